@@ -29,28 +29,77 @@ SOURCES += \
     bluetoothmanager.cpp \
     camerapage.cpp \
     clavier.cpp \
+    deadreckoning.cpp \
+    gpsrecorder.cpp \
+    gpsreplaysource.cpp \
+    gpsserialworker.cpp \
     gpstelemetrysource.cpp \
     homeassistant.cpp \
     main.cpp \
     mainwindow.cpp \
+    mapboxclient.cpp \
     mediapage.cpp \
     mpu9250source.cpp \
     navigationpage.cpp \
+    nmeaparser.cpp \
+    offlinegeocoder.cpp \
+    offlinerouter.cpp \
+    orientationengine.cpp \
+    polylinesimplifier.cpp \
+    roadgraph.cpp \
+    routematcher.cpp \
+    routemodel.cpp \
+    routepolylineitem.cpp \
+    routestrip.cpp \
+    segmentgrid.cpp \
     settingspage.cpp \
-    telemetrydata.cpp
+    telemetrydata.cpp \
+    telemetryframepacer.cpp \
+    tilecache.cpp \
+    tileprefetcher.cpp \
+    triplog.cpp \
+    triplogreader.cpp \
+    triplogwriter.cpp \
+    ubxprotocol.cpp
 
 HEADERS += \
     bluetoothmanager.h \
     camerapage.h \
     clavier.h \
+    deadreckoning.h \
+    gpsfix.h \
+    gpsrecorder.h \
+    gpsreplaysource.h \
+    gpsserialworker.h \
     gpstelemetrysource.h \
     homeassistant.h \
+    imusample.h \
     mainwindow.h \
+    mapboxclient.h \
     mediapage.h \
     mpu9250source.h \
     navigationpage.h \
+    nmeaparser.h \
+    offlinegeocoder.h \
+    offlinerouter.h \
+    orientationengine.h \
+    polylinesimplifier.h \
+    roadgraph.h \
+    routematcher.h \
+    routemodel.h \
+    routepolylineitem.h \
+    routestrip.h \
+    segmentgrid.h \
     settingspage.h \
-    telemetrydata.h
+    telemetrydata.h \
+    telemetryframepacer.h \
+    telemetryring.h \
+    tilecache.h \
+    tileprefetcher.h \
+    triplog.h \
+    triplogreader.h \
+    triplogwriter.h \
+    ubxprotocol.h
 
 # -------------------------------------------------------------------------
 # Section 4 : Fichiers d'interface (UI Designer)
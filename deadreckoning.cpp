@@ -0,0 +1,225 @@
+/**
+ * @file deadreckoning.cpp
+ * @brief Implémentation de la navigation à l'estime GPS/IMU.
+ * @details Les déplacements sont calculés dans un plan tangent local (Nord/Est en mètres) puis
+ * reportés en latitude/longitude avec un rayon terrestre moyen : sur quelques centaines de mètres
+ * entre deux fix, l'erreur de cette approximation reste très inférieure au bruit GNSS.
+ */
+
+#include "deadreckoning.h"
+#include "telemetrydata.h"
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double EarthRadiusM = 6371000.0;
+constexpr double DegToRad = M_PI / 180.0;
+constexpr double RadToDeg = 180.0 / M_PI;
+
+// Constante de temps de résorption du résidu de raccord (s) : le saut est absorbé en ≈ 3τ.
+constexpr double BlendTauS = 0.6;
+// Au-delà de cet écart, l'estime est jugée fausse et la position est recalée sans transition (m).
+constexpr double SnapDistanceM = 50.0;
+// Vitesse minimale pour que la route GPS serve de référence au cap IMU (m/s, ≈ 11 km/h).
+constexpr double CourseReferenceMinSpeedMs = 3.0;
+// Poids d'une nouvelle observation dans l'apprentissage du décalage de cap.
+constexpr double HeadingOffsetGain = 0.2;
+// Vitesse maximale plausible pour l'intégration de l'accélération IMU (m/s, ≈ 250 km/h).
+constexpr double MaxSpeedMs = 70.0;
+// Écart maximal entre deux mesures IMU pour intégrer l'accélération (s).
+constexpr double MaxMotionGapS = 0.5;
+
+double wrap180(double deg) {
+    deg = std::fmod(deg + 180.0, 360.0);
+    if (deg < 0.0) deg += 360.0;
+    return deg - 180.0;
+}
+
+double wrap360(double deg) {
+    deg = std::fmod(deg, 360.0);
+    return deg < 0.0 ? deg + 360.0 : deg;
+}
+}
+
+DeadReckoning::DeadReckoning(TelemetryData* data, QObject* parent)
+    : QObject(parent), m_data(data)
+{
+    qRegisterMetaType<GpsFix>("GpsFix");
+    qRegisterMetaType<DeadReckoning::Mode>("DeadReckoning::Mode");
+
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &DeadReckoning::publishEstimate);
+}
+
+void DeadReckoning::start() {
+    m_timer->start(1000 / m_outputRateHz);
+}
+
+void DeadReckoning::stop() {
+    m_timer->stop();
+}
+
+void DeadReckoning::setOutputRateHz(int hz) {
+    m_outputRateHz = std::clamp(hz, MinOutputRateHz, MaxOutputRateHz);
+    if (m_timer->isActive()) m_timer->start(1000 / m_outputRateHz);
+}
+
+bool DeadReckoning::pushMotion(const MotionSample& sample) {
+    return m_motion.push(sample);
+}
+
+double DeadReckoning::latitude() const {
+    return m_lat + (m_residualNorthM / EarthRadiusM) * RadToDeg;
+}
+
+double DeadReckoning::longitude() const {
+    return m_lon + (m_residualEastM / (EarthRadiusM * std::cos(m_lat * DegToRad))) * RadToDeg;
+}
+
+void DeadReckoning::onGpsFix(const GpsFix& fix) {
+    if (!fix.valid) {
+        // Entrée en tunnel : pas besoin d'attendre le délai d'expiration pour passer à l'estime.
+        if (m_mode == Mode::Tracking) setMode(Mode::DeadReckoning);
+        return;
+    }
+
+    if (m_mode == Mode::Idle) {
+        // Premier fix : initialisation directe de l'état.
+        m_lat = fix.lat;
+        m_lon = fix.lon;
+        m_speedMs = fix.hasSpeed ? fix.speedMs : 0.0;
+        if (fix.hasCourse && !m_hasImuHeading) m_headingDeg = fix.courseDeg;
+        m_lastPropagateNs = fix.timestampNs;
+        m_lastFixNs = fix.timestampNs;
+        setMode(Mode::Tracking);
+        return;
+    }
+
+    // 1. On amène l'estimation à l'instant du fix pour comparer des positions contemporaines.
+    propagateTo(fix.timestampNs);
+
+    // 2. L'écart entre la position affichée et le fix devient le résidu de raccord.
+    const double displayedLat = latitude();
+    const double displayedLon = longitude();
+    const double northM = (displayedLat - fix.lat) * DegToRad * EarthRadiusM;
+    const double eastM = (displayedLon - fix.lon) * DegToRad * EarthRadiusM * std::cos(fix.lat * DegToRad);
+    if (std::hypot(northM, eastM) > SnapDistanceM) {
+        m_residualNorthM = 0.0;
+        m_residualEastM = 0.0;
+    } else {
+        m_residualNorthM = northM;
+        m_residualEastM = eastM;
+    }
+
+    // 3. Recalage de l'état interne sur la mesure GNSS.
+    m_lat = fix.lat;
+    m_lon = fix.lon;
+    if (fix.hasSpeed) m_speedMs = fix.speedMs;
+
+    // 4. En roulant, la route GPS est une référence absolue : on apprend le décalage du cap IMU.
+    if (fix.hasCourse && fix.hasSpeed && fix.speedMs > CourseReferenceMinSpeedMs) {
+        if (m_hasImuHeading) {
+            const double observed = wrap180(fix.courseDeg - m_lastImuHeadingDeg);
+            if (!m_offsetLearned) {
+                m_headingOffsetDeg = observed;
+                m_offsetLearned = true;
+            } else {
+                m_headingOffsetDeg = wrap180(m_headingOffsetDeg + HeadingOffsetGain * wrap180(observed - m_headingOffsetDeg));
+            }
+            m_headingDeg = wrap360(m_lastImuHeadingDeg + m_headingOffsetDeg);
+        } else {
+            m_headingDeg = fix.courseDeg;
+        }
+    }
+
+    m_lastFixNs = fix.timestampNs;
+    setMode(Mode::Tracking);
+}
+
+void DeadReckoning::propagateTo(qint64 nowNs) {
+    if (m_mode == Mode::Idle) {
+        // Sans position de départ, les mesures IMU ne servent qu'à connaître le cap courant.
+        MotionSample sample;
+        while (m_motion.pop(sample)) applyMotion(sample);
+        return;
+    }
+
+    // 1. Mesures IMU en file, dans l'ordre : on avance jusqu'à chacune puis on l'applique.
+    MotionSample sample;
+    while (m_motion.pop(sample)) {
+        if (sample.timestampNs > m_lastPropagateNs) {
+            const qint64 target = std::min(sample.timestampNs, nowNs);
+            advance((target - m_lastPropagateNs) / 1e9);
+            m_lastPropagateNs = target;
+        }
+        applyMotion(sample);
+    }
+
+    // 2. Avancée jusqu'à l'instant demandé.
+    if (nowNs > m_lastPropagateNs) {
+        advance((nowNs - m_lastPropagateNs) / 1e9);
+        m_lastPropagateNs = nowNs;
+    }
+
+    // 3. Transitions d'état liées à l'âge du dernier fix.
+    const qint64 sinceFix = nowNs - m_lastFixNs;
+    if (m_mode == Mode::Tracking && sinceFix > m_fixTimeoutNs) setMode(Mode::DeadReckoning);
+    if (m_mode == Mode::DeadReckoning && sinceFix > m_maxDeadReckoningNs) {
+        m_speedMs = 0.0;
+        setMode(Mode::Lost);
+    }
+}
+
+void DeadReckoning::advance(double dtS) {
+    if (dtS <= 0.0) return;
+
+    // Le résidu de raccord décroît quel que soit l'état : la carte rejoint la position estimée.
+    const double decay = std::exp(-dtS / BlendTauS);
+    m_residualNorthM *= decay;
+    m_residualEastM *= decay;
+
+    if (m_mode == Mode::Lost || m_speedMs <= 0.0) return;
+
+    const double distanceM = m_speedMs * dtS;
+    const double heading = m_headingDeg * DegToRad;
+    const double northM = distanceM * std::cos(heading);
+    const double eastM = distanceM * std::sin(heading);
+    m_lat += (northM / EarthRadiusM) * RadToDeg;
+    m_lon += (eastM / (EarthRadiusM * std::cos(m_lat * DegToRad))) * RadToDeg;
+}
+
+void DeadReckoning::applyMotion(const MotionSample& sample) {
+    const qint64 previousNs = m_lastMotionNs;
+    m_lastMotionNs = sample.timestampNs;
+    m_lastImuHeadingDeg = sample.headingDeg;
+    m_hasImuHeading = true;
+    m_headingDeg = wrap360(sample.headingDeg + m_headingOffsetDeg);
+
+    // L'accélération n'est intégrée qu'en mouvement : à l'arrêt, le bruit de l'accéléromètre
+    // ferait "ramper" la position. Un trou dans le flux IMU (> MaxMotionGapS) n'est pas intégré.
+    if (m_mode != Mode::Tracking && m_mode != Mode::DeadReckoning) return;
+    if (previousNs == 0 || m_speedMs <= 0.0) return;
+    const double dtS = (sample.timestampNs - previousNs) / 1e9;
+    if (dtS <= 0.0 || dtS > MaxMotionGapS) return;
+    m_speedMs = std::clamp(m_speedMs + sample.forwardAccelMs2 * dtS, 0.0, MaxSpeedMs);
+}
+
+void DeadReckoning::publishEstimate() {
+    propagateTo(TelemetryData::monotonicNowNs());
+    if (!m_data || m_mode == Mode::Idle) return;
+
+    TelemetrySnapshot update;
+    update.lat = latitude();
+    update.lon = longitude();
+    update.speedKmh = m_speedMs * 3.6;
+    m_data->publish(TelemetryData::FusionSource, update,
+                    TelemetryData::PositionFields | TelemetryData::SpeedKmhField);
+}
+
+void DeadReckoning::setMode(Mode mode) {
+    if (m_mode == mode) return;
+    m_mode = mode;
+    emit modeChanged(mode);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file deadreckoning.h
+ * @brief Rôle architectural : Étage de fusion GPS/IMU faiblement couplée (navigation à l'estime).
+ * @details Responsabilités : Propager la position entre deux fix GNSS (1 Hz) et pendant les pertes
+ * de fix (tunnels) à partir du cap et de l'accélération longitudinale de la centrale inertielle,
+ * puis raccorder en douceur l'estimation au fix suivant. La position résultante est publiée
+ * vers TelemetryData à cadence fixe (30 à 60 Hz) pour une carte fluide sans animation de masquage.
+ * Dépendances principales : TelemetryData (publication), TelemetryRing (échantillons IMU), QTimer.
+ */
+
+#ifndef DEADRECKONING_H
+#define DEADRECKONING_H
+
+#include <QObject>
+#include "gpsfix.h"
+#include "telemetryring.h"
+
+class QTimer;
+class TelemetryData;
+
+/**
+ * @struct MotionSample
+ * @brief Mesure de mouvement fournie par la centrale inertielle (thread d'acquisition).
+ */
+struct MotionSample {
+    qint64 timestampNs = 0;       ///< Instant de la mesure (horloge monotone, ns).
+    float headingDeg = 0.0f;      ///< Cap magnétique compensé, déclinaison incluse (degrés, non lissé).
+    float forwardAccelMs2 = 0.0f; ///< Accélération longitudinale, gravité retirée (m/s²).
+};
+
+/**
+ * @class DeadReckoning
+ * @brief Estimateur de position GPS/IMU à cadence d'affichage.
+ * @details Modèle cinématique 2D : position (lat, lon), vitesse longitudinale et cap.
+ * - Entre deux fix, la position avance selon la vitesse (intégrant l'accélération IMU) et le cap IMU,
+ *   corrigé d'un décalage appris contre la route GPS (désalignement de montage, déclinaison).
+ * - À chaque fix, l'état interne est recalé sur le fix ; l'écart avec la position affichée devient
+ *   un résidu qui décroît exponentiellement : la carte glisse au lieu de sauter.
+ * - Sans fix, l'estime continue jusqu'à setMaxDeadReckoningMs(), puis la position est figée.
+ *
+ * pushMotion() est sûr depuis le thread d'acquisition IMU (file SPSC sans verrou) ; le reste de
+ * l'API s'utilise depuis le thread GUI.
+ */
+class DeadReckoning : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief État de l'estimateur.
+     */
+    enum class Mode {
+        Idle,          ///< Aucun fix reçu : rien n'est publié.
+        Tracking,      ///< Fix récents : propagation entre fix et raccord progressif.
+        DeadReckoning, ///< Fix perdu : position à l'estime (cap + vitesse IMU).
+        Lost           ///< Estime trop ancienne : position figée jusqu'au prochain fix.
+    };
+
+    static constexpr int MinOutputRateHz = 30; ///< Cadence minimale de publication.
+    static constexpr int MaxOutputRateHz = 60; ///< Cadence maximale de publication.
+
+    /**
+     * @brief Constructeur.
+     * @param data Modèle de télémétrie recevant la position fusionnée (source FusionSource).
+     * @param parent Objet parent pour la gestion mémoire.
+     */
+    explicit DeadReckoning(TelemetryData* data, QObject* parent = nullptr);
+
+    /**
+     * @brief Démarre la publication périodique (cadence setOutputRateHz()).
+     */
+    void start();
+
+    /**
+     * @brief Arrête la publication périodique (l'état est conservé).
+     */
+    void stop();
+
+    /**
+     * @brief Cadence de publication vers TelemetryData, bornée à [30, 60] Hz (30 Hz par défaut).
+     */
+    void setOutputRateHz(int hz);
+    int outputRateHz() const { return m_outputRateHz; } ///< Cadence de publication effective.
+
+    /**
+     * @brief Délai sans fix valide au-delà duquel l'estimateur bascule en navigation à l'estime.
+     */
+    void setFixTimeoutMs(int ms) { m_fixTimeoutNs = qint64(ms) * 1000000; }
+
+    /**
+     * @brief Durée maximale de navigation à l'estime avant de figer la position.
+     */
+    void setMaxDeadReckoningMs(int ms) { m_maxDeadReckoningNs = qint64(ms) * 1000000; }
+
+    /**
+     * @brief Transmet une mesure de mouvement IMU (thread d'acquisition, un seul producteur).
+     * @return false si la file était pleine (mesure perdue).
+     */
+    bool pushMotion(const MotionSample& sample);
+
+    /**
+     * @brief Fait avancer l'estimation jusqu'à l'instant donné (mesures IMU en file incluses).
+     * @param nowNs Instant cible (horloge monotone, ns).
+     */
+    void propagateTo(qint64 nowNs);
+
+    Mode mode() const { return m_mode; }                  ///< État courant.
+    double latitude() const;                              ///< Latitude affichée (résidu de raccord inclus).
+    double longitude() const;                             ///< Longitude affichée (résidu de raccord inclus).
+    double speedMs() const { return m_speedMs; }          ///< Vitesse estimée (m/s).
+    double headingDeg() const { return m_headingDeg; }    ///< Cap utilisé pour la propagation (degrés).
+    double headingOffsetDeg() const { return m_headingOffsetDeg; } ///< Décalage appris route GPS - cap IMU.
+
+public slots:
+    /**
+     * @brief Intègre un fix GNSS (valide ou non).
+     * @param fix Fix horodaté sur l'horloge monotone.
+     */
+    void onGpsFix(const GpsFix& fix);
+
+signals:
+    /**
+     * @brief Émis à chaque changement d'état (ex: entrée en tunnel, retour du fix).
+     */
+    void modeChanged(DeadReckoning::Mode mode);
+
+private slots:
+    /**
+     * @brief Tick de publication : propage jusqu'à maintenant et publie la position.
+     */
+    void publishEstimate();
+
+private:
+    void advance(double dtS);
+    void applyMotion(const MotionSample& sample);
+    void setMode(Mode mode);
+
+    TelemetryData* m_data = nullptr;       ///< Modèle de télémétrie partagé
+    QTimer* m_timer = nullptr;             ///< Cadence de publication
+    int m_outputRateHz = 30;               ///< Cadence de publication (Hz)
+
+    TelemetryRing<MotionSample, 256> m_motion; ///< Mesures IMU en attente (thread IMU -> thread GUI)
+
+    Mode m_mode = Mode::Idle;              ///< État courant
+    double m_lat = 0.0;                    ///< Latitude estimée (degrés, sans résidu)
+    double m_lon = 0.0;                    ///< Longitude estimée (degrés, sans résidu)
+    double m_speedMs = 0.0;                ///< Vitesse longitudinale estimée (m/s)
+    double m_headingDeg = 0.0;             ///< Cap de propagation (degrés)
+    bool m_hasImuHeading = false;          ///< true dès qu'un cap IMU a été reçu
+    double m_lastImuHeadingDeg = 0.0;      ///< Dernier cap IMU brut (degrés)
+    double m_headingOffsetDeg = 0.0;       ///< Décalage appris entre route GPS et cap IMU
+    bool m_offsetLearned = false;          ///< false tant qu'aucune route GPS n'a servi de référence
+    double m_residualNorthM = 0.0;         ///< Résidu de raccord vers le Nord (m)
+    double m_residualEastM = 0.0;          ///< Résidu de raccord vers l'Est (m)
+
+    qint64 m_lastPropagateNs = 0;          ///< Instant de la dernière propagation
+    qint64 m_lastMotionNs = 0;             ///< Instant de la dernière mesure IMU appliquée
+    qint64 m_lastFixNs = 0;                ///< Instant du dernier fix valide
+    qint64 m_fixTimeoutNs = 1500000000;    ///< Délai avant navigation à l'estime (1,5 s)
+    qint64 m_maxDeadReckoningNs = 60000000000LL; ///< Durée maximale d'estime (60 s)
+};
+
+Q_DECLARE_METATYPE(DeadReckoning::Mode)
+
+#endif // DEADRECKONING_H
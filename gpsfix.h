@@ -0,0 +1,34 @@
+/**
+ * @file gpsfix.h
+ * @brief Rôle architectural : Format commun d'un fix GNSS transmis aux étages de fusion.
+ * @details Responsabilités : Transporter un fix horodaté (position, vitesse, route) du récepteur
+ * vers les consommateurs qui ont besoin de plus que l'instantané affiché (estime, journal de trajet).
+ * Dépendances principales : aucune (structure POD enregistrée auprès du système de méta-types Qt).
+ */
+
+#ifndef GPSFIX_H
+#define GPSFIX_H
+
+#include <QMetaType>
+#include <QtGlobal>
+
+/**
+ * @struct GpsFix
+ * @brief Fix GNSS horodaté sur l'horloge monotone (même base que ImuSample::timestampNs).
+ */
+struct GpsFix {
+    bool valid = false;        ///< false : récepteur sans fix (position non significative).
+    double lat = 0.0;          ///< Latitude (degrés WGS84).
+    double lon = 0.0;          ///< Longitude (degrés WGS84).
+    bool hasSpeed = false;     ///< true si la trame fournissait la vitesse sol.
+    double speedMs = 0.0;      ///< Vitesse sol (m/s).
+    bool hasCourse = false;    ///< true si la trame fournissait la route sur le fond.
+    double courseDeg = 0.0;    ///< Route sur le fond (degrés, 0 = Nord, sens horaire).
+    int satellites = -1;       ///< Satellites utilisés dans la solution (-1 : inconnu).
+    double hdop = -1.0;        ///< Dilution horizontale de précision (-1 : inconnue).
+    double horizontalAccuracyM = -1.0; ///< Précision horizontale estimée par le récepteur (m, UBX ; -1 : inconnue).
+    qint64 timestampNs = 0;    ///< Instant de réception (horloge monotone, ns).
+};
+Q_DECLARE_METATYPE(GpsFix)
+
+#endif // GPSFIX_H
@@ -0,0 +1,60 @@
+/**
+ * @file gpsrecorder.cpp
+ * @brief Implémentation de l'enregistrement horodaté du flux série GPS.
+ */
+
+#include "gpsrecorder.h"
+#include <QtEndian>
+
+namespace {
+// Au plus une seconde de flux perdue en cas de coupure d'alimentation.
+constexpr qint64 FlushIntervalNs = 1000000000LL;
+}
+
+GpsRecorder::~GpsRecorder()
+{
+    close();
+}
+
+bool GpsRecorder::open(const QString& path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    m_file.write(Magic, MagicLength);
+    m_originNs = -1;
+    m_lastFlushNs = 0;
+    m_chunks = 0;
+    m_bytes = 0;
+    return true;
+}
+
+void GpsRecorder::close()
+{
+    if (!m_file.isOpen()) return;
+    m_file.flush();
+    m_file.close();
+}
+
+void GpsRecorder::record(const char* data, qint64 size, qint64 timestampNs)
+{
+    if (!m_file.isOpen() || size <= 0) return;
+    if (m_originNs < 0) {
+        m_originNs = timestampNs;
+        m_lastFlushNs = timestampNs;
+    }
+
+    char header[ChunkHeaderLength];
+    qToLittleEndian<qint64>(timestampNs - m_originNs, header);
+    qToLittleEndian<quint32>(quint32(size), header + 8);
+    m_file.write(header, ChunkHeaderLength);
+    m_file.write(data, size);
+    ++m_chunks;
+    m_bytes += quint64(size);
+
+    if (timestampNs - m_lastFlushNs >= FlushIntervalNs) {
+        m_file.flush();
+        m_lastFlushNs = timestampNs;
+    }
+}
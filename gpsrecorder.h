@@ -0,0 +1,67 @@
+/**
+ * @file gpsrecorder.h
+ * @brief Rôle architectural : Enregistrement horodaté du flux série GPS brut (NMEA ou UBX).
+ * @details Responsabilités : Recopier chaque bloc lu sur le port série dans un fichier, avec son instant
+ * de réception relatif au début de l'enregistrement, pour le rejouer ensuite à l'identique avec
+ * GpsReplaySource (tests de performance sur poste de développement, reproduction de bugs terrain).
+ * Format (little-endian) : en-tête "IGPSREC1", puis pour chaque bloc : décalage (qint64, ns),
+ * longueur (quint32) et octets bruts.
+ * Dépendances principales : QFile.
+ */
+
+#ifndef GPSRECORDER_H
+#define GPSRECORDER_H
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @class GpsRecorder
+ * @brief Écrivain du journal série horodaté.
+ * @details Appelé depuis le thread de GpsTelemetrySource à chaque readyRead : l'écriture passe par
+ * le tampon de QFile et n'est vidée sur disque qu'une fois par seconde (quelques centaines d'octets
+ * à 9600 bauds, une dizaine de ko à 115200).
+ */
+class GpsRecorder {
+public:
+    /** @brief Signature en tête de fichier (8 octets). */
+    static constexpr char Magic[] = "IGPSREC1";
+    static constexpr int MagicLength = 8;
+    /** @brief Taille de l'en-tête de bloc : décalage (8 octets) + longueur (4 octets). */
+    static constexpr int ChunkHeaderLength = 12;
+
+    GpsRecorder() = default;
+    ~GpsRecorder();
+
+    /**
+     * @brief Crée (ou écrase) le fichier d'enregistrement et écrit la signature.
+     * @return false si le fichier ne peut pas être ouvert en écriture.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Vide le tampon et ferme le fichier.
+     */
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); } ///< true entre open() et close().
+
+    /**
+     * @brief Ajoute un bloc d'octets reçus.
+     * @param timestampNs Instant de réception (horloge monotone) ; le premier bloc définit l'origine.
+     */
+    void record(const char* data, qint64 size, qint64 timestampNs);
+
+    quint64 chunksRecorded() const { return m_chunks; } ///< Blocs écrits depuis open().
+    quint64 bytesRecorded() const { return m_bytes; }   ///< Octets série écrits depuis open().
+
+private:
+    QFile m_file;              ///< Fichier de destination
+    qint64 m_originNs = -1;    ///< Instant du premier bloc (-1 : aucun bloc)
+    qint64 m_lastFlushNs = 0;  ///< Dernier vidage du tampon sur disque
+    quint64 m_chunks = 0;      ///< Blocs écrits
+    quint64 m_bytes = 0;       ///< Octets série écrits
+};
+
+#endif // GPSRECORDER_H
@@ -0,0 +1,170 @@
+/**
+ * @file gpsreplaysource.cpp
+ * @brief Implémentation du rejeu de journal GPS.
+ */
+
+#include "gpsreplaysource.h"
+#include "gpsrecorder.h"
+#include "gpstelemetrysource.h"
+#include "telemetrydata.h"
+#include <QFile>
+#include <QTimer>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Découpage d'un journal brut : l'ordre de grandeur d'un readyRead sur un UART.
+constexpr int RawChunkBytes = 64;
+// Blocs injectés par passage de la boucle d'événements en mode AsFastAsPossible.
+constexpr int FastBatchChunks = 32;
+}
+
+GpsReplaySource::GpsReplaySource(GpsTelemetrySource* target, QObject* parent)
+    : QObject(parent), m_target(target)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &GpsReplaySource::onTimer);
+}
+
+bool GpsReplaySource::open(const QString& path)
+{
+    stop();
+    m_data.clear();
+    m_chunks.clear();
+    m_next = 0;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    m_data = file.readAll();
+    if (m_data.isEmpty()) return false;
+
+    m_containsUbx = m_data.contains("\xB5\x62");
+    m_timestamped = m_data.size() >= GpsRecorder::MagicLength
+                 && std::memcmp(m_data.constData(), GpsRecorder::Magic, GpsRecorder::MagicLength) == 0;
+
+    if (m_timestamped) {
+        // Un enregistrement interrompu (coupure d'alimentation) s'arrête au dernier bloc complet.
+        int pos = GpsRecorder::MagicLength;
+        qint64 lastOffsetNs = 0;
+        while (pos + GpsRecorder::ChunkHeaderLength <= m_data.size()) {
+            const char* header = m_data.constData() + pos;
+            const qint64 offsetNs = qFromLittleEndian<qint64>(header);
+            const quint32 length = qFromLittleEndian<quint32>(header + 8);
+            pos += GpsRecorder::ChunkHeaderLength;
+            if (length > quint32(m_data.size() - pos)) break;
+
+            Chunk chunk;
+            chunk.offsetNs = qMax(lastOffsetNs, offsetNs);
+            chunk.begin = pos;
+            chunk.length = int(length);
+            m_chunks.append(chunk);
+            lastOffsetNs = chunk.offsetNs;
+            pos += int(length);
+        }
+    } else {
+        // Journal brut (capture de /dev/serial0, export u-center...) : cadencé au débit série, 8N1.
+        const double nsPerByte = 10.0 * 1e9 / m_rawBaud;
+        for (int pos = 0; pos < m_data.size(); pos += RawChunkBytes) {
+            Chunk chunk;
+            chunk.begin = pos;
+            chunk.length = qMin(RawChunkBytes, int(m_data.size()) - pos);
+            chunk.offsetNs = qint64(std::llround((pos + chunk.length) * nsPerByte));
+            m_chunks.append(chunk);
+        }
+    }
+    return !m_chunks.isEmpty();
+}
+
+void GpsReplaySource::setSpeed(double factor)
+{
+    m_speed = factor > 0.0 ? factor : AsFastAsPossible;
+    // Reprise à la nouvelle vitesse sans saut : l'origine est recalée sur le bloc courant.
+    if (isRunning()) start();
+}
+
+bool GpsReplaySource::isRunning() const
+{
+    return m_timer->isActive();
+}
+
+void GpsReplaySource::start()
+{
+    if (m_next >= m_chunks.size()) return;
+    m_startOffsetNs = m_chunks.at(m_next).offsetNs;
+    // Origine prise avant l'horloge de cadence : un bloc n'est jamais horodaté après son injection.
+    anchorStamps(m_speed == AsFastAsPossible ? 1.0 : 1.0 / m_speed);
+    m_clock.start();
+    m_timer->start(0);
+}
+
+void GpsReplaySource::stop()
+{
+    m_timer->stop();
+}
+
+void GpsReplaySource::rewind()
+{
+    stop();
+    m_next = 0;
+}
+
+int GpsReplaySource::replayAll()
+{
+    stop();
+    const int first = m_next;
+    if (m_next < m_chunks.size()) {
+        m_startOffsetNs = m_chunks.at(m_next).offsetNs;
+        anchorStamps(1.0);
+    }
+    while (m_next < m_chunks.size()) injectNext();
+    // Fin du journal : pas d'époque suivante pour clore la dernière, ni de silence à attendre.
+    if (m_target) m_target->flushEpoch();
+    return m_next - first;
+}
+
+void GpsReplaySource::anchorStamps(double scale)
+{
+    // Le bloc m_next part maintenant : il reçoit l'instant courant, jamais antérieur au dernier bloc
+    // (rewind() puis start() ne fait pas remonter le temps des fix).
+    m_originNs = qMax(TelemetryData::monotonicNowNs(), m_lastStampNs);
+    m_stampScale = scale;
+}
+
+void GpsReplaySource::injectNext()
+{
+    const Chunk& chunk = m_chunks.at(m_next++);
+    // Rejeu accéléré ou ralenti : un écart enregistré de 1 s dure 1 / vitesse secondes réelles, et les
+    // fix doivent le refléter, sinon DeadReckoning les juge trop anciens (ou venus du futur).
+    m_lastStampNs = m_originNs + qint64(std::llround((chunk.offsetNs - m_startOffsetNs) * m_stampScale));
+    if (m_target) m_target->ingest(m_data.constData() + chunk.begin, chunk.length, m_lastStampNs);
+}
+
+void GpsReplaySource::onTimer()
+{
+    if (m_speed == AsFastAsPossible) {
+        // Par lots : la boucle d'événements (rendu de la carte, timers) continue de tourner.
+        for (int i = 0; i < FastBatchChunks && m_next < m_chunks.size(); ++i) injectNext();
+    } else {
+        const qint64 nowOffsetNs = m_startOffsetNs + qint64(m_clock.nsecsElapsed() * m_speed);
+        while (m_next < m_chunks.size() && m_chunks.at(m_next).offsetNs <= nowOffsetNs) injectNext();
+    }
+
+    if (m_next >= m_chunks.size()) {
+        if (m_target) m_target->flushEpoch();
+        emit finished();
+        return;
+    }
+
+    if (m_speed == AsFastAsPossible) {
+        m_timer->start(0);
+        return;
+    }
+
+    // Réveil à l'échéance du prochain bloc, ramenée au temps réel.
+    const qint64 nowOffsetNs = m_startOffsetNs + qint64(m_clock.nsecsElapsed() * m_speed);
+    const double waitNs = (m_chunks.at(m_next).offsetNs - nowOffsetNs) / m_speed;
+    m_timer->start(qMax(0, int(std::ceil(waitNs / 1e6))));
+}
@@ -0,0 +1,140 @@
+/**
+ * @file gpsreplaysource.h
+ * @brief Rôle architectural : Rejeu d'un journal GPS (NMEA ou UBX) dans GpsTelemetrySource.
+ * @details Responsabilités : Charger un enregistrement GpsRecorder (ou un journal brut sans horodatage)
+ * et réinjecter ses octets par GpsTelemetrySource::ingest(), c'est-à-dire par le même chemin de décodage
+ * et de publication qu'un port série réel, au rythme d'origine, accéléré N fois ou aussi vite que possible.
+ * Permet de mesurer toute la chaîne télémétrie -> carte sur un poste de développement et de reproduire
+ * un bug terrain de façon déterministe.
+ * Dépendances principales : GpsTelemetrySource, QTimer, QElapsedTimer.
+ */
+
+#ifndef GPSREPLAYSOURCE_H
+#define GPSREPLAYSOURCE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class GpsTelemetrySource;
+class QTimer;
+
+/**
+ * @class GpsReplaySource
+ * @brief Lecteur de journal GPS piloté par la boucle d'événements.
+ * @details Un journal UBX (containsUbx()) doit être rejoué dans une source réglée en Protocol::Ubx,
+ * sans start() ; un journal NMEA fonctionne dans les deux modes.
+ */
+class GpsReplaySource : public QObject {
+    Q_OBJECT
+public:
+    /** @brief Vitesse spéciale : blocs injectés sans attente, par lots, en rendant la main à la boucle d'événements. */
+    static constexpr double AsFastAsPossible = 0.0;
+
+    /**
+     * @brief Constructeur.
+     * @param target Source GPS qui reçoit les octets rejoués.
+     * @param parent Objet parent pour la gestion mémoire.
+     */
+    explicit GpsReplaySource(GpsTelemetrySource* target, QObject* parent = nullptr);
+
+    /**
+     * @brief Charge un journal en mémoire (et arrête un rejeu en cours).
+     * @details Un fichier GpsRecorder conserve les instants de réception d'origine ; tout autre fichier
+     * est traité comme un flux brut découpé en blocs de 64 octets cadencés au débit série (setRawBaudRate()).
+     * @return false si le fichier est illisible ou vide.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Facteur de vitesse : 1 = temps réel, N = N fois plus vite, AsFastAsPossible = sans attente.
+     * @details En rejeu cadencé, les fix sont horodatés à leur instant d'injection (écarts enregistrés
+     * divisés par la vitesse), comme les échantillons IMU et les propagations de DeadReckoning ; sans
+     * attente (et par replayAll()), ils gardent les écarts enregistrés.
+     */
+    void setSpeed(double factor);
+    double speed() const { return m_speed; } ///< Facteur de vitesse courant.
+
+    /**
+     * @brief Débit série simulé pour un journal brut (9600 bauds par défaut), pris en compte au prochain open().
+     */
+    void setRawBaudRate(int baud) { m_rawBaud = qMax(1200, baud); }
+
+    bool isTimestamped() const { return m_timestamped; }     ///< true pour un fichier GpsRecorder.
+    bool containsUbx() const { return m_containsUbx; }       ///< true si le journal contient des trames UBX.
+    int chunkCount() const { return int(m_chunks.size()); } ///< Blocs du journal chargé.
+    int position() const { return m_next; }                ///< Blocs déjà injectés.
+    bool isRunning() const;                                 ///< true entre start() et finished()/stop().
+
+    /**
+     * @brief Durée du journal au rythme d'origine (décalage du dernier bloc, ns).
+     */
+    qint64 durationNs() const { return m_chunks.isEmpty() ? 0 : m_chunks.last().offsetNs; }
+
+    /**
+     * @brief Lance (ou reprend) le rejeu asynchrone depuis position().
+     */
+    void start();
+
+    /**
+     * @brief Suspend le rejeu ; start() reprend au bloc suivant.
+     */
+    void stop();
+
+    /**
+     * @brief Revient au début du journal.
+     */
+    void rewind();
+
+    /**
+     * @brief Injecte immédiatement tous les blocs restants (rejeu synchrone, sans boucle d'événements).
+     * @details La dernière époque NMEA est publiée au retour (GpsTelemetrySource::flushEpoch()).
+     * @return Nombre de blocs injectés.
+     */
+    int replayAll();
+
+signals:
+    /**
+     * @brief Émis quand le dernier bloc du journal a été injecté par start() (dernière époque publiée).
+     */
+    void finished();
+
+private slots:
+    /**
+     * @brief Injecte les blocs échus puis programme le réveil suivant.
+     */
+    void onTimer();
+
+private:
+    /**
+     * @struct Chunk
+     * @brief Bloc du journal : position dans m_data et instant de réception d'origine.
+     */
+    struct Chunk {
+        qint64 offsetNs = 0; ///< Décalage depuis le début de l'enregistrement (ns)
+        int begin = 0;       ///< Premier octet dans m_data
+        int length = 0;      ///< Nombre d'octets
+    };
+
+    void anchorStamps(double scale);
+    void injectNext();
+
+    GpsTelemetrySource* m_target = nullptr; ///< Source qui décode les octets rejoués
+    qint64 m_originNs = 0;                  ///< Instant monotone attribué au décalage m_startOffsetNs
+    qint64 m_lastStampNs = 0;               ///< Horodatage du dernier bloc injecté
+    double m_stampScale = 1.0;              ///< ns monotones par ns enregistrée (1 / vitesse en rejeu cadencé)
+    QTimer* m_timer = nullptr;              ///< Réveil du rejeu (mono-coup)
+    QElapsedTimer m_clock;                  ///< Temps écoulé depuis start()
+    QByteArray m_data;                      ///< Contenu du journal
+    QList<Chunk> m_chunks;                  ///< Découpage en blocs
+    int m_next = 0;                         ///< Prochain bloc à injecter
+    qint64 m_startOffsetNs = 0;             ///< Décalage du bloc m_next au moment de start()
+    double m_speed = 1.0;                   ///< Facteur de vitesse
+    int m_rawBaud = 9600;                   ///< Débit simulé pour un journal brut
+    bool m_timestamped = false;             ///< true pour un fichier GpsRecorder
+    bool m_containsUbx = false;             ///< true si un motif de synchronisation UBX a été vu
+};
+
+#endif // GPSREPLAYSOURCE_H
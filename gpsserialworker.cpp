@@ -0,0 +1,237 @@
+/**
+ * @file gpsserialworker.cpp
+ * @brief Implémentation de la lecture série GPS (détection du débit, reconnexion).
+ */
+
+#include "gpsserialworker.h"
+#include "telemetrydata.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+QList<int> GpsSerialWorker::candidateBaudRates()
+{
+    // 9600 : NMEA d'usine ; 38400 : réglage courant des modules configurés ; 115200 : mode UBX.
+    return {9600, 38400, 115200};
+}
+
+GpsSerialWorker::GpsSerialWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+GpsSerialWorker::~GpsSerialWorker()
+{
+    closePort();
+}
+
+GpsSerialWorker::Stats GpsSerialWorker::stats() const
+{
+    Stats stats;
+    stats.bytes = m_statBytes.load(std::memory_order_relaxed);
+    stats.reconnects = m_statReconnects.load(std::memory_order_relaxed);
+    stats.baudProbes = m_statProbes.load(std::memory_order_relaxed);
+    stats.baudRate = m_statBaud.load(std::memory_order_relaxed);
+    stats.connected = stats.baudRate != 0;
+    return stats;
+}
+
+void GpsSerialWorker::ensureObjects()
+{
+    // Créés au premier start(), donc dans le thread du worker : leurs notifications y sont traitées.
+    if (m_port) return;
+    m_port = new QSerialPort(this);
+    connect(m_port, &QSerialPort::readyRead, this, &GpsSerialWorker::onReadyRead);
+    connect(m_port, &QSerialPort::errorOccurred, this, &GpsSerialWorker::onErrorOccurred);
+
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &GpsSerialWorker::tryOpen);
+
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setInterval(RetryIntervalMs);
+    connect(m_retryTimer, &QTimer::timeout, this, &GpsSerialWorker::tryOpen);
+
+    m_probeTimer = new QTimer(this);
+    m_probeTimer->setSingleShot(true);
+    connect(m_probeTimer, &QTimer::timeout, this, &GpsSerialWorker::onProbeTimeout);
+
+    m_stallTimer = new QTimer(this);
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setInterval(StallTimeoutMs);
+    connect(m_stallTimer, &QTimer::timeout, this, &GpsSerialWorker::onStallTimeout);
+}
+
+void GpsSerialWorker::start(const QString& portName, int preferredBaud)
+{
+    ensureObjects();
+    stop();
+
+    m_portName = portName;
+    m_preferredBaud = preferredBaud;
+    m_everConnected = false;
+    m_state = State::WaitingForDevice;
+    watchDevice();
+    tryOpen();
+}
+
+void GpsSerialWorker::stop()
+{
+    if (!m_port) return;
+    m_retryTimer->stop();
+    if (!m_watcher->directories().isEmpty()) m_watcher->removePaths(m_watcher->directories());
+    closePort();
+    m_state = State::Stopped;
+}
+
+void GpsSerialWorker::watchDevice()
+{
+    // inotify sur le répertoire du périphérique (/dev, /dev/serial/by-id...) : un récepteur USB
+    // ré-énuméré y réapparaît. Le timer couvre les répertoires créés après coup et les liens udev.
+    const QString directory = QFileInfo(m_portName).absolutePath();
+    if (QDir(directory).exists() && !m_watcher->directories().contains(directory)) m_watcher->addPath(directory);
+    m_retryTimer->start();
+}
+
+void GpsSerialWorker::tryOpen()
+{
+    if (m_state != State::WaitingForDevice) return;
+    if (m_portName.startsWith(QLatin1Char('/')) && !QFileInfo::exists(m_portName)) return;
+
+    m_port->setPortName(m_portName);
+    if (!m_port->open(QIODevice::ReadWrite)) {
+        m_port->clearError();
+        return;
+    }
+    m_retryTimer->stop();
+    if (m_everConnected) m_statReconnects.fetch_add(1, std::memory_order_relaxed);
+    m_everConnected = true;
+    qDebug() << "GPS : port" << m_portName << "ouvert, détection du débit";
+    startProbing();
+}
+
+void GpsSerialWorker::startProbing()
+{
+    m_state = State::Probing;
+    m_statBaud.store(0, std::memory_order_relaxed);
+    m_stallTimer->stop();
+
+    m_probeOrder = candidateBaudRates();
+    m_probeOrder.removeAll(m_preferredBaud);
+    m_probeOrder.prepend(m_preferredBaud);
+    m_probeIndex = 0;
+    probeBaud(m_probeOrder.first());
+}
+
+void GpsSerialWorker::probeBaud(int baud)
+{
+    m_statProbes.fetch_add(1, std::memory_order_relaxed);
+    m_port->setBaudRate(baud);
+    m_port->clear(QSerialPort::Input);
+    m_probeNmea.reset();
+    m_probeUbx.reset();
+    m_probeBuffer.clear();
+    m_probeTimer->start(ProbeWindowMs);
+}
+
+void GpsSerialWorker::onProbeTimeout()
+{
+    if (m_state != State::Probing) return;
+    if (m_portName.startsWith(QLatin1Char('/')) && !QFileInfo::exists(m_portName)) {
+        // Périphérique disparu sans erreur du pilote (port resté ouvert sur un descripteur mort).
+        onErrorOccurred(QSerialPort::ResourceError);
+        return;
+    }
+    // Aucun débit n'a répondu : le récepteur démarre peut-être encore, on reboucle sur la liste.
+    m_probeIndex = (m_probeIndex + 1) % int(m_probeOrder.size());
+    probeBaud(m_probeOrder.at(m_probeIndex));
+}
+
+void GpsSerialWorker::onReadyRead()
+{
+    qint64 n = 0;
+    while ((n = m_port->read(m_readBuffer, sizeof(m_readBuffer))) > 0) {
+        m_statBytes.fetch_add(quint64(n), std::memory_order_relaxed);
+        const qint64 timestampNs = TelemetryData::monotonicNowNs();
+
+        if (m_state == State::Streaming) {
+            m_stallTimer->start();
+            emit dataReceived(QByteArray(m_readBuffer, int(n)), timestampNs);
+            continue;
+        }
+        if (m_state != State::Probing) continue;
+
+        // À un mauvais débit, les octets sont du bruit : aucune somme de contrôle ne tombe juste.
+        const std::size_t length = std::size_t(n);
+        m_probeNmea.feed(m_readBuffer, length);
+        m_probeUbx.feed(m_readBuffer, length, [](quint8, quint8, const quint8*, std::size_t) {});
+        m_probeBuffer.append(m_readBuffer, int(n));
+
+        const quint64 frames = m_probeNmea.stats().sentences + m_probeNmea.stats().ignored
+                             + m_probeUbx.stats().frames;
+        if (frames < quint64(MinProbeFrames)) continue;
+
+        const int baud = m_probeOrder.at(m_probeIndex);
+        m_probeTimer->stop();
+        m_state = State::Streaming;
+        m_preferredBaud = baud;
+        m_statBaud.store(baud, std::memory_order_relaxed);
+        m_stallTimer->start();
+        qDebug() << "GPS : débit détecté" << baud << "bauds sur" << m_portName;
+        emit connected(baud);
+        // La fenêtre d'écoute réussie contient déjà des phrases complètes : rien n'est perdu.
+        emit dataReceived(m_probeBuffer, timestampNs);
+        m_probeBuffer.clear();
+    }
+}
+
+void GpsSerialWorker::onStallTimeout()
+{
+    if (m_state != State::Streaming) return;
+    qWarning() << "GPS : aucune donnée depuis" << StallTimeoutMs << "ms, nouvelle détection du débit";
+    emit disconnected(false);
+    startProbing();
+}
+
+void GpsSerialWorker::onErrorOccurred(QSerialPort::SerialPortError error)
+{
+    // ResourceError : périphérique débranché ou ré-énuméré. Le port est fermé et l'on attend
+    // sa réapparition (les autres erreurs, transitoires, sont ignorées).
+    if (error != QSerialPort::ResourceError || m_state == State::Stopped) return;
+    qWarning() << "GPS : périphérique" << m_portName << "perdu, attente de reconnexion";
+    closePort();
+    m_state = State::WaitingForDevice;
+    emit disconnected(true);
+    watchDevice();
+}
+
+void GpsSerialWorker::write(const QByteArray& data)
+{
+    if (m_state == State::Streaming) m_port->write(data);
+}
+
+void GpsSerialWorker::setBaudRate(int baud)
+{
+    if (m_state != State::Streaming) return;
+    m_port->setBaudRate(baud);
+    m_preferredBaud = baud;
+    m_statBaud.store(baud, std::memory_order_relaxed);
+    m_stallTimer->start();
+}
+
+void GpsSerialWorker::redetectBaudRate()
+{
+    if (m_state != State::Streaming) return;
+    emit disconnected(false);
+    startProbing();
+}
+
+void GpsSerialWorker::closePort()
+{
+    if (m_probeTimer) m_probeTimer->stop();
+    if (m_stallTimer) m_stallTimer->stop();
+    if (m_port && m_port->isOpen()) m_port->close();
+    if (m_port) m_port->clearError();
+    m_statBaud.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file gpsserialworker.h
+ * @brief Rôle architectural : Lecture du port série GPS dans un thread dédié, avec détection du débit
+ * et reconnexion automatique.
+ * @details Responsabilités : Ouvrir le port, trouver le débit auquel le récepteur émet (NMEA ou UBX),
+ * transmettre les octets reçus au thread GUI et rouvrir le port quand le périphérique réapparaît
+ * (récepteur USB ré-énuméré, module réinitialisé). Le thread GUI n'exécute jamais d'appel bloquant
+ * sur le port.
+ * Dépendances principales : QSerialPort, QFileSystemWatcher (inotify sous Linux), NmeaParser, UbxParser.
+ */
+
+#ifndef GPSSERIALWORKER_H
+#define GPSSERIALWORKER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSerialPort>
+#include <QString>
+#include <atomic>
+#include "nmeaparser.h"
+#include "ubxprotocol.h"
+
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @class GpsSerialWorker
+ * @brief Acquisition série GPS, à déplacer dans un QThread (voir GpsTelemetrySource).
+ * @details Cycle de vie :
+ * - WaitingForDevice : le port n'existe pas ou n'a pas pu être ouvert ; nouvelle tentative à chaque
+ *   modification du répertoire du périphérique (QFileSystemWatcher) et toutes les RetryIntervalMs.
+ * - Probing : chaque débit candidat est écouté ProbeWindowMs ; le premier qui produit MinProbeFrames
+ *   phrases NMEA ou trames UBX intègres est retenu (connected()).
+ * - Streaming : chaque lecture est transmise par dataReceived(). Sans octet reçu pendant StallTimeoutMs
+ *   (récepteur réinitialisé à son débit d'usine), la détection du débit recommence.
+ *
+ * Toutes les méthodes sauf stats() s'exécutent dans le thread du worker (appel en file d'attente).
+ */
+class GpsSerialWorker : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int ProbeWindowMs = 1200;   ///< Écoute d'un débit candidat (≥ une époque NMEA à 1 Hz).
+    static constexpr int MinProbeFrames = 2;     ///< Trames intègres requises pour retenir un débit.
+    static constexpr int StallTimeoutMs = 3000;  ///< Silence au-delà duquel le débit est re-détecté.
+    static constexpr int RetryIntervalMs = 2000; ///< Nouvelle tentative d'ouverture sans notification.
+
+    /**
+     * @struct Stats
+     * @brief Compteurs de la liaison (lisibles depuis n'importe quel thread).
+     */
+    struct Stats {
+        quint64 bytes = 0;       ///< Octets lus sur le port, détection du débit comprise.
+        quint64 reconnects = 0;  ///< Réouvertures après perte du périphérique.
+        quint64 baudProbes = 0;  ///< Débits candidats essayés.
+        int baudRate = 0;        ///< Débit retenu (0 : liaison non établie).
+        bool connected = false;  ///< true en état Streaming.
+    };
+
+    /**
+     * @brief Débits essayés par la détection automatique, dans l'ordre.
+     */
+    static QList<int> candidateBaudRates();
+
+    explicit GpsSerialWorker(QObject* parent = nullptr);
+    ~GpsSerialWorker() override;
+
+    Stats stats() const; ///< Compteurs courants.
+
+public slots:
+    /**
+     * @brief Ouvre le port (ou attend son apparition) puis détecte le débit.
+     * @param portName Chemin du périphérique (ex: "/dev/serial0", "/dev/ttyACM0").
+     * @param preferredBaud Débit essayé en premier (dernier débit connu, 9600 par défaut).
+     */
+    void start(const QString& portName, int preferredBaud = 9600);
+
+    /**
+     * @brief Ferme le port et arrête la surveillance du périphérique.
+     */
+    void stop();
+
+    /**
+     * @brief Écrit des octets vers le récepteur (configuration UBX) ; ignoré hors état Streaming.
+     */
+    void write(const QByteArray& data);
+
+    /**
+     * @brief Change de débit sans re-détection (le récepteur vient d'être reconfiguré).
+     */
+    void setBaudRate(int baud);
+
+    /**
+     * @brief Relance la détection du débit sur le port ouvert (reconfiguration du récepteur sans effet).
+     */
+    void redetectBaudRate();
+
+signals:
+    /**
+     * @brief Débit détecté : la liaison transmet désormais des données.
+     */
+    void connected(int baudRate);
+
+    /**
+     * @brief Liaison perdue.
+     * @param deviceRemoved true si le périphérique a disparu (port fermé, reconnexion en attente),
+     *        false si le récepteur s'est tu (détection du débit relancée sur le port ouvert).
+     */
+    void disconnected(bool deviceRemoved);
+
+    /**
+     * @brief Octets lus sur le port, horodatés à la réception (horloge monotone, ns).
+     */
+    void dataReceived(const QByteArray& data, qint64 timestampNs);
+
+private slots:
+    void tryOpen();
+    void onReadyRead();
+    void onErrorOccurred(QSerialPort::SerialPortError error);
+    void onProbeTimeout();
+    void onStallTimeout();
+
+private:
+    enum class State { Stopped, WaitingForDevice, Probing, Streaming };
+
+    void ensureObjects();
+    void watchDevice();
+    void startProbing();
+    void probeBaud(int baud);
+    void closePort();
+
+    QString m_portName;                        ///< Périphérique surveillé
+    State m_state = State::Stopped;            ///< État de la liaison
+    QSerialPort* m_port = nullptr;             ///< Port série (créé dans le thread du worker)
+    QFileSystemWatcher* m_watcher = nullptr;   ///< Notifications d'apparition du périphérique
+    QTimer* m_retryTimer = nullptr;            ///< Tentatives d'ouverture périodiques
+    QTimer* m_probeTimer = nullptr;            ///< Fin de la fenêtre d'écoute d'un débit
+    QTimer* m_stallTimer = nullptr;            ///< Détection de silence en état Streaming
+    QList<int> m_probeOrder;                   ///< Débits à essayer, le préféré en tête
+    int m_probeIndex = 0;                      ///< Débit candidat courant dans m_probeOrder
+    int m_preferredBaud = 9600;                ///< Débit essayé en premier
+    bool m_everConnected = false;              ///< Distingue une reconnexion d'une première ouverture
+    NmeaParser m_probeNmea;                    ///< Validation des phrases pendant la détection
+    UbxParser m_probeUbx;                      ///< Validation des trames UBX pendant la détection
+    QByteArray m_probeBuffer;                  ///< Octets de la fenêtre d'écoute, transmis si elle réussit
+    char m_readBuffer[1024];                   ///< Tampon de lecture réutilisé
+
+    std::atomic<quint64> m_statBytes{0};       ///< Octets lus
+    std::atomic<quint64> m_statReconnects{0};  ///< Réouvertures
+    std::atomic<quint64> m_statProbes{0};      ///< Débits essayés
+    std::atomic<int> m_statBaud{0};            ///< Débit retenu
+};
+
+#endif // GPSSERIALWORKER_H
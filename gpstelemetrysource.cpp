@@ -1,24 +1,55 @@
 /**
  * @file gpstelemetrysource.cpp
  * @brief Implémentation de la source GPS mat�rielle.
- * @details Responsabilités : Configurer le port série, décoder le flux NMEA en continu
- * et traduire les mesures brutes en télémétrie exploitable par l'interface graphique.
+ * @details Responsabilités : Configurer le port série (et le récepteur en mode UBX), décoder le flux
+ * NMEA ou UBX en continu et traduire les mesures brutes en télémétrie exploitable par l'interface graphique.
  * Dépendances principales : Qt SerialPort, Qt Positioning et TelemetryData.
  */
 
 #include "gpstelemetrysource.h"
 #include "telemetrydata.h"
+#include "gpsrecorder.h"
+#include "gpsserialworker.h"
 #include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+// 28 octets de CFG-PRT à 9600 bauds (≈ 30 ms) plus la bascule du récepteur.
+constexpr int UbxBaudSwitchDelayMs = 150;
+// Au-delà, le module n'émet pas NAV-PVT (u-blox 6 ou antérieur) : repli NMEA.
+constexpr int UbxPvtTimeoutMs = 3000;
+// Configurations UBX tentées par liaison avant de rester en NMEA.
+constexpr int MaxUbxAttempts = 2;
+}
 
 GpsTelemetrySource::GpsTelemetrySource(TelemetryData* data, QObject* parent)
     : QObject(parent), m_data(data)
 {
+    qRegisterMetaType<GpsFix>("GpsFix");
+
     // Initialisation de l'interface série mat�rielle
     m_serial = new QSerialPort(this);
+    // Connecté avant le parseur Qt Positioning (créé par start()) : l'instant est relevé avant le décodage.
+    connect(m_serial, &QSerialPort::readyRead, this, [this]() { m_chunkTimestampNs = TelemetryData::monotonicNowNs(); });
+
+    m_ubxTimer = new QTimer(this);
+    m_ubxTimer->setSingleShot(true);
+    connect(m_ubxTimer, &QTimer::timeout, this, &GpsTelemetrySource::onUbxTimer);
+
+    m_epochTimer = new QTimer(this);
+    m_epochTimer->setSingleShot(true);
+    m_epochTimer->setInterval(NmeaEpochGapMs);
+    connect(m_epochTimer, &QTimer::timeout, this, &GpsTelemetrySource::flushEpoch);
 }
 
 GpsTelemetrySource::~GpsTelemetrySource() {
     stop();
+    if (m_ioThread) {
+        m_ioThread->quit();
+        m_ioThread->wait();
+    }
 }
 
 void GpsTelemetrySource::start(const QString& portName) {
@@ -26,6 +57,42 @@ void GpsTelemetrySource::start(const QString& portName) {
     // s'il �tait déjà ouvert avant toute nouvelle tentative.
     stop();
 
+    if (m_protocol == Protocol::Nmea && m_backend == Backend::QtPositioning) {
+        startQtPositioning(portName);
+        return;
+    }
+
+    // Lecture dans le thread dédié : ouverture (ou attente du périphérique), détection du débit et
+    // reconnexion y sont gérées ; le thread GUI ne reçoit que des blocs d'octets déjà lus.
+    m_parser.reset();
+    m_ubxParser.reset();
+    m_ubxHdop = -1.0;
+    m_ubxAttempts = 0;
+    m_bytesDecoded = 0;
+    if (m_data) m_data->setGpsOk(false);
+
+    if (!m_worker) {
+        m_ioThread = new QThread(this);
+        m_ioThread->setObjectName(QStringLiteral("GpsSerial"));
+        m_worker = new GpsSerialWorker;
+        m_worker->moveToThread(m_ioThread);
+        connect(m_ioThread, &QThread::finished, m_worker, &QObject::deleteLater);
+        connect(m_worker, &GpsSerialWorker::dataReceived, this, &GpsTelemetrySource::onPortData);
+        connect(m_worker, &GpsSerialWorker::connected, this, &GpsTelemetrySource::onPortConnected);
+        connect(m_worker, &GpsSerialWorker::disconnected, this, &GpsTelemetrySource::onPortDisconnected);
+        m_ioThread->start();
+    }
+    GpsSerialWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, portName]() { worker->start(portName); }, Qt::QueuedConnection);
+
+    if (m_protocol == Protocol::Ubx) {
+        qDebug() << "GPS démarré (configuration UBX" << m_ubxRateHz << "Hz) sur" << portName;
+    } else {
+        qDebug() << "GPS démarré (décodeur NMEA natif) sur" << portName;
+    }
+}
+
+void GpsTelemetrySource::startQtPositioning(const QString& portName) {
     // Configuration de la connexion physique au module GPS (ex: NEO-6M)
     m_serial->setPortName(portName);
     m_serial->setBaudRate(QSerialPort::Baud9600); // 9600 bauds est le standard industriel NMEA par défaut
@@ -51,6 +118,11 @@ void GpsTelemetrySource::start(const QString& portName) {
 }
 
 void GpsTelemetrySource::stop() {
+    m_ubxTimer->stop();
+    m_ubxStage = UbxStage::Idle;
+    m_epochTimer->stop();
+    m_epochOpen = false;
+
     // L'arrêt explicite du parseur et la suppression de l'objet évitent
     // des callbacks fantômes lors des changements d'état de l'application.
     if (m_nmeaSource) {
@@ -59,46 +131,292 @@ void GpsTelemetrySource::stop() {
         m_nmeaSource = nullptr;
     }
 
+    // Appel bloquant : au retour, le port est fermé et un start() peut le rouvrir sans conflit.
+    if (m_worker) {
+        GpsSerialWorker* worker = m_worker;
+        QMetaObject::invokeMethod(worker, [worker]() { worker->stop(); }, Qt::BlockingQueuedConnection);
+    }
+    m_portConnected = false;
+
     // Lib�ration mat�rielle du port série
     if (m_serial->isOpen()) {
         m_serial->close();
     }
 }
 
+void GpsTelemetrySource::onPortData(const QByteArray& data, qint64 timestampNs) {
+    if (m_recorder) m_recorder->record(data.constData(), data.size(), timestampNs);
+    ingest(data.constData(), data.size(), timestampNs);
+}
+
+void GpsTelemetrySource::onPortConnected(int baudRate) {
+    m_portConnected = true;
+    if (m_protocol != Protocol::Ubx) return;
+
+    if (m_ubxAttempts >= MaxUbxAttempts) {
+        // Le récepteur ignore la configuration : on reste en NMEA au débit détecté.
+        qWarning() << "GPS UBX : configuration sans effet, décodage NMEA à" << baudRate << "bauds";
+        m_ubxStage = UbxStage::Fallback;
+        return;
+    }
+
+    // Le module démarre en NMEA à 9600 bauds, ou est resté à 115200 si l'application a redémarré
+    // sans coupure d'alimentation : CFG-PRT est envoyé au débit détecté, puis renvoyé au nouveau débit.
+    ++m_ubxAttempts;
+    sendToReceiver(UbxProtocol::cfgPrtUart(UbxProtocol::NavigationBaud));
+    m_ubxStage = UbxStage::SwitchingBaud;
+    m_ubxTimer->start(UbxBaudSwitchDelayMs);
+}
+
+void GpsTelemetrySource::onPortDisconnected(bool deviceRemoved) {
+    m_portConnected = false;
+    m_ubxTimer->stop();
+    m_ubxStage = UbxStage::Idle;
+    // Nouveau périphérique (ou module remis sous tension) : la configuration UBX est retentée.
+    if (deviceRemoved) m_ubxAttempts = 0;
+    if (m_data) m_data->setGpsOk(false);
+}
+
+void GpsTelemetrySource::sendToReceiver(const QByteArray& frame) {
+    if (!m_worker) return;
+    GpsSerialWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, frame]() { worker->write(frame); }, Qt::QueuedConnection);
+}
+
+quint64 GpsTelemetrySource::validFrames() const {
+    return m_parser.stats().sentences + m_parser.stats().ignored + m_ubxParser.stats().frames;
+}
+
+GpsTelemetrySource::IngestionStats GpsTelemetrySource::ingestionStats() const {
+    IngestionStats stats;
+    if (m_worker) {
+        const GpsSerialWorker::Stats link = m_worker->stats();
+        stats.bytesRead = link.bytes;
+        stats.reconnects = link.reconnects;
+        stats.baudRate = link.baudRate;
+        stats.connected = link.connected;
+    }
+    stats.bytesDecoded = m_bytesDecoded;
+    stats.sentences = m_parser.stats().sentences;
+    stats.ubxFrames = m_ubxParser.stats().frames;
+    stats.checksumErrors = m_parser.stats().checksumErrors + m_ubxParser.stats().checksumErrors;
+    return stats;
+}
+
+void GpsTelemetrySource::setUbxRateHz(int hz) {
+    m_ubxRateHz = std::clamp(hz, UbxProtocol::MinRateHz, UbxProtocol::MaxRateHz);
+}
+
+void GpsTelemetrySource::ingest(const char* data, qint64 size, qint64 timestampNs) {
+    if (size <= 0) return;
+    m_bytesDecoded += quint64(size);
+    // Relevé par le thread de lecture (ou enregistré, au rejeu) : l'attente dans la boucle d'événements
+    // du thread GUI n'entre pas dans l'âge du fix.
+    m_chunkTimestampNs = timestampNs >= 0 ? timestampNs : TelemetryData::monotonicNowNs();
+    const std::size_t length = static_cast<std::size_t>(size);
+    if (m_protocol == Protocol::Ubx) {
+        m_ubxParser.feed(data, length,
+                         [this](quint8 msgClass, quint8 msgId, const quint8* payload, std::size_t n) {
+                             onUbxFrame(msgClass, msgId, payload, n);
+                         });
+    }
+    // Tant qu'aucune NAV-PVT n'est arrivée, les phrases NMEA encore émises restent exploitées.
+    if (m_ubxStage != UbxStage::Active) {
+        m_parser.feed(data, length,
+                      [this](NmeaParser::Sentence sentence) { onNmeaSentence(sentence); });
+    }
+}
+
+void GpsTelemetrySource::onUbxTimer() {
+    if (!m_portConnected) return;
+
+    if (m_ubxStage == UbxStage::SwitchingBaud) {
+        // CFG-PRT est répété au nouveau débit pour le cas où le module y était déjà.
+        GpsSerialWorker* worker = m_worker;
+        QMetaObject::invokeMethod(worker, [worker]() { worker->setBaudRate(UbxProtocol::NavigationBaud); },
+                                  Qt::QueuedConnection);
+        sendToReceiver(UbxProtocol::cfgPrtUart(UbxProtocol::NavigationBaud));
+        for (const QByteArray& frame : UbxProtocol::navigationSetup(m_ubxRateHz)) {
+            sendToReceiver(frame);
+        }
+        m_ubxSwitchFrames = validFrames();
+        m_ubxStage = UbxStage::AwaitingPvt;
+        m_ubxTimer->start(UbxPvtTimeoutMs);
+    } else if (m_ubxStage == UbxStage::AwaitingPvt) {
+        if (validFrames() == m_ubxSwitchFrames) {
+            // Rien d'intelligible à 115200 bauds : le module n'a pas changé de débit. Le worker
+            // retrouve l'ancien débit et la liaison repart directement en NMEA.
+            qWarning() << "GPS UBX : débit inchangé par le récepteur, nouvelle détection du débit";
+            m_ubxAttempts = MaxUbxAttempts;
+            m_ubxStage = UbxStage::Idle;
+            GpsSerialWorker* worker = m_worker;
+            QMetaObject::invokeMethod(worker, [worker]() { worker->redetectBaudRate(); }, Qt::QueuedConnection);
+            return;
+        }
+        qWarning() << "GPS UBX : aucune trame NAV-PVT, repli sur les phrases NMEA à"
+                   << UbxProtocol::NavigationBaud << "bauds";
+        for (const QByteArray& frame : UbxProtocol::nmeaFallback()) {
+            sendToReceiver(frame);
+        }
+        m_ubxStage = UbxStage::Fallback;
+    }
+}
+
+void GpsTelemetrySource::onUbxFrame(quint8 msgClass, quint8 msgId, const quint8* payload, std::size_t length) {
+    if (msgClass == UbxProtocol::ClassNav && msgId == UbxProtocol::IdNavDop) {
+        UbxProtocol::decodeNavDopHdop(payload, length, m_ubxHdop);
+        return;
+    }
+    if (msgClass == UbxProtocol::ClassAck && msgId == UbxProtocol::IdAckNak && length >= 2) {
+        qWarning() << "GPS UBX : configuration refusée (classe" << Qt::hex << int(payload[0])
+                   << "id" << int(payload[1]) << ")";
+        return;
+    }
+    if (msgClass != UbxProtocol::ClassNav || msgId != UbxProtocol::IdNavPvt) return;
+
+    UbxNavPvt pvt;
+    if (!UbxProtocol::decodeNavPvt(payload, length, pvt)) return;
+
+    if (m_ubxStage != UbxStage::Active) {
+        // Première solution binaire : le décodeur NMEA n'est plus alimenté (sa dernière époque part avant).
+        flushEpoch();
+        m_ubxStage = UbxStage::Active;
+        m_ubxAttempts = 0;
+        m_ubxTimer->stop();
+    }
+
+    // Une trame NAV-PVT = une époque complète : position, vitesse, route et précision d'un seul tenant.
+    GpsFix fix;
+    fix.valid = pvt.positionValid();
+    fix.timestampNs = m_chunkTimestampNs;
+    fix.satellites = pvt.satellites;
+    fix.hdop = m_ubxHdop;
+    if (fix.valid) {
+        fix.lat = pvt.lat;
+        fix.lon = pvt.lon;
+        fix.hasSpeed = true;
+        fix.speedMs = pvt.groundSpeedMs;
+        fix.hasCourse = true;
+        fix.courseDeg = pvt.headingMotionDeg;
+        fix.horizontalAccuracyM = pvt.horizontalAccuracyM;
+    }
+    handleFix(fix);
+}
+
+void GpsTelemetrySource::onNmeaSentence(NmeaParser::Sentence sentence) {
+    // Une époque = un fix : l'époque précédente n'est complète (RMC, GGA, GSA, GSV, dans l'ordre du
+    // récepteur) qu'à la première phrase horodatée d'une autre seconde. Une phrase sans heure (GSA,
+    // GSV) rejoint l'époque en cours.
+    const NmeaFix& current = m_parser.fix();
+    const bool timed = sentence == NmeaParser::RMC || sentence == NmeaParser::GGA;
+    if (m_epochOpen && m_epochTimed && timed && current.timeMs != m_epochFix.timeMs) flushEpoch();
+
+    if (!m_epochOpen) {
+        m_epochOpen = true;
+        m_epochTimed = false;
+    }
+    if (timed && !m_epochTimed) {
+        // La position arrive avec la première phrase horodatée : c'est elle qui date le fix.
+        m_epochTimed = true;
+        m_epochTimestampNs = m_chunkTimestampNs;
+    }
+    m_epochFix = current;
+    m_epochTimer->start();
+}
+
+void GpsTelemetrySource::flushEpoch() {
+    m_epochTimer->stop();
+    if (!m_epochOpen) return;
+    m_epochOpen = false;
+    // Phrases sans heure ni position seules (GSV après une coupure) : rien de neuf à publier.
+    if (!m_epochTimed) return;
+
+    const NmeaFix& nmea = m_epochFix;
+    GpsFix fix;
+    fix.valid = nmea.valid;
+    fix.timestampNs = m_epochTimestampNs;
+    fix.satellites = nmea.satellitesUsed;
+    fix.hdop = nmea.hdop;
+    if (fix.valid) {
+        fix.lat = nmea.lat;
+        fix.lon = nmea.lon;
+        fix.hasSpeed = nmea.hasSpeed;
+        fix.speedMs = nmea.speedMs;
+        fix.hasCourse = nmea.hasCourse;
+        fix.courseDeg = nmea.courseDeg;
+    }
+    handleFix(fix);
+}
+
 void GpsTelemetrySource::onPositionUpdated(const QGeoPositionInfo &info) {
+    // Décodeur Qt Positioning : ni satellites ni HDOP ne sont disponibles.
+    GpsFix fix;
+    fix.valid = info.isValid();
+    fix.timestampNs = m_nmeaSource && m_chunkTimestampNs >= 0 ? m_chunkTimestampNs : TelemetryData::monotonicNowNs();
+    if (fix.valid) {
+        fix.lat = info.coordinate().latitude();
+        fix.lon = info.coordinate().longitude();
+        fix.hasSpeed = info.hasAttribute(QGeoPositionInfo::GroundSpeed);
+        if (fix.hasSpeed) fix.speedMs = info.attribute(QGeoPositionInfo::GroundSpeed);
+        fix.hasCourse = info.hasAttribute(QGeoPositionInfo::Direction);
+        if (fix.hasCourse) fix.courseDeg = info.attribute(QGeoPositionInfo::Direction);
+    }
+    handleFix(fix);
+}
+
+void GpsTelemetrySource::handleFix(const GpsFix& fix) {
+    // Le fix horodaté part vers les étages de fusion avant tout filtrage d'affichage.
+    emit fixReceived(fix);
+
     if (!m_data) return;
 
-    if (info.isValid()) {
-        // Le module GPS "fixe" les satellites (position 3D valid�e)
-        m_data->setGpsOk(true);
+    // Qualité de réception : publiée avec ou sans fix (utile pendant la recherche de satellites).
+    TelemetryData::Fields quality;
+    if (fix.satellites >= 0) quality |= TelemetryData::SatellitesField;
+    if (fix.hdop >= 0.0) quality |= TelemetryData::HdopField;
 
-        QGeoCoordinate coord = info.coordinate();
-        m_data->setLat(coord.latitude());
-        m_data->setLon(coord.longitude());
+    if (fix.valid) {
+        // Le module GPS "fixe" les satellites (position 3D validée).
+        // Tous les champs du fix sont regroupés dans un seul instantané : un fix NMEA
+        // ne produit ainsi qu'une seule notification snapshotChanged côté interface.
+        TelemetrySnapshot update;
+        TelemetryData::Fields fields = TelemetryData::GpsOkField | TelemetryData::PositionFields;
+        update.gpsOk = true;
+        update.satellites = fix.satellites;
+        update.hdop = fix.hdop;
+
+        update.lat = fix.lat;
+        update.lon = fix.lon;
 
         // Extraction de la vitesse (si la trame NMEA RMC ou VTG la fournit)
-        double speedMs = 0.0;
-        if (info.hasAttribute(QGeoPositionInfo::GroundSpeed)) {
-            speedMs = info.attribute(QGeoPositionInfo::GroundSpeed); // En m�tres par seconde
-            m_data->setSpeedKmh(speedMs * 3.6); // Conversion en km/h pour l'affichage tableau de bord
+        if (fix.hasSpeed) {
+            update.speedKmh = fix.speedMs * 3.6; // Conversion en km/h pour l'affichage tableau de bord
+            fields |= TelemetryData::SpeedKmhField;
         }
 
         // Extraction du cap (Direction)
-        if (info.hasAttribute(QGeoPositionInfo::Direction)) {
-            double course = info.attribute(QGeoPositionInfo::Direction);
-
+        if (fix.hasCourse) {
             // LOGIQUE M�TIER CRITIQUE :
             // Sous une faible vitesse, le calcul de cap (Heading) par le GPS devient erratique
             // car le module ne peut plus d�terminer l'avant de l'arri�re.
             // On applique un seuil (3 km/h) pour éviter que la carte GPS ne pivote brutalement
             // dans tous les sens lorsque le v�hicule est arrêt� � un feu rouge.
-            /*if (speedMs * 3.6 > 3.0) {
-                m_data->setHeading(course);
+            /*if (fix.speedMs * 3.6 > 3.0) {
+                m_data->setHeading(fix.courseDeg);
             }*/
         }
+
+        // Position et vitesse publiées par l'étage de fusion : seul l'état du fix reste ici.
+        if (!m_publishPosition) fields = TelemetryData::GpsOkField;
+
+        m_data->publish(TelemetryData::GpsSource, update, fields | quality);
     } else {
         // Le GPS est allum� mais cherche encore ses satellites (Cold/Warm start)
-        m_data->setGpsOk(false);
+        TelemetrySnapshot update;
+        update.gpsOk = false;
+        update.satellites = fix.satellites;
+        update.hdop = fix.hdop;
+        m_data->publish(TelemetryData::GpsSource, update, quality | TelemetryData::GpsOkField);
         qDebug() << "GPS : En attente de satellites (No Fix)...";
     }
 }
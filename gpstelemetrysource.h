@@ -3,7 +3,8 @@
  * @brief Rôle architectural : Source de télémétrie GPS branchée sur un flux NMEA série.
  * @details Responsabilités : Démarrer/arrêter la lecture sur le port série matériel
  * et publier les mises à jour de position (latitude, longitude, vitesse, cap) vers le bus TelemetryData.
- * Dépendances principales : QSerialPort, QNmeaPositionInfoSource et QGeoPositionInfo.
+ * Dépendances principales : GpsSerialWorker (lecture série dans un thread dédié), NmeaParser
+ * (décodage natif), UbxParser (mode binaire u-blox) et, en repli, QNmeaPositionInfoSource / QGeoPositionInfo.
  */
 
 #pragma once
@@ -11,19 +12,69 @@
 #include <QSerialPort>
 #include <QNmeaPositionInfoSource>
 #include <QGeoPositionInfo>
+#include "gpsfix.h"
+#include "nmeaparser.h"
+#include "ubxprotocol.h"
 
 class TelemetryData;
+class GpsRecorder;
+class GpsSerialWorker;
+class QThread;
+class QTimer;
 
 /**
  * @class GpsTelemetrySource
  * @brief Contrôleur matériel d'acquisition GPS.
  * Écoute un port série physique (ex: GPIO du Raspberry Pi ou USB).
- * Utilise le moteur Qt Positioning pour parser les trames NMEA standard (GPGGA, GPRMC, etc.).
+ * Le port est lu par un GpsSerialWorker dans son propre thread : débit détecté automatiquement
+ * (9600, 38400 ou 115200 bauds) et réouverture dès que le périphérique réapparaît, sans redémarrer
+ * l'application. Les trames NMEA standard (GGA, RMC, VTG, GSA, GSV) sont décodées par NmeaParser
+ * dans le thread GUI ; le moteur Qt Positioning reste disponible en repli (Backend::QtPositioning,
+ * lecture directe sans reconnexion).
+ * En mode Protocol::Ubx, le récepteur u-blox est reconfiguré (115200 bauds, 5 à 10 Hz, NMEA coupé)
+ * et chaque solution binaire NAV-PVT est publiée directement.
  * Filtre et transmet les données propres au modèle de télémétrie global de l'application.
  */
 class GpsTelemetrySource : public QObject {
     Q_OBJECT
 public:
+    /**
+     * @brief Décodeur NMEA utilisé pour le flux série.
+     */
+    enum class Backend {
+        Native,       ///< NmeaParser : sans allocation par phrase, satellites et HDOP publiés (par défaut).
+        QtPositioning ///< QNmeaPositionInfoSource : un QGeoPositionInfo par phrase, sans satellites ni HDOP.
+    };
+
+    /**
+     * @brief Protocole demandé au récepteur.
+     */
+    enum class Protocol {
+        Nmea, ///< Flux NMEA d'usine à 9600 bauds (≈ 1 Hz avec toutes les phrases ; par défaut).
+        Ubx   ///< Récepteur u-blox (protocole 15+) configuré en NAV-PVT binaire à 115200 bauds.
+    };
+
+    /**
+     * @struct IngestionStats
+     * @brief Compteurs de la chaîne d'acquisition, du port aux décodeurs.
+     */
+    struct IngestionStats {
+        quint64 bytesRead = 0;       ///< Octets lus sur le port (détection du débit comprise).
+        quint64 bytesDecoded = 0;    ///< Octets passés aux décodeurs (port ou rejeu).
+        quint64 sentences = 0;       ///< Phrases NMEA décodées.
+        quint64 ubxFrames = 0;       ///< Trames UBX intègres.
+        quint64 checksumErrors = 0;  ///< Phrases NMEA et trames UBX rejetées (somme de contrôle).
+        quint64 reconnects = 0;      ///< Réouvertures du port après perte du périphérique.
+        int baudRate = 0;            ///< Débit courant (0 : liaison non établie).
+        bool connected = false;      ///< true quand le port transmet des données.
+    };
+
+    /**
+     * @brief Silence du flux au-delà duquel l'époque NMEA en cours est close (ms).
+     * @details Un récepteur émet les phrases d'une époque d'une traite puis se tait jusqu'à la suivante.
+     */
+    static constexpr int NmeaEpochGapMs = 50;
+
     /**
      * @brief Constructeur de la source GPS.
      * @param data Pointeur vers le modèle de télémétrie partagé à mettre à jour.
@@ -38,7 +89,8 @@ public:
 
     /**
      * @brief Démarre l'acquisition des données GPS.
-     * Configure le port série (baudrate) et lance le parsing NMEA en temps réel.
+     * Ouvre le port dans le thread de lecture (ou attend son apparition), détecte le débit puis
+     * décode le flux en temps réel. gpsOk reste à false tant que la liaison n'est pas établie.
      * @param portName Le nom du port matériel (ex: "/dev/serial0" sur RPi, ou "COM3" sur Windows).
      */
     void start(const QString& portName = "/dev/serial0");
@@ -48,7 +100,103 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Active ou non la publication de la position et de la vitesse vers TelemetryData.
+     * @details Désactivé lorsqu'un étage de fusion (DeadReckoning) publie sa propre position :
+     * la source ne publie alors plus que l'état du fix (gpsOk), mais émet toujours fixReceived().
+     * @param enabled true par défaut.
+     */
+    void setPublishPosition(bool enabled) { m_publishPosition = enabled; }
+
+    /**
+     * @brief Choisit le décodeur NMEA (pris en compte au prochain start()).
+     */
+    void setBackend(Backend backend) { m_backend = backend; }
+    Backend backend() const { return m_backend; } ///< Décodeur choisi.
+
+    /**
+     * @brief Choisit le protocole du récepteur (pris en compte au prochain start()).
+     * @details En mode Ubx, le décodage NMEA est toujours natif (le Backend est ignoré) : il sert
+     * pendant la reconfiguration et en repli si le récepteur n'émet pas de NAV-PVT.
+     */
+    void setProtocol(Protocol protocol) { m_protocol = protocol; }
+    Protocol protocol() const { return m_protocol; } ///< Protocole choisi.
+
+    /**
+     * @brief Cadence de navigation demandée en mode Ubx, bornée à [5, 10] Hz (10 Hz par défaut).
+     */
+    void setUbxRateHz(int hz);
+    int ubxRateHz() const { return m_ubxRateHz; } ///< Cadence de navigation demandée.
+
+    /**
+     * @brief Injecte des octets bruts dans le décodeur natif (lecture série, rejeu, tests).
+     * @details En mode Ubx, les octets passent par UbxParser ; le décodeur NMEA ne les reçoit plus
+     * dès la première solution NAV-PVT.
+     * @param data Octets reçus, éventuellement coupés au milieu d'une phrase.
+     * @param size Nombre d'octets.
+     * @param timestampNs Instant de réception des octets (horloge monotone), porté par les fix dont ils
+     * apportent la position (RMC/GGA, NAV-PVT) ; -1 : instant de l'appel.
+     */
+    void ingest(const char* data, qint64 size, qint64 timestampNs = -1);
+
+    /**
+     * @brief Publie sans attendre l'époque NMEA en cours (fin d'un journal rejoué, tests).
+     * @details Sans effet si aucune RMC ou GGA n'attend ; en flux continu, l'époque est close par le
+     * changement d'heure UTC ou après NmeaEpochGapMs de silence.
+     */
+    void flushEpoch();
+
+    /**
+     * @brief Compteurs du décodeur natif (phrases décodées, erreurs de somme de contrôle...).
+     */
+    const NmeaParser::Stats& parserStats() const { return m_parser.stats(); }
+
+    /**
+     * @brief Compteurs du décodeur UBX (trames intègres, erreurs de somme de Fletcher...).
+     */
+    const UbxParser::Stats& ubxStats() const { return m_ubxParser.stats(); }
+
+    /**
+     * @brief Compteurs d'octets, de phrases, d'erreurs et de reconnexions (thread GUI).
+     */
+    IngestionStats ingestionStats() const;
+
+    /**
+     * @brief Recopie chaque bloc lu sur le port série dans un enregistrement horodaté (nullptr : aucun).
+     * @details Seuls les octets du port sont enregistrés, pas ceux passés à ingest() par un rejeu.
+     * @param recorder Enregistreur ouvert, non possédé par la source.
+     */
+    void setRecorder(GpsRecorder* recorder) { m_recorder = recorder; }
+
+signals:
+    /**
+     * @brief Émis pour chaque position décodée (valide ou non), horodatée à la réception de la phrase ou
+     * trame qui la porte, sur l'horloge monotone (et non à la fin du décodage ni de l'époque).
+     * @param fix Fix GNSS complet (vitesse et route incluses si disponibles).
+     */
+    void fixReceived(const GpsFix& fix);
+
 private slots:
+    /**
+     * @brief Octets reçus par le thread de lecture : enregistrement éventuel puis décodage.
+     */
+    void onPortData(const QByteArray& data, qint64 timestampNs);
+
+    /**
+     * @brief Liaison établie au débit détecté ; lance la configuration UBX si elle est demandée.
+     */
+    void onPortConnected(int baudRate);
+
+    /**
+     * @brief Liaison perdue : gpsOk passe à false jusqu'à la prochaine liaison.
+     */
+    void onPortDisconnected(bool deviceRemoved);
+
+    /**
+     * @brief Étape suivante de la configuration UBX (passage à 115200 bauds, puis délai de repli NMEA).
+     */
+    void onUbxTimer();
+
     /**
      * @brief Slot déclenché automatiquement par Qt chaque fois qu'une trame GPS valide est décodée.
      * Extrait les coordonnées, la vitesse et le cap, puis les injecte dans TelemetryData.
@@ -57,8 +205,76 @@ private slots:
     void onPositionUpdated(const QGeoPositionInfo &info);
 
 private:
+    /**
+     * @brief Appelé après chaque phrase décodée par NmeaParser ; publie le fix en fin d'époque.
+     * @details L'ordre des phrases varie d'un récepteur à l'autre (u-blox émet RMC en tête, avant
+     * GGA/GSA/GSV) : une époque se termine quand une RMC ou une GGA porte une nouvelle heure UTC, ou
+     * après NmeaEpochGapMs sans octet. L'état accumulé est mémorisé après chaque phrase, pour publier
+     * l'époque précédente telle qu'elle était avant la phrase qui ouvre la suivante.
+     */
+    void onNmeaSentence(NmeaParser::Sentence sentence);
+
+    /**
+     * @brief Appelé pour chaque trame UBX intègre : NAV-PVT publie un fix, NAV-DOP met à jour le HDOP.
+     */
+    void onUbxFrame(quint8 msgClass, quint8 msgId, const quint8* payload, std::size_t length);
+
+    /**
+     * @brief Traitement commun aux deux décodeurs : émission de fixReceived() et publication télémétrie.
+     */
+    void handleFix(const GpsFix& fix);
+
+    /**
+     * @brief Ancien chemin Backend::QtPositioning : port ouvert et lu dans le thread GUI, sans reconnexion.
+     */
+    void startQtPositioning(const QString& portName);
+
+    /**
+     * @brief Transmet une trame de configuration au récepteur (via le thread de lecture).
+     */
+    void sendToReceiver(const QByteArray& frame);
+
+    /**
+     * @brief Phrases NMEA et trames UBX intègres reçues depuis start().
+     */
+    quint64 validFrames() const;
+
     // --- ATTRIBUTS ---
     TelemetryData* m_data = nullptr;                ///< Référence au modèle de données partagé.
-    QSerialPort* m_serial = nullptr;                ///< Interface matérielle série UART/USB.
+    QSerialPort* m_serial = nullptr;                ///< Port lu directement par Backend::QtPositioning.
+    QThread* m_ioThread = nullptr;                  ///< Thread de lecture série.
+    GpsSerialWorker* m_worker = nullptr;            ///< Lecture série (vit dans m_ioThread).
+    bool m_portConnected = false;                   ///< true entre connected() et disconnected() du worker.
+    quint64 m_bytesDecoded = 0;                     ///< Octets passés aux décodeurs.
+    qint64 m_chunkTimestampNs = -1;                 ///< Instant de réception des octets en cours de décodage.
+    NmeaFix m_epochFix;                             ///< État NMEA de l'époque en cours (après sa dernière phrase).
+    bool m_epochOpen = false;                       ///< true si une époque NMEA attend sa publication.
+    bool m_epochTimed = false;                      ///< true si l'époque en cours contient une RMC ou une GGA.
+    qint64 m_epochTimestampNs = -1;                 ///< Réception de la première RMC/GGA de l'époque en cours.
+    QTimer* m_epochTimer = nullptr;                 ///< Silence qui clôt l'époque NMEA (mono-coup).
     QNmeaPositionInfoSource* m_nmeaSource = nullptr; ///< Parseur de trames NMEA intégré à Qt.
+    bool m_publishPosition = true;                  ///< false : position publiée par l'étage de fusion.
+    Backend m_backend = Backend::Native;            ///< Décodeur choisi pour le prochain start().
+    NmeaParser m_parser;                            ///< Décodeur NMEA natif.
+
+    /**
+     * @brief Avancement de la configuration du récepteur en mode Ubx.
+     */
+    enum class UbxStage {
+        Idle,          ///< Mode Nmea, ou port fermé.
+        SwitchingBaud, ///< CFG-PRT envoyé à 9600 bauds, attente avant de passer à 115200.
+        AwaitingPvt,   ///< Configuration envoyée, attente de la première trame NAV-PVT.
+        Active,        ///< NAV-PVT reçu : seul le décodeur UBX est alimenté.
+        Fallback       ///< Aucune NAV-PVT : phrases NMEA réactivées, décodage NMEA à 115200 bauds.
+    };
+
+    Protocol m_protocol = Protocol::Nmea;           ///< Protocole choisi pour le prochain start().
+    int m_ubxRateHz = UbxProtocol::MaxRateHz;       ///< Cadence de navigation demandée (Hz).
+    UbxParser m_ubxParser;                          ///< Décodeur de trames UBX.
+    UbxStage m_ubxStage = UbxStage::Idle;           ///< Avancement de la configuration UBX.
+    QTimer* m_ubxTimer = nullptr;                   ///< Délais de la configuration UBX (mono-coup).
+    double m_ubxHdop = -1.0;                        ///< Dernier HDOP reçu par NAV-DOP (-1 : inconnu).
+    int m_ubxAttempts = 0;                          ///< Configurations UBX sans NAV-PVT depuis la dernière liaison.
+    quint64 m_ubxSwitchFrames = 0;                  ///< validFrames() au passage à 115200 bauds.
+    GpsRecorder* m_recorder = nullptr;              ///< Enregistrement du flux série brut (optionnel).
 };
@@ -0,0 +1,27 @@
+/**
+ * @file imusample.h
+ * @brief Rôle architectural : Format commun d'un échantillon inertiel 9 axes déjà calibré.
+ * @details Responsabilités : Découpler l'acquisition matérielle (registres I2C du MPU9250)
+ * des algorithmes de fusion, qui ne manipulent que des grandeurs physiques alignées sur le repère NED.
+ * Dépendances principales : aucune (structure POD).
+ */
+
+#ifndef IMUSAMPLE_H
+#define IMUSAMPLE_H
+
+#include <cstdint>
+
+/**
+ * @struct ImuSample
+ * @brief Mesure inertielle calibrée, exprimée dans le repère NED (Nord-Est-Bas) du filtre de fusion.
+ */
+struct ImuSample {
+    float ax = 0.0f, ay = 0.0f, az = 0.0f;  ///< Accélération (en g).
+    float gx = 0.0f, gy = 0.0f, gz = 0.0f;  ///< Vitesse angulaire, biais retiré (en rad/s).
+    float mx = 0.0f, my = 0.0f, mz = 0.0f;  ///< Champ magnétique, Hard/Soft Iron corrigés (unités brutes).
+    float dt = 0.0f;                        ///< Temps écoulé depuis l'échantillon précédent (en s).
+    bool magValid = false;                  ///< false si le magnétomètre n'avait pas de nouvelle donnée.
+    std::int64_t timestampNs = 0;           ///< Instant d'acquisition (horloge monotone, ns).
+};
+
+#endif // IMUSAMPLE_H
@@ -17,7 +17,14 @@
 #include <QNetworkProxyFactory>
 #include <QDir>
 #include <QCoreApplication>
+#include <QDebug>
 #include "mpu9250source.h"
+#include "deadreckoning.h"
+#include "gpsrecorder.h"
+#include "gpsreplaysource.h"
+#include "triplogwriter.h"
+#include "routepolylineitem.h"
+#include <QQmlEngine>
 
 int main(int argc, char *argv[]) {
     // --- 1. CONFIGURATION SYSTÈME ET GRAPHIQUE ---
@@ -77,6 +84,10 @@ int main(int argc, char *argv[]) {
     // Utilisation du style Fusion comme base (tr�s flexible pour le mode sombre)
     QQuickStyle::setStyle("Fusion");
 
+    // Tracé de l'itinéraire dessiné directement dans le graphe de scène (RoutePolyline, module InterfaceGPS),
+    // enregistré une seule fois avant le chargement de map.qml
+    qmlRegisterType<RoutePolylineItem>("InterfaceGPS", 1, 0, "RoutePolyline");
+
     // --- 4. CONFIGURATION DES LOGS ET RÉSEAU ---
 
     QLoggingCategory::setFilterRules(
@@ -103,20 +114,83 @@ int main(int argc, char *argv[]) {
     // Le "Single Source of Truth" (Modèle de donn�es central)
     TelemetryData telemetry;
 
+    // Navigation à l'estime GPS/IMU : c'est elle qui publie la position affichée (30 Hz),
+    // le GPS ne publie plus que l'état du fix et alimente l'estimateur.
+    DeadReckoning deadReckoning(&telemetry);
+    deadReckoning.setOutputRateHz(30);
+
     // Initialisation du GPS (Port Série)
     GpsTelemetrySource gpsSource(&telemetry);
+    gpsSource.setPublishPosition(false);
+    QObject::connect(&gpsSource, &GpsTelemetrySource::fixReceived,
+                     &deadReckoning, &DeadReckoning::onGpsFix);
+
+    // Banc de test sans récepteur : GPS_REPLAY_FILE=<journal> rejoue un enregistrement (ou un flux
+    // NMEA/UBX brut) à la place du port série, GPS_REPLAY_SPEED=<facteur> l'accélère (0 : sans attente).
+    // GPS_RECORD_FILE=<fichier> enregistre le flux série horodaté pour un rejeu ultérieur.
+    GpsRecorder gpsRecorder;
+    GpsReplaySource gpsReplay(&gpsSource);
+    const QString replayPath = QString::fromLocal8Bit(qgetenv("GPS_REPLAY_FILE"));
+    const QString recordPath = QString::fromLocal8Bit(qgetenv("GPS_RECORD_FILE"));
+    if (!replayPath.isEmpty()) {
+        bool speedOk = false;
+        const double replaySpeed = QString::fromLocal8Bit(qgetenv("GPS_REPLAY_SPEED")).toDouble(&speedOk);
+        gpsReplay.setSpeed(speedOk ? replaySpeed : 1.0);
+        if (gpsReplay.open(replayPath)) {
+            if (gpsReplay.containsUbx()) gpsSource.setProtocol(GpsTelemetrySource::Protocol::Ubx);
+            gpsReplay.start();
+            qDebug() << "GPS : rejeu de" << replayPath << "(" << gpsReplay.chunkCount() << "blocs)";
+        } else {
+            qWarning() << "GPS : journal illisible" << replayPath;
+        }
+    } else {
+        if (!recordPath.isEmpty() && gpsRecorder.open(recordPath)) gpsSource.setRecorder(&gpsRecorder);
 #ifdef Q_OS_LINUX
-    gpsSource.start("/dev/serial0");:;:
+        // Récepteurs u-blox de la flotte : NAV-PVT binaire à 10 Hz et 115200 bauds
+        // (repli automatique sur NMEA si le module n'émet pas NAV-PVT).
+        gpsSource.setProtocol(GpsTelemetrySource::Protocol::Ubx);
+        gpsSource.setUbxRateHz(10);
+        gpsSource.start("/dev/serial0");
 #else
-    gpsSource.start("COM1");
+        gpsSource.start("COM1");
 #endif
+    }
+
+    // TRIP_LOG_FILE=<fichier> : journal de trajet binaire (GPS, IMU, cap, itinéraires, pages),
+    // écrit en tâche de fond et relu après coup avec TripLogReader.
+    TripLogWriter tripLog;
+    const QString tripLogPath = QString::fromLocal8Bit(qgetenv("TRIP_LOG_FILE"));
+    if (!tripLogPath.isEmpty()) {
+        if (tripLog.open(tripLogPath)) {
+            QObject::connect(&gpsSource, &GpsTelemetrySource::fixReceived, &tripLog, &TripLogWriter::logGpsFix);
+        } else {
+            qWarning() << "Journal de trajet : création impossible" << tripLogPath;
+        }
+    }
 
     // Initialisation de la Centrale inertielle (IMU)
+    // Sous Linux, l'acquisition tourne dans son propre thread à 100 Hz (échéances absolues, SCHED_FIFO
+    // si les droits le permettent) ; le cap n'est publié vers l'interface qu'à 20 Hz.
     Mpu9250Source mpuSource(&telemetry);
+#ifdef Q_OS_LINUX
+    mpuSource.setAcquisitionMode(Mpu9250Source::AcquisitionMode::Thread);
+    mpuSource.setSampleRateHz(100);
+    mpuSource.setPublishRateHz(20);
+    mpuSource.setRealtimePriority(true);
+    mpuSource.setReadMode(Mpu9250Source::ReadMode::FifoBurst);
+#endif
+    mpuSource.setMotionSink(&deadReckoning);
+    if (tripLog.isOpen()) mpuSource.setTripLog(&tripLog);
     mpuSource.start();
+    deadReckoning.start();
 
     // Démarrage de l'IHM avec injection de la télémétrie
     MainWindow w(&telemetry);
+    if (tripLog.isOpen()) {
+        tripLog.logPageSwitch(w.displayedPages());
+        QObject::connect(&w, &MainWindow::pagesDisplayed, &tripLog, &TripLogWriter::logPageSwitch);
+        QObject::connect(&w, &MainWindow::routeSearchRequested, &tripLog, &TripLogWriter::logRouteRequest);
+    }
     w.showFullScreen();
 
     // Lancement de la boucle d'événements
@@ -47,6 +47,7 @@ MainWindow::MainWindow(TelemetryData* telemetry, QWidget* parent)
 
     // TelemetryData sert de bus applicatif partagé.
     m_nav->bindTelemetry(m_t);
+    connect(m_nav, &NavigationPage::routeSearchRequested, this, &MainWindow::routeSearchRequested);
 
     // Configuration du conteneur principal qui va héberger toutes les pages côte à côte.
     QWidget* mainContainer = new QWidget(this);
@@ -115,6 +116,19 @@ void MainWindow::displayPages(QWidget* p1, QWidget* p2)
             }
         }
     }
+
+    m_displayedPages = p2 ? pageName(p1) + QLatin1Char('+') + pageName(p2) : pageName(p1);
+    emit pagesDisplayed(m_displayedPages);
+}
+
+QString MainWindow::pageName(QWidget* page) const
+{
+    if (page == m_nav) return QStringLiteral("navigation");
+    if (page == m_cam) return QStringLiteral("camera");
+    if (page == m_media) return QStringLiteral("media");
+    if (page == m_settings) return QStringLiteral("settings");
+    if (page == m_ha) return QStringLiteral("homeassistant");
+    return QString();
 }
 
 void MainWindow::toggleSplitAndHome() {
@@ -45,6 +45,24 @@ public:
      */
     ~MainWindow();
 
+    /**
+     * @brief Pages actuellement affichées, ex. "navigation+media" en écran partagé.
+     */
+    QString displayedPages() const { return m_displayedPages; }
+
+signals:
+    /**
+     * @brief Émis après chaque changement de pages affichées (journal de trajet).
+     * @param pages Même format que displayedPages().
+     */
+    void pagesDisplayed(const QString& pages);
+
+    /**
+     * @brief Relais de NavigationPage::routeSearchRequested() (journal de trajet).
+     * @param destination Destination saisie ou validée par l'utilisateur.
+     */
+    void routeSearchRequested(const QString& destination);
+
 private slots:
     // --- SLOTS DE NAVIGATION ---
     // Méthodes appelées lors du clic sur les boutons de la barre de navigation.
@@ -78,6 +96,12 @@ private:
     QHBoxLayout* m_mainLayout = nullptr; ///< Layout principal contenant toutes les pages.
     QPushButton* m_btnSplit = nullptr;   ///< Bouton dynamique permettant d'activer le mode Split-Screen.
     bool m_isSplitMode = false;          ///< Indique si l'interface est actuellement en écran divisé.
+    QString m_displayedPages;            ///< Noms des pages affichées (voir displayedPages()).
+
+    /**
+     * @brief Nom court et stable d'une page, utilisé dans le journal de trajet.
+     */
+    QString pageName(QWidget* page) const;
 
     /**
      * @brief Gère l'affichage, le masquage et les proportions des pages dans le layout principal.
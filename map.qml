@@ -3,7 +3,9 @@
  * @brief Rôle architectural : Vue cartographique principale utilisée par la page navigation.
  * @details Responsabilités : Afficher la position véhicule, gérer l'itinéraire/trafic
  * et orchestrer les interactions utilisateur (glisser, zoomer, taper).
- * Dépendances principales : Qt Location, Qt Positioning, API Mapbox (Directions/Geocoding) et clavier virtuel.
+ * Dépendances principales : Qt Location, Qt Positioning, API Mapbox (Directions/Geocoding, via la propriété
+ * de contexte `mapboxClient`), clavier virtuel et RouteModel (propriété de contexte `routeModel` : géométrie
+ * et progression de l'itinéraire en C++).
  */
 
 import QtQuick
@@ -11,6 +13,7 @@ import QtLocation
 import QtPositioning
 import QtQuick.Effects
 import QtQuick.Shapes
+import InterfaceGPS 1.0
 
 Item {
     id: root
@@ -52,37 +55,79 @@ Item {
     property var routeSteps: []             ///< Liste des étapes (manœuvres) fournies par l'API.
     property int currentStepIndex: 0        ///< Index de l'étape de guidage en cours.
     property double lastDistToStep: 999999  ///< Distance mémorisée pour détecter le passage d'une étape.
+    readonly property double arrivalDistanceM: 30 ///< Distance restante en deçà de laquelle on est arrivé.
 
     // --- PROPRIÉTÉS DE STATISTIQUES GLOBALES ---
     property string remainingDistString: "-- km"   ///< Distance totale restante.
     property string remainingTimeString: "-- min"  ///< Temps de trajet restant.
     property string arrivalTimeString: "--:--"     ///< Heure d'arrivée estimée.
-    property real realRouteSpeed: 13.8             ///< Vitesse moyenne de l'itinéraire (m/s) pour extrapolations.
 
     // --- PROPRIÉTÉS CARTOGRAPHIQUES ---
-    property var routePoints: []            ///< Tableau des coordonnées GPS formant le tracé bleu.
+    // Tracé, annotations (vitesse, trafic) et progression sont portés par routeModel (C++).
     property var finalDestination: null     ///< Coordonnée de la destination finale (QGeoCoordinate).
     property bool isRecalculating: false    ///< Indique si un calcul d'itinéraire est en cours (API).
+    property int directionsGeneration: 0    ///< Génération (mapboxClient) de l'itinéraire attendu, 0 : aucun.
+    property var offRouteGraceFrom: null    ///< Position du dernier tracé local, hors-itinéraire ignoré près d'elle.
+    readonly property double offRouteGraceDistanceM: 150 ///< Distance parcourue avant de juger le tracé local.
     property int speedLimit: -1             ///< Limitation de vitesse actuelle sur le tronçon (-1 si inconnue).
 
-    property var routeSpeedLimits: []       ///< Liste des limitations de vitesse par tronçon de l'API.
-    property var routeCongestions: []       ///< Liste des niveaux de trafic par tronçon de l'API.
-    property var trafficSegments: []        ///< Segments de ligne colorés à superposer sur le tracé bleu.
-
     // --- SIGNAUX ---
     /** @brief Émis vers le C++ pour afficher les stats globales sur l'UI (QLabel). */
     signal routeInfoUpdated(string distance, string duration)
     /** @brief Émis vers le C++ pour peupler le clavier ou la liste déroulante d'adresses. */
     signal suggestionsUpdated(string suggestions)
 
+    // --- RÉPONSES MAPBOX ---
+    // mapboxClient ne signale que la dernière demande de chaque canal : pas de réponse périmée ici.
+    Connections {
+        target: mapboxClient
+
+        function onSuggestionsReady(generation, suggestions) {
+            root.suggestionsUpdated(JSON.stringify(suggestions));
+        }
+
+        function onGeocoded(generation, lat, lon) {
+            navigateToCoordinate(lat, lon);
+        }
+
+        function onDirectionsReady(generation, route) {
+            routeInfoUpdated((route.distance / 1000).toFixed(1) + " km", Math.round(route.duration / 60) + " min");
+            updateStatsFromDuration(route.duration, route.distance);
+
+            // Tracé GeoJSON et annotations (vitesse, bouchons) décodés une fois, en C++.
+            routeModel.loadMapboxRoute(route);
+            updateRouteVisuals();
+
+            // Initialisation du guidage vocal/texte
+            if (route.legs && route.legs.length > 0) {
+                routeSteps = route.legs[0].steps;
+                currentStepIndex = 0;
+                lastDistToStep = 999999;
+                updateGuidance();
+            }
+            isRecalculating = false;
+            offRouteGraceFrom = null;
+        }
+
+        function onRequestFailed(generation, error) {
+            console.log("Mapbox: " + error);
+            // Seul l'échec de l'itinéraire attendu débloque le recalcul (pas celui d'une suggestion).
+            if (generation === directionsGeneration) {
+                isRecalculating = false;
+                offRouteGraceFrom = null;
+            }
+        }
+    }
+
     // --- MOTEUR DE CARTE (PLUGIN) ---
     // Fond CartoDB Dark via plugin OSM: compromis lisibilité nocturne / simplicité de déploiement.
+    // Les tuiles passent par le cache local de tileCache (préchargement le long de l'itinéraire).
     Plugin {
         id: mapPlugin
         name: "osm"
         PluginParameter {
             name: "osm.mapping.custom.host"
-            value: "https://a.basemaps.cartocdn.com/dark_all/%z/%x/%y.png"
+            value: tileCache.urlTemplate
         }
         PluginParameter { name: "osm.mapping.providersrepository.disabled"; value: true }
         PluginParameter { name: "osm.useragent"; value: "GPSInterface/1.0" }
@@ -145,28 +190,28 @@ Item {
 
         // --- ÉLÉMENTS VISUELS SUR LA CARTE ---
 
-        // 1. Tracé de l'itinéraire principal (Ligne bleue)
-        MapPolyline {
+        // 1. Tracé de l'itinéraire (ligne bleue, orange/rouge selon le trafic). Géométrie construite une fois
+        //    par itinéraire (RoutePolylineItem) ; à chaque fix seul son premier sommet, la voiture, est déplacé.
+        MapQuickItem {
             id: visualRouteLine
-            line.width: 8
-            line.color: "#1db7ff"
+            visible: routeModel.hasRoute
+            coordinate: routePolyline.origin
+            zoomLevel: routePolyline.referenceZoom
+            anchorPoint.x: 0; anchorPoint.y: 0
             opacity: 0.9
             z: 1
-        }
-
-        // 2. Tracés superposés indiquant l'état du trafic (Orange/Rouge)
-        MapItemView {
-            model: root.trafficSegments
-            delegate: MapPolyline {
-                line.width: 8
-                line.color: modelData.color
-                path: modelData.path
-                opacity: 1.0
-                z: 2
+            sourceItem: RoutePolyline {
+                id: routePolyline
+                model: routeModel
+                color: "#1db7ff"
+                moderateColor: "#FF9800"
+                heavyColor: "#F44336"
+                lineWidth: 8
+                mapZoomLevel: map.zoomLevel
             }
         }
 
-        // 3. Marqueur de la destination finale (Drapeau/Point d'arrivée)
+        // 2. Marqueur de la destination finale (Drapeau/Point d'arrivée)
         MapQuickItem {
             visible: root.finalDestination !== null
             coordinate: root.finalDestination !== null ? root.finalDestination : QtPositioning.coordinate(0,0)
@@ -180,10 +225,12 @@ Item {
             }
         }
 
-        // 4. Marqueur du véhicule (Flèche 3D) avec halo pulsant si le véhicule est à l'arrêt
+        // 3. Marqueur du véhicule (Flèche 3D) avec halo pulsant si le véhicule est à l'arrêt
         MapQuickItem {
             id: carMarker
-            coordinate: QtPositioning.coordinate(carLat, carLon)
+            // Position recalée sur l'itinéraire quand le recalage est sûr, position brute sinon.
+            coordinate: routeModel.hasRoute && routeModel.matchConfidence >= 0.5
+                        ? routeModel.matchedPosition : QtPositioning.coordinate(carLat, carLon)
             anchorPoint.x: carVisual.width / 2; anchorPoint.y: carVisual.height / 2
             z: 10
             sourceItem: Item {
@@ -197,7 +244,7 @@ Item {
                     anchors.centerIn: parent
                     width: 70; height: 70; radius: 35
                     color: "#D2CAEC"; opacity: 0
-                    property bool pulseActive: (root.routePoints && root.routePoints.length > 0) && (root.carSpeed < 2 || nextInstruction === "Vous êtes arrivé")
+                    property bool pulseActive: routeModel.hasRoute && (root.carSpeed < 2 || nextInstruction === "Vous êtes arrivé")
 
                     SequentialAnimation {
                         running: haloRect.pulseActive
@@ -242,199 +289,62 @@ Item {
     // --- FONCTIONS DE LOGIQUE MÉTIER ---
 
     /**
-     * @brief Requête HTTP à l'API Mapbox pour obtenir le tracé, les manœuvres et le trafic.
+     * @brief Calcule l'itinéraire : d'abord localement (offlineRouter, sans réseau), puis par une requête
+     * HTTP à l'API Mapbox qui, si elle aboutit, le remplace par un tracé tenant compte du trafic, avec manœuvres.
+     * Le contrôle hors itinéraire est suspendu sur le tracé local jusqu'à la réponse Mapbox ou
+     * offRouteGraceDistanceM parcourus : un recalcul l'annulerait.
      * @param startCoord Coordonnée GPS de départ.
      * @param endCoord Coordonnée GPS d'arrivée.
      */
     function requestRouteWithTraffic(startCoord, endCoord) {
-        if (typeof mapboxApiKey === "undefined" || mapboxApiKey === "") return;
-
-        var url = "https://api.mapbox.com/directions/v5/mapbox/driving-traffic/" +
-                  startCoord.longitude + "," + startCoord.latitude + ";" +
-                  endCoord.longitude + "," + endCoord.latitude +
-                  "?geometries=geojson&steps=true&overview=full&language=fr&annotations=maxspeed,congestion&access_token=" + mapboxApiKey;
-
-        var http = new XMLHttpRequest()
-        http.open("GET", url, true);
-        http.onreadystatechange = function() {
-            if (http.readyState == 4 && http.status == 200) {
-                try {
-                    var json = JSON.parse(http.responseText);
-                    if (json.routes && json.routes.length > 0) {
-                        var route = json.routes[0];
-                        var durationSec = route.duration;
-                        var distMeters = route.distance;
-
-                        if (durationSec > 0) realRouteSpeed = distMeters / durationSec;
-                        else realRouteSpeed = 13.8;
-
-                        routeInfoUpdated((distMeters / 1000).toFixed(1) + " km", Math.round(durationSec / 60) + " min");
-                        updateStatsFromDuration(durationSec, distMeters);
-
-                        // Parsing des coordonnées GeoJSON
-                        var coords = route.geometry.coordinates;
-                        var newPoints = [];
-                        for (var i = 0; i < coords.length; i++) {
-                            newPoints.push(QtPositioning.coordinate(coords[i][1], coords[i][0]));
-                        }
-                        routePoints = newPoints;
-                        root.trafficSegments = [];
-
-                        // Parsing des annotations (vitesse, bouchons)
-                        if (route.legs && route.legs[0] && route.legs[0].annotation) {
-                            routeSpeedLimits = route.legs[0].annotation.maxspeed ? route.legs[0].annotation.maxspeed : [];
-                            routeCongestions = route.legs[0].annotation.congestion ? route.legs[0].annotation.congestion : [];
-                        } else {
-                            routeSpeedLimits = [];
-                            routeCongestions = [];
-                        }
-
-                        // Initialisation du guidage vocal/texte
-                        if (route.legs && route.legs.length > 0) {
-                            routeSteps = route.legs[0].steps;
-                            currentStepIndex = 0;
-                            lastDistToStep = 999999;
-                            updateGuidance();
-                        }
-                        isRecalculating = false;
-                    }
-                } catch(e) { console.log("Erreur JSON: " + e) }
-            }
+        // Cap transmis au-delà de 5 km/h seulement : à l'arrêt, il ne dit rien du sens de circulation.
+        if (offlineRouter.available && offlineRouter.route(startCoord.latitude, startCoord.longitude,
+                                                           endCoord.latitude, endCoord.longitude,
+                                                           carSpeed > 5 ? carHeading : -1)) {
+            routeInfoUpdated((routeModel.totalDistance / 1000).toFixed(1) + " km",
+                             Math.round(routeModel.remainingDuration / 60) + " min");
+            updateStatsFromDuration(routeModel.remainingDuration, routeModel.totalDistance);
+            // Pas de manœuvres dans le graphe local : consigne neutre jusqu'à la réponse Mapbox.
+            routeSteps = [];
+            currentStepIndex = 0;
+            lastDistToStep = 999999;
+            updateRouteVisuals();
+            updateGuidance();
+            isRecalculating = false;
+            offRouteGraceFrom = startCoord;
         }
-        http.send();
+        // Réponse dans onDirectionsReady ; une demande plus récente (recalcul) remplace celle-ci.
+        directionsGeneration = mapboxClient.requestDirections(startCoord.latitude, startCoord.longitude,
+                                                              endCoord.latitude, endCoord.longitude);
+        if (directionsGeneration === 0) isRecalculating = false;
     }
 
     /**
      * @brief Met à jour le tracé visuel pour qu'il "disparaisse" derrière le véhicule au fur et à mesure de l'avancée.
-     * Cette fonction extrait également la limitation de vitesse et l'état du trafic du tronçon actuel.
+     * routeModel localise le véhicule sur le tracé et fournit la limitation de vitesse du tronçon actuel ;
+     * RoutePolyline en déplace la tête.
      */
     function updateRouteVisuals() {
-        if (!root.routePoints || root.routePoints.length === 0) {
-            root.trafficSegments = [];
-            visualRouteLine.path = [];
+        if (!routeModel.hasRoute) {
             root.speedLimit = -1;
             return;
         }
 
-        var carPos = QtPositioning.coordinate(root.carLat, root.carLon);
-        var changed = false;
-        var tempPoints = root.routePoints;
-        var tempLimits = (typeof root.routeSpeedLimits !== "undefined" && root.routeSpeedLimits) ? root.routeSpeedLimits : [];
-        var tempCongestions = (typeof root.routeCongestions !== "undefined" && root.routeCongestions) ? root.routeCongestions : [];
-
-        // Trouve le point de l'itinéraire le plus proche du véhicule
-        var bestI = 0;
-        var minD = 100000;
-        var searchLimit = Math.min(tempPoints.length - 1, 30);
-        for (var j = 0; j < searchLimit; j++) {
-            var d = distanceToSegment(carPos, tempPoints[j], tempPoints[j+1]);
-            if (d < minD) {
-                minD = d;
-                bestI = j;
-            }
-        }
-
-        // Efface les points déjà dépassés
-        if (bestI > 0) {
-            tempPoints.splice(0, bestI);
-            if (tempLimits.length >= bestI) tempLimits.splice(0, bestI);
-            if (tempCongestions.length >= bestI) tempCongestions.splice(0, bestI);
-            changed = true;
-        }
-
-        if (changed) {
-            root.routePoints = tempPoints;
-            if (typeof root.routeSpeedLimits !== "undefined") root.routeSpeedLimits = tempLimits;
-            if (typeof root.routeCongestions !== "undefined") root.routeCongestions = tempCongestions;
-        }
-
-        // Mise à jour de la limitation de vitesse locale
-        if (tempLimits.length > 0) {
-            var limitData = tempLimits[0];
-            if (limitData && limitData.speed !== undefined) root.speedLimit = limitData.speed;
-            else if (typeof limitData === 'number') root.speedLimit = limitData;
-        }
-
-        // Reconstruction du tracé
-        var limit = Math.min(tempPoints.length, 3000);
-        var drawPath = [carPos]; // Le point 0 est toujours la voiture pour une jonction parfaite
-        if (tempPoints.length > 1) {
-            for (var k = 1; k < limit; k++) drawPath.push(tempPoints[k]);
-        } else if (tempPoints.length === 1) {
-            drawPath.push(tempPoints[0]);
-        }
-        visualRouteLine.path = drawPath;
-
-        // Reconstruction des segments de trafic (couleurs)
-        if (changed || typeof root.trafficSegments === "undefined" || root.trafficSegments.length === 0) {
-            var newSegments = [];
-            var currentPath = [];
-            var currentColor = "none";
-
-            for (var k = 0; k < limit - 1; k++) {
-                var levelK = (k < tempCongestions.length) ? tempCongestions[k] : "unknown";
-                var colorK = "none";
-
-                if (levelK === "moderate") colorK = "#FF9800";
-                else if (levelK === "heavy" || levelK === "severe") colorK = "#F44336";
-
-                if (colorK === "none") {
-                    if (currentColor !== "none") {
-                        newSegments.push({"path": currentPath, "color": currentColor});
-                        currentColor = "none";
-                        currentPath = [];
-                    }
-                } else {
-                    if (currentColor === colorK) {
-                        currentPath.push(tempPoints[k+1]);
-                    } else {
-                        if (currentColor !== "none") {
-                            newSegments.push({"path": currentPath, "color": currentColor});
-                        }
-                        currentPath = [tempPoints[k], tempPoints[k+1]];
-                        currentColor = colorK;
-                    }
-                }
-            }
-            if (currentColor !== "none") {
-                newSegments.push({"path": currentPath, "color": currentColor});
-            }
-            root.trafficSegments = newSegments;
-        }
-    }
-
-    /**
-     * @brief Algorithme mathématique calculant la distance orthogonale (Cross-Track)
-     * entre un point (véhicule) et un segment de droite (route).
-     */
-    function distanceToSegment(P, A, B) {
-        var d_AB = A.distanceTo(B);
-        if (d_AB < 1) return A.distanceTo(P);
-        var d_AP = A.distanceTo(P);
-        var bearingAB = A.azimuthTo(B);
-        var bearingAP = A.azimuthTo(P);
-        var angleDiff = (bearingAP - bearingAB) * Math.PI / 180.0;
-        var crossTrack = Math.abs(d_AP * Math.sin(angleDiff));
-        var alongTrack = d_AP * Math.cos(angleDiff);
-        if (alongTrack < 0) return d_AP;
-        if (alongTrack > d_AB) return P.distanceTo(B);
-        return crossTrack;
+        routeModel.updatePosition(root.carLat, root.carLon, root.carHeading, root.carSpeed);
+        if (routeModel.speedLimit > 0) root.speedLimit = routeModel.speedLimit;
     }
 
     /**
-     * @brief Détecte si le véhicule a quitté l'itinéraire défini (distance > 75m)
+     * @brief Détecte si le véhicule a quitté l'itinéraire défini (distance > 75m, voir RouteModel::OffRouteDistanceM)
      * et relance un calcul de trajet si nécessaire.
      */
     function checkIfOffRoute() {
-        if (routePoints.length < 2 || isRecalculating) return;
-        var carPos = QtPositioning.coordinate(carLat, carLon);
-        var minDistance = 100000;
-        var searchLimit = Math.min(routePoints.length - 1, 30);
-        for (var i = 0; i < searchLimit; i++) {
-            var d = distanceToSegment(carPos, routePoints[i], routePoints[i+1]);
-            if (d < minDistance) minDistance = d;
+        if (!routeModel.hasRoute || isRecalculating) return;
+        if (offRouteGraceFrom) {
+            if (offRouteGraceFrom.distanceTo(QtPositioning.coordinate(carLat, carLon)) < offRouteGraceDistanceM) return;
+            offRouteGraceFrom = null;
         }
-        if (minDistance > 75) recalculateRoute();
+        if (routeModel.offRoute) recalculateRoute();
     }
 
     /**
@@ -452,10 +362,18 @@ Item {
      */
     function updateGuidance() {
         if (!routeSteps || routeSteps.length === 0 || currentStepIndex >= routeSteps.length) {
-            if (routePoints.length > 0 && routePoints.length < 15) {
-                 nextInstruction = "Vous êtes arrivé";
-                 distanceToNextTurn = "0 m";
-                 nextManeuverDirection = 0;
+            if (!routeModel.hasRoute) return;
+            // L'arrivée se décide sur la distance restante, pas sur le nombre de sommets : un trajet
+            // local court (ou quelques raccourcis dépliés) compte peu de sommets dès le départ.
+            if (routeModel.remainingDistance < arrivalDistanceM) {
+                nextInstruction = "Vous êtes arrivé";
+                distanceToNextTurn = "0 m";
+                nextManeuverDirection = 0;
+            } else if (!routeSteps || routeSteps.length === 0) {
+                // Itinéraire local, sans manœuvres tant que Mapbox n'a pas répondu
+                nextInstruction = "Suivez l'itinéraire";
+                distanceToNextTurn = formatWazeDistance(routeModel.remainingDistance);
+                nextManeuverDirection = 1;
             }
             return;
         }
@@ -498,19 +416,12 @@ Item {
     }
 
     /**
-     * @brief Calcule la distance totale restante en additionnant les segments non encore parcourus.
+     * @brief Affiche la distance et la durée restantes calculées par routeModel lors du dernier fix.
      */
     function updateTripStats() {
-        if (routePoints.length === 0) return;
-        var carPos = QtPositioning.coordinate(carLat, carLon);
-        var distRemaining = 0;
-        distRemaining += carPos.distanceTo(routePoints[0]);
-        for (var i = 0; i < routePoints.length - 1; i++) {
-            distRemaining += routePoints[i].distanceTo(routePoints[i+1]);
-        }
-        remainingDistString = formatWazeDistance(distRemaining);
-        var timeSeconds = distRemaining / realRouteSpeed;
-        updateStatsFromDuration(timeSeconds, distRemaining);
+        if (!routeModel.hasRoute) return;
+        remainingDistString = formatWazeDistance(routeModel.remainingDistance);
+        updateStatsFromDuration(routeModel.remainingDuration, routeModel.remainingDistance);
     }
 
     /**
@@ -533,47 +444,26 @@ Item {
      * Si trouvé, lance directement le calcul de l'itinéraire.
      */
     function searchDestination(address) {
-        if (typeof mapboxApiKey === "undefined" || mapboxApiKey === "") return;
-        var queryUrl = "https://api.mapbox.com/geocoding/v5/mapbox.places/" + encodeURIComponent(address) + ".json?access_token=" + mapboxApiKey + "&limit=1&language=fr";
-        var http = new XMLHttpRequest();
-        http.open("GET", queryUrl, true);
-        http.onreadystatechange = function() {
-            if (http.readyState == 4 && http.status == 200) {
-                try {
-                    var json = JSON.parse(http.responseText);
-                    if (json.features && json.features.length > 0) {
-                        var c = json.features[0].center;
-                        finalDestination = QtPositioning.coordinate(c[1], c[0]);
-                        isRecalculating = true;
-                        nextInstruction = "Calcul...";
-                        requestRouteWithTraffic(QtPositioning.coordinate(carLat, carLon), finalDestination);
-                        autoFollow = true;
-                    }
-                } catch(e) {}
-            }
-        }
-        http.send();
+        mapboxClient.geocode(address, carLat, carLon); // Résultat dans onGeocoded
+    }
+
+    /**
+     * @brief Lance le guidage vers une position connue (géocodage Mapbox ou suggestion de l'index local).
+     */
+    function navigateToCoordinate(lat, lon) {
+        finalDestination = QtPositioning.coordinate(lat, lon);
+        isRecalculating = true;
+        nextInstruction = "Calcul...";
+        requestRouteWithTraffic(QtPositioning.coordinate(carLat, carLon), finalDestination);
+        autoFollow = true;
     }
 
     /**
      * @brief Récupère des suggestions d'adresses en cours de frappe (Autocomplétion).
      */
     function requestSuggestions(query) {
-        if (!query || query.length < 3 || typeof mapboxApiKey === "undefined" || mapboxApiKey === "") return;
-        var http = new XMLHttpRequest();
-        var url = "https://api.mapbox.com/geocoding/v5/mapbox.places/" + encodeURIComponent(query) + ".json?access_token=" + mapboxApiKey + "&autocomplete=true&limit=5&language=fr";
-        http.open("GET", url, true);
-        http.onreadystatechange = function() {
-            if (http.readyState == 4 && http.status == 200) {
-                try {
-                    var json = JSON.parse(http.responseText);
-                    var results = [];
-                    if (json.features) for (var i=0; i<json.features.length; i++) results.push(json.features[i].place_name);
-                    root.suggestionsUpdated(JSON.stringify(results));
-                } catch(e) {}
-            }
-        }
-        http.send();
+        // Remplace la demande précédente : une réponse lente pour "rue d" n'écrase pas "rue de la paix".
+        mapboxClient.requestSuggestions(query, carLat, carLon);
     }
 
     /**
@@ -589,12 +479,12 @@ Item {
      * @brief Arrête le guidage en cours et nettoie l'itinéraire affiché.
      */
     function stopNavigation() {
+        mapboxClient.cancelDirections();
+        directionsGeneration = 0;
+        offRouteGraceFrom = null;
         finalDestination = null;
-        routePoints = [];
+        routeModel.clear();
         routeSteps = [];
-        trafficSegments = [];
-        routeSpeedLimits = [];
-        routeCongestions = [];
         currentStepIndex = 0;
         lastDistToStep = 999999;
         isRecalculating = false;
@@ -648,11 +538,8 @@ Item {
 
             // Zoom dynamique en fonction de la vitesse (faible vitesse = zoom fort)
             if (enableSpeedZoom) {
-                var targetZoom = 18;
-                if (carSpeed > 100) targetZoom = 15;
-                else if (carSpeed > 70) targetZoom = 16;
-                else if (carSpeed > 40) targetZoom = 17;
-                else targetZoom = 18;
+                // Mêmes paliers que le préchargement des tuiles (15 à 18 selon la vitesse)
+                var targetZoom = tilePrefetcher.zoomForSpeed(carSpeed);
 
                 if (Math.abs(carZoom - targetZoom) > 0.5) {
                     internalZoomChange = true;
@@ -686,7 +573,7 @@ Item {
     // Panneau Supérieur (Bandeau de Guidage)
     Rectangle {
         id: navPanel
-        visible: (routePoints.length > 0 || isRecalculating) && nextInstruction.length > 0
+        visible: (routeModel.hasRoute || isRecalculating) && nextInstruction.length > 0
         anchors.top: parent.top; anchors.horizontalCenter: parent.horizontalCenter; anchors.topMargin: 15
         width: Math.min(parent.width * 0.9, 500); height: 70; radius: 35
         color: "#CC1C1C1E"; border.color: isRecalculating ? "#FF9800" : "#33FFFFFF"; border.width: 2
@@ -709,7 +596,7 @@ Item {
     // Panneau Inférieur (Bandeau de Statistiques)
     Rectangle {
         id: bottomInfoPanel
-        visible: routePoints.length > 0 && !isRecalculating
+        visible: routeModel.hasRoute && !isRecalculating
         anchors.bottom: parent.bottom; anchors.horizontalCenter: parent.horizontalCenter; anchors.bottomMargin: 20
         width: Math.min(parent.width * 0.5, 250); height: 50; radius: 25
         color: "#CC1C1C1E"; border.color: "#33FFFFFF"; border.width: 1
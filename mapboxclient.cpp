@@ -0,0 +1,315 @@
+/**
+ * @file mapboxclient.cpp
+ * @brief Implémentation du client réseau Mapbox (fusion, annulation, cache des réponses).
+ */
+
+#include "mapboxclient.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrlQuery>
+#include <algorithm>
+#include <cmath>
+
+MapboxClient::MapboxClient(QObject* parent)
+    : QObject(parent)
+    , m_network(new QNetworkAccessManager(this))
+    , m_baseUrl(QStringLiteral("https://api.mapbox.com"))
+{
+    m_memory.setMaxCost(MemoryCacheBytes);
+}
+
+MapboxClient::~MapboxClient()
+{
+    // Les réponses encore en cours sont détruites avec m_network : plus rien ne doit nous être signalé.
+    for (const Pending& pending : std::as_const(m_pending)) pending.reply->disconnect(this);
+    m_pending.clear();
+}
+
+void MapboxClient::setAccessToken(const QString& token)
+{
+    const bool wasAvailable = isAvailable();
+    m_accessToken = token.trimmed();
+    if (wasAvailable != isAvailable()) emit availableChanged();
+}
+
+void MapboxClient::setCacheDirectory(const QString& path)
+{
+    m_cacheDir = path;
+    m_diskEntries = path.isEmpty() ? 0 : int(QDir(path).entryList({QStringLiteral("*.json")}, QDir::Files).size());
+    if (m_diskEntries > DiskCacheEntries) trimDiskCache();
+}
+
+QString MapboxClient::normalizedQuery(const QString& query)
+{
+    return query.simplified().toLower();
+}
+
+int MapboxClient::requestSuggestions(const QString& query, double lat, double lon)
+{
+    const QString normalized = normalizedQuery(query);
+    if (!isAvailable() || normalized.size() < MinQueryLength) {
+        // Saisie effacée ou raccourcie : les suggestions encore attendues ne correspondent plus à rien.
+        m_current[int(Channel::Suggestions)] = 0;
+        supersede(Channel::Suggestions);
+        return 0;
+    }
+    return start(Channel::Suggestions, geocodingUrl(normalized, lat, lon, true),
+                 cacheKey(Channel::Suggestions, normalized, lat, lon));
+}
+
+int MapboxClient::geocode(const QString& address, double lat, double lon)
+{
+    const QString normalized = normalizedQuery(address);
+    if (!isAvailable() || normalized.isEmpty()) return 0;
+    return start(Channel::Geocoding, geocodingUrl(normalized, lat, lon, false),
+                 cacheKey(Channel::Geocoding, normalized, lat, lon));
+}
+
+int MapboxClient::requestDirections(double fromLat, double fromLon, double toLat, double toLon)
+{
+    if (!isAvailable()) return 0;
+    QUrl url(m_baseUrl);
+    url.setPath(url.path() + QStringLiteral("/directions/v5/mapbox/driving-traffic/%1,%2;%3,%4")
+                                 .arg(QString::number(fromLon, 'f', 6), QString::number(fromLat, 'f', 6),
+                                      QString::number(toLon, 'f', 6), QString::number(toLat, 'f', 6)));
+    QUrlQuery query;
+    query.addQueryItem(QStringLiteral("geometries"), QStringLiteral("geojson"));
+    query.addQueryItem(QStringLiteral("steps"), QStringLiteral("true"));
+    query.addQueryItem(QStringLiteral("overview"), QStringLiteral("full"));
+    query.addQueryItem(QStringLiteral("language"), QStringLiteral("fr"));
+    query.addQueryItem(QStringLiteral("annotations"), QStringLiteral("maxspeed,congestion,duration"));
+    query.addQueryItem(QStringLiteral("access_token"), m_accessToken);
+    url.setQuery(query);
+    return start(Channel::Directions, url, QByteArray());
+}
+
+void MapboxClient::cancelDirections()
+{
+    m_current[int(Channel::Directions)] = 0;
+    supersede(Channel::Directions);
+}
+
+int MapboxClient::start(Channel channel, const QUrl& url, const QByteArray& cacheKey)
+{
+    const int generation = ++m_generation;
+    m_current[int(channel)] = generation;
+
+    QByteArray body;
+    if (!cacheKey.isEmpty() && cachedBody(cacheKey, body)) {
+        supersede(channel);
+        // Livré après le retour de l'appel, comme une réponse réseau : l'appelant connaît déjà la génération.
+        QMetaObject::invokeMethod(this, [this, channel, generation, body]() {
+            if (m_current[int(channel)] != generation) {
+                ++m_stats.staleDropped;
+                return;
+            }
+            deliver(channel, generation, body);
+        }, Qt::QueuedConnection);
+        return generation;
+    }
+
+    const QString id = url.toString(QUrl::FullyEncoded);
+    const auto existing = m_pending.find(id);
+    if (existing != m_pending.end()) {
+        existing->generations[int(channel)] = generation;
+        ++m_stats.coalesced;
+        supersede(channel);
+        return generation;
+    }
+    supersede(channel);
+
+    Pending pending;
+    pending.reply = m_network->get(QNetworkRequest(url));
+    pending.cacheKey = cacheKey;
+    pending.generations[int(channel)] = generation;
+    m_pending.insert(id, pending);
+    ++m_stats.networkRequests;
+    QNetworkReply* reply = pending.reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() { onFinished(reply); });
+    return generation;
+}
+
+void MapboxClient::supersede(Channel channel)
+{
+    // Détache les générations périmées du canal ; une requête que plus personne n'attend est interrompue.
+    QList<QNetworkReply*> orphans;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        int& generation = it->generations[int(channel)];
+        if (generation != 0 && generation != m_current[int(channel)]) {
+            generation = 0;
+            if (std::all_of(std::begin(it->generations), std::end(it->generations), [](int g) { return g == 0; })) {
+                orphans.append(it->reply);
+                it = m_pending.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+    // Hors de la boucle : abort() signale finished() immédiatement.
+    for (QNetworkReply* reply : std::as_const(orphans)) {
+        ++m_stats.cancelled;
+        reply->abort();
+    }
+}
+
+void MapboxClient::onFinished(QNetworkReply* reply)
+{
+    reply->deleteLater();
+    Pending pending;
+    bool found = false;
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (it->reply == reply) {
+            pending = *it;
+            m_pending.erase(it);
+            found = true;
+            break;
+        }
+    }
+    if (!found) return; // Interrompue après remplacement.
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError || status != 200) {
+        const QString error = reply->error() != QNetworkReply::NoError ? reply->errorString()
+                                                                      : QStringLiteral("HTTP %1").arg(status);
+        for (int channel = 0; channel < ChannelCount; ++channel) {
+            const int generation = pending.generations[channel];
+            if (generation != 0 && generation == m_current[channel]) emit requestFailed(generation, error);
+        }
+        return;
+    }
+
+    const QByteArray body = reply->readAll();
+    if (!pending.cacheKey.isEmpty() && QJsonDocument::fromJson(body).isObject()) storeBody(pending.cacheKey, body);
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        const int generation = pending.generations[channel];
+        if (generation != 0 && generation == m_current[channel]) deliver(Channel(channel), generation, body);
+    }
+}
+
+void MapboxClient::deliver(Channel channel, int generation, const QByteArray& body)
+{
+    const QJsonObject json = QJsonDocument::fromJson(body).object();
+    switch (channel) {
+    case Channel::Suggestions: {
+        QStringList suggestions;
+        for (const QJsonValue& feature : json.value(QStringLiteral("features")).toArray()) {
+            suggestions << feature.toObject().value(QStringLiteral("place_name")).toString();
+        }
+        emit suggestionsReady(generation, suggestions);
+        break;
+    }
+    case Channel::Geocoding: {
+        const QJsonArray center = json.value(QStringLiteral("features")).toArray().at(0).toObject()
+                                      .value(QStringLiteral("center")).toArray();
+        if (center.size() < 2) {
+            emit requestFailed(generation, QStringLiteral("adresse introuvable"));
+            break;
+        }
+        emit geocoded(generation, center.at(1).toDouble(), center.at(0).toDouble());
+        break;
+    }
+    case Channel::Directions: {
+        const QJsonArray routes = json.value(QStringLiteral("routes")).toArray();
+        if (routes.isEmpty()) {
+            emit requestFailed(generation, QStringLiteral("aucun itinéraire"));
+            break;
+        }
+        emit directionsReady(generation, routes.first().toObject().toVariantMap());
+        break;
+    }
+    }
+}
+
+QUrl MapboxClient::geocodingUrl(const QString& query, double lat, double lon, bool autocomplete) const
+{
+    QUrl url(m_baseUrl);
+    url.setPath(url.path() + QStringLiteral("/geocoding/v5/mapbox.places/")
+                    + QString::fromLatin1(QUrl::toPercentEncoding(query)) + QStringLiteral(".json"),
+                QUrl::TolerantMode);
+    QUrlQuery items;
+    items.addQueryItem(QStringLiteral("access_token"), m_accessToken);
+    if (autocomplete) items.addQueryItem(QStringLiteral("autocomplete"), QStringLiteral("true"));
+    items.addQueryItem(QStringLiteral("limit"), autocomplete ? QStringLiteral("5") : QStringLiteral("1"));
+    items.addQueryItem(QStringLiteral("language"), QStringLiteral("fr"));
+    if (std::isfinite(lat) && std::isfinite(lon) && std::abs(lat) <= 90.0 && std::abs(lon) <= 180.0) {
+        // Centre de la maille plutôt que la position exacte : la réponse ne dépend que de la clé du cache.
+        const double cellLat = (std::floor(lat / CellDegrees) + 0.5) * CellDegrees;
+        const double cellLon = (std::floor(lon / CellDegrees) + 0.5) * CellDegrees;
+        items.addQueryItem(QStringLiteral("proximity"),
+                           QString::number(cellLon, 'f', 4) + QLatin1Char(',') + QString::number(cellLat, 'f', 4));
+    }
+    url.setQuery(items);
+    return url;
+}
+
+QByteArray MapboxClient::cacheKey(Channel channel, const QString& query, double lat, double lon) const
+{
+    QByteArray key = QByteArray::number(int(channel)) + '|';
+    if (std::isfinite(lat) && std::isfinite(lon) && std::abs(lat) <= 90.0 && std::abs(lon) <= 180.0) {
+        key += QByteArray::number(qint64(std::floor(lat / CellDegrees))) + ','
+            + QByteArray::number(qint64(std::floor(lon / CellDegrees)));
+    }
+    return key + '|' + query.toUtf8();
+}
+
+bool MapboxClient::cachedBody(const QByteArray& key, QByteArray& body)
+{
+    if (const QByteArray* hit = m_memory.object(key)) {
+        body = *hit;
+        ++m_stats.memoryHits;
+        return true;
+    }
+    if (m_cacheDir.isEmpty()) return false;
+
+    QFile file(diskPath(key));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (file.fileTime(QFileDevice::FileModificationTime).secsTo(now) > DiskCacheMaxAgeSec) {
+        file.close();
+        if (file.remove()) --m_diskEntries;
+        return false;
+    }
+    body = file.readAll();
+    file.setFileTime(now, QFileDevice::FileModificationTime); // Ordre LRU du disque.
+    m_memory.insert(key, new QByteArray(body), body.size());
+    ++m_stats.diskHits;
+    return true;
+}
+
+void MapboxClient::storeBody(const QByteArray& key, const QByteArray& body)
+{
+    m_memory.insert(key, new QByteArray(body), body.size());
+    if (m_cacheDir.isEmpty() || !QDir().mkpath(m_cacheDir)) return;
+
+    QFile file(diskPath(key));
+    const bool existed = file.exists();
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(body) != body.size()) {
+        file.remove();
+        if (existed) --m_diskEntries;
+        return;
+    }
+    if (!existed && ++m_diskEntries > DiskCacheEntries) trimDiskCache();
+}
+
+QString MapboxClient::diskPath(const QByteArray& key) const
+{
+    return m_cacheDir + QLatin1Char('/')
+        + QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + QStringLiteral(".json");
+}
+
+void MapboxClient::trimDiskCache()
+{
+    // Garde les 90 % les plus récemment utilisés : un nettoyage tous les DiskCacheEntries / 10 ajouts.
+    const int keep = DiskCacheEntries - DiskCacheEntries / 10;
+    const QFileInfoList entries = QDir(m_cacheDir).entryInfoList({QStringLiteral("*.json")}, QDir::Files, QDir::Time);
+    for (int i = keep; i < entries.size(); ++i) QFile::remove(entries.at(i).filePath());
+    m_diskEntries = int(std::min<qsizetype>(entries.size(), keep));
+}
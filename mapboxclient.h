@@ -0,0 +1,176 @@
+/**
+ * @file mapboxclient.h
+ * @brief Rôle architectural : Client réseau des API Mapbox (géocodage, suggestions, itinéraires) pour map.qml.
+ * @details Responsabilités : Construire les requêtes, fusionner les requêtes identiques en cours, annuler
+ * celles qu'une saisie plus récente rend caduques, numéroter les réponses et garder en cache (mémoire
+ * puis disque) les résultats de géocodage, afin qu'une réponse lente ne remplace jamais une plus récente.
+ * Dépendances principales : Qt Network.
+ */
+
+#ifndef MAPBOXCLIENT_H
+#define MAPBOXCLIENT_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVariantMap>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * @class MapboxClient
+ * @brief Requêtes Mapbox de la carte (propriété de contexte `mapboxClient`).
+ * @details Trois canaux : suggestions, géocodage d'une adresse, itinéraire. Chaque appel reçoit un numéro
+ * de génération (croissant, tous canaux confondus) et remplace l'appel précédent du même canal : la
+ * requête réseau de ce dernier est interrompue si plus personne ne l'attend, et seule la génération
+ * courante d'un canal est jamais signalée. Deux appels produisant la même URL partagent une seule
+ * requête. Suggestions et géocodage sont mis en cache sous la clé (canal, saisie normalisée, maille de
+ * CellDegrees) ; la requête envoie le centre de cette maille comme `proximity`, si bien que la réponse
+ * ne dépend que de la clé. Les itinéraires (trafic) ne sont jamais mis en cache.
+ */
+class MapboxClient : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availableChanged)
+
+public:
+    static constexpr int MinQueryLength = 3;                  ///< Saisie normalisée minimale des suggestions.
+    static constexpr double CellDegrees = 0.05;               ///< Maille de position du cache (≈ 5 km).
+    static constexpr int MemoryCacheBytes = 2 * 1024 * 1024;  ///< Réponses gardées en mémoire (LRU).
+    static constexpr int DiskCacheEntries = 4096;             ///< Fichiers gardés sur disque (LRU).
+    static constexpr qint64 DiskCacheMaxAgeSec = 30 * 24 * 3600; ///< Au-delà, une entrée disque est ignorée.
+
+    /**
+     * @brief Canal d'une requête ; un nouvel appel remplace le précédent du même canal.
+     */
+    enum class Channel { Suggestions, Geocoding, Directions };
+
+    /**
+     * @struct Stats
+     * @brief Compteurs depuis la création.
+     */
+    struct Stats {
+        quint64 networkRequests = 0; ///< Requêtes HTTP réellement envoyées.
+        quint64 coalesced = 0;       ///< Appels rattachés à une requête identique déjà en cours.
+        quint64 cancelled = 0;       ///< Requêtes interrompues car remplacées.
+        quint64 memoryHits = 0;      ///< Réponses servies par le cache mémoire.
+        quint64 diskHits = 0;        ///< Réponses servies par le cache disque.
+        quint64 staleDropped = 0;    ///< Réponses du cache écartées, remplacées avant leur livraison.
+    };
+
+    explicit MapboxClient(QObject* parent = nullptr);
+    ~MapboxClient() override;
+
+    /**
+     * @brief Jeton d'accès Mapbox (`MAPBOX_API_KEY`) ; vide : aucune requête n'est envoyée.
+     */
+    void setAccessToken(const QString& token);
+    bool isAvailable() const { return !m_accessToken.isEmpty(); } ///< true si un jeton est défini.
+
+    /**
+     * @brief Racine des URL (`https://api.mapbox.com` par défaut ; un serveur local pour les tests).
+     */
+    void setBaseUrl(const QUrl& url) { m_baseUrl = url; }
+
+    /**
+     * @brief Répertoire du cache disque, créé à la première écriture ; vide : cache en mémoire seulement.
+     * @details Les entrées les plus anciennement utilisées sont supprimées au-delà de DiskCacheEntries.
+     */
+    void setCacheDirectory(const QString& path);
+    QString cacheDirectory() const { return m_cacheDir; } ///< Répertoire du cache disque.
+
+    const Stats& stats() const { return m_stats; } ///< Compteurs depuis la création.
+
+    /**
+     * @brief Forme de @p query utilisée comme clé et envoyée à Mapbox : espaces réduits, minuscules.
+     */
+    static QString normalizedQuery(const QString& query);
+
+    /**
+     * @brief Suggestions d'adresses pour une saisie en cours, proches de (@p lat, @p lon).
+     * @return Génération de l'appel (signalée par suggestionsReady()), 0 si la saisie est trop courte
+     *         ou sans jeton.
+     */
+    Q_INVOKABLE int requestSuggestions(const QString& query, double lat, double lon);
+
+    /**
+     * @brief Position de l'adresse @p address (premier résultat), recherchée près de (@p lat, @p lon).
+     * @return Génération de l'appel (signalée par geocoded()), 0 sans jeton.
+     */
+    Q_INVOKABLE int geocode(const QString& address, double lat, double lon);
+
+    /**
+     * @brief Itinéraire avec trafic, manœuvres et annotations (`maxspeed`, `congestion`, `duration`).
+     * @return Génération de l'appel (signalée par directionsReady()), 0 sans jeton.
+     */
+    Q_INVOKABLE int requestDirections(double fromLat, double fromLon, double toLat, double toLon);
+
+    /**
+     * @brief Abandonne l'itinéraire demandé (arrêt du guidage) : aucune réponse ne sera plus signalée.
+     */
+    Q_INVOKABLE void cancelDirections();
+
+signals:
+    void availableChanged();
+
+    /**
+     * @brief Libellés (`place_name`) des suggestions de la génération courante.
+     */
+    void suggestionsReady(int generation, const QStringList& suggestions);
+
+    /**
+     * @brief Position trouvée pour la génération courante du géocodage.
+     */
+    void geocoded(int generation, double lat, double lon);
+
+    /**
+     * @brief Premier itinéraire (`routes[0]`) de la génération courante, tel que RouteModel::loadMapboxRoute() l'attend.
+     */
+    void directionsReady(int generation, const QVariantMap& route);
+
+    /**
+     * @brief Échec réseau, HTTP ou réponse sans résultat pour la génération courante d'un canal.
+     */
+    void requestFailed(int generation, const QString& error);
+
+private:
+    static constexpr int ChannelCount = 3;
+
+    /**
+     * @struct Pending
+     * @brief Requête HTTP en cours et générations qui l'attendent (au plus une par canal).
+     */
+    struct Pending {
+        QNetworkReply* reply = nullptr;
+        QByteArray cacheKey;             ///< Vide : réponse non mise en cache.
+        int generations[ChannelCount] = {}; ///< 0 : canal non intéressé.
+    };
+
+    int start(Channel channel, const QUrl& url, const QByteArray& cacheKey);
+    void supersede(Channel channel);
+    void onFinished(QNetworkReply* reply);
+    void deliver(Channel channel, int generation, const QByteArray& body);
+    QUrl geocodingUrl(const QString& query, double lat, double lon, bool autocomplete) const;
+    QByteArray cacheKey(Channel channel, const QString& query, double lat, double lon) const;
+    bool cachedBody(const QByteArray& key, QByteArray& body);
+    void storeBody(const QByteArray& key, const QByteArray& body);
+    QString diskPath(const QByteArray& key) const;
+    void trimDiskCache();
+
+    QNetworkAccessManager* m_network;
+    QString m_accessToken;
+    QUrl m_baseUrl;
+    QString m_cacheDir;
+    int m_diskEntries = 0;                   ///< Fichiers présents dans m_cacheDir (estimation).
+    QCache<QByteArray, QByteArray> m_memory; ///< Corps des réponses, coût en octets.
+    QHash<QString, Pending> m_pending;       ///< Requêtes en cours par URL.
+    int m_current[ChannelCount] = {};        ///< Génération courante de chaque canal (0 : aucune).
+    int m_generation = 0;
+    Stats m_stats;
+};
+
+#endif // MAPBOXCLIENT_H
@@ -3,13 +3,17 @@
  * @brief Implémentation du contrôleur I2C pour la centrale inertielle MPU9250.
  * @details Gère les appels système bas niveau (ioctl) sous Linux pour communiquer
  * avec les registres du capteur. Contient la logique d'acquisition, l'application
- * des paramètres de calibration (Hard/Soft iron, biais) et l'algorithme de fusion
- * de capteurs (Filtre de Madgwick) nécessaire au calcul précis de l'orientation (Cap).
+ * des paramètres de calibration (Hard/Soft iron, biais) et le pilotage du filtre de fusion
+ * (OrientationEngine : Madgwick, Mahony ou ESKF) nécessaire au calcul précis de l'orientation (Cap).
  */
 
 #include "mpu9250source.h"
 #include "telemetrydata.h"
+#include "deadreckoning.h"
+#include "triplogwriter.h"
 #include <QDebug>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 // Les bibliothèques système Linux sont isolées pour que Windows ne plante pas à la compilation
@@ -17,11 +21,47 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <cerrno>
 #endif
 
+namespace {
+// Déclinaison magnétique ajoutée au cap pour pointer vers le Nord Géographique (Vrai Nord).
+// (2.0° correspond environ à la France actuelle, ajustez si besoin).
+constexpr float MagneticDeclinationDeg = 2.0f;
+
+// Gravité standard, pour convertir l'accélération de g en m/s² (navigation à l'estime).
+constexpr float StandardGravity = 9.80665f;
+
+#ifdef Q_OS_LINUX
+qint64 toNs(const timespec& ts) { return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec; }
+
+timespec fromNs(qint64 ns) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000LL);
+    return ts;
+}
+
+qint64 monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return toNs(ts);
+}
+#endif
+}
+
 Mpu9250Source::Mpu9250Source(TelemetryData* data, QObject* parent)
     : QObject(parent), m_data(data), m_fileDescriptor(-1) {
+    for (int i = 0; i < static_cast<int>(FusionAlgorithm::Count); ++i) {
+        m_engines[i] = createOrientationEngine(static_cast<FusionAlgorithm>(i));
+    }
+    m_engine = m_engines[static_cast<int>(FusionAlgorithm::Madgwick)].get();
+
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, &Mpu9250Source::readSensor);
 }
@@ -30,13 +70,85 @@ Mpu9250Source::~Mpu9250Source() {
     stop();
 }
 
+void Mpu9250Source::setSampleRateHz(int hz) {
+    m_sampleRateHz = std::clamp(hz, MinSampleRateHz, MaxSampleRateHz);
+}
+
+void Mpu9250Source::setPublishRateHz(int hz) {
+    m_publishRateHz = std::max(1, hz);
+}
+
+void Mpu9250Source::setRealtimePriority(bool enabled, int priority) {
+    m_realtime = enabled;
+    m_realtimePriority = std::clamp(priority, 1, 99);
+}
+
+Mpu9250Source::TimingStats Mpu9250Source::timingStats() const {
+    TimingStats stats;
+    stats.samples = m_statSamples.load(std::memory_order_relaxed);
+    stats.wakeups = m_statWakeups.load(std::memory_order_relaxed);
+    stats.missedDeadlines = m_statMissed.load(std::memory_order_relaxed);
+    // Un retard par réveil : en FIFO, un réveil vide plusieurs trames, diviser par samples sous-estimerait.
+    if (stats.wakeups > 0) {
+        stats.meanJitterUs = m_statJitterSumNs.load(std::memory_order_relaxed) / 1000.0 / stats.wakeups;
+    }
+    stats.maxJitterUs = m_statJitterMaxNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.fifoOverflows = m_statFifoOverflows.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Mpu9250Source::resetTimingStats() {
+    m_statSamples = 0;
+    m_statWakeups = 0;
+    m_statMissed = 0;
+    m_statJitterSumNs = 0;
+    m_statJitterMaxNs = 0;
+    m_statFifoOverflows = 0;
+}
+
 void Mpu9250Source::start() {
+    // Redémarrage idempotent : on repart d'un état propre (thread arrêté, bus refermé).
+    stop();
+
+    // Chaque session repart d'une orientation neutre et d'un lissage vierge.
+    activeEngine()->reset();
+    m_headingSmoother.reset();
+
+    if (m_mode == AcquisitionMode::Thread) {
+        // La configuration (dont 2 s de calibration gyro) s'exécute dans le thread d'acquisition :
+        // l'interface reste réactive pendant ce temps.
+        resetTimingStats();
+        m_running = true;
+        m_thread = std::thread(&Mpu9250Source::acquisitionLoop, this);
+
+#ifdef Q_OS_LINUX
+        if (m_realtime) {
+            sched_param param {};
+            param.sched_priority = m_realtimePriority;
+            const int rc = pthread_setschedparam(m_thread.native_handle(), SCHED_FIFO, &param);
+            if (rc != 0) {
+                qWarning() << "SCHED_FIFO refusé pour le thread IMU (errno" << rc << "), ordonnancement standard conservé.";
+            }
+        }
+#endif
+        return;
+    }
+
+    // Mode Timer : m_running n'arrête ici que la calibration (exécutée dans ce thread).
+    m_running = true;
+    if (!configureDevice()) return;
+
+    m_elapsedTimer.start();
+    m_timer->start(100); // Boucle de lecture à 10Hz
+}
+
+bool Mpu9250Source::configureDevice() {
 #ifdef Q_OS_LINUX
     qDebug() << "Tentative d'ouverture du bus I2C-1...";
     m_fileDescriptor = open("/dev/i2c-1", O_RDWR);
     if (m_fileDescriptor < 0) {
         qWarning() << "Échec de l'ouverture du bus I2C.";
-        return;
+        return false;
     }
 
     // Connexion à l'adresse I2C du MPU9250
@@ -61,9 +173,10 @@ void Mpu9250Source::start() {
     float gyroSum[3] = {0, 0, 0};
     int samples = 400;
     char reg = 0x43; // Registre de départ des données gyroscopiques
-    char dataG[6];
+    unsigned char dataG[6];
 
-    for (int i = 0; i < samples; i++) {
+    // stop() peut arriver pendant ces 2 s : on s'interrompt au lieu de faire attendre son join().
+    for (int i = 0; i < samples && m_running.load(std::memory_order_relaxed); i++) {
         write(m_fileDescriptor, &reg, 1);
         if (read(m_fileDescriptor, dataG, 6) == 6) {
             // Conversion des valeurs brutes en radians par seconde (rad/s)
@@ -73,6 +186,11 @@ void Mpu9250Source::start() {
         }
         usleep(5000); // Échantillonnage toutes les 5ms (total 2 seconde)
     }
+    if (!m_running.load(std::memory_order_relaxed)) {
+        // Biais partiel non retenu : la calibration précédente reste en place.
+        qDebug() << "Calibration du gyroscope interrompue (arrêt demandé).";
+        return false;
+    }
     m_gyroBias[0] = gyroSum[0] / samples;
     m_gyroBias[1] = gyroSum[1] / samples;
     m_gyroBias[2] = gyroSum[2] / samples;
@@ -85,14 +203,17 @@ void Mpu9250Source::start() {
 
     // Configuration du magnétomètre : 16 bits de résolution, mode continu (100Hz)
     config[0] = 0x0A; config[1] = 0x16; write(m_fileDescriptor, config, 2);
+
+    // --- Mode FIFO : le MPU9250 échantillonne seul, on ne fait que vider sa FIFO en rafale ---
+    m_fifoActive = (m_readMode == ReadMode::FifoBurst) && configureFifo();
+
     qDebug() << "Acquisition MPU9250 démarrée avec succès.";
+    return true;
 
 #else
     qWarning() << "[MODE SIMULATION] - Code compilé sous Windows/Autre. Le matériel I2C est bypassé.";
+    return true;
 #endif
-
-    m_elapsedTimer.start();
-    m_timer->start(100); // Boucle de lecture à 10Hz
 }
 
 void Mpu9250Source::readSensor() {
@@ -110,6 +231,34 @@ void Mpu9250Source::readSensor() {
     // Si le capteur n'est pas bien connecté ou initialisé, on annule tout.
     if (m_fileDescriptor < 0) return;
 
+    // Mode FIFO : tous les échantillons accumulés depuis le tick précédent sont fusionnés.
+    if (m_fifoActive) {
+        ImuSample batch[MaxFifoFrames];
+        const int count = drainFifo(batch, MaxFifoFrames);
+        if (fuseBatch(batch, count)) publishHeading();
+        return;
+    }
+
+    ImuSample sample;
+    if (!readRawSample(sample)) {
+        qDebug() << "Erreur de lecture I2C sur l'adresse 0x68 (Capteur débranché ou indisponible).";
+        return;
+    }
+    sample.dt = dt;
+
+    if (fuseSample(sample)) {
+        // Affichage console pour diagnostiquer
+        qDebug() << " Cap :" << m_heading << "° | dt:" << dt;
+        publishHeading();
+    }
+#else
+    // Empêche le compilateur Windows d'afficher un avertissement pour la variable non utilisée
+    Q_UNUSED(dt);
+#endif
+}
+
+bool Mpu9250Source::readRawSample(ImuSample& sample) {
+#ifdef Q_OS_LINUX
     // ------------------------------------------------------------------------
     // 1. LECTURE DE L'ACCÉLÉROMÈTRE ET DU GYROSCOPE
     // ------------------------------------------------------------------------
@@ -125,220 +274,378 @@ void Mpu9250Source::readSensor() {
     // - 6 octets pour l'accéléromètre (X, Y, Z)
     // - 2 octets pour le capteur de température interne
     // - 6 octets pour le gyroscope (X, Y, Z)
-    char dataAG[14];
-
-    if (write(m_fileDescriptor, &reg, 1) == 1 && read(m_fileDescriptor, dataAG, 14) == 14) {
-
-        // --- DÉCODAGE DE L'ACCÉLÉROMÈTRE ---
-        // Le capteur envoie les données "découpées" en morceaux de 8 bits (1 octet).
-        // Mais nos mesures font 16 bits ! Il faut recoller les morceaux.
-        // On prend le premier octet (High), on le décale de 8 zéros vers la gauche (<< 8),
-        // puis on "fusionne" avec le deuxième octet (Low) grâce à l'opérateur "OU" logique (|).
-        // Ensuite, on convertit la valeur brute (-32768 à +32767) en 'g' (gravité).
-        // Comme on a configuré le capteur sur +/- 2g max, on divise 2 par 32768.
-        float ax = (int16_t)((dataAG[0] << 8) | dataAG[1]) * (2.0f / 32768.0f);
-        float ay = (int16_t)((dataAG[2] << 8) | dataAG[3]) * (2.0f / 32768.0f);
-        float az = (int16_t)((dataAG[4] << 8) | dataAG[5]) * (2.0f / 32768.0f);
-
-        // --- DÉCODAGE DU GYROSCOPE ---
-        // On fait le même "recollage" de bits (octets 8 à 13, car 6 et 7 c'était la température).
-        // L'échelle est de 250 dps (degrés par seconde) maximum, donc on multiplie par (250 / 32768).
-        // IMPORTANT : Les mathématiques (Madgwick) fonctionnent en Radians, pas en Degrés !
-        // On multiplie donc par (Pi / 180) pour faire la conversion en Radians/seconde.
-        // Enfin, on soustrait l'erreur (le biais) qu'on a mesurée automatiquement au démarrage.
-        float gx = ((int16_t)((dataAG[8]  << 8) | dataAG[9]))  * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[0];
-        float gy = ((int16_t)((dataAG[10] << 8) | dataAG[11])) * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[1];
-        float gz = ((int16_t)((dataAG[12] << 8) | dataAG[13])) * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[2];
-
-        // ------------------------------------------------------------------------
-        // 2. LECTURE DU MAGNÉTOMÈTRE (LA BOUSSOLE)
-        // ------------------------------------------------------------------------
-
-        // Le magnétomètre est une puce séparée (AK8963) située à l'adresse 0x0C.
-        ioctl(m_fileDescriptor, I2C_SLAVE, 0x0C);
-
-        char st1;
-        char regSt1 = 0x02; // Registre d'état du magnétomètre
-        write(m_fileDescriptor, &regSt1, 1);
-
-        // On lit l'état. Le bit 0 (st1 & 0x01) nous dit "Data Ready".
-        // Le magnétomètre est plus lent (100Hz max), on vérifie donc s'il a une nouvelle info à donner.
-        if (read(m_fileDescriptor, &st1, 1) == 1 && (st1 & 0x01)) {
-
-            char regMag = 0x03; // Adresse du début des données magnétiques
-            char dataM[7]; // 6 octets pour (X,Y,Z) + 1 octet de statut final obligatoire
-            write(m_fileDescriptor, &regMag, 1);
-
-            if (read(m_fileDescriptor, dataM, 7) == 7) {
-                // ATTENTION PIÈGE : Contrairement à l'accéléromètre, le magnétomètre envoie
-                // le "Low byte" (petits bits) AVANT le "High byte" (gros bits).
-                // On inverse donc l'ordre dans le calcul (dataM[1] << 8 | dataM[0]).
-
-                // On applique ensuite la calibration :
-                // - Hard Iron (soustraction du biais) : annule les champs magnétiques du châssis.
-                // - Soft Iron (multiplication par l'échelle) : redonne une forme parfaitement ronde au signal.
-                float mx = ((int16_t)((dataM[1] << 8) | dataM[0]) - m_magBias[0]) * m_magScale[0];
-                float my = ((int16_t)((dataM[3] << 8) | dataM[2]) - m_magBias[1]) * m_magScale[1];
-                float mz = ((int16_t)((dataM[5] << 8) | dataM[4]) - m_magBias[2]) * m_magScale[2];
-
-                // ------------------------------------------------------------------------
-                // 3. FUSION DE DONNÉES (FILTRE DE MADGWICK)
-                // ------------------------------------------------------------------------
-
-                // Les axes physiques de la puce magnétomètre ne sont pas alignés dans le même
-                // sens que ceux du gyroscope/accéléromètre sur la carte électronique.
-                // On doit les réaligner pour utiliser le standard NED (Nord-Est-Bas).
-                // C'est pour ça qu'on croise des axes (my à la place de mx) et qu'on inverse des signes.
-                madgwickUpdate(-ax, ay, az, gx, -gy, -gz, my, -mx, mz, dt);
-
-                // ------------------------------------------------------------------------
-                // 4. CALCUL DU CAP COMPENSÉ EN INCLINAISON (TILT-COMPENSATED YAW)
-                // ------------------------------------------------------------------------
-
-                // Extraction du Roulis (Roll) et Tangage (Pitch) depuis le Quaternion.
-                // Cela nous dit comment la voiture est penchée par rapport à la gravité terrestre.
-                float roll = std::atan2(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
-                float pitch = std::asin(2.0f * (q[0] * q[2] - q[3] * q[1]));
-
-                // On projette les vecteurs magnétiques 'my' et '-mx' sur le plan horizontal (sol)
-                // en utilisant le roulis et le tangage. Cela garantit que la boussole pointe
-                // toujours le Vrai Nord, même si la voiture monte une pente raide.
-                float mag_x_horiz = my * std::cos(pitch) + (-mx) * std::sin(roll) * std::sin(pitch) - mz * std::cos(roll) * std::sin(pitch);
-                float mag_y_horiz = (-mx) * std::cos(roll) + mz * std::sin(roll);
-
-                // On calcule l'angle par rapport au Nord Magnétique à partir de cette projection
-                float yaw = std::atan2(mag_y_horiz, mag_x_horiz);
-
-                // Conversion des Radians vers les Degrés.
-                // On ajoute un signe MOINS (-) car les maths tournent en sens anti-horaire,
-                // mais la carte Qt tourne dans le sens horaire (comme une vraie boussole).
-                float heading = -yaw * (180.0f / M_PI);
-
-                // Ajout de la Déclinaison Magnétique pour pointer vers le Nord Géographique (Vrai Nord).
-                // (2.0° correspond environ à la France actuelle, ajustez si besoin).
-                heading += 2.0f;
-
-                // On s'assure que l'angle reste un cercle parfait de 0 à 360°.
-                if (heading < 0) heading += 360.0f;
-                if (heading >= 360.0f) heading -= 360.0f;
-
-                // ------------------------------------------------------------------------
-                // 5. FILTRE DE LISSAGE (PASSE-BAS VISUEL)
-                // ------------------------------------------------------------------------
-
-                // On mélange 90% de l'ancien cap avec 10% du nouveau.
-                // Cela empêche la carte de faire des micro-tremblements à l'écran à cause des vibrations.
-                static float smoothedHeading = heading;
-
-                // Gestion du passage difficile entre 359° et 0° pour éviter que la carte ne fasse
-                // un tour complet sur elle-même lors du passage du Nord.
-                float diff = heading - smoothedHeading;
-                if (diff > 180.0f) smoothedHeading += 360.0f;
-                else if (diff < -180.0f) smoothedHeading -= 360.0f;
-
-                smoothedHeading = (smoothedHeading * 0.90f) + (heading * 0.10f);
-
-                // On remet la valeur lissée proprement entre 0 et 360°.
-                if (smoothedHeading >= 360.0f) smoothedHeading -= 360.0f;
-                else if (smoothedHeading < 0.0f) smoothedHeading += 360.0f;
-
-                // Affichage console pour diagnostiquer
-                qDebug() << " Cap :" << smoothedHeading << "° | dt:" << dt;
-
-                // On envoie cet angle tout propre à l'interface graphique (QML) pour faire tourner la carte !
-                if (m_data) m_data->setHeading(static_cast<double>(smoothedHeading));
-            }
-        }
-    } else {
-        qDebug() << "Erreur de lecture I2C sur l'adresse 0x68 (Capteur débranché ou indisponible).";
+    // Les octets sont non signés : seul le mot 16 bits recomposé porte le signe.
+    unsigned char dataAG[14];
+
+    if (write(m_fileDescriptor, &reg, 1) != 1 || read(m_fileDescriptor, dataAG, 14) != 14) return false;
+
+    // Octets 0-5 : accéléromètre, 6-7 : température (ignorée), 8-13 : gyroscope.
+    decodeAccelGyro(dataAG, dataAG + 8, sample);
+    sample.timestampNs = monotonicNs();
+    sample.magValid = false;
+
+    // ------------------------------------------------------------------------
+    // 2. LECTURE DU MAGNÉTOMÈTRE (LA BOUSSOLE)
+    // ------------------------------------------------------------------------
+
+    // Le magnétomètre est une puce séparée (AK8963) située à l'adresse 0x0C.
+    ioctl(m_fileDescriptor, I2C_SLAVE, 0x0C);
+
+    char st1;
+    char regSt1 = 0x02; // Registre d'état du magnétomètre
+    write(m_fileDescriptor, &regSt1, 1);
+
+    // On lit l'état. Le bit 0 (st1 & 0x01) nous dit "Data Ready".
+    // Le magnétomètre est plus lent (100Hz max), on vérifie donc s'il a une nouvelle info à donner.
+    if (read(m_fileDescriptor, &st1, 1) == 1 && (st1 & 0x01)) {
+
+        char regMag = 0x03; // Adresse du début des données magnétiques
+        unsigned char dataM[7]; // 6 octets pour (X,Y,Z) + 1 octet de statut final obligatoire
+        write(m_fileDescriptor, &regMag, 1);
+
+        if (read(m_fileDescriptor, dataM, 7) == 7) decodeMag(dataM, sample);
     }
+    return true;
 #else
-    // Empêche le compilateur Windows d'afficher un avertissement pour la variable non utilisée
-    Q_UNUSED(dt);
+    Q_UNUSED(sample);
+    return false;
 #endif
 }
 
-/**
- * @brief Filtre de fusion de capteurs de Madgwick (Implémentation optimisée).
- * @details Cet algorithme estime l'orientation 3D (quaternions) en fusionnant les données :
- * - Le Gyroscope calcule les rotations rapides (mais dérive dans le temps).
- * - L'Accéléromètre trouve la gravité (vecteur Bas) pour corriger le tangage/roulis.
- * - Le Magnétomètre trouve le Nord magnétique pour corriger le lacet (Cap).
- * La descente de gradient permet de converger vers l'orientation réelle.
- */
-void Mpu9250Source::madgwickUpdate(float ax, float ay, float az, float gx, float gy, float gz, float mx, float my, float mz, float dt) {
-    float q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3];
-    float norm;
-    float hx, hy, _2bx, _2bz;
-    float s1, s2, s3, s4;
-    float qDot1, qDot2, qDot3, qDot4;
-
-    // Variables auxiliaires pour optimiser les performances (éviter les calculs répétitifs)
-    float _2q1mx; float _2q1my; float _2q1mz; float _2q2mx;
-    float _4bx; float _4bz;
-    float _2q1 = 2.0f * q1; float _2q2 = 2.0f * q2; float _2q3 = 2.0f * q3; float _2q4 = 2.0f * q4;
-    float _2q1q3 = 2.0f * q1 * q3; float _2q3q4 = 2.0f * q3 * q4;
-    float q1q1 = q1 * q1; float q1q2 = q1 * q2; float q1q3 = q1 * q3; float q1q4 = q1 * q4;
-    float q2q2 = q2 * q2; float q2q3 = q2 * q3; float q2q4 = q2 * q4;
-    float q3q3 = q3 * q3; float q3q4 = q3 * q4; float q4q4 = q4 * q4;
-
-    // 1. Normalisation du vecteur d'accélération (Gravité)
-    norm = std::sqrt(ax * ax + ay * ay + az * az);
-    if (norm == 0.0f) return; // Sécurité contre la division par zéro
-    norm = 1.0f/norm;
-    ax *= norm; ay *= norm; az *= norm;
-
-    // 2. Normalisation du vecteur magnétique (Nord)
-    norm = std::sqrt(mx * mx + my * my + mz * mz);
-    if (norm == 0.0f) return;
-    norm = 1.0f/norm;
-    mx *= norm; my *= norm; mz *= norm;
-
-    // 3. Calcul de la direction de référence du champ magnétique
-    _2q1mx = 2.0f * q1 * mx;
-    _2q1my = 2.0f * q1 * my;
-    _2q1mz = 2.0f * q1 * mz;
-    _2q2mx = 2.0f * q2 * mx;
-    hx = mx * q1q1 - _2q1my * q4 + _2q1mz * q3 + mx * q2q2 + _2q2 * my * q3 + _2q2 * mz * q4 - mx * q3q3 - mx * q4q4;
-    hy = _2q1mx * q4 + my * q1q1 - _2q1mz * q2 + _2q2mx * q3 - my * q2q2 + my * q3q3 + _2q3 * mz * q4 - my * q4q4;
-    _2bx = std::sqrt(hx * hx + hy * hy);
-    _2bz = -_2q1mx * q3 + _2q1my * q2 + mz * q1q1 + _2q2mx * q4 - mz * q2q2 + _2q3 * my * q4 - mz * q3q3 + mz * q4q4;
-    _4bx = 2.0f * _2bx;
-    _4bz = 2.0f * _2bz;
-
-    // 4. Descente de gradient : Calcul de l'erreur d'orientation
-    s1 = -_2q3 * (2.0f * q2q4 - _2q1q3 - ax) + _2q2 * (2.0f * q1q2 + _2q3q4 - ay) - _2bz * q3 * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (-_2bx * q4 + _2bz * q2) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + _2bx * q3 * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
-    s2 = _2q4 * (2.0f * q2q4 - _2q1q3 - ax) + _2q1 * (2.0f * q1q2 + _2q3q4 - ay) - 4.0f * q2 * (1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az) + _2bz * q4 * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (_2bx * q3 + _2bz * q1) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + (_2bx * q4 - _4bz * q2) * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
-    s3 = -_2q1 * (2.0f * q2q4 - _2q1q3 - ax) + _2q4 * (2.0f * q1q2 + _2q3q4 - ay) - 4.0f * q3 * (1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az) + (-_4bx * q3 - _2bz * q1) * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (_2bx * q2 + _2bz * q4) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + (_2bx * q1 - _4bz * q3) * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
-    s4 = _2q2 * (2.0f * q2q4 - _2q1q3 - ax) + _2q3 * (2.0f * q1q2 + _2q3q4 - ay) + (-_4bx * q4 + _2bz * q2) * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (-_2bx * q1 + _2bz * q3) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + _2bx * q2 * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
-    norm = std::sqrt(s1 * s1 + s2 * s2 + s3 * s3 + s4 * s4); // Normalisation de l'erreur
-    norm = 1.0f/norm;
-    s1 *= norm; s2 *= norm; s3 *= norm; s4 *= norm;
-
-    // 5. Calcul du taux de changement du quaternion (Fusion Gyroscope + Erreur corrigée par beta)
-    qDot1 = 0.5f * (-q2 * gx - q3 * gy - q4 * gz) - beta * s1;
-    qDot2 = 0.5f * (q1 * gx + q3 * gz - q4 * gy) - beta * s2;
-    qDot3 = 0.5f * (q1 * gy - q2 * gz + q4 * gx) - beta * s3;
-    qDot4 = 0.5f * (q1 * gz + q2 * gy - q3 * gx) - beta * s4;
-
-    // 6. Intégration dans le temps pour obtenir le nouveau quaternion d'orientation
-    q1 += qDot1 * dt;
-    q2 += qDot2 * dt;
-    q3 += qDot3 * dt;
-    q4 += qDot4 * dt;
-
-    // 7. Normalisation finale du quaternion
-    norm = std::sqrt(q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4);
-    norm = 1.0f/norm;
-
-    q[0] = q1 * norm;
-    q[1] = q2 * norm;
-    q[2] = q3 * norm;
-    q[3] = q4 * norm;
+void Mpu9250Source::decodeAccelGyro(const unsigned char* accel, const unsigned char* gyro, ImuSample& sample) const {
+    // --- DÉCODAGE DE L'ACCÉLÉROMÈTRE ---
+    // Le capteur envoie les données "découpées" en morceaux de 8 bits (1 octet).
+    // Mais nos mesures font 16 bits ! Il faut recoller les morceaux.
+    // On prend le premier octet (High), on le décale de 8 zéros vers la gauche (<< 8),
+    // puis on "fusionne" avec le deuxième octet (Low) grâce à l'opérateur "OU" logique (|).
+    // Ensuite, on convertit la valeur brute (-32768 à +32767) en 'g' (gravité).
+    // Comme on a configuré le capteur sur +/- 2g max, on divise 2 par 32768.
+    float ax = (int16_t)((accel[0] << 8) | accel[1]) * (2.0f / 32768.0f);
+    float ay = (int16_t)((accel[2] << 8) | accel[3]) * (2.0f / 32768.0f);
+    float az = (int16_t)((accel[4] << 8) | accel[5]) * (2.0f / 32768.0f);
+
+    // --- DÉCODAGE DU GYROSCOPE ---
+    // On fait le même "recollage" de bits.
+    // L'échelle est de 250 dps (degrés par seconde) maximum, donc on multiplie par (250 / 32768).
+    // IMPORTANT : Les mathématiques (Madgwick) fonctionnent en Radians, pas en Degrés !
+    // On multiplie donc par (Pi / 180) pour faire la conversion en Radians/seconde.
+    // Enfin, on soustrait l'erreur (le biais) qu'on a mesurée automatiquement au démarrage.
+    float gx = ((int16_t)((gyro[0] << 8) | gyro[1])) * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[0];
+    float gy = ((int16_t)((gyro[2] << 8) | gyro[3])) * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[1];
+    float gz = ((int16_t)((gyro[4] << 8) | gyro[5])) * (250.0f / 32768.0f) * (M_PI / 180.0f) - m_gyroBias[2];
+
+    // Les axes physiques de la puce magnétomètre ne sont pas alignés dans le même
+    // sens que ceux du gyroscope/accéléromètre sur la carte électronique.
+    // On doit les réaligner pour utiliser le standard NED (Nord-Est-Bas).
+    // C'est pour ça qu'on croise des axes (my à la place de mx) et qu'on inverse des signes.
+    sample.ax = -ax; sample.ay = ay; sample.az = az;
+    sample.gx = gx; sample.gy = -gy; sample.gz = -gz;
+}
+
+void Mpu9250Source::decodeMag(const unsigned char* dataM, ImuSample& sample) const {
+    // ATTENTION PIÈGE : Contrairement à l'accéléromètre, le magnétomètre envoie
+    // le "Low byte" (petits bits) AVANT le "High byte" (gros bits).
+    // On inverse donc l'ordre dans le calcul (dataM[1] << 8 | dataM[0]).
+    // L'octet 6 (ST2) signale un débordement magnétique (bit HOFL) : la mesure est alors ignorée.
+    if (dataM[6] & 0x08) return;
+
+    // On applique ensuite la calibration :
+    // - Hard Iron (soustraction du biais) : annule les champs magnétiques du châssis.
+    // - Soft Iron (multiplication par l'échelle) : redonne une forme parfaitement ronde au signal.
+    float mx = ((int16_t)((dataM[1] << 8) | dataM[0]) - m_magBias[0]) * m_magScale[0];
+    float my = ((int16_t)((dataM[3] << 8) | dataM[2]) - m_magBias[1]) * m_magScale[1];
+    float mz = ((int16_t)((dataM[5] << 8) | dataM[4]) - m_magBias[2]) * m_magScale[2];
+
+    sample.mx = my; sample.my = -mx; sample.mz = mz; // Réalignement NED (voir decodeAccelGyro)
+    sample.magValid = true;
+}
+
+bool Mpu9250Source::i2cWriteRegister(quint8 address, quint8 reg, quint8 value) {
+#ifdef Q_OS_LINUX
+    quint8 buffer[2] = {reg, value};
+    i2c_msg msg {};
+    msg.addr = address;
+    msg.flags = 0;
+    msg.len = 2;
+    msg.buf = buffer;
+    i2c_rdwr_ioctl_data transfer {&msg, 1};
+    return ioctl(m_fileDescriptor, I2C_RDWR, &transfer) == 1;
+#else
+    Q_UNUSED(address); Q_UNUSED(reg); Q_UNUSED(value);
+    return false;
+#endif
+}
+
+bool Mpu9250Source::i2cReadRegisters(quint8 address, quint8 reg, quint8* buffer, quint16 length) {
+#ifdef Q_OS_LINUX
+    // Transaction combinée (écriture du registre + lecture avec "repeated start") en un seul appel système :
+    // pas d'ioctl(I2C_SLAVE) ni de couple write()/read() séparés.
+    i2c_msg msgs[2] {};
+    msgs[0].addr = address;
+    msgs[0].flags = 0;
+    msgs[0].len = 1;
+    msgs[0].buf = &reg;
+    msgs[1].addr = address;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len = length;
+    msgs[1].buf = buffer;
+    i2c_rdwr_ioctl_data transfer {msgs, 2};
+    return ioctl(m_fileDescriptor, I2C_RDWR, &transfer) == 2;
+#else
+    Q_UNUSED(address); Q_UNUSED(reg); Q_UNUSED(buffer); Q_UNUSED(length);
+    return false;
+#endif
+}
+
+bool Mpu9250Source::configureFifo() {
+    // Le magnétomètre a déjà été mis en mode continu 100 Hz via le bypass (configureDevice).
+    // On coupe maintenant le bypass et on confie sa lecture au maître I2C interne du MPU9250 :
+    // l'esclave 0 recopie à chaque échantillon ST1..ST2 (8 octets) dans EXT_SENS_DATA,
+    // et ces octets entrent dans la FIFO juste après l'accéléromètre et le gyroscope.
+    const int divider = std::max(0, 1000 / m_sampleRateHz - 1); // DLPF actif : horloge interne à 1 kHz
+
+    bool ok = true;
+    ok &= i2cWriteRegister(0x68, 0x37, 0x00);            // INT_PIN_CFG : bypass désactivé
+    ok &= i2cWriteRegister(0x68, 0x19, quint8(divider)); // SMPLRT_DIV : fréquence d'échantillonnage
+    ok &= i2cWriteRegister(0x68, 0x24, 0x0D);            // I2C_MST_CTRL : maître I2C à 400 kHz
+    ok &= i2cWriteRegister(0x68, 0x25, 0x80 | 0x0C);     // I2C_SLV0_ADDR : lecture de l'AK8963
+    ok &= i2cWriteRegister(0x68, 0x26, 0x02);            // I2C_SLV0_REG : à partir de ST1 (DRDY)
+    ok &= i2cWriteRegister(0x68, 0x27, 0x80 | 8);        // I2C_SLV0_CTRL : activé, 8 octets (ST2 inclus)
+    ok &= i2cWriteRegister(0x68, 0x6A, 0x20 | 0x04);     // USER_CTRL : I2C_MST_EN + remise à zéro FIFO
+    ok &= i2cWriteRegister(0x68, 0x23, 0x78 | 0x01);     // FIFO_EN : accel + gyro XYZ + esclave 0
+    ok &= i2cWriteRegister(0x68, 0x6A, 0x20 | 0x40);     // USER_CTRL : I2C_MST_EN + FIFO_EN
+
+    if (!ok) qWarning() << "Configuration FIFO du MPU9250 impossible, retour au mode registre.";
+    return ok;
+}
+
+int Mpu9250Source::drainFifo(ImuSample* samples, int maxSamples) {
+    // 1. Nombre d'octets disponibles (FIFO_COUNTH/L, 13 bits).
+    quint8 countBytes[2];
+    if (!i2cReadRegisters(0x68, 0x72, countBytes, 2)) return -1;
+    const int count = ((countBytes[0] & 0x1F) << 8) | countBytes[1];
+
+    // 2. FIFO pleine : les trames les plus anciennes ont été écrasées et la frontière entre trames est
+    //    perdue, on repart à zéro. Une trame incomplète (écriture en cours) n'est pas un désalignement :
+    //    elle reste dans la FIFO et sera lue entière au lot suivant.
+    if (count >= FifoCapacity) {
+        m_statFifoOverflows.fetch_add(1, std::memory_order_relaxed);
+        i2cWriteRegister(0x68, 0x6A, 0x20 | 0x40 | 0x04); // FIFO_RESET en conservant maître I2C + FIFO
+        return 0;
+    }
+
+    const int frames = std::min(count / FifoFrameSize, maxSamples);
+    if (frames == 0) return 0;
+
+    // 3. Lecture en rafale de toutes les trames complètes en une seule transaction.
+    quint8 buffer[MaxFifoFrames * FifoFrameSize];
+    if (!i2cReadRegisters(0x68, 0x74, buffer, quint16(frames * FifoFrameSize))) return -1;
+
+    // Les échantillons sont espacés exactement d'une période de l'horloge interne du capteur :
+    // le plus récent est daté de maintenant, les précédents sont rétro-datés.
+    const float period = 1.0f / m_sampleRateHz;
+    const qint64 periodNs = 1000000000LL / m_sampleRateHz;
+    const qint64 now = TelemetryData::monotonicNowNs();
+
+    for (int i = 0; i < frames; ++i) {
+        const quint8* frame = buffer + i * FifoFrameSize;
+        ImuSample& sample = samples[i];
+        decodeFifoFrame(frame, sample);
+        sample.dt = period;
+        sample.timestampNs = now - (frames - 1 - i) * periodNs;
+    }
+    return frames;
+}
+
+void Mpu9250Source::decodeFifoFrame(const unsigned char* frame, ImuSample& sample) const {
+    sample = ImuSample();
+    decodeAccelGyro(frame, frame + 6, sample);  // 0-5 : accel, 6-11 : gyro (température non incluse)
+    if (frame[12] & 0x01) decodeMag(frame + 13, sample); // 12 : ST1 (DRDY), 13-19 : HXL..HZH + ST2
+}
+
+bool Mpu9250Source::fuseSample(const ImuSample& sample) {
+    // ------------------------------------------------------------------------
+    // 3. FUSION DE DONNÉES (FILTRE CHOISI : MADGWICK, MAHONY OU ESKF)
+    // ------------------------------------------------------------------------
+    OrientationEngine* engine = activeEngine();
+    if (!engine->update(sample)) return false;
+
+    if (m_tripLog) m_tripLog->logImu(sample);
+    pushMotion(engine, sample, updateHeading(engine, sample.dt));
+    return true;
+}
+
+bool Mpu9250Source::fuseBatch(const ImuSample* samples, int count) {
+    if (count <= 0) return false;
+
+    OrientationEngine* engine = activeEngine();
+    if (!engine->updateBatch(samples, static_cast<std::size_t>(count))) return false;
+
+    if (m_tripLog) {
+        for (int i = 0; i < count; ++i) m_tripLog->logImu(samples[i]);
+    }
+
+    // Le cap n'est recalculé qu'une fois par lot : le lissage reçoit la durée totale couverte.
+    // L'estime reçoit une mesure par lot : accélération moyenne, horodatage du dernier échantillon.
+    float elapsed = 0.0f;
+    ImuSample mean = samples[count - 1];
+    mean.ax = mean.ay = mean.az = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        elapsed += samples[i].dt;
+        mean.ax += samples[i].ax;
+        mean.ay += samples[i].ay;
+        mean.az += samples[i].az;
+    }
+    mean.ax /= count;
+    mean.ay /= count;
+    mean.az /= count;
+    pushMotion(engine, mean, updateHeading(engine, elapsed));
+    return true;
+}
+
+float Mpu9250Source::updateHeading(OrientationEngine* engine, float dt) {
+    // ------------------------------------------------------------------------
+    // 4. CALCUL DU CAP COMPENSÉ EN INCLINAISON (TILT-COMPENSATED YAW)
+    // ------------------------------------------------------------------------
+    float heading = engine->computeHeading() + MagneticDeclinationDeg;
+    if (heading >= 360.0f) heading -= 360.0f;
+
+    // ------------------------------------------------------------------------
+    // 5. FILTRE DE LISSAGE (PASSE-BAS VISUEL)
+    // ------------------------------------------------------------------------
+    m_heading = m_headingSmoother.update(heading, dt);
+    return heading;
+}
+
+void Mpu9250Source::pushMotion(const OrientationEngine* engine, const ImuSample& sample, float headingDeg) {
+    if (!m_motionSink) return;
+
+    // Au repos, l'accéléromètre mesure la direction de la gravité dans le repère capteur, soit la
+    // troisième ligne de la matrice de rotation : l'écart sur l'axe X (axe longitudinal du véhicule)
+    // est l'accélération propre, ramenée en m/s².
+    const float* q = engine->quaternion();
+    const float gravityX = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+
+    MotionSample motion;
+    motion.timestampNs = sample.timestampNs;
+    motion.headingDeg = headingDeg;
+    motion.forwardAccelMs2 = (gravityX - sample.ax) * StandardGravity;
+    m_motionSink->pushMotion(motion);
+}
+
+OrientationEngine* Mpu9250Source::activeEngine() {
+    // Changement d'algorithme demandé depuis un autre thread : le nouveau filtre repart
+    // de l'orientation courante pour éviter un saut de cap à l'écran.
+    const int requested = m_requestedAlgorithm.load(std::memory_order_acquire);
+    OrientationEngine* engine = m_engines[requested].get();
+    if (engine != m_engine) {
+        engine->reset(m_engine->quaternion());
+        m_engine = engine;
+    }
+    return m_engine;
+}
+
+void Mpu9250Source::setFusionAlgorithm(FusionAlgorithm algorithm) {
+    if (algorithm == FusionAlgorithm::Count) return;
+    m_requestedAlgorithm.store(static_cast<int>(algorithm), std::memory_order_release);
+}
+
+FusionAlgorithm Mpu9250Source::fusionAlgorithm() const {
+    return static_cast<FusionAlgorithm>(m_requestedAlgorithm.load(std::memory_order_acquire));
+}
+
+OrientationEngine::Stats Mpu9250Source::fusionStats(FusionAlgorithm algorithm) const {
+    if (algorithm == FusionAlgorithm::Count) return OrientationEngine::Stats();
+    return m_engines[static_cast<int>(algorithm)]->stats();
+}
+
+OrientationEngine::Stats Mpu9250Source::fusionStats() const {
+    return fusionStats(fusionAlgorithm());
+}
+
+void Mpu9250Source::publishHeading() {
+    // On envoie cet angle tout propre à l'interface graphique (QML) pour faire tourner la carte !
+    // publish() est sûr depuis le thread d'acquisition (file sans verrou dédiée à l'IMU).
+    if (m_tripLog) m_tripLog->logHeading(static_cast<double>(m_heading), TelemetryData::monotonicNowNs());
+    if (!m_data) return;
+    TelemetrySnapshot update;
+    update.heading = static_cast<double>(m_heading);
+    m_data->publish(TelemetryData::ImuSource, update, TelemetryData::HeadingField);
+}
+
+void Mpu9250Source::acquisitionLoop() {
+#ifdef Q_OS_LINUX
+    if (!configureDevice()) {
+        m_running = false;
+        return;
+    }
+
+    // En mode FIFO, le capteur échantillonne seul : le thread ne se réveille qu'à la cadence
+    // de publication pour vider la FIFO (en restant sous sa capacité de 26 trames).
+    const int wakeRateHz = m_fifoActive
+            ? std::max({m_publishRateHz, m_sampleRateHz / (MaxFifoFrames / 2), 1})
+            : m_sampleRateHz;
+    const qint64 periodNs = 1000000000LL / wakeRateHz;
+    const int publishEvery = std::max(1, m_sampleRateHz / std::min(m_publishRateHz, m_sampleRateHz));
+
+    qint64 deadlineNs = monotonicNs();
+    qint64 previousNs = deadlineNs;
+    quint64 fused = 0;
+    ImuSample batch[MaxFifoFrames];
+
+    while (m_running.load(std::memory_order_relaxed)) {
+        if (m_fifoActive) {
+            // --- Vidage en rafale : une transaction I2C pour tout le lot ---
+            const int count = drainFifo(batch, MaxFifoFrames);
+            if (fuseBatch(batch, count)) publishHeading();
+            if (count > 0) m_statSamples.fetch_add(static_cast<quint64>(count), std::memory_order_relaxed);
+        } else {
+            // --- Acquisition + fusion de l'échantillon courant ---
+            ImuSample sample;
+            if (readRawSample(sample)) {
+                sample.dt = (sample.timestampNs - previousNs) / 1e9f;
+                previousNs = sample.timestampNs;
+
+                // Le filtre tourne à pleine fréquence, l'interface n'est notifiée qu'à la cadence UI.
+                if (fuseSample(sample) && (++fused % publishEvery) == 0) publishHeading();
+            }
+            m_statSamples.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // --- Attente de l'échéance absolue suivante ---
+        // Une échéance absolue n'accumule pas la durée des lectures I2C, contrairement à un usleep(période).
+        deadlineNs += periodNs;
+        const timespec deadline = fromNs(deadlineNs);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+        const qint64 lateNs = std::max<qint64>(0, monotonicNs() - deadlineNs);
+        m_statWakeups.fetch_add(1, std::memory_order_relaxed);
+        m_statJitterSumNs.fetch_add(lateNs, std::memory_order_relaxed);
+        if (lateNs > m_statJitterMaxNs.load(std::memory_order_relaxed)) {
+            m_statJitterMaxNs.store(lateNs, std::memory_order_relaxed);
+        }
+
+        // Plus d'une période de retard : les échéances intermédiaires sont perdues, on se recale
+        // sur l'instant présent plutôt que d'enchaîner des lectures en rafale pour "rattraper".
+        if (lateNs >= periodNs) {
+            m_statMissed.fetch_add(static_cast<quint64>(lateNs / periodNs), std::memory_order_relaxed);
+            deadlineNs += (lateNs / periodNs) * periodNs;
+        }
+    }
+#else
+    configureDevice();
+    m_running = false; // Aucun matériel I2C : rien à échantillonner hors Linux
+#endif
 }
 
 void Mpu9250Source::stop() {
     m_timer->stop();
+
+    // Le thread d'acquisition est rejoint avant de fermer le bus qu'il utilise.
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+    m_fifoActive = false;
+
 #ifdef Q_OS_LINUX
     if (m_fileDescriptor >= 0) {
         close(m_fileDescriptor);
@@ -9,20 +9,72 @@
 #include <QObject>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <memory>
+#include "imusample.h"
+#include "orientationengine.h"
 
+class DeadReckoning;
 class TelemetryData;
+class TripLogWriter;
 
 /**
  * @class Mpu9250Source
  * @brief Contrôleur matériel d'acquisition pour la centrale inertielle MPU9250.
  * @details Communique via le bus I2C physique (ex: broches du Raspberry Pi) pour
  * récupérer les données brutes de l'accéléromètre, du gyroscope et du magnétomètre.
- * Utilise ensuite l'algorithme de fusion de capteurs de Madgwick pour calculer
- * l'orientation 3D (quaternions) et en déduire le cap (Heading) du véhicule.
+ * Confie ensuite les échantillons à un filtre de fusion (OrientationEngine : Madgwick par défaut,
+ * Mahony ou ESKF, sélectionnable à chaud) pour calculer l'orientation 3D (quaternions)
+ * et en déduire le cap (Heading) du véhicule.
+ *
+ * Deux modes d'acquisition sont disponibles :
+ * - AcquisitionMode::Timer : historique, QTimer à 10 Hz dans le thread GUI.
+ * - AcquisitionMode::Thread : thread dédié cadencé à 50–200 Hz sur échéances absolues
+ *   (optionnellement en SCHED_FIFO), le cap étant publié vers TelemetryData à une cadence UI plus basse.
+ *
+ * Indépendamment, ReadMode::FifoBurst laisse le capteur échantillonner seul dans sa FIFO
+ * (magnétomètre inclus via le maître I2C interne) et vide celle-ci par lots.
  */
 class Mpu9250Source : public QObject {
     Q_OBJECT
 public:
+    /**
+     * @brief Mode d'exécution de la boucle d'acquisition.
+     */
+    enum class AcquisitionMode {
+        Timer,   ///< QTimer à 10 Hz dans le thread GUI (I2C bloquant dans la boucle d'événements).
+        Thread   ///< Thread temps réel dédié, fréquence configurable (setSampleRateHz).
+    };
+
+    /**
+     * @brief Méthode de lecture des mesures sur le bus I2C.
+     */
+    enum class ReadMode {
+        RegisterPolling, ///< Lecture des registres à chaque échantillon (~6 appels système par échantillon).
+        FifoBurst        ///< Vidage de la FIFO matérielle par lots (2 transactions I2C_RDWR par lot).
+    };
+
+    /**
+     * @struct TimingStats
+     * @brief Statistiques de cadencement de la boucle d'acquisition (mode Thread).
+     */
+    struct TimingStats {
+        quint64 samples = 0;          ///< Nombre d'échantillons acquis.
+        quint64 wakeups = 0;          ///< Réveils de la boucle (un par échéance, plusieurs échantillons en FIFO).
+        quint64 missedDeadlines = 0;  ///< Échéances dépassées de plus d'une période complète.
+        double meanJitterUs = 0.0;    ///< Retard moyen d'un réveil par rapport à son échéance (µs).
+        double maxJitterUs = 0.0;     ///< Retard maximal observé (µs).
+        quint64 fifoOverflows = 0;    ///< Remises à zéro de la FIFO (débordement).
+    };
+
+    static constexpr int MinSampleRateHz = 50;   ///< Fréquence minimale du mode Thread.
+    static constexpr int MaxSampleRateHz = 200;  ///< Fréquence maximale du mode Thread.
+    static constexpr int FifoFrameSize = 20;     ///< Trame FIFO : accel (6) + gyro (6) + AK8963 ST1..ST2 (8).
+    static constexpr int FifoCapacity = 512;     ///< Taille de la FIFO matérielle (octets).
+    static constexpr int MaxFifoFrames = FifoCapacity / FifoFrameSize; ///< Trames complètes tenant dans la FIFO.
+
     /**
      * @brief Constructeur de la source MPU9250.
      * @param data Pointeur vers le modèle de télémétrie partagé pour y injecter le cap.
@@ -38,7 +90,9 @@ public:
     /**
      * @brief Démarre l'acquisition matérielle.
      * @details Ouvre le bus I2C, réveille le capteur, configure les filtres passe-bas (DLPF),
-     * exécute une auto-calibration du gyroscope (stationnaire), et lance le timer de lecture.
+     * exécute une auto-calibration du gyroscope (stationnaire), et lance le timer de lecture
+     * (mode Timer) ou le thread d'acquisition (mode Thread, la configuration s'y exécute alors
+     * pour ne pas bloquer l'interface pendant la calibration).
      */
     void start();
 
@@ -47,6 +101,84 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Choisit le mode d'acquisition (pris en compte au prochain start()).
+     * @param mode Timer (par défaut) ou Thread.
+     */
+    void setAcquisitionMode(AcquisitionMode mode) { m_mode = mode; }
+    AcquisitionMode acquisitionMode() const { return m_mode; } ///< Mode d'acquisition courant.
+
+    /**
+     * @brief Choisit la méthode de lecture I2C (pris en compte au prochain start()).
+     * @param mode RegisterPolling (par défaut) ou FifoBurst (repli automatique sur RegisterPolling
+     * si la configuration de la FIFO échoue).
+     */
+    void setReadMode(ReadMode mode) { m_readMode = mode; }
+    ReadMode readMode() const { return m_readMode; } ///< Méthode de lecture demandée.
+
+    /**
+     * @brief Choisit le filtre de fusion, y compris pendant l'acquisition.
+     * @details Le changement est appliqué par le thread d'acquisition au prochain échantillon ;
+     * le nouveau filtre repart de l'orientation courante.
+     * @param algorithm Madgwick (par défaut), Mahony ou Eskf.
+     */
+    void setFusionAlgorithm(FusionAlgorithm algorithm);
+    FusionAlgorithm fusionAlgorithm() const; ///< Filtre de fusion sélectionné.
+
+    /**
+     * @brief Coût CPU moyen et variance du cap d'un filtre (lisibles depuis n'importe quel thread).
+     * @param algorithm Filtre interrogé ; chaque filtre conserve ses propres statistiques.
+     */
+    OrientationEngine::Stats fusionStats(FusionAlgorithm algorithm) const;
+    OrientationEngine::Stats fusionStats() const; ///< Statistiques du filtre sélectionné.
+
+    /**
+     * @brief Branche l'étage de navigation à l'estime (à appeler avant start()).
+     * @details Après chaque fusion, le cap brut (non lissé) et l'accélération longitudinale
+     * sont transmis via DeadReckoning::pushMotion(), sans verrou depuis le thread d'acquisition.
+     * @param sink Estimateur destinataire, ou nullptr pour ne plus rien transmettre.
+     */
+    void setMotionSink(DeadReckoning* sink) { m_motionSink = sink; }
+
+    /**
+     * @brief Branche le journal de trajet (à appeler avant start()).
+     * @details Chaque échantillon fusionné et chaque cap publié y sont copiés sans blocage
+     * (file dédiée au contexte d'acquisition).
+     * @param log Journal destinataire, ou nullptr pour ne plus rien journaliser.
+     */
+    void setTripLog(TripLogWriter* log) { m_tripLog = log; }
+
+    /**
+     * @brief Fréquence d'échantillonnage du mode Thread, bornée à [50, 200] Hz.
+     * @param hz Fréquence souhaitée (100 Hz par défaut).
+     */
+    void setSampleRateHz(int hz);
+    int sampleRateHz() const { return m_sampleRateHz; } ///< Fréquence d'échantillonnage effective.
+
+    /**
+     * @brief Fréquence de publication du cap vers l'interface en mode Thread.
+     * @param hz Fréquence souhaitée (20 Hz par défaut, plafonnée à la fréquence d'échantillonnage).
+     */
+    void setPublishRateHz(int hz);
+    int publishRateHz() const { return m_publishRateHz; } ///< Fréquence de publication UI.
+
+    /**
+     * @brief Demande l'ordonnancement temps réel SCHED_FIFO du thread d'acquisition (Linux).
+     * @param enabled true pour activer (nécessite CAP_SYS_NICE, sinon repli silencieux sur SCHED_OTHER).
+     * @param priority Priorité SCHED_FIFO (1 à 99).
+     */
+    void setRealtimePriority(bool enabled, int priority = 50);
+
+    /**
+     * @brief Statistiques de gigue et d'échéances manquées (lisibles depuis n'importe quel thread).
+     */
+    TimingStats timingStats() const;
+
+    /**
+     * @brief Remet à zéro les compteurs de cadencement.
+     */
+    void resetTimingStats();
+
 private slots:
     /**
      * @brief Routine de lecture appelée à intervalle régulier par le timer.
@@ -57,19 +189,116 @@ private slots:
 
 private:
     /**
-     * @brief Implémentation du filtre de fusion de capteurs de Madgwick (Méthode Kris Winer).
-     * @param ax Accélération sur l'axe X (en g).
-     * @param ay Accélération sur l'axe Y (en g).
-     * @param az Accélération sur l'axe Z (en g).
-     * @param gx Vitesse angulaire sur l'axe X (en rad/s).
-     * @param gy Vitesse angulaire sur l'axe Y (en rad/s).
-     * @param gz Vitesse angulaire sur l'axe Z (en rad/s).
-     * @param mx Champ magnétique sur l'axe X (normalisé).
-     * @param my Champ magnétique sur l'axe Y (normalisé).
-     * @param mz Champ magnétique sur l'axe Z (normalisé).
-     * @param dt Delta de temps écoulé depuis la dernière mise à jour (en secondes).
+     * @brief Ouvre le bus I2C et configure le MPU9250 et son magnétomètre (calibration gyro incluse).
+     * @details La calibration (2 s) s'interrompt dès que m_running passe à false (stop()).
+     * @return true si le bus a pu être ouvert et la calibration menée à son terme.
+     */
+    bool configureDevice();
+
+    /**
+     * @brief Lit un échantillon 9 axes sur le bus I2C et le calibre.
+     * @param sample Échantillon rempli (repère NED, unités physiques).
+     * @return false en cas d'erreur de lecture accéléromètre/gyroscope.
+     */
+    bool readRawSample(ImuSample& sample);
+
+    /**
+     * @brief Décode les registres accéléromètre/gyroscope (big-endian) en unités physiques, repère NED.
+     * @param accel 6 octets ACCEL_XOUT_H..ACCEL_ZOUT_L.
+     * @param gyro 6 octets GYRO_XOUT_H..GYRO_ZOUT_L.
+     * @param sample Échantillon complété (biais gyro retiré).
+     */
+    void decodeAccelGyro(const unsigned char* accel, const unsigned char* gyro, ImuSample& sample) const;
+
+    /**
+     * @brief Décode et calibre une mesure AK8963 (little-endian) dans le repère NED.
+     * @param dataM 7 octets HXL..HZH puis ST2 ; la mesure est ignorée si ST2 signale un débordement.
+     * @param sample Échantillon complété (magValid positionné).
+     */
+    void decodeMag(const unsigned char* dataM, ImuSample& sample) const;
+
+    /**
+     * @brief Décode une trame FIFO (FifoFrameSize octets) ; dt et horodatage restent à renseigner.
+     * @details Le maître I2C recopie l'AK8963 à chaque échantillon du MPU9250, plus souvent que le
+     * magnétomètre ne mesure (100 Hz) : sans DRDY dans ST1, la trame répète une mesure déjà fusionnée
+     * et magValid reste faux.
      */
-    void madgwickUpdate(float ax, float ay, float az, float gx, float gy, float gz, float mx, float my, float mz, float dt);
+    void decodeFifoFrame(const unsigned char* frame, ImuSample& sample) const;
+
+    /**
+     * @brief Écrit un registre en une seule transaction I2C_RDWR.
+     */
+    bool i2cWriteRegister(quint8 address, quint8 reg, quint8 value);
+
+    /**
+     * @brief Lit @p length registres consécutifs en une seule transaction I2C_RDWR (repeated start).
+     */
+    bool i2cReadRegisters(quint8 address, quint8 reg, quint8* buffer, quint16 length);
+
+    /**
+     * @brief Configure la FIFO matérielle (SMPLRT_DIV, maître I2C lisant l'AK8963, FIFO_EN).
+     * @return false si l'une des écritures a échoué (le mode registre est alors conservé).
+     */
+    bool configureFifo();
+
+    /**
+     * @brief Vide les trames complètes de la FIFO en une lecture en rafale.
+     * @details Une trame en cours d'écriture reste dans la FIFO pour le lot suivant ; seule une FIFO
+     * pleine (débordement, trames perdues) est remise à zéro.
+     * @param samples Tableau de sortie (au moins @p maxSamples éléments).
+     * @param maxSamples Nombre maximal de trames à décoder.
+     * @return Nombre d'échantillons décodés (dt et horodatage reconstitués), -1 en cas d'erreur I2C.
+     */
+    int drainFifo(ImuSample* samples, int maxSamples);
+
+    /**
+     * @brief Fusionne un échantillon et met à jour le cap lissé interne.
+     * @param sample Échantillon calibré (dt renseigné).
+     * @return true si le cap a pu être recalculé (données magnétiques disponibles).
+     */
+    bool fuseSample(const ImuSample& sample);
+
+    /**
+     * @brief Renvoie le filtre actif en appliquant un éventuel changement demandé par setFusionAlgorithm().
+     * @details Appelé uniquement depuis le contexte d'acquisition (thread dédié ou timer).
+     */
+    OrientationEngine* activeEngine();
+
+    /**
+     * @brief Fusionne un lot d'échantillons consécutifs (vidage FIFO) avec OrientationEngine::updateBatch().
+     * @param samples Échantillons calibrés (dt renseigné).
+     * @param count Nombre d'échantillons.
+     * @return true si le cap a pu être recalculé (une seule fois, en fin de lot).
+     */
+    bool fuseBatch(const ImuSample* samples, int count);
+
+    /**
+     * @brief Calcule le cap compensé en inclinaison du filtre, ajoute la déclinaison et le lisse.
+     * @param engine Filtre venant d'être mis à jour.
+     * @param dt Durée couverte depuis le calcul précédent (en secondes).
+     * @return Cap brut avant lissage (degrés, 0 à 360, déclinaison incluse).
+     */
+    float updateHeading(OrientationEngine* engine, float dt);
+
+    /**
+     * @brief Transmet cap et accélération longitudinale à l'étage de navigation à l'estime, s'il est branché.
+     * @param engine Filtre venant d'être mis à jour (orientation utilisée pour retirer la gravité).
+     * @param sample Échantillon de référence (horodatage, accélération).
+     * @param headingDeg Cap brut renvoyé par updateHeading().
+     */
+    void pushMotion(const OrientationEngine* engine, const ImuSample& sample, float headingDeg);
+
+    /**
+     * @brief Publie le cap lissé courant vers TelemetryData (thread-safe via TelemetryData::publish).
+     */
+    void publishHeading();
+
+    /**
+     * @brief Boucle du thread d'acquisition (mode Thread).
+     * @details Réveils sur échéances absolues (clock_nanosleep TIMER_ABSTIME) pour éviter la dérive
+     * cumulative d'un sommeil relatif ; mesure la gigue et rattrape les échéances manquées.
+     */
+    void acquisitionLoop();
 
     // --- Paramètres matériels ---
     TelemetryData* m_data;          ///< Pointeur vers les données partagées de l'application
@@ -77,9 +306,33 @@ private:
     QElapsedTimer m_elapsedTimer;   ///< Timer haute précision pour calculer le dt de Madgwick
     int m_fileDescriptor;           ///< Descripteur du bus I2C système Linux
 
-    // --- État du filtre ---
-    float q[4] = {1.0f, 0.0f, 0.0f, 0.0f}; ///< Quaternions représentant l'orientation actuelle
-    const float beta = 0.1f;               ///< Gain du filtre de Madgwick (équilibre entre gyro et accéléromètre)
+    // --- Mode d'acquisition ---
+    AcquisitionMode m_mode = AcquisitionMode::Timer; ///< Mode choisi pour le prochain start()
+    ReadMode m_readMode = ReadMode::RegisterPolling; ///< Méthode de lecture choisie pour le prochain start()
+    bool m_fifoActive = false;              ///< FIFO effectivement configurée pour la session en cours
+    int m_sampleRateHz = 100;               ///< Fréquence d'échantillonnage du mode Thread
+    int m_publishRateHz = 20;               ///< Fréquence de publication du cap vers l'UI (mode Thread)
+    bool m_realtime = false;                ///< Demande d'ordonnancement SCHED_FIFO
+    int m_realtimePriority = 50;            ///< Priorité SCHED_FIFO
+    std::thread m_thread;                   ///< Thread d'acquisition (mode Thread)
+    std::atomic<bool> m_running{false};     ///< Drapeau d'arrêt de la boucle d'acquisition et de la calibration
+
+    // --- Statistiques de cadencement (écrites par le thread d'acquisition) ---
+    std::atomic<quint64> m_statSamples{0};      ///< Échantillons acquis
+    std::atomic<quint64> m_statWakeups{0};      ///< Réveils de la boucle d'acquisition
+    std::atomic<quint64> m_statMissed{0};       ///< Échéances manquées
+    std::atomic<qint64> m_statJitterSumNs{0};   ///< Somme des retards de réveil (ns)
+    std::atomic<qint64> m_statJitterMaxNs{0};   ///< Retard de réveil maximal (ns)
+    std::atomic<quint64> m_statFifoOverflows{0}; ///< Remises à zéro de la FIFO
+
+    // --- Fusion de capteurs ---
+    std::unique_ptr<OrientationEngine> m_engines[static_cast<int>(FusionAlgorithm::Count)]; ///< Un filtre par algorithme (statistiques conservées)
+    OrientationEngine* m_engine = nullptr;  ///< Filtre actif (contexte d'acquisition uniquement)
+    std::atomic<int> m_requestedAlgorithm{static_cast<int>(FusionAlgorithm::Madgwick)}; ///< Filtre demandé
+    HeadingSmoother m_headingSmoother;      ///< Lissage visuel du cap (τ = 0.95 s)
+    float m_heading = 0.0f;                 ///< Dernier cap lissé calculé (degrés, 0 à 360)
+    DeadReckoning* m_motionSink = nullptr;  ///< Étage de navigation à l'estime (optionnel)
+    TripLogWriter* m_tripLog = nullptr;     ///< Journal de trajet (optionnel)
 
     // --- Paramètres de calibration ---
     float m_magBias[3] = {108.0f, 144.0f, -77.0f};          ///< Biais magnétomètre (Hard Iron)
@@ -8,12 +8,22 @@
 #include "navigationpage.h"
 #include "ui_navigationpage.h"
 #include "telemetrydata.h"
+#include "telemetryframepacer.h"
+#include "offlinegeocoder.h"
+#include "offlinerouter.h"
+#include "routemodel.h"
 #include "clavier.h"
+#include "mapboxclient.h"
+#include "tilecache.h"
+#include "tileprefetcher.h"
+#include <QCoreApplication>
 #include <QCompleter>
 #include <QStringListModel>
 #include <QTimer>
 #include <QQmlContext>
+#include <QQmlEngine>
 #include <QQuickItem>
+#include <QStandardPaths>
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -51,6 +61,7 @@ NavigationPage::NavigationPage(QWidget* parent)
 
     connect(ui->editSearch, &QLineEdit::textEdited, this, [this](const QString &text) {
         if (!m_ignoreTextUpdate && text.length() >= 2) {
+            updateOfflineSuggestions();         // Index local : réponse immédiate à chaque lettre
             m_suggestionDebounceTimer->start(); // Relance le timer à chaque nouvelle lettre
         }
     });
@@ -59,13 +70,47 @@ NavigationPage::NavigationPage(QWidget* parent)
     // QQuickWidget héberge la carte QML dans la hiérarchie QWidget existante.
     m_mapView = new QQuickWidget(this);
 
-    // Récupération des clés API depuis les variables d'environnement
-    QString mapboxKey = QString::fromLocal8Bit(qgetenv("MAPBOX_API_KEY")).trimmed();
-
-    // Injection des clés API dans le contexte QML pour qu'elles soient lisibles par la carte
-    m_mapView->rootContext()->setContextProperty("mapboxApiKey", mapboxKey);
+    // Requêtes Mapbox (suggestions, géocodage, itinéraire) : le jeton reste côté C++. Les réponses de
+    // géocodage sont gardées sur disque (MAPBOX_CACHE_DIR, sinon le cache de l'application).
+    m_mapboxClient = new MapboxClient(this);
+    m_mapboxClient->setAccessToken(QString::fromLocal8Bit(qgetenv("MAPBOX_API_KEY")));
+    QString mapboxCacheDir = QString::fromLocal8Bit(qgetenv("MAPBOX_CACHE_DIR"));
+    if (mapboxCacheDir.isEmpty()) {
+        mapboxCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/mapbox");
+    }
+    m_mapboxClient->setCacheDirectory(mapboxCacheDir);
+    m_mapView->rootContext()->setContextProperty("mapboxClient", m_mapboxClient);
+    // Tuiles de la carte servies par un cache local borné (TILE_CACHE_DIR, TILE_CACHE_MB) : le plugin
+    // QtLocation relit son propre cache seulement au démarrage, pas les tuiles préchargées en route.
+    m_tileCache = new TileCache(this);
+    QString tileCacheDir = QString::fromLocal8Bit(qgetenv("TILE_CACHE_DIR"));
+    if (tileCacheDir.isEmpty()) {
+        tileCacheDir = QCoreApplication::applicationDirPath() + QStringLiteral("/tile_cache");
+    }
+    const qint64 tileCacheMb = qgetenv("TILE_CACHE_MB").toLongLong();
+    m_tileCache->open(tileCacheDir, tileCacheMb > 0 ? tileCacheMb * 1024 * 1024 : TileCache::DefaultByteBudget);
+    if (!m_tileCache->listen()) {
+        qWarning() << "Cache de tuiles local indisponible, tuiles chargées directement";
+    }
+    m_mapView->rootContext()->setContextProperty("tileCache", m_tileCache);
     m_mapView->setResizeMode(QQuickWidget::SizeRootObjectToView);
 
+    // Géométrie et progression de l'itinéraire calculées en C++ (voir RouteModel), lues par map.qml
+    m_routeModel = new RouteModel(this);
+    m_mapView->rootContext()->setContextProperty("routeModel", m_routeModel);
+    // Préchargement des tuiles le long de chaque nouvel itinéraire, aux zooms du zoom automatique
+    m_tilePrefetcher = new TilePrefetcher(m_routeModel, m_tileCache, this);
+    m_mapView->rootContext()->setContextProperty("tilePrefetcher", m_tilePrefetcher);
+    // Calcul d'itinéraire hors ligne : ROAD_GRAPH_FILE=<fichier> (voir RoadGraphBuilder). Sans graphe,
+    // offlineRouter.available reste faux et seul Mapbox calcule les trajets.
+    m_offlineRouter = new OfflineRouter(m_routeModel, this);
+    const QString roadGraphPath = QString::fromLocal8Bit(qgetenv("ROAD_GRAPH_FILE"));
+    if (!roadGraphPath.isEmpty() && !m_offlineRouter->load(roadGraphPath)) {
+        qWarning() << "Graphe routier illisible:" << roadGraphPath;
+    }
+    m_mapView->rootContext()->setContextProperty("offlineRouter", m_offlineRouter);
+    // Autocomplétion hors ligne sur l'index des noms du même graphe (disponible s'il en porte un)
+    m_offlineGeocoder = new OfflineGeocoder(m_offlineRouter->graph());
     // Fonction lambda pour lier les signaux QML aux slots C++ une fois la carte chargée
     auto setupQmlConnections = [this]() {
         QObject* root = m_mapView->rootObject();
@@ -79,6 +124,12 @@ NavigationPage::NavigationPage(QWidget* parent)
         if (status == QQuickWidget::Ready) setupQmlConnections();
     });
 
+    // Les mises à jour télémétriques sont livrées à la scène au plus une fois par image rendue
+    m_framePacer = new TelemetryFramePacer(this);
+    m_framePacer->attachWindow(m_mapView->quickWindow());
+    connect(m_framePacer, &TelemetryFramePacer::frameReady,
+            this, &NavigationPage::applyTelemetryToMap);
+
     // Chargement du fichier QML et ajout au layout de l'interface
     m_mapView->setSource(QUrl("qrc:/map.qml"));
     ui->mapLayout->addWidget(m_mapView);
@@ -116,6 +167,7 @@ NavigationPage::NavigationPage(QWidget* parent)
 }
 
 NavigationPage::~NavigationPage() {
+    delete m_offlineGeocoder;
     delete ui;
 }
 
@@ -141,7 +193,10 @@ void NavigationPage::openVirtualKeyboard()
     // Permet de mettre à jour la barre de recherche en temps réel pendant la frappe sur le clavier custom
     connect(&clavier, &Clavier::textChangedExternally, this, [this](const QString &text){
         ui->editSearch->setText(text);
-        triggerSuggestionsSearch(); // Relance la recherche de suggestions dynamiques
+        // Suggestions locales immédiates ; la requête réseau passe par le même debounce que la saisie
+        // physique (elle partait auparavant à chaque touche du clavier tactile).
+        updateOfflineSuggestions();
+        m_suggestionDebounceTimer->start();
     });
 
     // Si l'utilisateur valide sa saisie (Touche Entrée sur le clavier)
@@ -173,10 +228,40 @@ void NavigationPage::onSuggestionsReceived(const QString& jsonSuggestions) {
 
     QJsonDocument doc = QJsonDocument::fromJson(jsonSuggestions.toUtf8());
     QJsonArray arr = doc.array();
-    QStringList suggestions;
+    m_onlineSuggestions.clear();
 
     for(const auto& val : arr) {
-        suggestions << val.toString();
+        m_onlineSuggestions << val.toString();
+    }
+
+    publishSuggestions();
+}
+
+void NavigationPage::updateOfflineSuggestions() {
+    m_offlineSuggestions.clear();
+    m_offlineDestinations.clear();
+    if (m_offlineGeocoder && m_offlineGeocoder->isAvailable()) {
+        // Classement par distance au véhicule ; quelques millisecondes au plus, sans réseau.
+        const QGeoCoordinate position = m_t ? QGeoCoordinate(m_t->lat(), m_t->lon()) : QGeoCoordinate();
+        const QList<OfflineGeocoder::Result> results = m_offlineGeocoder->search(ui->editSearch->text(), position);
+        for (const OfflineGeocoder::Result& result : results) {
+            const QString label = OfflineGeocoder::label(result);
+            m_offlineSuggestions << label;
+            m_offlineDestinations.insert(label, result.position);
+        }
+    }
+    // Publié même sans index local : retire les suggestions Mapbox d'une saisie précédente.
+    publishSuggestions();
+}
+
+void NavigationPage::publishSuggestions() {
+    // Une réponse Mapbox ne vaut que pour la saisie qui l'a demandée : à la lettre suivante, elle ne
+    // correspond plus au texte et n'est plus fusionnée (la nouvelle requête part après le debounce).
+    if (m_onlineQuery != ui->editSearch->text().trimmed()) m_onlineSuggestions.clear();
+
+    QStringList suggestions = m_offlineSuggestions;
+    for (const QString& online : m_onlineSuggestions) {
+        if (!suggestions.contains(online)) suggestions << online;
     }
 
     m_suggestionsModel->setStringList(suggestions);
@@ -191,25 +276,35 @@ void NavigationPage::bindTelemetry(TelemetryData* t) {
     m_t = t;
     if(!m_t) return;
 
-    // Fonction lambda pour synchroniser les données GPS C++ vers les propriétés de la carte QML
-    auto refresh = [this](){
+    // Fonction lambda relayant chaque transaction télémétrique vers la carte.
+    // Le signal C++ est émis immédiatement ; la poussée vers QML passe par le cadenceur d'images.
+    auto refresh = [this](TelemetryData::Fields dirty){
+        const TelemetryData::Fields mapFields = TelemetryData::PositionFields
+                                              | TelemetryData::HeadingField
+                                              | TelemetryData::SpeedKmhField;
+        dirty &= mapFields;
+        if (!dirty) return; // Ex: seul gpsOk a changé, rien à pousser vers la carte
+
         emit telemetryRefreshRequested(m_t->lat(), m_t->lon(), m_t->heading(), m_t->speedKmh());
-        if(m_mapView && m_mapView->rootObject()){
-            m_mapView->rootObject()->setProperty("carLat", m_t->lat());
-            m_mapView->rootObject()->setProperty("carLon", m_t->lon());
-            m_mapView->rootObject()->setProperty("carHeading", m_t->heading());
-            m_mapView->rootObject()->setProperty("carSpeed", m_t->speedKmh());
-        }
+        m_framePacer->submit(m_t->snapshot(), dirty);
     };
 
-    // Connexion aux signaux de télémétrie pour une mise à jour en temps réel
-    connect(m_t, &TelemetryData::latChanged, this, refresh);
-    connect(m_t, &TelemetryData::lonChanged, this, refresh);
-    connect(m_t, &TelemetryData::headingChanged, this, refresh);
-    connect(m_t, &TelemetryData::speedKmhChanged, this, refresh);
+    // Un seul signal agrégé par tick producteur (au lieu d'un signal par champ)
+    connect(m_t, &TelemetryData::snapshotChanged, this, refresh);
 
+    refresh(TelemetryData::AllFields); // Premier appel pour initialiser la carte avec les valeurs actuelles
+}
+
+void NavigationPage::applyTelemetryToMap(const TelemetrySnapshot& snapshot, TelemetryData::Fields dirty) {
+    if (!m_mapView || !m_mapView->rootObject()) return;
 
-    refresh(); // Premier appel pour initialiser la carte avec les valeurs actuelles
+    // Seuls les champs marqués "dirty" sont poussés, et carLat est écrit en dernier :
+    // onCarLatChanged (QML) lit carLon/carSpeed et doit donc voir un état déjà cohérent.
+    QQuickItem* root = m_mapView->rootObject();
+    if (dirty.testFlag(TelemetryData::SpeedKmhField)) root->setProperty("carSpeed", snapshot.speedKmh);
+    if (dirty.testFlag(TelemetryData::HeadingField)) root->setProperty("carHeading", snapshot.heading);
+    if (dirty.testFlag(TelemetryData::LonField)) root->setProperty("carLon", snapshot.lon);
+    if (dirty.testFlag(TelemetryData::LatField)) root->setProperty("carLat", snapshot.lat);
 }
 
 void NavigationPage::requestRouteForText(const QString& destination) {
@@ -221,6 +316,14 @@ void NavigationPage::requestRouteForText(const QString& destination) {
 
     if (!m_mapView || !m_mapView->rootObject()) return;
 
+    // Suggestion locale : la position est déjà connue, pas de géocodage réseau
+    const auto offline = m_offlineDestinations.constFind(trimmed);
+    if (offline != m_offlineDestinations.constEnd()) {
+        QMetaObject::invokeMethod(m_mapView->rootObject(), "navigateToCoordinate",
+                                  Q_ARG(QVariant, offline->latitude()), Q_ARG(QVariant, offline->longitude()));
+        return;
+    }
+
     // Appel d'une fonction Javascript/QML directement depuis le C++
     QMetaObject::invokeMethod(m_mapView->rootObject(), "searchDestination",
                               Q_ARG(QVariant, trimmed));
@@ -243,6 +346,7 @@ void NavigationPage::triggerSuggestionsSearch() {
     if (query.size() < 3) return;
 
     emit suggestionsSearchRequested(query);
+    m_onlineQuery = query;
 
     if (m_mapView && m_mapView->rootObject()) {
         // Envoie la requête au script QML pour interrogation de l'API cartographique
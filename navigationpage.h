@@ -11,13 +11,22 @@
 
 #include <QWidget>
 #include <QQuickWidget>
+#include <QGeoCoordinate>
+#include <QHash>
 #include <QStringList>
 #include <QVariant>
 #include <QVariantList>
 #include <QEvent>
+#include "telemetrydata.h"
 
 namespace Ui { class NavigationPage; }
-class TelemetryData;
+class TelemetryFramePacer;
+class MapboxClient;
+class TileCache;
+class TilePrefetcher;
+class OfflineGeocoder;
+class OfflineRouter;
+class RouteModel;
 class QCompleter;
 class QStringListModel;
 class QTimer;
@@ -106,6 +115,13 @@ private slots:
      */
     void triggerSuggestionsSearch();
 
+    /**
+     * @brief Pousse un instantané télémétrique cadencé vers les propriétés de la carte QML.
+     * @param snapshot État télémétrique à afficher.
+     * @param dirty Champs modifiés depuis la livraison précédente (les autres ne sont pas réécrits).
+     */
+    void applyTelemetryToMap(const TelemetrySnapshot& snapshot, TelemetryData::Fields dirty);
+
 private:
     // --- MÉTHODES INTERNES ---
 
@@ -120,6 +136,18 @@ private:
      */
     void openVirtualKeyboard();
 
+    /**
+     * @brief Suggestions locales (index des noms du graphe routier) pour le texte courant, sans attente.
+     * Appelée à chaque frappe : la requête réseau, elle, reste soumise au timer de debounce.
+     */
+    void updateOfflineSuggestions();
+
+    /**
+     * @brief Publie vers le completer et le clavier les suggestions locales, suivies des suggestions
+     * réseau qui ne les répètent pas.
+     */
+    void publishSuggestions();
+
     /**
      * @brief Affiche/masque les contrôles de recherche (champ + bouton Aller).
      * @param visible true pour afficher, false pour masquer.
@@ -130,12 +158,23 @@ private:
     Ui::NavigationPage* ui;                    ///< Interface utilisateur générée.
     TelemetryData* m_t = nullptr;              ///< Référence aux données du véhicule.
     QQuickWidget* m_mapView = nullptr;         ///< Conteneur intégrant le code QML de la carte.
+    TelemetryFramePacer* m_framePacer = nullptr; ///< Livraison de la télémétrie cadencée sur le rendu de la carte.
+    RouteModel* m_routeModel = nullptr;        ///< Itinéraire actif (tracé, progression), exposé à la carte.
+    OfflineRouter* m_offlineRouter = nullptr;  ///< Calcul d'itinéraire local (graphe routier), exposé à la carte.
+    OfflineGeocoder* m_offlineGeocoder = nullptr; ///< Autocomplétion locale sur le graphe de m_offlineRouter.
+    MapboxClient* m_mapboxClient = nullptr;    ///< Requêtes Mapbox de la carte (fusion, annulation, cache).
+    TileCache* m_tileCache = nullptr;          ///< Tuiles de la carte (cache disque borné, adresse locale).
+    TilePrefetcher* m_tilePrefetcher = nullptr; ///< Préchargement des tuiles le long de l'itinéraire.
 
     // Autocomplétion
     QCompleter* m_searchCompleter = nullptr;       ///< Moteur d'autocomplétion Qt.
     QStringListModel* m_suggestionsModel = nullptr; ///< Modèle de données stockant les adresses suggérées.
     QTimer* m_suggestionDebounceTimer = nullptr;    ///< Timer pour différer les requêtes réseau (anti-spam).
     bool m_ignoreTextUpdate = false;               ///< Flag pour éviter les boucles infinies lors de la sélection d'une suggestion.
+    QStringList m_offlineSuggestions;              ///< Libellés locaux, du plus proche au plus éloigné.
+    QStringList m_onlineSuggestions;               ///< Dernière réponse Mapbox.
+    QString m_onlineQuery;                         ///< Saisie de la dernière requête Mapbox (à laquelle répond m_onlineSuggestions).
+    QHash<QString, QGeoCoordinate> m_offlineDestinations; ///< Libellé local -> position (pas de géocodage réseau).
 
     Clavier* m_currentClavier = nullptr;           ///< Pointeur vers l'instance active du clavier virtuel.
 };
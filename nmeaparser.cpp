@@ -0,0 +1,347 @@
+/**
+ * @file nmeaparser.cpp
+ * @brief Implémentation du décodeur NMEA 0183 en flux.
+ * @details Les champs sont lus directement dans la phrase (string_view) et convertis par des routines
+ * numériques minimales : les nombres NMEA ne contiennent que des chiffres, un point et un signe
+ * éventuel, ce qui évite strtod (dépendant de la locale) et toute copie intermédiaire.
+ */
+
+#include "nmeaparser.h"
+#include <cstring>
+
+namespace {
+constexpr double KnotsToMs = 1852.0 / 3600.0;
+constexpr double KmhToMs = 1.0 / 3.6;
+
+/**
+ * @brief Parcours des champs séparés par des virgules, sans copie.
+ */
+class FieldCursor {
+public:
+    explicit FieldCursor(std::string_view fields) : m_rest(fields) {}
+
+    std::string_view next() {
+        if (m_done) return {};
+        const std::size_t comma = m_rest.find(',');
+        if (comma == std::string_view::npos) {
+            m_done = true;
+            return m_rest;
+        }
+        const std::string_view field = m_rest.substr(0, comma);
+        m_rest.remove_prefix(comma + 1);
+        return field;
+    }
+
+    void skip(int count) { while (count-- > 0) next(); }
+
+private:
+    std::string_view m_rest;
+    bool m_done = false;
+};
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool parseInt(std::string_view field, int& out) {
+    if (field.empty()) return false;
+    int value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    out = value;
+    return true;
+}
+
+bool parseDecimal(std::string_view field, double& out) {
+    if (field.empty()) return false;
+    bool negative = false;
+    if (field.front() == '-' || field.front() == '+') {
+        negative = field.front() == '-';
+        field.remove_prefix(1);
+        if (field.empty()) return false;
+    }
+
+    double integer = 0.0;
+    double fraction = 0.0;
+    double scale = 1.0;
+    bool seenPoint = false;
+    bool seenDigit = false;
+    for (char c : field) {
+        if (c == '.' && !seenPoint) {
+            seenPoint = true;
+        } else if (c >= '0' && c <= '9') {
+            seenDigit = true;
+            if (seenPoint) {
+                scale *= 0.1;
+                fraction += (c - '0') * scale;
+            } else {
+                integer = integer * 10.0 + (c - '0');
+            }
+        } else {
+            return false;
+        }
+    }
+    if (!seenDigit) return false;
+    out = negative ? -(integer + fraction) : integer + fraction;
+    return true;
+}
+
+// Format NMEA "dddmm.mmmm" + hémisphère : conversion en degrés décimaux signés.
+bool parseCoordinate(std::string_view value, std::string_view hemisphere, double& out) {
+    double raw = 0.0;
+    if (!parseDecimal(value, raw) || hemisphere.size() != 1) return false;
+    const int degrees = static_cast<int>(raw / 100.0);
+    const double minutes = raw - degrees * 100.0;
+    double result = degrees + minutes / 60.0;
+    switch (hemisphere.front()) {
+    case 'N': case 'E': break;
+    case 'S': case 'W': result = -result; break;
+    default: return false;
+    }
+    out = result;
+    return true;
+}
+
+// Heure "hhmmss.sss" en millisecondes depuis minuit.
+bool parseTime(std::string_view field, int& out) {
+    if (field.size() < 6) return false;
+    int hours = 0, minutes = 0;
+    double seconds = 0.0;
+    if (!parseInt(field.substr(0, 2), hours) || !parseInt(field.substr(2, 2), minutes)
+        || !parseDecimal(field.substr(4), seconds)) {
+        return false;
+    }
+    out = (hours * 3600 + minutes * 60) * 1000 + static_cast<int>(seconds * 1000.0 + 0.5);
+    return true;
+}
+}
+
+bool NmeaParser::checksumValid(std::string_view sentence) {
+    while (!sentence.empty() && (sentence.back() == '\r' || sentence.back() == '\n')) sentence.remove_suffix(1);
+    if (sentence.size() < 4 || sentence.front() != '$') return false;
+
+    const std::size_t star = sentence.size() - 3;
+    if (sentence[star] != '*') return false;
+    const int high = hexValue(sentence[star + 1]);
+    const int low = hexValue(sentence[star + 2]);
+    if (high < 0 || low < 0) return false;
+
+    // XOR par mots de 64 bits puis repli sur un octet : le XOR étant associatif, le résultat est
+    // identique au calcul octet par octet, avec huit fois moins de dépendances en chaîne.
+    const char* p = sentence.data() + 1;
+    std::size_t remaining = star - 1;
+    quint64 wide = 0;
+    for (; remaining >= 8; remaining -= 8, p += 8) {
+        quint64 word;
+        std::memcpy(&word, p, sizeof(word));
+        wide ^= word;
+    }
+    wide ^= wide >> 32;
+    wide ^= wide >> 16;
+    wide ^= wide >> 8;
+    unsigned char sum = static_cast<unsigned char>(wide);
+    for (; remaining > 0; --remaining, ++p) sum ^= static_cast<unsigned char>(*p);
+    return sum == ((high << 4) | low);
+}
+
+NmeaParser::Sentence NmeaParser::parseSentence(std::string_view sentence) {
+    while (!sentence.empty() && (sentence.back() == '\r' || sentence.back() == '\n')) sentence.remove_suffix(1);
+    if (sentence.size() > MaxSentenceLength) {
+        ++m_stats.malformed;
+        return NoSentence;
+    }
+    if (!checksumValid(sentence)) {
+        ++m_stats.checksumErrors;
+        return NoSentence;
+    }
+
+    // "$TTSSS,champs*hh" : préfixe d'émetteur, type, puis champs sans la somme de contrôle.
+    const std::string_view body = sentence.substr(1, sentence.size() - 4);
+    const std::size_t comma = body.find(',');
+    if (comma != 5) {
+        ++m_stats.ignored; // Phrases propriétaires ($PUBX...) ou address field non standard.
+        return NoSentence;
+    }
+    const std::string_view talker = body.substr(0, 2);
+    const std::string_view type = body.substr(2, 3);
+    const std::string_view fields = body.substr(comma + 1);
+
+    Sentence decoded = NoSentence;
+    if (type == "GGA") {
+        parseGga(fields);
+        decoded = GGA;
+    } else if (type == "RMC") {
+        parseRmc(fields);
+        decoded = RMC;
+    } else if (type == "VTG") {
+        parseVtg(fields);
+        decoded = VTG;
+    } else if (type == "GSA") {
+        parseGsa(fields);
+        decoded = GSA;
+    } else if (type == "GSV") {
+        parseGsv(fields, constellationIndex(talker));
+        decoded = GSV;
+    } else {
+        ++m_stats.ignored;
+        return NoSentence;
+    }
+
+    ++m_stats.sentences;
+    return decoded;
+}
+
+void NmeaParser::reset() {
+    m_fix = NmeaFix();
+    m_stats = Stats();
+    m_seenRmc = false;
+    for (int& count : m_inView) count = -1;
+    m_partialLength = 0;
+    m_partialOverflow = false;
+}
+
+int NmeaParser::constellationIndex(std::string_view talker) {
+    if (talker == "GP") return 0;
+    if (talker == "GL") return 1;
+    if (talker == "GA") return 2;
+    if (talker == "GB" || talker == "BD") return 3;
+    if (talker == "GQ") return 4;
+    return 5;
+}
+
+void NmeaParser::parseGga(std::string_view fields) {
+    // hhmmss.ss,llll.ll,a,yyyyy.yy,a,q,nn,h.h,alt,M,geoid,M,age,station
+    FieldCursor f(fields);
+    int timeMs = 0;
+    if (parseTime(f.next(), timeMs)) m_fix.timeMs = timeMs;
+
+    const std::string_view lat = f.next();
+    const std::string_view ns = f.next();
+    const std::string_view lon = f.next();
+    const std::string_view ew = f.next();
+
+    int quality = 0;
+    parseInt(f.next(), quality);
+    m_fix.quality = quality;
+
+    if (quality > 0) {
+        double value = 0.0;
+        if (parseCoordinate(lat, ns, value)) m_fix.lat = value;
+        if (parseCoordinate(lon, ew, value)) m_fix.lon = value;
+    }
+
+    int satellites = 0;
+    if (parseInt(f.next(), satellites)) m_fix.satellitesUsed = satellites;
+    double hdop = 0.0;
+    if (parseDecimal(f.next(), hdop)) m_fix.hdop = hdop;
+    double altitude = 0.0;
+    m_fix.hasAltitude = parseDecimal(f.next(), altitude);
+    if (m_fix.hasAltitude) m_fix.altitudeM = altitude;
+
+    // Sans RMC dans le flux, la qualité GGA fait foi pour la validité du fix.
+    if (!m_seenRmc) m_fix.valid = quality > 0;
+}
+
+void NmeaParser::parseRmc(std::string_view fields) {
+    // hhmmss.ss,A,llll.ll,a,yyyyy.yy,a,x.x,x.x,ddmmyy,x.x,a[,m[,s]]
+    m_seenRmc = true;
+    FieldCursor f(fields);
+    int timeMs = 0;
+    if (parseTime(f.next(), timeMs)) m_fix.timeMs = timeMs;
+
+    const std::string_view status = f.next();
+    const std::string_view lat = f.next();
+    const std::string_view ns = f.next();
+    const std::string_view lon = f.next();
+    const std::string_view ew = f.next();
+    const std::string_view speed = f.next();
+    const std::string_view course = f.next();
+    const std::string_view date = f.next();
+    f.skip(2); // Déclinaison magnétique et son sens
+    const std::string_view mode = f.next(); // NMEA 2.3+ : 'N' = données non valides
+
+    bool valid = status == "A" && mode != "N";
+    double latitude = 0.0, longitude = 0.0;
+    if (valid && parseCoordinate(lat, ns, latitude) && parseCoordinate(lon, ew, longitude)) {
+        m_fix.lat = latitude;
+        m_fix.lon = longitude;
+    } else {
+        valid = false;
+    }
+    m_fix.valid = valid;
+
+    double knots = 0.0;
+    m_fix.hasSpeed = valid && parseDecimal(speed, knots);
+    if (m_fix.hasSpeed) m_fix.speedMs = knots * KnotsToMs;
+    double courseDeg = 0.0;
+    m_fix.hasCourse = valid && parseDecimal(course, courseDeg);
+    if (m_fix.hasCourse) m_fix.courseDeg = courseDeg;
+
+    int day = 0, month = 0, year = 0;
+    if (date.size() == 6 && parseInt(date.substr(0, 2), day) && parseInt(date.substr(2, 2), month)
+        && parseInt(date.substr(4, 2), year)) {
+        m_fix.day = day;
+        m_fix.month = month;
+        m_fix.year = year < 80 ? 2000 + year : 1900 + year;
+    }
+}
+
+void NmeaParser::parseVtg(std::string_view fields) {
+    // route vraie,T,route magnétique,M,vitesse noeuds,N,vitesse km/h,K[,mode]
+    FieldCursor f(fields);
+    const std::string_view courseTrue = f.next();
+    f.skip(3);
+    const std::string_view knots = f.next();
+    f.skip(1);
+    const std::string_view kmh = f.next();
+    f.skip(1);
+    if (f.next() == "N") return; // Mode "données non valides"
+
+    double value = 0.0;
+    if (parseDecimal(courseTrue, value)) {
+        m_fix.courseDeg = value;
+        m_fix.hasCourse = true;
+    }
+    if (parseDecimal(kmh, value)) {
+        m_fix.speedMs = value * KmhToMs;
+        m_fix.hasSpeed = true;
+    } else if (parseDecimal(knots, value)) {
+        m_fix.speedMs = value * KnotsToMs;
+        m_fix.hasSpeed = true;
+    }
+}
+
+void NmeaParser::parseGsa(std::string_view fields) {
+    // mode,type,12 x PRN,PDOP,HDOP,VDOP[,système]
+    FieldCursor f(fields);
+    f.skip(1);
+    int fixMode = 0;
+    if (parseInt(f.next(), fixMode)) m_fix.fixMode = fixMode;
+    f.skip(12);
+
+    double value = 0.0;
+    if (parseDecimal(f.next(), value)) m_fix.pdop = value;
+    if (parseDecimal(f.next(), value)) m_fix.hdop = value;
+    if (parseDecimal(f.next(), value)) m_fix.vdop = value;
+}
+
+void NmeaParser::parseGsv(std::string_view fields, int constellation) {
+    // nombre de messages,numéro,satellites visibles,{PRN,élévation,azimut,SNR}...
+    FieldCursor f(fields);
+    f.skip(2);
+    int inView = 0;
+    if (!parseInt(f.next(), inView)) return;
+
+    // Chaque constellation annonce son propre total : le cumul couvre les récepteurs multi-GNSS.
+    m_inView[constellation] = inView;
+    int total = 0;
+    for (int count : m_inView) {
+        if (count > 0) total += count;
+    }
+    m_fix.satellitesInView = total;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file nmeaparser.h
+ * @brief Rôle architectural : Décodeur NMEA 0183 en flux, sans allocation, pour la source GPS.
+ * @details Responsabilités : Découper le flux série en phrases directement dans le tampon de lecture
+ * (std::string_view), vérifier la somme de contrôle et décoder GGA, RMC, VTG, GSA et GSV dans une
+ * structure POD. Remplace QNmeaPositionInfoSource sur le chemin critique : aucun QGeoPositionInfo ni
+ * table d'attributs n'est créé par phrase, et le nombre de satellites ainsi que les DOP sont conservés.
+ * Dépendances principales : aucune (types entiers Qt uniquement).
+ */
+
+#ifndef NMEAPARSER_H
+#define NMEAPARSER_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @struct NmeaFix
+ * @brief État de navigation accumulé au fil des phrases d'une même époque.
+ * @details Chaque phrase ne met à jour que les champs qu'elle porte : GGA la qualité et les satellites
+ * utilisés, RMC la validité, la vitesse et la route, GSA les DOP, GSV les satellites visibles.
+ */
+struct NmeaFix {
+    bool valid = false;          ///< Fix exploitable (RMC statut 'A', ou qualité GGA > 0 sans RMC).
+    int timeMs = -1;             ///< Heure UTC en ms depuis minuit (-1 : inconnue).
+    int day = 0;                 ///< Jour UTC (RMC, 0 : inconnu).
+    int month = 0;               ///< Mois UTC (RMC, 0 : inconnu).
+    int year = 0;                ///< Année UTC (RMC, ex: 2024 ; 0 : inconnue).
+    double lat = 0.0;            ///< Latitude (degrés WGS84, Nord positif).
+    double lon = 0.0;            ///< Longitude (degrés WGS84, Est positif).
+    bool hasAltitude = false;    ///< true si GGA fournissait l'altitude.
+    double altitudeM = 0.0;      ///< Altitude au-dessus du géoïde (m).
+    bool hasSpeed = false;       ///< true si RMC ou VTG fournissait la vitesse sol.
+    double speedMs = 0.0;        ///< Vitesse sol (m/s).
+    bool hasCourse = false;      ///< true si RMC ou VTG fournissait la route (vide à l'arrêt).
+    double courseDeg = 0.0;      ///< Route vraie sur le fond (degrés, 0 = Nord).
+    int quality = 0;             ///< Qualité GGA (0 : pas de fix, 1 : GPS, 2 : DGPS, 4/5 : RTK...).
+    int fixMode = 0;             ///< Type de fix GSA (1 : aucun, 2 : 2D, 3 : 3D ; 0 : inconnu).
+    int satellitesUsed = -1;     ///< Satellites utilisés dans la solution (GGA, -1 : inconnu).
+    int satellitesInView = -1;   ///< Satellites visibles, toutes constellations (GSV, -1 : inconnu).
+    double hdop = -1.0;          ///< Dilution horizontale de précision (GGA/GSA, -1 : inconnue).
+    double pdop = -1.0;          ///< Dilution de précision 3D (GSA, -1 : inconnue).
+    double vdop = -1.0;          ///< Dilution verticale de précision (GSA, -1 : inconnue).
+};
+
+/**
+ * @class NmeaParser
+ * @brief Analyseur NMEA 0183 incrémental.
+ * @details Les phrases complètes contenues dans un bloc lu sont décodées en place ; seule une phrase
+ * coupée entre deux lectures est recopiée dans un petit tampon fixe (MaxSentenceLength octets).
+ * Aucune allocation dynamique n'a lieu, quel que soit le débit. Tous les préfixes d'émetteur
+ * (GP, GN, GL, GA, GB, BD...) sont acceptés.
+ */
+class NmeaParser {
+public:
+    /**
+     * @brief Types de phrases décodées (valeurs combinables en masque).
+     */
+    enum Sentence : quint32 {
+        NoSentence = 0x00,
+        GGA = 0x01, ///< Position, qualité, satellites utilisés, HDOP, altitude.
+        RMC = 0x02, ///< Heure, date, validité, position, vitesse, route. Clôt l'époque chez la plupart des récepteurs.
+        VTG = 0x04, ///< Route et vitesse sol.
+        GSA = 0x08, ///< Type de fix et DOP.
+        GSV = 0x10  ///< Satellites visibles.
+    };
+
+    /** @brief Longueur maximale acceptée pour une phrase (82 octets selon la norme, marge pour les phrases propriétaires). */
+    static constexpr std::size_t MaxSentenceLength = 128;
+
+    /**
+     * @struct Stats
+     * @brief Compteurs de diagnostic du flux.
+     */
+    struct Stats {
+        quint64 sentences = 0;      ///< Phrases décodées.
+        quint64 checksumErrors = 0; ///< Phrases rejetées (somme de contrôle absente ou fausse).
+        quint64 ignored = 0;        ///< Phrases valides d'un type non décodé (GLL, TXT, propriétaires...).
+        quint64 malformed = 0;      ///< Phrases tronquées ou trop longues.
+    };
+
+    /**
+     * @brief Analyse un bloc d'octets lu sur le port série.
+     * @param data Octets reçus (peuvent commencer ou finir au milieu d'une phrase).
+     * @param size Nombre d'octets.
+     * @param onSentence Appelé après chaque phrase décodée avec son type ; fix() est alors à jour.
+     * @return Nombre de phrases décodées dans ce bloc.
+     */
+    template <typename Handler>
+    std::size_t feed(const char* data, std::size_t size, Handler&& onSentence);
+
+    /**
+     * @brief Analyse un bloc d'octets sans notification (fix() reflète la dernière phrase décodée).
+     */
+    std::size_t feed(const char* data, std::size_t size) { return feed(data, size, [](Sentence) {}); }
+
+    /**
+     * @brief Décode une phrase complète, du '$' au dernier chiffre de la somme de contrôle (CR/LF tolérés).
+     * @return Type de la phrase décodée, NoSentence si elle est rejetée ou ignorée.
+     */
+    Sentence parseSentence(std::string_view sentence);
+
+    /**
+     * @brief Vérifie la présence et l'exactitude de la somme de contrôle "*hh".
+     */
+    static bool checksumValid(std::string_view sentence);
+
+    const NmeaFix& fix() const { return m_fix; }   ///< État accumulé.
+    const Stats& stats() const { return m_stats; } ///< Compteurs de diagnostic.
+    bool seenRmc() const { return m_seenRmc; }     ///< true dès qu'une phrase RMC a été décodée.
+
+    /**
+     * @brief Oublie l'état accumulé, la phrase partielle et les compteurs.
+     */
+    void reset();
+
+private:
+    /** @brief Indice de constellation pour le cumul GSV (GP, GL, GA, GB/BD, GQ, autres). */
+    static constexpr int ConstellationCount = 6;
+
+    /**
+     * @brief Position du premier '$' ou '\\n' à partir de @p from (npos si aucun).
+     * @details Deux memchr (vectorisés par la libc) au lieu d'un parcours caractère par caractère :
+     * on cherche la fin de ligne, puis un éventuel début de phrase avant elle.
+     */
+    static std::size_t findDelimiter(std::string_view in, std::size_t from);
+
+    static int constellationIndex(std::string_view talker);
+    void parseGga(std::string_view fields);
+    void parseRmc(std::string_view fields);
+    void parseVtg(std::string_view fields);
+    void parseGsa(std::string_view fields);
+    void parseGsv(std::string_view fields, int constellation);
+
+    NmeaFix m_fix;                              ///< État accumulé
+    Stats m_stats;                              ///< Compteurs de diagnostic
+    bool m_seenRmc = false;                     ///< true dès qu'une RMC a été reçue (elle fait alors foi pour la validité)
+    int m_inView[ConstellationCount] = {-1, -1, -1, -1, -1, -1}; ///< Satellites visibles par constellation
+    char m_partial[MaxSentenceLength];          ///< Phrase coupée entre deux lectures
+    std::size_t m_partialLength = 0;            ///< Octets valides dans m_partial (0 : aucune phrase en cours)
+    bool m_partialOverflow = false;             ///< Phrase en cours trop longue : ignorée jusqu'au prochain '$'
+};
+
+template <typename Handler>
+std::size_t NmeaParser::feed(const char* data, std::size_t size, Handler&& onSentence)
+{
+    std::size_t decoded = 0;
+    auto process = [&](std::string_view sentence) {
+        const Sentence type = parseSentence(sentence);
+        if (type != NoSentence) {
+            ++decoded;
+            onSentence(type);
+        }
+    };
+
+    std::string_view in(data, size);
+    std::size_t pos = 0;
+
+    // 1. Fin d'une phrase commencée lors de la lecture précédente.
+    if (m_partialLength > 0 || m_partialOverflow) {
+        const std::size_t end = findDelimiter(in, 0);
+        const std::size_t take = end == std::string_view::npos ? in.size() : end;
+        if (!m_partialOverflow && m_partialLength + take <= MaxSentenceLength) {
+            in.copy(m_partial + m_partialLength, take);
+            m_partialLength += take;
+        } else if (!m_partialOverflow) {
+            m_partialOverflow = true;
+            ++m_stats.malformed;
+        }
+        if (end == std::string_view::npos) return 0;
+
+        if (in[end] == '\n' && !m_partialOverflow) {
+            process(std::string_view(m_partial, m_partialLength));
+        } else if (in[end] == '$' && !m_partialOverflow) {
+            ++m_stats.malformed; // Phrase interrompue par une nouvelle : perdue.
+        }
+        m_partialLength = 0;
+        m_partialOverflow = false;
+        pos = end;
+    }
+
+    // 2. Phrases complètes : décodées en place, sans copie.
+    while (pos < in.size()) {
+        const std::size_t start = in.find('$', pos);
+        if (start == std::string_view::npos) break;
+        const std::size_t end = findDelimiter(in, start + 1);
+        if (end == std::string_view::npos) {
+            // 3. Phrase coupée en fin de bloc : seule copie du chemin de lecture.
+            const std::size_t tail = in.size() - start;
+            if (tail <= MaxSentenceLength) {
+                in.copy(m_partial, tail, start);
+                m_partialLength = tail;
+            } else {
+                m_partialOverflow = true;
+                ++m_stats.malformed;
+            }
+            break;
+        }
+        if (in[end] == '\n') {
+            process(in.substr(start, end - start));
+            pos = end + 1;
+        } else {
+            ++m_stats.malformed;
+            pos = end;
+        }
+    }
+    return decoded;
+}
+
+inline std::size_t NmeaParser::findDelimiter(std::string_view in, std::size_t from)
+{
+    if (from >= in.size()) return std::string_view::npos;
+    const char* begin = in.data() + from;
+    const std::size_t length = in.size() - from;
+    const void* newline = std::memchr(begin, '\n', length);
+    const std::size_t limit = newline ? static_cast<const char*>(newline) - begin : length;
+    const void* dollar = std::memchr(begin, '$', limit);
+    if (dollar) return from + (static_cast<const char*>(dollar) - begin);
+    return newline ? from + limit : std::string_view::npos;
+}
+
+#endif // NMEAPARSER_H
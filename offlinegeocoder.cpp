@@ -0,0 +1,139 @@
+/**
+ * @file offlinegeocoder.cpp
+ * @brief Implémentation de l'autocomplétion d'adresses hors ligne.
+ */
+
+#include "offlinegeocoder.h"
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <vector>
+
+namespace {
+// true si un mot de @p folded (forme repliée) commence par @p prefix.
+bool hasWordPrefix(std::string_view folded, std::string_view prefix)
+{
+    std::size_t start = 0;
+    while (start < folded.size()) {
+        if (folded.compare(start, prefix.size(), prefix) == 0) return true;
+        const std::size_t space = folded.find(' ', start);
+        if (space == std::string_view::npos) return false;
+        start = space + 1;
+    }
+    return false;
+}
+}
+
+OfflineGeocoder::OfflineGeocoder(const RoadGraph& graph)
+    : m_graph(graph)
+{
+}
+
+QList<OfflineGeocoder::Result> OfflineGeocoder::search(const QString& query, const QGeoCoordinate& from, int limit)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QList<Result> results;
+    const QByteArray utf8 = query.toUtf8();
+    const QByteArray folded = RoadGraph::foldName(std::string_view(utf8.constData(), std::size_t(utf8.size())));
+    if (!isAvailable() || limit <= 0 || folded.size() < MinQueryLength) {
+        m_lastSearchMs = timer.nsecsElapsed() / 1e6;
+        return results;
+    }
+
+    // Mots de la saisie ; celui dont la plage est la plus courte fournit les candidats.
+    std::vector<std::string_view> words;
+    std::string_view rest(folded.constData(), std::size_t(folded.size()));
+    while (!rest.empty()) {
+        const std::size_t space = std::min(rest.find(' '), rest.size());
+        words.push_back(rest.substr(0, space));
+        rest.remove_prefix(std::min(space + 1, rest.size()));
+    }
+    std::size_t driving = 0;
+    std::pair<quint32, quint32> range = m_graph.wordPrefixRange(words[0]);
+    for (std::size_t i = 1; i < words.size() && range.first < range.second; ++i) {
+        const std::pair<quint32, quint32> candidate = m_graph.wordPrefixRange(words[i]);
+        if (candidate.second - candidate.first < range.second - range.first) {
+            range = candidate;
+            driving = i;
+        }
+    }
+
+    // Tas max des meilleurs candidats (score : distance approchée, ou rang dans l'index sans position).
+    struct Candidate {
+        double score;
+        quint32 place;
+    };
+    auto lower = [](const Candidate& a, const Candidate& b) { return a.score < b.score; };
+    std::vector<Candidate> best;
+    best.reserve(std::size_t(limit) + 1);
+    const bool ranked = from.isValid();
+    const double cosLat = ranked ? std::cos(qDegreesToRadians(from.latitude())) : 1.0;
+    QByteArray placeWords; // Réutilisé d'un candidat à l'autre.
+    const quint32 end = std::min(range.second, range.first + std::min(range.second - range.first, MaxCandidates));
+    for (quint32 posting = range.first; posting < end; ++posting) {
+        const quint32 place = m_graph.wordPlace(posting);
+        if (place == RoadGraph::NoNode) continue;
+        double score = posting;
+        if (ranked) {
+            const RoadGraph::Coordinate& position = m_graph.place(int(place)).position;
+            const double dLat = position.lat / RoadGraph::CoordinateScale - from.latitude();
+            const double dLon = (position.lon / RoadGraph::CoordinateScale - from.longitude()) * cosLat;
+            score = dLat * dLat + dLon * dLon;
+        }
+        if (int(best.size()) == limit && score >= best.front().score) continue;
+
+        const std::string_view name = m_graph.placeBytes(int(place));
+        if (words.size() > 1) {
+            RoadGraph::foldName(name, placeWords);
+            const std::string_view foldedName(placeWords.constData(), std::size_t(placeWords.size()));
+            bool all = true;
+            for (std::size_t i = 0; all && i < words.size(); ++i) all = i == driving || hasWordPrefix(foldedName, words[i]);
+            if (!all) continue;
+        }
+        // Un même nom (rue longue découpée en plusieurs lieux) n'est proposé qu'une fois.
+        const auto same = std::find_if(best.begin(), best.end(), [&](const Candidate& other) {
+            return m_graph.place(int(other.place)).kind == m_graph.place(int(place)).kind
+                && m_graph.placeBytes(int(other.place)) == name;
+        });
+        if (same != best.end()) {
+            if (same->score <= score) continue;
+            best.erase(same);
+            std::make_heap(best.begin(), best.end(), lower);
+        }
+        best.push_back({score, place});
+        std::push_heap(best.begin(), best.end(), lower);
+        if (int(best.size()) > limit) {
+            std::pop_heap(best.begin(), best.end(), lower);
+            best.pop_back();
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end(), lower);
+    results.reserve(qsizetype(best.size()));
+    for (const Candidate& candidate : best) {
+        Result result;
+        result.name = m_graph.placeName(int(candidate.place));
+        result.kind = RoadGraph::PlaceKind(m_graph.place(int(candidate.place)).kind);
+        result.position = m_graph.placeCoordinate(int(candidate.place));
+        result.distanceM = ranked ? from.distanceTo(result.position) : -1.0;
+        results.append(result);
+    }
+    m_lastSearchMs = timer.nsecsElapsed() / 1e6;
+    return results;
+}
+
+QString OfflineGeocoder::label(const Result& result)
+{
+    if (result.distanceM < 0.0) return result.name;
+    QString distance;
+    if (result.distanceM < 1000.0) {
+        distance = QString::number(qRound(result.distanceM / 10.0) * 10) + QStringLiteral(" m");
+    } else {
+        const double km = result.distanceM / 1000.0;
+        distance = QString::number(km, 'f', km < 10.0 ? 1 : 0).replace(QLatin1Char('.'), QLatin1Char(',')) + QStringLiteral(" km");
+    }
+    return QStringLiteral("%1 (%2)").arg(result.name, distance);
+}
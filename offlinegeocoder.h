@@ -0,0 +1,74 @@
+/**
+ * @file offlinegeocoder.h
+ * @brief Rôle architectural : Autocomplétion d'adresses hors ligne sur l'index des noms du graphe routier.
+ * @details Responsabilités : Trouver, à chaque frappe et sans réseau, les rues, points d'intérêt et
+ * localités dont les mots commencent par ceux de la saisie (accents et casse ignorés), classés par
+ * distance à la position courante. Les suggestions Mapbox restent un complément facultatif.
+ * Dépendances principales : RoadGraph (sections PlaceEntries, PlaceNames, Word*).
+ */
+
+#ifndef OFFLINEGEOCODER_H
+#define OFFLINEGEOCODER_H
+
+#include <QGeoCoordinate>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include "roadgraph.h"
+
+/**
+ * @class OfflineGeocoder
+ * @brief Recherche par préfixes de mots, en quelques millisecondes quelle que soit la région chargée.
+ * @details Chaque mot de la saisie est un préfixe (« av jean jau » trouve « Avenue Jean Jaurès »).
+ * Le mot le plus sélectif donne les candidats par une seule plage de l'index ; les autres mots ne sont
+ * vérifiés que pour les candidats assez proches pour entrer dans le résultat.
+ */
+class OfflineGeocoder {
+public:
+    static constexpr int MinQueryLength = 3;        ///< Caractères repliés en dessous desquels rien n'est cherché.
+    static constexpr quint32 MaxCandidates = 20000; ///< Lieux examinés au plus (saisie encore trop vague).
+
+    /**
+     * @struct Result
+     * @brief Lieu proposé.
+     */
+    struct Result {
+        QString name;
+        RoadGraph::PlaceKind kind = RoadGraph::PlaceKind::Street;
+        QGeoCoordinate position;
+        double distanceM = -1.0; ///< Depuis la position de la recherche, -1 si elle est inconnue.
+    };
+
+    /**
+     * @param graph Graphe portant l'index des noms ; peut être ouvert ou fermé plus tard.
+     */
+    explicit OfflineGeocoder(const RoadGraph& graph);
+
+    /**
+     * @brief true si le graphe est ouvert et porte l'index des mots.
+     */
+    bool isAvailable() const { return m_graph.isOpen() && m_graph.hasWordIndex(); }
+
+    /**
+     * @brief Lieux correspondant à @p query, du plus proche au plus éloigné de @p from.
+     * @details Un même nom n'apparaît qu'une fois (le plus proche). Sans position valide, l'ordre est
+     * celui de l'index.
+     */
+    QList<Result> search(const QString& query, const QGeoCoordinate& from, int limit = 5);
+
+    /**
+     * @brief Libellé d'une suggestion : nom et distance (« Rue de la Paix (1,2 km) »).
+     */
+    static QString label(const Result& result);
+
+    /**
+     * @brief Durée du dernier search() (ms).
+     */
+    double lastSearchMs() const { return m_lastSearchMs; }
+
+private:
+    const RoadGraph& m_graph;
+    double m_lastSearchMs = 0.0;
+};
+
+#endif // OFFLINEGEOCODER_H
@@ -0,0 +1,122 @@
+/**
+ * @file offlinerouter.cpp
+ * @brief Implémentation de la façade de calcul d'itinéraire hors ligne.
+ */
+
+#include "offlinerouter.h"
+#include "routemodel.h"
+#include <QElapsedTimer>
+
+OfflineRouter::OfflineRouter(RouteModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+{
+}
+
+bool OfflineRouter::load(const QString& path)
+{
+    const bool wasAvailable = isAvailable();
+    const bool ok = m_graph.open(path);
+    // Un nouveau graphe change aussi les trajets possibles : notifié même si la disponibilité ne change pas.
+    if (ok || wasAvailable) emit availableChanged();
+    return ok;
+}
+
+bool OfflineRouter::route(double fromLat, double fromLon, double toLat, double toLon, double headingDeg)
+{
+    if (!m_model || !isAvailable()) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    RoadGraph::EdgeSnap start;
+    RoadGraph::EdgeSnap end;
+    // Cap trop éloigné de tout arc (bruit à basse vitesse, demi-tour) : recalage sans cap plutôt qu'un refus.
+    const bool startFound = (headingDeg >= 0.0 && m_graph.nearestEdge(fromLat, fromLon, start, headingDeg))
+        || m_graph.nearestEdge(fromLat, fromLon, start);
+    if (!startFound || !m_graph.nearestEdge(toLat, toLon, end)) {
+        m_lastQueryMs = timer.nsecsElapsed() / 1e6;
+        return false;
+    }
+
+    // Voie à double sens : les deux sens sont essayés, au départ seulement si le cap est inconnu.
+    QList<RoadGraph::EdgeSnap> starts{start};
+    QList<RoadGraph::EdgeSnap> ends{end};
+    RoadGraph::EdgeSnap reversed;
+    if (headingDeg < 0.0 && m_graph.reverseEdge(start, reversed)) starts.append(reversed);
+    if (m_graph.reverseEdge(end, reversed)) ends.append(reversed);
+
+    bool found = false;
+    double bestSec = 0.0;
+    RoadGraph::EdgeSnap bestStart;
+    RoadGraph::EdgeSnap bestEnd;
+    RoadGraph::Path bestPath;
+    bool bestDirect = false;
+    RoadGraph::Path path;
+    for (const RoadGraph::EdgeSnap& s : starts) {
+        for (const RoadGraph::EdgeSnap& e : ends) {
+            double seconds = 0.0;
+            const bool direct = s.from == e.from && s.to == e.to && s.fraction <= e.fraction;
+            if (direct) {
+                seconds = (e.fraction - s.fraction) * s.durationSec;
+                path = RoadGraph::Path();
+            } else {
+                // Projeté sur une extrémité : le trajet part (ou finit) directement de ce nœud.
+                const quint32 source = s.fraction <= 0.0 ? s.from : s.to;
+                const quint32 target = e.fraction >= 1.0 ? e.to : e.from;
+                if (!m_graph.shortestPath(source, target, path)) continue;
+                seconds = path.durationSec + (source == s.to ? (1.0 - s.fraction) * s.durationSec : 0.0)
+                    + (target == e.from ? e.fraction * e.durationSec : 0.0);
+            }
+            if (found && seconds >= bestSec) continue;
+            found = true;
+            bestSec = seconds;
+            bestStart = s;
+            bestEnd = e;
+            bestPath = path;
+            bestDirect = direct;
+        }
+    }
+    m_lastQueryMs = timer.nsecsElapsed() / 1e6;
+    if (!found) return false;
+
+    RouteModel::RouteData data;
+    auto append = [&data](const QGeoCoordinate& point, double seconds, int speedLimitKmh) {
+        if (!data.points.isEmpty() && data.points.last().distanceTo(point) < MinSegmentM) {
+            if (!data.segmentDurationsSec.isEmpty()) {
+                data.segmentDurationsSec.last() += seconds;
+                data.durationSec += seconds;
+            }
+            return;
+        }
+        if (!data.points.isEmpty()) {
+            data.segmentDurationsSec.append(seconds);
+            data.speedLimitsKmh.append(speedLimitKmh);
+        }
+        data.points.append(point);
+        data.durationSec += seconds;
+    };
+    // Position du véhicule puis point de la route : le tracé ne commence pas à plusieurs dizaines de
+    // mètres de la voiture, ce qui le ferait aussitôt juger hors itinéraire.
+    append(QGeoCoordinate(fromLat, fromLon), 0.0, -1);
+    append(bestStart.position, bestStart.distanceM / (ApproachSpeedKmh / 3.6), -1);
+    if (bestDirect) {
+        append(bestEnd.position, (bestEnd.fraction - bestStart.fraction) * bestStart.durationSec, bestStart.speedLimitKmh);
+    } else {
+        const quint32 source = bestStart.fraction <= 0.0 ? bestStart.from : bestStart.to;
+        const quint32 target = bestEnd.fraction >= 1.0 ? bestEnd.to : bestEnd.from;
+        if (source == bestStart.to) {
+            append(m_graph.coordinate(source), (1.0 - bestStart.fraction) * bestStart.durationSec, bestStart.speedLimitKmh);
+        }
+        append(m_graph.coordinate(source), 0.0, -1);
+        for (int i = 0; i + 1 < bestPath.nodes.size(); ++i) {
+            append(m_graph.coordinate(bestPath.nodes.at(i + 1)), bestPath.segmentDurationsSec.value(i),
+                   bestPath.segmentSpeedLimitsKmh.value(i, -1));
+        }
+        if (target == bestEnd.from) {
+            append(bestEnd.position, bestEnd.fraction * bestEnd.durationSec, bestEnd.speedLimitKmh);
+        }
+    }
+    if (data.points.size() < 2) return false;
+    m_model->setRoute(data);
+    return true;
+}
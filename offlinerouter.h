@@ -0,0 +1,76 @@
+/**
+ * @file offlinerouter.h
+ * @brief Rôle architectural : Façade QML du calcul d'itinéraire hors ligne.
+ * @details Responsabilités : Charger le graphe routier prétraité (RoadGraph), recaler départ et arrivée
+ * sur le réseau, calculer le trajet le plus rapide et le charger dans RouteModel, sans réseau. Mapbox
+ * reste un complément facultatif (trafic, manœuvres) qui remplace le trajet local dès qu'il arrive.
+ * Dépendances principales : RoadGraph, RouteModel.
+ */
+
+#ifndef OFFLINEROUTER_H
+#define OFFLINEROUTER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include "roadgraph.h"
+
+class RouteModel;
+
+/**
+ * @class OfflineRouter
+ * @brief Itinéraires locaux pour map.qml (propriété de contexte `offlineRouter`).
+ * @details Un calcul prend quelques millisecondes et s'exécute dans le thread de l'interface : il reste
+ * disponible en zone blanche, pour le premier tracé comme pour chaque recalcul hors itinéraire.
+ */
+class OfflineRouter : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availableChanged)
+
+public:
+    static constexpr double ApproachSpeedKmh = 20.0; ///< Vitesse comptée entre la position et la route.
+    static constexpr double MinSegmentM = 0.5;       ///< Sommets plus proches fusionnés.
+
+    /**
+     * @param model Itinéraire actif, rempli par route().
+     */
+    explicit OfflineRouter(RouteModel* model, QObject* parent = nullptr);
+
+    /**
+     * @brief Projette le graphe routier @p path (voir RoadGraphBuilder).
+     * @return false si le fichier est absent ou invalide ; le calcul local est alors indisponible.
+     */
+    bool load(const QString& path);
+
+    bool isAvailable() const { return m_graph.isOpen(); } ///< true si un graphe est chargé.
+    const RoadGraph& graph() const { return m_graph; }    ///< Graphe chargé (index des noms pour OfflineGeocoder).
+
+    /**
+     * @brief Calcule le trajet le plus rapide et le charge dans le RouteModel.
+     * @details Départ et arrivée sont projetés sur l'arc le plus proche (RoadGraph::nearestEdge(),
+     * SnapRadiusM au plus), le départ dans le sens de @p headingDeg s'il est connu : le véhicule n'est pas
+     * recalé sur la chaussée opposée ni à contresens d'un sens unique. Le tracé commence à la position
+     * du véhicule, rejoint la route au point projeté et finit au point projeté de l'arrivée ; sur une voie
+     * à double sens sans cap, le sens le plus rapide est retenu. Le tracé n'a pas de trafic ; durées et
+     * limitations de vitesse par segment viennent du graphe.
+     * @param headingDeg Cap du véhicule (degrés, 0 = nord), négatif s'il est inconnu (à l'arrêt).
+     * @return false (itinéraire courant inchangé) si aucun graphe n'est chargé, si un point est trop
+     *         loin du réseau ou si l'arrivée est inaccessible.
+     */
+    Q_INVOKABLE bool route(double fromLat, double fromLon, double toLat, double toLon, double headingDeg = -1.0);
+
+    /**
+     * @brief Durée du dernier calcul, recalage compris (ms).
+     */
+    double lastQueryMs() const { return m_lastQueryMs; }
+
+signals:
+    void availableChanged();
+
+private:
+    QPointer<RouteModel> m_model; ///< Destination des trajets calculés.
+    RoadGraph m_graph;            ///< Graphe projeté.
+    double m_lastQueryMs = 0.0;
+};
+
+#endif // OFFLINEROUTER_H
@@ -0,0 +1,677 @@
+/**
+ * @file orientationengine.cpp
+ * @brief Implémentation des filtres de fusion de capteurs (Madgwick, Mahony, ESKF) et du lissage du cap.
+ * @details Toutes les implémentations travaillent dans la même convention que le filtre historique :
+ * quaternion (w, x, y, z) tel que q' = 0.5 * q ⊗ (0, ω), gravité mesurée attendue le long de +Z capteur
+ * au repos et cap extrait par compensation d'inclinaison du champ magnétique.
+ */
+
+#include "orientationengine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Poids de la moyenne/variance glissante du cap (≈ 20 derniers caps calculés).
+constexpr float HeadingStatsWeight = 0.05f;
+
+qint64 steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Inverse de la racine carrée rapide (approximation par manipulation de bits + 2 itérations de Newton).
+ * @details Erreur relative < 5e-6, suffisante pour les normalisations du filtre, sans division ni sqrt.
+ */
+inline float invSqrt(float x) {
+    const float half = 0.5f * x;
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f375a86u - (bits >> 1);
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+}
+
+/**
+ * @brief Normalise un quadruplet (quaternion ou gradient) en place.
+ * @details Sur AArch64 (Cortex-A53), les 4 composantes sont élevées au carré, sommées et mises à l'échelle
+ * dans un seul registre NEON ; ailleurs, version scalaire équivalente.
+ */
+inline void normalize4(float& a, float& b, float& c, float& d) {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    const float values[4] = {a, b, c, d};
+    float32x4_t v = vld1q_f32(values);
+    const float scale = invSqrt(vaddvq_f32(vmulq_f32(v, v)));
+    v = vmulq_n_f32(v, scale);
+    a = vgetq_lane_f32(v, 0); b = vgetq_lane_f32(v, 1);
+    c = vgetq_lane_f32(v, 2); d = vgetq_lane_f32(v, 3);
+#else
+    const float scale = invSqrt(a * a + b * b + c * c + d * d);
+    a *= scale; b *= scale; c *= scale; d *= scale;
+#endif
+}
+
+/**
+ * @brief Matrice de rotation capteur -> NED associée au quaternion (w, x, y, z).
+ */
+void rotationMatrix(const float q[4], float R[3][3]) {
+    const float w = q[0], x = q[1], y = q[2], z = q[3];
+    R[0][0] = 1.0f - 2.0f * (y * y + z * z); R[0][1] = 2.0f * (x * y - w * z);        R[0][2] = 2.0f * (x * z + w * y);
+    R[1][0] = 2.0f * (x * y + w * z);        R[1][1] = 1.0f - 2.0f * (x * x + z * z); R[1][2] = 2.0f * (y * z - w * x);
+    R[2][0] = 2.0f * (x * z - w * y);        R[2][1] = 2.0f * (y * z + w * x);        R[2][2] = 1.0f - 2.0f * (x * x + y * y);
+}
+
+float wrap180(float deg) {
+    if (deg > 180.0f) deg -= 360.0f;
+    else if (deg < -180.0f) deg += 360.0f;
+    return deg;
+}
+
+float wrap360(float deg) {
+    if (deg < 0.0f) deg += 360.0f;
+    if (deg >= 360.0f) deg -= 360.0f;
+    return deg;
+}
+}
+
+// ============================================================================
+// Classe de base
+// ============================================================================
+
+bool OrientationEngine::update(const ImuSample& sample) {
+    holdMag(sample);
+    if (!m_hasMag) return false;
+
+    const qint64 begin = steadyNowNs();
+    integrate(sample, m_mag[0], m_mag[1], m_mag[2]);
+    recordCost(steadyNowNs() - begin, 1);
+    return true;
+}
+
+bool OrientationEngine::updateBatch(const ImuSample* samples, std::size_t count) {
+    if (count == 0) return false;
+
+    const qint64 begin = steadyNowNs();
+    const std::size_t integrated = integrateBatch(samples, count);
+    if (integrated > 0) recordCost(steadyNowNs() - begin, integrated);
+    return integrated > 0;
+}
+
+std::size_t OrientationEngine::integrateBatch(const ImuSample* samples, std::size_t count) {
+    std::size_t integrated = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        holdMag(samples[i]);
+        if (!m_hasMag) continue;
+        integrate(samples[i], m_mag[0], m_mag[1], m_mag[2]);
+        ++integrated;
+    }
+    return integrated;
+}
+
+void OrientationEngine::holdMag(const ImuSample& sample) {
+    // Le magnétomètre (100 Hz) est plus lent que la boucle à haute fréquence :
+    // entre deux données AK8963, on réutilise la dernière mesure magnétique connue.
+    if (!sample.magValid) return;
+    m_mag[0] = sample.mx; m_mag[1] = sample.my; m_mag[2] = sample.mz;
+    m_hasMag = true;
+}
+
+void OrientationEngine::reset(const float quaternion[4]) {
+    std::copy(quaternion, quaternion + 4, m_q);
+    m_mag[0] = m_mag[1] = m_mag[2] = 0.0f;
+    m_hasMag = false;
+    m_headingSeeded = false;
+    resetState();
+}
+
+void OrientationEngine::reset() {
+    const float identity[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    reset(identity);
+}
+
+float OrientationEngine::computeHeading() {
+    const float* q = m_q;
+    const float mx = m_mag[0], my = m_mag[1], mz = m_mag[2];
+
+    // Extraction du Roulis (Roll) et Tangage (Pitch) depuis le Quaternion.
+    // Cela nous dit comment la voiture est penchée par rapport à la gravité terrestre.
+    const float roll = std::atan2(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
+    const float pitch = std::asin(std::clamp(2.0f * (q[0] * q[2] - q[3] * q[1]), -1.0f, 1.0f));
+
+    // On projette le vecteur magnétique (repère NED) sur le plan horizontal (sol)
+    // en utilisant le roulis et le tangage. Cela garantit que la boussole pointe
+    // toujours le Nord, même si la voiture monte une pente raide.
+    const float magXHoriz = mx * std::cos(pitch) + my * std::sin(roll) * std::sin(pitch) - mz * std::cos(roll) * std::sin(pitch);
+    const float magYHoriz = my * std::cos(roll) + mz * std::sin(roll);
+
+    // On ajoute un signe MOINS (-) car les maths tournent en sens anti-horaire,
+    // mais la carte Qt tourne dans le sens horaire (comme une vraie boussole).
+    const float heading = wrap360(-std::atan2(magYHoriz, magXHoriz) * (180.0f / float(M_PI)));
+
+    // Variance glissante du cap brut (écart circulaire à la moyenne glissante).
+    applyStatsReset();
+    if (!m_headingSeeded) {
+        m_headingMean = heading;
+        m_headingVariance.store(0.0, std::memory_order_relaxed);
+        m_headingSeeded = true;
+    } else {
+        const float diff = wrap180(heading - m_headingMean);
+        m_headingMean = wrap360(m_headingMean + HeadingStatsWeight * diff);
+        const double variance = m_headingVariance.load(std::memory_order_relaxed);
+        m_headingVariance.store((1.0 - HeadingStatsWeight) * (variance + HeadingStatsWeight * diff * diff),
+                                std::memory_order_relaxed);
+    }
+    return heading;
+}
+
+OrientationEngine::Stats OrientationEngine::stats() const {
+    Stats stats;
+    if (m_statsResetRequested.load(std::memory_order_acquire)) return stats;
+    stats.updates = m_updates.load(std::memory_order_relaxed);
+    if (stats.updates > 0) {
+        stats.meanCpuNs = double(m_cpuNs.load(std::memory_order_relaxed)) / stats.updates;
+    }
+    stats.headingVarianceDeg2 = m_headingVariance.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void OrientationEngine::resetStats() {
+    m_statsResetRequested.store(true, std::memory_order_release);
+}
+
+void OrientationEngine::applyStatsReset() {
+    // Thread du filtre uniquement : seul à lire et écrire la moyenne glissante du cap. La demande est
+    // consommée avant l'effacement, pour qu'une demande arrivée entre-temps ne soit pas perdue.
+    if (!m_statsResetRequested.load(std::memory_order_relaxed)) return;
+    if (!m_statsResetRequested.exchange(false, std::memory_order_acq_rel)) return;
+    m_updates.store(0, std::memory_order_relaxed);
+    m_cpuNs.store(0, std::memory_order_relaxed);
+    m_headingVariance.store(0.0, std::memory_order_relaxed);
+    m_headingSeeded = false;
+}
+
+void OrientationEngine::recordCost(qint64 elapsedNs, std::size_t updates) {
+    applyStatsReset();
+    m_cpuNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    m_updates.fetch_add(updates, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Madgwick
+// ============================================================================
+
+/**
+ * @brief Filtre de fusion de capteurs de Madgwick (Implémentation optimisée).
+ * @details Cet algorithme estime l'orientation 3D (quaternions) en fusionnant les données :
+ * - Le Gyroscope calcule les rotations rapides (mais dérive dans le temps).
+ * - L'Accéléromètre trouve la gravité (vecteur Bas) pour corriger le tangage/roulis.
+ * - Le Magnétomètre trouve le Nord magnétique pour corriger le lacet (Cap).
+ * La descente de gradient permet de converger vers l'orientation réelle.
+ */
+void MadgwickEngine::integrate(const ImuSample& sample, float mx, float my, float mz) {
+    float ax = sample.ax, ay = sample.ay, az = sample.az;
+    const float gx = sample.gx, gy = sample.gy, gz = sample.gz;
+    const float dt = sample.dt;
+    const float beta = m_beta;
+
+    float q1 = m_q[0], q2 = m_q[1], q3 = m_q[2], q4 = m_q[3];
+    float norm;
+    float hx, hy, _2bx, _2bz;
+    float s1, s2, s3, s4;
+    float qDot1, qDot2, qDot3, qDot4;
+
+    // Variables auxiliaires pour optimiser les performances (éviter les calculs répétitifs)
+    float _2q1mx; float _2q1my; float _2q1mz; float _2q2mx;
+    float _4bx; float _4bz;
+    float _2q1 = 2.0f * q1; float _2q2 = 2.0f * q2; float _2q3 = 2.0f * q3; float _2q4 = 2.0f * q4;
+    float _2q1q3 = 2.0f * q1 * q3; float _2q3q4 = 2.0f * q3 * q4;
+    float q1q1 = q1 * q1; float q1q2 = q1 * q2; float q1q3 = q1 * q3; float q1q4 = q1 * q4;
+    float q2q2 = q2 * q2; float q2q3 = q2 * q3; float q2q4 = q2 * q4;
+    float q3q3 = q3 * q3; float q3q4 = q3 * q4; float q4q4 = q4 * q4;
+
+    // 1. Normalisation du vecteur d'accélération (Gravité)
+    norm = std::sqrt(ax * ax + ay * ay + az * az);
+    if (norm == 0.0f) return; // Sécurité contre la division par zéro
+    norm = 1.0f/norm;
+    ax *= norm; ay *= norm; az *= norm;
+
+    // 2. Normalisation du vecteur magnétique (Nord)
+    norm = std::sqrt(mx * mx + my * my + mz * mz);
+    if (norm == 0.0f) return;
+    norm = 1.0f/norm;
+    mx *= norm; my *= norm; mz *= norm;
+
+    // 3. Calcul de la direction de référence du champ magnétique
+    _2q1mx = 2.0f * q1 * mx;
+    _2q1my = 2.0f * q1 * my;
+    _2q1mz = 2.0f * q1 * mz;
+    _2q2mx = 2.0f * q2 * mx;
+    hx = mx * q1q1 - _2q1my * q4 + _2q1mz * q3 + mx * q2q2 + _2q2 * my * q3 + _2q2 * mz * q4 - mx * q3q3 - mx * q4q4;
+    hy = _2q1mx * q4 + my * q1q1 - _2q1mz * q2 + _2q2mx * q3 - my * q2q2 + my * q3q3 + _2q3 * mz * q4 - my * q4q4;
+    _2bx = std::sqrt(hx * hx + hy * hy);
+    _2bz = -_2q1mx * q3 + _2q1my * q2 + mz * q1q1 + _2q2mx * q4 - mz * q2q2 + _2q3 * my * q4 - mz * q3q3 + mz * q4q4;
+    _4bx = 2.0f * _2bx;
+    _4bz = 2.0f * _2bz;
+
+    // 4. Descente de gradient : Calcul de l'erreur d'orientation
+    s1 = -_2q3 * (2.0f * q2q4 - _2q1q3 - ax) + _2q2 * (2.0f * q1q2 + _2q3q4 - ay) - _2bz * q3 * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (-_2bx * q4 + _2bz * q2) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + _2bx * q3 * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
+    s2 = _2q4 * (2.0f * q2q4 - _2q1q3 - ax) + _2q1 * (2.0f * q1q2 + _2q3q4 - ay) - 4.0f * q2 * (1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az) + _2bz * q4 * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (_2bx * q3 + _2bz * q1) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + (_2bx * q4 - _4bz * q2) * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
+    s3 = -_2q1 * (2.0f * q2q4 - _2q1q3 - ax) + _2q4 * (2.0f * q1q2 + _2q3q4 - ay) - 4.0f * q3 * (1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az) + (-_4bx * q3 - _2bz * q1) * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (_2bx * q2 + _2bz * q4) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + (_2bx * q1 - _4bz * q3) * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
+    s4 = _2q2 * (2.0f * q2q4 - _2q1q3 - ax) + _2q3 * (2.0f * q1q2 + _2q3q4 - ay) + (-_4bx * q4 + _2bz * q2) * (_2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx) + (-_2bx * q1 + _2bz * q3) * (_2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my) + _2bx * q2 * (_2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz);
+    norm = std::sqrt(s1 * s1 + s2 * s2 + s3 * s3 + s4 * s4); // Normalisation de l'erreur
+    norm = 1.0f/norm;
+    s1 *= norm; s2 *= norm; s3 *= norm; s4 *= norm;
+
+    // 5. Calcul du taux de changement du quaternion (Fusion Gyroscope + Erreur corrigée par beta)
+    qDot1 = 0.5f * (-q2 * gx - q3 * gy - q4 * gz) - beta * s1;
+    qDot2 = 0.5f * (q1 * gx + q3 * gz - q4 * gy) - beta * s2;
+    qDot3 = 0.5f * (q1 * gy - q2 * gz + q4 * gx) - beta * s3;
+    qDot4 = 0.5f * (q1 * gz + q2 * gy - q3 * gx) - beta * s4;
+
+    // 6. Intégration dans le temps pour obtenir le nouveau quaternion d'orientation
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    q4 += qDot4 * dt;
+
+    // 7. Normalisation finale du quaternion
+    norm = std::sqrt(q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4);
+    norm = 1.0f/norm;
+
+    m_q[0] = q1 * norm;
+    m_q[1] = q2 * norm;
+    m_q[2] = q3 * norm;
+    m_q[3] = q4 * norm;
+}
+
+/**
+ * @brief Version par lot du filtre de Madgwick (rejeu, vidage FIFO).
+ * @details Mêmes équations que integrate(), mais :
+ * - le quaternion reste dans des variables locales (registres) pendant tout le lot ;
+ * - le champ magnétique n'est normalisé qu'à l'arrivée d'une nouvelle mesure AK8963 ;
+ * - les racines carrées inverses passent par invSqrt() et les normalisations à 4 composantes
+ *   par normalize4() (NEON sur AArch64).
+ * Les écarts avec la version scalaire restent de l'ordre de l'erreur d'arrondi de invSqrt().
+ */
+std::size_t MadgwickEngine::integrateBatch(const ImuSample* samples, std::size_t count) {
+    float q1 = m_q[0], q2 = m_q[1], q3 = m_q[2], q4 = m_q[3];
+    const float b = m_beta;
+    std::size_t integrated = 0;
+
+    // Dernière mesure magnétique connue, déjà normalisée.
+    float mx = 0.0f, my = 0.0f, mz = 0.0f;
+    bool magUsable = false;
+    auto loadMag = [&](float x, float y, float z) {
+        const float sq = x * x + y * y + z * z;
+        magUsable = sq > 0.0f;
+        if (!magUsable) return;
+        const float inv = invSqrt(sq);
+        mx = x * inv; my = y * inv; mz = z * inv;
+    };
+    if (m_hasMag) loadMag(m_mag[0], m_mag[1], m_mag[2]);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const ImuSample& sample = samples[i];
+        if (sample.magValid) {
+            holdMag(sample);
+            loadMag(sample.mx, sample.my, sample.mz);
+        }
+        if (!m_hasMag) continue;
+        ++integrated;
+        if (!magUsable) continue; // Même garde que la version scalaire
+
+        // 1. Normalisation de la gravité
+        float ax = sample.ax, ay = sample.ay, az = sample.az;
+        const float accSq = ax * ax + ay * ay + az * az;
+        if (accSq == 0.0f) continue;
+        const float accInv = invSqrt(accSq);
+        ax *= accInv; ay *= accInv; az *= accInv;
+
+        const float gx = sample.gx, gy = sample.gy, gz = sample.gz;
+
+        // Produits du quaternion communs aux étapes 2 à 4
+        const float _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3, _2q4 = 2.0f * q4;
+        const float _2q1q3 = 2.0f * q1 * q3, _2q3q4 = 2.0f * q3 * q4;
+        const float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3, q1q4 = q1 * q4;
+        const float q2q2 = q2 * q2, q2q3 = q2 * q3, q2q4 = q2 * q4;
+        const float q3q3 = q3 * q3, q3q4 = q3 * q4, q4q4 = q4 * q4;
+
+        // 2. Direction de référence du champ magnétique
+        const float _2q1mx = _2q1 * mx, _2q1my = _2q1 * my, _2q1mz = _2q1 * mz, _2q2mx = _2q2 * mx;
+        const float hx = mx * q1q1 - _2q1my * q4 + _2q1mz * q3 + mx * q2q2 + _2q2 * my * q3 + _2q2 * mz * q4 - mx * q3q3 - mx * q4q4;
+        const float hy = _2q1mx * q4 + my * q1q1 - _2q1mz * q2 + _2q2mx * q3 - my * q2q2 + my * q3q3 + _2q3 * mz * q4 - my * q4q4;
+        const float hSq = hx * hx + hy * hy;
+        const float _2bx = hSq * invSqrt(hSq); // sqrt(h) = h / sqrt(h), nul si h est nul
+        const float _2bz = -_2q1mx * q3 + _2q1my * q2 + mz * q1q1 + _2q2mx * q4 - mz * q2q2 + _2q3 * my * q4 - mz * q3q3 + mz * q4q4;
+        const float _4bx = 2.0f * _2bx, _4bz = 2.0f * _2bz;
+
+        // 3. Résidus (fonction objectif), chacun calculé une seule fois
+        const float fAx = 2.0f * q2q4 - _2q1q3 - ax;
+        const float fAy = 2.0f * q1q2 + _2q3q4 - ay;
+        const float fAz = 1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az;
+        const float fMx = _2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx;
+        const float fMy = _2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my;
+        const float fMz = _2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz;
+
+        // 4. Gradient (Jacobienne transposée x résidus)
+        float s1 = -_2q3 * fAx + _2q2 * fAy - _2bz * q3 * fMx + (-_2bx * q4 + _2bz * q2) * fMy + _2bx * q3 * fMz;
+        float s2 = _2q4 * fAx + _2q1 * fAy - 4.0f * q2 * fAz + _2bz * q4 * fMx + (_2bx * q3 + _2bz * q1) * fMy + (_2bx * q4 - _4bz * q2) * fMz;
+        float s3 = -_2q1 * fAx + _2q4 * fAy - 4.0f * q3 * fAz + (-_4bx * q3 - _2bz * q1) * fMx + (_2bx * q2 + _2bz * q4) * fMy + (_2bx * q1 - _4bz * q3) * fMz;
+        float s4 = _2q2 * fAx + _2q3 * fAy + (-_4bx * q4 + _2bz * q2) * fMx + (-_2bx * q1 + _2bz * q3) * fMy + _2bx * q2 * fMz;
+        normalize4(s1, s2, s3, s4);
+
+        // 5. Dérivée du quaternion puis intégration sur dt
+        const float dt = sample.dt;
+        const float qDot1 = 0.5f * (-q2 * gx - q3 * gy - q4 * gz) - b * s1;
+        const float qDot2 = 0.5f * (q1 * gx + q3 * gz - q4 * gy) - b * s2;
+        const float qDot3 = 0.5f * (q1 * gy - q2 * gz + q4 * gx) - b * s3;
+        const float qDot4 = 0.5f * (q1 * gz + q2 * gy - q3 * gx) - b * s4;
+        q1 += qDot1 * dt; q2 += qDot2 * dt; q3 += qDot3 * dt; q4 += qDot4 * dt;
+        normalize4(q1, q2, q3, q4);
+    }
+
+    m_q[0] = q1; m_q[1] = q2; m_q[2] = q3; m_q[3] = q4;
+    return integrated;
+}
+
+// ============================================================================
+// Mahony
+// ============================================================================
+
+/**
+ * @brief Filtre complémentaire de Mahony (formulation x-io, même convention que Madgwick).
+ * @details L'erreur est le produit vectoriel entre les directions mesurées (gravité, champ magnétique)
+ * et celles prédites par le quaternion ; elle corrige directement la vitesse angulaire via un PI.
+ */
+void MahonyEngine::integrate(const ImuSample& sample, float mx, float my, float mz) {
+    float ax = sample.ax, ay = sample.ay, az = sample.az;
+    float gx = sample.gx, gy = sample.gy, gz = sample.gz;
+    const float dt = sample.dt;
+    float q0 = m_q[0], q1 = m_q[1], q2 = m_q[2], q3 = m_q[3];
+
+    // 1. Normalisation des mesures
+    const float accSq = ax * ax + ay * ay + az * az;
+    const float magSq = mx * mx + my * my + mz * mz;
+    if (accSq == 0.0f || magSq == 0.0f) return;
+    const float accInv = invSqrt(accSq);
+    ax *= accInv; ay *= accInv; az *= accInv;
+    const float magInv = invSqrt(magSq);
+    mx *= magInv; my *= magInv; mz *= magInv;
+
+    const float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    const float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    const float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+    // 2. Direction de référence du champ magnétique (composantes horizontale bx et verticale bz)
+    const float hx = 2.0f * (mx * (0.5f - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
+    const float hy = 2.0f * (mx * (q1q2 + q0q3) + my * (0.5f - q1q1 - q3q3) + mz * (q2q3 - q0q1));
+    const float bx = std::sqrt(hx * hx + hy * hy);
+    const float bz = 2.0f * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1) + mz * (0.5f - q1q1 - q2q2));
+
+    // 3. Directions estimées de la gravité (v) et du champ magnétique (w), divisées par deux
+    const float halfvx = q1q3 - q0q2;
+    const float halfvy = q0q1 + q2q3;
+    const float halfvz = q0q0 - 0.5f + q3q3;
+    const float halfwx = bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2);
+    const float halfwy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
+    const float halfwz = bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2);
+
+    // 4. Erreur = somme des produits vectoriels mesuré x estimé
+    const float halfex = (ay * halfvz - az * halfvy) + (my * halfwz - mz * halfwy);
+    const float halfey = (az * halfvx - ax * halfvz) + (mz * halfwx - mx * halfwz);
+    const float halfez = (ax * halfvy - ay * halfvx) + (mx * halfwy - my * halfwx);
+
+    // 5. Correcteur PI appliqué à la vitesse angulaire
+    if (m_ki > 0.0f) {
+        m_integral[0] += 2.0f * m_ki * halfex * dt;
+        m_integral[1] += 2.0f * m_ki * halfey * dt;
+        m_integral[2] += 2.0f * m_ki * halfez * dt;
+        gx += m_integral[0]; gy += m_integral[1]; gz += m_integral[2];
+    }
+    gx += 2.0f * m_kp * halfex;
+    gy += 2.0f * m_kp * halfey;
+    gz += 2.0f * m_kp * halfez;
+
+    // 6. Intégration du quaternion (q' = 0.5 q ⊗ ω) puis normalisation
+    gx *= 0.5f * dt; gy *= 0.5f * dt; gz *= 0.5f * dt;
+    const float qa = q0, qb = q1, qc = q2;
+    q0 += (-qb * gx - qc * gy - q3 * gz);
+    q1 += (qa * gx + qc * gz - q3 * gy);
+    q2 += (qa * gy - qb * gz + q3 * gx);
+    q3 += (qa * gz + qb * gy - qc * gx);
+    normalize4(q0, q1, q2, q3);
+
+    m_q[0] = q0; m_q[1] = q1; m_q[2] = q2; m_q[3] = q3;
+}
+
+void MahonyEngine::resetState() {
+    m_integral[0] = m_integral[1] = m_integral[2] = 0.0f;
+}
+
+// ============================================================================
+// Kalman à état d'erreur
+// ============================================================================
+
+EskfEngine::EskfEngine(const Noise& noise) : m_noise(noise) {
+    resetState();
+}
+
+void EskfEngine::resetState() {
+    m_bias[0] = m_bias[1] = m_bias[2] = 0.0f;
+    for (auto& row : m_P) std::fill(std::begin(row), std::end(row), 0.0f);
+    for (int i = 0; i < 3; ++i) {
+        m_P[i][i] = 0.1f;           // ≈ 18° d'incertitude initiale sur l'attitude
+        m_P[i + 3][i + 3] = 1e-4f;  // ≈ 0.6 °/s d'incertitude sur le biais gyro
+    }
+}
+
+/**
+ * @brief Propagation puis corrections gravité et champ magnétique.
+ * @details État d'erreur δx = [δθ (angle local, repère capteur), δb (biais gyro)].
+ * Propagation : F = [[I - [ω×]dt, -I dt], [0, I]], P = F P Fᵀ + Q.
+ */
+void EskfEngine::integrate(const ImuSample& sample, float mx, float my, float mz) {
+    const float dt = sample.dt;
+    if (dt <= 0.0f) return;
+
+    // --- 1. Propagation de l'état nominal : q ← q ⊗ exp(0.5 (ω - b) dt) ---
+    const float wx = sample.gx - m_bias[0];
+    const float wy = sample.gy - m_bias[1];
+    const float wz = sample.gz - m_bias[2];
+    {
+        const float hx = 0.5f * wx * dt, hy = 0.5f * wy * dt, hz = 0.5f * wz * dt;
+        float q0 = m_q[0], q1 = m_q[1], q2 = m_q[2], q3 = m_q[3];
+        const float n0 = q0 - q1 * hx - q2 * hy - q3 * hz;
+        const float n1 = q1 + q0 * hx + q2 * hz - q3 * hy;
+        const float n2 = q2 + q0 * hy - q1 * hz + q3 * hx;
+        const float n3 = q3 + q0 * hz + q1 * hy - q2 * hx;
+        q0 = n0; q1 = n1; q2 = n2; q3 = n3;
+        normalize4(q0, q1, q2, q3);
+        m_q[0] = q0; m_q[1] = q1; m_q[2] = q2; m_q[3] = q3;
+    }
+
+    // --- 2. Propagation de la covariance ---
+    // Blocs : A = I - [ω×]dt (attitude/attitude), B = -I dt (attitude/biais).
+    float A[3][3] = {{1.0f, wz * dt, -wy * dt},
+                     {-wz * dt, 1.0f, wx * dt},
+                     {wy * dt, -wx * dt, 1.0f}};
+    float FP[6][6];
+    for (int j = 0; j < 6; ++j) {
+        for (int i = 0; i < 3; ++i) {
+            FP[i][j] = A[i][0] * m_P[0][j] + A[i][1] * m_P[1][j] + A[i][2] * m_P[2][j] - dt * m_P[i + 3][j];
+            FP[i + 3][j] = m_P[i + 3][j];
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            m_P[i][j] = FP[i][0] * A[j][0] + FP[i][1] * A[j][1] + FP[i][2] * A[j][2] - dt * FP[i][j + 3];
+            m_P[i][j + 3] = FP[i][j + 3];
+        }
+    }
+    const float qTheta = m_noise.gyro * m_noise.gyro * dt * dt;
+    const float qBias = m_noise.gyroBias * m_noise.gyroBias * dt;
+    for (int i = 0; i < 3; ++i) {
+        m_P[i][i] += qTheta;
+        m_P[i + 3][i + 3] += qBias;
+    }
+
+    float R[3][3];
+    rotationMatrix(m_q, R);
+
+    // --- 3. Correction par la gravité (si le véhicule n'accélère pas trop) ---
+    const float accNorm = std::sqrt(sample.ax * sample.ax + sample.ay * sample.ay + sample.az * sample.az);
+    if (accNorm > 0.0f && std::abs(accNorm - 1.0f) < m_noise.accelGate) {
+        const float measured[3] = {sample.ax / accNorm, sample.ay / accNorm, sample.az / accNorm};
+        const float predicted[3] = {R[2][0], R[2][1], R[2][2]}; // Rᵀ · (0, 0, 1)
+        correct(measured, predicted, m_noise.accel * m_noise.accel);
+        rotationMatrix(m_q, R);
+    }
+
+    // --- 4. Correction par le champ magnétique ---
+    const float magNorm = std::sqrt(mx * mx + my * my + mz * mz);
+    if (magNorm > 0.0f) {
+        const float m[3] = {mx / magNorm, my / magNorm, mz / magNorm};
+        // Champ de référence (horizontal bx vers le Nord, vertical bz) reconstruit depuis l'estimation courante
+        const float h[3] = {R[0][0] * m[0] + R[0][1] * m[1] + R[0][2] * m[2],
+                            R[1][0] * m[0] + R[1][1] * m[1] + R[1][2] * m[2],
+                            R[2][0] * m[0] + R[2][1] * m[1] + R[2][2] * m[2]};
+        const float bx = std::sqrt(h[0] * h[0] + h[1] * h[1]);
+        const float bz = h[2];
+        const float predicted[3] = {R[0][0] * bx + R[2][0] * bz,
+                                    R[0][1] * bx + R[2][1] * bz,
+                                    R[0][2] * bx + R[2][2] * bz}; // Rᵀ · (bx, 0, bz)
+        correct(m, predicted, m_noise.mag * m_noise.mag);
+    }
+}
+
+/**
+ * @brief Correction de Kalman pour une direction mesurée (3 composantes).
+ * @details Modèle linéarisé : z ≈ h + [h×] δθ, soit H = [[h×], 0]. Gain K = P Hᵀ S⁻¹,
+ * puis injection de δx dans l'état nominal et remise à zéro implicite de l'erreur.
+ */
+void EskfEngine::correct(const float measured[3], const float predicted[3], float variance) {
+    const float hx = predicted[0], hy = predicted[1], hz = predicted[2];
+    const float Hs[3][3] = {{0.0f, -hz, hy},
+                            {hz, 0.0f, -hx},
+                            {-hy, hx, 0.0f}};
+
+    // PHt = P Hᵀ (6x3) : seul le bloc attitude de H est non nul.
+    float PHt[6][3];
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            PHt[i][j] = m_P[i][0] * Hs[j][0] + m_P[i][1] * Hs[j][1] + m_P[i][2] * Hs[j][2];
+        }
+    }
+
+    // S = H P Hᵀ + R (3x3)
+    float S[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            S[i][j] = Hs[i][0] * PHt[0][j] + Hs[i][1] * PHt[1][j] + Hs[i][2] * PHt[2][j];
+        }
+        S[i][i] += variance;
+    }
+
+    // S⁻¹ par la comatrice
+    const float det = S[0][0] * (S[1][1] * S[2][2] - S[1][2] * S[2][1])
+                    - S[0][1] * (S[1][0] * S[2][2] - S[1][2] * S[2][0])
+                    + S[0][2] * (S[1][0] * S[2][1] - S[1][1] * S[2][0]);
+    if (std::abs(det) < 1e-12f) return;
+    const float invDet = 1.0f / det;
+    float Si[3][3];
+    Si[0][0] = (S[1][1] * S[2][2] - S[1][2] * S[2][1]) * invDet;
+    Si[0][1] = (S[0][2] * S[2][1] - S[0][1] * S[2][2]) * invDet;
+    Si[0][2] = (S[0][1] * S[1][2] - S[0][2] * S[1][1]) * invDet;
+    Si[1][0] = (S[1][2] * S[2][0] - S[1][0] * S[2][2]) * invDet;
+    Si[1][1] = (S[0][0] * S[2][2] - S[0][2] * S[2][0]) * invDet;
+    Si[1][2] = (S[0][2] * S[1][0] - S[0][0] * S[1][2]) * invDet;
+    Si[2][0] = (S[1][0] * S[2][1] - S[1][1] * S[2][0]) * invDet;
+    Si[2][1] = (S[0][1] * S[2][0] - S[0][0] * S[2][1]) * invDet;
+    Si[2][2] = (S[0][0] * S[1][1] - S[0][1] * S[1][0]) * invDet;
+
+    // K = PHt S⁻¹ (6x3), δx = K (z - h)
+    const float innovation[3] = {measured[0] - hx, measured[1] - hy, measured[2] - hz};
+    float K[6][3];
+    float dx[6];
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            K[i][j] = PHt[i][0] * Si[0][j] + PHt[i][1] * Si[1][j] + PHt[i][2] * Si[2][j];
+        }
+        dx[i] = K[i][0] * innovation[0] + K[i][1] * innovation[1] + K[i][2] * innovation[2];
+    }
+
+    // P ← P - K (H P) avec H P = PHtᵀ (P symétrique), puis symétrisation
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            m_P[i][j] -= K[i][0] * PHt[j][0] + K[i][1] * PHt[j][1] + K[i][2] * PHt[j][2];
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        for (int j = i + 1; j < 6; ++j) {
+            const float mean = 0.5f * (m_P[i][j] + m_P[j][i]);
+            m_P[i][j] = m_P[j][i] = mean;
+        }
+    }
+
+    // Injection : q ← q ⊗ (1, δθ/2), b ← b + δb
+    const float ex = 0.5f * dx[0], ey = 0.5f * dx[1], ez = 0.5f * dx[2];
+    float q0 = m_q[0], q1 = m_q[1], q2 = m_q[2], q3 = m_q[3];
+    const float n0 = q0 - q1 * ex - q2 * ey - q3 * ez;
+    const float n1 = q1 + q0 * ex + q2 * ez - q3 * ey;
+    const float n2 = q2 + q0 * ey - q1 * ez + q3 * ex;
+    const float n3 = q3 + q0 * ez + q1 * ey - q2 * ex;
+    q0 = n0; q1 = n1; q2 = n2; q3 = n3;
+    normalize4(q0, q1, q2, q3);
+    m_q[0] = q0; m_q[1] = q1; m_q[2] = q2; m_q[3] = q3;
+
+    m_bias[0] += dx[3]; m_bias[1] += dx[4]; m_bias[2] += dx[5];
+}
+
+// ============================================================================
+// Lissage du cap et fabrique
+// ============================================================================
+
+float HeadingSmoother::update(float headingDeg, float dt) {
+    if (!m_initialized) {
+        m_value = headingDeg;
+        m_initialized = true;
+        return m_value;
+    }
+
+    // On mélange l'ancien cap avec une fraction du nouveau (≈ 90 % / 10 % à 10 Hz).
+    // Cela empêche la carte de faire des micro-tremblements à l'écran à cause des vibrations.
+    const float alpha = 1.0f - std::exp(-std::max(dt, 0.0f) / m_tau);
+
+    // Gestion du passage difficile entre 359° et 0° pour éviter que la carte ne fasse
+    // un tour complet sur elle-même lors du passage du Nord.
+    float diff = headingDeg - m_value;
+    if (diff > 180.0f) m_value += 360.0f;
+    else if (diff < -180.0f) m_value -= 360.0f;
+    m_value = (m_value * (1.0f - alpha)) + (headingDeg * alpha);
+
+    // On remet la valeur lissée proprement entre 0 et 360°.
+    m_value = wrap360(m_value);
+    return m_value;
+}
+
+std::unique_ptr<OrientationEngine> createOrientationEngine(FusionAlgorithm algorithm) {
+    switch (algorithm) {
+    case FusionAlgorithm::Mahony:
+        return std::make_unique<MahonyEngine>();
+    case FusionAlgorithm::Eskf:
+        return std::make_unique<EskfEngine>();
+    case FusionAlgorithm::Madgwick:
+    case FusionAlgorithm::Count:
+        break;
+    }
+    return std::make_unique<MadgwickEngine>();
+}
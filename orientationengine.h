@@ -0,0 +1,293 @@
+/**
+ * @file orientationengine.h
+ * @brief Rôle architectural : Algorithmes de fusion de capteurs interchangeables (estimation d'orientation).
+ * @details Responsabilités : Estimer l'orientation 3D (quaternion, repère NED) à partir d'échantillons
+ * inertiels calibrés, en déduire le cap compensé en inclinaison et mesurer le coût CPU de chaque mise à jour.
+ * Trois implémentations partagent la même interface : Madgwick (descente de gradient), Mahony
+ * (correcteur PI complémentaire) et un filtre de Kalman étendu à état d'erreur (ESKF).
+ * Dépendances principales : ImuSample (aucune dépendance Qt hormis les types entiers).
+ */
+
+#ifndef ORIENTATIONENGINE_H
+#define ORIENTATIONENGINE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include "imusample.h"
+
+/**
+ * @brief Algorithmes de fusion disponibles.
+ */
+enum class FusionAlgorithm {
+    Madgwick = 0, ///< Descente de gradient, un seul gain (beta). Référence historique.
+    Mahony,       ///< Correcteur proportionnel-intégral sur l'erreur de direction (Kp, Ki), le moins coûteux.
+    Eskf,         ///< Kalman à état d'erreur (attitude + biais gyro), le plus coûteux mais adaptatif.
+    Count         ///< Nombre d'algorithmes (non sélectionnable).
+};
+
+/**
+ * @class OrientationEngine
+ * @brief Interface commune des filtres de fusion.
+ * @details La classe de base gère ce qui est commun à tous les filtres : maintien de la dernière mesure
+ * magnétique entre deux données AK8963, chronométrage CPU de chaque mise à jour, calcul du cap
+ * compensé en inclinaison et variance de ce cap. Les statistiques sont atomiques : elles peuvent
+ * être lues depuis le thread GUI pendant que le thread d'acquisition fait tourner le filtre.
+ */
+class OrientationEngine {
+public:
+    /**
+     * @struct Stats
+     * @brief Coût et stabilité mesurés d'un filtre.
+     */
+    struct Stats {
+        quint64 updates = 0;              ///< Nombre de mises à jour exécutées.
+        double meanCpuNs = 0.0;           ///< Coût CPU moyen d'une mise à jour (ns, horloge monotone).
+        double headingVarianceDeg2 = 0.0; ///< Variance glissante du cap brut autour de sa moyenne (deg²).
+    };
+
+    virtual ~OrientationEngine() = default;
+
+    /**
+     * @brief Algorithme implémenté.
+     */
+    virtual FusionAlgorithm algorithm() const = 0;
+
+    /**
+     * @brief Nom lisible de l'algorithme (journaux, diagnostics).
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Fusionne un échantillon.
+     * @param sample Échantillon calibré, repère NED, dt renseigné.
+     * @return false tant qu'aucune mesure magnétique n'a été reçue (le filtre n'avance pas).
+     */
+    bool update(const ImuSample& sample);
+
+    /**
+     * @brief Fusionne un lot d'échantillons consécutifs (vidage FIFO, rejeu).
+     * @param samples Échantillons calibrés, repère NED, dt renseigné.
+     * @param count Nombre d'échantillons.
+     * @return true si au moins un échantillon a fait avancer le filtre.
+     */
+    bool updateBatch(const ImuSample* samples, std::size_t count);
+
+    /**
+     * @brief Réinitialise le filtre à l'orientation donnée (quaternion w, x, y, z).
+     * @details Les mesures magnétiques mémorisées et l'état interne propre au filtre sont effacés,
+     * les statistiques sont conservées.
+     */
+    void reset(const float quaternion[4]);
+
+    /**
+     * @brief Réinitialise le filtre à l'orientation neutre.
+     */
+    void reset();
+
+    /**
+     * @brief Quaternion courant (w, x, y, z), repère capteur vers NED.
+     */
+    const float* quaternion() const { return m_q; }
+
+    /**
+     * @brief true dès qu'une mesure magnétique a été reçue.
+     */
+    bool hasMag() const { return m_hasMag; }
+
+    /**
+     * @brief Cap magnétique compensé en inclinaison (degrés, 0 à 360, sens horaire).
+     * @details Met aussi à jour la variance glissante du cap : à appeler une fois par cap publié.
+     */
+    float computeHeading();
+
+    /**
+     * @brief Statistiques de coût et de stabilité (lisibles depuis n'importe quel thread).
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Demande la remise à zéro des statistiques (depuis n'importe quel thread).
+     * @details La moyenne glissante du cap n'est pas atomique : c'est le thread du filtre qui l'efface,
+     * à sa prochaine mise à jour. D'ici là, stats() renvoie des statistiques vides.
+     */
+    void resetStats();
+
+protected:
+    /**
+     * @brief Étape propre au filtre : intègre un échantillon avec le champ magnétique courant.
+     * @param sample Échantillon (accéléromètre, gyroscope, dt).
+     * @param mx Champ magnétique X maintenu (non normalisé).
+     * @param my Champ magnétique Y maintenu (non normalisé).
+     * @param mz Champ magnétique Z maintenu (non normalisé).
+     */
+    virtual void integrate(const ImuSample& sample, float mx, float my, float mz) = 0;
+
+    /**
+     * @brief Étape par lot ; par défaut, appels successifs à integrate() avec maintien du champ magnétique.
+     * @return Nombre d'échantillons effectivement intégrés.
+     */
+    virtual std::size_t integrateBatch(const ImuSample* samples, std::size_t count);
+
+    /**
+     * @brief Remise à zéro de l'état propre au filtre (intégrale, covariance, biais...).
+     */
+    virtual void resetState() {}
+
+    /**
+     * @brief Mémorise une nouvelle mesure magnétique si l'échantillon en porte une.
+     */
+    void holdMag(const ImuSample& sample);
+
+    float m_q[4] = {1.0f, 0.0f, 0.0f, 0.0f}; ///< Quaternion courant (w, x, y, z)
+    float m_mag[3] = {0.0f, 0.0f, 0.0f};     ///< Dernière mesure magnétique (maintenue entre deux données AK8963)
+    bool m_hasMag = false;                   ///< true dès qu'une première mesure magnétique a été reçue
+
+private:
+    void recordCost(qint64 elapsedNs, std::size_t updates);
+    void applyStatsReset();
+
+    std::atomic<quint64> m_updates{0};      ///< Mises à jour exécutées
+    std::atomic<qint64> m_cpuNs{0};         ///< Temps CPU cumulé (ns)
+    std::atomic<double> m_headingVariance{0.0}; ///< Variance glissante du cap (deg²)
+    float m_headingMean = 0.0f;             ///< Moyenne glissante du cap (deg), thread du filtre uniquement
+    bool m_headingSeeded = false;           ///< false tant que la moyenne n'est pas initialisée
+    std::atomic<bool> m_statsResetRequested{false}; ///< resetStats() en attente du thread du filtre
+};
+
+/**
+ * @class MadgwickEngine
+ * @brief Filtre de Madgwick (descente de gradient, méthode Kris Winer).
+ * @details Le traitement par lot garde le quaternion en registres, ne normalise le champ magnétique
+ * qu'à l'arrivée d'une nouvelle mesure et utilise une racine carrée inverse rapide (NEON sur AArch64).
+ */
+class MadgwickEngine : public OrientationEngine {
+public:
+    /**
+     * @param beta Gain du filtre (équilibre entre gyroscope et correction accéléromètre/magnétomètre).
+     */
+    explicit MadgwickEngine(float beta = 0.1f) : m_beta(beta) {}
+
+    FusionAlgorithm algorithm() const override { return FusionAlgorithm::Madgwick; }
+    const char* name() const override { return "Madgwick"; }
+
+protected:
+    void integrate(const ImuSample& sample, float mx, float my, float mz) override;
+    std::size_t integrateBatch(const ImuSample* samples, std::size_t count) override;
+
+private:
+    const float m_beta; ///< Gain du filtre de Madgwick
+};
+
+/**
+ * @class MahonyEngine
+ * @brief Filtre complémentaire de Mahony (correcteur PI sur l'erreur entre directions mesurées et estimées).
+ * @details Pas de descente de gradient : l'erreur est un simple produit vectoriel, d'où un coût
+ * par mise à jour nettement inférieur à Madgwick. Le terme intégral estime le biais résiduel du gyroscope.
+ */
+class MahonyEngine : public OrientationEngine {
+public:
+    /**
+     * @param kp Gain proportionnel (vitesse de correction).
+     * @param ki Gain intégral (0 = pas d'estimation du biais gyro).
+     */
+    explicit MahonyEngine(float kp = 0.5f, float ki = 0.005f) : m_kp(kp), m_ki(ki) {}
+
+    FusionAlgorithm algorithm() const override { return FusionAlgorithm::Mahony; }
+    const char* name() const override { return "Mahony"; }
+
+protected:
+    void integrate(const ImuSample& sample, float mx, float my, float mz) override;
+    void resetState() override;
+
+private:
+    const float m_kp;                                ///< Gain proportionnel
+    const float m_ki;                                ///< Gain intégral
+    float m_integral[3] = {0.0f, 0.0f, 0.0f};        ///< Terme intégral (rad/s)
+};
+
+/**
+ * @class EskfEngine
+ * @brief Filtre de Kalman étendu à état d'erreur (attitude + biais gyroscope, 6 états).
+ * @details L'état nominal (quaternion, biais) est propagé avec le gyroscope ; l'erreur (petit angle
+ * local + erreur de biais) porte la covariance 6x6. Deux corrections séquentielles : direction de la
+ * gravité (ignorée si la norme mesurée s'écarte de 1 g, pour ne pas confondre accélération du véhicule
+ * et inclinaison) puis direction du champ magnétique.
+ */
+class EskfEngine : public OrientationEngine {
+public:
+    /**
+     * @brief Paramètres de bruit du filtre.
+     */
+    struct Noise {
+        float gyro = 0.01f;        ///< Densité de bruit du gyroscope (rad/s).
+        float gyroBias = 0.0005f;  ///< Marche aléatoire du biais gyro (rad/s²).
+        float accel = 0.05f;       ///< Bruit de la direction de gravité mesurée (normalisée).
+        float mag = 0.1f;          ///< Bruit de la direction magnétique mesurée (normalisée).
+        float accelGate = 0.15f;   ///< Écart toléré entre la norme d'accélération et 1 g.
+    };
+
+    EskfEngine() : EskfEngine(Noise()) {}
+    explicit EskfEngine(const Noise& noise);
+
+    FusionAlgorithm algorithm() const override { return FusionAlgorithm::Eskf; }
+    const char* name() const override { return "ESKF"; }
+
+    /**
+     * @brief Biais gyroscope résiduel estimé (rad/s).
+     */
+    const float* gyroBias() const { return m_bias; }
+
+protected:
+    void integrate(const ImuSample& sample, float mx, float my, float mz) override;
+    void resetState() override;
+
+private:
+    void correct(const float measured[3], const float predicted[3], float variance);
+
+    const Noise m_noise;                    ///< Paramètres de bruit
+    float m_bias[3] = {0.0f, 0.0f, 0.0f};   ///< Biais gyroscope nominal (rad/s)
+    float m_P[6][6] = {};                   ///< Covariance de l'état d'erreur
+};
+
+/**
+ * @class HeadingSmoother
+ * @brief Lissage visuel du cap (passe-bas exponentiel tenant compte du passage 359° / 0°).
+ * @details Le coefficient dépend de dt pour garder le même rendu quelle que soit la fréquence.
+ * Remplace l'ancienne variable locale statique : chaque source possède son propre état et peut le réinitialiser.
+ */
+class HeadingSmoother {
+public:
+    /**
+     * @param tauSeconds Constante de temps du lissage (s).
+     */
+    explicit HeadingSmoother(float tauSeconds = 0.95f) : m_tau(tauSeconds) {}
+
+    /**
+     * @brief Intègre un nouveau cap et renvoie le cap lissé.
+     * @param headingDeg Cap brut (degrés, 0 à 360).
+     * @param dt Temps écoulé depuis l'appel précédent (s).
+     * @return Cap lissé (degrés, 0 à 360). Le premier appel renvoie le cap brut.
+     */
+    float update(float headingDeg, float dt);
+
+    /**
+     * @brief Oublie l'historique : le prochain cap sera repris tel quel.
+     */
+    void reset() { m_initialized = false; }
+
+    float value() const { return m_value; } ///< Dernier cap lissé.
+
+private:
+    float m_tau;                ///< Constante de temps (s)
+    float m_value = 0.0f;       ///< Cap lissé courant (degrés)
+    bool m_initialized = false; ///< false avant le premier cap
+};
+
+/**
+ * @brief Fabrique d'un filtre de fusion avec ses réglages par défaut.
+ */
+std::unique_ptr<OrientationEngine> createOrientationEngine(FusionAlgorithm algorithm);
+
+#endif // ORIENTATIONENGINE_H
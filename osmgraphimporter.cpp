@@ -0,0 +1,227 @@
+/**
+ * @file osmgraphimporter.cpp
+ * @brief Implémentation de la conversion OSM -> graphe routier.
+ */
+
+#include "osmgraphimporter.h"
+#include "roadgraphbuilder.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace {
+constexpr double EarthRadiusM = 6371008.8;
+constexpr double KmhPerMph = 1.609344;
+
+std::string_view tag(const OsmPbfReader::Tags& tags, std::string_view key)
+{
+    for (const OsmPbfReader::Tag& t : tags) {
+        if (t.first == key) return t.second;
+    }
+    return {};
+}
+
+bool isOneOf(std::string_view value, std::initializer_list<std::string_view> values)
+{
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+double haversineM(double lat1, double lon1, double lat2, double lon2)
+{
+    const double dLat = qDegreesToRadians(lat2 - lat1);
+    const double dLon = qDegreesToRadians(lon2 - lon1);
+    const double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+        + std::cos(qDegreesToRadians(lat1)) * std::cos(qDegreesToRadians(lat2)) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2.0 * EarthRadiusM * std::asin(std::min(1.0, std::sqrt(a)));
+}
+}
+
+OsmGraphImporter::OsmGraphImporter(RoadGraphBuilder& builder)
+    : m_builder(builder)
+{
+}
+
+int OsmGraphImporter::defaultSpeedKmh(std::string_view highway)
+{
+    struct Entry {
+        std::string_view highway;
+        int kmh;
+    };
+    static constexpr Entry speeds[] = {
+        {"motorway", 120}, {"motorway_link", 60}, {"trunk", 100}, {"trunk_link", 50},
+        {"primary", 80}, {"primary_link", 50}, {"secondary", 70}, {"secondary_link", 40},
+        {"tertiary", 60}, {"tertiary_link", 40}, {"unclassified", 50}, {"road", 40},
+        {"residential", 30}, {"service", 20}, {"living_street", 10},
+    };
+    for (const Entry& entry : speeds) {
+        if (entry.highway == highway) return entry.kmh;
+    }
+    return 0;
+}
+
+int OsmGraphImporter::parseMaxSpeed(std::string_view value)
+{
+    if (value.empty()) return 0;
+
+    // Valeurs implicites : "FR:urban", "FR:zone30", "walk"... (le préfixe de pays est ignoré).
+    const std::size_t colon = value.find(':');
+    const std::string_view implicit = colon == std::string_view::npos ? value : value.substr(colon + 1);
+    if (implicit == "urban") return 50;
+    if (implicit == "rural") return 80;
+    if (implicit == "trunk") return 110;
+    if (implicit == "motorway") return 130;
+    if (implicit == "living_street") return 20;
+    if (implicit == "walk") return 6;
+    if (implicit == "zone30" || implicit == "zone:30") return 30;
+    if (implicit == "zone20" || implicit == "zone:20") return 20;
+
+    int number = 0;
+    std::size_t i = 0;
+    while (i < value.size() && value[i] >= '0' && value[i] <= '9') {
+        number = number * 10 + (value[i] - '0');
+        if (number > 1000) return 0;
+        ++i;
+    }
+    if (i == 0) return 0; // "none", "signals", "variable"...
+    while (i < value.size() && value[i] == ' ') ++i;
+    if (value.substr(i) == "mph") return int(std::lround(number * KmhPerMph));
+    if (i < value.size() && value.substr(i) != "km/h" && value.substr(i) != "kmh") return 0;
+    return number;
+}
+
+OsmGraphImporter::Direction OsmGraphImporter::direction(const OsmPbfReader::Tags& tags)
+{
+    const std::string_view oneway = tag(tags, "oneway");
+    if (isOneOf(oneway, {"yes", "true", "1"})) return Direction::Forward;
+    if (isOneOf(oneway, {"-1", "reverse"})) return Direction::Backward;
+    if (isOneOf(oneway, {"no", "false", "0"})) return Direction::Both;
+    // Sens unique implicite : giratoires et autoroutes.
+    if (isOneOf(tag(tags, "junction"), {"roundabout", "circular"})) return Direction::Forward;
+    if (isOneOf(tag(tags, "highway"), {"motorway", "motorway_link"})) return Direction::Forward;
+    return Direction::Both;
+}
+
+bool OsmGraphImporter::import(const QString& path)
+{
+    m_error.clear();
+    m_stats = Stats();
+    m_ways.clear();
+    m_refs.clear();
+    m_names.clear();
+    m_nodeIndex.clear();
+    m_positions.clear();
+
+    // Passe 1 : chemins seulement (les nœuds, bien plus nombreux, ne sont pas décodés).
+    OsmPbfReader ways;
+    ways.setWayHandler([this](qint64, const std::vector<qint64>& refs, const OsmPbfReader::Tags& tags) {
+        onWay(refs, tags);
+    });
+    if (!ways.read(path)) {
+        m_error = ways.errorString();
+        return false;
+    }
+
+    // Passe 2 : nœuds utilisés par ces chemins, et lieux nommés.
+    OsmPbfReader nodes;
+    nodes.setNodeHandler([this](qint64 id, double lat, double lon, const OsmPbfReader::Tags& tags) {
+        onNode(id, lat, lon, tags);
+    });
+    if (!nodes.read(path)) {
+        m_error = nodes.errorString();
+        return false;
+    }
+
+    addEdges();
+    return true;
+}
+
+void OsmGraphImporter::onWay(const std::vector<qint64>& refs, const OsmPbfReader::Tags& tags)
+{
+    if (refs.size() < 2) return;
+    const std::string_view highway = tag(tags, "highway");
+    const int defaultKmh = defaultSpeedKmh(highway);
+    if (defaultKmh == 0 || tag(tags, "area") == "yes") return;
+    // Accès interdit aux voitures, sauf autorisation explicite.
+    const std::string_view motor = !tag(tags, "motorcar").empty() ? tag(tags, "motorcar") : tag(tags, "motor_vehicle");
+    if (isOneOf(motor, {"no", "private"})) return;
+    if (isOneOf(tag(tags, "access"), {"no", "private"}) && !isOneOf(motor, {"yes", "designated", "permissive"})) return;
+
+    RoadWay way;
+    way.firstRef = m_refs.size();
+    way.refCount = refs.size();
+    way.limitKmh = parseMaxSpeed(tag(tags, "maxspeed"));
+    way.travelKmh = way.limitKmh > 0 ? way.limitKmh : defaultKmh;
+    way.direction = direction(tags);
+    way.name = -1;
+    const std::string_view name = tag(tags, "name");
+    if (!name.empty()) {
+        way.name = int(m_names.size());
+        m_names.push_back(QByteArray(name.data(), qsizetype(name.size())));
+    }
+    m_ways.push_back(way);
+    m_refs.insert(m_refs.end(), refs.begin(), refs.end());
+    for (qint64 ref : refs) m_nodeIndex.emplace(ref, RoadGraph::NoNode);
+    ++m_stats.roadWays;
+}
+
+void OsmGraphImporter::onNode(qint64 id, double lat, double lon, const OsmPbfReader::Tags& tags)
+{
+    const auto it = m_nodeIndex.find(id);
+    if (it != m_nodeIndex.end() && it->second == RoadGraph::NoNode) {
+        it->second = m_builder.addNode(lat, lon);
+        m_positions.push_back(lat);
+        m_positions.push_back(lon);
+        ++m_stats.roadNodes;
+    }
+    if (tags.empty()) return;
+
+    const std::string_view name = tag(tags, "name");
+    if (name.empty()) return;
+    const QByteArray bytes(name.data(), qsizetype(name.size()));
+    if (isOneOf(tag(tags, "place"), {"city", "town", "village", "hamlet", "suburb", "quarter", "neighbourhood", "locality"})) {
+        m_builder.addPlace(bytes, lat, lon, RoadGraph::PlaceKind::Locality);
+        ++m_stats.places;
+    } else if (!tag(tags, "amenity").empty() || !tag(tags, "shop").empty() || !tag(tags, "tourism").empty()
+               || !tag(tags, "leisure").empty()) {
+        m_builder.addPlace(bytes, lat, lon, RoadGraph::PlaceKind::PointOfInterest);
+        ++m_stats.places;
+    }
+}
+
+void OsmGraphImporter::addEdges()
+{
+    for (const RoadWay& way : m_ways) {
+        const qint64* refs = m_refs.data() + way.firstRef;
+        const double metersPerSecond = way.travelKmh / 3.6;
+        for (std::size_t i = 0; i + 1 < way.refCount; ++i) {
+            const quint32 a = m_nodeIndex[refs[i]];
+            const quint32 b = m_nodeIndex[refs[i + 1]];
+            if (a == RoadGraph::NoNode || b == RoadGraph::NoNode) {
+                ++m_stats.missingNodes;
+                continue;
+            }
+            const double length = haversineM(m_positions[2 * a], m_positions[2 * a + 1],
+                                             m_positions[2 * b], m_positions[2 * b + 1]);
+            const double seconds = length / metersPerSecond;
+            if (way.direction != Direction::Backward) {
+                m_builder.addEdge(a, b, seconds, way.limitKmh);
+                ++m_stats.edges;
+            }
+            if (way.direction != Direction::Forward) {
+                m_builder.addEdge(b, a, seconds, way.limitKmh);
+                ++m_stats.edges;
+            }
+        }
+        if (way.name >= 0) {
+            // Point représentatif : nœud du milieu du chemin.
+            const quint32 middle = m_nodeIndex[refs[way.refCount / 2]];
+            if (middle != RoadGraph::NoNode) {
+                m_builder.addPlace(m_names[std::size_t(way.name)], m_positions[2 * middle],
+                                   m_positions[2 * middle + 1], RoadGraph::PlaceKind::Street);
+                ++m_stats.places;
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file osmgraphimporter.h
+ * @brief Rôle architectural : Conversion d'un extrait OpenStreetMap en graphe routier (outil de préparation).
+ * @details Responsabilités : Retenir les voies carrossables d'un extrait PBF (OsmPbfReader), en déduire
+ * sens de circulation, limitation et vitesse de parcours, puis alimenter RoadGraphBuilder en nœuds, arcs
+ * et lieux nommés (rues, points d'intérêt, localités) pour le géocodage hors ligne.
+ * Dépendances principales : OsmPbfReader, RoadGraphBuilder.
+ */
+
+#ifndef OSMGRAPHIMPORTER_H
+#define OSMGRAPHIMPORTER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "osmpbfreader.h"
+
+class RoadGraphBuilder;
+
+/**
+ * @class OsmGraphImporter
+ * @brief Import en deux passes : chemins routiers d'abord, puis seulement les nœuds qu'ils utilisent.
+ * @details Chaque nœud d'un chemin retenu devient un nœud du graphe (points de forme compris), ce qui
+ * permet de restituer le tracé exact ; la hiérarchie de contraction absorbe ces nœuds de degré 2.
+ * La vitesse de parcours est la limitation si elle est connue, sinon une vitesse par classe de voie.
+ */
+class OsmGraphImporter {
+public:
+    /**
+     * @brief Sens de circulation d'un chemin, par rapport à l'ordre de ses nœuds.
+     */
+    enum class Direction { Both, Forward, Backward };
+
+    /**
+     * @struct Stats
+     * @brief Bilan du dernier import.
+     */
+    struct Stats {
+        qint64 roadWays = 0;     ///< Chemins carrossables retenus.
+        qint64 roadNodes = 0;    ///< Nœuds du graphe.
+        qint64 edges = 0;        ///< Arcs orientés ajoutés.
+        qint64 places = 0;       ///< Lieux nommés proposés à l'index (avant fusion).
+        qint64 missingNodes = 0; ///< Tronçons ignorés faute de nœud (extrait découpé).
+    };
+
+    explicit OsmGraphImporter(RoadGraphBuilder& builder);
+
+    /**
+     * @brief Lit l'extrait et alimente le constructeur.
+     * @return false si l'extrait est illisible (errorString() précise la cause).
+     */
+    bool import(const QString& path);
+
+    QString errorString() const { return m_error; } ///< Cause du dernier échec.
+    const Stats& stats() const { return m_stats; }  ///< Bilan du dernier import.
+
+    /**
+     * @brief Vitesse de parcours par défaut d'une classe de voie (`highway=*`), en km/h.
+     * @return 0 si la voie n'est pas carrossable (chemin piéton, piste cyclable...).
+     */
+    static int defaultSpeedKmh(std::string_view highway);
+
+    /**
+     * @brief Limitation `maxspeed=*` en km/h : nombre, nombre suivi de `mph`, ou valeur implicite
+     *        (`FR:urban`, `FR:rural`, `FR:motorway`, `FR:zone30`, `walk`...).
+     * @return 0 si la valeur est absente ou sans limitation chiffrée (`none`, `signals`...).
+     */
+    static int parseMaxSpeed(std::string_view value);
+
+    /**
+     * @brief Sens de circulation déduit de `oneway`, `junction` et `highway`.
+     */
+    static Direction direction(const OsmPbfReader::Tags& tags);
+
+private:
+    /**
+     * @struct RoadWay
+     * @brief Chemin retenu à la première passe.
+     */
+    struct RoadWay {
+        std::size_t firstRef;  ///< Début dans m_refs.
+        std::size_t refCount;
+        int travelKmh;         ///< Vitesse de parcours.
+        int limitKmh;          ///< Limitation (0 : inconnue).
+        Direction direction;
+        int name;              ///< Index dans m_names, -1 sans nom.
+    };
+
+    void onWay(const std::vector<qint64>& refs, const OsmPbfReader::Tags& tags);
+    void onNode(qint64 id, double lat, double lon, const OsmPbfReader::Tags& tags);
+    void addEdges();
+
+    RoadGraphBuilder& m_builder;
+    QString m_error;
+    Stats m_stats;
+    std::vector<RoadWay> m_ways;
+    std::vector<qint64> m_refs;                     ///< Nœuds des chemins retenus, à la suite.
+    std::vector<QByteArray> m_names;                ///< Noms des chemins retenus.
+    std::unordered_map<qint64, quint32> m_nodeIndex; ///< Identifiant OSM -> nœud du graphe (NoNode : pas encore lu).
+    std::vector<double> m_positions;                ///< (lat, lon) par nœud du graphe.
+};
+
+#endif // OSMGRAPHIMPORTER_H
@@ -0,0 +1,385 @@
+/**
+ * @file osmpbfreader.cpp
+ * @brief Implémentation de la lecture PBF (fileformat.proto / osmformat.proto, décodage protobuf manuel).
+ */
+
+#include "osmpbfreader.h"
+#include <QByteArray>
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+// Types de fil protobuf.
+enum WireType { Varint = 0, Fixed64 = 1, LengthDelimited = 2, Fixed32 = 5 };
+
+/**
+ * @brief Champ protobuf : valeur entière (Varint, Fixed*) ou tranche d'octets (LengthDelimited).
+ */
+struct Field {
+    quint32 number = 0;
+    int wireType = 0;
+    quint64 value = 0;
+    const char* data = nullptr;
+    qsizetype size = 0;
+
+    std::string_view bytes() const { return std::string_view(data, std::size_t(size)); }
+};
+
+bool readVarint(const uchar*& p, const uchar* end, quint64& out)
+{
+    out = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uchar byte = *p++;
+        out |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+qint64 zigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+/**
+ * @brief Parcours des champs d'un message protobuf.
+ */
+class ProtoReader {
+public:
+    ProtoReader(const char* data, qsizetype size)
+        : m_p(reinterpret_cast<const uchar*>(data))
+        , m_end(reinterpret_cast<const uchar*>(data) + size)
+    {
+    }
+
+    /**
+     * @return false en fin de message ou sur un message mal formé (voir failed()).
+     */
+    bool next(Field& field)
+    {
+        if (m_p >= m_end) return false;
+        quint64 key = 0;
+        if (!readVarint(m_p, m_end, key)) return setFailed();
+        field.number = quint32(key >> 3);
+        field.wireType = int(key & 7);
+        field.data = nullptr;
+        field.size = 0;
+        switch (field.wireType) {
+        case Varint:
+            return readVarint(m_p, m_end, field.value) || setFailed();
+        case Fixed64:
+            if (m_end - m_p < 8) return setFailed();
+            field.value = qFromLittleEndian<quint64>(m_p);
+            m_p += 8;
+            return true;
+        case Fixed32:
+            if (m_end - m_p < 4) return setFailed();
+            field.value = qFromLittleEndian<quint32>(m_p);
+            m_p += 4;
+            return true;
+        case LengthDelimited: {
+            quint64 length = 0;
+            if (!readVarint(m_p, m_end, length) || length > quint64(m_end - m_p)) return setFailed();
+            field.data = reinterpret_cast<const char*>(m_p);
+            field.size = qsizetype(length);
+            m_p += length;
+            return true;
+        }
+        default:
+            return setFailed(); // Groupes (obsolètes) : absents du format OSM.
+        }
+    }
+
+    bool failed() const { return m_failed; }
+
+private:
+    bool setFailed()
+    {
+        m_failed = true;
+        m_p = m_end;
+        return false;
+    }
+
+    const uchar* m_p;
+    const uchar* m_end;
+    bool m_failed = false;
+};
+
+/**
+ * @brief Ajoute les entiers d'un champ répété, empaqueté (LengthDelimited) ou non (Varint).
+ */
+bool appendVarints(const Field& field, std::vector<quint64>& out)
+{
+    if (field.wireType == Varint) {
+        out.push_back(field.value);
+        return true;
+    }
+    if (field.wireType != LengthDelimited) return false;
+    const uchar* p = reinterpret_cast<const uchar*>(field.data);
+    const uchar* end = p + field.size;
+    while (p < end) {
+        quint64 value = 0;
+        if (!readVarint(p, end, value)) return false;
+        out.push_back(value);
+    }
+    return true;
+}
+
+/**
+ * @brief Décodage d'un blob : brut ou zlib (champ raw_size requis).
+ */
+bool decodeBlob(const char* data, qsizetype size, QByteArray& out, QString& error)
+{
+    ProtoReader reader(data, size);
+    Field field;
+    const char* raw = nullptr;
+    qsizetype rawLength = 0;
+    const char* zlib = nullptr;
+    qsizetype zlibLength = 0;
+    quint64 rawSize = 0;
+    while (reader.next(field)) {
+        if (field.number == 1 && field.wireType == LengthDelimited) {
+            raw = field.data;
+            rawLength = field.size;
+        } else if (field.number == 2 && field.wireType == Varint) {
+            rawSize = field.value;
+        } else if (field.number == 3 && field.wireType == LengthDelimited) {
+            zlib = field.data;
+            zlibLength = field.size;
+        } else if (field.number >= 4 && field.number <= 7) {
+            error = QStringLiteral("compression non prise en charge (seuls brut et zlib sont lus)");
+            return false;
+        }
+    }
+    if (reader.failed()) {
+        error = QStringLiteral("blob mal formé");
+        return false;
+    }
+    if (raw) {
+        out = QByteArray(raw, rawLength);
+        return true;
+    }
+    if (!zlib || rawSize == 0 || rawSize > quint64(OsmPbfReader::MaxBlobBytes)) {
+        error = QStringLiteral("blob vide ou trop grand");
+        return false;
+    }
+    // qUncompress attend la taille décompressée en tête, sur 4 octets gros-boutistes.
+    QByteArray compressed(4 + zlibLength, Qt::Uninitialized);
+    qToBigEndian(quint32(rawSize), reinterpret_cast<uchar*>(compressed.data()));
+    std::memcpy(compressed.data() + 4, zlib, std::size_t(zlibLength));
+    out = qUncompress(compressed);
+    if (quint64(out.size()) != rawSize) {
+        error = QStringLiteral("données zlib corrompues");
+        return false;
+    }
+    return true;
+}
+}
+
+bool OsmPbfReader::fail(const QString& error)
+{
+    m_error = error;
+    return false;
+}
+
+bool OsmPbfReader::read(const QString& path)
+{
+    m_error.clear();
+    m_blocks = 0;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return fail(QStringLiteral("fichier illisible"));
+    const qint64 size = file.size();
+    const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (!mapped) return fail(QStringLiteral("fichier vide ou impossible à projeter"));
+    const char* base = reinterpret_cast<const char*>(mapped);
+
+    bool headerSeen = false;
+    qint64 position = 0;
+    QByteArray block;
+    while (position < size) {
+        // [longueur de BlobHeader, 4 octets gros-boutistes][BlobHeader][Blob]
+        if (size - position < 4) return fail(QStringLiteral("fichier tronqué"));
+        const quint32 headerLength = qFromBigEndian<quint32>(mapped + position);
+        position += 4;
+        if (headerLength > quint32(MaxBlobHeaderBytes) || qint64(headerLength) > size - position) {
+            return fail(QStringLiteral("en-tête de bloc invalide"));
+        }
+        ProtoReader header(base + position, qsizetype(headerLength));
+        position += headerLength;
+        Field field;
+        std::string_view type;
+        quint64 dataSize = 0;
+        bool hasDataSize = false;
+        while (header.next(field)) {
+            if (field.number == 1 && field.wireType == LengthDelimited) type = field.bytes();
+            if (field.number == 3 && field.wireType == Varint) {
+                dataSize = field.value;
+                hasDataSize = true;
+            }
+        }
+        if (header.failed() || !hasDataSize || dataSize > quint64(MaxBlobBytes) || qint64(dataSize) > size - position) {
+            return fail(QStringLiteral("en-tête de bloc invalide"));
+        }
+        const char* blob = base + position;
+        position += qint64(dataSize);
+
+        if (type == "OSMHeader") {
+            QString error;
+            if (!decodeBlob(blob, qsizetype(dataSize), block, error)) return fail(error);
+            if (!readHeaderBlock(block.constData(), block.size())) return false;
+            headerSeen = true;
+        } else if (type == "OSMData") {
+            if (!headerSeen) return fail(QStringLiteral("bloc de données avant l'en-tête OSMHeader"));
+            if (!m_nodeHandler && !m_wayHandler) continue;
+            QString error;
+            if (!decodeBlob(blob, qsizetype(dataSize), block, error)) return fail(error);
+            if (!readPrimitiveBlock(block.constData(), block.size())) return false;
+            ++m_blocks;
+        }
+        // Autres types : ignorés, comme le prévoit le format.
+    }
+    return true;
+}
+
+bool OsmPbfReader::readHeaderBlock(const char* data, qsizetype size)
+{
+    ProtoReader reader(data, size);
+    Field field;
+    while (reader.next(field)) {
+        if (field.number != 4 || field.wireType != LengthDelimited) continue; // required_features
+        const std::string_view feature = field.bytes();
+        if (feature != "OsmSchema-V0.6" && feature != "DenseNodes") {
+            return fail(QStringLiteral("fonctionnalité requise non prise en charge : ")
+                        + QString::fromUtf8(feature.data(), qsizetype(feature.size())));
+        }
+    }
+    return !reader.failed() || fail(QStringLiteral("en-tête OSMHeader mal formé"));
+}
+
+bool OsmPbfReader::readPrimitiveBlock(const char* data, qsizetype size)
+{
+    std::vector<std::string_view> strings;
+    std::vector<Field> groups;
+    qint64 granularity = 100;
+    qint64 latOffset = 0;
+    qint64 lonOffset = 0;
+
+    // La granularité peut suivre les groupes : ceux-ci ne sont décodés qu'après le bloc entier.
+    ProtoReader block(data, size);
+    Field field;
+    while (block.next(field)) {
+        if (field.number == 1 && field.wireType == LengthDelimited) {
+            ProtoReader table(field.data, field.size);
+            Field entry;
+            while (table.next(entry)) {
+                if (entry.number == 1 && entry.wireType == LengthDelimited) strings.push_back(entry.bytes());
+            }
+            if (table.failed()) return fail(QStringLiteral("table de chaînes mal formée"));
+        } else if (field.number == 2 && field.wireType == LengthDelimited) {
+            groups.push_back(field);
+        } else if (field.number == 17 && field.wireType == Varint) {
+            granularity = qint64(field.value);
+        } else if (field.number == 19 && field.wireType == Varint) {
+            latOffset = qint64(field.value);
+        } else if (field.number == 20 && field.wireType == Varint) {
+            lonOffset = qint64(field.value);
+        }
+    }
+    if (block.failed()) return fail(QStringLiteral("bloc de données mal formé"));
+
+    auto string = [&strings](quint64 index) {
+        return index < strings.size() ? strings[std::size_t(index)] : std::string_view();
+    };
+    auto degrees = [granularity](qint64 offset, qint64 value) { return 1e-9 * double(offset + granularity * value); };
+    std::vector<quint64> keys;
+    std::vector<quint64> values;
+    std::vector<quint64> ids;
+    std::vector<quint64> lats;
+    std::vector<quint64> lons;
+
+    for (const Field& group : groups) {
+        ProtoReader elements(group.data, group.size);
+        Field element;
+        while (elements.next(element)) {
+            if (element.wireType != LengthDelimited) continue;
+            ProtoReader reader(element.data, element.size);
+            Field f;
+            keys.clear();
+            values.clear();
+            m_tags.clear();
+            bool ok = true;
+
+            if (element.number == 1 && m_nodeHandler) {
+                // Node : id (sint64), keys, vals, lat et lon (sint64).
+                qint64 id = 0;
+                qint64 lat = 0;
+                qint64 lon = 0;
+                while (reader.next(f)) {
+                    if (f.number == 1 && f.wireType == Varint) id = zigzag(f.value);
+                    else if (f.number == 2) ok = ok && appendVarints(f, keys);
+                    else if (f.number == 3) ok = ok && appendVarints(f, values);
+                    else if (f.number == 8 && f.wireType == Varint) lat = zigzag(f.value);
+                    else if (f.number == 9 && f.wireType == Varint) lon = zigzag(f.value);
+                }
+                if (!ok || reader.failed() || keys.size() != values.size()) return fail(QStringLiteral("nœud mal formé"));
+                for (std::size_t i = 0; i < keys.size(); ++i) m_tags.push_back({string(keys[i]), string(values[i])});
+                m_nodeHandler(id, degrees(latOffset, lat), degrees(lonOffset, lon), m_tags);
+            } else if (element.number == 2 && m_nodeHandler) {
+                // DenseNodes : id, lat et lon codés en écart au précédent ; étiquettes à plat,
+                // (clé, valeur)* 0 pour chaque nœud.
+                ids.clear();
+                lats.clear();
+                lons.clear();
+                while (reader.next(f)) {
+                    if (f.number == 1) ok = ok && appendVarints(f, ids);
+                    else if (f.number == 8) ok = ok && appendVarints(f, lats);
+                    else if (f.number == 9) ok = ok && appendVarints(f, lons);
+                    else if (f.number == 10) ok = ok && appendVarints(f, keys);
+                }
+                if (!ok || reader.failed() || lats.size() != ids.size() || lons.size() != ids.size()) {
+                    return fail(QStringLiteral("nœuds denses mal formés"));
+                }
+                qint64 id = 0;
+                qint64 lat = 0;
+                qint64 lon = 0;
+                std::size_t tag = 0;
+                for (std::size_t i = 0; i < ids.size(); ++i) {
+                    id += zigzag(ids[i]);
+                    lat += zigzag(lats[i]);
+                    lon += zigzag(lons[i]);
+                    m_tags.clear();
+                    while (tag < keys.size() && keys[tag] != 0) {
+                        if (tag + 1 >= keys.size()) return fail(QStringLiteral("étiquettes de nœuds denses mal formées"));
+                        m_tags.push_back({string(keys[tag]), string(keys[tag + 1])});
+                        tag += 2;
+                    }
+                    ++tag; // Séparateur 0 (absent si aucun nœud du groupe n'a d'étiquette).
+                    m_nodeHandler(id, degrees(latOffset, lat), degrees(lonOffset, lon), m_tags);
+                }
+            } else if (element.number == 3 && m_wayHandler) {
+                // Way : id (int64), keys, vals, refs (sint64 en écart au précédent).
+                qint64 id = 0;
+                ids.clear();
+                while (reader.next(f)) {
+                    if (f.number == 1 && f.wireType == Varint) id = qint64(f.value);
+                    else if (f.number == 2) ok = ok && appendVarints(f, keys);
+                    else if (f.number == 3) ok = ok && appendVarints(f, values);
+                    else if (f.number == 8) ok = ok && appendVarints(f, ids);
+                }
+                if (!ok || reader.failed() || keys.size() != values.size()) return fail(QStringLiteral("chemin mal formé"));
+                for (std::size_t i = 0; i < keys.size(); ++i) m_tags.push_back({string(keys[i]), string(values[i])});
+                m_refs.clear();
+                qint64 ref = 0;
+                for (quint64 delta : ids) {
+                    ref += zigzag(delta);
+                    m_refs.push_back(ref);
+                }
+                m_wayHandler(id, m_refs, m_tags);
+            }
+        }
+        if (elements.failed()) return fail(QStringLiteral("groupe d'éléments mal formé"));
+    }
+    return true;
+}
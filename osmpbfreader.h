@@ -0,0 +1,75 @@
+/**
+ * @file osmpbfreader.h
+ * @brief Rôle architectural : Lecture en flux d'un extrait OpenStreetMap au format PBF (outil de préparation).
+ * @details Responsabilités : Parcourir les blocs d'un fichier `.osm.pbf` (en-tête de bloc, blob brut ou
+ * zlib), décoder les PrimitiveBlock (nœuds simples et denses, chemins) et les livrer à des fonctions de
+ * rappel, sans construire de modèle intermédiaire. Le décodage protobuf est fait à la main (varints,
+ * champs empaquetés) : aucune dépendance hors de QtCore.
+ * Dépendances principales : QFile (projection mémoire), qUncompress.
+ */
+
+#ifndef OSMPBFREADER_H
+#define OSMPBFREADER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @class OsmPbfReader
+ * @brief Parcours d'un extrait PBF, un élément à la fois.
+ * @details Les étiquettes passées aux fonctions de rappel pointent dans le bloc en cours de décodage :
+ * elles ne sont valides que pendant l'appel. Les types d'éléments sans fonction de rappel ne sont pas
+ * décodés, ce qui permet une passe rapide sur les seuls chemins puis une passe sur les seuls nœuds.
+ * Les relations sont ignorées.
+ */
+class OsmPbfReader {
+public:
+    static constexpr int MaxBlobHeaderBytes = 64 * 1024;       ///< Limite du format.
+    static constexpr int MaxBlobBytes = 32 * 1024 * 1024;      ///< Limite du format (données décompressées).
+
+    using Tag = std::pair<std::string_view, std::string_view>; ///< (clé, valeur) en UTF-8.
+    using Tags = std::vector<Tag>;
+
+    /**
+     * @brief Nœud : identifiant, position (degrés), étiquettes.
+     */
+    using NodeHandler = std::function<void(qint64 id, double lat, double lon, const Tags& tags)>;
+
+    /**
+     * @brief Chemin : identifiant, identifiants des nœuds dans l'ordre, étiquettes.
+     */
+    using WayHandler = std::function<void(qint64 id, const std::vector<qint64>& refs, const Tags& tags)>;
+
+    void setNodeHandler(NodeHandler handler) { m_nodeHandler = std::move(handler); }
+    void setWayHandler(WayHandler handler) { m_wayHandler = std::move(handler); }
+
+    /**
+     * @brief Lit tout le fichier et appelle les fonctions de rappel dans l'ordre du fichier.
+     * @return false si le fichier est illisible, tronqué, compressé autrement qu'en zlib ou s'il exige
+     *         une fonctionnalité non prise en charge (errorString() précise la cause).
+     */
+    bool read(const QString& path);
+
+    QString errorString() const { return m_error; } ///< Cause du dernier échec de read().
+    qint64 blockCount() const { return m_blocks; }  ///< Blocs de données décodés par le dernier read().
+
+private:
+    bool readHeaderBlock(const char* data, qsizetype size);
+    bool readPrimitiveBlock(const char* data, qsizetype size);
+    bool fail(const QString& error);
+
+    NodeHandler m_nodeHandler;
+    WayHandler m_wayHandler;
+    QString m_error;
+    qint64 m_blocks = 0;
+
+    // Tampons réutilisés d'un élément à l'autre.
+    Tags m_tags;
+    std::vector<qint64> m_refs;
+};
+
+#endif // OSMPBFREADER_H
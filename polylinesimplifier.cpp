@@ -0,0 +1,81 @@
+/**
+ * @file polylinesimplifier.cpp
+ * @brief Implémentation de la simplification Douglas-Peucker hiérarchique.
+ */
+
+#include "polylinesimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+double segmentDistance(const double* xy, int point, int a, int b)
+{
+    const double px = xy[2 * point];
+    const double py = xy[2 * point + 1];
+    const double ax = xy[2 * a];
+    const double ay = xy[2 * a + 1];
+    const double dx = xy[2 * b] - ax;
+    const double dy = xy[2 * b + 1] - ay;
+    const double lengthSq = dx * dx + dy * dy;
+    double t = lengthSq > 0.0 ? ((px - ax) * dx + (py - ay) * dy) / lengthSq : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    return std::hypot(px - ax - t * dx, py - ay - t * dy);
+}
+
+struct Range {
+    int first;
+    int last;
+    double parent; ///< Importance du sommet qui a créé cet intervalle.
+};
+}
+
+std::vector<double> PolylineSimplifier::importance(const double* xy, int count, const std::vector<int>& forced)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> result(std::size_t(std::max(count, 0)), 0.0);
+    if (count <= 0) return result;
+    result.front() = infinity;
+    result.back() = infinity;
+    for (int index : forced) {
+        if (index >= 0 && index < count) result[std::size_t(index)] = infinity;
+    }
+
+    // Pile explicite : pas de récursion profonde sur un trajet de plusieurs dizaines de milliers de sommets.
+    std::vector<Range> stack;
+    int previous = 0;
+    for (int i = 1; i < count; ++i) {
+        if (result[std::size_t(i)] == infinity) {
+            if (i - previous > 1) stack.push_back({previous, i, infinity});
+            previous = i;
+        }
+    }
+
+    while (!stack.empty()) {
+        const Range range = stack.back();
+        stack.pop_back();
+        int farthest = -1;
+        double distance = -1.0;
+        for (int i = range.first + 1; i < range.last; ++i) {
+            const double d = segmentDistance(xy, i, range.first, range.last);
+            if (d > distance) {
+                distance = d;
+                farthest = i;
+            }
+        }
+        const double value = std::min(distance, range.parent);
+        result[std::size_t(farthest)] = value;
+        if (farthest - range.first > 1) stack.push_back({range.first, farthest, value});
+        if (range.last - farthest > 1) stack.push_back({farthest, range.last, value});
+    }
+    return result;
+}
+
+std::vector<int> PolylineSimplifier::select(const std::vector<double>& importance, double tolerance)
+{
+    std::vector<int> kept;
+    for (std::size_t i = 0; i < importance.size(); ++i) {
+        if (importance[i] > tolerance) kept.push_back(int(i));
+    }
+    return kept;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file polylinesimplifier.h
+ * @brief Rôle architectural : Simplification multi-résolution d'une polyligne (Douglas-Peucker).
+ * @details Responsabilités : Calculer une seule fois, pour chaque sommet, la tolérance jusqu'à laquelle
+ * il reste nécessaire, puis extraire en O(n) la polyligne simplifiée de n'importe quelle tolérance
+ * (une par plage de zoom pour RoutePolylineItem).
+ * Dépendances principales : aucune.
+ */
+
+#ifndef POLYLINESIMPLIFIER_H
+#define POLYLINESIMPLIFIER_H
+
+#include <vector>
+
+/**
+ * @class PolylineSimplifier
+ * @brief Douglas-Peucker hiérarchique : importance d'un sommet = écart qui l'a fait retenir, bornée par
+ *        celle du sommet qui a découpé son intervalle.
+ * @details Avec cette borne, les sommets d'importance strictement supérieure à une tolérance t sont
+ * exactement ceux que retiendrait un Douglas-Peucker de tolérance t. Les extrémités et les sommets
+ * imposés (changement de couleur du trafic, par exemple) ont une importance infinie.
+ */
+class PolylineSimplifier {
+public:
+    /**
+     * @brief Importance de chaque sommet.
+     * @param xy Sommets entrelacés (x0, y0, x1, y1...) dans un repère plan.
+     * @param count Nombre de sommets.
+     * @param forced Sommets à conserver quelle que soit la tolérance (indices croissants ou non).
+     */
+    static std::vector<double> importance(const double* xy, int count, const std::vector<int>& forced = {});
+
+    /**
+     * @brief Indices des sommets retenus pour une tolérance (croissants, extrémités comprises).
+     */
+    static std::vector<int> select(const std::vector<double>& importance, double tolerance);
+};
+
+#endif // POLYLINESIMPLIFIER_H
@@ -0,0 +1,704 @@
+/**
+ * @file roadgraph.cpp
+ * @brief Implémentation de la lecture du graphe routier et de la recherche par hiérarchie de contraction.
+ */
+
+#include "roadgraph.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+
+const char RoadGraph::Magic[8] = {'I', 'G', 'P', 'S', 'R', 'O', 'A', 'D'};
+
+namespace {
+constexpr double MetersPerDegree = 111320.0;
+constexpr quint32 Infinity = std::numeric_limits<quint32>::max();
+
+// Repli des lettres U+00C0 à U+017F (Latin-1 et Latin étendu A) : deux caractères par lettre,
+// '_' pour aucun, ' ' pour un séparateur (× et ÷).
+constexpr char FoldTable[] =
+    "a_a_a_a_a_a_aec_e_e_e_e_i_i_i_i_"
+    "d_n_o_o_o_o_o_ _o_u_u_u_u_y_thss"
+    "a_a_a_a_a_a_aec_e_e_e_e_i_i_i_i_"
+    "d_n_o_o_o_o_o_ _o_u_u_u_u_y_thy_"
+    "a_a_a_a_a_a_c_c_c_c_c_c_c_c_d_d_"
+    "d_d_e_e_e_e_e_e_e_e_e_e_g_g_g_g_"
+    "g_g_g_g_h_h_h_h_i_i_i_i_i_i_i_i_"
+    "i_i_ijijj_j_k_k_k_l_l_l_l_l_l_l_"
+    "l_l_l_n_n_n_n_n_n_n_n_n_o_o_o_o_"
+    "o_o_oeoer_r_r_r_r_r_s_s_s_s_s_s_"
+    "s_s_t_t_t_t_t_t_u_u_u_u_u_u_u_u_"
+    "u_u_u_u_w_w_y_y_y_z_z_z_z_z_z_s_";
+static_assert(sizeof(FoldTable) == 2 * (0x180 - 0xC0) + 1, "FoldTable : deux caractères par lettre");
+
+// Lecture d'un mot de WordData à @p offset ; @p word contient le mot précédent du bloc.
+bool readWord(const uchar* data, quint64 size, quint64& offset, std::string& word, quint32& postings)
+{
+    if (offset + 2 > size) return false;
+    const quint32 shared = data[offset];
+    const quint32 suffix = data[offset + 1];
+    offset += 2;
+    if (shared > word.size() || offset + suffix > size) return false;
+    word.resize(shared);
+    word.append(reinterpret_cast<const char*>(data + offset), suffix);
+    offset += suffix;
+    postings = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= size) return false;
+        const uchar byte = data[offset++];
+        postings |= quint32(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+}
+
+RoadGraph::~RoadGraph()
+{
+    close();
+}
+
+bool RoadGraph::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(Header))) {
+        m_file.close();
+        return false;
+    }
+    uchar* mapped = m_file.map(0, size);
+    if (!mapped) {
+        m_file.close();
+        return false;
+    }
+    // map() renvoie une adresse alignée sur une page, les sections sur 8 octets : les tableaux
+    // sont lus en place.
+    m_data = mapped;
+    m_size = quint64(size);
+
+    Header header;
+    std::memcpy(&header, m_data, sizeof(header));
+    const quint64 tableEnd = sizeof(Header) + quint64(header.sectionCount) * sizeof(SectionEntry);
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version || tableEnd > m_size) {
+        close();
+        return false;
+    }
+
+    quint64 count = 0;
+    m_coordinates = static_cast<const Coordinate*>(section(NodeCoordinates, sizeof(Coordinate), count));
+    m_nodeCount = quint32(count);
+    quint64 ranks = 0;
+    quint64 forwardOffsets = 0;
+    quint64 forwardEdges = 0;
+    quint64 backwardOffsets = 0;
+    quint64 backwardEdges = 0;
+    quint64 grids = 0;
+    quint64 cells = 0;
+    quint64 gridNodes = 0;
+    m_ranks = static_cast<const quint32*>(section(NodeRanks, sizeof(quint32), ranks));
+    m_forwardOffsets = static_cast<const quint32*>(section(ForwardOffsets, sizeof(quint32), forwardOffsets));
+    m_forwardEdges = static_cast<const Edge*>(section(ForwardEdges, sizeof(Edge), forwardEdges));
+    m_backwardOffsets = static_cast<const quint32*>(section(BackwardOffsets, sizeof(quint32), backwardOffsets));
+    m_backwardEdges = static_cast<const Edge*>(section(BackwardEdges, sizeof(Edge), backwardEdges));
+    const Grid* grid = static_cast<const Grid*>(section(GridInfo, sizeof(Grid), grids));
+    if (grid && grids == 1) m_grid = *grid;
+    m_gridCells = static_cast<const quint32*>(section(GridCells, sizeof(quint32), cells));
+    m_gridNodes = static_cast<const quint32*>(section(GridNodes, sizeof(quint32), gridNodes));
+
+    // Cohérence des tailles uniquement (temps constant) : aucune section n'est parcourue à l'ouverture.
+    const bool valid = m_coordinates && m_nodeCount > 0 && count < NoNode
+        && m_ranks && ranks == count
+        && m_forwardOffsets && forwardOffsets == count + 1 && m_forwardOffsets[count] == forwardEdges
+        && m_backwardOffsets && backwardOffsets == count + 1 && m_backwardOffsets[count] == backwardEdges
+        && (forwardEdges == 0 || m_forwardEdges) && (backwardEdges == 0 || m_backwardEdges)
+        && grids == 1 && m_grid.cellSize > 0 && m_gridCells
+        && cells == quint64(m_grid.rows) * m_grid.cols + 1 && m_gridCells[cells - 1] == gridNodes
+        && (gridNodes == 0 || m_gridNodes);
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    // Sections facultatives : absentes, elles désactivent seulement la fonction correspondante ;
+    // présentes mais de mauvaise taille, elles rendent le fichier invalide.
+    quint64 forwardSpeeds = 0;
+    quint64 backwardSpeeds = 0;
+    m_forwardSpeedLimits = static_cast<const quint8*>(section(ForwardSpeedLimits, 1, forwardSpeeds));
+    m_backwardSpeedLimits = static_cast<const quint8*>(section(BackwardSpeedLimits, 1, backwardSpeeds));
+    quint64 places = 0;
+    m_places = static_cast<const Place*>(section(PlaceEntries, sizeof(Place), places));
+    m_placeNames = static_cast<const char*>(section(PlaceNames, 1, m_placeNamesSize));
+    const bool speedsValid = (!m_forwardSpeedLimits && !m_backwardSpeedLimits)
+        || (m_forwardSpeedLimits && m_backwardSpeedLimits && forwardSpeeds == forwardEdges && backwardSpeeds == backwardEdges);
+    const bool placesValid = !m_places || (m_placeNames && places < NoNode);
+    quint64 wordBlocks = 0;
+    quint64 wordPostings = 0;
+    m_wordBlocks = static_cast<const WordBlock*>(section(WordBlocks, sizeof(WordBlock), wordBlocks));
+    m_wordData = static_cast<const uchar*>(section(WordData, 1, m_wordDataSize));
+    m_wordPostings = static_cast<const quint32*>(section(WordPostings, sizeof(quint32), wordPostings));
+    // Seule la sentinelle est vérifiée ici ; les blocs sont bornés à la lecture.
+    const bool wordsValid = !m_wordBlocks
+        || (m_places && wordBlocks >= 1 && wordBlocks < NoNode && wordPostings < NoNode
+            && (m_wordDataSize == 0 || m_wordData) && (wordPostings == 0 || m_wordPostings)
+            && m_wordBlocks[wordBlocks - 1].dataOffset == m_wordDataSize
+            && m_wordBlocks[wordBlocks - 1].firstPosting == wordPostings);
+    if (!speedsValid || !placesValid || !wordsValid) {
+        close();
+        return false;
+    }
+    m_placeCount = m_places ? quint32(places) : 0;
+    m_wordBlockCount = m_wordBlocks ? quint32(wordBlocks - 1) : 0;
+    m_wordPostingCount = quint32(wordPostings);
+    return true;
+}
+
+void RoadGraph::close()
+{
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    m_nodeCount = 0;
+    m_coordinates = nullptr;
+    m_ranks = nullptr;
+    m_forwardOffsets = nullptr;
+    m_forwardEdges = nullptr;
+    m_backwardOffsets = nullptr;
+    m_backwardEdges = nullptr;
+    m_grid = {};
+    m_gridCells = nullptr;
+    m_gridNodes = nullptr;
+    m_forwardSpeedLimits = nullptr;
+    m_backwardSpeedLimits = nullptr;
+    m_places = nullptr;
+    m_placeCount = 0;
+    m_placeNames = nullptr;
+    m_placeNamesSize = 0;
+    m_wordBlocks = nullptr;
+    m_wordBlockCount = 0;
+    m_wordData = nullptr;
+    m_wordDataSize = 0;
+    m_wordPostings = nullptr;
+    m_wordPostingCount = 0;
+    m_longestEdgeM = -1.0;
+    for (int side = 0; side < 2; ++side) {
+        m_distance[side].clear();
+        m_parentEdge[side].clear();
+        m_parentNode[side].clear();
+        m_stamp[side].clear();
+    }
+    m_generation = 0;
+    m_settled = 0;
+    m_file.close();
+}
+
+const void* RoadGraph::section(Section id, quint64 elementSize, quint64& count) const
+{
+    count = 0;
+    Header header;
+    std::memcpy(&header, m_data, sizeof(header));
+    for (quint32 i = 0; i < header.sectionCount; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, m_data + sizeof(Header) + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.id != id) continue;
+        if (entry.offset % 8 != 0 || entry.offset > m_size || entry.size > m_size - entry.offset
+            || entry.size % elementSize != 0) {
+            return nullptr;
+        }
+        count = entry.size / elementSize;
+        return m_data + entry.offset;
+    }
+    return nullptr;
+}
+
+int RoadGraph::edgeCount() const
+{
+    if (!isOpen()) return 0;
+    return int(m_forwardOffsets[m_nodeCount] + m_backwardOffsets[m_nodeCount]);
+}
+
+QGeoCoordinate RoadGraph::coordinate(quint32 node) const
+{
+    if (node >= m_nodeCount) return QGeoCoordinate();
+    return QGeoCoordinate(m_coordinates[node].lat / CoordinateScale, m_coordinates[node].lon / CoordinateScale);
+}
+
+quint32 RoadGraph::nearestNode(double lat, double lon, double maxDistanceM) const
+{
+    if (!isOpen() || m_grid.rows == 0 || m_grid.cols == 0) return NoNode;
+
+    const double cellDeg = m_grid.cellSize / CoordinateScale;
+    const double cosLat = std::max(std::cos(qDegreesToRadians(lat)), 0.01);
+    const double cellM = cellDeg * MetersPerDegree * cosLat; // Côté le plus court (est-ouest).
+    const int row = int(std::floor((lat - m_grid.minLat / CoordinateScale) / cellDeg));
+    const int col = int(std::floor((lon - m_grid.minLon / CoordinateScale) / cellDeg));
+    const int rows = int(m_grid.rows);
+    const int cols = int(m_grid.cols);
+
+    quint32 best = NoNode;
+    double bestM = maxDistanceM;
+    auto visitCell = [&](int r, int c) {
+        if (r < 0 || r >= rows || c < 0 || c >= cols) return;
+        const quint32 cell = quint32(r) * m_grid.cols + quint32(c);
+        for (quint32 i = m_gridCells[cell]; i < m_gridCells[cell + 1]; ++i) {
+            const quint32 node = m_gridNodes[i];
+            const double dy = (m_coordinates[node].lat / CoordinateScale - lat) * MetersPerDegree;
+            const double dx = (m_coordinates[node].lon / CoordinateScale - lon) * MetersPerDegree * cosLat;
+            const double d = std::hypot(dx, dy);
+            if (d <= bestM) {
+                bestM = d;
+                best = node;
+            }
+        }
+    };
+
+    // Anneaux de cellules autour du point : les cellules de l'anneau r + 1 sont à plus de r côtés de
+    // cellule, on s'arrête dès que le meilleur nœud est plus proche.
+    for (int ring = 0;; ++ring) {
+        if (ring == 0) {
+            visitCell(row, col);
+        } else {
+            for (int c = col - ring; c <= col + ring; ++c) {
+                visitCell(row - ring, c);
+                visitCell(row + ring, c);
+            }
+            for (int r = row - ring + 1; r <= row + ring - 1; ++r) {
+                visitCell(r, col - ring);
+                visitCell(r, col + ring);
+            }
+        }
+        const double reachedM = ring * cellM;
+        if (reachedM >= bestM) break;
+        const bool outside = row - ring < 0 && row + ring >= rows && col - ring < 0 && col + ring >= cols;
+        if (outside) break;
+    }
+    return best;
+}
+
+bool RoadGraph::nearestEdge(double lat, double lon, EdgeSnap& out, double headingDeg, double maxDistanceM) const
+{
+    out = EdgeSnap();
+    if (!isOpen() || m_grid.rows == 0 || m_grid.cols == 0) return false;
+
+    const double cellDeg = m_grid.cellSize / CoordinateScale;
+    const double cosLat = std::max(std::cos(qDegreesToRadians(lat)), 0.01);
+    const double cellM = cellDeg * MetersPerDegree * cosLat; // Côté le plus court (est-ouest).
+    const int row = int(std::floor((lat - m_grid.minLat / CoordinateScale) / cellDeg));
+    const int col = int(std::floor((lon - m_grid.minLon / CoordinateScale) / cellDeg));
+    const int rows = int(m_grid.rows);
+    const int cols = int(m_grid.cols);
+    const double reachM = std::min(longestEdgeM(), MaxSnapEdgeM);
+
+    // Plan local centré sur la position (m) : x vers l'est, y vers le nord.
+    auto localX = [&](quint32 node) { return (m_coordinates[node].lon / CoordinateScale - lon) * MetersPerDegree * cosLat; };
+    auto localY = [&](quint32 node) { return (m_coordinates[node].lat / CoordinateScale - lat) * MetersPerDegree; };
+
+    double bestM = maxDistanceM;
+    auto visitEdge = [&](quint32 from, quint32 to, const Edge* edge) {
+        const double ax = localX(from);
+        const double ay = localY(from);
+        const double dx = localX(to) - ax;
+        const double dy = localY(to) - ay;
+        const double lengthSq = dx * dx + dy * dy;
+        if (headingDeg >= 0.0 && lengthSq > 0.0) {
+            const double bearing = qRadiansToDegrees(std::atan2(dx, dy));
+            if (std::abs(std::remainder(bearing - headingDeg, 360.0)) > MaxHeadingDifferenceDeg) return;
+        }
+        const double t = lengthSq > 0.0 ? std::clamp(-(ax * dx + ay * dy) / lengthSq, 0.0, 1.0) : 0.0;
+        const double px = ax + t * dx;
+        const double py = ay + t * dy;
+        const double d = std::hypot(px, py);
+        if (d > bestM || (d == bestM && out.from != NoNode)) return;
+        bestM = d;
+        out.from = from;
+        out.to = to;
+        out.fraction = t;
+        out.distanceM = d;
+        out.durationSec = edge->weight / 1000.0;
+        out.speedLimitKmh = speedLimit(edge);
+        out.position = QGeoCoordinate(lat + py / MetersPerDegree, lon + px / (MetersPerDegree * cosLat));
+    };
+    auto visitCell = [&](int r, int c) {
+        if (r < 0 || r >= rows || c < 0 || c >= cols) return;
+        const quint32 cell = quint32(r) * m_grid.cols + quint32(c);
+        for (quint32 i = m_gridCells[cell]; i < m_gridCells[cell + 1]; ++i) {
+            const quint32 node = m_gridNodes[i];
+            // Arcs originaux rangés chez ce nœud : node -> cible (ascendants), cible -> node (descendants).
+            for (quint32 e = m_forwardOffsets[node]; e < m_forwardOffsets[node + 1]; ++e) {
+                if (m_forwardEdges[e].middle == NoNode) visitEdge(node, m_forwardEdges[e].target, &m_forwardEdges[e]);
+            }
+            for (quint32 e = m_backwardOffsets[node]; e < m_backwardOffsets[node + 1]; ++e) {
+                if (m_backwardEdges[e].middle == NoNode) visitEdge(m_backwardEdges[e].target, node, &m_backwardEdges[e]);
+            }
+        }
+    };
+
+    // Comme nearestNode(), en élargissant d'une longueur d'arc : l'extrémité qui porte l'arc peut être
+    // plus loin que le point de l'arc le plus proche.
+    for (int ring = 0;; ++ring) {
+        if (ring == 0) {
+            visitCell(row, col);
+        } else {
+            for (int c = col - ring; c <= col + ring; ++c) {
+                visitCell(row - ring, c);
+                visitCell(row + ring, c);
+            }
+            for (int r = row - ring + 1; r <= row + ring - 1; ++r) {
+                visitCell(r, col - ring);
+                visitCell(r, col + ring);
+            }
+        }
+        const double reachedM = ring * cellM;
+        if (reachedM >= bestM + reachM) break;
+        const bool outside = row - ring < 0 && row + ring >= rows && col - ring < 0 && col + ring >= cols;
+        if (outside) break;
+    }
+    return out.from != NoNode;
+}
+
+bool RoadGraph::reverseEdge(const EdgeSnap& snap, EdgeSnap& out) const
+{
+    if (!isOpen() || snap.from >= m_nodeCount || snap.to >= m_nodeCount) return false;
+    const Edge* edge = originalEdge(snap.to, snap.from);
+    if (!edge) return false;
+    out = snap;
+    out.from = snap.to;
+    out.to = snap.from;
+    out.fraction = 1.0 - snap.fraction;
+    out.durationSec = edge->weight / 1000.0;
+    out.speedLimitKmh = speedLimit(edge);
+    return true;
+}
+
+double RoadGraph::longestEdgeM() const
+{
+    if (m_longestEdgeM >= 0.0) return m_longestEdgeM;
+    // Un seul parcours des arcs, au premier recalage (pas à l'ouverture, qui ne lit rien).
+    double longest = 0.0;
+    for (quint32 node = 0; node < m_nodeCount; ++node) {
+        const QGeoCoordinate origin = coordinate(node);
+        for (quint32 e = m_forwardOffsets[node]; e < m_forwardOffsets[node + 1]; ++e) {
+            if (m_forwardEdges[e].middle == NoNode) longest = std::max(longest, origin.distanceTo(coordinate(m_forwardEdges[e].target)));
+        }
+        for (quint32 e = m_backwardOffsets[node]; e < m_backwardOffsets[node + 1]; ++e) {
+            if (m_backwardEdges[e].middle == NoNode) longest = std::max(longest, origin.distanceTo(coordinate(m_backwardEdges[e].target)));
+        }
+    }
+    m_longestEdgeM = longest;
+    return longest;
+}
+
+bool RoadGraph::shortestPath(quint32 source, quint32 target, Path& out)
+{
+    out = Path();
+    m_settled = 0;
+    if (!isOpen() || source >= m_nodeCount || target >= m_nodeCount) return false;
+    if (source == target) {
+        out.nodes.append(source);
+        return true;
+    }
+
+    if (m_stamp[0].size() != m_nodeCount) {
+        for (int side = 0; side < 2; ++side) {
+            m_distance[side].assign(m_nodeCount, Infinity);
+            m_parentEdge[side].assign(m_nodeCount, NoNode);
+            m_parentNode[side].assign(m_nodeCount, NoNode);
+            m_stamp[side].assign(m_nodeCount, 0);
+        }
+        m_generation = 0;
+    }
+    if (++m_generation == 0) {
+        // Estampilles épuisées (après 4 milliards de requêtes) : remise à zéro unique.
+        for (int side = 0; side < 2; ++side) std::fill(m_stamp[side].begin(), m_stamp[side].end(), 0);
+        m_generation = 1;
+    }
+
+    using Entry = std::pair<quint32, quint32>; // (distance, nœud)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queues[2];
+    const quint32 roots[2] = {source, target};
+    for (int side = 0; side < 2; ++side) {
+        m_stamp[side][roots[side]] = m_generation;
+        m_distance[side][roots[side]] = 0;
+        m_parentEdge[side][roots[side]] = NoNode;
+        m_parentNode[side][roots[side]] = NoNode;
+        queues[side].push({0, roots[side]});
+    }
+    auto distance = [this](int side, quint32 node) {
+        return m_stamp[side][node] == m_generation ? m_distance[side][node] : Infinity;
+    };
+
+    quint64 best = Infinity;
+    quint32 meeting = NoNode;
+    int side = 0;
+    while (!queues[0].empty() || !queues[1].empty()) {
+        // Arrêt : aucun sens ne peut plus améliorer la meilleure jonction.
+        const quint32 top0 = queues[0].empty() ? Infinity : queues[0].top().first;
+        const quint32 top1 = queues[1].empty() ? Infinity : queues[1].top().first;
+        if (top0 >= best && top1 >= best) break;
+        if (queues[side].empty() || (side == 0 ? top0 : top1) >= best) side = 1 - side;
+
+        const Entry entry = queues[side].top();
+        queues[side].pop();
+        const quint32 node = entry.second;
+        if (entry.first != distance(side, node)) continue; // Entrée périmée.
+        ++m_settled;
+
+        const quint32 other = distance(1 - side, node);
+        if (other != Infinity && quint64(entry.first) + other < best) {
+            best = quint64(entry.first) + other;
+            meeting = node;
+        }
+
+        const quint32* offsets = side == 0 ? m_forwardOffsets : m_backwardOffsets;
+        const Edge* edges = side == 0 ? m_forwardEdges : m_backwardEdges;
+        for (quint32 i = offsets[node]; i < offsets[node + 1]; ++i) {
+            const quint64 candidate = quint64(entry.first) + edges[i].weight;
+            const quint32 next = edges[i].target;
+            if (candidate >= distance(side, next)) continue;
+            m_stamp[side][next] = m_generation;
+            m_distance[side][next] = quint32(candidate);
+            m_parentEdge[side][next] = i;
+            m_parentNode[side][next] = node;
+            queues[side].push({quint32(candidate), next});
+        }
+        side = 1 - side;
+    }
+    if (meeting == NoNode) return false;
+
+    // Partie avant : de la source à la jonction, remontée par les parents puis remise dans l'ordre.
+    std::vector<std::pair<quint32, quint32>> forward; // (origine, index dans ForwardEdges)
+    for (quint32 node = meeting; m_parentNode[0][node] != NoNode; node = m_parentNode[0][node]) {
+        forward.push_back({m_parentNode[0][node], m_parentEdge[0][node]});
+    }
+    out.nodes.append(source);
+    for (auto it = forward.rbegin(); it != forward.rend(); ++it) {
+        const Edge& edge = m_forwardEdges[it->second];
+        unpack(it->first, edge.target, edge, out);
+    }
+    // Partie arrière : de la jonction à l'arrivée, déjà dans l'ordre du trajet.
+    for (quint32 node = meeting; m_parentNode[1][node] != NoNode; node = m_parentNode[1][node]) {
+        unpack(node, m_parentNode[1][node], m_backwardEdges[m_parentEdge[1][node]], out);
+    }
+    return true;
+}
+
+const RoadGraph::Edge* RoadGraph::findEdge(quint32 from, quint32 to) const
+{
+    // Arc de poids minimal from -> to, rangé chez l'extrémité de rang inférieur.
+    const Edge* best = nullptr;
+    if (m_ranks[to] > m_ranks[from]) {
+        for (quint32 i = m_forwardOffsets[from]; i < m_forwardOffsets[from + 1]; ++i) {
+            if (m_forwardEdges[i].target == to && (!best || m_forwardEdges[i].weight < best->weight)) best = &m_forwardEdges[i];
+        }
+    } else {
+        for (quint32 i = m_backwardOffsets[to]; i < m_backwardOffsets[to + 1]; ++i) {
+            if (m_backwardEdges[i].target == from && (!best || m_backwardEdges[i].weight < best->weight)) best = &m_backwardEdges[i];
+        }
+    }
+    return best;
+}
+
+const RoadGraph::Edge* RoadGraph::originalEdge(quint32 from, quint32 to) const
+{
+    // Comme findEdge(), limité aux arcs originaux (un raccourci n'est pas une voie).
+    if (m_ranks[to] > m_ranks[from]) {
+        for (quint32 i = m_forwardOffsets[from]; i < m_forwardOffsets[from + 1]; ++i) {
+            if (m_forwardEdges[i].target == to && m_forwardEdges[i].middle == NoNode) return &m_forwardEdges[i];
+        }
+    } else {
+        for (quint32 i = m_backwardOffsets[to]; i < m_backwardOffsets[to + 1]; ++i) {
+            if (m_backwardEdges[i].target == from && m_backwardEdges[i].middle == NoNode) return &m_backwardEdges[i];
+        }
+    }
+    return nullptr;
+}
+
+void RoadGraph::unpack(quint32 from, quint32 to, const Edge& edge, Path& out) const
+{
+    // Pile explicite : (origine, extrémité, arc) ; la moitié arrière est empilée en premier.
+    struct Pending {
+        quint32 from;
+        quint32 to;
+        const Edge* edge;
+    };
+    std::vector<Pending> stack{{from, to, &edge}};
+    while (!stack.empty()) {
+        const Pending current = stack.back();
+        stack.pop_back();
+        const quint32 middle = current.edge->middle;
+        if (middle == NoNode) {
+            const double seconds = current.edge->weight / 1000.0;
+            out.nodes.append(current.to);
+            out.segmentDurationsSec.append(seconds);
+            out.segmentSpeedLimitsKmh.append(speedLimit(current.edge));
+            out.durationSec += seconds;
+            continue;
+        }
+        const Edge* first = findEdge(current.from, middle);
+        const Edge* second = findEdge(middle, current.to);
+        if (!first || !second) continue; // Fichier incohérent : le raccourci n'est pas déplié.
+        stack.push_back({middle, current.to, second});
+        stack.push_back({current.from, middle, first});
+    }
+}
+
+int RoadGraph::speedLimit(const Edge* edge) const
+{
+    if (!m_forwardSpeedLimits) return -1;
+    const quint32 forwardCount = m_forwardOffsets[m_nodeCount];
+    int kmh = 0;
+    if (edge >= m_forwardEdges && edge < m_forwardEdges + forwardCount) {
+        kmh = m_forwardSpeedLimits[edge - m_forwardEdges];
+    } else {
+        kmh = m_backwardSpeedLimits[edge - m_backwardEdges];
+    }
+    return kmh > 0 ? kmh : -1;
+}
+
+std::string_view RoadGraph::placeBytes(int index) const
+{
+    const Place& entry = m_places[index];
+    // Bornes vérifiées à la lecture plutôt qu'à l'ouverture : l'index n'est pas parcouru au chargement.
+    if (entry.nameOffset > m_placeNamesSize || entry.nameLength > m_placeNamesSize - entry.nameOffset) return {};
+    return std::string_view(m_placeNames + entry.nameOffset, entry.nameLength);
+}
+
+QString RoadGraph::placeName(int index) const
+{
+    if (index < 0 || index >= placeCount()) return QString();
+    const std::string_view name = placeBytes(index);
+    return QString::fromUtf8(name.data(), qsizetype(name.size()));
+}
+
+QGeoCoordinate RoadGraph::placeCoordinate(int index) const
+{
+    if (index < 0 || index >= placeCount()) return QGeoCoordinate();
+    const Coordinate& position = m_places[index].position;
+    return QGeoCoordinate(position.lat / CoordinateScale, position.lon / CoordinateScale);
+}
+
+int RoadGraph::lowerBoundPlace(const QByteArray& name) const
+{
+    const std::string_view key(name.constData(), std::size_t(name.size()));
+    int low = 0;
+    int high = placeCount();
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (placeBytes(mid) < key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+QByteArray RoadGraph::foldName(std::string_view utf8)
+{
+    QByteArray out;
+    foldName(utf8, out);
+    return out;
+}
+
+void RoadGraph::foldName(std::string_view utf8, QByteArray& out)
+{
+    // Le résultat n'est jamais plus long que l'entrée : chaque séquence UTF-8 donne au plus autant
+    // d'octets qu'elle en occupe, et un séparateur remplace au moins un octet.
+    out.resize(qsizetype(utf8.size()));
+    char* const begin = out.data();
+    char* write = begin;
+    bool separator = false; // Séparateur en attente, écrit avant le prochain caractère conservé.
+    auto put = [begin, &write, &separator](const char* bytes, std::size_t count) {
+        if (separator && write != begin) *write++ = ' ';
+        separator = false;
+        for (std::size_t k = 0; k < count; ++k) *write++ = bytes[k];
+    };
+    std::size_t i = 0;
+    while (i < utf8.size()) {
+        const uchar lead = uchar(utf8[i]);
+        if (lead < 0x80) {
+            const char c = char(lead >= 'A' && lead <= 'Z' ? lead + ('a' - 'A') : lead);
+            if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) put(&c, 1);
+            else separator = true;
+            ++i;
+            continue;
+        }
+        const std::size_t length = (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 0;
+        bool valid = length > 0 && i + length <= utf8.size();
+        char32_t codePoint = valid ? char32_t(lead & (0x7F >> length)) : 0;
+        for (std::size_t k = 1; valid && k < length; ++k) {
+            const uchar next = uchar(utf8[i + k]);
+            valid = (next & 0xC0) == 0x80;
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        if (!valid) {
+            separator = true;
+            ++i;
+            continue;
+        }
+        if (codePoint >= 0xC0 && codePoint < 0x180) {
+            const char* folded = FoldTable + 2 * (codePoint - 0xC0);
+            if (folded[0] == ' ') separator = true;
+            else put(folded, folded[1] == '_' ? 1 : 2);
+        } else if (codePoint < 0xC0 || (codePoint >= 0x2000 && codePoint < 0x2070) || codePoint == 0x3000) {
+            separator = true; // Espaces insécables, guillemets, apostrophe typographique, tirets...
+        } else {
+            put(utf8.data() + i, length);
+        }
+        i += length;
+    }
+    out.resize(qsizetype(write - begin));
+}
+
+quint32 RoadGraph::lowerBoundWord(std::string_view key) const
+{
+    // Premier bloc dont le premier mot (complet) est >= key : la réponse est dans le bloc précédent
+    // ou au début de celui-ci.
+    quint32 low = 0;
+    quint32 high = m_wordBlockCount;
+    std::string word;
+    quint32 postings = 0;
+    while (low < high) {
+        const quint32 mid = low + (high - low) / 2;
+        quint64 offset = m_wordBlocks[mid].dataOffset;
+        word.clear();
+        if (!readWord(m_wordData, m_wordDataSize, offset, word, postings) || word >= key) high = mid;
+        else low = mid + 1;
+    }
+    if (low == 0) return m_wordBlocks[0].firstPosting;
+
+    const WordBlock& block = m_wordBlocks[low - 1];
+    const quint64 end = std::min<quint64>(m_wordBlocks[low].dataOffset, m_wordDataSize);
+    quint64 offset = block.dataOffset;
+    quint32 posting = block.firstPosting;
+    word.clear();
+    while (offset < end && readWord(m_wordData, end, offset, word, postings)) {
+        if (word >= key) return posting;
+        posting += postings;
+    }
+    return m_wordBlocks[low].firstPosting;
+}
+
+std::pair<quint32, quint32> RoadGraph::wordPrefixRange(std::string_view prefix) const
+{
+    if (!m_wordBlocks || m_wordBlockCount == 0) return {0, 0};
+    // Fin de plage : premier mot >= successeur du préfixe (dernier octet incrémenté).
+    std::string successor(prefix);
+    while (!successor.empty() && uchar(successor.back()) == 0xFF) successor.pop_back();
+    const quint32 first = std::min(lowerBoundWord(prefix), m_wordPostingCount);
+    if (successor.empty()) return {first, m_wordPostingCount};
+    successor.back() = char(uchar(successor.back()) + 1);
+    const quint32 last = std::min(lowerBoundWord(successor), m_wordPostingCount);
+    return {first, std::max(first, last)};
+}
+
+quint32 RoadGraph::wordPlace(quint32 posting) const
+{
+    if (posting >= m_wordPostingCount) return NoNode;
+    const quint32 place = m_wordPostings[posting];
+    return place < m_placeCount ? place : NoNode;
+}
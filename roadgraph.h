@@ -0,0 +1,361 @@
+/**
+ * @file roadgraph.h
+ * @brief Rôle architectural : Calcul d'itinéraire hors ligne sur un graphe routier prétraité (hiérarchie de contraction).
+ * @details Responsabilités : Projeter en mémoire (QFile::map) un fichier de graphe produit par
+ * RoadGraphBuilder, sans le recopier ni le décoder, puis répondre aux requêtes point à point par une
+ * recherche bidirectionnelle ascendante et déplier les raccourcis en sommets routiers. Le même fichier porte
+ * les limitations de vitesse des arcs et l'index des noms (rues, lieux) destiné au géocodage hors ligne.
+ * Utilisable hors de l'application (outils, tests) : ne dépend que de QtCore et QtPositioning.
+ * Dépendances principales : QFile, QGeoCoordinate.
+ */
+
+#ifndef ROADGRAPH_H
+#define ROADGRAPH_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RoadGraph
+ * @brief Vue en lecture seule d'un graphe routier contracté projeté en mémoire.
+ * @details Organisation du fichier : un en-tête (signature, version, nombre de sections), une table de
+ * sections (identifiant, position, taille) puis les sections, alignées sur 8 octets. Les champs sont
+ * stockés dans l'ordre des octets de la cible (little-endian sur Raspberry Pi et x86). Un identifiant de
+ * section inconnu est ignoré : une section ajoutée ne rend pas les anciens fichiers illisibles.
+ *
+ * Chaque nœud a un rang (ordre de contraction). Les arcs sont rangés en deux tableaux CSR ascendants :
+ * ForwardEdges[u] contient les arcs u -> v avec rang(v) > rang(u), BackwardEdges[v] les arcs u -> v avec
+ * rang(u) > rang(v) (cible = u). Un raccourci u -> v porte le nœud contourné (middle) ; ses deux moitiés
+ * sont u -> middle dans BackwardEdges[middle] et middle -> v dans ForwardEdges[middle].
+ *
+ * Sections facultatives : limitations de vitesse (un octet par arc, parallèle à ForwardEdges et
+ * BackwardEdges), lieux nommés (Place triés par nom UTF-8, noms concaténés dans PlaceNames) et index
+ * des mots de ces noms pour l'autocomplétion. Cet index est un dictionnaire trié des mots repliés
+ * (foldName()) codé par préfixe commun avec le mot précédent (front coding), par blocs de WordBlockSize
+ * mots dont le premier est complet : un trie compacté parcouru par dichotomie sur les blocs. Les lieux
+ * de mots consécutifs se suivent dans WordPostings, si bien que tous les mots commençant par un préfixe
+ * désignent une seule plage de WordPostings.
+ */
+class RoadGraph {
+public:
+    static constexpr quint32 Version = 1;            ///< Version du format.
+    static constexpr quint32 NoNode = 0xFFFFFFFFu;   ///< Nœud absent (arc original, nœud introuvable).
+    static constexpr double CoordinateScale = 1e7;   ///< Degrés -> entiers (précision ≈ 1 cm).
+    static constexpr double SnapRadiusM = 500.0;     ///< Distance maximale entre un point et son nœud (ou arc).
+    static constexpr double MaxSnapEdgeM = 1000.0;   ///< Longueur d'arc prise en compte par nearestEdge().
+    static constexpr double MaxHeadingDifferenceDeg = 90.0; ///< Écart maximal entre un arc et le cap du véhicule.
+    static constexpr int WordBlockSize = 16;         ///< Mots par bloc de WordData.
+    static constexpr int MaxWordBytes = 255;         ///< Mots plus longs non indexés.
+
+    /**
+     * @brief Identifiants des sections.
+     */
+    enum Section : quint32 {
+        NodeCoordinates = 1, ///< Coordinate par nœud.
+        NodeRanks = 2,       ///< quint32 par nœud (ordre de contraction).
+        ForwardOffsets = 3,  ///< quint32, nodeCount + 1 débuts de liste.
+        ForwardEdges = 4,    ///< Edge ascendants sortants.
+        BackwardOffsets = 5, ///< quint32, nodeCount + 1 débuts de liste.
+        BackwardEdges = 6,   ///< Edge ascendants entrants (cible = origine de l'arc).
+        GridInfo = 7,        ///< Grid : grille régulière des nœuds (recalage d'un point).
+        GridCells = 8,       ///< quint32, rows * cols + 1 débuts de cellule.
+        GridNodes = 9,       ///< quint32, nœuds triés par cellule.
+        ForwardSpeedLimits = 10,  ///< quint8 par arc de ForwardEdges (km/h, 0 : inconnue ou raccourci).
+        BackwardSpeedLimits = 11, ///< quint8 par arc de BackwardEdges.
+        PlaceEntries = 12,   ///< Place, triés par nom (ordre des octets UTF-8) puis position.
+        PlaceNames = 13,     ///< Noms UTF-8 concaténés, sans séparateur.
+        WordBlocks = 14,     ///< WordBlock, un par bloc de mots plus une sentinelle (fin des données).
+        WordData = 15,       ///< Mots : [préfixe commun u8][longueur du suffixe u8][suffixe][lieux varint].
+        WordPostings = 16    ///< quint32 : index de Place, regroupés par mot dans l'ordre des mots.
+    };
+
+    /**
+     * @brief Nature d'un lieu nommé.
+     */
+    enum class PlaceKind : quint8 {
+        Street = 1,          ///< Voie (un lieu par nom et par cellule de RoadGraphBuilder::PlaceCellDeg).
+        PointOfInterest = 2, ///< Commerce, service, site touristique.
+        Locality = 3         ///< Ville, village, quartier.
+    };
+
+    /**
+     * @struct Header
+     * @brief En-tête du fichier.
+     */
+    struct Header {
+        char magic[8];        ///< "IGPSROAD".
+        quint32 version;      ///< RoadGraph::Version.
+        quint32 sectionCount; ///< Entrées de la table de sections qui suit.
+    };
+
+    /**
+     * @struct SectionEntry
+     * @brief Entrée de la table de sections.
+     */
+    struct SectionEntry {
+        quint32 id;       ///< RoadGraph::Section.
+        quint32 reserved;
+        quint64 offset;   ///< Depuis le début du fichier, multiple de 8.
+        quint64 size;     ///< Octets.
+    };
+
+    /**
+     * @struct Coordinate
+     * @brief Position d'un nœud en degrés × CoordinateScale.
+     */
+    struct Coordinate {
+        qint32 lat;
+        qint32 lon;
+    };
+
+    /**
+     * @struct Edge
+     * @brief Arc ascendant (original ou raccourci).
+     */
+    struct Edge {
+        quint32 target; ///< Extrémité de rang supérieur.
+        quint32 weight; ///< Durée de parcours (ms).
+        quint32 middle; ///< Nœud contourné par un raccourci, NoNode pour un arc original.
+    };
+
+    /**
+     * @struct Grid
+     * @brief Grille régulière couvrant l'emprise des nœuds.
+     */
+    struct Grid {
+        qint32 minLat;   ///< Coin sud-ouest (degrés × CoordinateScale).
+        qint32 minLon;
+        qint32 cellSize; ///< Côté d'une cellule (degrés × CoordinateScale).
+        quint32 rows;
+        quint32 cols;
+        quint32 reserved;
+    };
+
+    /**
+     * @struct Place
+     * @brief Lieu nommé de l'index de géocodage.
+     */
+    struct Place {
+        quint32 nameOffset;  ///< Début du nom dans PlaceNames.
+        quint16 nameLength;  ///< Octets UTF-8.
+        quint8 kind;         ///< PlaceKind.
+        quint8 reserved;
+        Coordinate position; ///< Point représentatif.
+    };
+
+    /**
+     * @struct WordBlock
+     * @brief Début d'un bloc de mots.
+     */
+    struct WordBlock {
+        quint32 dataOffset;   ///< Premier mot du bloc dans WordData (préfixe commun nul).
+        quint32 firstPosting; ///< Premier lieu de ce mot dans WordPostings.
+    };
+
+    /**
+     * @struct EdgeSnap
+     * @brief Projection d'une position sur un arc original (orienté).
+     */
+    struct EdgeSnap {
+        quint32 from = NoNode;    ///< Origine de l'arc.
+        quint32 to = NoNode;      ///< Extrémité de l'arc.
+        double fraction = 0.0;    ///< Position du point projeté, de 0 (from) à 1 (to).
+        double distanceM = 0.0;   ///< Distance entre la position et l'arc.
+        double durationSec = 0.0; ///< Durée de parcours de tout l'arc.
+        int speedLimitKmh = -1;   ///< Limitation de l'arc (km/h), -1 si inconnue.
+        QGeoCoordinate position;  ///< Point projeté.
+    };
+
+    /**
+     * @struct Path
+     * @brief Plus court chemin déplié en nœuds routiers.
+     */
+    struct Path {
+        QList<quint32> nodes;          ///< Nœuds du départ à l'arrivée.
+        QList<double> segmentDurationsSec; ///< Durée de chaque arc (nodes[i] -> nodes[i + 1]).
+        QList<int> segmentSpeedLimitsKmh;  ///< Limitation de chaque arc (km/h), -1 si inconnue.
+        double durationSec = 0.0;      ///< Durée totale.
+    };
+
+    static const char Magic[8]; ///< Signature du fichier.
+
+    RoadGraph() = default;
+    ~RoadGraph();
+    RoadGraph(const RoadGraph&) = delete;
+    RoadGraph& operator=(const RoadGraph&) = delete;
+
+    /**
+     * @brief Projette le fichier en mémoire et valide l'en-tête et la taille des sections.
+     * @return false si le fichier est illisible, n'est pas un graphe routier, est d'une autre version
+     *         ou est incohérent (sections manquantes ou tronquées).
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Libère la projection.
+     */
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; } ///< true après un open() réussi.
+    int nodeCount() const { return int(m_nodeCount); } ///< Nœuds routiers.
+    int edgeCount() const; ///< Arcs ascendants, raccourcis compris.
+
+    /**
+     * @brief Position du nœud @p node (0 <= node < nodeCount()).
+     */
+    QGeoCoordinate coordinate(quint32 node) const;
+
+    /**
+     * @brief Nœud le plus proche d'une position, par la grille.
+     * @return NoNode si aucun nœud n'est à moins de @p maxDistanceM.
+     */
+    quint32 nearestNode(double lat, double lon, double maxDistanceM = SnapRadiusM) const;
+
+    /**
+     * @brief Arc original le plus proche d'une position, dans le sens de circulation @p headingDeg.
+     * @details Un arc est rangé chez son extrémité de rang inférieur : les anneaux de la grille sont
+     * parcourus jusqu'à la meilleure distance plus la longueur du plus long arc (au plus MaxSnapEdgeM).
+     * Une voie à sens unique n'a d'arc que dans le sens autorisé ; avec un cap (>= 0), les arcs qui s'en
+     * écartent de plus de MaxHeadingDifferenceDeg sont ignorés, dont la chaussée opposée d'une voie séparée.
+     * @return false si aucun arc n'est à moins de @p maxDistanceM.
+     */
+    bool nearestEdge(double lat, double lon, EdgeSnap& out, double headingDeg = -1.0,
+                     double maxDistanceM = SnapRadiusM) const;
+
+    /**
+     * @brief Même point sur l'arc de sens inverse de @p snap.
+     * @return false si la voie est à sens unique.
+     */
+    bool reverseEdge(const EdgeSnap& snap, EdgeSnap& out) const;
+
+    /**
+     * @brief Plus court chemin (en durée) entre deux nœuds.
+     * @details Recherche bidirectionnelle limitée aux arcs ascendants : chaque sens ne visite que les
+     * nœuds de rang croissant, soit quelques centaines de nœuds même sur une grande région. Les
+     * tableaux de travail sont alloués au premier appel puis réutilisés (ni effacement ni allocation).
+     * @return false si l'un des nœuds est invalide ou si l'arrivée est inaccessible.
+     */
+    bool shortestPath(quint32 source, quint32 target, Path& out);
+
+    /**
+     * @brief Nœuds visités par le dernier shortestPath() (diagnostic, tests).
+     */
+    int lastSettledCount() const { return m_settled; }
+
+    int placeCount() const { return int(m_placeCount); } ///< Lieux nommés (0 : pas d'index).
+
+    /**
+     * @brief Lieu @p index (0 <= index < placeCount()).
+     */
+    const Place& place(int index) const { return m_places[index]; }
+
+    /**
+     * @brief Nom du lieu @p index, lu dans la projection.
+     */
+    QString placeName(int index) const;
+
+    /**
+     * @brief Nom UTF-8 du lieu @p index, sans copie (vide si le fichier est incohérent).
+     */
+    std::string_view placeBytes(int index) const;
+
+    /**
+     * @brief Position du lieu @p index.
+     */
+    QGeoCoordinate placeCoordinate(int index) const;
+
+    /**
+     * @brief Premier lieu dont le nom (octets UTF-8) est >= @p name : les lieux commençant par un
+     *        préfixe forment la plage qui suit, sans rien parcourir d'autre.
+     * @return placeCount() si tous les noms sont inférieurs.
+     */
+    int lowerBoundPlace(const QByteArray& name) const;
+
+    /**
+     * @brief Forme de recherche d'un nom UTF-8 : minuscules, accents et ligatures du français retirés
+     *        (« Œuvre » -> « oeuvre »), mots séparés par une seule espace (ponctuation, apostrophes et
+     *        tirets sont des séparateurs). Les autres écritures sont conservées telles quelles.
+     */
+    static QByteArray foldName(std::string_view utf8);
+
+    /**
+     * @brief Variante de foldName() écrivant dans @p out, dont la capacité est réutilisée.
+     */
+    static void foldName(std::string_view utf8, QByteArray& out);
+
+    bool hasWordIndex() const { return m_wordBlocks != nullptr; } ///< true si le fichier porte l'index des mots.
+
+    /**
+     * @brief Plage [first, second) de WordPostings des mots commençant par @p prefix (forme repliée).
+     * @details Deux dichotomies sur les blocs puis au plus deux blocs décodés, quelle que soit la taille
+     * de l'index. Plage vide sans index ou sans mot correspondant.
+     */
+    std::pair<quint32, quint32> wordPrefixRange(std::string_view prefix) const;
+
+    /**
+     * @brief Lieu (index de Place) de l'entrée @p posting d'une plage de wordPrefixRange().
+     * @return NoNode si l'entrée désigne un lieu inexistant (fichier incohérent).
+     */
+    quint32 wordPlace(quint32 posting) const;
+
+private:
+    const void* section(Section id, quint64 elementSize, quint64& count) const;
+    const Edge* findEdge(quint32 from, quint32 to) const;
+    const Edge* originalEdge(quint32 from, quint32 to) const;
+    double longestEdgeM() const;
+    void unpack(quint32 from, quint32 to, const Edge& edge, Path& out) const;
+    int speedLimit(const Edge* edge) const;
+    quint32 lowerBoundWord(std::string_view key) const;
+
+    QFile m_file;                              ///< Fichier projeté.
+    const uchar* m_data = nullptr;             ///< Début de la projection.
+    quint64 m_size = 0;                        ///< Taille projetée.
+    quint32 m_nodeCount = 0;
+    const Coordinate* m_coordinates = nullptr;
+    const quint32* m_ranks = nullptr;
+    const quint32* m_forwardOffsets = nullptr;
+    const Edge* m_forwardEdges = nullptr;
+    const quint32* m_backwardOffsets = nullptr;
+    const Edge* m_backwardEdges = nullptr;
+    Grid m_grid = {};
+    const quint32* m_gridCells = nullptr;
+    const quint32* m_gridNodes = nullptr;
+    const quint8* m_forwardSpeedLimits = nullptr;  ///< nullptr : section absente.
+    const quint8* m_backwardSpeedLimits = nullptr;
+    const Place* m_places = nullptr;
+    quint32 m_placeCount = 0;
+    const char* m_placeNames = nullptr;
+    quint64 m_placeNamesSize = 0;
+    const WordBlock* m_wordBlocks = nullptr;       ///< nullptr : pas d'index des mots.
+    quint32 m_wordBlockCount = 0;                  ///< Blocs, sentinelle exclue.
+    const uchar* m_wordData = nullptr;
+    quint64 m_wordDataSize = 0;
+    const quint32* m_wordPostings = nullptr;
+    quint32 m_wordPostingCount = 0;
+    mutable double m_longestEdgeM = -1.0;          ///< Plus long arc original (m), calculé au premier recalage.
+
+    // Espace de travail de la recherche (deux sens) : une entrée n'est valide que si son estampille
+    // vaut m_generation, ce qui évite de remettre à zéro des tableaux de la taille du graphe.
+    std::vector<quint32> m_distance[2];
+    std::vector<quint32> m_parentEdge[2];      ///< Index dans ForwardEdges / BackwardEdges, NoNode à la source.
+    std::vector<quint32> m_parentNode[2];
+    std::vector<quint32> m_stamp[2];
+    quint32 m_generation = 0;
+    int m_settled = 0;
+};
+
+static_assert(sizeof(RoadGraph::Header) == 16, "RoadGraph::Header : taille figée par le format");
+static_assert(sizeof(RoadGraph::SectionEntry) == 24, "RoadGraph::SectionEntry : taille figée par le format");
+static_assert(sizeof(RoadGraph::Edge) == 12, "RoadGraph::Edge : taille figée par le format");
+static_assert(sizeof(RoadGraph::Grid) == 24, "RoadGraph::Grid : taille figée par le format");
+static_assert(sizeof(RoadGraph::Place) == 16, "RoadGraph::Place : taille figée par le format");
+static_assert(sizeof(RoadGraph::WordBlock) == 8, "RoadGraph::WordBlock : taille figée par le format");
+
+#endif // ROADGRAPH_H
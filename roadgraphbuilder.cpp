@@ -0,0 +1,372 @@
+/**
+ * @file roadgraphbuilder.cpp
+ * @brief Implémentation de la contraction du graphe routier et de l'écriture du fichier RoadGraph.
+ */
+
+#include "roadgraphbuilder.h"
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace {
+constexpr quint32 Infinity = std::numeric_limits<quint32>::max();
+
+qint32 toFixed(double degrees)
+{
+    return qint32(std::lround(degrees * RoadGraph::CoordinateScale));
+}
+}
+
+quint32 RoadGraphBuilder::addNode(double lat, double lon)
+{
+    m_coordinates.push_back({toFixed(lat), toFixed(lon)});
+    m_out.emplace_back();
+    m_in.emplace_back();
+    m_contracted = false;
+    return quint32(m_coordinates.size() - 1);
+}
+
+void RoadGraphBuilder::addEdge(quint32 from, quint32 to, double durationSec, int speedLimitKmh)
+{
+    if (from == to || from >= m_coordinates.size() || to >= m_coordinates.size()) return;
+    const double ms = std::clamp(std::round(durationSec * 1000.0), 0.0, double(Infinity / 4));
+    const quint32 weight = quint32(ms);
+    const quint8 limit = quint8(std::clamp(speedLimitKmh, 0, 255));
+    insertArc(m_out[from], {to, weight, RoadGraph::NoNode, limit});
+    insertArc(m_in[to], {from, weight, RoadGraph::NoNode, limit});
+    m_contracted = false;
+}
+
+void RoadGraphBuilder::addPlace(const QByteArray& name, double lat, double lon, RoadGraph::PlaceKind kind)
+{
+    if (name.isEmpty()) return;
+    const QByteArray stored = name.left(0xFFFF);
+    const qint32 row = qint32(std::floor(lat / PlaceCellDeg));
+    const qint32 col = qint32(std::floor(lon / PlaceCellDeg));
+    if (!m_placeKeys.insert({stored, quint8(kind), row, col}).second) return;
+    m_places.push_back({stored, {toFixed(lat), toFixed(lon)}, kind});
+}
+
+void RoadGraphBuilder::insertArc(std::vector<Arc>& arcs, const Arc& arc)
+{
+    for (Arc& existing : arcs) {
+        if (existing.node != arc.node) continue;
+        if (arc.weight < existing.weight) existing = arc;
+        return;
+    }
+    arcs.push_back(arc);
+}
+
+void RoadGraphBuilder::witnessSearch(quint32 from, quint32 skipped, quint32 limit)
+{
+    if (++m_witnessGeneration == 0) {
+        std::fill(m_witnessStamp.begin(), m_witnessStamp.end(), 0);
+        m_witnessGeneration = 1;
+    }
+    using Entry = std::pair<quint32, quint32>; // (distance, nœud)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    m_witnessStamp[from] = m_witnessGeneration;
+    m_witnessDistance[from] = 0;
+    queue.push({0, from});
+    int settled = 0;
+    while (!queue.empty() && settled < WitnessSettleLimit) {
+        const Entry entry = queue.top();
+        queue.pop();
+        if (entry.first > limit) break;
+        if (entry.first != witnessDistance(entry.second)) continue;
+        ++settled;
+        for (const Arc& arc : m_out[entry.second]) {
+            if (arc.node == skipped) continue;
+            const quint64 candidate = quint64(entry.first) + arc.weight;
+            if (candidate > limit || candidate >= witnessDistance(arc.node)) continue;
+            m_witnessStamp[arc.node] = m_witnessGeneration;
+            m_witnessDistance[arc.node] = quint32(candidate);
+            queue.push({quint32(candidate), arc.node});
+        }
+    }
+}
+
+quint32 RoadGraphBuilder::witnessDistance(quint32 node) const
+{
+    return m_witnessStamp[node] == m_witnessGeneration ? m_witnessDistance[node] : Infinity;
+}
+
+int RoadGraphBuilder::simulate(quint32 node, std::vector<Shortcut>* shortcuts)
+{
+    int created = 0;
+    for (const Arc& in : m_in[node]) {
+        quint32 longest = 0;
+        bool through = false;
+        for (const Arc& out : m_out[node]) {
+            if (out.node == in.node) continue;
+            longest = std::max(longest, out.weight);
+            through = true;
+        }
+        if (!through) continue;
+        const quint32 limit = in.weight + longest;
+        witnessSearch(in.node, node, limit);
+        for (const Arc& out : m_out[node]) {
+            if (out.node == in.node) continue;
+            const quint32 via = in.weight + out.weight;
+            if (witnessDistance(out.node) <= via) continue;
+            ++created;
+            if (shortcuts) shortcuts->push_back({in.node, out.node, via});
+        }
+    }
+    return created - int(m_in[node].size() + m_out[node].size());
+}
+
+void RoadGraphBuilder::contract()
+{
+    if (m_contracted) return;
+    const quint32 count = quint32(m_coordinates.size());
+    m_rank.assign(count, RoadGraph::NoNode);
+    m_contractedNeighbours.assign(count, 0);
+    m_forward.assign(count, {});
+    m_backward.assign(count, {});
+    m_forwardSpeedLimits.assign(count, {});
+    m_backwardSpeedLimits.assign(count, {});
+    m_witnessDistance.assign(count, Infinity);
+    m_witnessStamp.assign(count, 0);
+    m_witnessGeneration = 0;
+    m_shortcuts = 0;
+
+    // Les arcs restants sont modifiés par la contraction : on travaille sur une copie pour pouvoir
+    // ajouter des arcs puis recontracter.
+    const std::vector<std::vector<Arc>> out = m_out;
+    const std::vector<std::vector<Arc>> in = m_in;
+
+    using Entry = std::pair<int, quint32>; // (priorité, nœud)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (quint32 node = 0; node < count; ++node) queue.push({simulate(node, nullptr), node});
+
+    std::vector<Shortcut> shortcuts;
+    quint32 rank = 0;
+    while (!queue.empty()) {
+        const quint32 node = queue.top().second;
+        queue.pop();
+        if (m_rank[node] != RoadGraph::NoNode) continue;
+
+        // Mise à jour paresseuse : la priorité a pu augmenter depuis l'insertion. Les raccourcis de
+        // la simulation servent directement si le nœud est contracté.
+        shortcuts.clear();
+        const int priority = simulate(node, &shortcuts) + m_contractedNeighbours[node];
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, node});
+            continue;
+        }
+
+        for (const Arc& arc : m_out[node]) {
+            m_forward[node].push_back({arc.node, arc.weight, arc.middle});
+            m_forwardSpeedLimits[node].push_back(arc.speedLimit);
+            auto& back = m_in[arc.node];
+            back.erase(std::remove_if(back.begin(), back.end(), [node](const Arc& a) { return a.node == node; }), back.end());
+            ++m_contractedNeighbours[arc.node];
+        }
+        for (const Arc& arc : m_in[node]) {
+            m_backward[node].push_back({arc.node, arc.weight, arc.middle});
+            m_backwardSpeedLimits[node].push_back(arc.speedLimit);
+            auto& forth = m_out[arc.node];
+            forth.erase(std::remove_if(forth.begin(), forth.end(), [node](const Arc& a) { return a.node == node; }), forth.end());
+            ++m_contractedNeighbours[arc.node];
+        }
+        for (const Shortcut& shortcut : shortcuts) {
+            insertArc(m_out[shortcut.from], {shortcut.to, shortcut.weight, node, 0});
+            insertArc(m_in[shortcut.to], {shortcut.from, shortcut.weight, node, 0});
+        }
+        m_shortcuts += int(shortcuts.size());
+        m_out[node].clear();
+        m_in[node].clear();
+        m_rank[node] = rank++;
+    }
+
+    m_out = out;
+    m_in = in;
+    m_contracted = true;
+}
+
+bool RoadGraphBuilder::write(const QString& path)
+{
+    if (m_coordinates.empty()) return false;
+    contract();
+    const quint32 count = quint32(m_coordinates.size());
+
+    auto flatten = [count](const std::vector<std::vector<RoadGraph::Edge>>& lists,
+                           std::vector<quint32>& offsets, std::vector<RoadGraph::Edge>& edges) {
+        offsets.assign(count + 1, 0);
+        edges.clear();
+        for (quint32 node = 0; node < count; ++node) {
+            offsets[node] = quint32(edges.size());
+            edges.insert(edges.end(), lists[node].begin(), lists[node].end());
+        }
+        offsets[count] = quint32(edges.size());
+    };
+    std::vector<quint32> forwardOffsets;
+    std::vector<quint32> backwardOffsets;
+    std::vector<RoadGraph::Edge> forwardEdges;
+    std::vector<RoadGraph::Edge> backwardEdges;
+    flatten(m_forward, forwardOffsets, forwardEdges);
+    flatten(m_backward, backwardOffsets, backwardEdges);
+    std::vector<quint8> forwardSpeedLimits;
+    std::vector<quint8> backwardSpeedLimits;
+    for (quint32 node = 0; node < count; ++node) {
+        forwardSpeedLimits.insert(forwardSpeedLimits.end(), m_forwardSpeedLimits[node].begin(), m_forwardSpeedLimits[node].end());
+        backwardSpeedLimits.insert(backwardSpeedLimits.end(), m_backwardSpeedLimits[node].begin(), m_backwardSpeedLimits[node].end());
+    }
+
+    // Index des noms : tri par octets UTF-8 (recherche de préfixe par dichotomie dans RoadGraph).
+    std::vector<const PendingPlace*> sortedPlaces;
+    sortedPlaces.reserve(m_places.size());
+    for (const PendingPlace& place : m_places) sortedPlaces.push_back(&place);
+    std::sort(sortedPlaces.begin(), sortedPlaces.end(), [](const PendingPlace* a, const PendingPlace* b) {
+        const int order = std::string_view(a->name.constData(), std::size_t(a->name.size()))
+                              .compare(std::string_view(b->name.constData(), std::size_t(b->name.size())));
+        if (order != 0) return order < 0;
+        return std::tie(a->position.lat, a->position.lon) < std::tie(b->position.lat, b->position.lon);
+    });
+    std::vector<RoadGraph::Place> places;
+    QByteArray placeNames;
+    places.reserve(sortedPlaces.size());
+    for (const PendingPlace* place : sortedPlaces) {
+        places.push_back({quint32(placeNames.size()), quint16(place->name.size()), quint8(place->kind), 0, place->position});
+        placeNames.append(place->name);
+    }
+
+    // Index des mots (voir RoadGraph) : mots repliés de chaque nom, triés, codés par préfixe commun.
+    std::vector<std::pair<std::string, quint32>> words;
+    for (quint32 index = 0; index < quint32(sortedPlaces.size()); ++index) {
+        const QByteArray folded = RoadGraph::foldName(std::string_view(sortedPlaces[index]->name.constData(),
+                                                                       std::size_t(sortedPlaces[index]->name.size())));
+        std::string_view rest(folded.constData(), std::size_t(folded.size()));
+        while (!rest.empty()) {
+            const std::size_t space = std::min(rest.find(' '), rest.size());
+            if (space <= std::size_t(RoadGraph::MaxWordBytes)) words.push_back({std::string(rest.substr(0, space)), index});
+            rest.remove_prefix(std::min(space + 1, rest.size()));
+        }
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    std::vector<RoadGraph::WordBlock> wordBlocks;
+    QByteArray wordData;
+    std::vector<quint32> wordPostings;
+    wordPostings.reserve(words.size());
+    std::string previous;
+    int inBlock = 0;
+    for (std::size_t i = 0; i < words.size();) {
+        const std::string& word = words[i].first;
+        const quint32 firstPosting = quint32(wordPostings.size());
+        std::size_t next = i;
+        while (next < words.size() && words[next].first == word) wordPostings.push_back(words[next++].second);
+        std::size_t shared = 0;
+        if (inBlock == RoadGraph::WordBlockSize) inBlock = 0;
+        if (inBlock == 0) {
+            wordBlocks.push_back({quint32(wordData.size()), firstPosting});
+        } else {
+            while (shared < previous.size() && shared < word.size() && previous[shared] == word[shared]) ++shared;
+        }
+        wordData.append(char(shared));
+        wordData.append(char(word.size() - shared));
+        wordData.append(word.data() + shared, qsizetype(word.size() - shared));
+        for (quint32 count = quint32(next - i); ; count >>= 7) {
+            if (count < 0x80) {
+                wordData.append(char(count));
+                break;
+            }
+            wordData.append(char((count & 0x7F) | 0x80));
+        }
+        previous = word;
+        ++inBlock;
+        i = next;
+    }
+    wordBlocks.push_back({quint32(wordData.size()), quint32(wordPostings.size())});
+
+    // Grille de recalage : tri des nœuds par cellule (tri par dénombrement).
+    RoadGraph::Grid grid = {};
+    grid.cellSize = toFixed(GridCellDeg);
+    qint32 maxLat = std::numeric_limits<qint32>::min();
+    qint32 maxLon = std::numeric_limits<qint32>::min();
+    grid.minLat = std::numeric_limits<qint32>::max();
+    grid.minLon = std::numeric_limits<qint32>::max();
+    for (const RoadGraph::Coordinate& c : m_coordinates) {
+        grid.minLat = std::min(grid.minLat, c.lat);
+        grid.minLon = std::min(grid.minLon, c.lon);
+        maxLat = std::max(maxLat, c.lat);
+        maxLon = std::max(maxLon, c.lon);
+    }
+    grid.rows = quint32((qint64(maxLat) - grid.minLat) / grid.cellSize + 1);
+    grid.cols = quint32((qint64(maxLon) - grid.minLon) / grid.cellSize + 1);
+    auto cellOf = [&grid](const RoadGraph::Coordinate& c) {
+        return quint32((qint64(c.lat) - grid.minLat) / grid.cellSize) * grid.cols
+            + quint32((qint64(c.lon) - grid.minLon) / grid.cellSize);
+    };
+    std::vector<quint32> cells(std::size_t(grid.rows) * grid.cols + 1, 0);
+    for (const RoadGraph::Coordinate& c : m_coordinates) ++cells[cellOf(c) + 1];
+    for (std::size_t i = 1; i < cells.size(); ++i) cells[i] += cells[i - 1];
+    std::vector<quint32> gridNodes(count);
+    std::vector<quint32> fill(cells.begin(), cells.end() - 1);
+    for (quint32 node = 0; node < count; ++node) gridNodes[fill[cellOf(m_coordinates[node])]++] = node;
+
+    struct Pending {
+        RoadGraph::Section id;
+        const void* data;
+        quint64 size;
+    };
+    const Pending sections[] = {
+        {RoadGraph::NodeCoordinates, m_coordinates.data(), m_coordinates.size() * sizeof(RoadGraph::Coordinate)},
+        {RoadGraph::NodeRanks, m_rank.data(), m_rank.size() * sizeof(quint32)},
+        {RoadGraph::ForwardOffsets, forwardOffsets.data(), forwardOffsets.size() * sizeof(quint32)},
+        {RoadGraph::ForwardEdges, forwardEdges.data(), forwardEdges.size() * sizeof(RoadGraph::Edge)},
+        {RoadGraph::BackwardOffsets, backwardOffsets.data(), backwardOffsets.size() * sizeof(quint32)},
+        {RoadGraph::BackwardEdges, backwardEdges.data(), backwardEdges.size() * sizeof(RoadGraph::Edge)},
+        {RoadGraph::GridInfo, &grid, sizeof(grid)},
+        {RoadGraph::GridCells, cells.data(), cells.size() * sizeof(quint32)},
+        {RoadGraph::GridNodes, gridNodes.data(), gridNodes.size() * sizeof(quint32)},
+        {RoadGraph::ForwardSpeedLimits, forwardSpeedLimits.data(), forwardSpeedLimits.size()},
+        {RoadGraph::BackwardSpeedLimits, backwardSpeedLimits.data(), backwardSpeedLimits.size()},
+        {RoadGraph::PlaceEntries, places.data(), places.size() * sizeof(RoadGraph::Place)},
+        {RoadGraph::PlaceNames, placeNames.constData(), quint64(placeNames.size())},
+        {RoadGraph::WordBlocks, wordBlocks.data(), wordBlocks.size() * sizeof(RoadGraph::WordBlock)},
+        {RoadGraph::WordData, wordData.constData(), quint64(wordData.size())},
+        {RoadGraph::WordPostings, wordPostings.data(), wordPostings.size() * sizeof(quint32)},
+    };
+    const quint32 sectionCount = quint32(std::size(sections));
+
+    RoadGraph::Header header = {};
+    std::memcpy(header.magic, RoadGraph::Magic, sizeof(header.magic));
+    header.version = RoadGraph::Version;
+    header.sectionCount = sectionCount;
+
+    auto align = [](quint64 offset) { return (offset + 7) & ~quint64(7); };
+    std::vector<RoadGraph::SectionEntry> table(sectionCount);
+    quint64 offset = align(sizeof(header) + sectionCount * sizeof(RoadGraph::SectionEntry));
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        table[i] = {quint32(sections[i].id), 0, offset, sections[i].size};
+        offset = align(offset + sections[i].size);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    static const char padding[8] = {};
+    quint64 written = 0;
+    auto put = [&file, &written](const void* data, quint64 size) {
+        if (size == 0) return true;
+        if (file.write(static_cast<const char*>(data), qint64(size)) != qint64(size)) return false;
+        written += size;
+        return true;
+    };
+    bool ok = put(&header, sizeof(header)) && put(table.data(), table.size() * sizeof(RoadGraph::SectionEntry));
+    for (quint32 i = 0; ok && i < sectionCount; ++i) {
+        ok = put(padding, table[i].offset - written) && put(sections[i].data, sections[i].size);
+    }
+    ok = ok && put(padding, offset - written);
+    file.close();
+    return ok;
+}
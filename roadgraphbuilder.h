@@ -0,0 +1,130 @@
+/**
+ * @file roadgraphbuilder.h
+ * @brief Rôle architectural : Prétraitement d'un graphe routier en hiérarchie de contraction (hors véhicule).
+ * @details Responsabilités : Recevoir les nœuds et arcs orientés d'un réseau routier, contracter les nœuds
+ * un à un en ajoutant les raccourcis nécessaires, puis écrire le fichier lu par RoadGraph (sections CSR
+ * ascendantes, coordonnées en entiers, grille de recalage, limitations de vitesse, index des noms). Le coût est payé une fois, sur le poste de
+ * préparation ; l'application n'a plus qu'à projeter le fichier.
+ * Dépendances principales : RoadGraph (format), QFile.
+ */
+
+#ifndef ROADGRAPHBUILDER_H
+#define ROADGRAPHBUILDER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <set>
+#include <tuple>
+#include <vector>
+#include "roadgraph.h"
+
+/**
+ * @class RoadGraphBuilder
+ * @brief Construction et contraction d'un graphe routier.
+ * @details Ordre de contraction : file de priorité paresseuse sur la différence d'arcs (raccourcis créés
+ * moins arcs retirés) plus le nombre de voisins déjà contractés, qui répartit la contraction sur tout le
+ * réseau. Un raccourci u -> w n'est ajouté que si aucun chemin témoin au plus aussi court n'évite le
+ * nœud contracté ; la recherche de témoin est bornée (WitnessSettleLimit), un témoin manqué ne coûte
+ * qu'un raccourci superflu, jamais un chemin faux.
+ */
+class RoadGraphBuilder {
+public:
+    static constexpr int WitnessSettleLimit = 500; ///< Nœuds visités au plus par recherche de témoin.
+    static constexpr double GridCellDeg = 0.01;    ///< Côté d'une cellule de la grille de recalage (≈ 1 km).
+    static constexpr double PlaceCellDeg = 0.01;   ///< Regroupement des lieux de même nom (une rue = un lieu par cellule).
+
+    /**
+     * @brief Ajoute un nœud routier.
+     * @return Son numéro (0, 1, 2...).
+     */
+    quint32 addNode(double lat, double lon);
+
+    /**
+     * @brief Ajoute un arc orienté from -> to ; entre deux mêmes nœuds, seul le plus rapide est conservé.
+     * @param durationSec Durée de parcours (s), arrondie à la milliseconde.
+     * @param speedLimitKmh Limitation de vitesse (km/h, 0 : inconnue), bornée à 255.
+     */
+    void addEdge(quint32 from, quint32 to, double durationSec, int speedLimitKmh = 0);
+
+    /**
+     * @brief Ajoute un lieu nommé à l'index de géocodage.
+     * @details Les lieux de même nature, de même nom et de même cellule PlaceCellDeg sont fusionnés
+     * (le premier ajouté est conservé) : une rue découpée en plusieurs chemins OSM n'apparaît qu'une fois.
+     * @param name Nom UTF-8, tronqué à 65535 octets.
+     */
+    void addPlace(const QByteArray& name, double lat, double lon, RoadGraph::PlaceKind kind);
+
+    /**
+     * @brief Contracte tous les nœuds (appelé par write() si nécessaire).
+     */
+    void contract();
+
+    /**
+     * @brief Écrit le fichier RoadGraph.
+     * @return false si le fichier ne peut pas être écrit ou si le graphe est vide.
+     */
+    bool write(const QString& path);
+
+    int nodeCount() const { return int(m_coordinates.size()); } ///< Nœuds ajoutés.
+    int shortcutCount() const { return m_shortcuts; }             ///< Raccourcis créés par contract().
+    int placeCount() const { return int(m_places.size()); }       ///< Lieux retenus par addPlace().
+
+private:
+    /**
+     * @struct Arc
+     * @brief Arc du graphe restant pendant la contraction.
+     */
+    struct Arc {
+        quint32 node;   ///< Autre extrémité.
+        quint32 weight; ///< Durée (ms).
+        quint32 middle; ///< Nœud contourné, RoadGraph::NoNode pour un arc original.
+        quint8 speedLimit; ///< km/h (0 : inconnue ou raccourci).
+    };
+
+    /**
+     * @struct PendingPlace
+     * @brief Lieu en attente d'écriture.
+     */
+    struct PendingPlace {
+        QByteArray name;
+        RoadGraph::Coordinate position;
+        RoadGraph::PlaceKind kind;
+    };
+
+    /**
+     * @struct Shortcut
+     * @brief Raccourci from -> to remplaçant from -> nœud contracté -> to.
+     */
+    struct Shortcut {
+        quint32 from;
+        quint32 to;
+        quint32 weight;
+    };
+
+    static void insertArc(std::vector<Arc>& arcs, const Arc& arc);
+    int simulate(quint32 node, std::vector<Shortcut>* shortcuts);
+    void witnessSearch(quint32 from, quint32 skipped, quint32 limit);
+    quint32 witnessDistance(quint32 node) const;
+
+    std::vector<RoadGraph::Coordinate> m_coordinates;
+    std::vector<std::vector<Arc>> m_out;        ///< Arcs sortants restants.
+    std::vector<std::vector<Arc>> m_in;         ///< Arcs entrants restants.
+    std::vector<std::vector<RoadGraph::Edge>> m_forward;  ///< ForwardEdges figés par nœud contracté.
+    std::vector<std::vector<RoadGraph::Edge>> m_backward; ///< BackwardEdges figés par nœud contracté.
+    std::vector<std::vector<quint8>> m_forwardSpeedLimits;  ///< Parallèle à m_forward.
+    std::vector<std::vector<quint8>> m_backwardSpeedLimits; ///< Parallèle à m_backward.
+    std::vector<PendingPlace> m_places;
+    std::set<std::tuple<QByteArray, quint8, qint32, qint32>> m_placeKeys; ///< (nom, nature, cellule) déjà ajoutés.
+    std::vector<quint32> m_rank;                ///< Ordre de contraction (NoNode : pas encore contracté).
+    std::vector<int> m_contractedNeighbours;
+    bool m_contracted = false;
+    int m_shortcuts = 0;
+
+    // Recherche de témoin : distances valides si l'estampille vaut la génération courante.
+    std::vector<quint32> m_witnessDistance;
+    std::vector<quint32> m_witnessStamp;
+    quint32 m_witnessGeneration = 0;
+};
+
+#endif // ROADGRAPHBUILDER_H
@@ -0,0 +1,131 @@
+/**
+ * @file routematcher.cpp
+ * @brief Implémentation du recalage sur l'itinéraire (Viterbi en ligne).
+ */
+
+#include "routematcher.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr double DegToRad = M_PI / 180.0;
+constexpr double Impossible = -std::numeric_limits<double>::infinity();
+}
+
+RouteMatcher::RouteMatcher()
+{
+    reset();
+}
+
+void RouteMatcher::reset()
+{
+    m_head = -1;
+    m_size = 0;
+}
+
+double RouteMatcher::emission(const Candidate& candidate, double headingDeg, double speedKmh)
+{
+    const double z = candidate.distanceM / GpsSigmaM;
+    double logLikelihood = -0.5 * z * z;
+    // Le cap départage deux chaussées voisines (bretelle, voie parallèle) ; à l'arrêt il n'a pas de sens.
+    if (!std::isnan(headingDeg) && speedKmh >= MinHeadingSpeedKmh) {
+        logLikelihood += HeadingWeight * (std::cos((headingDeg - candidate.bearingDeg) * DegToRad) - 1.0);
+    }
+    return logLikelihood;
+}
+
+RouteMatcher::Match RouteMatcher::update(const Candidate* candidates, int count, double x, double y,
+                                         double headingDeg, double speedKmh)
+{
+    Match match;
+    count = std::min(count, MaxCandidates);
+    if (!candidates || count <= 0) {
+        reset();
+        return match;
+    }
+
+    const Step* previous = m_size > 0 ? &m_history[m_head] : nullptr;
+    const double travelledM = previous ? std::hypot(x - m_lastX, y - m_lastY) : 0.0;
+
+    const int slot = (m_head + 1) % HistoryLength;
+    Step& step = m_history[slot];
+    step.count = count;
+    bool connected = false;
+    for (int j = 0; j < count; ++j) {
+        const Candidate& candidate = candidates[j];
+        step.candidates[j] = candidate;
+        step.previous[j] = -1;
+        double best = previous ? Impossible : 0.0;
+        if (previous) {
+            for (int i = 0; i < previous->count; ++i) {
+                const double routeM = candidate.alongM - previous->candidates[i].alongM;
+                const double deviationM = std::abs(routeM - travelledM);
+                if (routeM < -BacktrackToleranceM || deviationM > MaxRouteDeviationM) continue;
+                const double score = previous->score[i] - deviationM / TransitionScaleM;
+                if (score > best) {
+                    best = score;
+                    step.previous[j] = qint8(i);
+                }
+            }
+        }
+        step.score[j] = best + emission(candidate, headingDeg, speedKmh);
+        if (step.previous[j] >= 0) connected = true;
+    }
+
+    if (previous && !connected) {
+        // Aucune transition possible (saut GPS, demi-tour) : la chaîne repart de cette position.
+        for (int j = 0; j < count; ++j) step.score[j] = emission(step.candidates[j], headingDeg, speedKmh);
+        m_size = 0;
+    }
+
+    // Normalisation (meilleur score à 0) : pas de dérive numérique sur un long trajet.
+    int best = 0;
+    for (int j = 1; j < count; ++j) {
+        if (step.score[j] > step.score[best]) best = j;
+    }
+    const double top = step.score[best];
+    const double bestAlongM = step.candidates[best].alongM;
+    double total = 0.0;
+    double agreeing = 0.0;
+    for (int j = 0; j < count; ++j) {
+        step.score[j] -= top;
+        const double weight = std::exp(step.score[j]);
+        total += weight;
+        // Segments voisins d'une même chaussée (sommet partagé, ligne droite découpée finement) : ils
+        // désignent le même point du trajet et ne contredisent pas le candidat retenu.
+        if (std::abs(step.candidates[j].alongM - bestAlongM) <= 2.0 * GpsSigmaM) agreeing += weight;
+    }
+    step.best = best;
+
+    m_head = slot;
+    m_size = std::min(m_size + 1, HistoryLength);
+    m_lastX = x;
+    m_lastY = y;
+
+    match.valid = true;
+    match.candidate = step.candidates[best];
+    match.confidence = agreeing / total;
+    return match;
+}
+
+std::vector<RouteMatcher::Candidate> RouteMatcher::bestPath() const
+{
+    std::vector<Candidate> path;
+    if (m_size == 0) return path;
+    path.resize(std::size_t(m_size));
+
+    int slot = m_head;
+    int index = m_history[slot].best;
+    for (int k = m_size - 1; k >= 0; --k) {
+        const Step& step = m_history[slot];
+        path[std::size_t(k)] = step.candidates[index];
+        index = step.previous[index];
+        slot = (slot + HistoryLength - 1) % HistoryLength;
+        // La plus ancienne étape conservée peut pointer vers une étape déjà recouverte.
+        if (index < 0) {
+            path.erase(path.begin(), path.begin() + k);
+            break;
+        }
+    }
+    return path;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file routematcher.h
+ * @brief Rôle architectural : Recalage de la position du véhicule sur l'itinéraire (modèle de Markov caché).
+ * @details Responsabilités : Choisir, parmi les segments candidats proches de chaque position, celui que
+ * le véhicule suit réellement en tenant compte des positions précédentes et du cap, puis fournir une
+ * confiance. Coût borné : nombre de candidats fixe, historique en tampon circulaire.
+ * Dépendances principales : aucune (la géométrie des candidats est fournie par RouteModel).
+ */
+
+#ifndef ROUTEMATCHER_H
+#define ROUTEMATCHER_H
+
+#include <QtGlobal>
+#include <array>
+#include <cmath>
+#include <vector>
+
+/**
+ * @class RouteMatcher
+ * @brief Décodage de Viterbi en ligne (Newson & Krumm) sur une fenêtre glissante de positions.
+ * @details À chaque position :
+ * - émission : écart au segment (gaussienne d'écart-type GpsSigmaM) et, en mouvement, accord entre
+ *   le cap du véhicule et la direction du segment ;
+ * - transition : la distance parcourue le long de l'itinéraire entre deux candidats doit correspondre à
+ *   la distance à vol d'oiseau entre les deux positions (loi exponentielle d'échelle TransitionScaleM) ;
+ *   un recul de plus de BacktrackToleranceM ou un écart de plus de MaxRouteDeviationM est exclu ;
+ *   sans transition possible (saut GPS), la chaîne repart de la seule émission.
+ * Les HistoryLength dernières étapes (candidats, scores, prédécesseurs) sont conservées pour
+ * reconstituer le chemin retenu (bestPath()).
+ */
+class RouteMatcher {
+public:
+    static constexpr int MaxCandidates = 6;             ///< Candidats examinés par position.
+    static constexpr int HistoryLength = 10;            ///< Étapes conservées (tampon circulaire).
+    static constexpr double CandidateRadiusM = 60.0;    ///< Rayon de recherche des candidats.
+    static constexpr double GpsSigmaM = 8.0;            ///< Écart-type de la position (m).
+    static constexpr double TransitionScaleM = 15.0;    ///< Tolérance d'écart route / vol d'oiseau (m).
+    static constexpr double BacktrackToleranceM = 15.0; ///< Recul admis le long de l'itinéraire (bruit GPS).
+    static constexpr double MaxRouteDeviationM = 200.0; ///< Écart route / vol d'oiseau au-delà duquel la chaîne repart.
+    static constexpr double HeadingWeight = 2.0;        ///< Poids du cap (log-vraisemblance à 90° d'écart).
+    static constexpr double MinHeadingSpeedKmh = 8.0;   ///< Vitesse sous laquelle le cap est ignoré.
+
+    /**
+     * @struct Candidate
+     * @brief Projection d'une position sur un segment de l'itinéraire.
+     */
+    struct Candidate {
+        int segment = -1;        ///< Segment de l'itinéraire.
+        double fraction = 0.0;   ///< Position le long du segment (0 à 1).
+        double distanceM = 0.0;  ///< Écart entre la position et le segment (m).
+        double alongM = 0.0;     ///< Distance depuis le départ de l'itinéraire jusqu'à la projection (m).
+        double bearingDeg = 0.0; ///< Direction du segment (degrés, 0 = nord).
+    };
+
+    /**
+     * @struct Match
+     * @brief Résultat d'une étape.
+     */
+    struct Match {
+        bool valid = false;       ///< false : aucun candidat.
+        Candidate candidate;      ///< Candidat retenu.
+        double confidence = 0.0;  ///< Part de la vraisemblance de l'étape proche (2σ le long du trajet) du candidat retenu.
+    };
+
+    RouteMatcher();
+
+    /**
+     * @brief Oublie l'historique (nouvel itinéraire, véhicule loin du tracé).
+     */
+    void reset();
+
+    /**
+     * @brief Traite une position.
+     * @param candidates Candidats (au plus MaxCandidates sont lus).
+     * @param x, y Position dans le repère de l'itinéraire (mètres, x mis à l'échelle par cos(latitude)).
+     * @param headingDeg Cap du véhicule (NaN : inconnu).
+     * @param speedKmh Vitesse du véhicule (le cap n'est utilisé qu'au-dessus de MinHeadingSpeedKmh).
+     */
+    Match update(const Candidate* candidates, int count, double x, double y, double headingDeg, double speedKmh);
+
+    /**
+     * @brief Chemin le plus vraisemblable sur l'historique, de la plus ancienne étape à la dernière.
+     */
+    std::vector<Candidate> bestPath() const;
+
+    int historySize() const { return m_size; } ///< Étapes conservées (≤ HistoryLength).
+
+private:
+    struct Step {
+        std::array<Candidate, MaxCandidates> candidates; ///< Candidats de l'étape.
+        std::array<double, MaxCandidates> score{};       ///< Log-vraisemblance du meilleur chemin (max = 0).
+        std::array<qint8, MaxCandidates> previous{};     ///< Candidat précédent sur ce chemin (-1 : départ).
+        int count = 0;                                   ///< Candidats valides.
+        int best = 0;                                    ///< Meilleur candidat.
+    };
+
+    static double emission(const Candidate& candidate, double headingDeg, double speedKmh);
+
+    std::array<Step, HistoryLength> m_history; ///< Tampon circulaire des étapes.
+    int m_head = -1;                           ///< Dernière étape écrite.
+    int m_size = 0;                            ///< Étapes valides.
+    double m_lastX = 0.0;                      ///< Position précédente (repère de l'itinéraire).
+    double m_lastY = 0.0;
+};
+
+#endif // ROUTEMATCHER_H
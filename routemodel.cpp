@@ -0,0 +1,363 @@
+/**
+ * @file routemodel.cpp
+ * @brief Implémentation du modèle d'itinéraire (décodage, projection, progression).
+ */
+
+#include "routemodel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double EarthRadiusM = 6371000.0;
+constexpr double DegToRad = M_PI / 180.0;
+constexpr double RadToDeg = 180.0 / M_PI;
+constexpr double MphToKmh = 1.609344;
+
+double haversineM(double lat1, double lon1, double lat2, double lon2)
+{
+    const double dLat = (lat2 - lat1) * DegToRad;
+    const double dLon = (lon2 - lon1) * DegToRad;
+    const double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+                   + std::cos(lat1 * DegToRad) * std::cos(lat2 * DegToRad) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2.0 * EarthRadiusM * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+}
+
+RouteModel::Congestion parseCongestion(const QString& level)
+{
+    if (level == QLatin1String("low")) return RouteModel::Congestion::Low;
+    if (level == QLatin1String("moderate")) return RouteModel::Congestion::Moderate;
+    if (level == QLatin1String("heavy")) return RouteModel::Congestion::Heavy;
+    if (level == QLatin1String("severe")) return RouteModel::Congestion::Severe;
+    return RouteModel::Congestion::Unknown;
+}
+
+int parseSpeedLimit(const QVariant& entry)
+{
+    // Mapbox : {"speed": 50, "unit": "km/h"}, {"unknown": true} ou {"none": true} (sans limitation).
+    if (entry.typeId() == QMetaType::QVariantMap) {
+        const QVariantMap map = entry.toMap();
+        bool ok = false;
+        const double speed = map.value(QStringLiteral("speed")).toDouble(&ok);
+        if (!ok || speed <= 0) return -1;
+        const bool mph = map.value(QStringLiteral("unit")).toString() == QLatin1String("mph");
+        return int(std::lround(mph ? speed * MphToKmh : speed));
+    }
+    bool ok = false;
+    const double speed = entry.toDouble(&ok);
+    return ok && speed > 0 ? int(std::lround(speed)) : -1;
+}
+
+}
+
+RouteModel::RouteModel(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool RouteModel::parseMapboxRoute(const QVariantMap& route, RouteData& out)
+{
+    out = RouteData();
+    const QVariantList coordinates = route.value(QStringLiteral("geometry")).toMap()
+                                          .value(QStringLiteral("coordinates")).toList();
+    out.points.reserve(coordinates.size());
+    for (const QVariant& coordinate : coordinates) {
+        // GeoJSON : [longitude, latitude].
+        const QVariantList pair = coordinate.toList();
+        if (pair.size() < 2) continue;
+        out.points.append(QGeoCoordinate(pair.at(1).toDouble(), pair.at(0).toDouble()));
+    }
+    if (out.points.size() < 2) return false;
+
+    // Les annotations de chaque étape (leg) se suivent dans l'ordre des segments du tracé.
+    const QVariantList legs = route.value(QStringLiteral("legs")).toList();
+    for (const QVariant& leg : legs) {
+        const QVariantMap annotation = leg.toMap().value(QStringLiteral("annotation")).toMap();
+        for (const QVariant& level : annotation.value(QStringLiteral("congestion")).toList()) {
+            out.congestion.append(parseCongestion(level.toString()));
+        }
+        for (const QVariant& limit : annotation.value(QStringLiteral("maxspeed")).toList()) {
+            out.speedLimitsKmh.append(parseSpeedLimit(limit));
+        }
+        for (const QVariant& duration : annotation.value(QStringLiteral("duration")).toList()) {
+            out.segmentDurationsSec.append(duration.toDouble());
+        }
+    }
+    out.durationSec = route.value(QStringLiteral("duration")).toDouble();
+    return true;
+}
+
+void RouteModel::setRoute(const RouteData& route)
+{
+    const int count = route.points.size() >= 2 ? int(route.points.size()) : 0;
+    m_xy.assign(std::size_t(count) * 2, 0.0);
+    m_cumulative.assign(std::size_t(count), 0.0);
+    for (int i = 0; i < count; ++i) {
+        const QGeoCoordinate& p = route.points.at(i);
+        m_xy[2 * i] = EarthRadiusM * p.longitude() * DegToRad;
+        m_xy[2 * i + 1] = EarthRadiusM * p.latitude() * DegToRad;
+        if (i > 0) {
+            const QGeoCoordinate& previous = route.points.at(i - 1);
+            m_cumulative[i] = m_cumulative[i - 1]
+                            + haversineM(previous.latitude(), previous.longitude(), p.latitude(), p.longitude());
+        }
+    }
+
+    const int segments = std::max(0, count - 1);
+    m_congestion.assign(std::size_t(segments), quint8(Congestion::Unknown));
+    m_speedLimits.assign(std::size_t(segments), qint16(-1));
+    for (int i = 0; i < segments && i < route.congestion.size(); ++i) m_congestion[i] = quint8(route.congestion.at(i));
+    for (int i = 0; i < segments && i < route.speedLimitsKmh.size(); ++i) m_speedLimits[i] = qint16(route.speedLimitsKmh.at(i));
+
+    // Durées cumulées : annotation par segment (vitesses réelles, bouchons compris) ; un segment
+    // non annoté est compté à la vitesse moyenne du trajet, comme l'ancienne extrapolation QML.
+    const double averageSpeedMs = route.durationSec > 0 && totalDistance() > 0 ? totalDistance() / route.durationSec
+                                                                                : DefaultSpeedMs;
+    m_cumulativeDuration.assign(std::size_t(count), 0.0);
+    for (int i = 0; i < segments; ++i) {
+        const double annotated = i < route.segmentDurationsSec.size() ? route.segmentDurationsSec.at(i) : -1.0;
+        const double duration = annotated >= 0.0 ? annotated : (m_cumulative[i + 1] - m_cumulative[i]) / averageSpeedMs;
+        m_cumulativeDuration[i + 1] = m_cumulativeDuration[i] + duration;
+    }
+
+    // Plan de la grille centré en latitude sur le trajet : l'échelle de x y reste juste à quelques % près
+    // sur plusieurs centaines de km, et nearestSegmentOnRoute() corrige la borne de recherche en conséquence.
+    double minLat = 90.0;
+    double maxLat = -90.0;
+    for (int i = 0; i < count; ++i) {
+        minLat = std::min(minLat, route.points.at(i).latitude());
+        maxLat = std::max(maxLat, route.points.at(i).latitude());
+    }
+    m_grid.build(m_xy.data(), count, count ? std::cos((minLat + maxLat) / 2 * DegToRad) : 1.0);
+
+    m_matcher.reset();
+    m_matchedPosition = QGeoCoordinate();
+    m_matchConfidence = 0.0;
+    m_segment = 0;
+    m_distanceFromRoute = 0.0;
+    m_remainingDistance = totalDistance();
+    m_remainingDuration = totalDuration();
+
+    // Avant le premier fix, le tracé part du premier sommet.
+    m_pathHead = point(0);
+
+    emit routeChanged();
+    emit progressChanged();
+}
+
+bool RouteModel::loadMapboxRoute(const QVariantMap& route)
+{
+    RouteData data;
+    const bool ok = parseMapboxRoute(route, data);
+    setRoute(data);
+    return ok;
+}
+
+void RouteModel::setCongestion(const QList<Congestion>& congestion)
+{
+    std::fill(m_congestion.begin(), m_congestion.end(), quint8(Congestion::Unknown));
+    const int count = std::min(int(m_congestion.size()), int(congestion.size()));
+    for (int i = 0; i < count; ++i) m_congestion[i] = quint8(congestion.at(i));
+    emit congestionChanged();
+}
+
+void RouteModel::clear()
+{
+    setRoute(RouteData());
+}
+
+void RouteModel::projectOnSegment(int segment, double px, double py, double kx, Projection& best) const
+{
+    // Repère local centré sur le véhicule : seul x dépend de la latitude, d'où un unique cosinus.
+    const double* xy = m_xy.data() + 2 * segment;
+    const double ax = (xy[0] - px) * kx;
+    const double ay = xy[1] - py;
+    const double bx = (xy[2] - px) * kx;
+    const double by = xy[3] - py;
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double lengthSq = dx * dx + dy * dy;
+    // Véhicule à l'origine : t minimise |A + t·AB|.
+    double t = lengthSq > 0.0 ? -(ax * dx + ay * dy) / lengthSq : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    const double cx = ax + t * dx;
+    const double cy = ay + t * dy;
+    const double distance = std::sqrt(cx * cx + cy * cy);
+    // À égalité (sommet partagé), le segment le plus en amont est retenu.
+    if (distance < best.distanceM || (distance == best.distanceM && segment < best.segment)) {
+        best.segment = segment;
+        best.fraction = t;
+        best.distanceM = distance;
+    }
+}
+
+RouteModel::Projection RouteModel::nearestSegment(double lat, double lon, int firstSegment, int lastSegment) const
+{
+    Projection best;
+    firstSegment = std::max(firstSegment, 0);
+    lastSegment = std::min(lastSegment, pointCount() - 1);
+
+    const double kx = std::cos(lat * DegToRad);
+    const double px = EarthRadiusM * lon * DegToRad;
+    const double py = EarthRadiusM * lat * DegToRad;
+    for (int i = firstSegment; i < lastSegment; ++i) projectOnSegment(i, px, py, kx, best);
+    return best;
+}
+
+RouteModel::Projection RouteModel::nearestSegmentOnRoute(double lat, double lon, int firstSegment,
+                                                         double maxDistanceM) const
+{
+    Projection best;
+    if (m_grid.isEmpty()) return best;
+
+    const double kx = std::cos(lat * DegToRad);
+    const double px = EarthRadiusM * lon * DegToRad;
+    const double py = EarthRadiusM * lat * DegToRad;
+    // Distance réelle ≥ distance dans le plan de la grille × scale (x y est mis à l'échelle par kx0
+    // au lieu de cos(latitude du véhicule)).
+    const double scale = std::min(1.0, kx / m_grid.referenceKx());
+    const double ringM = m_grid.cellSize() * scale;
+    const int maxRing = int(std::ceil(maxDistanceM / ringM)) + 1;
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        m_grid.visitRing(px, py, ring, [&](int segment) {
+            if (segment >= firstSegment) projectOnSegment(segment, px, py, kx, best);
+        });
+        // Tout segment non visité est au-delà de ring cellules.
+        if (best.distanceM <= ring * ringM) break;
+    }
+    if (best.distanceM > maxDistanceM) return Projection();
+    return best;
+}
+
+double RouteModel::distanceAlong(int segment, double fraction) const
+{
+    if (!hasRoute()) return 0.0;
+    segment = std::clamp(segment, 0, pointCount() - 2);
+    const double start = m_cumulative[segment];
+    return start + std::clamp(fraction, 0.0, 1.0) * (m_cumulative[segment + 1] - start);
+}
+
+int RouteModel::collectCandidates(double lat, double lon, int firstSegment, RouteMatcher::Candidate* out) const
+{
+    if (m_grid.isEmpty()) return 0;
+
+    const double kx = std::cos(lat * DegToRad);
+    const double px = EarthRadiusM * lon * DegToRad;
+    const double py = EarthRadiusM * lat * DegToRad;
+    const double ringM = m_grid.cellSize() * std::min(1.0, kx / m_grid.referenceKx());
+    const int maxRing = int(std::ceil(RouteMatcher::CandidateRadiusM / ringM));
+
+    // Les MaxCandidates plus proches, triés par distance ; un segment visité depuis plusieurs cellules
+    // n'est retenu qu'une fois.
+    Projection nearest[RouteMatcher::MaxCandidates];
+    int count = 0;
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        m_grid.visitRing(px, py, ring, [&](int segment) {
+            if (segment < firstSegment) return;
+            for (int i = 0; i < count; ++i) {
+                if (nearest[i].segment == segment) return;
+            }
+            Projection projection;
+            projectOnSegment(segment, px, py, kx, projection);
+            if (projection.distanceM > RouteMatcher::CandidateRadiusM) return;
+            if (count == RouteMatcher::MaxCandidates && projection.distanceM >= nearest[count - 1].distanceM) return;
+            int i = std::min(count, RouteMatcher::MaxCandidates - 1);
+            for (; i > 0 && nearest[i - 1].distanceM > projection.distanceM; --i) nearest[i] = nearest[i - 1];
+            nearest[i] = projection;
+            count = std::min(count + 1, RouteMatcher::MaxCandidates);
+        });
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const double* xy = m_xy.data() + 2 * nearest[i].segment;
+        RouteMatcher::Candidate& candidate = out[i];
+        candidate.segment = nearest[i].segment;
+        candidate.fraction = nearest[i].fraction;
+        candidate.distanceM = nearest[i].distanceM;
+        candidate.alongM = distanceAlong(nearest[i].segment, nearest[i].fraction);
+        const double bearing = std::atan2((xy[2] - xy[0]) * kx, xy[3] - xy[1]) * RadToDeg;
+        candidate.bearingDeg = bearing < 0.0 ? bearing + 360.0 : bearing;
+    }
+    return count;
+}
+
+double RouteModel::durationAlong(int segment, double fraction) const
+{
+    if (!hasRoute()) return 0.0;
+    segment = std::clamp(segment, 0, pointCount() - 2);
+    const double start = m_cumulativeDuration[segment];
+    return start + std::clamp(fraction, 0.0, 1.0) * (m_cumulativeDuration[segment + 1] - start);
+}
+
+void RouteModel::updatePosition(double lat, double lon, double headingDeg, double speedKmh)
+{
+    if (!hasRoute()) return;
+
+    Projection projection;
+    RouteMatcher::Candidate candidates[RouteMatcher::MaxCandidates];
+    const int candidateCount = collectCandidates(lat, lon, m_segment, candidates);
+    const RouteMatcher::Match match = m_matcher.update(candidates, candidateCount,
+                                                       EarthRadiusM * lon * DegToRad * std::cos(lat * DegToRad),
+                                                       EarthRadiusM * lat * DegToRad, headingDeg, speedKmh);
+    if (match.valid) {
+        // Recalage : le segment retenu tient compte des positions précédentes et du cap (bretelle ou
+        // chaussée parallèle à quelques mètres, tracé qui repasse au même endroit).
+        projection.segment = match.candidate.segment;
+        projection.fraction = match.candidate.fraction;
+        projection.distanceM = match.candidate.distanceM;
+    } else {
+        projection = nearestSegment(lat, lon, m_segment, m_segment + SearchWindowSegments);
+        if (projection.distanceM > SnapToleranceM) {
+            // Saut GPS ou retour sur l'itinéraire plus loin : la fenêtre ne suffit plus, tout le reste
+            // du trajet est examiné (sans revenir en arrière) avant de conclure à une sortie d'itinéraire.
+            const Projection global = nearestSegmentOnRoute(lat, lon, m_segment);
+            if (global.segment >= 0 && global.distanceM < projection.distanceM) projection = global;
+        }
+    }
+    if (projection.segment < 0) return;
+
+    m_segment = projection.segment;
+    m_distanceFromRoute = projection.distanceM;
+    m_remainingDistance = std::max(0.0, totalDistance() - distanceAlong(projection.segment, projection.fraction));
+    m_remainingDuration = std::max(0.0, totalDuration() - durationAlong(projection.segment, projection.fraction));
+    m_matchedPosition = match.valid ? pointAlong(projection.segment, projection.fraction) : QGeoCoordinate();
+    m_matchConfidence = match.valid ? match.confidence : 0.0;
+
+    // Le tracé restant est pathHead() suivi des sommets pathStart() + 1... : RoutePolylineItem ne réécrit
+    // que ce premier sommet, sans reconstruire ni transmettre la liste des sommets.
+    m_pathHead = match.valid ? m_matchedPosition : QGeoCoordinate(lat, lon);
+
+    emit progressChanged();
+    if (match.valid) emit positionMatched(m_matchedPosition, m_segment, m_matchConfidence);
+}
+
+int RouteModel::speedLimit() const
+{
+    return speedLimitAt(m_segment);
+}
+
+QGeoCoordinate RouteModel::point(int index) const
+{
+    if (index < 0 || index >= pointCount()) return QGeoCoordinate();
+    return QGeoCoordinate(m_xy[2 * index + 1] / EarthRadiusM * RadToDeg, m_xy[2 * index] / EarthRadiusM * RadToDeg);
+}
+
+QGeoCoordinate RouteModel::pointAlong(int segment, double fraction) const
+{
+    const double* xy = m_xy.data() + 2 * segment;
+    const double x = xy[0] + fraction * (xy[2] - xy[0]);
+    const double y = xy[1] + fraction * (xy[3] - xy[1]);
+    return QGeoCoordinate(y / EarthRadiusM * RadToDeg, x / EarthRadiusM * RadToDeg);
+}
+
+RouteModel::Congestion RouteModel::congestion(int segment) const
+{
+    if (segment < 0 || segment >= int(m_congestion.size())) return Congestion::Unknown;
+    return Congestion(m_congestion[segment]);
+}
+
+int RouteModel::speedLimitAt(int segment) const
+{
+    if (segment < 0 || segment >= int(m_speedLimits.size())) return -1;
+    return m_speedLimits[segment];
+}
@@ -0,0 +1,209 @@
+/**
+ * @file routemodel.h
+ * @brief Rôle architectural : Géométrie de l'itinéraire actif et calculs de progression, côté C++.
+ * @details Responsabilités : Conserver le tracé renvoyé par l'API Directions dans des tableaux contigus,
+ * localiser le véhicule sur le tracé, fournir distance et durée restantes, limitation de vitesse et
+ * trafic par segment à la carte QML (tracé dessiné par RoutePolylineItem). Remplace le traitement JavaScript de map.qml, exécuté à chaque fix.
+ * Dépendances principales : QGeoCoordinate (sorties QML), JSON Mapbox converti en QVariant.
+ */
+
+#ifndef ROUTEMODEL_H
+#define ROUTEMODEL_H
+
+#include <QGeoCoordinate>
+#include <QList>
+#include <QObject>
+#include <QVariant>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QtNumeric>
+#include <limits>
+#include <vector>
+#include "routematcher.h"
+#include "segmentgrid.h"
+
+/**
+ * @class RouteModel
+ * @brief Modèle d'itinéraire exposé à map.qml (propriété de contexte `routeModel`).
+ * @details Stockage :
+ * - positions projetées (x = R·lon, y = R·lat, en mètres le long de l'équateur et d'un méridien),
+ *   entrelacées dans un seul tableau de doubles ; la distance à un segment se calcule en mettant
+ *   x à l'échelle par cos(latitude du véhicule), sans trigonométrie par segment ;
+ * - distances et durées cumulées (sommes préfixes : haversine, annotation Mapbox `duration`) :
+ *   distance et durée restantes sont deux soustractions, quelle que soit la longueur du trajet ;
+ * - annotations par segment (trafic, limitation de vitesse) en tableaux d'octets et d'entiers.
+ *
+ * - index spatial des segments (SegmentGrid) pour chercher sur tout le trajet.
+ *
+ * updatePosition() fait avancer l'index de segment courant (jamais en arrière) : le segment le plus
+ * proche est d'abord cherché dans les SearchWindowSegments suivants ; au-delà de SnapToleranceM
+ * (saut GPS, retour sur l'itinéraire plus loin), tout le reste du trajet est examiné via la grille.
+ * Tant que des segments sont à moins de RouteMatcher::CandidateRadiusM, c'est le recalage HMM
+ * (RouteMatcher : dernières positions et cap) qui choisit le segment, pas la seule distance.
+ */
+class RouteModel : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool hasRoute READ hasRoute NOTIFY routeChanged)
+    Q_PROPERTY(int pointCount READ pointCount NOTIFY routeChanged)
+    Q_PROPERTY(double totalDistance READ totalDistance NOTIFY routeChanged)
+    Q_PROPERTY(int segmentIndex READ segmentIndex NOTIFY progressChanged)
+    Q_PROPERTY(int remainingPointCount READ remainingPointCount NOTIFY progressChanged)
+    Q_PROPERTY(double distanceFromRoute READ distanceFromRoute NOTIFY progressChanged)
+    Q_PROPERTY(bool offRoute READ isOffRoute NOTIFY progressChanged)
+    Q_PROPERTY(double remainingDistance READ remainingDistance NOTIFY progressChanged)
+    Q_PROPERTY(double remainingDuration READ remainingDuration NOTIFY progressChanged)
+    Q_PROPERTY(int speedLimit READ speedLimit NOTIFY progressChanged)
+    Q_PROPERTY(QGeoCoordinate matchedPosition READ matchedPosition NOTIFY progressChanged)
+    Q_PROPERTY(double matchConfidence READ matchConfidence NOTIFY progressChanged)
+    Q_PROPERTY(QGeoCoordinate pathHead READ pathHead NOTIFY progressChanged)
+
+public:
+    static constexpr int SearchWindowSegments = 30;    ///< Segments examinés à partir du segment courant.
+    static constexpr double SnapToleranceM = 20.0;     ///< Écart toléré dans la fenêtre avant recherche globale.
+    static constexpr double GlobalSearchRadiusM = 1000.0; ///< Rayon maximal de la recherche sur tout le trajet.
+    static constexpr double OffRouteDistanceM = 75.0;  ///< Écart au tracé au-delà duquel on recalcule.
+    static constexpr double DefaultSpeedMs = 13.8;     ///< Vitesse moyenne sans durée fournie (≈ 50 km/h).
+
+    /**
+     * @brief Niveau de trafic Mapbox (annotation `congestion`) d'un segment.
+     */
+    enum class Congestion : quint8 { Unknown, Low, Moderate, Heavy, Severe };
+
+    /**
+     * @struct RouteData
+     * @brief Itinéraire décodé : sommets et annotations par segment (entre le sommet i et i + 1).
+     */
+    struct RouteData {
+        QList<QGeoCoordinate> points;   ///< Sommets du tracé.
+        QList<Congestion> congestion;   ///< Trafic par segment (peut être plus court que le tracé).
+        QList<int> speedLimitsKmh;      ///< Limitation par segment en km/h, -1 si inconnue.
+        QList<double> segmentDurationsSec; ///< Durée de parcours par segment, trafic compris (s).
+        double durationSec = 0.0;       ///< Durée totale annoncée par l'API (0 : inconnue).
+    };
+
+    /**
+     * @struct Projection
+     * @brief Projection d'une position sur le tracé.
+     */
+    struct Projection {
+        int segment = -1;        ///< Segment le plus proche (-1 : aucun).
+        double fraction = 0.0;   ///< Position le long du segment, de 0 (sommet i) à 1 (sommet i + 1).
+        double distanceM = std::numeric_limits<double>::infinity(); ///< Distance au segment (m).
+    };
+
+    explicit RouteModel(QObject* parent = nullptr);
+
+    /**
+     * @brief Extrait tracé et annotations d'une route de la réponse Mapbox Directions
+     *        (`geometries=geojson`, annotations `maxspeed`, `congestion` et `duration`).
+     * @return false si la géométrie est absente ou compte moins de deux sommets.
+     */
+    static bool parseMapboxRoute(const QVariantMap& route, RouteData& out);
+
+    /**
+     * @brief Remplace l'itinéraire courant ; la progression repart du premier segment.
+     */
+    void setRoute(const RouteData& route);
+
+    /**
+     * @brief Charge `json.routes[i]` tel que reçu en QML (l'objet JavaScript est converti en QVariantMap).
+     * @return false si la route est inexploitable (l'itinéraire courant est alors effacé).
+     */
+    Q_INVOKABLE bool loadMapboxRoute(const QVariantMap& route);
+
+    /**
+     * @brief Remplace le trafic par segment sans changer le tracé ni la progression
+     *        (actualisation du trafic) : le tracé n'est que recoloré.
+     */
+    void setCongestion(const QList<Congestion>& congestion);
+
+    /**
+     * @brief Efface l'itinéraire (fin de guidage).
+     */
+    Q_INVOKABLE void clear();
+
+    /**
+     * @brief Localise le véhicule sur le tracé et met à jour progression, distance et durée restantes.
+     * @param headingDeg Cap du véhicule (NaN : inconnu), utilisé par le recalage au-dessus de
+     *        RouteMatcher::MinHeadingSpeedKmh.
+     * @param speedKmh Vitesse du véhicule.
+     */
+    Q_INVOKABLE void updatePosition(double lat, double lon, double headingDeg = qQNaN(), double speedKmh = 0.0);
+
+    /**
+     * @brief Segment le plus proche parmi [firstSegment, lastSegment) (parcours linéaire).
+     */
+    Projection nearestSegment(double lat, double lon, int firstSegment, int lastSegment) const;
+
+    /**
+     * @brief Segment le plus proche sur tout le trajet à partir de firstSegment, via l'index spatial.
+     * @return Projection vide (segment -1) si aucun segment n'est à moins de maxDistanceM.
+     */
+    Projection nearestSegmentOnRoute(double lat, double lon, int firstSegment = 0,
+                                     double maxDistanceM = GlobalSearchRadiusM) const;
+
+    /**
+     * @brief Distance parcourue depuis le départ jusqu'à un point du tracé (m).
+     */
+    double distanceAlong(int segment, double fraction) const;
+
+    /**
+     * @brief Segments à moins de RouteMatcher::CandidateRadiusM, à partir de firstSegment, triés par distance.
+     * @param out Tableau d'au moins RouteMatcher::MaxCandidates éléments.
+     * @return Nombre de candidats écrits.
+     */
+    int collectCandidates(double lat, double lon, int firstSegment, RouteMatcher::Candidate* out) const;
+
+    /**
+     * @brief Durée de parcours prévue depuis le départ jusqu'à un point du tracé (s).
+     * @details Durées par segment de l'API ; à défaut, longueur du segment / vitesse moyenne du trajet.
+     */
+    double durationAlong(int segment, double fraction) const;
+
+    bool hasRoute() const { return pointCount() >= 2; }                        ///< Itinéraire chargé.
+    int pointCount() const { return int(m_cumulative.size()); }                 ///< Nombre de sommets.
+    double totalDistance() const { return m_cumulative.empty() ? 0.0 : m_cumulative.back(); } ///< Longueur (m).
+    int segmentIndex() const { return m_segment; }                              ///< Segment courant.
+    int remainingPointCount() const { return hasRoute() ? pointCount() - m_segment : 0; } ///< Sommets restants.
+    double distanceFromRoute() const { return m_distanceFromRoute; }            ///< Écart latéral (m).
+    bool isOffRoute() const { return hasRoute() && m_distanceFromRoute > OffRouteDistanceM; } ///< Hors itinéraire.
+    double remainingDistance() const { return m_remainingDistance; }            ///< Distance restante (m).
+    double totalDuration() const { return m_cumulativeDuration.empty() ? 0.0 : m_cumulativeDuration.back(); } ///< Durée prévue (s).
+    double remainingDuration() const { return m_remainingDuration; }            ///< Durée restante (s).
+    int speedLimit() const;                                                      ///< Limitation courante (km/h, -1).
+    QGeoCoordinate matchedPosition() const { return m_matchedPosition; }        ///< Position recalée (invalide : aucune).
+    double matchConfidence() const { return m_matchConfidence; }                ///< Confiance du recalage (0 à 1).
+    QGeoCoordinate point(int index) const;                                       ///< Sommet du tracé.
+    Congestion congestion(int segment) const;                                    ///< Trafic d'un segment.
+    int speedLimitAt(int segment) const;                                         ///< Limitation d'un segment (km/h, -1).
+    QGeoCoordinate pathHead() const { return m_pathHead; }                       ///< Début du tracé restant (véhicule).
+    int pathStart() const { return hasRoute() ? m_segment : 0; }                 ///< Sommet remplacé par pathHead().
+
+signals:
+    void routeChanged();           ///< Nouvel itinéraire (ou effacement).
+    void progressChanged();        ///< Position sur l'itinéraire mise à jour.
+    void congestionChanged();      ///< Trafic mis à jour sur l'itinéraire courant (géométrie inchangée).
+    void positionMatched(const QGeoCoordinate& position, int segment, double confidence); ///< Position recalée sur le tracé.
+
+private:
+    void projectOnSegment(int segment, double px, double py, double kx, Projection& best) const;
+    QGeoCoordinate pointAlong(int segment, double fraction) const;
+
+    std::vector<double> m_xy;           ///< Sommets projetés (x0, y0, x1, y1...) en mètres.
+    std::vector<double> m_cumulative;   ///< Distance depuis le départ à chaque sommet (m).
+    std::vector<double> m_cumulativeDuration; ///< Durée prévue depuis le départ à chaque sommet (s).
+    std::vector<quint8> m_congestion;   ///< Congestion par segment.
+    std::vector<qint16> m_speedLimits;  ///< Limitation par segment (km/h, -1).
+    SegmentGrid m_grid;                 ///< Index spatial des segments.
+    RouteMatcher m_matcher;             ///< Recalage sur les dernières positions.
+
+    int m_segment = 0;                  ///< Segment courant (ne recule pas).
+    double m_distanceFromRoute = 0.0;   ///< Écart du dernier fix au tracé (m).
+    double m_remainingDistance = 0.0;   ///< Distance restante depuis la projection du véhicule (m).
+    double m_remainingDuration = 0.0;   ///< Durée restante depuis la projection du véhicule (s).
+    QGeoCoordinate m_matchedPosition;   ///< Projection retenue par le recalage (invalide : aucune).
+    double m_matchConfidence = 0.0;     ///< Confiance du recalage (0 : non recalé).
+    QGeoCoordinate m_pathHead;          ///< Véhicule (recalé s'il est sur le tracé), en tête du tracé restant.
+};
+
+#endif // ROUTEMODEL_H
@@ -0,0 +1,315 @@
+/**
+ * @file routepolylineitem.cpp
+ * @brief Implémentation du rendu du tracé (géométrie persistante, tête mise à jour sur place).
+ */
+
+#include "routepolylineitem.h"
+#include "polylinesimplifier.h"
+#include "routemodel.h"
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+static_assert(sizeof(RouteStrip::Vertex) == sizeof(QSGGeometry::ColoredPoint2D), "disposition de sommet incompatible");
+
+namespace {
+constexpr double WorldSize = RoutePolylineItem::TileSize * double(1 << int(RoutePolylineItem::ReferenceZoom));
+
+double mercatorX(double lon)
+{
+    return (lon + 180.0) / 360.0 * WorldSize;
+}
+
+double mercatorY(double lat)
+{
+    const double phi = std::clamp(lat, -85.05112878, 85.05112878) * M_PI / 180.0;
+    return (0.5 - std::log(std::tan(M_PI / 4.0 + phi / 2.0)) / (2.0 * M_PI)) * WorldSize;
+}
+
+RouteStrip::Color toStripColor(const QColor& color)
+{
+    // QSGVertexColorMaterial attend un alpha prémultiplié.
+    const int a = color.alpha();
+    return RouteStrip::Color{quint8(color.red() * a / 255), quint8(color.green() * a / 255),
+                             quint8(color.blue() * a / 255), quint8(a)};
+}
+
+QGeoCoordinate fromMercator(double x, double y)
+{
+    const double lon = x / WorldSize * 360.0 - 180.0;
+    const double lat = std::atan(std::sinh(M_PI * (1.0 - 2.0 * y / WorldSize))) * 180.0 / M_PI;
+    return QGeoCoordinate(lat, lon);
+}
+}
+
+RoutePolylineItem::RoutePolylineItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+
+    m_widthTimer = new QTimer(this);
+    m_widthTimer->setSingleShot(true);
+    m_widthTimer->setInterval(WidthSettleMs);
+    connect(m_widthTimer, &QTimer::timeout, this, [this]() {
+        m_widthDirty = true;
+        update();
+    });
+}
+
+void RoutePolylineItem::setModel(RouteModel* model)
+{
+    if (m_model == model) return;
+    if (m_model) disconnect(m_model, nullptr, this, nullptr);
+    m_model = model;
+    if (m_model) {
+        connect(m_model, &RouteModel::routeChanged, this, &RoutePolylineItem::onRouteChanged);
+        connect(m_model, &RouteModel::progressChanged, this, &RoutePolylineItem::onProgressChanged);
+        connect(m_model, &RouteModel::congestionChanged, this, &RoutePolylineItem::onCongestionChanged);
+    }
+    onRouteChanged();
+    emit modelChanged();
+}
+
+void RoutePolylineItem::setColor(const QColor& color)
+{
+    setLineColor(m_color, color);
+}
+
+void RoutePolylineItem::setModerateColor(const QColor& color)
+{
+    setLineColor(m_moderateColor, color);
+}
+
+void RoutePolylineItem::setHeavyColor(const QColor& color)
+{
+    setLineColor(m_heavyColor, color);
+}
+
+void RoutePolylineItem::setLineColor(QColor& target, const QColor& color)
+{
+    if (target == color) return;
+    target = color;
+    onCongestionChanged();
+    emit colorChanged();
+}
+
+void RoutePolylineItem::setLineWidth(double width)
+{
+    if (m_lineWidth == width) return;
+    m_lineWidth = width;
+    m_widthDirty = true;
+    update();
+    emit lineWidthChanged();
+}
+
+void RoutePolylineItem::setMapZoomLevel(double zoom)
+{
+    if (m_mapZoomLevel == zoom) return;
+    m_mapZoomLevel = zoom;
+    applyLevel(false);
+    // Pendant une animation de zoom, la bande garde son épaisseur (mise à l'échelle par la carte).
+    m_widthTimer->start();
+    emit mapZoomLevelChanged();
+}
+
+void RoutePolylineItem::onRouteChanged()
+{
+    // Seule conversion de tout le tracé : une fois par itinéraire.
+    std::vector<double> xy;
+    const int count = m_model ? m_model->pointCount() : 0;
+    double minX = 0.0;
+    double minY = 0.0;
+    double maxX = 0.0;
+    double maxY = 0.0;
+    if (count > 0) {
+        xy.resize(std::size_t(count) * 2);
+        for (int i = 0; i < count; ++i) {
+            const QGeoCoordinate p = m_model->point(i);
+            xy[2 * i] = mercatorX(p.longitude());
+            xy[2 * i + 1] = mercatorY(p.latitude());
+        }
+        minX = maxX = xy[0];
+        minY = maxY = xy[1];
+        for (int i = 1; i < count; ++i) {
+            minX = std::min(minX, xy[2 * i]);
+            maxX = std::max(maxX, xy[2 * i]);
+            minY = std::min(minY, xy[2 * i + 1]);
+            maxY = std::max(maxY, xy[2 * i + 1]);
+        }
+        // Coordonnées relatives au coin nord-ouest : petites valeurs, exactes en float.
+        for (int i = 0; i < count; ++i) {
+            xy[2 * i] -= minX;
+            xy[2 * i + 1] -= minY;
+        }
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_origin = count > 0 ? fromMercator(minX, minY) : QGeoCoordinate();
+    setWidth(maxX - minX);
+    setHeight(maxY - minY);
+
+    m_xy = std::move(xy);
+    m_segment = 0;
+    m_level = -1;
+    m_drawn.clear();
+    emit originChanged();
+    onCongestionChanged();
+    onProgressChanged();
+}
+
+void RoutePolylineItem::onCongestionChanged()
+{
+    const int segments = m_model ? std::max(m_model->pointCount() - 1, 0) : 0;
+    const RouteStrip::Color low = toStripColor(m_color);
+    const RouteStrip::Color moderate = toStripColor(m_moderateColor);
+    const RouteStrip::Color heavy = toStripColor(m_heavyColor);
+    std::vector<RouteStrip::Color> colors(std::size_t(segments), low);
+    for (int i = 0; i < segments; ++i) {
+        switch (m_model->congestion(i)) {
+        case RouteModel::Congestion::Moderate: colors[i] = moderate; break;
+        case RouteModel::Congestion::Heavy:
+        case RouteModel::Congestion::Severe: colors[i] = heavy; break;
+        default: break;
+        }
+    }
+    m_segmentColors = std::move(colors);
+    rebuildLevels();
+    applyLevel(true);
+}
+
+void RoutePolylineItem::rebuildLevels()
+{
+    // Les changements de couleur restent des sommets à tous les niveaux : un segment simplifié
+    // est d'une seule couleur, celle de son premier segment d'origine.
+    std::vector<int> forced;
+    for (std::size_t i = 1; i < m_segmentColors.size(); ++i) {
+        const RouteStrip::Color& a = m_segmentColors[i - 1];
+        const RouteStrip::Color& b = m_segmentColors[i];
+        if (a.r != b.r || a.g != b.g || a.b != b.b || a.a != b.a) forced.push_back(int(i));
+    }
+    const std::vector<double> importance = PolylineSimplifier::importance(m_xy.data(), int(m_xy.size() / 2), forced);
+    m_levels.clear();
+    for (int zoom = MinLevelZoom; zoom <= MaxLevelZoom; ++zoom) {
+        // Plage [zoom, zoom + 1) : tolérance fixée par son échelle la plus grande, en pixels de l'élément.
+        const double tolerance = ToleranceScreenPx * std::exp2(ReferenceZoom - (zoom + 1));
+        m_levels.push_back(PolylineSimplifier::select(importance, tolerance));
+    }
+}
+
+void RoutePolylineItem::applyLevel(bool levelsChanged)
+{
+    if (m_levels.empty()) return;
+    const int level = std::clamp(int(std::floor(m_mapZoomLevel)), MinLevelZoom, MaxLevelZoom) - MinLevelZoom;
+    // Zoom à l'intérieur du même niveau : rien à faire (l'épaisseur est traitée dans updatePaintNode()).
+    if (!levelsChanged && level == m_level) return;
+    const std::vector<int>& kept = m_levels[std::size_t(level)];
+
+    std::vector<RouteStrip::Color> colors;
+    colors.reserve(kept.size());
+    for (std::size_t k = 0; k + 1 < kept.size(); ++k) colors.push_back(m_segmentColors[std::size_t(kept[k])]);
+
+    if (level != m_level || kept != m_drawn) {
+        // Changement de niveau (franchissement d'un zoom entier) ou nouvel itinéraire : nouvelle bande.
+        std::vector<double> xy;
+        xy.reserve(kept.size() * 2);
+        for (int index : kept) {
+            xy.push_back(m_xy[2 * std::size_t(index)]);
+            xy.push_back(m_xy[2 * std::size_t(index) + 1]);
+        }
+        m_strip.setPath(std::move(xy));
+        m_drawn = kept;
+        m_level = level;
+        m_geometryDirty = true;
+    } else {
+        // Même sommets (actualisation du trafic sans nouveau changement de couleur) : recoloration seule.
+        m_colorDirty = true;
+    }
+    m_strip.setSegmentColors(std::move(colors));
+    m_start = drawnStart();
+    update();
+}
+
+int RoutePolylineItem::drawnStart() const
+{
+    // Sommet retenu qui commence le segment simplifié contenant le segment courant.
+    if (m_drawn.empty()) return 0;
+    const auto it = std::upper_bound(m_drawn.begin(), m_drawn.end(), m_segment);
+    return std::max(int(it - m_drawn.begin()) - 1, 0);
+}
+
+void RoutePolylineItem::onProgressChanged()
+{
+    if (!m_model || !m_model->hasRoute()) return;
+    const QGeoCoordinate head = m_model->pathHead();
+    m_segment = m_model->pathStart();
+    m_start = drawnStart();
+    m_headX = mercatorX(head.longitude()) - m_originX;
+    m_headY = mercatorY(head.latitude()) - m_originY;
+    m_headDirty = true;
+    update();
+}
+
+double RoutePolylineItem::targetHalfWidth() const
+{
+    // L'élément est agrandi de 2^(zoom carte - ReferenceZoom) par le MapQuickItem porteur.
+    return m_lineWidth / 2.0 * std::exp2(ReferenceZoom - m_mapZoomLevel);
+}
+
+QSGNode* RoutePolylineItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    auto* node = static_cast<QSGGeometryNode*>(oldNode);
+    m_lastWritten = 0;
+    if (m_strip.vertexCount() == 0) {
+        delete node;
+        m_geometryDirty = true;
+        return nullptr;
+    }
+
+    if (!node) {
+        node = new QSGGeometryNode;
+        auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+        // Tampon réécrit sur place à chaque fix : le moteur de rendu le garde en mémoire dynamique.
+        geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+        m_geometryDirty = true;
+    }
+
+    QSGGeometry* geometry = node->geometry();
+    auto* vertices = reinterpret_cast<RouteStrip::Vertex*>(geometry->vertexDataAsColoredPoint2D());
+    const double halfWidth = targetHalfWidth();
+    const bool widthChanged = m_widthDirty
+        && std::abs(halfWidth - m_strip.halfWidth()) > WidthTolerance * m_strip.halfWidth();
+    if (m_geometryDirty || widthChanged) {
+        // Nouvel itinéraire, changement de niveau ou zoom stabilisé : tessellation complète, jamais à chaque fix.
+        if (geometry->vertexCount() != m_strip.vertexCount()) {
+            geometry->allocate(m_strip.vertexCount());
+            vertices = reinterpret_cast<RouteStrip::Vertex*>(geometry->vertexDataAsColoredPoint2D());
+        }
+        m_strip.setHalfWidth(halfWidth);
+        m_strip.setHead(m_start, m_headX, m_headY);
+        m_strip.write(vertices);
+        m_lastWritten = m_strip.vertexCount();
+        node->markDirty(QSGNode::DirtyGeometry);
+    } else {
+        // Trafic actualisé : couleurs réécrites sur place, positions inchangées.
+        if (m_colorDirty) {
+            m_strip.writeColors(vertices);
+            node->markDirty(QSGNode::DirtyGeometry);
+        }
+        if (m_headDirty) {
+            m_lastWritten = m_strip.moveHead(m_start, m_headX, m_headY, vertices);
+            node->markDirty(QSGNode::DirtyGeometry);
+        }
+    }
+    m_geometryDirty = false;
+    m_headDirty = false;
+    m_colorDirty = false;
+    m_widthDirty = false;
+    return node;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file routepolylineitem.h
+ * @brief Rôle architectural : Rendu du tracé d'itinéraire dans le graphe de scène Qt Quick.
+ * @details Responsabilités : Construire une seule fois par itinéraire la géométrie du tracé (RouteStrip)
+ * à partir de RouteModel, colorée sommet par sommet selon le trafic, puis, à chaque fix, ne mettre à
+ * jour que son début (le véhicule). Un seul élément remplace la MapPolyline de map.qml (chemin de
+ * 3000 coordonnées réaffecté à chaque position) et les MapPolyline de trafic créées par MapItemView.
+ * Dépendances principales : QQuickItem / QSGGeometryNode, RouteModel, RouteStrip.
+ */
+
+#ifndef ROUTEPOLYLINEITEM_H
+#define ROUTEPOLYLINEITEM_H
+
+#include <QColor>
+#include <QGeoCoordinate>
+#include <QPointer>
+#include <QQuickItem>
+#include "routestrip.h"
+
+class QTimer;
+class RouteModel;
+
+/**
+ * @class RoutePolylineItem
+ * @brief Élément QML `RoutePolyline` (module InterfaceGPS 1.0), placé dans un MapQuickItem.
+ * @details Les sommets sont en pixels Web Mercator au niveau de zoom referenceZoom, relatifs au coin
+ * nord-ouest du tracé (origin). Le MapQuickItem porteur est ancré sur origin avec
+ * `zoomLevel: referenceZoom` : la carte se charge de l'échelle, de la rotation et de l'inclinaison.
+ * L'épaisseur est exprimée en pixels écran ; elle dépend donc de mapZoomLevel, mais la bande n'est
+ * re-tessellée qu'une fois le zoom stable depuis WidthSettleMs (pas à chaque pas d'une animation de
+ * zoom, où elle suit l'échelle de la carte), et si l'épaisseur effective varie de plus de WidthTolerance.
+ *
+ * Multi-résolution : l'importance Douglas-Peucker de chaque sommet est calculée une fois par itinéraire
+ * (PolylineSimplifier, changements de trafic imposés), puis une liste de sommets par niveau de zoom
+ * entier, à ToleranceScreenPx près. Seul le niveau du zoom courant est tessellé ; RouteModel conserve
+ * le tracé complet pour le guidage.
+ */
+class RoutePolylineItem : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(RouteModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor moderateColor READ moderateColor WRITE setModerateColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor heavyColor READ heavyColor WRITE setHeavyColor NOTIFY colorChanged)
+    Q_PROPERTY(double lineWidth READ lineWidth WRITE setLineWidth NOTIFY lineWidthChanged)
+    Q_PROPERTY(double mapZoomLevel READ mapZoomLevel WRITE setMapZoomLevel NOTIFY mapZoomLevelChanged)
+    Q_PROPERTY(QGeoCoordinate origin READ origin NOTIFY originChanged)
+    Q_PROPERTY(double referenceZoom READ referenceZoom CONSTANT)
+
+public:
+    static constexpr double ReferenceZoom = 16.0;  ///< Zoom de la géométrie (≈ 2,4 m par pixel à l'équateur).
+    static constexpr double TileSize = 256.0;      ///< Côté d'une tuile Web Mercator (pixels).
+    static constexpr double WidthTolerance = 0.05; ///< Écart relatif d'épaisseur déclenchant une re-tessellation.
+    static constexpr int WidthSettleMs = 150;      ///< Zoom stable depuis ce délai : épaisseur ré-appliquée.
+    static constexpr int MinLevelZoom = 5;         ///< Niveau le plus simplifié (zooms inférieurs compris).
+    static constexpr int MaxLevelZoom = 20;        ///< Niveau le plus détaillé (zoom maximal de la carte).
+    static constexpr double ToleranceScreenPx = 0.5; ///< Écart maximal à l'écran entre tracé simplifié et complet.
+
+    explicit RoutePolylineItem(QQuickItem* parent = nullptr);
+
+    RouteModel* model() const { return m_model; }         ///< Itinéraire dessiné.
+    void setModel(RouteModel* model);
+    QColor color() const { return m_color; }              ///< Couleur du tracé (trafic fluide ou inconnu).
+    void setColor(const QColor& color);
+    QColor moderateColor() const { return m_moderateColor; } ///< Couleur du trafic modéré.
+    void setModerateColor(const QColor& color);
+    QColor heavyColor() const { return m_heavyColor; }    ///< Couleur du trafic dense ou bloqué.
+    void setHeavyColor(const QColor& color);
+    double lineWidth() const { return m_lineWidth; }      ///< Épaisseur à l'écran (pixels).
+    void setLineWidth(double width);
+    double mapZoomLevel() const { return m_mapZoomLevel; } ///< Zoom courant de la carte.
+    void setMapZoomLevel(double zoom);
+    QGeoCoordinate origin() const { return m_origin; }    ///< Coin nord-ouest du tracé (ancrage).
+    double referenceZoom() const { return ReferenceZoom; }
+
+    /**
+     * @brief Sommets réécrits lors de la dernière mise à jour du graphe de scène (diagnostic, tests).
+     */
+    int lastWrittenVertexCount() const { return m_lastWritten; }
+
+    /**
+     * @brief Sommets du niveau de détail dessiné (≤ pointCount() de l'itinéraire).
+     */
+    int drawnPointCount() const { return m_strip.pointCount(); }
+
+signals:
+    void modelChanged();
+    void colorChanged();
+    void lineWidthChanged();
+    void mapZoomLevelChanged();
+    void originChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+
+private slots:
+    void onRouteChanged();
+    void onProgressChanged();
+    void onCongestionChanged();
+
+private:
+    double targetHalfWidth() const;
+    void setLineColor(QColor& target, const QColor& color);
+    void rebuildLevels();
+    void applyLevel(bool levelsChanged);
+    int drawnStart() const;
+
+    QPointer<RouteModel> m_model;    ///< Source du tracé et de la progression.
+    RouteStrip m_strip;              ///< Géométrie du niveau dessiné (mise à jour dans updatePaintNode()).
+    std::vector<double> m_xy;        ///< Tracé complet, en coordonnées de l'élément.
+    std::vector<RouteStrip::Color> m_segmentColors; ///< Couleur de chaque segment du tracé complet.
+    std::vector<std::vector<int>> m_levels; ///< Sommets retenus par niveau (MinLevelZoom à MaxLevelZoom).
+    std::vector<int> m_drawn;        ///< Sommets du niveau dessiné.
+    int m_level = -1;                ///< Niveau dessiné (-1 : aucun).
+    QColor m_color = QColor(0x1d, 0xb7, 0xff);
+    QColor m_moderateColor = QColor(0xff, 0x98, 0x00);
+    QColor m_heavyColor = QColor(0xf4, 0x43, 0x36);
+    double m_lineWidth = 8.0;
+    double m_mapZoomLevel = ReferenceZoom;
+    QGeoCoordinate m_origin;         ///< Coin nord-ouest du tracé.
+    double m_originX = 0.0;          ///< Coin nord-ouest en pixels Web Mercator (ReferenceZoom).
+    double m_originY = 0.0;
+
+    int m_segment = 0;               ///< Segment courant du tracé complet (RouteModel::pathStart()).
+    int m_start = 0;                 ///< Point du niveau dessiné remplacé par le véhicule.
+    double m_headX = 0.0;            ///< Véhicule, en coordonnées de l'élément.
+    double m_headY = 0.0;
+    bool m_geometryDirty = true;     ///< Nouvel itinéraire : tampon à réallouer et réécrire.
+    bool m_headDirty = false;        ///< Progression à appliquer.
+    bool m_colorDirty = true;        ///< Couleurs des sommets à réécrire (trafic, couleurs QML).
+    bool m_widthDirty = false;       ///< Épaisseur à comparer à celle de la bande (zoom stabilisé, lineWidth).
+    QTimer* m_widthTimer = nullptr;  ///< Attente de la fin d'une animation de zoom (mono-coup).
+    int m_lastWritten = 0;
+};
+
+#endif // ROUTEPOLYLINEITEM_H
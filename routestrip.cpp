@@ -0,0 +1,170 @@
+/**
+ * @file routestrip.cpp
+ * @brief Implémentation de la bande de triangles du tracé (normales de raccord, tête mobile).
+ */
+
+#include "routestrip.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void RouteStrip::setPath(std::vector<double> xy)
+{
+    m_xy = std::move(xy);
+    m_xy.resize(m_xy.size() & ~std::size_t(1));
+    const int count = pointCount();
+    m_normals.assign(m_xy.size(), 0.0);
+    m_start = 0;
+    m_headX = count ? m_xy[0] : 0.0;
+    m_headY = count ? m_xy[1] : 0.0;
+    if (count < 2) return;
+
+    // Directions unitaires des segments ; un segment de longueur nulle (sommet répété) reprend
+    // la direction de son voisin.
+    std::vector<double> directions(std::size_t(count - 1) * 2, 0.0);
+    int firstValid = -1;
+    for (int i = 0; i + 1 < count; ++i) {
+        const double dx = m_xy[2 * i + 2] - m_xy[2 * i];
+        const double dy = m_xy[2 * i + 3] - m_xy[2 * i + 1];
+        const double length = std::hypot(dx, dy);
+        if (length > 1e-9) {
+            directions[2 * i] = dx / length;
+            directions[2 * i + 1] = dy / length;
+            if (firstValid < 0) firstValid = i;
+        } else if (i > 0) {
+            directions[2 * i] = directions[2 * i - 2];
+            directions[2 * i + 1] = directions[2 * i - 1];
+        }
+    }
+    if (firstValid < 0) {
+        for (int i = 0; i + 1 < count; ++i) directions[2 * i] = 1.0;
+    }
+    for (int i = 0; i < firstValid; ++i) {
+        directions[2 * i] = directions[2 * firstValid];
+        directions[2 * i + 1] = directions[2 * firstValid + 1];
+    }
+
+    for (int i = 0; i < count; ++i) {
+        // Normale à gauche de la direction : (-dy, dx).
+        const int before = std::max(i - 1, 0);
+        const int after = std::min(i, count - 2);
+        const double nx0 = -directions[2 * before + 1];
+        const double ny0 = directions[2 * before];
+        const double nx1 = -directions[2 * after + 1];
+        const double ny1 = directions[2 * after];
+        double nx = nx0 + nx1;
+        double ny = ny0 + ny1;
+        const double length = std::hypot(nx, ny);
+        if (length < 1e-9) {
+            // Demi-tour : pas de raccord possible, la normale du segment suivant est conservée.
+            nx = nx1;
+            ny = ny1;
+        } else {
+            nx /= length;
+            ny /= length;
+            // Onglet : la bande garde son épaisseur de part et d'autre du virage, sans pointe démesurée.
+            const double scale = std::min(1.0 / std::max(nx * nx1 + ny * ny1, 1e-9), MaxMiterScale);
+            nx *= scale;
+            ny *= scale;
+        }
+        m_normals[2 * i] = nx;
+        m_normals[2 * i + 1] = ny;
+    }
+}
+
+void RouteStrip::setHead(int start, double x, double y)
+{
+    m_start = std::clamp(start, 0, std::max(pointCount() - 1, 0));
+    m_headX = x;
+    m_headY = y;
+}
+
+RouteStrip::Color RouteStrip::segmentColor(int segment) const
+{
+    if (m_colors.empty()) return Color{0, 0, 0, 255};
+    return m_colors[std::size_t(std::clamp(segment, 0, int(m_colors.size()) - 1))];
+}
+
+void RouteStrip::writePoint(int point, double x, double y, double nx, double ny, Vertex* out) const
+{
+    // Positions seules : les couleurs, fixées par writeColors(), restent en place.
+    Vertex* v = out + VerticesPerPoint * point;
+    const float leftX = float(x + nx);
+    const float leftY = float(y + ny);
+    const float rightX = float(x - nx);
+    const float rightY = float(y - ny);
+    v[0].x = v[2].x = leftX;
+    v[0].y = v[2].y = leftY;
+    v[1].x = v[3].x = rightX;
+    v[1].y = v[3].y = rightY;
+}
+
+void RouteStrip::writeCollapsed(int point, Vertex* out) const
+{
+    writePoint(point, m_headX, m_headY, 0.0, 0.0, out);
+}
+
+void RouteStrip::writeHead(Vertex* out) const
+{
+    // Normale de la tête vers le point suivant : la bande part exactement du véhicule.
+    double nx = m_normals[2 * m_start];
+    double ny = m_normals[2 * m_start + 1];
+    if (m_start + 1 < pointCount()) {
+        const double dx = m_xy[2 * m_start + 2] - m_headX;
+        const double dy = m_xy[2 * m_start + 3] - m_headY;
+        const double length = std::hypot(dx, dy);
+        if (length > 1e-9) {
+            nx = -dy / length;
+            ny = dx / length;
+        }
+    }
+    writePoint(m_start, m_headX, m_headY, nx * m_halfWidth, ny * m_halfWidth, out);
+}
+
+void RouteStrip::write(Vertex* out) const
+{
+    const int count = pointCount();
+    if (count == 0) return;
+    for (int i = 0; i < m_start; ++i) writeCollapsed(i, out);
+    writeHead(out);
+    for (int i = m_start + 1; i < count; ++i) {
+        writePoint(i, m_xy[2 * i], m_xy[2 * i + 1], m_normals[2 * i] * m_halfWidth,
+                   m_normals[2 * i + 1] * m_halfWidth, out);
+    }
+    writeColors(out);
+}
+
+void RouteStrip::writeColors(Vertex* out) const
+{
+    const int count = pointCount();
+    for (int i = 0; i < count; ++i) {
+        const Color in = segmentColor(i - 1);
+        const Color leaving = segmentColor(std::min(i, count - 2));
+        Vertex* v = out + VerticesPerPoint * i;
+        for (int k = 0; k < VerticesPerPoint; ++k) {
+            const Color& c = k < 2 ? in : leaving;
+            v[k].r = c.r;
+            v[k].g = c.g;
+            v[k].b = c.b;
+            v[k].a = c.a;
+        }
+    }
+}
+
+int RouteStrip::moveHead(int start, double x, double y, Vertex* out)
+{
+    if (pointCount() == 0) return 0;
+    const int previous = m_start;
+    setHead(start, x, y);
+    if (m_start < previous) {
+        // Recul (nouvel itinéraire côté appelant, progression réinitialisée) : les points déjà
+        // repliés doivent être reconstruits.
+        write(out);
+        return vertexCount();
+    }
+    // Les points dépassés depuis la dernière image sont repliés sur la tête ; ceux repliés avant
+    // restent à l'ancienne position de la tête, les triangles qui les relient sont d'aire nulle.
+    for (int i = previous; i < m_start; ++i) writeCollapsed(i, out);
+    writeHead(out);
+    return VerticesPerPoint * (m_start - previous + 1);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file routestrip.h
+ * @brief Rôle architectural : Tessellation du tracé d'itinéraire en bande de triangles, réécrite sur place.
+ * @details Responsabilités : Transformer une polyligne (coordonnées écran) en sommets colorés de bande de
+ * triangles d'épaisseur donnée, puis faire avancer le début du tracé avec le véhicule en ne réécrivant
+ * que les sommets concernés. Aucun sommet n'est ajouté ni retiré tant que l'itinéraire ne change pas ;
+ * un changement de couleur (trafic) ne réécrit que les couleurs.
+ * Dépendances principales : aucune (le tampon de sommets est celui de RoutePolylineItem).
+ */
+
+#ifndef ROUTESTRIP_H
+#define ROUTESTRIP_H
+
+#include <QtGlobal>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RouteStrip
+ * @brief Bande de triangles d'une polyligne avec un début mobile.
+ * @details Chaque point i de la polyligne donne deux paires de sommets (4i à 4i + 3) de part et d'autre de
+ * la ligne, décalées selon la normale de raccord (onglet borné) : la première porte la couleur du segment
+ * qui arrive au point, la seconde celle du segment qui en part. Les deux paires sont confondues, le
+ * changement de couleur est donc net sans dupliquer de point ni changer le nombre de sommets.
+ * Le tracé affiché commence à la tête (le véhicule), qui remplace le point start() ; les points
+ * précédents sont ramenés sur la tête, ce qui ne produit que des triangles d'aire nulle. Avancer de
+ * k points réécrit 4(k + 1) positions, sans allocation.
+ */
+class RouteStrip {
+public:
+    static constexpr double MaxMiterScale = 4.0; ///< Allongement maximal de la normale dans un virage serré.
+    static constexpr int VerticesPerPoint = 4;   ///< Deux paires (couleur entrante, couleur sortante).
+
+    /**
+     * @struct Color
+     * @brief Couleur RGBA 8 bits, alpha prémultiplié (QSGVertexColorMaterial).
+     */
+    struct Color {
+        quint8 r;
+        quint8 g;
+        quint8 b;
+        quint8 a;
+    };
+
+    /**
+     * @struct Vertex
+     * @brief Sommet écrit dans le tampon (même disposition que QSGGeometry::ColoredPoint2D).
+     */
+    struct Vertex {
+        float x;
+        float y;
+        quint8 r;
+        quint8 g;
+        quint8 b;
+        quint8 a;
+    };
+
+    /**
+     * @brief Remplace la polyligne ; la tête revient sur le premier point.
+     * @param xy Points entrelacés (x0, y0, x1, y1...).
+     */
+    void setPath(std::vector<double> xy);
+
+    /**
+     * @brief Demi-épaisseur du tracé, dans l'unité des points. Prise en compte au prochain write().
+     */
+    void setHalfWidth(double halfWidth) { m_halfWidth = halfWidth; }
+
+    /**
+     * @brief Couleur de chaque segment [i, i + 1] ; les segments absents prennent la dernière couleur fournie
+     *        (ou le noir). Prise en compte au prochain write() ou writeColors().
+     */
+    void setSegmentColors(std::vector<Color> colors) { m_colors = std::move(colors); }
+
+    /**
+     * @brief Place la tête sans écrire de sommet (suivi de write()).
+     */
+    void setHead(int start, double x, double y);
+
+    /**
+     * @brief Écrit les vertexCount() sommets (nouvel itinéraire, nouvelle épaisseur).
+     */
+    void write(Vertex* out) const;
+
+    /**
+     * @brief Réécrit uniquement les couleurs d'un tampon rempli par write() (recoloration du trafic).
+     */
+    void writeColors(Vertex* out) const;
+
+    /**
+     * @brief Déplace la tête et réécrit seulement les sommets concernés dans un tampon déjà rempli par write().
+     * @param start Point remplacé par la tête (segment courant) ; un recul réécrit tout le tampon.
+     * @return Nombre de sommets dont la position a été réécrite (les couleurs ne changent pas).
+     */
+    int moveHead(int start, double x, double y, Vertex* out);
+
+    int pointCount() const { return int(m_xy.size() / 2); }  ///< Points de la polyligne.
+    int vertexCount() const { return VerticesPerPoint * pointCount(); } ///< Sommets de la bande.
+    int start() const { return m_start; }                    ///< Point remplacé par la tête.
+    double halfWidth() const { return m_halfWidth; }         ///< Demi-épaisseur courante.
+
+private:
+    Color segmentColor(int segment) const;
+    void writePoint(int point, double x, double y, double nx, double ny, Vertex* out) const;
+    void writeHead(Vertex* out) const;
+    void writeCollapsed(int point, Vertex* out) const;
+
+    std::vector<double> m_xy;      ///< Points de la polyligne.
+    std::vector<double> m_normals; ///< Normale de raccord unitaire (allongée dans les virages) par point.
+    std::vector<Color> m_colors;   ///< Couleur par segment.
+    double m_halfWidth = 1.0;      ///< Demi-épaisseur.
+    int m_start = 0;               ///< Point remplacé par la tête.
+    double m_headX = 0.0;          ///< Position de la tête.
+    double m_headY = 0.0;
+};
+
+#endif // ROUTESTRIP_H
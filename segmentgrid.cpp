@@ -0,0 +1,77 @@
+/**
+ * @file segmentgrid.cpp
+ * @brief Construction de la grille de segments (parcours des cellules traversées).
+ */
+
+#include "segmentgrid.h"
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+void SegmentGrid::clear()
+{
+    m_cellKeys.clear();
+    m_cellStart.clear();
+    m_segments.clear();
+}
+
+void SegmentGrid::build(const double* xy, int pointCount, double referenceKx, double cellSizeM)
+{
+    clear();
+    m_referenceKx = referenceKx;
+    m_cellSize = cellSizeM;
+    if (!xy || pointCount < 2 || cellSizeM <= 0.0) return;
+
+    std::vector<std::pair<quint64, quint32>> entries;
+    entries.reserve(std::size_t(pointCount) * 2);
+
+    for (int i = 0; i + 1 < pointCount; ++i) {
+        // Extrémités en unités de cellule.
+        const double x0 = xy[2 * i] * referenceKx / cellSizeM;
+        const double y0 = xy[2 * i + 1] / cellSizeM;
+        const double x1 = xy[2 * i + 2] * referenceKx / cellSizeM;
+        const double y1 = xy[2 * i + 3] / cellSizeM;
+
+        // Parcours des cellules traversées (Amanatides-Woo) : un segment de 2 km n'occupe qu'une
+        // vingtaine de cellules, là où sa boîte englobante en couvrirait des centaines.
+        qint64 cx = qint64(std::floor(x0));
+        qint64 cy = qint64(std::floor(y0));
+        const qint64 ex = qint64(std::floor(x1));
+        const qint64 ey = qint64(std::floor(y1));
+        const double dx = x1 - x0;
+        const double dy = y1 - y0;
+        const qint64 stepX = dx >= 0 ? 1 : -1;
+        const qint64 stepY = dy >= 0 ? 1 : -1;
+        const double inf = std::numeric_limits<double>::infinity();
+        const double tDeltaX = dx != 0.0 ? 1.0 / std::abs(dx) : inf;
+        const double tDeltaY = dy != 0.0 ? 1.0 / std::abs(dy) : inf;
+        double tMaxX = dx != 0.0 ? (stepX > 0 ? double(cx + 1) - x0 : x0 - double(cx)) * tDeltaX : inf;
+        double tMaxY = dy != 0.0 ? (stepY > 0 ? double(cy + 1) - y0 : y0 - double(cy)) * tDeltaY : inf;
+
+        entries.emplace_back(key(cx, cy), quint32(i));
+        // Nombre exact de pas : les arrondis ne peuvent ni dépasser la cellule d'arrivée ni boucler.
+        for (qint64 steps = std::llabs(ex - cx) + std::llabs(ey - cy); steps > 0; --steps) {
+            if ((tMaxX < tMaxY && cx != ex) || cy == ey) {
+                cx += stepX;
+                tMaxX += tDeltaX;
+            } else {
+                cy += stepY;
+                tMaxY += tDeltaY;
+            }
+            entries.emplace_back(key(cx, cy), quint32(i));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    m_segments.reserve(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (i == 0 || entries[i].first != entries[i - 1].first) {
+            m_cellKeys.push_back(entries[i].first);
+            m_cellStart.push_back(quint32(i));
+        }
+        m_segments.push_back(entries[i].second);
+    }
+    m_cellStart.push_back(quint32(entries.size()));
+}
@@ -0,0 +1,92 @@
+/**
+ * @file segmentgrid.h
+ * @brief Rôle architectural : Index spatial des segments d'une polyligne (grille uniforme en mètres).
+ * @details Responsabilités : Répertorier chaque segment dans les cellules qu'il traverse pour retrouver
+ * les segments proches d'une position sans parcourir toute la polyligne (itinéraire de RouteModel).
+ * Dépendances principales : aucune (tableaux contigus, recherche dichotomique).
+ */
+
+#ifndef SEGMENTGRID_H
+#define SEGMENTGRID_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * @class SegmentGrid
+ * @brief Grille creuse de cellules carrées, stockée en CSR (clés de cellule triées, segments contigus).
+ * @details Les sommets sont fournis comme dans RouteModel (x = R·lon, y = R·lat, en mètres) ; la grille
+ * travaille dans le plan local (x·kx0, y) où kx0 = cos(latitude de référence). Seules les cellules
+ * traversées sont stockées : une cellule se retrouve par dichotomie, en O(log n).
+ *
+ * Recherche du plus proche voisin : visiter les anneaux de cellules 0, 1, 2... autour de la position
+ * (visitRing) ; après l'anneau r, tout segment non visité est à plus de r · cellSize() dans le plan
+ * de la grille, ce qui borne la recherche.
+ */
+class SegmentGrid {
+public:
+    static constexpr double DefaultCellSizeM = 100.0; ///< Côté d'une cellule (≈ quelques segments urbains).
+
+    /**
+     * @brief Indexe les segments [i, i + 1] d'une polyligne.
+     * @param xy Sommets entrelacés (x0, y0, x1, y1...) en mètres.
+     * @param pointCount Nombre de sommets.
+     * @param referenceKx cos(latitude de référence), facteur d'échelle de x dans le plan de la grille.
+     */
+    void build(const double* xy, int pointCount, double referenceKx, double cellSizeM = DefaultCellSizeM);
+
+    void clear();                                                   ///< Vide l'index.
+    bool isEmpty() const { return m_cellKeys.empty(); }             ///< Aucun segment indexé.
+    int cellCount() const { return int(m_cellKeys.size()); }        ///< Cellules non vides.
+    int entryCount() const { return int(m_segments.size()); }       ///< Couples (cellule, segment).
+    double cellSize() const { return m_cellSize; }                  ///< Côté d'une cellule (m).
+    double referenceKx() const { return m_referenceKx; }            ///< Échelle de x dans la grille.
+
+    /**
+     * @brief Appelle visit(segment) pour chaque segment des cellules de l'anneau `ring`
+     *        (distance de Tchebychev en cellules) autour du point (x, y) du repère des sommets.
+     * @details Un segment traversant plusieurs cellules peut être visité plusieurs fois.
+     */
+    template<typename Visitor>
+    void visitRing(double x, double y, int ring, Visitor&& visit) const
+    {
+        if (isEmpty()) return;
+        const qint64 cx = qint64(std::floor(x * m_referenceKx / m_cellSize));
+        const qint64 cy = qint64(std::floor(y / m_cellSize));
+        if (ring == 0) {
+            visitCell(cx, cy, visit);
+            return;
+        }
+        for (qint64 dx = -ring; dx <= ring; ++dx) {
+            visitCell(cx + dx, cy - ring, visit);
+            visitCell(cx + dx, cy + ring, visit);
+        }
+        for (qint64 dy = -ring + 1; dy <= ring - 1; ++dy) {
+            visitCell(cx - ring, cy + dy, visit);
+            visitCell(cx + ring, cy + dy, visit);
+        }
+    }
+
+private:
+    static quint64 key(qint64 cx, qint64 cy) { return (quint64(quint32(qint32(cx))) << 32) | quint32(qint32(cy)); }
+
+    template<typename Visitor>
+    void visitCell(qint64 cx, qint64 cy, Visitor& visit) const
+    {
+        const quint64 k = key(cx, cy);
+        const auto it = std::lower_bound(m_cellKeys.begin(), m_cellKeys.end(), k);
+        if (it == m_cellKeys.end() || *it != k) return;
+        const std::size_t cell = std::size_t(it - m_cellKeys.begin());
+        for (quint32 i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) visit(int(m_segments[i]));
+    }
+
+    std::vector<quint64> m_cellKeys;   ///< Cellules non vides, triées.
+    std::vector<quint32> m_cellStart;  ///< Début des segments de chaque cellule (taille cellCount + 1).
+    std::vector<quint32> m_segments;   ///< Segments, regroupés par cellule.
+    double m_cellSize = DefaultCellSizeM; ///< Côté d'une cellule (m).
+    double m_referenceKx = 1.0;        ///< cos(latitude de référence).
+};
+
+#endif // SEGMENTGRID_H
@@ -9,46 +9,180 @@
 #include "telemetrydata.h"
 #include <QtGlobal>
 #include <QtMath>
+#include <QThread>
+#include <QMetaObject>
+#include <chrono>
+
+namespace {
+// qFuzzyCompare est utilisé pour comparer des nombres à virgule flottante (double)
+// afin d'éviter des faux positifs liés aux imprécisions mathématiques de l'ordinateur.
+bool sameValue(double a, double b) { return qFuzzyCompare(a, b); }
+bool sameValue(bool a, bool b) { return a == b; }
+bool sameValue(int a, int b) { return a == b; }
+
+// Copie dans @p into les champs @p fields de @p values (le plus récent gagne).
+void mergeFields(TelemetrySnapshot& into, const TelemetrySnapshot& values, TelemetryData::Fields fields)
+{
+    if (fields.testFlag(TelemetryData::SpeedKmhField)) into.speedKmh = values.speedKmh;
+    if (fields.testFlag(TelemetryData::GpsOkField)) into.gpsOk = values.gpsOk;
+    if (fields.testFlag(TelemetryData::LatField)) into.lat = values.lat;
+    if (fields.testFlag(TelemetryData::LonField)) into.lon = values.lon;
+    if (fields.testFlag(TelemetryData::HeadingField)) into.heading = values.heading;
+    if (fields.testFlag(TelemetryData::SatellitesField)) into.satellites = values.satellites;
+    if (fields.testFlag(TelemetryData::HdopField)) into.hdop = values.hdop;
+}
+}
 
 TelemetryData::TelemetryData(QObject* parent) : QObject(parent)
 {
-    // L'initialisation se fait via les valeurs par défaut dans le fichier d'en-tête (.h)
+    // L'initialisation se fait via les valeurs par défaut de TelemetrySnapshot (.h)
+    qRegisterMetaType<TelemetrySnapshot>("TelemetrySnapshot");
+    qRegisterMetaType<TelemetryData::Fields>("TelemetryData::Fields");
 }
 
-void TelemetryData::setSpeedKmh(double v) {
-    // qFuzzyCompare est utilisé pour comparer des nombres à virgule flottante (double)
-    // afin d'éviter des faux positifs liés aux imprécisions mathématiques de l'ordinateur.
-    if (qFuzzyCompare(m_speedKmh, v)) return;
+TelemetryData::Fields TelemetryData::applyUpdate(const TelemetrySnapshot& update, Fields fields) {
+    Fields dirty;
+
+    // 1. Validation : on n'enregistre que les champs fournis ET réellement modifiés.
+    if (fields.testFlag(SpeedKmhField) && !sameValue(m_snapshot.speedKmh, update.speedKmh)) {
+        m_snapshot.speedKmh = update.speedKmh;
+        dirty |= SpeedKmhField;
+    }
+    if (fields.testFlag(GpsOkField) && !sameValue(m_snapshot.gpsOk, update.gpsOk)) {
+        m_snapshot.gpsOk = update.gpsOk;
+        dirty |= GpsOkField;
+    }
+    if (fields.testFlag(LatField) && !sameValue(m_snapshot.lat, update.lat)) {
+        m_snapshot.lat = update.lat;
+        dirty |= LatField;
+    }
+    if (fields.testFlag(LonField) && !sameValue(m_snapshot.lon, update.lon)) {
+        m_snapshot.lon = update.lon;
+        dirty |= LonField;
+    }
+    if (fields.testFlag(HeadingField) && !sameValue(m_snapshot.heading, update.heading)) {
+        m_snapshot.heading = update.heading;
+        dirty |= HeadingField;
+    }
+    if (fields.testFlag(SatellitesField) && !sameValue(m_snapshot.satellites, update.satellites)) {
+        m_snapshot.satellites = update.satellites;
+        dirty |= SatellitesField;
+    }
+    if (fields.testFlag(HdopField) && !sameValue(m_snapshot.hdop, update.hdop)) {
+        m_snapshot.hdop = update.hdop;
+        dirty |= HdopField;
+    }
+
+    if (!dirty) return dirty;
 
-    m_speedKmh = v;
-    emit speedKmhChanged(); // Notifie l'UI (QML/C++) de la nouvelle valeur
+    // 2. Notification : l'état est déjà entièrement cohérent quand les slots s'exécutent.
+    if (dirty.testFlag(SpeedKmhField)) emit speedKmhChanged();
+    if (dirty.testFlag(GpsOkField)) emit gpsOkChanged();
+    if (dirty.testFlag(LatField)) emit latChanged();
+    if (dirty.testFlag(LonField)) emit lonChanged();
+    if (dirty.testFlag(HeadingField)) emit headingChanged();
+    if (dirty.testFlag(SatellitesField)) emit satellitesChanged();
+    if (dirty.testFlag(HdopField)) emit hdopChanged();
+
+    emit snapshotChanged(dirty); // Un seul signal agrégé par tick producteur
+    return dirty;
 }
 
-void TelemetryData::setGpsOk(bool v) {
-    // Si la valeur est identique à l'actuelle, on ne fait rien
-    if (m_gpsOk == v) return;
+void TelemetryData::setSpeedKmh(double v) {
+    TelemetrySnapshot update = m_snapshot;
+    update.speedKmh = v;
+    applyUpdate(update, SpeedKmhField);
+}
 
-    m_gpsOk = v;
-    emit gpsOkChanged();
+void TelemetryData::setGpsOk(bool v) {
+    TelemetrySnapshot update = m_snapshot;
+    update.gpsOk = v;
+    applyUpdate(update, GpsOkField);
 }
 
 void TelemetryData::setLat(double v) {
-    if (qFuzzyCompare(m_lat, v)) return;
-
-    m_lat = v;
-    emit latChanged();
+    TelemetrySnapshot update = m_snapshot;
+    update.lat = v;
+    applyUpdate(update, LatField);
 }
 
 void TelemetryData::setLon(double v) {
-    if (qFuzzyCompare(m_lon, v)) return;
-
-    m_lon = v;
-    emit lonChanged();
+    TelemetrySnapshot update = m_snapshot;
+    update.lon = v;
+    applyUpdate(update, LonField);
 }
 
 void TelemetryData::setHeading(double v) {
-    if (qFuzzyCompare(m_heading, v)) return;
+    TelemetrySnapshot update = m_snapshot;
+    update.heading = v;
+    applyUpdate(update, HeadingField);
+}
+
+void TelemetryData::setSatellites(int v) {
+    TelemetrySnapshot update = m_snapshot;
+    update.satellites = v;
+    applyUpdate(update, SatellitesField);
+}
+
+void TelemetryData::setHdop(double v) {
+    TelemetrySnapshot update = m_snapshot;
+    update.hdop = v;
+    applyUpdate(update, HdopField);
+}
+
+qint64 TelemetryData::monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool TelemetryData::publish(SampleSource source, const TelemetrySnapshot& values, Fields fields) {
+    TelemetrySample sample;
+    sample.sequence = m_sequence[source].fetch_add(1, std::memory_order_relaxed) + 1;
+    sample.timestampNs = monotonicNowNs();
+    sample.fields = static_cast<quint32>(fields);
+    sample.values = values;
+
+    if (QThread::currentThread() == thread()) {
+        // Producteur déjà dans le thread GUI : application directe, sans latence de boucle d'événements.
+        // Ce qui attend en file est fusionné d'abord (jamais dans le désordre), puis la mesure par-dessus :
+        // une seule transaction, donc un seul snapshotChanged().
+        TelemetrySnapshot merged = m_snapshot;
+        const Fields pending = takePendingSamples(merged);
+        mergeFields(merged, values, fields);
+        m_lastSample[source] = sample;
+        applyUpdate(merged, pending | fields);
+        return true;
+    }
+
+    // Producteur sur un thread capteur : dépôt sans verrou, le thread GUI appliquera plus tard.
+    if (!m_rings[source].push(sample)) return false;
+
+    // Un seul vidage planifié à la fois, quel que soit le nombre d'échantillons déposés entre-temps.
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &TelemetryData::drainSamples, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void TelemetryData::drainSamples() {
+    TelemetrySnapshot merged = m_snapshot;
+    const Fields mergedFields = takePendingSamples(merged);
+    if (mergedFields) applyUpdate(merged, mergedFields);
+}
+
+TelemetryData::Fields TelemetryData::takePendingSamples(TelemetrySnapshot& merged) {
+    // Réarmé avant de lire les files : un dépôt concurrent replanifiera un vidage au lieu d'être oublié.
+    m_drainScheduled.store(false, std::memory_order_release);
 
-    m_heading = v;
-    emit headingChanged();
+    Fields mergedFields;
+    TelemetrySample sample;
+    for (int source = 0; source < SourceCount; ++source) {
+        while (m_rings[source].pop(sample)) {
+            const Fields f = Fields::fromInt(sample.fields);
+            mergeFields(merged, sample.values, f);
+            mergedFields |= f;
+            m_lastSample[source] = sample;
+        }
+    }
+    return mergedFields;
 }
@@ -9,12 +9,44 @@
 #pragma once
 #include <QObject>
 #include <QVariantList>
+#include <QMetaType>
+#include <atomic>
+#include "telemetryring.h"
+
+/**
+ * @struct TelemetrySnapshot
+ * @brief Instantané cohérent de toutes les mesures véhicule à un instant donné.
+ * @details Sert à la fois de valeur d'entrée pour TelemetryData::applyUpdate()
+ * (les producteurs remplissent les champs qu'ils connaissent) et de valeur de lecture
+ * pour les consommateurs qui veulent un état complet sans lectures champ par champ.
+ */
+struct TelemetrySnapshot {
+    double speedKmh = 0.0;   ///< Vitesse en km/h
+    bool gpsOk = true;       ///< État de la connexion GPS
+    double lat = 48.8566;    ///< Latitude (Par défaut: Paris)
+    double lon = 2.3522;     ///< Longitude (Par défaut: Paris)
+    double heading = 0.0;    ///< Cap en degrés (0 à 360)
+    int satellites = -1;     ///< Satellites utilisés par le récepteur (-1 : inconnu)
+    double hdop = -1.0;      ///< Dilution horizontale de précision (-1 : inconnue)
+};
+Q_DECLARE_METATYPE(TelemetrySnapshot)
+
+/**
+ * @struct TelemetrySample
+ * @brief Échantillon horodaté transporté d'un thread capteur vers le thread GUI.
+ */
+struct TelemetrySample {
+    quint64 sequence = 0;          ///< Numéro de séquence propre à la source (1, 2, 3...). Un trou = perte.
+    qint64 timestampNs = 0;        ///< Instant de production (horloge monotone, nanosecondes).
+    quint32 fields = 0;            ///< Champs renseignés (masque de TelemetryData::Field).
+    TelemetrySnapshot values;      ///< Valeurs mesurées.
+};
 
 /**
  * @class TelemetryData
  * @brief Classe représentant les données en temps réel du véhicule.
  * Cette classe hérite de QObject et centralise les mesures runtime du véhicule.
- * Les modules producteurs (GPS, IMU, etc.) écrivent via les setters,
+ * Les modules producteurs (GPS, IMU, etc.) écrivent via applyUpdate() (ou les setters unitaires),
  * tandis que les consommateurs UI réagissent aux signaux de changement associés.
  */
 class TelemetryData : public QObject {
@@ -26,6 +58,40 @@ class TelemetryData : public QObject {
     // (QObject + signaux), ce qui évite de dépendre d'un binding QML global.
 
 public:
+    /**
+     * @brief Bits de modification ("dirty bits") identifiant les champs d'un instantané.
+     * @details Utilisés en entrée d'applyUpdate() pour désigner les champs fournis par le producteur,
+     * et en sortie (signal snapshotChanged) pour indiquer les champs réellement modifiés.
+     */
+    enum Field : quint32 {
+        NoField        = 0x00,
+        SpeedKmhField  = 0x01,  ///< TelemetrySnapshot::speedKmh
+        GpsOkField     = 0x02,  ///< TelemetrySnapshot::gpsOk
+        LatField       = 0x04,  ///< TelemetrySnapshot::lat
+        LonField       = 0x08,  ///< TelemetrySnapshot::lon
+        HeadingField   = 0x10,  ///< TelemetrySnapshot::heading
+        SatellitesField = 0x20, ///< TelemetrySnapshot::satellites
+        HdopField      = 0x40,  ///< TelemetrySnapshot::hdop
+        PositionFields = LatField | LonField,
+        GnssQualityFields = SatellitesField | HdopField,
+        AllFields      = SpeedKmhField | GpsOkField | LatField | LonField | HeadingField | GnssQualityFields
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+    Q_FLAG(Fields)
+
+    /**
+     * @brief Identifiant des producteurs disposant chacun de leur propre file sans verrou.
+     */
+    enum SampleSource {
+        GpsSource = 0,   ///< Récepteur GNSS (GpsTelemetrySource)
+        ImuSource,       ///< Centrale inertielle (Mpu9250Source)
+        FusionSource,    ///< Position fusionnée GPS/IMU (DeadReckoning)
+        SourceCount
+    };
+
+    /** @brief Capacité de chaque file producteur (≈ 1,3 s d'IMU à 200 Hz). */
+    static constexpr std::size_t RingCapacity = 256;
+
     /**
      * @brief Constructeur par défaut de TelemetryData.
      * @param parent Objet parent pour la gestion automatique de la mémoire (QObject tree).
@@ -33,26 +99,89 @@ public:
     explicit TelemetryData(QObject* parent = nullptr);
 
     // --- GETTERS (Accesseurs) ---
-    double speedKmh() const { return m_speedKmh; }   ///< Retourne la vitesse actuelle en km/h.
-    bool gpsOk() const { return m_gpsOk; }           ///< Retourne true si le signal GPS est valide.
-    double lat() const { return m_lat; }             ///< Retourne la latitude actuelle en degrés.
-    double lon() const { return m_lon; }             ///< Retourne la longitude actuelle en degrés.
-    double heading() const { return m_heading; }     ///< Retourne le cap actuel du véhicule en degrés (0 = Nord).
+    double speedKmh() const { return m_snapshot.speedKmh; }   ///< Retourne la vitesse actuelle en km/h.
+    bool gpsOk() const { return m_snapshot.gpsOk; }           ///< Retourne true si le signal GPS est valide.
+    double lat() const { return m_snapshot.lat; }             ///< Retourne la latitude actuelle en degrés.
+    double lon() const { return m_snapshot.lon; }             ///< Retourne la longitude actuelle en degrés.
+    double heading() const { return m_snapshot.heading; }     ///< Retourne le cap actuel du véhicule en degrés (0 = Nord).
+    int satellites() const { return m_snapshot.satellites; }  ///< Retourne le nombre de satellites utilisés (-1 : inconnu).
+    double hdop() const { return m_snapshot.hdop; }           ///< Retourne la dilution horizontale de précision (-1 : inconnue).
+    const TelemetrySnapshot& snapshot() const { return m_snapshot; } ///< Retourne l'état complet courant.
+
+    /**
+     * @brief Applique en une seule transaction tous les champs fournis par un producteur.
+     * @details Les valeurs sont d'abord toutes enregistrées, puis les signaux unitaires sont émis,
+     * puis un unique snapshotChanged() : un consommateur ne voit donc jamais un état à moitié
+     * mis à jour (ex: latitude nouvelle mais longitude ancienne).
+     * @param update Valeurs proposées (seuls les champs cités dans @p fields sont lus).
+     * @param fields Champs renseignés par le producteur pour ce tick.
+     * @return Champs réellement modifiés (vide si rien n'a changé, aucun signal émis dans ce cas).
+     */
+    Fields applyUpdate(const TelemetrySnapshot& update, Fields fields);
+
+    /**
+     * @brief Publie une mesure depuis n'importe quel thread (un seul thread producteur par source).
+     * @details Depuis le thread propriétaire de TelemetryData, la mesure est appliquée immédiatement,
+     * dans la même transaction que les échantillons déjà en file (fusionnés avant elle, pour conserver
+     * l'ordre) : un seul snapshotChanged() pour les deux. Depuis un thread capteur,
+     * l'échantillon est horodaté, numéroté et déposé dans la file sans verrou de la source ;
+     * un unique vidage est alors planifié dans la boucle d'événements du thread GUI.
+     * Ne bloque jamais : si la file est pleine, l'échantillon est perdu et comptabilisé.
+     * @param source Producteur émetteur.
+     * @param values Valeurs mesurées.
+     * @param fields Champs renseignés dans @p values.
+     * @return false si l'échantillon a été perdu (file pleine).
+     */
+    bool publish(SampleSource source, const TelemetrySnapshot& values, Fields fields);
+
+    /**
+     * @brief Dernier échantillon appliqué pour une source (séquence et horodatage inclus).
+     * @param source Producteur concerné.
+     */
+    TelemetrySample lastSample(SampleSource source) const { return m_lastSample[source]; }
+
+    /**
+     * @brief Nombre d'échantillons perdus pour une source (file pleine côté producteur).
+     * @param source Producteur concerné.
+     */
+    quint64 droppedSamples(SampleSource source) const { return m_rings[source].droppedCount(); }
+
+    /**
+     * @brief Horloge monotone utilisée pour horodater les échantillons (nanosecondes).
+     */
+    static qint64 monotonicNowNs();
 
 public slots:
     // --- SETTERS (Modificateurs) ---
     // Ces méthodes peuvent être appelées dynamiquement, y compris depuis QML.
+    // Chaque setter est une transaction applyUpdate() d'un seul champ.
 
     void setSpeedKmh(double v);
     void setGpsOk(bool v);
     void setLat(double v);
     void setLon(double v);
     void setHeading(double v);
+    void setSatellites(int v);
+    void setHdop(double v);
+
+    /**
+     * @brief Vide les files de toutes les sources et applique leur contenu en une seule transaction.
+     * @details Doit être appelé depuis le thread propriétaire (planifié automatiquement par publish()).
+     * Les échantillons sont fusionnés champ par champ (le plus récent gagne) : un seul snapshotChanged
+     * est émis par vidage, quel que soit le nombre d'échantillons accumulés.
+     */
+    void drainSamples();
 
 signals:
     // --- SIGNAUX DE NOTIFICATION ---
     // Émis uniquement en cas de changement effectif de valeur.
 
+    /**
+     * @brief Notifie qu'une transaction a modifié au moins un champ (un seul signal par tick producteur).
+     * @param dirty Champs modifiés par la transaction.
+     */
+    void snapshotChanged(TelemetryData::Fields dirty);
+
     /** @brief Notifie une mise à jour de la vitesse véhicule (km/h). */
     void speedKmhChanged();
 
@@ -68,11 +197,27 @@ signals:
     /** @brief Notifie une mise à jour de cap/heading. */
     void headingChanged();
 
+    /** @brief Notifie un changement du nombre de satellites utilisés. */
+    void satellitesChanged();
+
+    /** @brief Notifie une mise à jour de la dilution horizontale de précision. */
+    void hdopChanged();
+
 private:
+    /**
+     * @brief Retire les échantillons en file et les fusionne dans @p merged (thread propriétaire).
+     * @return Champs fournis par les échantillons retirés.
+     */
+    Fields takePendingSamples(TelemetrySnapshot& merged);
+
     // --- VARIABLES INTERNES ---
-    double m_speedKmh = 0.0;           ///< Vitesse en km/h
-    bool m_gpsOk = true;               ///< État de la connexion GPS
-    double m_lat = 48.8566;            ///< Latitude (Par défaut: Paris)
-    double m_lon = 2.3522;             ///< Longitude (Par défaut: Paris)
-    double m_heading = 0.0;            ///< Cap en degrés (0 à 360)
+    TelemetrySnapshot m_snapshot;      ///< État courant (valeurs par défaut dans TelemetrySnapshot)
+
+    // --- TRANSPORT INTER-THREADS ---
+    TelemetryRing<TelemetrySample, RingCapacity> m_rings[SourceCount];  ///< Une file SPSC par source.
+    std::atomic<quint64> m_sequence[SourceCount] = {};                   ///< Compteurs de séquence (écrits par le producteur).
+    std::atomic<bool> m_drainScheduled{false};                           ///< Évite d'empiler plusieurs vidages planifiés.
+    TelemetrySample m_lastSample[SourceCount];                           ///< Dernier échantillon appliqué par source (thread GUI).
 };
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TelemetryData::Fields)
@@ -0,0 +1,67 @@
+/**
+ * @file telemetryframepacer.cpp
+ * @brief Implémentation du cadenceur de télémétrie aligné sur le rendu QML.
+ * @details La fin de rendu est détectée via QQuickWindow::afterRendering : contrairement à frameSwapped,
+ * ce signal est aussi émis par la fenêtre hors-écran d'un QQuickWidget (rendu via QQuickRenderControl).
+ * Avec une boucle de rendu threadée, il est émis depuis le thread de rendu et la connexion
+ * automatique le remet dans le thread GUI.
+ */
+
+#include "telemetryframepacer.h"
+#include <QQuickWindow>
+#include <QTimer>
+
+TelemetryFramePacer::TelemetryFramePacer(QObject* parent)
+    : QObject(parent)
+{
+    m_watchdog = new QTimer(this);
+    m_watchdog->setSingleShot(true);
+    m_watchdog->setInterval(100);
+    connect(m_watchdog, &QTimer::timeout, this, &TelemetryFramePacer::onFrameRendered);
+}
+
+void TelemetryFramePacer::attachWindow(QQuickWindow* window) {
+    if (m_window) disconnect(m_window, nullptr, this, nullptr);
+    m_window = window;
+    if (m_window) {
+        connect(m_window, &QQuickWindow::afterRendering,
+                this, &TelemetryFramePacer::onFrameRendered);
+    }
+}
+
+void TelemetryFramePacer::setWatchdogInterval(int ms) {
+    m_watchdog->setInterval(ms);
+}
+
+void TelemetryFramePacer::submit(const TelemetrySnapshot& snapshot, TelemetryData::Fields dirty) {
+    if (!dirty) return;
+    ++m_submitted;
+
+    // Une valeur encore en attente est écrasée : elle n'aurait jamais été visible à l'écran.
+    if (m_pendingDirty) ++m_dropped;
+    m_pending = snapshot;
+    m_pendingDirty |= dirty;
+
+    // Aucune image en cours : on livre tout de suite pour ne pas ajouter de latence.
+    if (!m_frameInFlight) deliverPending();
+}
+
+void TelemetryFramePacer::onFrameRendered() {
+    if (!m_frameInFlight) return; // Image sans rapport avec une livraison (animation, zoom...)
+    m_watchdog->stop();
+    m_frameInFlight = false;
+    if (m_pendingDirty) deliverPending();
+}
+
+void TelemetryFramePacer::deliverPending() {
+    const TelemetryData::Fields dirty = m_pendingDirty;
+    m_pendingDirty = TelemetryData::NoField;
+
+    // Le créneau est réservé avant l'émission : une soumission réentrante sera coalescée.
+    m_frameInFlight = true;
+    m_watchdog->start();
+    ++m_delivered;
+
+    emit frameReady(m_pending, dirty);
+    if (m_window) m_window->update(); // Garantit qu'une image suivra bien cette livraison
+}
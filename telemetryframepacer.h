@@ -0,0 +1,93 @@
+/**
+ * @file telemetryframepacer.h
+ * @brief Rôle architectural : Étage de livraison cadencé entre TelemetryData et la scène QML.
+ * @details Responsabilités : Accumuler les instantanés télémétriques produits par les capteurs
+ * et ne les livrer à la carte qu'au plus une fois par image effectivement rendue, en écrasant
+ * les valeurs intermédiaires devenues obsolètes.
+ * Dépendances principales : QQuickWindow (signal de fin de rendu), QTimer et TelemetryData.
+ */
+
+#ifndef TELEMETRYFRAMEPACER_H
+#define TELEMETRYFRAMEPACER_H
+
+#include <QObject>
+#include <QPointer>
+#include "telemetrydata.h"
+
+class QQuickWindow;
+class QTimer;
+
+/**
+ * @class TelemetryFramePacer
+ * @brief Coalesce les mises à jour télémétriques au rythme du rendu de la carte.
+ * @details Tant qu'aucune image n'est en cours, une mise à jour est livrée immédiatement (latence nulle).
+ * Ensuite, les mises à jour reçues avant la fin du rendu de l'image sont fusionnées (dernière valeur gagnante,
+ * union des bits de modification) et livrées en bloc dès que la fenêtre QML signale la fin du rendu.
+ * Un chien de garde débloque la livraison si aucune image n'est produite (fenêtre masquée,
+ * propriété inchangée qui n'invalide pas la scène, etc.).
+ */
+class TelemetryFramePacer : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructeur du cadenceur.
+     * @param parent Objet parent pour la gestion mémoire.
+     */
+    explicit TelemetryFramePacer(QObject* parent = nullptr);
+
+    /**
+     * @brief Associe la fenêtre QML dont le rendu cadence les livraisons.
+     * @param window Fenêtre de la scène (ex: QQuickWidget::quickWindow()). nullptr = cadence du chien de garde seule.
+     */
+    void attachWindow(QQuickWindow* window);
+
+    /**
+     * @brief Soumet un nouvel instantané à livrer.
+     * @param snapshot État télémétrique complet courant.
+     * @param dirty Champs modifiés depuis la soumission précédente.
+     */
+    void submit(const TelemetrySnapshot& snapshot, TelemetryData::Fields dirty);
+
+    /**
+     * @brief Définit le délai maximal d'attente d'une image avant livraison forcée.
+     * @param ms Délai en millisecondes (100 ms par défaut).
+     */
+    void setWatchdogInterval(int ms);
+
+    quint64 submittedCount() const { return m_submitted; }  ///< Nombre d'instantanés soumis.
+    quint64 deliveredCount() const { return m_delivered; }  ///< Nombre de livraisons effectives vers la scène.
+    quint64 droppedCount() const { return m_dropped; }      ///< Nombre d'instantanés écrasés avant livraison.
+
+signals:
+    /**
+     * @brief Livraison cadencée d'un instantané vers la scène.
+     * @param snapshot Dernier état connu.
+     * @param dirty Union des champs modifiés depuis la livraison précédente.
+     */
+    void frameReady(const TelemetrySnapshot& snapshot, TelemetryData::Fields dirty);
+
+private slots:
+    /**
+     * @brief Appelé quand la fenêtre a terminé le rendu d'une image (ou par le chien de garde).
+     * Libère le créneau de livraison et transmet la mise à jour en attente s'il y en a une.
+     */
+    void onFrameRendered();
+
+private:
+    /**
+     * @brief Livre l'instantané en attente et réserve le créneau jusqu'à la prochaine image.
+     */
+    void deliverPending();
+
+    QPointer<QQuickWindow> m_window;                ///< Fenêtre QML cadençant les livraisons.
+    QTimer* m_watchdog = nullptr;                   ///< Livraison forcée si aucune image n'arrive.
+    TelemetrySnapshot m_pending;                    ///< Dernier instantané soumis.
+    TelemetryData::Fields m_pendingDirty;           ///< Champs modifiés non encore livrés.
+    bool m_frameInFlight = false;                   ///< true entre une livraison et la fin de l'image correspondante.
+
+    quint64 m_submitted = 0;                        ///< Compteur de soumissions.
+    quint64 m_delivered = 0;                        ///< Compteur de livraisons.
+    quint64 m_dropped = 0;                          ///< Compteur de valeurs intermédiaires écrasées.
+};
+
+#endif // TELEMETRYFRAMEPACER_H
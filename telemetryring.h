@@ -0,0 +1,83 @@
+/**
+ * @file telemetryring.h
+ * @brief Rôle architectural : File circulaire sans verrou reliant un thread capteur au thread GUI.
+ * @details Responsabilités : Transporter des échantillons de taille fixe d'un unique producteur
+ * (thread d'acquisition) vers un unique consommateur (thread GUI) sans mutex ni allocation,
+ * afin qu'un blocage d'entrée/sortie côté capteur ne se propage jamais à l'interface.
+ * Dépendances principales : std::atomic (ordre acquire/release), std::array.
+ */
+
+#ifndef TELEMETRYRING_H
+#define TELEMETRYRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class TelemetryRing
+ * @brief File SPSC (Single-Producer / Single-Consumer) lock-free à capacité fixe.
+ * @details Contrat d'utilisation : push() n'est appelé que depuis un seul thread producteur et pop()
+ * que depuis un seul thread consommateur. Les deux index sont placés sur des lignes de cache distinctes
+ * pour éviter le faux partage entre les deux cœurs. Quand la file est pleine, push() refuse l'échantillon
+ * (le producteur ne bloque jamais) et le compteur de pertes est incrémenté.
+ * @tparam T Type d'échantillon (copiable, de préférence trivial).
+ * @tparam Capacity Nombre d'emplacements, obligatoirement une puissance de deux.
+ */
+template <typename T, std::size_t Capacity>
+class TelemetryRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "TelemetryRing: la capacite doit etre une puissance de deux");
+
+public:
+    /**
+     * @brief Ajoute un échantillon (côté producteur uniquement).
+     * @param value Échantillon à copier dans la file.
+     * @return false si la file est pleine (échantillon perdu et comptabilisé).
+     */
+    bool push(const T& value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_buffer[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release); // Publie l'échantillon au consommateur
+        return true;
+    }
+
+    /**
+     * @brief Retire l'échantillon le plus ancien (côté consommateur uniquement).
+     * @param out Reçoit l'échantillon retiré.
+     * @return false si la file est vide.
+     */
+    bool pop(T& out) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head) return false;
+        out = m_buffer[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release); // Libère l'emplacement pour le producteur
+        return true;
+    }
+
+    /** @brief Nombre approximatif d'échantillons en attente (exact si appelé par l'un des deux threads). */
+    std::size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }                ///< true si aucun échantillon n'est en attente.
+    static constexpr std::size_t capacity() { return Capacity; } ///< Capacité fixe de la file.
+
+    /** @brief Nombre total d'échantillons refusés car la file était pleine. */
+    std::uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_head{0};      ///< Prochain emplacement à écrire (producteur).
+    alignas(64) std::atomic<std::size_t> m_tail{0};      ///< Prochain emplacement à lire (consommateur).
+    alignas(64) std::atomic<std::uint64_t> m_dropped{0}; ///< Échantillons perdus (file pleine).
+    std::array<T, Capacity> m_buffer{};                  ///< Stockage des échantillons.
+};
+
+#endif // TELEMETRYRING_H
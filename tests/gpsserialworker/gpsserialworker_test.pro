@@ -0,0 +1,24 @@
+QT += testlib core serialport
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = gpsserialworker_test
+
+# openpty() (pseudo-terminaux du récepteur simulé)
+linux: LIBS += -lutil
+
+SOURCES += \
+    tst_gpsserialworker.cpp \
+    ../../gpsserialworker.cpp \
+    ../../nmeaparser.cpp \
+    ../../ubxprotocol.cpp \
+    ../../telemetrydata.cpp
+
+HEADERS += \
+    ../../gpsserialworker.h \
+    ../../nmeaparser.h \
+    ../../ubxprotocol.h \
+    ../../telemetrydata.h \
+    ../../telemetryring.h \
+    ../../gpsfix.h \
+    ../../imusample.h
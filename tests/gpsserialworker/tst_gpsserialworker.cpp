@@ -0,0 +1,183 @@
+#include <QtTest>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "../../gpsserialworker.h"
+
+#ifdef Q_OS_LINUX
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace {
+QByteArray withChecksum(const QByteArray& body)
+{
+    unsigned char sum = 0;
+    for (char c : body) sum ^= static_cast<unsigned char>(c);
+    return "$" + body + "*" + QByteArray::number(sum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+#ifdef Q_OS_LINUX
+// Récepteur simulé derrière un pseudo-terminal : le lien symbolique joue le rôle du nœud /dev
+// créé par udev. Les réglages termios d'un pty sont partagés entre maître et esclave, ce qui permet
+// d'émettre des phrases valides au bon débit et du bruit (comme un vrai UART) aux autres.
+class FakeReceiver : public QObject
+{
+public:
+    FakeReceiver(const QString& linkPath, int baud) : m_linkPath(linkPath), m_baud(baud)
+    {
+        m_timer.setInterval(100);
+        QObject::connect(&m_timer, &QTimer::timeout, this, [this]() { emitEpoch(); });
+    }
+    ~FakeReceiver() override { unplug(); }
+
+    bool plug()
+    {
+        char slaveName[256] = {};
+        if (::openpty(&m_master, &m_slave, slaveName, nullptr, nullptr) != 0) return false;
+        QFile::remove(m_linkPath);
+        if (!QFile::link(QString::fromLocal8Bit(slaveName), m_linkPath)) return false;
+        m_timer.start();
+        return true;
+    }
+
+    void unplug()
+    {
+        m_timer.stop();
+        QFile::remove(m_linkPath);
+        if (m_slave >= 0) ::close(m_slave);
+        if (m_master >= 0) ::close(m_master);
+        m_slave = m_master = -1;
+    }
+
+private:
+    static speed_t speedFor(int baud)
+    {
+        switch (baud) {
+        case 9600: return B9600;
+        case 38400: return B38400;
+        case 115200: return B115200;
+        default: return B0;
+        }
+    }
+
+    void emitEpoch()
+    {
+        termios settings{};
+        if (::tcgetattr(m_master, &settings) != 0) return;
+        QByteArray bytes;
+        if (cfgetispeed(&settings) == speedFor(m_baud)) {
+            bytes = withChecksum("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,")
+                  + withChecksum("GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W");
+        } else {
+            // Octets échantillonnés au mauvais débit : ni '$' bien formé ni somme de contrôle.
+            bytes = QByteArray("\xF0\x3C\x8E\x00\xFC\x1E\x66\x98\xE0\x7F", 10).repeated(8);
+        }
+        if (::write(m_master, bytes.constData(), size_t(bytes.size())) < 0) return;
+    }
+
+    QString m_linkPath;
+    int m_baud = 9600;
+    int m_master = -1;
+    int m_slave = -1;
+    QTimer m_timer;
+};
+#endif
+}
+
+class GpsSerialWorkerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void start_receiverAtOtherBaud_detectsRate();
+    void deviceUnplugged_reappears_reconnectsWithoutRestart();
+};
+
+void GpsSerialWorkerTest::start_receiverAtOtherBaud_detectsRate()
+{
+    // Objectif: vérifier que la détection essaie les débits candidats et retient celui qui produit des phrases intègres.
+    // Pourquoi: un module configuré à 38400 bauds lu à 9600 ne produit que du bruit ; auparavant il
+    //           fallait connaître et saisir le bon débit, sinon le GPS restait muet sans diagnostic.
+    // Procédure détaillée:
+    //   1) Récepteur simulé émettant des phrases valides seulement à 38400 bauds (bruit sinon).
+    //   2) Démarrage avec 9600 bauds comme débit préféré.
+    //   3) Attente de connected(38400) puis de données transmises par dataReceived().
+    //   4) Contrôle des compteurs (au moins deux débits essayés, octets comptés).
+#ifndef Q_OS_LINUX
+    QSKIP("Pseudo-terminaux requis (Linux).");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString link = dir.filePath(QStringLiteral("gps0"));
+    FakeReceiver receiver(link, 38400);
+    QVERIFY(receiver.plug());
+
+    GpsSerialWorker worker;
+    QSignalSpy connectedSpy(&worker, &GpsSerialWorker::connected);
+    QSignalSpy dataSpy(&worker, &GpsSerialWorker::dataReceived);
+    worker.start(link, 9600);
+
+    QTRY_COMPARE_WITH_TIMEOUT(connectedSpy.count(), 1, 4 * GpsSerialWorker::ProbeWindowMs);
+    QCOMPARE(connectedSpy.at(0).at(0).toInt(), 38400);
+    QTRY_VERIFY(dataSpy.count() >= 1);
+    QVERIFY(dataSpy.at(0).at(0).toByteArray().contains("$GPGGA"));
+
+    const GpsSerialWorker::Stats stats = worker.stats();
+    QVERIFY(stats.connected);
+    QCOMPARE(stats.baudRate, 38400);
+    QVERIFY(stats.baudProbes >= 2);
+    QVERIFY(stats.bytes > 0);
+    QCOMPARE(stats.reconnects, quint64(0));
+    worker.stop();
+#endif
+}
+
+void GpsSerialWorkerTest::deviceUnplugged_reappears_reconnectsWithoutRestart()
+{
+    // Objectif: vérifier qu'un récepteur débranché puis rebranché est rouvert sans intervention.
+    // Pourquoi: un récepteur USB ré-énuméré (faux contact, alimentation faible) obligeait à relancer
+    //           l'application ; la liaison doit reprendre dès que le périphérique réapparaît.
+    // Procédure détaillée:
+    //   1) Connexion initiale à 9600 bauds.
+    //   2) Débranchement : pty fermé et lien supprimé ; attente de disconnected(true).
+    //   3) Rebranchement sur un nouveau pty au même chemin.
+    //   4) Attente d'une nouvelle connexion ; reconnects vaut 1 et les données reprennent.
+#ifndef Q_OS_LINUX
+    QSKIP("Pseudo-terminaux requis (Linux).");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString link = dir.filePath(QStringLiteral("gps0"));
+    FakeReceiver receiver(link, 9600);
+    QVERIFY(receiver.plug());
+
+    GpsSerialWorker worker;
+    QSignalSpy connectedSpy(&worker, &GpsSerialWorker::connected);
+    QSignalSpy disconnectedSpy(&worker, &GpsSerialWorker::disconnected);
+    QSignalSpy dataSpy(&worker, &GpsSerialWorker::dataReceived);
+    worker.start(link);
+    QTRY_COMPARE_WITH_TIMEOUT(connectedSpy.count(), 1, 2 * GpsSerialWorker::ProbeWindowMs);
+
+    receiver.unplug();
+    // Selon le pilote, la perte est signalée par une erreur de lecture ou détectée après le silence.
+    const int lossTimeoutMs = GpsSerialWorker::StallTimeoutMs + 2 * GpsSerialWorker::ProbeWindowMs;
+    QTRY_VERIFY_WITH_TIMEOUT(!disconnectedSpy.isEmpty() && disconnectedSpy.last().at(0).toBool(), lossTimeoutMs);
+    QVERIFY(!worker.stats().connected);
+
+    dataSpy.clear();
+    QVERIFY(receiver.plug());
+    QTRY_COMPARE_WITH_TIMEOUT(connectedSpy.count(), 2,
+                              GpsSerialWorker::RetryIntervalMs + 2 * GpsSerialWorker::ProbeWindowMs);
+    QTRY_VERIFY(dataSpy.count() >= 1);
+    QCOMPARE(worker.stats().reconnects, quint64(1));
+    QCOMPARE(worker.stats().baudRate, 9600);
+    worker.stop();
+#endif
+}
+
+QTEST_GUILESS_MAIN(GpsSerialWorkerTest)
+#include "tst_gpsserialworker.moc"
@@ -0,0 +1,83 @@
+/**
+ * @file httpstandin.h
+ * @brief Rôle architectural : Serveur HTTP local partagé par les tests réseau (Mapbox, tuiles).
+ * @details Responsabilités : Écouter sur la boucle locale, lire une requête par connexion, confier la
+ * réponse à une fonction fournie par le test puis l'envoyer après un délai réglable en fermant la
+ * connexion. Garde la trace des cibles reçues et du plus grand nombre de requêtes servies en parallèle.
+ * Dépendances principales : QTcpServer, QTcpSocket, QTimer.
+ */
+
+#ifndef HTTPSTANDIN_H
+#define HTTPSTANDIN_H
+
+#include <QHash>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <algorithm>
+#include <functional>
+
+/**
+ * @class HttpStandIn
+ * @brief Serveur HTTP minimal dont la réponse et le délai sont paramétrés par le test.
+ */
+class HttpStandIn {
+public:
+    /// Réponse renvoyée pour une cible donnée.
+    struct Reply {
+        int status = 200;
+        QByteArray contentType = "application/json";
+        QByteArray body;
+    };
+
+    HttpStandIn()
+    {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { onReadyRead(socket); });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+        m_server.listen(QHostAddress::LocalHost);
+    }
+
+    /// Adresse de base du serveur, sans chemin.
+    QUrl url() const { return QUrl(QStringLiteral("http://127.0.0.1:%1").arg(m_server.serverPort())); }
+
+    std::function<Reply(const QString& target)> respond = [](const QString&) { return Reply{}; };
+    std::function<int(const QString& target)> delayMs = [](const QString&) { return 0; };
+
+    QStringList requests;  ///< Chemins et paramètres reçus, décodés.
+    int maxInFlight = 0;   ///< Plus grand nombre de requêtes reçues et pas encore servies.
+
+private:
+    void onReadyRead(QTcpSocket* socket)
+    {
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        if (!buffer.contains("\r\n\r\n")) return;
+        const QString target = QUrl::fromPercentEncoding(buffer.split(' ').value(1));
+        m_buffers.remove(socket);
+        requests << target;
+        maxInFlight = std::max(maxInFlight, ++m_inFlight);
+
+        const Reply reply = respond(target);
+        const QByteArray reason = reply.status == 200 ? "OK" : reply.status == 404 ? "Not Found" : "Error";
+        const QByteArray response = "HTTP/1.1 " + QByteArray::number(reply.status) + ' ' + reason
+            + "\r\nContent-Type: " + reply.contentType + "\r\nContent-Length: " + QByteArray::number(reply.body.size())
+            + "\r\nConnection: close\r\n\r\n" + reply.body;
+        QTimer::singleShot(delayMs(target), socket, [this, socket, response]() {
+            --m_inFlight;
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    int m_inFlight = 0;
+};
+
+#endif // HTTPSTANDIN_H
@@ -0,0 +1,13 @@
+QT += testlib core network
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = mapboxclient_test
+
+SOURCES += \
+    tst_mapboxclient.cpp \
+    ../../mapboxclient.cpp
+
+HEADERS += \
+    ../httpstandin.h \
+    ../../mapboxclient.h
@@ -0,0 +1,213 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "../httpstandin.h"
+#include "../../mapboxclient.h"
+
+namespace {
+// Réponses de l'API Mapbox simulée : 500 pour "introuvable", un lieu pour le géocodage, un trajet sinon.
+HttpStandIn::Reply mapboxReply(const QString& target)
+{
+    HttpStandIn::Reply reply;
+    if (target.contains(QStringLiteral("introuvable"))) {
+        reply.status = 500;
+    } else if (target.startsWith(QStringLiteral("/geocoding/"))) {
+        const qsizetype from = target.indexOf(QStringLiteral("mapbox.places/")) + 14;
+        const QString query = target.mid(from, target.indexOf(QStringLiteral(".json")) - from);
+        reply.body = QStringLiteral("{\"features\":[{\"place_name\":\"%1 (réponse)\",\"center\":[2.2945,48.8584]}]}")
+                         .arg(query).toUtf8();
+    } else {
+        reply.body = "{\"routes\":[{\"distance\":1200,\"duration\":90,\"geometry\":{\"type\":\"LineString\","
+                     "\"coordinates\":[[5.0,45.0],[5.01,45.01]]},\"legs\":[]}]}";
+    }
+    return reply;
+}
+
+// Serveur HTTP local tenant lieu de l'API Mapbox.
+class MapboxStandIn : public HttpStandIn {
+public:
+    MapboxStandIn() { respond = mapboxReply; }
+};
+}
+
+class MapboxClientTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void suggestions_slowAnswerForOlderQuery_neverShown();
+    void identicalRequests_shareOneNetworkRequest();
+    void geocodingCache_keyedByNormalisedQueryAndCell();
+    void failuresAndMissingToken_reported();
+};
+
+void MapboxClientTest::suggestions_slowAnswerForOlderQuery_neverShown()
+{
+    // Objectif: une saisie plus récente remplace la précédente, même si la réponse de celle-ci arrive après.
+    // Pourquoi: avec une requête HTTP par frappe, la réponse lente de « rue d » écrasait celle de
+    //           « rue de la paix » et les suggestions clignotaient.
+    // Procédure détaillée:
+    //   1) Serveur lent (300 ms) pour « rue d », immédiat pour le reste.
+    //   2) Demander « rue d » puis « Rue de la  Paix » : générations croissantes.
+    //   3) Une seule livraison, celle de la deuxième génération ; la première requête est interrompue.
+    //   4) Après le délai du serveur lent, toujours une seule livraison.
+    MapboxStandIn server;
+    server.delayMs = [](const QString& target) { return target.contains(QStringLiteral("/rue d.json")) ? 300 : 0; };
+    MapboxClient client;
+    client.setBaseUrl(server.url());
+    client.setAccessToken(QStringLiteral("pk.test"));
+    QSignalSpy spy(&client, &MapboxClient::suggestionsReady);
+
+    const int first = client.requestSuggestions(QStringLiteral("rue d"), 48.85, 2.35);
+    const int second = client.requestSuggestions(QStringLiteral("Rue de la  Paix"), 48.85, 2.35);
+    QVERIFY(first > 0);
+    QVERIFY(second > first);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), second);
+    QCOMPARE(spy.at(0).at(1).toStringList(), QStringList({QStringLiteral("rue de la paix (réponse)")}));
+    QCOMPARE(client.stats().cancelled, quint64(1));
+
+    QTest::qWait(400);
+    QCOMPARE(spy.count(), 1);
+
+    // Saisie raccourcie sous le minimum : rien n'est envoyé, une demande en cours est abandonnée.
+    server.delayMs = [](const QString&) { return 200; };
+    QVERIFY(client.requestSuggestions(QStringLiteral("rue de"), 48.85, 2.35) > 0);
+    QCOMPARE(client.requestSuggestions(QStringLiteral(" r "), 48.85, 2.35), 0);
+    QTest::qWait(300);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(client.stats().cancelled, quint64(2));
+}
+
+void MapboxClientTest::identicalRequests_shareOneNetworkRequest()
+{
+    // Objectif: deux demandes identiques en cours ne coûtent qu'une requête, livrée à la plus récente.
+    // Pourquoi: un recalcul relancé avant la réponse du précédent (même départ, même arrivée)
+    //           doublait les appels à l'API Directions.
+    // Procédure détaillée:
+    //   1) Deux requestDirections() identiques pendant que le serveur tarde.
+    //   2) Une requête reçue par le serveur, une livraison pour la deuxième génération, route décodée.
+    //   3) cancelDirections() (arrêt du guidage) : la réponse suivante n'est jamais livrée.
+    MapboxStandIn server;
+    server.delayMs = [](const QString&) { return 100; };
+    MapboxClient client;
+    client.setBaseUrl(server.url());
+    client.setAccessToken(QStringLiteral("pk.test"));
+    QSignalSpy spy(&client, &MapboxClient::directionsReady);
+
+    client.requestDirections(45.0, 5.0, 45.01, 5.01);
+    const int second = client.requestDirections(45.0, 5.0, 45.01, 5.01);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), second);
+    const QVariantMap route = spy.at(0).at(1).toMap();
+    QCOMPARE(route.value(QStringLiteral("distance")).toDouble(), 1200.0);
+    QCOMPARE(route.value(QStringLiteral("duration")).toDouble(), 90.0);
+    QCOMPARE(server.requests.size(), 1);
+    QVERIFY(server.requests.first().startsWith(
+        QStringLiteral("/directions/v5/mapbox/driving-traffic/5.000000,45.000000;5.010000,45.010000?")));
+    QVERIFY(server.requests.first().contains(QStringLiteral("annotations=maxspeed,congestion,duration")));
+    QCOMPARE(client.stats().networkRequests, quint64(1));
+    QCOMPARE(client.stats().coalesced, quint64(1));
+
+    QVERIFY(client.requestDirections(45.0, 5.0, 45.02, 5.02) > second);
+    client.cancelDirections();
+    QTest::qWait(250);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(client.stats().cancelled, quint64(1));
+}
+
+void MapboxClientTest::geocodingCache_keyedByNormalisedQueryAndCell()
+{
+    // Objectif: valider le cache du géocodage (mémoire puis disque) et sa clé.
+    // Pourquoi: les mêmes destinations reviennent d'un trajet à l'autre ; chaque réponse servie par le
+    //           cache est une requête de moins sur le quota Mapbox et une réponse sans attente réseau.
+    // Procédure détaillée:
+    //   1) Géocoder « Tour Eiffel » : une requête, avec le centre de la maille comme proximity.
+    //   2) Même saisie à la casse et aux espaces près, dans la même maille : cache mémoire, pas de requête.
+    //   3) Autre maille : nouvelle requête.
+    //   4) Réponse du cache remplacée avant sa livraison : écartée (génération périmée).
+    //   5) Nouveau client sur le même répertoire : cache disque.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    MapboxStandIn server;
+    MapboxClient client;
+    client.setBaseUrl(server.url());
+    client.setAccessToken(QStringLiteral("pk.test"));
+    client.setCacheDirectory(dir.filePath(QStringLiteral("mapbox")));
+    QSignalSpy spy(&client, &MapboxClient::geocoded);
+
+    const int first = client.geocode(QStringLiteral("Tour Eiffel"), 48.858, 2.294);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), first);
+    QCOMPARE(spy.at(0).at(1).toDouble(), 48.8584);
+    QCOMPARE(spy.at(0).at(2).toDouble(), 2.2945);
+    QCOMPARE(server.requests.size(), 1);
+    QVERIFY(server.requests.first().startsWith(QStringLiteral("/geocoding/v5/mapbox.places/tour eiffel.json?")));
+    QVERIFY(server.requests.first().contains(QStringLiteral("proximity=2.2750,48.8750")));
+    QVERIFY(server.requests.first().contains(QStringLiteral("limit=1")));
+
+    const int cached = client.geocode(QStringLiteral("  tour   EIFFEL "), 48.88, 2.26);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toInt(), cached);
+    QCOMPARE(client.stats().memoryHits, quint64(1));
+    QCOMPARE(server.requests.size(), 1);
+
+    client.geocode(QStringLiteral("Tour Eiffel"), 45.0, 5.0);
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(server.requests.size(), 2);
+
+    client.geocode(QStringLiteral("tour eiffel"), 48.858, 2.294);
+    const int latest = client.geocode(QStringLiteral("Gare de Lyon"), 48.858, 2.294);
+    QTRY_COMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(3).at(0).toInt(), latest);
+    QCOMPARE(client.stats().staleDropped, quint64(1));
+
+    MapboxClient restarted;
+    restarted.setBaseUrl(server.url());
+    restarted.setAccessToken(QStringLiteral("pk.test"));
+    restarted.setCacheDirectory(dir.filePath(QStringLiteral("mapbox")));
+    QSignalSpy restartedSpy(&restarted, &MapboxClient::geocoded);
+    restarted.geocode(QStringLiteral("Tour Eiffel"), 48.86, 2.29);
+    QTRY_COMPARE(restartedSpy.count(), 1);
+    QCOMPARE(restarted.stats().diskHits, quint64(1));
+    QCOMPARE(restarted.stats().networkRequests, quint64(0));
+    QCOMPARE(server.requests.size(), 3);
+}
+
+void MapboxClientTest::failuresAndMissingToken_reported()
+{
+    // Objectif: un échec est signalé à la génération qui l'attend ; sans jeton, rien n'est envoyé.
+    // Pourquoi: map.qml débloque le recalcul d'itinéraire sur échec au lieu de rester « Calcul... ».
+    // Procédure détaillée:
+    //   1) Erreur HTTP 500 : requestFailed avec la génération demandée, rien en cache.
+    //   2) Client sans jeton : génération 0, aucune requête.
+    MapboxStandIn server;
+    MapboxClient client;
+    client.setBaseUrl(server.url());
+    client.setAccessToken(QStringLiteral("pk.test"));
+    QSignalSpy failed(&client, &MapboxClient::requestFailed);
+    QSignalSpy geocoded(&client, &MapboxClient::geocoded);
+
+    const int generation = client.geocode(QStringLiteral("Lieu introuvable"), 45.0, 5.0);
+    QTRY_COMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(0).toInt(), generation);
+    QCOMPARE(geocoded.count(), 0);
+    client.geocode(QStringLiteral("Lieu introuvable"), 45.0, 5.0);
+    QTRY_COMPARE(failed.count(), 2);
+    QCOMPARE(server.requests.size(), 2);
+
+    MapboxClient offline;
+    offline.setBaseUrl(server.url());
+    QVERIFY(!offline.isAvailable());
+    QCOMPARE(offline.requestSuggestions(QStringLiteral("rue de la paix"), 45.0, 5.0), 0);
+    QCOMPARE(offline.geocode(QStringLiteral("Tour Eiffel"), 45.0, 5.0), 0);
+    QCOMPARE(offline.requestDirections(45.0, 5.0, 45.01, 5.01), 0);
+    QTest::qWait(50);
+    QCOMPARE(server.requests.size(), 2);
+}
+
+QTEST_GUILESS_MAIN(MapboxClientTest)
+#include "tst_mapboxclient.moc"
@@ -0,0 +1,12 @@
+QT += testlib core positioning
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = nmeaparser_test
+
+SOURCES += \
+    tst_nmeaparser.cpp \
+    ../../nmeaparser.cpp
+
+HEADERS += \
+    ../../nmeaparser.h
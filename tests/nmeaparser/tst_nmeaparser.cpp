@@ -0,0 +1,351 @@
+#include <QtTest>
+#include <QFile>
+#include <QNmeaPositionInfoSource>
+#include <QGeoPositionInfo>
+#include <cmath>
+
+#include "../../nmeaparser.h"
+
+namespace {
+// Expose le décodage phrase par phrase de Qt Positioning (méthode protégée) pour la comparaison.
+class QtNmeaReference : public QNmeaPositionInfoSource
+{
+public:
+    QtNmeaReference() : QNmeaPositionInfoSource(QNmeaPositionInfoSource::RealTimeMode) {}
+    using QNmeaPositionInfoSource::parsePosInfoFromNmeaData;
+};
+
+QByteArray withChecksum(const QByteArray& body)
+{
+    unsigned char sum = 0;
+    for (char c : body) sum ^= static_cast<unsigned char>(c);
+    return "$" + body + "*" + QByteArray::number(sum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+QByteArray nmeaCoordinate(double degrees, bool latitude)
+{
+    const double absolute = std::abs(degrees);
+    const int whole = static_cast<int>(absolute);
+    const double minutes = (absolute - whole) * 60.0;
+    QByteArray value = QByteArray::number(whole).rightJustified(latitude ? 2 : 3, '0')
+                     + QByteArray::number(minutes, 'f', 5).rightJustified(8, '0');
+    const char hemisphere = latitude ? (degrees < 0 ? 'S' : 'N') : (degrees < 0 ? 'W' : 'E');
+    return value + "," + hemisphere;
+}
+
+// Trajet synthétique à 1 Hz avec le jeu de phrases complet d'un récepteur u-blox par défaut.
+// Un journal enregistré peut être utilisé à la place via la variable d'environnement NMEA_BENCH_LOG.
+QByteArray drivingLog(int epochs)
+{
+    const QByteArray recorded = qgetenv("NMEA_BENCH_LOG");
+    if (!recorded.isEmpty()) {
+        QFile file(QString::fromLocal8Bit(recorded));
+        if (file.open(QIODevice::ReadOnly)) return file.readAll();
+    }
+
+    QByteArray log;
+    double lat = 48.8566;
+    double lon = 2.3522;
+    for (int i = 0; i < epochs; ++i) {
+        const int seconds = 12 * 3600 + i;
+        const QByteArray time = QByteArray::number(seconds / 3600).rightJustified(2, '0')
+                              + QByteArray::number((seconds / 60) % 60).rightJustified(2, '0')
+                              + QByteArray::number(seconds % 60).rightJustified(2, '0') + ".00";
+        const double course = std::fmod(i * 0.5, 360.0);
+        const double speedKnots = 25.0 + 5.0 * std::sin(i * 0.05);
+        lat += speedKnots * 0.514444 * std::cos(course * M_PI / 180.0) / 111320.0;
+        lon += speedKnots * 0.514444 * std::sin(course * M_PI / 180.0) / (111320.0 * std::cos(lat * M_PI / 180.0));
+
+        log += withChecksum("GPGGA," + time + "," + nmeaCoordinate(lat, true) + "," + nmeaCoordinate(lon, false)
+                            + ",1,09,0.92,35.4,M,47.1,M,,");
+        log += withChecksum("GPGSA,A,3,02,05,07,09,13,15,18,20,30,,,,1.61,0.92,1.32");
+        log += withChecksum("GPGSV,3,1,11,02,64,174,38,05,41,287,32,07,12,043,25,09,22,118,30");
+        log += withChecksum("GPGSV,3,2,11,13,52,062,41,15,33,226,36,18,06,322,,20,47,301,39");
+        log += withChecksum("GPGSV,3,3,11,23,04,150,,29,10,275,,30,71,045,44");
+        log += withChecksum("GPRMC," + time + ",A," + nmeaCoordinate(lat, true) + "," + nmeaCoordinate(lon, false)
+                            + "," + QByteArray::number(speedKnots, 'f', 3) + "," + QByteArray::number(course, 'f', 2)
+                            + ",170324,,,A");
+        log += withChecksum("GPVTG," + QByteArray::number(course, 'f', 2) + ",T,,M,"
+                            + QByteArray::number(speedKnots, 'f', 3) + ",N,"
+                            + QByteArray::number(speedKnots * 1.852, 'f', 3) + ",K,A");
+    }
+    return log;
+}
+}
+
+class NmeaParserTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void checksum_validAndCorruptedSentences();
+    void parseSentence_standardSentences_decodeAllFields();
+    void parseSentence_voidRmcAndHemispheres_areHandled();
+    void parseSentence_multiConstellationGsv_sumsSatellitesInView();
+    void feed_sentencesSplitAcrossReads_matchSingleRead();
+    void feed_garbageAndOverlongLines_areCountedWithoutCorruptingState();
+    void drivingLog_nativeParser_matchesQtPositioning();
+
+    void benchmark_nativeParser();
+    void benchmark_qtPositioningParser();
+};
+
+void NmeaParserTest::checksum_validAndCorruptedSentences()
+{
+    // Objectif: vérifier le contrôle de la somme de contrôle NMEA ("*hh", XOR entre '$' et '*').
+    // Pourquoi: une liaison UART bruitée produit des octets corrompus qui ne doivent jamais
+    //           se traduire par une position fausse sur la carte.
+    // Procédure détaillée:
+    //   1) Une phrase de référence est acceptée, avec ou sans CR/LF final.
+    //   2) Un seul octet modifié, une somme absente ou tronquée : la phrase est rejetée et comptée.
+    const QByteArray gga = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+    QVERIFY(NmeaParser::checksumValid(gga.toStdString()));
+    QVERIFY(NmeaParser::checksumValid((gga + "\r\n").toStdString()));
+    QVERIFY(NmeaParser::checksumValid("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"));
+
+    QByteArray corrupted = gga;
+    corrupted[20] = '9';
+    QVERIFY(!NmeaParser::checksumValid(corrupted.toStdString()));
+    QVERIFY(!NmeaParser::checksumValid(gga.left(gga.size() - 3).toStdString()));
+    QVERIFY(!NmeaParser::checksumValid(gga.left(gga.size() - 1).toStdString()));
+
+    NmeaParser parser;
+    QCOMPARE(parser.parseSentence(corrupted.toStdString()), NmeaParser::NoSentence);
+    QCOMPARE(parser.stats().checksumErrors, quint64(1));
+    QCOMPARE(parser.fix().satellitesUsed, -1);
+}
+
+void NmeaParserTest::parseSentence_standardSentences_decodeAllFields()
+{
+    // Objectif: contrôler le décodage champ par champ des cinq phrases prises en charge.
+    // Pourquoi: le nombre de satellites, les DOP et le type de fix étaient perdus par Qt Positioning.
+    // Procédure détaillée:
+    //   1) Décoder les exemples de référence GGA, GSA, GSV, RMC et VTG.
+    //   2) Vérifier position, altitude, heure, date, satellites, DOP, vitesse (m/s) et route.
+    NmeaParser parser;
+    QCOMPARE(parser.parseSentence("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"), NmeaParser::GGA);
+    QCOMPARE(parser.parseSentence("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39"), NmeaParser::GSA);
+    QCOMPARE(parser.parseSentence("$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75"), NmeaParser::GSV);
+    QCOMPARE(parser.parseSentence("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61"), NmeaParser::RMC);
+
+    const NmeaFix& fix = parser.fix();
+    QVERIFY(fix.valid);
+    QCOMPARE(fix.timeMs, (12 * 3600 + 35 * 60 + 19) * 1000);
+    QCOMPARE(fix.day, 23);
+    QCOMPARE(fix.month, 3);
+    QCOMPARE(fix.year, 2024);
+    QVERIFY(std::abs(fix.lat - (48.0 + 7.038 / 60.0)) < 1e-9);
+    QVERIFY(std::abs(fix.lon - (11.0 + 31.0 / 60.0)) < 1e-9);
+    QVERIFY(fix.hasAltitude);
+    QCOMPARE(fix.altitudeM, 545.4);
+    QCOMPARE(fix.quality, 1);
+    QCOMPARE(fix.fixMode, 3);
+    QCOMPARE(fix.satellitesUsed, 8);
+    QCOMPARE(fix.satellitesInView, 8);
+    QCOMPARE(fix.pdop, 2.5);
+    QCOMPARE(fix.hdop, 1.3); // GSA postérieure à GGA : valeur la plus récente
+    QCOMPARE(fix.vdop, 2.1);
+    QVERIFY(fix.hasSpeed);
+    QVERIFY(std::abs(fix.speedMs - 22.4 * 1852.0 / 3600.0) < 1e-9);
+    QVERIFY(fix.hasCourse);
+    QCOMPARE(fix.courseDeg, 84.4);
+
+    QCOMPARE(parser.parseSentence("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"), NmeaParser::VTG);
+    QCOMPARE(parser.fix().courseDeg, 54.7);
+    QVERIFY(std::abs(parser.fix().speedMs - 10.2 / 3.6) < 1e-9);
+
+    QCOMPARE(parser.stats().sentences, quint64(5));
+    QCOMPARE(parser.parseSentence("$GPGLL,4916.45,N,12311.12,W,225444,A,*1D"), NmeaParser::NoSentence);
+    QCOMPARE(parser.stats().ignored, quint64(1));
+}
+
+void NmeaParserTest::parseSentence_voidRmcAndHemispheres_areHandled()
+{
+    // Objectif: vérifier la validité du fix et le signe des coordonnées.
+    // Pourquoi: un récepteur sans fix émet des RMC au statut 'V' (souvent avec une ancienne position),
+    //           et une erreur de signe S/W placerait le véhicule dans un autre hémisphère.
+    // Procédure détaillée:
+    //   1) RMC statut 'A' en hémisphères Sud/Ouest : coordonnées négatives, fix valide.
+    //   2) RMC statut 'V' : fix invalide, sans vitesse ni route, position précédente conservée.
+    //   3) Sans RMC dans le flux, la qualité GGA fait foi (0 = pas de fix).
+    NmeaParser parser;
+    QCOMPARE(parser.parseSentence("$GPRMC,081836,A,3751.65,S,14507.36,W,000.0,360.0,130998,011.3,E*70"), NmeaParser::RMC);
+    QVERIFY(parser.fix().valid);
+    QVERIFY(std::abs(parser.fix().lat + (37.0 + 51.65 / 60.0)) < 1e-9);
+    QVERIFY(std::abs(parser.fix().lon + (145.0 + 7.36 / 60.0)) < 1e-9);
+    QCOMPARE(parser.fix().year, 1998);
+
+    QCOMPARE(parser.parseSentence("$GPRMC,081837,V,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*74"), NmeaParser::RMC);
+    QVERIFY(!parser.fix().valid);
+    QVERIFY(!parser.fix().hasSpeed);
+    QVERIFY(!parser.fix().hasCourse);
+    QVERIFY(parser.fix().lon < 0.0);
+
+    NmeaParser ggaOnly;
+    QCOMPARE(ggaOnly.parseSentence("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"), NmeaParser::GGA);
+    QVERIFY(ggaOnly.fix().valid);
+    QCOMPARE(ggaOnly.parseSentence("$GPGGA,123520,,,,,0,00,99.99,,,,,,*4F"), NmeaParser::GGA);
+    QVERIFY(!ggaOnly.fix().valid);
+    QCOMPARE(ggaOnly.fix().satellitesUsed, 0);
+    QVERIFY(!ggaOnly.seenRmc());
+}
+
+void NmeaParserTest::parseSentence_multiConstellationGsv_sumsSatellitesInView()
+{
+    // Objectif: cumuler les satellites visibles des différentes constellations.
+    // Pourquoi: un récepteur multi-GNSS émet une série GSV par constellation (GP, GL, GA...),
+    //           chacune avec son propre total ; garder la dernière ferait osciller l'affichage.
+    // Procédure détaillée:
+    //   1) Décoder une GSV GPS (11 satellites) puis une GSV GLONASS (7 satellites).
+    //   2) Vérifier le total de 18, puis sa mise à jour quand la série GPS suivante annonce 10.
+    NmeaParser parser;
+    QVERIFY(parser.parseSentence(withChecksum("GPGSV,3,1,11,02,64,174,38,05,41,287,32,07,12,043,25,09,22,118,30").toStdString()));
+    QVERIFY(parser.parseSentence(withChecksum("GLGSV,2,1,07,65,40,083,46,66,17,308,41,72,07,344,39,81,22,228,45").toStdString()));
+    QCOMPARE(parser.fix().satellitesInView, 18);
+    QVERIFY(parser.parseSentence(withChecksum("GPGSV,3,1,10,02,64,174,38,05,41,287,32,07,12,043,25,09,22,118,30").toStdString()));
+    QCOMPARE(parser.fix().satellitesInView, 17);
+}
+
+void NmeaParserTest::feed_sentencesSplitAcrossReads_matchSingleRead()
+{
+    // Objectif: garantir un décodage identique quel que soit le découpage des lectures série.
+    // Pourquoi: readyRead livre des blocs arbitraires ; une phrase coupée en deux ne doit être ni
+    //           perdue ni décodée deux fois.
+    // Procédure détaillée:
+    //   1) Décoder un journal de 20 époques en un seul bloc (référence).
+    //   2) Le redécoder octet par octet, puis par blocs de tailles variables (1 à 97 octets).
+    //   3) Comparer le nombre de phrases, la séquence des types et l'état final.
+    const QByteArray log = drivingLog(20);
+
+    NmeaParser reference;
+    QVector<int> expectedTypes;
+    QCOMPARE(reference.feed(log.constData(), log.size(), [&](NmeaParser::Sentence s) { expectedTypes.append(s); }),
+             std::size_t(20 * 7));
+
+    NmeaParser byteWise;
+    QVector<int> byteTypes;
+    for (int i = 0; i < log.size(); ++i) {
+        byteWise.feed(log.constData() + i, 1, [&](NmeaParser::Sentence s) { byteTypes.append(s); });
+    }
+    QCOMPARE(byteTypes, expectedTypes);
+
+    NmeaParser chunked;
+    int offset = 0;
+    int chunk = 1;
+    while (offset < log.size()) {
+        const int size = std::min(chunk, int(log.size()) - offset);
+        chunked.feed(log.constData() + offset, size);
+        offset += size;
+        chunk = chunk % 97 + 13;
+    }
+
+    for (const NmeaParser* parser : {&byteWise, &chunked}) {
+        QCOMPARE(parser->stats().sentences, reference.stats().sentences);
+        QCOMPARE(parser->stats().malformed, quint64(0));
+        QCOMPARE(parser->fix().lat, reference.fix().lat);
+        QCOMPARE(parser->fix().lon, reference.fix().lon);
+        QCOMPARE(parser->fix().timeMs, reference.fix().timeMs);
+        QCOMPARE(parser->fix().satellitesInView, reference.fix().satellitesInView);
+    }
+}
+
+void NmeaParserTest::feed_garbageAndOverlongLines_areCountedWithoutCorruptingState()
+{
+    // Objectif: vérifier la robustesse face à un flux corrompu (démarrage à chaud, mauvais débit).
+    // Pourquoi: à l'ouverture du port, le premier bloc commence souvent au milieu d'une phrase,
+    //           et un débit erroné produit de longues suites d'octets sans fin de ligne.
+    // Procédure détaillée:
+    //   1) Injecter une fin de phrase orpheline, du bruit binaire, une phrase interrompue par une autre,
+    //      puis une ligne de 300 octets coupée entre deux lectures.
+    //   2) Vérifier que seules les phrases intègres sont décodées et que les anomalies sont comptées.
+    NmeaParser parser;
+    const QByteArray gga = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    const QByteArray noise = "545.4,M,46.9,M,,*47\r\n\x01\xff\xfe garbage\r\n$GPRMC,1235";
+    QByteArray corrupted = gga;
+    corrupted[20] = '9';
+
+    QCOMPARE(parser.feed(noise.constData(), noise.size()), std::size_t(0));
+    QCOMPARE(parser.feed(corrupted.constData(), corrupted.size()), std::size_t(0));
+    QCOMPARE(parser.stats().malformed, quint64(1));      // RMC interrompue par le '$' suivant
+    QCOMPARE(parser.stats().checksumErrors, quint64(1)); // GGA corrompue
+
+    const QByteArray overlong = "$GPTXT," + QByteArray(300, 'x');
+    parser.feed(overlong.constData(), 150);
+    parser.feed(overlong.constData() + 150, overlong.size() - 150);
+    QCOMPARE(parser.feed("\r\n", 2), std::size_t(0));
+    QCOMPARE(parser.stats().malformed, quint64(2));
+
+    QCOMPARE(parser.feed(gga.constData(), gga.size()), std::size_t(1));
+    QCOMPARE(parser.fix().satellitesUsed, 8);
+}
+
+void NmeaParserTest::drivingLog_nativeParser_matchesQtPositioning()
+{
+    // Objectif: confirmer que le décodeur natif reproduit les positions du décodeur Qt remplacé.
+    // Pourquoi: le changement de décodeur ne doit déplacer le véhicule ni en position ni en vitesse.
+    // Procédure détaillée:
+    //   1) Décoder chaque RMC du journal avec Qt Positioning et avec NmeaParser.
+    //   2) Comparer latitude, longitude (1e-7°), vitesse (1e-3 m/s) et route (1e-3°).
+    const QList<QByteArray> lines = drivingLog(120).split('\n');
+    QtNmeaReference qt;
+    NmeaParser native;
+    int compared = 0;
+
+    for (const QByteArray& line : lines) {
+        if (!line.startsWith("$GPRMC")) continue;
+        QGeoPositionInfo info;
+        bool hasFix = false;
+        QVERIFY(qt.parsePosInfoFromNmeaData(line.constData(), line.size(), &info, &hasFix));
+        QCOMPARE(native.parseSentence(std::string_view(line.constData(), line.size())), NmeaParser::RMC);
+
+        QCOMPARE(native.fix().valid, hasFix);
+        QVERIFY(std::abs(native.fix().lat - info.coordinate().latitude()) < 1e-7);
+        QVERIFY(std::abs(native.fix().lon - info.coordinate().longitude()) < 1e-7);
+        QVERIFY(std::abs(native.fix().speedMs - info.attribute(QGeoPositionInfo::GroundSpeed)) < 1e-3);
+        QVERIFY(std::abs(native.fix().courseDeg - info.attribute(QGeoPositionInfo::Direction)) < 1e-3);
+        ++compared;
+    }
+    QCOMPARE(compared, 120);
+}
+
+void NmeaParserTest::benchmark_nativeParser()
+{
+    // Objectif: mesurer le coût du décodeur natif sur un trajet (blocs de 256 octets, comme readyRead).
+    // Pourquoi: référence à comparer avec benchmark_qtPositioningParser sur les mêmes octets.
+    const QByteArray log = drivingLog(600);
+    NmeaParser parser;
+    std::size_t decoded = 0;
+
+    QBENCHMARK {
+        parser.reset();
+        decoded = 0;
+        for (int offset = 0; offset < log.size(); offset += 256) {
+            decoded += parser.feed(log.constData() + offset, std::min(256, int(log.size()) - offset));
+        }
+    }
+    QVERIFY(decoded > 0);
+    QCOMPARE(parser.stats().checksumErrors, quint64(0));
+}
+
+void NmeaParserTest::benchmark_qtPositioningParser()
+{
+    // Objectif: mesurer le coût de Qt Positioning sur le même trajet, une phrase à la fois.
+    // Pourquoi: les lignes sont découpées hors mesure, ce qui avantage Qt ; l'écart mesuré est donc
+    //           un minorant du gain réel (Qt lit en plus le port ligne par ligne via QIODevice).
+    const QList<QByteArray> lines = drivingLog(600).split('\n');
+    QtNmeaReference qt;
+    int fixes = 0;
+
+    QBENCHMARK {
+        fixes = 0;
+        for (const QByteArray& line : lines) {
+            QGeoPositionInfo info;
+            bool hasFix = false;
+            if (qt.parsePosInfoFromNmeaData(line.constData(), line.size(), &info, &hasFix) && hasFix) ++fixes;
+        }
+    }
+    QVERIFY(fixes > 0);
+}
+
+QTEST_GUILESS_MAIN(NmeaParserTest)
+#include "tst_nmeaparser.moc"
@@ -0,0 +1,28 @@
+QT += testlib core positioning
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = roadgraph_test
+
+SOURCES += \
+    tst_roadgraph.cpp \
+    ../../roadgraph.cpp \
+    ../../roadgraphbuilder.cpp \
+    ../../offlinerouter.cpp \
+    ../../routemodel.cpp \
+    ../../segmentgrid.cpp \
+    ../../routematcher.cpp \
+    ../../osmpbfreader.cpp \
+    ../../osmgraphimporter.cpp \
+    ../../offlinegeocoder.cpp
+
+HEADERS += \
+    ../../roadgraph.h \
+    ../../roadgraphbuilder.h \
+    ../../offlinerouter.h \
+    ../../routemodel.h \
+    ../../segmentgrid.h \
+    ../../routematcher.h \
+    ../../osmpbfreader.h \
+    ../../osmgraphimporter.h \
+    ../../offlinegeocoder.h
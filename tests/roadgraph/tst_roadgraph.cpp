@@ -0,0 +1,957 @@
+#include <QtTest>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+
+#include "../../offlinegeocoder.h"
+#include "../../offlinerouter.h"
+#include "../../osmgraphimporter.h"
+#include "../../osmpbfreader.h"
+#include "../../roadgraph.h"
+#include "../../roadgraphbuilder.h"
+#include "../../routemodel.h"
+
+namespace {
+constexpr double GridLatStep = 0.001;  // ≈ 111 m
+constexpr double GridLonStep = 0.0014; // ≈ 110 m à 45° de latitude
+constexpr double GridLat = 45.0;
+constexpr double GridLon = 5.0;
+
+using ArcMap = std::map<std::pair<quint32, quint32>, qint64>; // (origine, extrémité) -> durée (ms)
+
+// Quadrillage de size × size carrefours : durées aléatoires, un tronçon sur dix à sens unique.
+void buildGrid(RoadGraphBuilder& builder, int size, quint32 seed, ArcMap& arcs)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> duration(5.0, 60.0);
+    std::uniform_int_distribution<int> oneWay(0, 9);
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) builder.addNode(GridLat + row * GridLatStep, GridLon + col * GridLonStep);
+    }
+    auto add = [&](quint32 from, quint32 to, double seconds) {
+        builder.addEdge(from, to, seconds);
+        const qint64 ms = std::llround(seconds * 1000.0);
+        auto it = arcs.find({from, to});
+        if (it == arcs.end() || it->second > ms) arcs[{from, to}] = ms;
+    };
+    auto road = [&](quint32 a, quint32 b) {
+        const double seconds = duration(rng);
+        const int direction = oneWay(rng);
+        if (direction != 0) add(a, b, seconds);
+        if (direction != 1) add(b, a, seconds);
+    };
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            const quint32 node = quint32(row * size + col);
+            if (col + 1 < size) road(node, node + 1);
+            if (row + 1 < size) road(node, node + quint32(size));
+        }
+    }
+}
+
+// Dijkstra de référence sur le graphe d'origine (sans raccourcis).
+std::vector<qint64> dijkstra(const ArcMap& arcs, int nodeCount, quint32 source)
+{
+    const std::size_t count = std::size_t(nodeCount);
+    std::vector<std::vector<std::pair<quint32, qint64>>> adjacency(count);
+    for (const auto& arc : arcs) adjacency[arc.first.first].push_back({arc.first.second, arc.second});
+    std::vector<qint64> distance(count, std::numeric_limits<qint64>::max());
+    using Entry = std::pair<qint64, quint32>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    distance[source] = 0;
+    queue.push({0, source});
+    while (!queue.empty()) {
+        const Entry entry = queue.top();
+        queue.pop();
+        if (entry.first != distance[entry.second]) continue;
+        for (const auto& next : adjacency[entry.second]) {
+            if (entry.first + next.second >= distance[next.first]) continue;
+            distance[next.first] = entry.first + next.second;
+            queue.push({distance[next.first], next.first});
+        }
+    }
+    return distance;
+}
+
+// Encodeur protobuf minimal, pour fabriquer des extraits PBF de test.
+class ProtoWriter
+{
+public:
+    void varint(int field, quint64 value) { key(field, 0); raw(value); }
+    void sint(int field, qint64 value) { varint(field, zigzag(value)); }
+    void bytes(int field, const QByteArray& value)
+    {
+        key(field, 2);
+        raw(quint64(value.size()));
+        data.append(value);
+    }
+    void packed(int field, const std::vector<quint64>& values)
+    {
+        ProtoWriter inner;
+        for (quint64 value : values) inner.raw(value);
+        bytes(field, inner.data);
+    }
+    static quint64 zigzag(qint64 value) { return (quint64(value) << 1) ^ quint64(value >> 63); }
+
+    QByteArray data;
+
+private:
+    void key(int field, int wireType) { raw(quint64(field) << 3 | quint64(wireType)); }
+    void raw(quint64 value)
+    {
+        while (value >= 0x80) {
+            data.append(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        data.append(char(value));
+    }
+};
+
+using OsmTags = std::vector<std::pair<QByteArray, QByteArray>>;
+
+struct OsmNode {
+    qint64 id;
+    double lat;
+    double lon;
+    OsmTags tags;
+};
+
+struct OsmWay {
+    qint64 id;
+    std::vector<qint64> refs;
+    OsmTags tags;
+};
+
+// PrimitiveBlock : nœuds denses, nœuds simples et chemins, avec décalage et granularité non triviaux.
+QByteArray primitiveBlock(const std::vector<OsmNode>& dense, const std::vector<OsmNode>& plain, const std::vector<OsmWay>& ways)
+{
+    constexpr qint64 Granularity = 100;
+    constexpr qint64 LatOffset = 44000000000; // nanodegrés
+    constexpr qint64 LonOffset = 4000000000;
+    std::vector<QByteArray> strings{QByteArray()};
+    auto stringId = [&strings](const QByteArray& value) {
+        for (std::size_t i = 1; i < strings.size(); ++i) {
+            if (strings[i] == value) return quint64(i);
+        }
+        strings.push_back(value);
+        return quint64(strings.size() - 1);
+    };
+    auto lat = [](double degrees) { return std::llround((degrees * 1e9 - LatOffset) / Granularity); };
+    auto lon = [](double degrees) { return std::llround((degrees * 1e9 - LonOffset) / Granularity); };
+
+    ProtoWriter groups;
+    if (!dense.empty()) {
+        std::vector<quint64> ids, lats, lons, keysVals;
+        qint64 lastId = 0, lastLat = 0, lastLon = 0;
+        for (const OsmNode& node : dense) {
+            ids.push_back(ProtoWriter::zigzag(node.id - lastId));
+            lats.push_back(ProtoWriter::zigzag(lat(node.lat) - lastLat));
+            lons.push_back(ProtoWriter::zigzag(lon(node.lon) - lastLon));
+            lastId = node.id;
+            lastLat = lat(node.lat);
+            lastLon = lon(node.lon);
+            for (const auto& tag : node.tags) {
+                keysVals.push_back(stringId(tag.first));
+                keysVals.push_back(stringId(tag.second));
+            }
+            keysVals.push_back(0);
+        }
+        ProtoWriter denseNodes;
+        denseNodes.packed(1, ids);
+        denseNodes.packed(8, lats);
+        denseNodes.packed(9, lons);
+        denseNodes.packed(10, keysVals);
+        ProtoWriter group;
+        group.bytes(2, denseNodes.data);
+        groups.bytes(2, group.data);
+    }
+    if (!plain.empty()) {
+        ProtoWriter group;
+        for (const OsmNode& node : plain) {
+            ProtoWriter element;
+            element.sint(1, node.id);
+            // Clés et valeurs non empaquetées : forme admise par protobuf, à accepter aussi.
+            for (const auto& tag : node.tags) element.varint(2, stringId(tag.first));
+            for (const auto& tag : node.tags) element.varint(3, stringId(tag.second));
+            element.sint(8, lat(node.lat));
+            element.sint(9, lon(node.lon));
+            group.bytes(1, element.data);
+        }
+        groups.bytes(2, group.data);
+    }
+    if (!ways.empty()) {
+        ProtoWriter group;
+        for (const OsmWay& way : ways) {
+            std::vector<quint64> keys, values, refs;
+            for (const auto& tag : way.tags) {
+                keys.push_back(stringId(tag.first));
+                values.push_back(stringId(tag.second));
+            }
+            qint64 last = 0;
+            for (qint64 ref : way.refs) {
+                refs.push_back(ProtoWriter::zigzag(ref - last));
+                last = ref;
+            }
+            ProtoWriter element;
+            element.varint(1, quint64(way.id));
+            element.packed(2, keys);
+            element.packed(3, values);
+            element.packed(8, refs);
+            group.bytes(3, element.data);
+        }
+        groups.bytes(2, group.data);
+    }
+
+    ProtoWriter table;
+    for (const QByteArray& value : strings) table.bytes(1, value);
+    ProtoWriter block;
+    block.bytes(1, table.data);
+    block.data.append(groups.data);
+    block.varint(17, Granularity);
+    block.varint(19, quint64(LatOffset));
+    block.varint(20, quint64(LonOffset));
+    return block.data;
+}
+
+// Bloc de fichier : longueur (big-endian), BlobHeader, Blob brut ou zlib.
+QByteArray fileBlock(const QByteArray& type, const QByteArray& payload, bool zlib)
+{
+    ProtoWriter blob;
+    if (zlib) {
+        blob.varint(2, quint64(payload.size()));
+        blob.bytes(3, qCompress(payload).mid(4)); // qCompress préfixe la taille : flux zlib seul.
+    } else {
+        blob.bytes(1, payload);
+    }
+    ProtoWriter header;
+    header.bytes(1, type);
+    header.varint(3, quint64(blob.data.size()));
+    QByteArray out(4, Qt::Uninitialized);
+    qToBigEndian(quint32(header.data.size()), out.data());
+    return out + header.data + blob.data;
+}
+
+QByteArray osmHeader(const std::vector<QByteArray>& requiredFeatures)
+{
+    ProtoWriter header;
+    for (const QByteArray& feature : requiredFeatures) header.bytes(4, feature);
+    return fileBlock("OSMHeader", header.data, false);
+}
+
+// Petit quartier : rues nommées, sens unique, giratoire, autoroute, sentier piéton, voie privée,
+// chemin coupé par l'extrait, commerce et village.
+QByteArray townExtract()
+{
+    const std::vector<OsmNode> dense = {
+        {1, 45.000, 5.000, {}},
+        {2, 45.000, 5.001, {}},
+        {3, 45.000, 5.002, {}},
+        {4, 45.001, 5.002, {}},
+        {5, 45.002, 5.002, {}},
+        {6, 45.002, 5.000, {}},
+        {7, 45.001, 5.000, {}},
+        {8, 45.000, 5.003, {}},
+        {9, 44.9995, 5.0025, {}},
+        {30, 44.999, 5.003, {}},
+        {31, 44.998, 5.003, {}},
+        {32, 45.000, 4.999, {}},
+        {33, 45.001, 4.999, {}},
+        {41, 45.003, 5.001, {{"place", "village"}, {"name", "Village Test"}}},
+    };
+    const std::vector<OsmNode> plain = {
+        {40, 45.0005, 5.001, {{"shop", "bakery"}, {"name", "Boulangerie Dupont"}}},
+    };
+    const std::vector<OsmWay> ways = {
+        {100, {1, 2, 3}, {{"highway", "residential"}, {"name", "Rue de la Paix"}}},
+        {101, {3, 4, 5}, {{"highway", "primary"}, {"maxspeed", "50"}, {"name", "Avenue Jean Jaurès"}}},
+        {102, {5, 6, 7, 1}, {{"highway", "secondary"}, {"oneway", "yes"}, {"name", "Rue Sens Unique"}}},
+        {103, {3, 8, 9, 3}, {{"highway", "tertiary"}, {"junction", "roundabout"}}},
+        {104, {9, 30, 31}, {{"highway", "motorway"}, {"maxspeed", "130"}, {"name", "Autoroute du Soleil"}}},
+        {105, {1, 32}, {{"highway", "footway"}, {"name", "Sentier"}}},
+        {106, {7, 33}, {{"highway", "service"}, {"access", "private"}}},
+        {107, {2, 99}, {{"highway", "residential"}, {"name", "Rue Coupée"}}},
+    };
+    return osmHeader({"OsmSchema-V0.6", "DenseNodes"})
+        + fileBlock("OSMData", primitiveBlock(dense, {}, {}), true)
+        + fileBlock("OSMData", primitiveBlock({}, plain, ways), false);
+}
+
+bool writeFile(const QString& path, const QByteArray& bytes)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(bytes) == bytes.size();
+}
+// Petit graphe (deux nœuds) portant seulement des lieux nommés.
+void addTwoNodeNetwork(RoadGraphBuilder& builder)
+{
+    builder.addNode(GridLat, GridLon);
+    builder.addNode(GridLat + GridLatStep, GridLon);
+    builder.addEdge(0, 1, 10.0);
+    builder.addEdge(1, 0, 10.0);
+}
+}
+
+class RoadGraphTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void shortestPath_grid_matchesDijkstra();
+    void open_invalidFiles_rejected();
+    void nearestNode_snapsWithinRadius();
+    void offlineRouter_route_loadsRouteModel();
+    void offlineRouter_oppositeOneWay_snapsToCarriagewayOfTravel();
+    void osmImporter_pbfExtract_buildsRoutableGraph();
+    void osmImporter_maxSpeedAndDirection_parsed();
+    void osmPbfReader_unsupportedInput_rejected();
+    void foldName_frenchText_foldedToSearchForm();
+    void offlineGeocoder_wordPrefixes_rankedByDistance();
+    void offlineGeocoder_largeIndex_matchesExhaustiveSearch();
+    void benchmark_shortestPath2500Nodes();
+};
+
+void RoadGraphTest::shortestPath_grid_matchesDijkstra()
+{
+    // Objectif: garantir que la recherche sur la hiérarchie de contraction donne le plus court chemin exact.
+    // Pourquoi: un raccourci manquant ou mal déplié donnerait un trajet plus long ou impossible à suivre
+    //           (sommets non reliés), sans aucun signe visible à l'écran.
+    // Procédure détaillée:
+    //   1) Quadrillage 40 × 40 (durées aléatoires, sens uniques), contracté puis écrit et reprojeté.
+    //   2) 300 couples départ/arrivée : durée identique au Dijkstra sur le graphe d'origine.
+    //   3) Chemin déplié : chaque pas est un arc d'origine, la somme des durées égale la durée totale.
+    //   4) La recherche ne visite qu'une petite partie du graphe.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("grid.graph"));
+    const int size = 40;
+    ArcMap arcs;
+    RoadGraphBuilder builder;
+    buildGrid(builder, size, 3, arcs);
+    QVERIFY(builder.write(path));
+    QVERIFY(builder.shortcutCount() > 0);
+
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+    QCOMPARE(graph.nodeCount(), size * size);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<quint32> pick(0, quint32(size * size - 1));
+    int maxSettled = 0;
+    for (int query = 0; query < 300; ++query) {
+        const quint32 source = pick(rng);
+        const quint32 target = pick(rng);
+        const qint64 expected = dijkstra(arcs, size * size, source)[target];
+        RoadGraph::Path result;
+        const bool found = graph.shortestPath(source, target, result);
+        if (expected == std::numeric_limits<qint64>::max()) {
+            QVERIFY(!found);
+            continue;
+        }
+        QVERIFY(found);
+        QCOMPARE(std::llround(result.durationSec * 1000.0), expected);
+        QCOMPARE(result.nodes.first(), source);
+        QCOMPARE(result.nodes.last(), target);
+        QCOMPARE(result.segmentDurationsSec.size(), result.nodes.size() - 1);
+        qint64 sum = 0;
+        for (int i = 0; i + 1 < result.nodes.size(); ++i) {
+            const auto arc = arcs.find({result.nodes.at(i), result.nodes.at(i + 1)});
+            QVERIFY(arc != arcs.end());
+            sum += arc->second;
+        }
+        QCOMPARE(sum, expected);
+        maxSettled = std::max(maxSettled, graph.lastSettledCount());
+    }
+    QVERIFY(maxSettled < size * size / 4);
+}
+
+void RoadGraphTest::open_invalidFiles_rejected()
+{
+    // Objectif: vérifier qu'un fichier absent, étranger, d'une autre version ou tronqué est refusé.
+    // Pourquoi: le fichier est lu en place sans décodage ; une section plus courte qu'annoncé ferait lire
+    //           hors de la projection au lieu de simplement désactiver le calcul local.
+    // Procédure détaillée:
+    //   1) Graphe valide de référence (ouverture acceptée).
+    //   2) Fichier absent, signature modifiée, version modifiée, fichier coupé en deux : refusés.
+    //   3) Après un refus, le graphe est fermé et les requêtes échouent proprement.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("grid.graph"));
+    ArcMap arcs;
+    RoadGraphBuilder builder;
+    buildGrid(builder, 10, 5, arcs);
+    QVERIFY(builder.write(path));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray valid = file.readAll();
+    file.close();
+
+    auto openBytes = [&dir](const QByteArray& bytes) {
+        const QString altered = dir.filePath(QStringLiteral("altered.graph"));
+        QFile out(altered);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        out.write(bytes);
+        out.close();
+        RoadGraph graph;
+        return graph.open(altered);
+    };
+    QVERIFY(openBytes(valid));
+
+    QByteArray badMagic = valid;
+    badMagic[0] = 'X';
+    QVERIFY(!openBytes(badMagic));
+
+    QByteArray badVersion = valid;
+    badVersion[8] = char(RoadGraph::Version + 1);
+    QVERIFY(!openBytes(badVersion));
+
+    QVERIFY(!openBytes(valid.left(valid.size() / 2)));
+
+    RoadGraph graph;
+    QVERIFY(!graph.open(dir.filePath(QStringLiteral("absent.graph"))));
+    QVERIFY(!graph.isOpen());
+    RoadGraph::Path result;
+    QVERIFY(!graph.shortestPath(0, 1, result));
+    QCOMPARE(graph.nearestNode(GridLat, GridLon), RoadGraph::NoNode);
+}
+
+void RoadGraphTest::nearestNode_snapsWithinRadius()
+{
+    // Objectif: valider le recalage d'une position sur le carrefour le plus proche via la grille.
+    // Pourquoi: départ (véhicule) et arrivée (adresse) ne sont jamais exactement sur un nœud ; un mauvais
+    //           recalage ferait partir le trajet d'une rue parallèle.
+    // Procédure détaillée:
+    //   1) Quadrillage 30 × 30 (≈ 3,3 km de côté, plusieurs cellules de grille).
+    //   2) Points décalés de quelques dizaines de mètres d'un carrefour : ce carrefour est retenu.
+    //   3) Point à plus de SnapRadiusM du réseau : aucun nœud.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("grid.graph"));
+    const int size = 30;
+    ArcMap arcs;
+    RoadGraphBuilder builder;
+    buildGrid(builder, size, 9, arcs);
+    QVERIFY(builder.write(path));
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+
+    for (int row : {0, 7, 18, 29}) {
+        for (int col : {0, 11, 29}) {
+            const double lat = GridLat + row * GridLatStep + 0.0002;
+            const double lon = GridLon + col * GridLonStep - 0.0003;
+            QCOMPARE(graph.nearestNode(lat, lon), quint32(row * size + col));
+            QVERIFY(graph.coordinate(graph.nearestNode(lat, lon)).distanceTo(QGeoCoordinate(lat, lon)) < 40.0);
+        }
+    }
+    QCOMPARE(graph.nearestNode(GridLat - 0.01, GridLon), RoadGraph::NoNode);
+    QCOMPARE(graph.nearestNode(GridLat + 1.0, GridLon + 1.0), RoadGraph::NoNode);
+}
+
+void RoadGraphTest::offlineRouter_route_loadsRouteModel()
+{
+    // Objectif: vérifier la chaîne complète hors ligne : graphe projeté -> trajet -> RouteModel.
+    // Pourquoi: c'est ce qu'appelle map.qml sans réseau, au premier calcul comme à chaque recalcul ;
+    //           le tracé doit être exploitable par le guidage (durées, distance restante).
+    // Procédure détaillée:
+    //   1) Sans graphe : indisponible, route() refusé, itinéraire inchangé.
+    //   2) Graphe chargé : availableChanged émis, trajet calculé en quelques millisecondes.
+    //   3) Le RouteModel reçoit un tracé qui part de la position du véhicule, rejoint le carrefour de
+    //      départ, arrive au carrefour d'arrivée, avec la durée du graphe (plus l'approche) comme durée
+    //      restante.
+    //   4) Arrivée hors du réseau : refus, l'itinéraire précédent est conservé.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("grid.graph"));
+    const int size = 20;
+    ArcMap arcs;
+    RoadGraphBuilder builder;
+    buildGrid(builder, size, 21, arcs);
+    QVERIFY(builder.write(path));
+
+    RouteModel model;
+    OfflineRouter router(&model);
+    QVERIFY(!router.isAvailable());
+    QVERIFY(!router.route(GridLat, GridLon, GridLat + 0.01, GridLon + 0.01));
+    QVERIFY(!model.hasRoute());
+
+    QSignalSpy availableSpy(&router, &OfflineRouter::availableChanged);
+    QVERIFY(router.load(path));
+    QCOMPARE(availableSpy.count(), 1);
+    QVERIFY(router.isAvailable());
+
+    // Au sud-ouest du premier carrefour : les deux rues qui en partent s'y projettent.
+    const QGeoCoordinate car(GridLat - 0.0001, GridLon - 0.0001);
+    QVERIFY(router.route(car.latitude(), car.longitude(),
+                         GridLat + (size - 1) * GridLatStep, GridLon + (size - 1) * GridLonStep + 0.0001));
+    QVERIFY(router.lastQueryMs() < 50.0);
+    QVERIFY(model.hasRoute());
+    QVERIFY(model.pointCount() >= 2 * (size - 1) + 2);
+    const QGeoCoordinate start(GridLat, GridLon);
+    const QGeoCoordinate end(GridLat + (size - 1) * GridLatStep, GridLon + (size - 1) * GridLonStep);
+    QVERIFY(model.point(0).distanceTo(car) < 0.01);
+    QVERIFY(model.point(1).distanceTo(start) < 0.01);
+    QVERIFY(model.point(model.pointCount() - 1).distanceTo(end) < 0.01);
+    const double blocks = start.distanceTo(QGeoCoordinate(end.latitude(), GridLon))
+        + start.distanceTo(QGeoCoordinate(GridLat, end.longitude()));
+    QVERIFY(model.totalDistance() > blocks * 0.99);
+    const qint64 expectedMs = dijkstra(arcs, size * size, 0)[std::size_t(size * size - 1)];
+    const double approachSec = car.distanceTo(start) / (OfflineRouter::ApproachSpeedKmh / 3.6);
+    QVERIFY(std::abs(model.remainingDuration() - expectedMs / 1000.0 - approachSec) < 0.05);
+
+    const int pointCount = model.pointCount();
+    QVERIFY(!router.route(GridLat, GridLon, GridLat + 1.0, GridLon));
+    QCOMPARE(model.pointCount(), pointCount);
+}
+
+void RoadGraphTest::offlineRouter_oppositeOneWay_snapsToCarriagewayOfTravel()
+{
+    // Objectif: vérifier que le départ est recalé sur la chaussée empruntée, pas sur le nœud le plus proche.
+    // Pourquoi: sur une voie séparée, le nœud le plus proche peut être sur la chaussée opposée (sens
+    //           unique inverse) : le tracé partait alors à contresens, aussitôt jugé hors itinéraire,
+    //           et chaque position relançait un recalcul qui annulait l'affinage Mapbox.
+    // Procédure détaillée:
+    //   1) Deux chaussées à sens unique (nord vers l'est, sud vers l'ouest) reliées à leurs extrémités ;
+    //      le véhicule roule vers l'est sur la chaussée nord, loin de ses nœuds, près d'un nœud de la
+    //      chaussée sud : nearestNode() retient ce dernier.
+    //   2) Cap est : le tracé part de la position du véhicule, rejoint la chaussée nord et va vers l'est
+    //      jusqu'à la destination, sans détour par la chaussée sud.
+    //   3) Cap ouest : le même départ est recalé sur la chaussée sud.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("carriageways.graph"));
+    RoadGraphBuilder builder;
+    const quint32 northWest = builder.addNode(GridLat + 0.0003, GridLon - 0.004);
+    const quint32 northEast = builder.addNode(GridLat + 0.0003, GridLon + 0.004);
+    const quint32 southEast = builder.addNode(GridLat, GridLon + 0.004);
+    const quint32 southMiddle = builder.addNode(GridLat, GridLon);
+    const quint32 southWest = builder.addNode(GridLat, GridLon - 0.004);
+    builder.addEdge(northWest, northEast, 45.0);
+    builder.addEdge(northEast, southEast, 3.0);
+    builder.addEdge(southEast, southMiddle, 22.0);
+    builder.addEdge(southMiddle, southWest, 23.0);
+    builder.addEdge(southWest, northWest, 3.0);
+    QVERIFY(builder.write(path));
+
+    const QGeoCoordinate car(GridLat + 0.00025, GridLon + 0.0001); // ≈ 6 m de la chaussée nord.
+    const QGeoCoordinate destination(GridLat + 0.0004, GridLon + 0.0035);
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+    QCOMPARE(graph.nearestNode(car.latitude(), car.longitude()), southMiddle);
+
+    RouteModel model;
+    OfflineRouter router(&model);
+    QVERIFY(router.load(path));
+    QVERIFY(router.route(car.latitude(), car.longitude(), destination.latitude(), destination.longitude(), 90.0));
+    QVERIFY(model.pointCount() >= 3);
+    QVERIFY(model.point(0).distanceTo(car) < 0.01);
+    QVERIFY(std::abs(model.point(1).latitude() - (GridLat + 0.0003)) < 1e-6);
+    for (int i = 1; i < model.pointCount(); ++i) {
+        QVERIFY(model.point(i).latitude() > GridLat + 0.0002);
+        QVERIFY(model.point(i).longitude() >= model.point(i - 1).longitude());
+    }
+    QVERIFY(model.totalDistance() < 400.0);
+
+    QVERIFY(router.route(car.latitude(), car.longitude(), destination.latitude(), destination.longitude(), 270.0));
+    QVERIFY(model.point(0).distanceTo(car) < 0.01);
+    QVERIFY(std::abs(model.point(1).latitude() - GridLat) < 1e-6);
+    QVERIFY(model.totalDistance() > 600.0);
+}
+
+void RoadGraphTest::osmImporter_pbfExtract_buildsRoutableGraph()
+{
+    // Objectif: valider la chaîne de préparation complète : extrait PBF -> graphe -> fichier projeté.
+    // Pourquoi: c'est ce qui produit le fichier embarqué ; un sens unique ignoré ferait proposer des
+    //           contresens, une voie piétonne retenue ferait passer la voiture par un sentier.
+    // Procédure détaillée:
+    //   1) Extrait fabriqué : bloc zlib (nœuds denses) puis bloc brut (nœud simple et chemins).
+    //   2) Seuls les chemins carrossables et les nœuds qu'ils utilisent sont retenus ; le tronçon coupé
+    //      par l'extrait est compté et ignoré.
+    //   3) Sens unique, giratoire et autoroute ne se parcourent que dans le sens autorisé.
+    //   4) Les limitations connues accompagnent chaque arc du trajet, -1 sinon.
+    //   5) Rues, commerce et village sont dans l'index des noms ; sentier et voie coupée n'y sont pas.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString pbfPath = dir.filePath(QStringLiteral("town.osm.pbf"));
+    const QString graphPath = dir.filePath(QStringLiteral("town.graph"));
+    QVERIFY(writeFile(pbfPath, townExtract()));
+
+    RoadGraphBuilder builder;
+    OsmGraphImporter importer(builder);
+    QVERIFY2(importer.import(pbfPath), qPrintable(importer.errorString()));
+    QCOMPARE(importer.stats().roadWays, qint64(6));
+    QCOMPARE(importer.stats().roadNodes, qint64(11));
+    QCOMPARE(importer.stats().edges, qint64(16));
+    QCOMPARE(importer.stats().missingNodes, qint64(1));
+    QVERIFY(builder.write(graphPath));
+
+    RoadGraph graph;
+    QVERIFY(graph.open(graphPath));
+    QCOMPARE(graph.nodeCount(), 11);
+    auto at = [&graph](double lat, double lon) { return graph.nearestNode(lat, lon, 1.0); };
+    auto route = [&graph](quint32 from, quint32 to, RoadGraph::Path& path) {
+        path = RoadGraph::Path();
+        return graph.shortestPath(from, to, path);
+    };
+    const quint32 n1 = at(45.000, 5.000), n2 = at(45.000, 5.001), n3 = at(45.000, 5.002);
+    const quint32 n4 = at(45.001, 5.002), n5 = at(45.002, 5.002), n6 = at(45.002, 5.000);
+    const quint32 n7 = at(45.001, 5.000), n8 = at(45.000, 5.003), n9 = at(44.9995, 5.0025);
+    const quint32 n31 = at(44.998, 5.003);
+    for (quint32 node : {n1, n2, n3, n4, n5, n6, n7, n8, n9, n31}) QVERIFY(node != RoadGraph::NoNode);
+
+    RoadGraph::Path path;
+    QVERIFY(route(n1, n5, path));
+    QCOMPARE(path.nodes, QList<quint32>({n1, n2, n3, n4, n5}));
+    QCOMPARE(path.segmentSpeedLimitsKmh, QList<int>({-1, -1, 50, 50}));
+    QVERIFY(route(n5, n1, path));
+    QCOMPARE(path.nodes, QList<quint32>({n5, n6, n7, n1}));
+
+    QVERIFY(route(n3, n8, path));
+    QCOMPARE(path.nodes, QList<quint32>({n3, n8}));
+    QVERIFY(route(n8, n3, path));
+    QCOMPARE(path.nodes, QList<quint32>({n8, n9, n3}));
+
+    QVERIFY(route(n9, n31, path));
+    QCOMPARE(path.segmentSpeedLimitsKmh, QList<int>({130, 130}));
+    QVERIFY(!route(n31, n9, path));
+
+    QCOMPARE(graph.placeCount(), 6);
+    auto find = [&graph](const QString& name) {
+        const int index = graph.lowerBoundPlace(name.toUtf8());
+        return index < graph.placeCount() && graph.placeName(index) == name ? index : -1;
+    };
+    const int paix = find(QStringLiteral("Rue de la Paix"));
+    QVERIFY(paix >= 0);
+    QCOMPARE(RoadGraph::PlaceKind(graph.place(paix).kind), RoadGraph::PlaceKind::Street);
+    QVERIFY(graph.placeCoordinate(paix).distanceTo(QGeoCoordinate(45.000, 5.001)) < 0.1);
+    QVERIFY(find(QStringLiteral("Avenue Jean Jaurès")) >= 0);
+    const int bakery = find(QStringLiteral("Boulangerie Dupont"));
+    QVERIFY(bakery >= 0);
+    QCOMPARE(RoadGraph::PlaceKind(graph.place(bakery).kind), RoadGraph::PlaceKind::PointOfInterest);
+    QVERIFY(graph.placeCoordinate(bakery).distanceTo(QGeoCoordinate(45.0005, 5.001)) < 0.1);
+    const int village = find(QStringLiteral("Village Test"));
+    QVERIFY(village >= 0);
+    QCOMPARE(RoadGraph::PlaceKind(graph.place(village).kind), RoadGraph::PlaceKind::Locality);
+    QCOMPARE(find(QStringLiteral("Sentier")), -1);
+    QCOMPARE(find(QStringLiteral("Rue Coupée")), -1);
+}
+
+void RoadGraphTest::osmImporter_maxSpeedAndDirection_parsed()
+{
+    // Objectif: couvrir les formes courantes de `maxspeed` et des sens uniques implicites.
+    // Pourquoi: la limitation affichée et la durée estimée en dépendent ; une valeur mal lue doit
+    //           retomber sur « inconnue » plutôt que sur un chiffre faux.
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("50"), 50);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("90 km/h"), 90);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("30 mph"), 48);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("FR:urban"), 50);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("FR:rural"), 80);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("FR:motorway"), 130);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("FR:zone30"), 30);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("none"), 0);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("signals"), 0);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed("50;30"), 0);
+    QCOMPARE(OsmGraphImporter::parseMaxSpeed(""), 0);
+
+    using Direction = OsmGraphImporter::Direction;
+    QCOMPARE(OsmGraphImporter::direction({}), Direction::Both);
+    QCOMPARE(OsmGraphImporter::direction({{"oneway", "yes"}}), Direction::Forward);
+    QCOMPARE(OsmGraphImporter::direction({{"oneway", "-1"}}), Direction::Backward);
+    QCOMPARE(OsmGraphImporter::direction({{"junction", "roundabout"}}), Direction::Forward);
+    QCOMPARE(OsmGraphImporter::direction({{"highway", "motorway"}}), Direction::Forward);
+    QCOMPARE(OsmGraphImporter::direction({{"highway", "motorway"}, {"oneway", "no"}}), Direction::Both);
+
+    QCOMPARE(OsmGraphImporter::defaultSpeedKmh("footway"), 0);
+    QCOMPARE(OsmGraphImporter::defaultSpeedKmh("cycleway"), 0);
+    QVERIFY(OsmGraphImporter::defaultSpeedKmh("residential") > 0);
+    QVERIFY(OsmGraphImporter::defaultSpeedKmh("motorway") > OsmGraphImporter::defaultSpeedKmh("primary"));
+}
+
+void RoadGraphTest::osmPbfReader_unsupportedInput_rejected()
+{
+    // Objectif: vérifier le décodage élément par élément et le refus des extraits inexploitables.
+    // Pourquoi: l'outil de préparation doit échouer explicitement plutôt que produire un graphe
+    //           silencieusement incomplet (bloc tronqué, compression non gérée, format exigé inconnu).
+    // Procédure détaillée:
+    //   1) Extrait valide : tous les nœuds et chemins sont livrés, positions exactes.
+    //   2) Fichier absent, tronqué, bloc lzma, fonctionnalité exigée inconnue : refus avec message.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("extract.osm.pbf"));
+    const QByteArray valid = townExtract();
+    QVERIFY(writeFile(path, valid));
+
+    OsmPbfReader reader;
+    int nodes = 0;
+    int ways = 0;
+    double lat9 = 0.0;
+    reader.setNodeHandler([&](qint64 id, double lat, double, const OsmPbfReader::Tags&) {
+        ++nodes;
+        if (id == 9) lat9 = lat;
+    });
+    reader.setWayHandler([&](qint64, const std::vector<qint64>&, const OsmPbfReader::Tags&) { ++ways; });
+    QVERIFY2(reader.read(path), qPrintable(reader.errorString()));
+    QCOMPARE(reader.blockCount(), qint64(2));
+    QCOMPARE(nodes, 15);
+    QCOMPARE(ways, 8);
+    QVERIFY(std::abs(lat9 - 44.9995) < 1e-9);
+
+    auto rejected = [&](const QByteArray& bytes) {
+        if (!writeFile(path, bytes)) return false;
+        OsmPbfReader other;
+        other.setNodeHandler([](qint64, double, double, const OsmPbfReader::Tags&) {});
+        return !other.read(path) && !other.errorString().isEmpty();
+    };
+    QVERIFY(rejected(valid.left(valid.size() - 10)));
+    QVERIFY(rejected(osmHeader({"OsmSchema-V0.6", "HistoricalInformation"})));
+
+    ProtoWriter lzma;
+    lzma.varint(2, 16);
+    lzma.bytes(4, QByteArray(8, 'x'));
+    ProtoWriter header;
+    header.bytes(1, "OSMData");
+    header.varint(3, quint64(lzma.data.size()));
+    QByteArray lzmaBlock(4, Qt::Uninitialized);
+    qToBigEndian(quint32(header.data.size()), lzmaBlock.data());
+    QVERIFY(rejected(osmHeader({"OsmSchema-V0.6"}) + lzmaBlock + header.data + lzma.data));
+
+    OsmPbfReader absent;
+    QVERIFY(!absent.read(dir.filePath(QStringLiteral("absent.osm.pbf"))));
+}
+
+void RoadGraphTest::foldName_frenchText_foldedToSearchForm()
+{
+    // Objectif: fixer la forme de recherche des noms (index et saisie passent par la même fonction).
+    // Pourquoi: sur le clavier tactile, l'utilisateur tape « eglise » ou « jaures » sans accents ; une
+    //           lettre repliée différemment d'un côté et de l'autre rendrait le lieu introuvable.
+    auto fold = [](const char* utf8) { return RoadGraph::foldName(utf8); };
+    QCOMPARE(fold("Avenue Jean Jaurès"), QByteArray("avenue jean jaures"));
+    QCOMPARE(fold("Place de l'Église"), QByteArray("place de l eglise"));
+    QCOMPARE(fold("L\u2019Haÿ-les-Roses"), QByteArray("l hay les roses"));
+    QCOMPARE(fold("  Œuvre   Saint-Éloi  "), QByteArray("oeuvre saint eloi"));
+    QCOMPARE(fold("Straße ÆÇ"), QByteArray("strasse aec"));
+    QCOMPARE(fold("Rue du 8 Mai 1945"), QByteArray("rue du 8 mai 1945"));
+    QCOMPARE(fold("«\u00a0Chez Léa\u00a0»"), QByteArray("chez lea"));
+    QCOMPARE(fold("Москва"), QByteArray("Москва")); // Autres écritures conservées.
+    QCOMPARE(fold("a\xff" "b"), QByteArray("a b"));    // Octet invalide : séparateur.
+    QCOMPARE(fold(""), QByteArray());
+}
+
+void RoadGraphTest::offlineGeocoder_wordPrefixes_rankedByDistance()
+{
+    // Objectif: valider l'autocomplétion locale : préfixes de mots, accents ignorés, tri par distance.
+    // Pourquoi: c'est ce qui remplace la requête Mapbox à chaque frappe ; la suggestion la plus utile
+    //           est la plus proche du véhicule, et une rue découpée en plusieurs lieux ne doit
+    //           apparaître qu'une fois.
+    // Procédure détaillée:
+    //   1) Index de quelques lieux, dont la même avenue en trois points éloignés.
+    //   2) « av jean jau » : l'avenue, une seule fois, au point le plus proche de la position.
+    //   3) « jean » : tous les noms contenant un mot commençant par « jean », du plus proche au plus loin.
+    //   4) Saisie sans accents, avec accents, en majuscules : mêmes résultats.
+    //   5) Saisie trop courte, sans correspondance ou graphe sans index : aucun résultat.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("places.graph"));
+    RoadGraphBuilder builder;
+    addTwoNodeNetwork(builder);
+    builder.addPlace(QByteArray("Avenue Jean Jaurès"), 45.10, 5.00, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Avenue Jean Jaurès"), 45.01, 5.00, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Avenue Jean Jaurès"), 45.30, 5.00, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Rue Jean Moulin"), 45.02, 5.00, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Saint-Jean-de-Moirans"), 45.05, 5.00, RoadGraph::PlaceKind::Locality);
+    builder.addPlace(QByteArray("Place de l'Église"), 45.00, 5.01, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Boulangerie Dupont"), 45.00, 5.02, RoadGraph::PlaceKind::PointOfInterest);
+    QVERIFY(builder.write(path));
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+    QVERIFY(graph.hasWordIndex());
+    OfflineGeocoder geocoder(graph);
+    QVERIFY(geocoder.isAvailable());
+    const QGeoCoordinate here(45.0, 5.0);
+
+    QList<OfflineGeocoder::Result> results = geocoder.search(QStringLiteral("av jean jau"), here);
+    QCOMPARE(results.size(), 1);
+    QCOMPARE(results.first().name, QStringLiteral("Avenue Jean Jaurès"));
+    QCOMPARE(results.first().kind, RoadGraph::PlaceKind::Street);
+    QVERIFY(results.first().position.distanceTo(QGeoCoordinate(45.01, 5.00)) < 1.0);
+    QVERIFY(std::abs(results.first().distanceM - here.distanceTo(results.first().position)) < 0.01);
+
+    results = geocoder.search(QStringLiteral("jean"), here, 10);
+    QStringList names;
+    for (const OfflineGeocoder::Result& result : results) names << result.name;
+    QCOMPARE(names, QStringList({QStringLiteral("Avenue Jean Jaurès"), QStringLiteral("Rue Jean Moulin"),
+                                 QStringLiteral("Saint-Jean-de-Moirans")}));
+    for (int i = 1; i < results.size(); ++i) QVERIFY(results.at(i - 1).distanceM <= results.at(i).distanceM);
+
+    for (const QString& query : {QStringLiteral("eglise"), QStringLiteral("ÉGLISE"), QStringLiteral("pl de l'égl")}) {
+        results = geocoder.search(query, here);
+        QCOMPARE(results.size(), 1);
+        QCOMPARE(results.first().name, QStringLiteral("Place de l'Église"));
+    }
+    results = geocoder.search(QStringLiteral("boul dup"), QGeoCoordinate());
+    QCOMPARE(results.size(), 1);
+    QCOMPARE(results.first().distanceM, -1.0);
+    QCOMPARE(OfflineGeocoder::label(results.first()), QStringLiteral("Boulangerie Dupont"));
+
+    QVERIFY(geocoder.search(QStringLiteral("je"), here).isEmpty());
+    QVERIFY(geocoder.search(QStringLiteral("jean zzz"), here).isEmpty());
+    QVERIFY(geocoder.search(QStringLiteral("xyz"), here).isEmpty());
+
+    OfflineGeocoder::Result labelled;
+    labelled.name = QStringLiteral("Rue Jean Moulin");
+    labelled.distanceM = 1234.0;
+    QCOMPARE(OfflineGeocoder::label(labelled), QStringLiteral("Rue Jean Moulin (1,2 km)"));
+    labelled.distanceM = 456.0;
+    QCOMPARE(OfflineGeocoder::label(labelled), QStringLiteral("Rue Jean Moulin (460 m)"));
+
+    // Graphe sans lieux : l'index des mots existe mais est vide ; graphe fermé : indisponible.
+    const QString emptyPath = dir.filePath(QStringLiteral("empty.graph"));
+    RoadGraphBuilder emptyBuilder;
+    addTwoNodeNetwork(emptyBuilder);
+    QVERIFY(emptyBuilder.write(emptyPath));
+    RoadGraph empty;
+    QVERIFY(empty.open(emptyPath));
+    OfflineGeocoder emptyGeocoder(empty);
+    QVERIFY(emptyGeocoder.search(QStringLiteral("jean"), here).isEmpty());
+    empty.close();
+    QVERIFY(!emptyGeocoder.isAvailable());
+}
+
+void RoadGraphTest::offlineGeocoder_largeIndex_matchesExhaustiveSearch()
+{
+    // Objectif: vérifier sur un index de taille régionale que la recherche par plages de l'index donne
+    //           exactement le résultat d'un parcours exhaustif, dans le budget d'une frappe.
+    // Pourquoi: le codage par préfixe et la dichotomie sur les blocs ne se voient pas sur quelques lieux ;
+    //           une frontière de bloc mal gérée ferait disparaître des mots entiers.
+    // Procédure détaillée:
+    //   1) 50 000 lieux aux noms générés (accents, apostrophes, types de voie), sur 1° × 1°.
+    //   2) 200 saisies (préfixe seul, type de voie abrégé + préfixe, nom complet) depuis des positions
+    //      aléatoires : mêmes cinq noms, dans le même ordre, que le parcours de tous les lieux.
+    //   3) Durée moyenne d'une recherche sous 5 ms.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("places.graph"));
+    std::mt19937 rng(23);
+    const char* syllables[] = {"ma", "ri", "jo", "lé", "pa", "su", "tan", "ver", "ch", "ô", "lou", "gé",
+                               "ra", "ni", "co", "vil", "mont", "bel", "sa", "é", "ter", "ne", "ro"};
+    const char* types[] = {"Rue", "Avenue", "Boulevard", "Place", "Impasse", "Chemin", "Allée", "Quai"};
+    const char* links[] = {"de la ", "du ", "des ", "de l'", "", "d'"};
+    std::vector<std::string> words;
+    for (int i = 0; i < 3000; ++i) {
+        std::string word;
+        for (int k = 2 + int(rng() % 3); k > 0; --k) word += syllables[rng() % std::size(syllables)];
+        word[0] = char(std::toupper(uchar(word[0])));
+        words.push_back(word);
+    }
+    RoadGraphBuilder builder;
+    addTwoNodeNetwork(builder);
+    std::uniform_real_distribution<double> lat(45.0, 46.0);
+    std::uniform_real_distribution<double> lon(4.5, 5.5);
+    for (int i = 0; i < 50000; ++i) {
+        std::string name = std::string(types[rng() % std::size(types)]) + " " + links[rng() % std::size(links)]
+            + words[rng() % words.size()];
+        if (rng() % 3 == 0) name += " " + words[rng() % words.size()];
+        builder.addPlace(QByteArray(name.c_str()), lat(rng), lon(rng), RoadGraph::PlaceKind::Street);
+    }
+    QVERIFY(builder.write(path));
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+    OfflineGeocoder geocoder(graph);
+
+    std::vector<std::string> folded(std::size_t(graph.placeCount()));
+    for (int i = 0; i < graph.placeCount(); ++i) {
+        const QByteArray name = RoadGraph::foldName(graph.placeBytes(i));
+        folded[std::size_t(i)] = std::string(name.constData(), std::size_t(name.size()));
+    }
+    auto hasWordPrefix = [](const std::string& name, const std::string& prefix) {
+        for (std::size_t start = 0; start < name.size();) {
+            if (name.compare(start, prefix.size(), prefix) == 0) return true;
+            const std::size_t space = name.find(' ', start);
+            if (space == std::string::npos) break;
+            start = space + 1;
+        }
+        return false;
+    };
+
+    double totalMs = 0.0;
+    int searches = 0;
+    for (int query = 0; query < 200; ++query) {
+        const std::string& word = words[rng() % words.size()];
+        std::string text;
+        switch (query % 3) {
+        case 0: text = word.substr(0, 4); break;
+        case 1: text = std::string(types[rng() % std::size(types)]).substr(0, 3) + " " + word.substr(0, 3); break;
+        default: text = "rue " + word; break;
+        }
+        const QByteArray foldedText = RoadGraph::foldName(text);
+        if (foldedText.size() < OfflineGeocoder::MinQueryLength || QString::fromUtf8(text.c_str()).contains(QChar(0xFFFD))) continue;
+        const QGeoCoordinate from(lat(rng), lon(rng));
+
+        // Parcours exhaustif : meilleur point par nom, cinq noms les plus proches.
+        std::vector<std::string> queryWords;
+        for (const QByteArray& part : foldedText.split(' ')) queryWords.push_back(part.toStdString());
+        std::map<std::string, double> nearest;
+        const double cosLat = std::cos(qDegreesToRadians(from.latitude()));
+        for (int i = 0; i < graph.placeCount(); ++i) {
+            bool all = true;
+            for (const std::string& part : queryWords) all = all && hasWordPrefix(folded[std::size_t(i)], part);
+            if (!all) continue;
+            const QGeoCoordinate position = graph.placeCoordinate(i);
+            const double dLat = position.latitude() - from.latitude();
+            const double dLon = (position.longitude() - from.longitude()) * cosLat;
+            const std::string name(graph.placeBytes(i));
+            const auto it = nearest.find(name);
+            if (it == nearest.end() || it->second > dLat * dLat + dLon * dLon) nearest[name] = dLat * dLat + dLon * dLon;
+        }
+        std::vector<std::pair<double, std::string>> expected;
+        for (const auto& entry : nearest) expected.push_back({entry.second, entry.first});
+        std::sort(expected.begin(), expected.end());
+        if (expected.size() > 5) expected.resize(5);
+
+        const QList<OfflineGeocoder::Result> results = geocoder.search(QString::fromUtf8(text.c_str()), from, 5);
+        totalMs += geocoder.lastSearchMs();
+        ++searches;
+        QCOMPARE(std::size_t(results.size()), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            QCOMPARE(results.at(int(i)).name, QString::fromUtf8(expected[i].second.c_str()));
+        }
+    }
+    QVERIFY(searches > 150);
+    QVERIFY2(totalMs / searches < 5.0, qPrintable(QStringLiteral("%1 ms en moyenne").arg(totalMs / searches)));
+}
+
+void RoadGraphTest::benchmark_shortestPath2500Nodes()
+{
+    // Objectif: mesurer une requête d'un coin à l'autre d'un quadrillage de 2500 carrefours.
+    // Pourquoi: le recalcul hors itinéraire se fait dans le thread de l'interface ; il doit rester
+    //           de l'ordre de la milliseconde sur le Raspberry Pi.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("grid.graph"));
+    const int size = 50;
+    ArcMap arcs;
+    RoadGraphBuilder builder;
+    buildGrid(builder, size, 17, arcs);
+    QVERIFY(builder.write(path));
+    RoadGraph graph;
+    QVERIFY(graph.open(path));
+    RoadGraph::Path result;
+
+    QBENCHMARK {
+        graph.shortestPath(0, quint32(size * size - 1), result);
+    }
+    QVERIFY(result.nodes.size() >= 2 * (size - 1) + 1);
+}
+
+QTEST_GUILESS_MAIN(RoadGraphTest)
+#include "tst_roadgraph.moc"
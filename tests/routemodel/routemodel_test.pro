@@ -0,0 +1,20 @@
+QT += testlib core positioning
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = routemodel_test
+
+SOURCES += \
+    tst_routemodel.cpp \
+    ../../routemodel.cpp \
+    ../../segmentgrid.cpp \
+    ../../routematcher.cpp \
+    ../../routestrip.cpp \
+    ../../polylinesimplifier.cpp
+
+HEADERS += \
+    ../../routemodel.h \
+    ../../segmentgrid.h \
+    ../../routematcher.h \
+    ../../routestrip.h \
+    ../../polylinesimplifier.h
@@ -0,0 +1,650 @@
+#include <QtTest>
+#include <QGeoCoordinate>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "../../polylinesimplifier.h"
+#include "../../routemodel.h"
+#include "../../routestrip.h"
+
+namespace {
+// Trajet synthétique : `count` sommets espacés d'environ `stepM` mètres, virages doux vers l'est.
+QList<QGeoCoordinate> synthetic(int count, double stepM)
+{
+    QList<QGeoCoordinate> points;
+    QGeoCoordinate current(48.2715, 4.0645);
+    for (int i = 0; i < count; ++i) {
+        points.append(current);
+        current = current.atDistanceAndAzimuth(stepM, 20.0 * std::sin(i / 50.0));
+    }
+    return points;
+}
+
+// Trajet sinueux avec quelques longs segments (autoroute) et des boucles qui se recoupent.
+QList<QGeoCoordinate> winding(int count, quint32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> turn(-0.3, 0.3);
+    std::uniform_real_distribution<double> length(5.0, 35.0);
+    QList<QGeoCoordinate> points;
+    QGeoCoordinate current(48.2715, 4.0645);
+    double azimuth = 0.0;
+    for (int i = 0; i < count; ++i) {
+        points.append(current);
+        azimuth += turn(rng) * 180.0 / M_PI;
+        current = current.atDistanceAndAzimuth(i % 100 == 0 ? 2000.0 : length(rng), azimuth);
+    }
+    return points;
+}
+
+// Douglas-Peucker récursif de référence (sommets intérieurs retenus entre a et b).
+double segmentDistance(const std::vector<double>& xy, int p, int a, int b)
+{
+    const double ax = xy[2 * a];
+    const double ay = xy[2 * a + 1];
+    const double dx = xy[2 * b] - ax;
+    const double dy = xy[2 * b + 1] - ay;
+    const double lengthSq = dx * dx + dy * dy;
+    const double t = lengthSq > 0.0 ? std::clamp(((xy[2 * p] - ax) * dx + (xy[2 * p + 1] - ay) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+    return std::hypot(xy[2 * p] - ax - t * dx, xy[2 * p + 1] - ay - t * dy);
+}
+
+void douglasPeucker(const std::vector<double>& xy, int a, int b, double tolerance, std::vector<int>& kept)
+{
+    if (b - a < 2) return;
+    int farthest = -1;
+    double distance = -1.0;
+    for (int i = a + 1; i < b; ++i) {
+        const double d = segmentDistance(xy, i, a, b);
+        if (d > distance) {
+            distance = d;
+            farthest = i;
+        }
+    }
+    if (distance <= tolerance) return;
+    douglasPeucker(xy, a, farthest, tolerance, kept);
+    kept.push_back(farthest);
+    douglasPeucker(xy, farthest, b, tolerance, kept);
+}
+
+QVariantMap mapboxRoute()
+{
+    // Extrait d'une réponse Directions (geometries=geojson, annotations=maxspeed,congestion).
+    const QByteArray json = R"({
+        "distance": 300.0, "duration": 30.0,
+        "geometry": {"type": "LineString",
+                     "coordinates": [[4.0645, 48.2715], [4.0645, 48.2724], [4.0658, 48.2724], [4.0658, 48.2733]]},
+        "legs": [{"annotation": {
+            "congestion": ["low", "heavy", "moderate"],
+            "maxspeed": [{"speed": 50, "unit": "km/h"}, {"unknown": true}, {"speed": 30, "unit": "mph"}],
+            "duration": [7.5, 14.0, 8.5]
+        }}]
+    })";
+    return QJsonDocument::fromJson(json).toVariant().toMap();
+}
+}
+
+class RouteModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void setRoute_cumulativeDistances_matchQtPositioning();
+    void parseMapboxRoute_geometryAndAnnotations();
+    void updatePosition_projectsOntoRoute_remainingDistanceAndEta();
+    void updatePosition_farFromRoute_reportsOffRoute();
+    void updatePosition_segmentDurations_etaFollowsTraffic();
+    void nearestSegmentOnRoute_randomQueries_matchesLinearSearch();
+    void updatePosition_gpsJumpAhead_rejoinsRouteWithoutRecalculation();
+    void setCongestion_sameRoute_onlyColorsRewritten();
+    void updatePosition_parallelCarriageway_headingKeepsVehicleOnItsSide();
+    void updatePosition_noisyTrace_snappedWithHighConfidence();
+    void routeMatcher_history_boundedAndBacktracked();
+    void routeStrip_moveHead_rewritesOnlyPassedVertices();
+    void polylineSimplifier_levels_matchDouglasPeucker();
+    void benchmark_updatePosition3000Points();
+    void benchmark_nearestSegmentOnRoute5000Points();
+    void benchmark_javascriptEquivalent3000Points();
+    void benchmark_routeStripMoveHead3000Points();
+};
+
+void RouteModelTest::setRoute_cumulativeDistances_matchQtPositioning()
+{
+    // Objectif: garantir que les sommes préfixes donnent la même longueur que QGeoCoordinate::distanceTo.
+    // Pourquoi: la distance restante affichée n'est plus une somme de segments mais une soustraction
+    //           dans ce tableau ; une dérive s'accumulerait sur tout le trajet.
+    // Procédure détaillée:
+    //   1) Trajet de 3000 sommets espacés de 12 m.
+    //   2) Longueur totale et distance cumulée à mi-parcours comparées à la somme Qt (écart < 0,1 %).
+    //   3) Relecture d'un sommet projeté (précision < 1 mm).
+    const QList<QGeoCoordinate> points = synthetic(3000, 12.0);
+    RouteModel model;
+    RouteModel::RouteData data;
+    data.points = points;
+    model.setRoute(data);
+
+    double reference = 0.0;
+    double halfway = 0.0;
+    for (int i = 0; i + 1 < points.size(); ++i) {
+        reference += points.at(i).distanceTo(points.at(i + 1));
+        if (i + 1 == 1500) halfway = reference;
+    }
+    QCOMPARE(model.pointCount(), 3000);
+    QVERIFY(std::abs(model.totalDistance() - reference) < reference * 1e-3);
+    QVERIFY(std::abs(model.distanceAlong(1500, 0.0) - halfway) < halfway * 1e-3);
+    QVERIFY(model.point(1234).distanceTo(points.at(1234)) < 1e-3);
+    QCOMPARE(model.remainingDistance(), model.totalDistance());
+}
+
+void RouteModelTest::parseMapboxRoute_geometryAndAnnotations()
+{
+    // Objectif: vérifier le décodage d'une route Mapbox telle que map.qml la transmet.
+    // Pourquoi: l'ordre GeoJSON [lon, lat] et les formes de maxspeed ({speed, unit}, {unknown})
+    //           étaient interprétés en JavaScript ; une inversion décalerait tout le tracé.
+    // Procédure détaillée:
+    //   1) Extrait JSON converti en QVariantMap (comme un objet JavaScript passé à Q_INVOKABLE).
+    //   2) Contrôle des sommets, du trafic, des limitations (mph converti) et de la durée.
+    //   3) Une route sans géométrie est refusée et efface l'itinéraire.
+    RouteModel::RouteData data;
+    QVERIFY(RouteModel::parseMapboxRoute(mapboxRoute(), data));
+    QCOMPARE(data.points.size(), 4);
+    QCOMPARE(data.points.at(0).latitude(), 48.2715);
+    QCOMPARE(data.points.at(0).longitude(), 4.0645);
+    QCOMPARE(data.congestion.size(), 3);
+    QCOMPARE(data.congestion.at(1), RouteModel::Congestion::Heavy);
+    QCOMPARE(data.congestion.at(2), RouteModel::Congestion::Moderate);
+    QCOMPARE(data.speedLimitsKmh, (QList<int>{50, -1, 48}));
+    QCOMPARE(data.segmentDurationsSec, (QList<double>{7.5, 14.0, 8.5}));
+    QCOMPARE(data.durationSec, 30.0);
+
+    RouteModel model;
+    QSignalSpy routeSpy(&model, &RouteModel::routeChanged);
+    QVERIFY(model.loadMapboxRoute(mapboxRoute()));
+    QVERIFY(model.hasRoute());
+    QCOMPARE(model.speedLimit(), 50);
+    QCOMPARE(model.totalDuration(), 30.0);
+    QVERIFY(!model.loadMapboxRoute(QVariantMap()));
+    QVERIFY(!model.hasRoute());
+    QCOMPARE(routeSpy.count(), 2);
+}
+
+void RouteModelTest::updatePosition_projectsOntoRoute_remainingDistanceAndEta()
+{
+    // Objectif: vérifier la projection du véhicule sur le tracé et la distance/durée restantes.
+    // Pourquoi: l'ancienne somme JavaScript comptait la distance au début du segment courant, déjà
+    //           dépassé ; la distance restante part désormais du point projeté.
+    // Procédure détaillée:
+    //   1) Tracé rectiligne vers le nord (10 sommets espacés de 100 m), durée annoncée 90 s.
+    //   2) Véhicule à 350 m du départ, décalé de 8 m vers l'est.
+    //   3) Segment 3, écart 8 m, 550 m restants, 55 s restantes ; tracé dessiné depuis la position recalée.
+    //   4) Un fix en arrière ne fait pas reculer la progression.
+    RouteModel::RouteData data;
+    const QGeoCoordinate start(45.0, 5.0);
+    for (int i = 0; i < 10; ++i) data.points.append(start.atDistanceAndAzimuth(100.0 * i, 0.0));
+    data.durationSec = 90.0;
+    RouteModel model;
+    model.setRoute(data);
+    QVERIFY(std::abs(model.totalDistance() - 900.0) < 0.5);
+
+    QSignalSpy progressSpy(&model, &RouteModel::progressChanged);
+    const QGeoCoordinate car = start.atDistanceAndAzimuth(350.0, 0.0).atDistanceAndAzimuth(8.0, 90.0);
+    model.updatePosition(car.latitude(), car.longitude());
+    QCOMPARE(progressSpy.count(), 1);
+    QCOMPARE(model.segmentIndex(), 3);
+    QVERIFY(std::abs(model.distanceFromRoute() - 8.0) < 0.05);
+    QVERIFY(std::abs(model.remainingDistance() - 550.0) < 0.5);
+    QVERIFY(std::abs(model.remainingDuration() - 55.0) < 0.1);
+    QVERIFY(!model.isOffRoute());
+
+    const QGeoCoordinate onRoute = start.atDistanceAndAzimuth(350.0, 0.0);
+    QCOMPARE(model.pathStart(), 3);
+    QVERIFY(model.pathHead().distanceTo(onRoute) < 0.5);
+    QVERIFY(model.matchedPosition().distanceTo(onRoute) < 0.5);
+
+    const QGeoCoordinate behind = start.atDistanceAndAzimuth(150.0, 0.0);
+    model.updatePosition(behind.latitude(), behind.longitude());
+    QCOMPARE(model.segmentIndex(), 3);
+}
+
+void RouteModelTest::updatePosition_farFromRoute_reportsOffRoute()
+{
+    // Objectif: vérifier le seuil de sortie d'itinéraire (75 m, comme l'ancien checkIfOffRoute).
+    // Pourquoi: map.qml relance le calcul d'itinéraire sur cette seule propriété.
+    // Procédure détaillée:
+    //   1) Véhicule à 60 m du tracé : sur l'itinéraire.
+    //   2) Véhicule à 90 m : hors itinéraire.
+    RouteModel::RouteData data;
+    const QGeoCoordinate start(45.0, 5.0);
+    for (int i = 0; i < 5; ++i) data.points.append(start.atDistanceAndAzimuth(100.0 * i, 0.0));
+    RouteModel model;
+    model.setRoute(data);
+
+    const QGeoCoordinate near = start.atDistanceAndAzimuth(200.0, 0.0).atDistanceAndAzimuth(60.0, 270.0);
+    model.updatePosition(near.latitude(), near.longitude());
+    QVERIFY(!model.isOffRoute());
+
+    const QGeoCoordinate far = start.atDistanceAndAzimuth(200.0, 0.0).atDistanceAndAzimuth(90.0, 270.0);
+    model.updatePosition(far.latitude(), far.longitude());
+    QVERIFY(model.isOffRoute());
+}
+
+void RouteModelTest::updatePosition_segmentDurations_etaFollowsTraffic()
+{
+    // Objectif: vérifier que la durée restante suit les durées par segment de l'API (sommes préfixes).
+    // Pourquoi: l'extrapolation à vitesse moyenne ignorait un bouchon situé devant le véhicule ;
+    //           la durée restante doit aussi rester une soustraction, sans parcours du trajet.
+    // Procédure détaillée:
+    //   1) 4 segments de 100 m : 10 s, 60 s (bouchon), 10 s, durée absente pour le dernier.
+    //   2) Durée du segment non annoté : longueur / vitesse moyenne du trajet (400 m en 100 s).
+    //   3) Véhicule au quart du segment 1 : 45 s + 10 s + 25 s restantes.
+    //   4) Véhicule au milieu du segment 3 : 12,5 s restantes.
+    RouteModel::RouteData data;
+    const QGeoCoordinate start(45.0, 5.0);
+    for (int i = 0; i < 5; ++i) data.points.append(start.atDistanceAndAzimuth(100.0 * i, 0.0));
+    data.segmentDurationsSec = {10.0, 60.0, 10.0};
+    data.durationSec = 100.0;
+    RouteModel model;
+    model.setRoute(data);
+    QVERIFY(std::abs(model.totalDuration() - 105.0) < 0.01);
+
+    QGeoCoordinate car = start.atDistanceAndAzimuth(125.0, 0.0);
+    model.updatePosition(car.latitude(), car.longitude());
+    QCOMPARE(model.segmentIndex(), 1);
+    QVERIFY(std::abs(model.remainingDuration() - 80.0) < 0.05);
+
+    car = start.atDistanceAndAzimuth(350.0, 0.0);
+    model.updatePosition(car.latitude(), car.longitude());
+    QCOMPARE(model.segmentIndex(), 3);
+    QVERIFY(std::abs(model.remainingDuration() - 12.5) < 0.05);
+    QVERIFY(std::abs(model.remainingDistance() - 50.0) < 0.1);
+}
+
+void RouteModelTest::nearestSegmentOnRoute_randomQueries_matchesLinearSearch()
+{
+    // Objectif: garantir que la recherche par grille trouve exactement le segment le plus proche.
+    // Pourquoi: la borne d'arrêt par anneaux et le parcours des cellules traversées (segments de 2 km)
+    //           ne doivent rien manquer, sans quoi la progression sauterait sur un mauvais segment.
+    // Procédure détaillée:
+    //   1) Trajet sinueux de 5000 sommets (boucles, segments de 2 km tous les 100 sommets).
+    //   2) 2000 positions tirées jusqu'à ±500 m autour de sommets aléatoires.
+    //   3) Même distance que le parcours linéaire de tous les segments ; filtre firstSegment respecté.
+    //   4) Au-delà du rayon maximal, aucun segment n'est renvoyé.
+    RouteModel::RouteData data;
+    data.points = winding(5000, 7);
+    RouteModel model;
+    model.setRoute(data);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> vertex(0, 4999);
+    std::uniform_real_distribution<double> offset(-500.0, 500.0);
+    for (int q = 0; q < 2000; ++q) {
+        const QGeoCoordinate around = data.points.at(vertex(rng))
+                                          .atDistanceAndAzimuth(std::abs(offset(rng)), offset(rng) * 0.36);
+        const int first = q % 2 ? 0 : 2500;
+        const RouteModel::Projection grid = model.nearestSegmentOnRoute(around.latitude(), around.longitude(), first, 1e7);
+        const RouteModel::Projection linear = model.nearestSegment(around.latitude(), around.longitude(), first, 4999);
+        QVERIFY2(grid.segment >= first, qPrintable(QString::number(q)));
+        QVERIFY2(std::abs(grid.distanceM - linear.distanceM) < 1e-9, qPrintable(QString::number(q)));
+    }
+
+    const QGeoCoordinate far = data.points.at(0).atDistanceAndAzimuth(2000000.0, 180.0);
+    QCOMPARE(model.nearestSegmentOnRoute(far.latitude(), far.longitude()).segment, -1);
+}
+
+void RouteModelTest::updatePosition_gpsJumpAhead_rejoinsRouteWithoutRecalculation()
+{
+    // Objectif: vérifier qu'un véhicule retrouvé loin devant sur l'itinéraire n'est pas déclaré hors route.
+    // Pourquoi: la recherche limitée aux 30 segments suivants concluait à une sortie d'itinéraire
+    //           après un saut GPS (tunnel, démarrage à froid), d'où un appel Directions facturé inutile.
+    // Procédure détaillée:
+    //   1) Trajet de 3000 sommets de 12 m ; premier fix au départ.
+    //   2) Fix suivant au milieu du segment 1500, à 5 m du tracé.
+    //   3) Progression au segment 1500, distance restante cohérente, pas de sortie d'itinéraire.
+    RouteModel::RouteData data;
+    data.points = synthetic(3000, 12.0);
+    RouteModel model;
+    model.setRoute(data);
+    model.updatePosition(data.points.at(0).latitude(), data.points.at(0).longitude());
+    QCOMPARE(model.segmentIndex(), 0);
+
+    const QGeoCoordinate& a = data.points.at(1500);
+    const QGeoCoordinate car = a.atDistanceAndAzimuth(a.distanceTo(data.points.at(1501)) / 2, a.azimuthTo(data.points.at(1501)))
+                                .atDistanceAndAzimuth(5.0, a.azimuthTo(data.points.at(1501)) + 90.0);
+    model.updatePosition(car.latitude(), car.longitude());
+    QCOMPARE(model.segmentIndex(), 1500);
+    QVERIFY(std::abs(model.distanceFromRoute() - 5.0) < 0.1);
+    QVERIFY(!model.isOffRoute());
+    QVERIFY(std::abs(model.remainingDistance() - (model.totalDistance() - model.distanceAlong(1500, 0.5))) < 0.5);
+}
+
+void RouteModelTest::setCongestion_sameRoute_onlyColorsRewritten()
+{
+    // Objectif: vérifier l'actualisation du trafic sur l'itinéraire courant et la couleur des sommets.
+    // Pourquoi: le trafic n'est plus dessiné par des MapPolyline créées à la volée ; changer de niveau
+    //           doit seulement réécrire les couleurs de la bande, sans toucher tracé ni progression.
+    // Procédure détaillée:
+    //   1) Trafic initial : fluide, dense, très dense, modéré, fluide sur 5 segments.
+    //   2) Bande colorée : la paire sortante d'un point prend la couleur de son segment, la paire
+    //      entrante celle du segment précédent (changement net au point 1).
+    //   3) setCongestion() : congestionChanged émis, ni routeChanged ni progression modifiée.
+    RouteModel::RouteData data;
+    const QGeoCoordinate start(45.0, 5.0);
+    for (int i = 0; i < 6; ++i) data.points.append(start.atDistanceAndAzimuth(100.0 * i, 0.0));
+    data.congestion = {RouteModel::Congestion::Low, RouteModel::Congestion::Heavy, RouteModel::Congestion::Severe,
+                       RouteModel::Congestion::Moderate, RouteModel::Congestion::Low};
+    RouteModel model;
+    model.setRoute(data);
+    const QGeoCoordinate car = start.atDistanceAndAzimuth(250.0, 0.0);
+    model.updatePosition(car.latitude(), car.longitude());
+    QCOMPARE(model.segmentIndex(), 2);
+
+    const RouteStrip::Color blue{0x1d, 0xb7, 0xff, 255};
+    const RouteStrip::Color red{0xf4, 0x43, 0x36, 255};
+    std::vector<RouteStrip::Color> colors;
+    for (int i = 0; i + 1 < model.pointCount(); ++i) {
+        colors.push_back(model.congestion(i) == RouteModel::Congestion::Low ? blue : red);
+    }
+    RouteStrip strip;
+    strip.setPath({0, 0, 0, 10, 0, 20, 0, 30, 0, 40, 0, 50});
+    strip.setSegmentColors(colors);
+    std::vector<RouteStrip::Vertex> vertices(std::size_t(strip.vertexCount()));
+    strip.write(vertices.data());
+    QCOMPARE(vertices[4].b, quint8(0xff)); // point 1, paire entrante : segment 0, fluide
+    QCOMPARE(vertices[6].r, quint8(0xf4)); // point 1, paire sortante : segment 1, dense
+    QCOMPARE(vertices[4].x, vertices[6].x);
+
+    QSignalSpy routeSpy(&model, &RouteModel::routeChanged);
+    QSignalSpy congestionSpy(&model, &RouteModel::congestionChanged);
+    model.setCongestion({RouteModel::Congestion::Low, RouteModel::Congestion::Low, RouteModel::Congestion::Moderate});
+    QCOMPARE(congestionSpy.count(), 1);
+    QCOMPARE(routeSpy.count(), 0);
+    QCOMPARE(model.segmentIndex(), 2);
+    QCOMPARE(model.congestion(1), RouteModel::Congestion::Low);
+    QCOMPARE(model.congestion(2), RouteModel::Congestion::Moderate);
+    QCOMPARE(model.congestion(3), RouteModel::Congestion::Unknown);
+
+    const std::vector<RouteStrip::Vertex> before = vertices;
+    strip.setSegmentColors({blue});
+    strip.writeColors(vertices.data());
+    QCOMPARE(vertices[6].r, quint8(0x1d));
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        QCOMPARE(vertices[i].x, before[i].x);
+        QCOMPARE(vertices[i].y, before[i].y);
+    }
+}
+
+void RouteModelTest::updatePosition_parallelCarriageway_headingKeepsVehicleOnItsSide()
+{
+    // Objectif: vérifier que le cap et les positions précédentes départagent deux chaussées voisines.
+    // Pourquoi: un aller-retour sur une voie séparée (ou une bretelle) passe à quelques mètres du
+    //           véhicule ; le seul segment le plus proche le plaçait sur le retour, 1 km plus loin.
+    // Procédure détaillée:
+    //   1) Aller de 900 m vers le nord, puis retour vers le sud sur une chaussée décalée de 15 m.
+    //   2) Véhicule roulant vers le nord à 9 m à l'est de l'aller (donc à 6 m du retour).
+    //   3) Le segment le plus proche est sur le retour ; le recalage reste sur l'aller, avec
+    //      une confiance élevée et un signal positionMatched par fix.
+    RouteModel::RouteData data;
+    const QGeoCoordinate start(45.0, 5.0);
+    for (int i = 0; i < 10; ++i) data.points.append(start.atDistanceAndAzimuth(100.0 * i, 0.0));
+    const QGeoCoordinate turn = start.atDistanceAndAzimuth(900.0, 0.0).atDistanceAndAzimuth(15.0, 90.0);
+    for (int i = 0; i < 10; ++i) data.points.append(turn.atDistanceAndAzimuth(100.0 * i, 180.0));
+    RouteModel model;
+    model.setRoute(data);
+
+    const QGeoCoordinate first = start.atDistanceAndAzimuth(50.0, 0.0).atDistanceAndAzimuth(9.0, 90.0);
+    QVERIFY(model.nearestSegment(first.latitude(), first.longitude(), 0, model.pointCount() - 1).segment >= 10);
+
+    QSignalSpy matchedSpy(&model, &RouteModel::positionMatched);
+    for (int k = 0; k < 9; ++k) {
+        const QGeoCoordinate car = start.atDistanceAndAzimuth(50.0 + 100.0 * k, 0.0).atDistanceAndAzimuth(9.0, 90.0);
+        model.updatePosition(car.latitude(), car.longitude(), 0.0, 50.0);
+        QCOMPARE(model.segmentIndex(), k);
+        QVERIFY(std::abs(model.distanceFromRoute() - 9.0) < 0.05);
+        QVERIFY(model.matchConfidence() > 0.9);
+    }
+    QCOMPARE(matchedSpy.count(), 9);
+    QCOMPARE(matchedSpy.last().at(1).toInt(), 8);
+}
+
+void RouteModelTest::updatePosition_noisyTrace_snappedWithHighConfidence()
+{
+    // Objectif: vérifier le recalage d'une trace GPS bruitée (écart-type 5 m) sur un long trajet.
+    // Pourquoi: la flèche est affichée sur la position recalée dès que la confiance dépasse 0,5.
+    // Procédure détaillée:
+    //   1) Trajet de 400 sommets de 12 m ; un fix par segment, bruité, cap du segment, 50 km/h.
+    //   2) Segment retenu à ±1 du segment réel pour au moins 98 % des fix.
+    //   3) Confiance moyenne > 0,9 ; position recalée en moyenne à moins de 6 m de la position réelle.
+    RouteModel::RouteData data;
+    data.points = synthetic(400, 12.0);
+    RouteModel model;
+    model.setRoute(data);
+
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 5.0);
+    int onSegment = 0;
+    double confidence = 0.0;
+    double errorM = 0.0;
+    const int fixes = data.points.size() - 2;
+    for (int i = 0; i < fixes; ++i) {
+        const QGeoCoordinate& a = data.points.at(i);
+        const double azimuth = a.azimuthTo(data.points.at(i + 1));
+        const QGeoCoordinate truth = a.atDistanceAndAzimuth(6.0, azimuth);
+        const QGeoCoordinate fix = truth.atDistanceAndAzimuth(noise(rng), 90.0).atDistanceAndAzimuth(noise(rng), 0.0);
+        model.updatePosition(fix.latitude(), fix.longitude(), azimuth, 50.0);
+        if (std::abs(model.segmentIndex() - i) <= 1) ++onSegment;
+        confidence += model.matchConfidence();
+        errorM += model.matchedPosition().distanceTo(truth);
+    }
+    QVERIFY(onSegment >= fixes * 98 / 100);
+    QVERIFY(confidence / fixes > 0.9);
+    QVERIFY(errorM / fixes < 6.0);
+}
+
+void RouteModelTest::routeMatcher_history_boundedAndBacktracked()
+{
+    // Objectif: vérifier que l'historique du recalage reste borné et que le chemin retenu est cohérent.
+    // Pourquoi: le recalage tourne à chaque image ; son coût ne doit pas croître avec la durée du trajet.
+    // Procédure détaillée:
+    //   1) 25 étapes à deux candidats : l'un avance avec le véhicule, l'autre est 5 km plus loin, à contresens.
+    //   2) Historique limité à HistoryLength ; bestPath() suit le premier candidat sur les 10 dernières étapes.
+    //   3) Une position sans candidat vide l'historique.
+    RouteMatcher matcher;
+    RouteMatcher::Candidate candidates[2];
+    for (int k = 0; k < 25; ++k) {
+        candidates[0] = {k, 0.5, 3.0, 12.0 * k, 0.0};
+        candidates[1] = {k + 100, 0.5, 2.0, 5000.0 + 12.0 * k, 180.0};
+        const RouteMatcher::Match match = matcher.update(candidates, 2, 0.0, 12.0 * k, 0.0, 50.0);
+        QVERIFY(match.valid);
+        QCOMPARE(match.candidate.segment, k);
+    }
+    QCOMPARE(matcher.historySize(), RouteMatcher::HistoryLength);
+    const std::vector<RouteMatcher::Candidate> path = matcher.bestPath();
+    QCOMPARE(int(path.size()), RouteMatcher::HistoryLength);
+    for (int i = 0; i < int(path.size()); ++i) QCOMPARE(path[i].segment, 15 + i);
+
+    QVERIFY(!matcher.update(candidates, 0, 0.0, 0.0, 0.0, 0.0).valid);
+    QCOMPARE(matcher.historySize(), 0);
+}
+
+void RouteModelTest::routeStrip_moveHead_rewritesOnlyPassedVertices()
+{
+    // Objectif: vérifier la bande de triangles du tracé et sa mise à jour incrémentale.
+    // Pourquoi: le tracé n'est plus reconstruit à chaque fix ; seuls la tête (le véhicule) et les
+    //           points dépassés sont réécrits dans le tampon du graphe de scène.
+    // Procédure détaillée:
+    //   1) Polyligne en L (virage à 90° au point 2), demi-épaisseur 2 : onglet de longueur 2·√2.
+    //   2) Tête déplacée sur le même segment : 4 sommets réécrits (deux paires par point).
+    //   3) Tête avancée de deux points : 12 sommets réécrits, les points dépassés repliés sur la tête.
+    //   4) Aire totale de la bande = épaisseur × longueur restante (triangles repliés d'aire nulle).
+    RouteStrip strip;
+    strip.setPath({0, 0, 10, 0, 20, 0, 20, 10, 20, 20});
+    strip.setHalfWidth(2.0);
+    std::vector<RouteStrip::Vertex> vertices(std::size_t(strip.vertexCount()));
+    strip.write(vertices.data());
+    QCOMPARE(vertices[4].y, 2.0f);
+    QCOMPARE(vertices[5].y, -2.0f);
+    QCOMPARE(vertices[8].x, 18.0f);
+    QCOMPARE(vertices[8].y, 2.0f);
+    QCOMPARE(vertices[9].x, 22.0f);
+    QCOMPARE(vertices[9].y, -2.0f);
+
+    QCOMPARE(strip.moveHead(0, 5.0, 0.0, vertices.data()), 4);
+    QCOMPARE(vertices[0].x, 5.0f);
+    QCOMPARE(strip.moveHead(2, 20.0, 5.0, vertices.data()), 12);
+    for (int i = 0; i < 8; ++i) {
+        QCOMPARE(vertices[i].x, 20.0f);
+        QCOMPARE(vertices[i].y, 5.0f);
+    }
+    QCOMPARE(vertices[8].x, 18.0f);
+    QCOMPARE(vertices[9].x, 22.0f);
+
+    double area = 0.0;
+    for (std::size_t i = 0; i + 2 < vertices.size(); ++i) {
+        const RouteStrip::Vertex& a = vertices[i];
+        const RouteStrip::Vertex& b = vertices[i + 1];
+        const RouteStrip::Vertex& c = vertices[i + 2];
+        area += std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2.0;
+    }
+    QVERIFY(std::abs(area - 4.0 * 15.0) < 1e-3);
+
+    // Recul (progression réinitialisée) : tout le tampon est réécrit.
+    QCOMPARE(strip.moveHead(0, 0.0, 0.0, vertices.data()), strip.vertexCount());
+}
+
+void RouteModelTest::polylineSimplifier_levels_matchDouglasPeucker()
+{
+    // Objectif: vérifier la simplification multi-résolution du tracé dessiné.
+    // Pourquoi: l'importance est calculée une fois par itinéraire, puis chaque niveau de zoom n'est
+    //           qu'un filtre ; il doit donner exactement le Douglas-Peucker de sa tolérance.
+    // Procédure détaillée:
+    //   1) Trajet sinueux de 3000 sommets (repère plan, en mètres).
+    //   2) Pour plusieurs tolérances : sommets retenus identiques au Douglas-Peucker récursif.
+    //   3) Le nombre de sommets décroît avec la tolérance (dézoom).
+    //   4) Sommets imposés (changement de trafic) conservés même à tolérance infinie.
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> turn(-0.3, 0.3);
+    std::uniform_real_distribution<double> length(5.0, 35.0);
+    std::vector<double> xy;
+    double x = 0.0;
+    double y = 0.0;
+    double heading = 0.0;
+    const int count = 3000;
+    for (int i = 0; i < count; ++i) {
+        xy.push_back(x);
+        xy.push_back(y);
+        heading += turn(rng);
+        const double step = length(rng);
+        x += step * std::cos(heading);
+        y += step * std::sin(heading);
+    }
+
+    const std::vector<double> importance = PolylineSimplifier::importance(xy.data(), count);
+    int previousSize = count + 1;
+    for (double tolerance : {0.1, 0.5, 2.0, 5.0, 20.0, 100.0}) {
+        std::vector<int> expected{0};
+        douglasPeucker(xy, 0, count - 1, tolerance, expected);
+        expected.push_back(count - 1);
+        const std::vector<int> kept = PolylineSimplifier::select(importance, tolerance);
+        QCOMPARE(kept, expected);
+        QVERIFY(int(kept.size()) < previousSize);
+        previousSize = int(kept.size());
+    }
+    QVERIFY(previousSize < count / 20);
+
+    const std::vector<double> forced = PolylineSimplifier::importance(xy.data(), count, {77, 1234});
+    QCOMPARE(PolylineSimplifier::select(forced, std::numeric_limits<double>::max()), (std::vector<int>{0, 77, 1234, count - 1}));
+}
+
+void RouteModelTest::benchmark_updatePosition3000Points()
+{
+    // Objectif: mesurer le coût par fix sur un long trajet (3000 sommets), tracé restant compris.
+    // Pourquoi: référence à comparer avec benchmark_javascriptEquivalent3000Points.
+    RouteModel::RouteData data;
+    data.points = synthetic(3000, 12.0);
+    RouteModel model;
+    model.setRoute(data);
+    const QGeoCoordinate car = data.points.at(10).atDistanceAndAzimuth(6.0, data.points.at(10).azimuthTo(data.points.at(11)));
+
+    QBENCHMARK {
+        model.updatePosition(car.latitude(), car.longitude());
+    }
+    QCOMPARE(model.segmentIndex(), 10);
+}
+
+void RouteModelTest::benchmark_nearestSegmentOnRoute5000Points()
+{
+    // Objectif: mesurer la recherche du segment le plus proche sur tout un trajet (grille).
+    // Pourquoi: elle remplace la fenêtre de 30 segments après un saut GPS ; son coût doit rester
+    //           de l'ordre de celui de la fenêtre, pas proportionnel à la longueur du trajet.
+    RouteModel::RouteData data;
+    data.points = winding(5000, 7);
+    RouteModel model;
+    model.setRoute(data);
+    const QGeoCoordinate car = data.points.at(3210).atDistanceAndAzimuth(40.0, 45.0);
+    RouteModel::Projection projection;
+
+    QBENCHMARK {
+        projection = model.nearestSegmentOnRoute(car.latitude(), car.longitude());
+    }
+    QVERIFY(projection.segment >= 0);
+}
+
+void RouteModelTest::benchmark_javascriptEquivalent3000Points()
+{
+    // Objectif: mesurer, en C++, l'équivalent des calculs de l'ancienne version JavaScript par fix.
+    // Pourquoi: updateTripStats additionnait un distanceTo par segment restant et les recherches de
+    //           segment faisaient 3 distanceTo et 2 azimuthTo par segment ; en JavaScript, le coût réel
+    //           était encore supérieur (allocations des QGeoCoordinate).
+    const QList<QGeoCoordinate> points = synthetic(3000, 12.0);
+    const QGeoCoordinate car = points.at(10).atDistanceAndAzimuth(6.0, points.at(10).azimuthTo(points.at(11)));
+    double sink = 0.0;
+
+    QBENCHMARK {
+        // Recherche du segment le plus proche (distanceToSegment sur les 30 premiers segments).
+        double minD = 1e9;
+        for (int j = 0; j < 30; ++j) {
+            const QGeoCoordinate& a = points.at(j);
+            const QGeoCoordinate& b = points.at(j + 1);
+            const double dAB = a.distanceTo(b);
+            const double dAP = a.distanceTo(car);
+            const double angle = (a.azimuthTo(car) - a.azimuthTo(b)) * M_PI / 180.0;
+            const double along = dAP * std::cos(angle);
+            const double d = along < 0 ? dAP : (along > dAB ? car.distanceTo(b) : std::abs(dAP * std::sin(angle)));
+            minD = std::min(minD, d);
+        }
+        // updateTripStats : somme de tous les segments restants.
+        double remaining = car.distanceTo(points.at(0));
+        for (int i = 0; i + 1 < points.size(); ++i) remaining += points.at(i).distanceTo(points.at(i + 1));
+        sink += minD + remaining;
+    }
+    QVERIFY(sink > 0.0);
+}
+
+void RouteModelTest::benchmark_routeStripMoveHead3000Points()
+{
+    // Objectif: mesurer la mise à jour du tracé par fix (tête déplacée sur place), à comparer avec
+    //           une tessellation complète de 3000 points (ancienne réaffectation du chemin QML).
+    std::vector<double> xy;
+    for (int i = 0; i < 3000; ++i) {
+        xy.push_back(5.0 * i);
+        xy.push_back(50.0 * std::sin(i / 20.0));
+    }
+    RouteStrip strip;
+    strip.setPath(xy);
+    strip.setHalfWidth(4.0);
+    std::vector<RouteStrip::Vertex> vertices(std::size_t(strip.vertexCount()));
+    strip.write(vertices.data());
+
+    int start = 0;
+    QBENCHMARK {
+        strip.moveHead(start / 8, 5.0 * (start / 8) + 1.0, 0.0, vertices.data());
+        start = (start + 1) % (8 * 2999);
+    }
+}
+
+QTEST_GUILESS_MAIN(RouteModelTest)
+#include "tst_routemodel.moc"
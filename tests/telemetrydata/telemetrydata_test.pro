@@ -8,9 +8,30 @@ SOURCES += \
     tst_telemetrydata.cpp \
     ../../telemetrydata.cpp \
     ../../gpstelemetrysource.cpp \
-    ../../mpu9250source.cpp
+    ../../nmeaparser.cpp \
+    ../../mpu9250source.cpp \
+    ../../orientationengine.cpp \
+    ../../deadreckoning.cpp \
+    ../../ubxprotocol.cpp \
+    ../../gpsrecorder.cpp \
+    ../../gpsreplaysource.cpp \
+    ../../triplog.cpp \
+    ../../triplogwriter.cpp \
+    ../../gpsserialworker.cpp
 
 HEADERS += \
     ../../telemetrydata.h \
     ../../gpstelemetrysource.h \
-    ../../mpu9250source.h
+    ../../nmeaparser.h \
+    ../../mpu9250source.h \
+    ../../telemetryring.h \
+    ../../imusample.h \
+    ../../orientationengine.h \
+    ../../deadreckoning.h \
+    ../../gpsfix.h \
+    ../../ubxprotocol.h \
+    ../../gpsrecorder.h \
+    ../../gpsreplaysource.h \
+    ../../triplog.h \
+    ../../triplogwriter.h \
+    ../../gpsserialworker.h
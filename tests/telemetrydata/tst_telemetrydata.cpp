@@ -3,14 +3,26 @@
 #include <QDateTime>
 #include <QGeoCoordinate>
 #include <QGeoPositionInfo>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
 #include <limits>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #define private public
 #include "../../telemetrydata.h"
+#include "../../telemetryring.h"
 #include "../../gpstelemetrysource.h"
 #include "../../mpu9250source.h"
+#include "../../deadreckoning.h"
+#include "../../gpsrecorder.h"
+#include "../../gpsreplaysource.h"
 #undef private
+#define protected public
+#include "../../orientationengine.h"
+#undef protected
 
 class TelemetryAndSourcesTest : public QObject
 {
@@ -22,13 +34,35 @@ private slots:
     void telemetryData_setGpsOk_emitsOnlyWhenValueChanges();
     void telemetryData_setLatLonHeading_updateValuesAndSignals();
     void telemetryData_setters_withNanAndInf_storeAndNotify();
+    void telemetryData_applyUpdate_emitsSingleSnapshotWithDirtyFields();
+    void telemetryRing_producerThread_preservesOrderWithoutLoss();
+    void telemetryData_publishFromWorkerThread_drainsInOneTransaction();
+    void telemetryData_publishFromGuiThread_mergesPendingSamplesInOneTransaction();
 
     void gpsTelemetrySource_invalidPosition_setsGpsKo();
     void gpsTelemetrySource_validPosition_updatesTelemetry();
     void gpsTelemetrySource_validPosition_withoutGroundSpeed_keepsPreviousSpeed();
     void gpsTelemetrySource_validPosition_withDirection_doesNotChangeHeadingYet();
+    void gpsTelemetrySource_validPosition_emitsOneSnapshotPerFix();
+    void gpsTelemetrySource_positionPublishingDisabled_emitsFixAndOnlyGpsOk();
+    void gpsTelemetrySource_nativeIngest_publishesOneFixPerEpochWithSatellites();
+    void gpsTelemetrySource_rmcFirstEpochs_publishSatellitesOfSameEpoch();
+    void gpsTelemetrySource_ubxIngest_publishesNavPvtAndDropsNmea();
+    void gpsReplaySource_recordedLog_replaysThroughParsingPathDeterministically();
+    void gpsReplaySource_timedReplay_followsRecordedTimingAtRequestedSpeed();
+    void gpsReplaySource_timedReplayTwiceFaster_keepsDeadReckoningTracking();
+    void gpsReplaySource_timedReplayHalfSpeed_keepsDeadReckoningTracking();
 
     void mpu9250Source_startStopAndReadSensor_withoutHardware_doesNotCorruptTelemetry();
+    void mpu9250Source_threadMode_clampsRateAndStopsCleanlyWithoutHardware();
+    void mpu9250Source_fifoFrameDecode_matchesRegisterLayoutAndRejectsMagOverflow();
+    void madgwickEngine_batch_matchesScalarReference();
+    void orientationEngines_staticTiltedPose_convergeToReferenceHeading();
+    void mpu9250Source_fusionAlgorithm_switchesAtRuntimeWithPerInstanceSmoothing();
+    void mpu9250Source_motionSink_receivesRawHeadingAndTimestamp();
+
+    void deadReckoning_fixLoss_propagatesWithLearnedImuHeading();
+    void deadReckoning_fixReturn_blendsInsteadOfJumping();
 };
 
 void TelemetryAndSourcesTest::telemetryData_defaultValues_areInitialized()
@@ -155,6 +189,146 @@ void TelemetryAndSourcesTest::telemetryData_setters_withNanAndInf_storeAndNotify
     QCOMPARE(lonSpy.count(), 1);
 }
 
+void TelemetryAndSourcesTest::telemetryData_applyUpdate_emitsSingleSnapshotWithDirtyFields()
+{
+    // Objectif: vérifier la transaction groupée applyUpdate() et ses bits de modification.
+    // Pourquoi: un tick producteur ne doit déclencher qu'un seul rafraîchissement de la carte.
+    // Procédure détaillée:
+    //   1) Appliquer lat/lon/vitesse en une transaction, mais avec une vitesse inchangée (0).
+    //   2) Vérifier 1 seul snapshotChanged portant uniquement LatField|LonField.
+    //   3) Vérifier que les champs non cités (heading) sont ignorés même si la valeur diffère.
+    //   4) Réappliquer la même transaction: aucun signal.
+    TelemetryData data;
+    QSignalSpy snapshotSpy(&data, &TelemetryData::snapshotChanged);
+    QSignalSpy latSpy(&data, &TelemetryData::latChanged);
+    QSignalSpy speedSpy(&data, &TelemetryData::speedKmhChanged);
+
+    TelemetrySnapshot update;
+    update.lat = 44.8378;
+    update.lon = -0.5792;
+    update.speedKmh = 0.0;
+    update.heading = 123.0; // Non cité dans les champs: doit être ignoré
+
+    const TelemetryData::Fields fields = TelemetryData::PositionFields | TelemetryData::SpeedKmhField;
+    const TelemetryData::Fields dirty = data.applyUpdate(update, fields);
+
+    QCOMPARE(dirty, TelemetryData::Fields(TelemetryData::PositionFields));
+    QCOMPARE(snapshotSpy.count(), 1);
+    QCOMPARE(snapshotSpy.first().at(0).value<TelemetryData::Fields>(), dirty);
+    QCOMPARE(latSpy.count(), 1);
+    QCOMPARE(speedSpy.count(), 0);
+    QCOMPARE(data.snapshot().lat, 44.8378);
+    QCOMPARE(data.snapshot().lon, -0.5792);
+    QCOMPARE(data.heading(), 0.0);
+
+    QVERIFY(!data.applyUpdate(update, fields));
+    QCOMPARE(snapshotSpy.count(), 1);
+}
+
+void TelemetryAndSourcesTest::telemetryRing_producerThread_preservesOrderWithoutLoss()
+{
+    // Objectif: valider la file SPSC sans verrou entre deux threads réels.
+    // Pourquoi: c'est le seul canal entre threads capteurs et thread GUI.
+    // Procédure détaillée:
+    //   1) Un thread producteur pousse 100000 entiers croissants (réessaie si la file est pleine).
+    //   2) Le thread de test les retire et vérifie l'ordre strict, sans trou ni doublon.
+    //   3) Vérifier le refus d'un push sur une file pleine.
+    TelemetryRing<quint64, 64> ring;
+    const quint64 count = 100000;
+
+    std::thread producer([&ring, count]() {
+        for (quint64 i = 0; i < count;) {
+            if (ring.push(i)) ++i;
+            else std::this_thread::yield();
+        }
+    });
+
+    quint64 expected = 0;
+    quint64 value = 0;
+    bool ordered = true;
+    while (expected < count) {
+        if (ring.pop(value)) {
+            ordered = ordered && (value == expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    QVERIFY(ordered);
+    QVERIFY(ring.empty());
+
+    TelemetryRing<quint64, 4> small;
+    for (quint64 i = 0; i < 4; ++i) QVERIFY(small.push(i));
+    QVERIFY(!small.push(99));
+    QCOMPARE(small.droppedCount(), quint64(1));
+}
+
+void TelemetryAndSourcesTest::telemetryData_publishFromWorkerThread_drainsInOneTransaction()
+{
+    // Objectif: vérifier le chemin thread capteur -> file -> thread GUI de TelemetryData.
+    // Pourquoi: les capteurs publiant hors thread GUI ne doivent ni bloquer ni inonder l'interface.
+    // Procédure détaillée:
+    //   1) Publier 50 caps depuis un thread de travail.
+    //   2) Vérifier que rien n'est appliqué avant le passage de la boucle d'événements.
+    //   3) Vérifier un unique snapshotChanged, le dernier cap et le numéro de séquence 50.
+    TelemetryData data;
+    QSignalSpy snapshotSpy(&data, &TelemetryData::snapshotChanged);
+
+    std::thread worker([&data]() {
+        for (int i = 1; i <= 50; ++i) {
+            TelemetrySnapshot update;
+            update.heading = i;
+            data.publish(TelemetryData::ImuSource, update, TelemetryData::HeadingField);
+        }
+    });
+    worker.join();
+
+    QCOMPARE(data.heading(), 0.0);
+    QCOMPARE(snapshotSpy.count(), 0);
+
+    QTRY_COMPARE(snapshotSpy.count(), 1);
+    QCOMPARE(data.heading(), 50.0);
+    QCOMPARE(data.lastSample(TelemetryData::ImuSource).sequence, quint64(50));
+    QVERIFY(data.lastSample(TelemetryData::ImuSource).timestampNs > 0);
+    QCOMPARE(data.droppedSamples(TelemetryData::ImuSource), quint64(0));
+}
+
+void TelemetryAndSourcesTest::telemetryData_publishFromGuiThread_mergesPendingSamplesInOneTransaction()
+{
+    // Objectif: vérifier qu'une publication du thread GUI absorbe les échantillons encore en file.
+    // Pourquoi: contrat "un seul signal agrégé par tick producteur" ; vider la file puis appliquer la
+    //           mesure séparément émettrait deux snapshotChanged pour le même tick.
+    // Procédure détaillée:
+    //   1) Publier un cap depuis un thread de travail (laissé en file).
+    //   2) Publier la vitesse depuis le thread GUI avant tout passage de la boucle d'événements.
+    //   3) Vérifier un unique snapshotChanged portant cap et vitesse, et aucun signal au vidage planifié.
+    TelemetryData data;
+    QSignalSpy snapshotSpy(&data, &TelemetryData::snapshotChanged);
+
+    std::thread worker([&data]() {
+        TelemetrySnapshot update;
+        update.heading = 90.0;
+        data.publish(TelemetryData::ImuSource, update, TelemetryData::HeadingField);
+    });
+    worker.join();
+
+    TelemetrySnapshot gps;
+    gps.speedKmh = 42.0;
+    QVERIFY(data.publish(TelemetryData::GpsSource, gps, TelemetryData::SpeedKmhField));
+
+    QCOMPARE(snapshotSpy.count(), 1);
+    const TelemetryData::Fields dirty = snapshotSpy.at(0).at(0).value<TelemetryData::Fields>();
+    QCOMPARE(dirty, TelemetryData::Fields(TelemetryData::HeadingField | TelemetryData::SpeedKmhField));
+    QCOMPARE(data.heading(), 90.0);
+    QCOMPARE(data.speedKmh(), 42.0);
+    QCOMPARE(data.lastSample(TelemetryData::ImuSource).sequence, quint64(1));
+
+    QCoreApplication::processEvents();
+    QCOMPARE(snapshotSpy.count(), 1);
+}
+
 void TelemetryAndSourcesTest::gpsTelemetrySource_invalidPosition_setsGpsKo()
 {
     // Objectif: valider la réaction à une position GPS invalide.
@@ -240,6 +414,428 @@ void TelemetryAndSourcesTest::gpsTelemetrySource_validPosition_withDirection_doe
     QCOMPARE(data.heading(), 12.0);
 }
 
+void TelemetryAndSourcesTest::gpsTelemetrySource_validPosition_emitsOneSnapshotPerFix()
+{
+    // Objectif: garantir qu'un fix GPS complet ne produit qu'une notification agrégée.
+    // Pourquoi: la carte QML recalcule l'itinéraire à chaque notification de position.
+    // Procédure détaillée:
+    //   1) Envoyer une position valide avec vitesse.
+    //   2) Vérifier un seul snapshotChanged contenant position + vitesse.
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    QSignalSpy snapshotSpy(&data, &TelemetryData::snapshotChanged);
+
+    QGeoPositionInfo info(QGeoCoordinate(43.6047, 1.4442), QDateTime::currentDateTimeUtc());
+    info.setAttribute(QGeoPositionInfo::GroundSpeed, 20.0);
+
+    source.onPositionUpdated(info);
+
+    QCOMPARE(snapshotSpy.count(), 1);
+    const auto dirty = snapshotSpy.first().at(0).value<TelemetryData::Fields>();
+    QVERIFY(dirty.testFlag(TelemetryData::LatField));
+    QVERIFY(dirty.testFlag(TelemetryData::LonField));
+    QVERIFY(dirty.testFlag(TelemetryData::SpeedKmhField));
+}
+
+void TelemetryAndSourcesTest::gpsTelemetrySource_positionPublishingDisabled_emitsFixAndOnlyGpsOk()
+{
+    // Objectif: vérifier le mode "position publiée par la fusion" de la source GPS.
+    // Pourquoi: la carte ne doit recevoir qu'une seule source de position (DeadReckoning), sinon
+    //           les fix GPS à 1 Hz et l'estime à 30 Hz se disputeraient l'affichage.
+    // Procédure détaillée:
+    //   1) Désactiver la publication de position puis injecter un fix valide avec vitesse et route.
+    //   2) Vérifier que lat/lon/vitesse de TelemetryData n'ont pas bougé mais que gpsOk est publié.
+    //   3) Vérifier que fixReceived porte le fix complet, horodaté sur l'horloge monotone.
+    TelemetryData data;
+    data.setGpsOk(false);
+    GpsTelemetrySource source(&data);
+    source.setPublishPosition(false);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+
+    QGeoPositionInfo info(QGeoCoordinate(48.8584, 2.2945), QDateTime::currentDateTimeUtc());
+    info.setAttribute(QGeoPositionInfo::GroundSpeed, 10.0);
+    info.setAttribute(QGeoPositionInfo::Direction, 90.0);
+
+    const qint64 before = TelemetryData::monotonicNowNs();
+    source.onPositionUpdated(info);
+
+    QCOMPARE(data.gpsOk(), true);
+    QCOMPARE(data.lat(), 48.8566);
+    QCOMPARE(data.lon(), 2.3522);
+    QCOMPARE(data.speedKmh(), 0.0);
+
+    QCOMPARE(fixSpy.count(), 1);
+    const GpsFix fix = fixSpy.takeFirst().at(0).value<GpsFix>();
+    QVERIFY(fix.valid);
+    QCOMPARE(fix.lat, 48.8584);
+    QCOMPARE(fix.lon, 2.2945);
+    QVERIFY(fix.hasSpeed);
+    QCOMPARE(fix.speedMs, 10.0);
+    QVERIFY(fix.hasCourse);
+    QCOMPARE(fix.courseDeg, 90.0);
+    QVERIFY(fix.timestampNs >= before);
+}
+
+namespace {
+// Phrase NMEA complète à partir du corps entre '$' et '*' (somme de contrôle calculée).
+QByteArray nmeaSentence(const QByteArray& body)
+{
+    quint8 checksum = 0;
+    for (char c : body) checksum ^= quint8(c);
+    return "$" + body + "*" + QByteArray::number(checksum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+}
+
+void TelemetryAndSourcesTest::gpsTelemetrySource_nativeIngest_publishesOneFixPerEpochWithSatellites()
+{
+    // Objectif: valider le chemin série natif (octets bruts -> NmeaParser -> TelemetryData).
+    // Pourquoi: c'est le chemin par défaut sur la cible ; il doit publier un seul fix par époque
+    //           (et non un par phrase) et transmettre satellites et HDOP, ignorés par Qt Positioning.
+    // Procédure détaillée:
+    //   1) Injecter une époque GGA + GSA + RMC coupée au milieu d'une phrase : rien n'est publié avant
+    //      le silence qui la clôt (NmeaEpochGapMs).
+    //   2) Vérifier un seul fixReceived, une seule transaction télémétrie et les valeurs publiées.
+    //   3) Injecter une époque sans fix : gpsOk passe à false, le nombre de satellites est conservé.
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+    QSignalSpy snapshotSpy(&data, &TelemetryData::snapshotChanged);
+
+    const QByteArray epoch =
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+        "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61\r\n";
+    source.ingest(epoch.constData(), 40);
+    QCOMPARE(fixSpy.count(), 0);
+    source.ingest(epoch.constData() + 40, epoch.size() - 40);
+    QCOMPARE(fixSpy.count(), 0);
+
+    QVERIFY(fixSpy.wait(1000));
+    QCOMPARE(fixSpy.count(), 1);
+    QCOMPARE(snapshotSpy.count(), 1);
+    QCOMPARE(source.parserStats().sentences, quint64(3));
+    QCOMPARE(data.gpsOk(), true);
+    QVERIFY(std::abs(data.lat() - (48.0 + 7.038 / 60.0)) < 1e-9);
+    QVERIFY(std::abs(data.speedKmh() - 22.4 * 1.852) < 1e-9);
+    QCOMPARE(data.satellites(), 8);
+    QCOMPARE(data.hdop(), 1.3);
+
+    const GpsFix fix = fixSpy.takeFirst().at(0).value<GpsFix>();
+    QCOMPARE(fix.satellites, 8);
+    QVERIFY(fix.hasCourse);
+    QCOMPARE(fix.courseDeg, 84.4);
+
+    const QByteArray lost = "$GPRMC,081837,V,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*74\r\n";
+    source.ingest(lost.constData(), lost.size());
+    QVERIFY(fixSpy.wait(1000));
+    QCOMPARE(fixSpy.count(), 1);
+    QVERIFY(!fixSpy.takeFirst().at(0).value<GpsFix>().valid);
+    QCOMPARE(data.gpsOk(), false);
+    QCOMPARE(data.satellites(), 8);
+}
+
+void TelemetryAndSourcesTest::gpsTelemetrySource_rmcFirstEpochs_publishSatellitesOfSameEpoch()
+{
+    // Objectif: vérifier le découpage en époques d'un récepteur qui émet la RMC en tête (u-blox).
+    // Pourquoi: clore l'époque sur la RMC publiait satellites et HDOP de l'époque précédente, la GGA et
+    //           la GSA de l'époque courante n'arrivant qu'après.
+    // Procédure détaillée:
+    //   1) Époque 1 dans l'ordre RMC -> GGA -> GSA : rien n'est publié tant qu'elle peut se poursuivre.
+    //   2) La RMC de l'époque 2 (autre heure UTC) clôt l'époque 1 : satellites et HDOP de ses GGA/GSA,
+    //      horodatage de sa RMC.
+    //   3) GGA et GSA de l'époque 2 puis flushEpoch() : second fix avec leurs valeurs.
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+    auto feed = [&source](const QByteArray& body, qint64 timestampNs) {
+        const QByteArray sentence = nmeaSentence(body);
+        source.ingest(sentence.constData(), sentence.size(), timestampNs);
+    };
+
+    feed("GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W", 1000000000LL);
+    feed("GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", 1100000000LL);
+    feed("GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1", 1200000000LL);
+    QCOMPARE(fixSpy.count(), 0);
+
+    feed("GPRMC,123520.00,A,4807.040,N,01131.010,E,022.4,084.4,230324,003.1,W", 2000000000LL);
+    QCOMPARE(fixSpy.count(), 1);
+    GpsFix fix = fixSpy.takeFirst().at(0).value<GpsFix>();
+    QVERIFY(fix.valid);
+    QCOMPARE(fix.satellites, 8);
+    QCOMPARE(fix.hdop, 1.3);
+    QCOMPARE(fix.timestampNs, 1000000000LL);
+    QVERIFY(std::abs(fix.lat - (48.0 + 7.038 / 60.0)) < 1e-9);
+
+    feed("GPGGA,123520.00,4807.040,N,01131.010,E,1,05,2.0,545.4,M,46.9,M,,", 2100000000LL);
+    feed("GPGSA,A,3,04,05,09,12,24,,,,,,,,3.1,2.4,1.9", 2200000000LL);
+    QCOMPARE(fixSpy.count(), 0);
+    source.flushEpoch();
+    QCOMPARE(fixSpy.count(), 1);
+    fix = fixSpy.takeFirst().at(0).value<GpsFix>();
+    QCOMPARE(fix.satellites, 5);
+    QCOMPARE(fix.hdop, 2.4);
+    QCOMPARE(fix.timestampNs, 2000000000LL);
+    QVERIFY(std::abs(fix.lat - (48.0 + 7.040 / 60.0)) < 1e-9);
+    QCOMPARE(data.satellites(), 5);
+}
+
+void TelemetryAndSourcesTest::gpsTelemetrySource_ubxIngest_publishesNavPvtAndDropsNmea()
+{
+    // Objectif: valider le chemin UBX (octets bruts -> UbxParser -> NAV-PVT -> TelemetryData).
+    // Pourquoi: pendant la reconfiguration le récepteur émet encore du NMEA ; ensuite, seule la trame
+    //           binaire doit faire foi (sinon chaque époque serait publiée deux fois).
+    // Procédure détaillée:
+    //   1) Mode Ubx : une époque NMEA reçue avant toute trame binaire est encore publiée.
+    //   2) NAV-DOP puis NAV-PVT coupée en deux lectures : un fix avec satellites, HDOP et précision.
+    //   3) Une RMC reçue ensuite est ignorée ; la cadence demandée est bornée à [5, 10] Hz.
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    source.setProtocol(GpsTelemetrySource::Protocol::Ubx);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+
+    const QByteArray rmc = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61\r\n";
+    source.ingest(rmc.constData(), rmc.size());
+    QVERIFY(fixSpy.wait(1000));
+    QCOMPARE(fixSpy.count(), 1);
+    fixSpy.clear();
+
+    auto putI4 = [](QByteArray& payload, int offset, qint32 value) {
+        for (int i = 0; i < 4; ++i) payload[offset + i] = char((quint32(value) >> (8 * i)) & 0xFF);
+    };
+    QByteArray dop(18, '\0');
+    dop[12] = char(87); // hDOP 0.87
+    QByteArray pvt(92, '\0');
+    pvt[20] = 3;        // fix 3D
+    pvt[21] = 0x01;     // gnssFixOK
+    pvt[23] = 14;       // numSV
+    putI4(pvt, 24, 115166667);
+    putI4(pvt, 28, 481173000);
+    putI4(pvt, 40, 1800);
+    putI4(pvt, 60, 15000);
+    putI4(pvt, 64, 8440000);
+    const QByteArray stream = UbxProtocol::frame(UbxProtocol::ClassNav, UbxProtocol::IdNavDop, dop)
+                            + UbxProtocol::frame(UbxProtocol::ClassNav, UbxProtocol::IdNavPvt, pvt);
+    source.ingest(stream.constData(), 50);
+    QCOMPARE(fixSpy.count(), 0);
+    source.ingest(stream.constData() + 50, stream.size() - 50);
+
+    QCOMPARE(fixSpy.count(), 1);
+    QCOMPARE(source.ubxStats().frames, quint64(2));
+    const GpsFix fix = fixSpy.takeFirst().at(0).value<GpsFix>();
+    QVERIFY(fix.valid);
+    QCOMPARE(fix.satellites, 14);
+    QCOMPARE(fix.hdop, 0.87);
+    QVERIFY(std::abs(fix.horizontalAccuracyM - 1.8) < 1e-9);
+    QVERIFY(std::abs(fix.courseDeg - 84.4) < 1e-9);
+    QVERIFY(std::abs(data.lat() - 48.1173) < 1e-9);
+    QVERIFY(std::abs(data.speedKmh() - 54.0) < 1e-9);
+    QCOMPARE(data.satellites(), 14);
+
+    source.ingest(rmc.constData(), rmc.size());
+    QCOMPARE(fixSpy.count(), 0);
+
+    source.setUbxRateHz(25);
+    QCOMPARE(source.ubxRateHz(), 10);
+    source.setUbxRateHz(1);
+    QCOMPARE(source.ubxRateHz(), 5);
+}
+
+void TelemetryAndSourcesTest::gpsReplaySource_recordedLog_replaysThroughParsingPathDeterministically()
+{
+    // Objectif: valider la boucle enregistrement -> rejeu sans port série.
+    // Pourquoi: un bug terrain n'est reproductible que si le même flux d'octets, découpé de la même
+    //           façon, repasse par le même décodeur et produit exactement les mêmes fix.
+    // Procédure détaillée:
+    //   1) Enregistrer trois époques RMC coupées en deux blocs, puis les rejouer (replayAll) : trois fix.
+    //   2) Rembobiner et rejouer : séquence de positions et de vitesses identique, fix espacés des
+    //      instants de réception enregistrés (1 s) bien que replayAll() n'attende pas.
+    //   3) Fichier tronqué au milieu du dernier bloc : rejeu jusqu'au dernier bloc complet.
+    //   4) Journal brut sans horodatage : découpé et cadencé au débit série (9600 bauds, 8N1).
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString recordPath = dir.filePath("drive.igpsrec");
+
+    const QByteArray epochs[] = {
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61\r\n",
+        "$GPRMC,081837,V,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*74\r\n",
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61\r\n"
+    };
+    GpsRecorder recorder;
+    QVERIFY(recorder.open(recordPath));
+    for (int i = 0; i < 3; ++i) {
+        const qint64 t = 1000000000LL * (i + 1);
+        recorder.record(epochs[i].constData(), 30, t);
+        recorder.record(epochs[i].constData() + 30, epochs[i].size() - 30, t + 15000000);
+    }
+    recorder.close();
+    QCOMPARE(recorder.chunksRecorded(), quint64(6));
+
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+    GpsReplaySource replay(&source);
+    QVERIFY(replay.open(recordPath));
+    QVERIFY(replay.isTimestamped());
+    QCOMPARE(replay.chunkCount(), 6);
+    QCOMPARE(replay.durationNs(), 2015000000LL);
+
+    auto run = [&]() {
+        fixSpy.clear();
+        replay.rewind();
+        replay.replayAll();
+        QList<QPair<bool, double>> fixes;
+        for (const QList<QVariant>& args : fixSpy) {
+            const GpsFix fix = args.at(0).value<GpsFix>();
+            fixes.append({fix.valid, fix.lat + fix.speedMs});
+        }
+        return fixes;
+    };
+    const QList<QPair<bool, double>> first = run();
+    QCOMPARE(first.size(), 3);
+    for (int i = 1; i < 3; ++i) {
+        QCOMPARE(fixSpy.at(i).at(0).value<GpsFix>().timestampNs - fixSpy.at(i - 1).at(0).value<GpsFix>().timestampNs,
+                 1000000000LL);
+    }
+    QVERIFY(first.at(0).first && !first.at(1).first && first.at(2).first);
+    QVERIFY(run() == first);
+    QCOMPARE(data.gpsOk(), true);
+
+    QFile file(recordPath);
+    QVERIFY(file.resize(file.size() - 10));
+    QVERIFY(replay.open(recordPath));
+    QCOMPARE(replay.chunkCount(), 5);
+
+    const QString rawPath = dir.filePath("drive.nmea");
+    QFile raw(rawPath);
+    QVERIFY(raw.open(QIODevice::WriteOnly));
+    for (const QByteArray& epoch : epochs) raw.write(epoch);
+    raw.close();
+    QVERIFY(replay.open(rawPath));
+    QVERIFY(!replay.isTimestamped());
+    const int rawBytes = epochs[0].size() + epochs[1].size() + epochs[2].size();
+    QCOMPARE(replay.chunkCount(), (rawBytes + 63) / 64);
+    QVERIFY(std::abs(replay.durationNs() - qint64(rawBytes) * 10 * 1000000000LL / 9600) <= 1);
+    fixSpy.clear();
+    replay.replayAll();
+    QCOMPARE(fixSpy.count(), 3);
+}
+
+void TelemetryAndSourcesTest::gpsReplaySource_timedReplay_followsRecordedTimingAtRequestedSpeed()
+{
+    // Objectif: vérifier le rejeu asynchrone cadencé (accéléré et sans attente).
+    // Pourquoi: le banc de performance desktop doit reproduire le rythme réel (ou un multiple connu)
+    //           pour que les mesures de la chaîne télémétrie -> carte soient représentatives.
+    // Procédure détaillée:
+    //   1) Journal de trois époques espacées de 1 s, rejoué à 10x : finished() n'arrive pas avant
+    //      ≈ 200 ms (borne inférieure déterministe) et tous les fix sont publiés.
+    //   2) Même journal en AsFastAsPossible : terminé via la boucle d'événements, sans attente.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("timed.igpsrec");
+    GpsRecorder recorder;
+    QVERIFY(recorder.open(path));
+    for (int i = 0; i < 3; ++i) {
+        const QByteArray rmc = nmeaSentence("GPRMC,12351" + QByteArray::number(7 + i)
+                                            + ",A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W");
+        recorder.record(rmc.constData(), rmc.size(), 5000000000LL + i * 1000000000LL);
+    }
+    recorder.close();
+
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    QSignalSpy fixSpy(&source, &GpsTelemetrySource::fixReceived);
+    GpsReplaySource replay(&source);
+    QVERIFY(replay.open(path));
+    QSignalSpy finishedSpy(&replay, &GpsReplaySource::finished);
+
+    replay.setSpeed(10.0);
+    QElapsedTimer clock;
+    clock.start();
+    replay.start();
+    QVERIFY(replay.isRunning());
+    QVERIFY(finishedSpy.wait(5000));
+    QVERIFY(clock.elapsed() >= 190);
+    QCOMPARE(fixSpy.count(), 3);
+    QCOMPARE(replay.position(), 3);
+
+    replay.rewind();
+    replay.setSpeed(GpsReplaySource::AsFastAsPossible);
+    replay.start();
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(fixSpy.count(), 6);
+}
+
+namespace {
+// Rejoue à @p speed cinq fix enregistrés à 400 ms d'intervalle vers un DeadReckoning publié en continu
+// (délai de fix 1 s) : les fix sont horodatés au rythme réel et l'estimateur reste en Tracking.
+void replayIntoDeadReckoning(double speed)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("dr.igpsrec");
+    const int fixCount = 5;
+    const qint64 spacingNs = 400000000;
+    GpsRecorder recorder;
+    QVERIFY(recorder.open(path));
+    for (int i = 0; i < fixCount; ++i) {
+        const QByteArray utc = QByteArray::number(123519.0 + i * 0.4, 'f', 2);
+        const QByteArray rmc = nmeaSentence("GPRMC," + utc + ",A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W");
+        recorder.record(rmc.constData(), rmc.size(), 5000000000LL + i * spacingNs);
+    }
+    recorder.close();
+
+    TelemetryData data;
+    GpsTelemetrySource source(&data);
+    DeadReckoning dr(nullptr);
+    dr.setFixTimeoutMs(1000);
+    QSignalSpy modeSpy(&dr, &DeadReckoning::modeChanged);
+    QList<qint64> stamps;
+    bool stampedAhead = false;
+    QObject::connect(&source, &GpsTelemetrySource::fixReceived, &dr, [&](const GpsFix& fix) {
+        stampedAhead = stampedAhead || fix.timestampNs > TelemetryData::monotonicNowNs() + 1000000;
+        stamps.append(fix.timestampNs);
+        dr.onGpsFix(fix);
+    });
+    dr.start();
+
+    GpsReplaySource replay(&source);
+    QVERIFY(replay.open(path));
+    QSignalSpy finishedSpy(&replay, &GpsReplaySource::finished);
+    replay.setSpeed(speed);
+    replay.start();
+    QVERIFY(finishedSpy.wait(10000));
+    dr.propagateTo(TelemetryData::monotonicNowNs());
+
+    QCOMPARE(stamps.size(), fixCount);
+    QVERIFY(!stampedAhead);
+    for (int i = 1; i < stamps.size(); ++i) QCOMPARE(stamps.at(i) - stamps.at(i - 1), qint64(spacingNs / speed));
+    QCOMPARE(dr.mode(), DeadReckoning::Mode::Tracking);
+    QCOMPARE(modeSpy.count(), 1);
+}
+}
+
+void TelemetryAndSourcesTest::gpsReplaySource_timedReplayTwiceFaster_keepsDeadReckoningTracking()
+{
+    // Objectif: vérifier qu'un rejeu accéléré horodate les fix à leur instant d'injection.
+    // Pourquoi: horodatés aux instants enregistrés, les fix arrivaient « du futur » pour DeadReckoning,
+    //           qui propageait sa position en avance sur le temps réel.
+    // Procédure détaillée:
+    //   1) Journal de cinq fix espacés de 400 ms, rejoué à 2x.
+    //   2) Fix espacés de 200 ms, aucun postérieur à sa réception ; DeadReckoning reste en Tracking.
+    replayIntoDeadReckoning(2.0);
+}
+
+void TelemetryAndSourcesTest::gpsReplaySource_timedReplayHalfSpeed_keepsDeadReckoningTracking()
+{
+    // Objectif: vérifier qu'un rejeu ralenti horodate les fix à leur instant d'injection.
+    // Pourquoi: horodatés aux instants enregistrés, les fix vieillissaient de 400 ms à chaque époque et
+    //           DeadReckoning passait en navigation à l'estime alors que les fix arrivaient.
+    // Procédure détaillée:
+    //   1) Même journal rejoué à 0,5x.
+    //   2) Fix espacés de 800 ms ; DeadReckoning (délai 1 s) reste en Tracking jusqu'au dernier.
+    replayIntoDeadReckoning(0.5);
+}
+
 void TelemetryAndSourcesTest::mpu9250Source_startStopAndReadSensor_withoutHardware_doesNotCorruptTelemetry()
 {
     // Objectif: vérifier la robustesse du capteur inertiel en environnement sans matériel réel.
@@ -257,5 +853,391 @@ void TelemetryAndSourcesTest::mpu9250Source_startStopAndReadSensor_withoutHardwa
     QVERIFY(data.heading() >= 0.0 && data.heading() < 360.0);
 }
 
-QTEST_APPLESS_MAIN(TelemetryAndSourcesTest)
+void TelemetryAndSourcesTest::mpu9250Source_threadMode_clampsRateAndStopsCleanlyWithoutHardware()
+{
+    // Objectif: vérifier le mode d'acquisition threadé sans centrale inertielle branchée.
+    // Pourquoi: start()/stop() doivent rester sûrs (thread rejoint, bus refermé) même sans I2C.
+    // Procédure détaillée:
+    //   1) Demander 500 Hz et 1 Hz: les bornes 200 Hz et 50 Hz doivent s'appliquer.
+    //   2) Démarrer puis arrêter en mode Thread, deux fois (redémarrage idempotent).
+    //   3) Vérifier l'absence de thread résiduel et des statistiques cohérentes.
+    TelemetryData data;
+    Mpu9250Source source(&data);
+
+    source.setSampleRateHz(500);
+    QCOMPARE(source.sampleRateHz(), Mpu9250Source::MaxSampleRateHz);
+    source.setSampleRateHz(1);
+    QCOMPARE(source.sampleRateHz(), Mpu9250Source::MinSampleRateHz);
+
+    source.setAcquisitionMode(Mpu9250Source::AcquisitionMode::Thread);
+    source.start();
+    source.start();
+    source.stop();
+
+    QVERIFY(!source.m_thread.joinable());
+    QCOMPARE(source.m_fileDescriptor, -1);
+
+    const Mpu9250Source::TimingStats stats = source.timingStats();
+    QVERIFY(stats.missedDeadlines <= stats.samples);
+    QVERIFY(stats.wakeups <= stats.samples);
+    QVERIFY(stats.maxJitterUs >= 0.0);
+    QVERIFY(stats.meanJitterUs <= stats.maxJitterUs);
+    QVERIFY(std::isfinite(data.heading()));
+}
+
+void TelemetryAndSourcesTest::mpu9250Source_fifoFrameDecode_matchesRegisterLayoutAndRejectsMagOverflow()
+{
+    // Objectif: vérifier le décodage d'une trame FIFO de 20 octets (accel, gyro, AK8963 ST1..ST2).
+    // Pourquoi: la FIFO mélange des mots big-endian (MPU) et little-endian (AK8963) ;
+    //           une erreur d'ordre d'octets ou d'axe NED fausserait silencieusement le cap.
+    // Procédure détaillée:
+    //   1) Construire une trame: ax = +1 g, gz = +250 dps, ST1 DRDY, mag X = 1000, Y = -500 (ST2 sain).
+    //   2) Vérifier les valeurs physiques et le réalignement NED (ax et gz inversés, mx/my croisés).
+    //   3) Sans DRDY (mesure déjà recopiée), puis avec le bit HOFL de ST2 : la mesure magnétique doit
+    //      être ignorée, l'accéléromètre et le gyroscope restent décodés.
+    //   4) Sans matériel, le mode FifoBurst doit démarrer/s'arrêter sans activer la FIFO.
+    TelemetryData data;
+    Mpu9250Source source(&data);
+    source.m_magBias[0] = source.m_magBias[1] = source.m_magBias[2] = 0.0f;
+    source.m_magScale[0] = source.m_magScale[1] = source.m_magScale[2] = 1.0f;
+
+    unsigned char frame[Mpu9250Source::FifoFrameSize] = {};
+    frame[0] = 0x40; frame[1] = 0x00;   // ACCEL_X = 16384 -> 1 g
+    frame[10] = 0x7F; frame[11] = 0xFF; // GYRO_Z = 32767 -> ~250 dps
+    frame[12] = 0x01;                   // ST1 : DRDY, mesure nouvelle
+    frame[13] = 0xE8; frame[14] = 0x03; // HX = 1000 (little-endian)
+    frame[15] = 0x0C; frame[16] = 0xFE; // HY = -500
+    frame[19] = 0x10;                   // ST2 : sortie 16 bits, pas de débordement
+
+    ImuSample sample;
+    source.decodeFifoFrame(frame, sample);
+
+    QVERIFY(qFuzzyCompare(sample.ax, -1.0f));
+    QVERIFY(qAbs(sample.gz + 250.0f * float(M_PI) / 180.0f) < 1e-3f);
+    QVERIFY(sample.magValid);
+    QVERIFY(qFuzzyCompare(sample.mx, -500.0f));
+    QVERIFY(qFuzzyCompare(sample.my, -1000.0f));
+
+    ImuSample stale;
+    frame[12] = 0x00; // DRDY absent : mesure déjà recopiée dans la trame précédente
+    source.decodeFifoFrame(frame, stale);
+    QVERIFY(!stale.magValid);
+    QVERIFY(qFuzzyCompare(stale.ax, -1.0f));
+
+    ImuSample overflowed;
+    frame[12] = 0x01;
+    frame[19] |= 0x08; // HOFL
+    source.decodeFifoFrame(frame, overflowed);
+    QVERIFY(!overflowed.magValid);
+
+    source.setReadMode(Mpu9250Source::ReadMode::FifoBurst);
+    source.setAcquisitionMode(Mpu9250Source::AcquisitionMode::Thread);
+    source.start();
+    source.stop();
+    QVERIFY(!source.m_fifoActive);
+    QCOMPARE(source.timingStats().fifoOverflows, quint64(0));
+}
+
+namespace {
+// Pose immobile inclinée (roulis 10°, tangage 5°, lacet ≈ 57°) : mesures idéales et quaternion de vérité.
+ImuSample tiltedStaticSample(float q[4])
+{
+    const float roll = 0.17f, pitch = 0.09f, yaw = 1.0f;
+    const float cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+    const float cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+    const float cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+    q[0] = cr * cp * cy + sr * sp * sy;
+    q[1] = sr * cp * cy - cr * sp * sy;
+    q[2] = cr * sp * cy + sr * cp * sy;
+    q[3] = cr * cp * sy - sr * sp * cy;
+
+    const float w = q[0], x = q[1], y = q[2], z = q[3];
+    const float R[3][3] = {{1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y)},
+                           {2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x)},
+                           {2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)}};
+    const float field[3] = {200.0f, 0.0f, -350.0f};
+
+    ImuSample sample;
+    sample.ax = R[2][0]; sample.ay = R[2][1]; sample.az = R[2][2];
+    sample.mx = R[0][0] * field[0] + R[2][0] * field[2];
+    sample.my = R[0][1] * field[0] + R[2][1] * field[2];
+    sample.mz = R[0][2] * field[0] + R[2][2] * field[2];
+    sample.magValid = true;
+    sample.dt = 0.01f;
+    return sample;
+}
+}
+
+void TelemetryAndSourcesTest::madgwickEngine_batch_matchesScalarReference()
+{
+    // Objectif: garantir que le noyau par lot reproduit le filtre scalaire de référence.
+    // Pourquoi: le lot utilise une racine carrée inverse rapide et un maintien de la mesure
+    //           magnétique interne ; il ne doit pas dériver sur un long rejeu.
+    // Procédure détaillée:
+    //   1) Générer 20 000 échantillons (200 s à 100 Hz) avec rotation lente et magnétomètre à 50 Hz.
+    //   2) Les fusionner un par un (update) sur un filtre, en un seul lot (updateBatch) sur un autre.
+    //   3) Comparer les quaternions finaux composante par composante (tolérance 1e-4).
+    //   4) resetStats() depuis un autre thread : statistiques vides, puis recomptées par le filtre.
+    MadgwickEngine scalar;
+    MadgwickEngine batched;
+
+    std::vector<ImuSample> samples(20000);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const float t = i * 0.01f;
+        ImuSample& sample = samples[i];
+        sample.ax = 0.05f * std::sin(t);
+        sample.ay = 0.03f * std::cos(0.7f * t);
+        sample.az = 1.0f;
+        sample.gx = 0.02f * std::sin(1.3f * t);
+        sample.gy = 0.01f;
+        sample.gz = 0.3f * std::sin(0.2f * t);
+        sample.magValid = (i % 2) == 0;
+        sample.mx = 200.0f * std::cos(0.05f * t);
+        sample.my = 200.0f * std::sin(0.05f * t);
+        sample.mz = -300.0f;
+        sample.dt = 0.01f;
+    }
+
+    for (const ImuSample& sample : samples) scalar.update(sample);
+    QVERIFY(batched.updateBatch(samples.data(), samples.size()));
+
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY2(std::abs(scalar.quaternion()[i] - batched.quaternion()[i]) < 1e-4f, qPrintable(QString("q[%1]").arg(i)));
+    }
+    QCOMPARE(batched.stats().updates, quint64(samples.size()));
+
+    std::thread([&batched]() { batched.resetStats(); }).join();
+    QCOMPARE(batched.stats().updates, quint64(0));
+    batched.update(samples.front());
+    QCOMPARE(batched.stats().updates, quint64(1));
+}
+
+void TelemetryAndSourcesTest::orientationEngines_staticTiltedPose_convergeToReferenceHeading()
+{
+    // Objectif: vérifier que les trois filtres convergent vers le même cap sur une pose inclinée.
+    // Pourquoi: le choix du filtre ne doit changer que le coût et la dynamique, pas le cap final.
+    // Procédure détaillée:
+    //   1) Calculer le cap de référence avec le quaternion de vérité.
+    //   2) Faire converger chaque filtre depuis l'orientation neutre (30 s, biais gyro de 0.002 rad/s).
+    //   3) Vérifier l'écart de cap (< 2°) et la cohérence des statistiques (mises à jour, coût, variance).
+    float truth[4];
+    ImuSample sample = tiltedStaticSample(truth);
+
+    MadgwickEngine reference;
+    reference.reset(truth);
+    reference.holdMag(sample);
+    const float expected = reference.computeHeading();
+
+    sample.gx = 0.002f;
+    const std::vector<ImuSample> samples(3000, sample);
+
+    for (int a = 0; a < static_cast<int>(FusionAlgorithm::Count); ++a) {
+        std::unique_ptr<OrientationEngine> engine = createOrientationEngine(static_cast<FusionAlgorithm>(a));
+        QVERIFY(engine->updateBatch(samples.data(), samples.size()));
+
+        const float heading = engine->computeHeading();
+        float error = std::abs(heading - expected);
+        if (error > 180.0f) error = 360.0f - error;
+        QVERIFY2(error < 2.0f, engine->name());
+
+        const OrientationEngine::Stats stats = engine->stats();
+        QCOMPARE(stats.updates, quint64(samples.size()));
+        QVERIFY(stats.meanCpuNs > 0.0);
+        QVERIFY(std::isfinite(stats.headingVarianceDeg2) && stats.headingVarianceDeg2 >= 0.0);
+    }
+}
+
+void TelemetryAndSourcesTest::mpu9250Source_fusionAlgorithm_switchesAtRuntimeWithPerInstanceSmoothing()
+{
+    // Objectif: vérifier la sélection du filtre à chaud et l'indépendance du lissage entre instances.
+    // Pourquoi: l'ancien lissage reposait sur une variable locale statique partagée par toutes les sources.
+    // Procédure détaillée:
+    //   1) Basculer une source sur Mahony : seules les statistiques Mahony doivent progresser.
+    //   2) Alimenter une seconde source (Madgwick) avec un champ magnétique tourné de 90°.
+    //   3) Vérifier que les deux caps lissés restent distincts (pas d'état partagé).
+    TelemetryData data;
+    Mpu9250Source first(&data);
+    Mpu9250Source second(&data);
+
+    float truth[4];
+    const ImuSample sample = tiltedStaticSample(truth);
+    ImuSample rotated = sample;
+    rotated.mx = sample.my;
+    rotated.my = -sample.mx;
+
+    first.setFusionAlgorithm(FusionAlgorithm::Mahony);
+    QCOMPARE(first.fusionAlgorithm(), FusionAlgorithm::Mahony);
+    for (int i = 0; i < 500; ++i) {
+        QVERIFY(first.fuseSample(sample));
+        QVERIFY(second.fuseSample(rotated));
+    }
+
+    QCOMPARE(first.fusionStats(FusionAlgorithm::Mahony).updates, quint64(500));
+    QCOMPARE(first.fusionStats(FusionAlgorithm::Madgwick).updates, quint64(0));
+    QCOMPARE(second.fusionStats().updates, quint64(500));
+
+    float gap = std::abs(first.m_heading - second.m_heading);
+    if (gap > 180.0f) gap = 360.0f - gap;
+    QVERIFY(gap > 45.0f);
+}
+
+void TelemetryAndSourcesTest::mpu9250Source_motionSink_receivesRawHeadingAndTimestamp()
+{
+    // Objectif: vérifier que chaque fusion alimente l'étage de navigation à l'estime.
+    // Pourquoi: l'estime a besoin du cap brut (pas du cap lissé pour l'affichage, en retard de ~1 s)
+    //           et de l'horodatage d'acquisition pour propager la position au bon instant.
+    // Procédure détaillée:
+    //   1) Brancher un DeadReckoning sur la source et fusionner un échantillon statique horodaté.
+    //   2) Lire la mesure en file : même horodatage, cap brut identique au cap du filtre + déclinaison.
+    //   3) Vérifier que l'accélération longitudinale est nulle au repos (gravité correctement retirée).
+    TelemetryData data;
+    DeadReckoning deadReckoning(&data);
+    Mpu9250Source source(&data);
+    source.setMotionSink(&deadReckoning);
+
+    float truth[4];
+    ImuSample sample = tiltedStaticSample(truth);
+    sample.timestampNs = 123456789;
+    source.m_engine->reset(truth);
+
+    QVERIFY(source.fuseSample(sample));
+    QCOMPARE(deadReckoning.m_motion.size(), std::size_t(1));
+
+    MotionSample motion;
+    QVERIFY(deadReckoning.m_motion.pop(motion));
+    QCOMPARE(motion.timestampNs, qint64(123456789));
+
+    MadgwickEngine reference;
+    reference.reset(truth);
+    reference.holdMag(sample);
+    float expected = reference.computeHeading() + 2.0f;
+    if (expected >= 360.0f) expected -= 360.0f;
+    QVERIFY(std::abs(motion.headingDeg - expected) < 0.5f);
+    QVERIFY(std::abs(motion.forwardAccelMs2) < 0.05f);
+}
+
+namespace {
+// Écart Nord/Est (m) entre la position affichée par l'estimateur et un point de référence.
+void offsetMetres(const DeadReckoning& dr, double lat, double lon, double& north, double& east)
+{
+    const double earthRadius = 6371000.0;
+    north = (dr.latitude() - lat) * M_PI / 180.0 * earthRadius;
+    east = (dr.longitude() - lon) * M_PI / 180.0 * earthRadius * std::cos(lat * M_PI / 180.0);
+}
+
+GpsFix movingFix(double lat, double lon, qint64 timestampNs)
+{
+    GpsFix fix;
+    fix.valid = true;
+    fix.lat = lat;
+    fix.lon = lon;
+    fix.hasSpeed = true;
+    fix.speedMs = 10.0;
+    fix.hasCourse = true;
+    fix.courseDeg = 90.0;
+    fix.timestampNs = timestampNs;
+    return fix;
+}
+
+void pushConstantMotion(DeadReckoning& dr, qint64 fromNs, qint64 toNs, float headingDeg)
+{
+    for (qint64 t = fromNs + 10000000; t <= toNs; t += 10000000) {
+        MotionSample motion;
+        motion.timestampNs = t;
+        motion.headingDeg = headingDeg;
+        QVERIFY(dr.pushMotion(motion));
+        // Vidage régulier, comme le ferait le tick de publication à 30 Hz.
+        if ((t - fromNs) % 100000000 == 0) dr.propagateTo(t);
+    }
+}
+}
+
+void TelemetryAndSourcesTest::deadReckoning_fixLoss_propagatesWithLearnedImuHeading()
+{
+    // Objectif: valider la navigation à l'estime pendant une perte de fix (tunnel).
+    // Pourquoi: sans estime, le marqueur reste figé au dernier fix pendant toute la perte de signal.
+    // Procédure détaillée:
+    //   1) Rouler plein Est à 10 m/s avec un cap IMU décalé de 10° (désalignement de montage).
+    //   2) Au second fix, le décalage route GPS - cap IMU doit être appris.
+    //   3) Perdre le fix 3 s : la position doit avancer d'environ 30 m vers l'Est, pas vers l'Est-Nord-Est.
+    //   4) Sans fix pendant plus que la durée maximale, la position est figée (état Lost).
+    DeadReckoning dr(nullptr);
+    QSignalSpy modeSpy(&dr, &DeadReckoning::modeChanged);
+    const qint64 second = 1000000000LL;
+    const double lat = 48.0;
+    const double lon = 2.0;
+    const double metreLon = 180.0 / (M_PI * 6371000.0 * std::cos(lat * M_PI / 180.0));
+
+    dr.onGpsFix(movingFix(lat, lon, 10 * second));
+    QCOMPARE(dr.mode(), DeadReckoning::Mode::Tracking);
+    pushConstantMotion(dr, 10 * second, 11 * second, 80.0f);
+    dr.onGpsFix(movingFix(lat, lon + 10.0 * metreLon, 11 * second));
+    QVERIFY(std::abs(dr.headingOffsetDeg() - 10.0) < 1e-6);
+    QVERIFY(std::abs(dr.headingDeg() - 90.0) < 1e-6);
+
+    GpsFix lost;
+    lost.timestampNs = 11 * second + 200000000;
+    dr.onGpsFix(lost);
+    QCOMPARE(dr.mode(), DeadReckoning::Mode::DeadReckoning);
+
+    pushConstantMotion(dr, 11 * second, 14 * second, 80.0f);
+    dr.propagateTo(14 * second);
+
+    double north = 0.0, east = 0.0;
+    offsetMetres(dr, lat, lon + 10.0 * metreLon, north, east);
+    QVERIFY(std::abs(east - 30.0) < 0.1);
+    QVERIFY(std::abs(north) < 0.1);
+
+    dr.setMaxDeadReckoningMs(5000);
+    dr.propagateTo(17 * second);
+    QCOMPARE(dr.mode(), DeadReckoning::Mode::Lost);
+    const double frozenLon = dr.longitude();
+    dr.propagateTo(20 * second);
+    QCOMPARE(dr.longitude(), frozenLon);
+    QCOMPARE(modeSpy.count(), 3);
+}
+
+void TelemetryAndSourcesTest::deadReckoning_fixReturn_blendsInsteadOfJumping()
+{
+    // Objectif: vérifier le raccord progressif entre l'estime et le fix qui revient.
+    // Pourquoi: un recalage instantané ferait sauter le marqueur de plusieurs mètres à la sortie du tunnel.
+    // Procédure détaillée:
+    //   1) Estimer 3 s sans fix, puis recevoir un fix décalé de 5 m vers le Nord.
+    //   2) Juste après le fix, la position affichée est encore celle de l'estime (écart ≈ 5 m).
+    //   3) L'écart décroît ensuite continûment et devient négligeable en 2 s.
+    //   4) Un écart aberrant (> 50 m) est recalé immédiatement.
+    DeadReckoning dr(nullptr);
+    const qint64 second = 1000000000LL;
+    const double lat = 48.0;
+    const double lon = 2.0;
+    const double metreLat = 180.0 / (M_PI * 6371000.0);
+    const double metreLon = 180.0 / (M_PI * 6371000.0 * std::cos(lat * M_PI / 180.0));
+
+    dr.onGpsFix(movingFix(lat, lon, 10 * second));
+    dr.propagateTo(13 * second);
+
+    GpsFix back = movingFix(lat + 5.0 * metreLat, lon + 30.0 * metreLon, 13 * second);
+    dr.onGpsFix(back);
+    QCOMPARE(dr.mode(), DeadReckoning::Mode::Tracking);
+
+    double north = 0.0, east = 0.0;
+    offsetMetres(dr, back.lat, back.lon, north, east);
+    QVERIFY(std::abs(north + 5.0) < 0.05);
+
+    double previous = std::abs(north);
+    for (int i = 1; i <= 20; ++i) {
+        dr.propagateTo(13 * second + i * 100000000LL);
+        offsetMetres(dr, back.lat, back.lon + i * metreLon, north, east);
+        QVERIFY(std::abs(north) < previous);
+        previous = std::abs(north);
+    }
+    QVERIFY(previous < 0.2);
+
+    dr.onGpsFix(movingFix(lat + 500.0 * metreLat, lon, 16 * second));
+    offsetMetres(dr, lat + 500.0 * metreLat, lon, north, east);
+    QVERIFY(std::abs(north) < 1e-6);
+    QVERIFY(std::abs(east) < 1e-6);
+}
+
+QTEST_GUILESS_MAIN(TelemetryAndSourcesTest)
 #include "tst_telemetrydata.moc"
@@ -0,0 +1,25 @@
+QT += testlib core network positioning
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = tileprefetcher_test
+
+SOURCES += \
+    tst_tileprefetcher.cpp \
+    ../../tilecache.cpp \
+    ../../tileprefetcher.cpp \
+    ../../routemodel.cpp \
+    ../../segmentgrid.cpp \
+    ../../routematcher.cpp \
+    ../../routestrip.cpp \
+    ../../polylinesimplifier.cpp
+
+HEADERS += \
+    ../httpstandin.h \
+    ../../tilecache.h \
+    ../../tileprefetcher.h \
+    ../../routemodel.h \
+    ../../segmentgrid.h \
+    ../../routematcher.h \
+    ../../routestrip.h \
+    ../../polylinesimplifier.h
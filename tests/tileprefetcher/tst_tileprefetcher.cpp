@@ -0,0 +1,312 @@
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSet>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <cmath>
+
+#include "../httpstandin.h"
+#include "../../routemodel.h"
+#include "../../tilecache.h"
+#include "../../tileprefetcher.h"
+
+namespace {
+// Serveur de tuiles local : renvoie "tuile z/x/y" pour les zooms 0 à 18, 404 au-delà, après un délai.
+class TileServerStandIn : public HttpStandIn {
+public:
+    TileServerStandIn()
+    {
+        respond = [](const QString& path) {
+            Reply reply;
+            reply.contentType = "image/png";
+            if (path.section(QLatin1Char('/'), 1, 1).toInt() <= 18)
+                reply.body = "tuile " + path.mid(1).chopped(4).toLatin1();
+            else
+                reply.status = 404;
+            return reply;
+        };
+        delayMs = [](const QString&) { return 5; };
+    }
+
+    QString urlTemplate() const { return url().toString() + QStringLiteral("/%z/%x/%y.png"); }
+};
+
+// Tuile contenant (lat, lon), formule de référence OpenStreetMap.
+TileId tileAt(double lat, double lon, int zoom)
+{
+    const double n = double(1 << zoom);
+    const double phi = lat * M_PI / 180.0;
+    return TileId{zoom, int(std::floor((lon + 180.0) / 360.0 * n)),
+                  int(std::floor((1.0 - std::asinh(std::tan(phi)) / M_PI) / 2.0 * n))};
+}
+
+QSet<quint64> keysOf(const QList<TileId>& tiles)
+{
+    QSet<quint64> keys;
+    for (const TileId& tile : tiles) keys.insert(tile.key());
+    return keys;
+}
+
+// GET synchrone ; renvoie le code HTTP et remplit @p body.
+int httpGet(QNetworkAccessManager& network, const QString& url, QByteArray& body)
+{
+    QNetworkReply* reply = network.get(QNetworkRequest(QUrl(url)));
+    QSignalSpy finished(reply, &QNetworkReply::finished);
+    if (!reply->isFinished() && !finished.wait(5000)) return -1;
+    body = reply->readAll();
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    reply->deleteLater();
+    return status;
+}
+}
+
+class TilePrefetcherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void corridorTiles_followRouteAtSpeedZoomLevels();
+    void tileCache_byteBudget_evictsLeastRecentlyUsed();
+    void prefetcher_newRoute_downloadsCorridorOnceAtLowConcurrency();
+    void tileCache_mapRequests_servedFromDiskOrUpstream();
+    void tileCache_mapRequestDuringPrefetch_reissuedAtNormalPriority();
+};
+
+void TilePrefetcherTest::corridorTiles_followRouteAtSpeedZoomLevels()
+{
+    // Objectif: le couloir couvre le tracé aux zooms que la carte affichera sur chaque segment, sans plus.
+    // Pourquoi: à 130 km/h la carte passe en zoom 15 ; précharger le zoom 18 d'une autoroute coûterait
+    //           des milliers de tuiles inutiles, ne pas précharger le zoom 15 laisserait des tuiles vides.
+    // Procédure détaillée:
+    //   1) Paliers du zoom automatique identiques à map.qml (15 > 100 km/h, 16 > 70, 17 > 40, 18 sinon).
+    //   2) Tracé est-ouest : 4 km limités à 130 km/h, puis 800 m à 50 km/h.
+    //   3) Autoroute en zooms 15 et 16, ville en 17 et 18 ; aucune tuile en double ; ordre du trajet.
+    //   4) Autour de chaque sommet, le carré de 2 tuiles de rayon est présent ; rien au-delà en latitude.
+    //   5) maxTiles tronque la fin du trajet, pas le début.
+    QCOMPARE(TilePrefetcher::speedZoom(130), 15);
+    QCOMPARE(TilePrefetcher::speedZoom(100), 16);
+    QCOMPARE(TilePrefetcher::speedZoom(90), 16);
+    QCOMPARE(TilePrefetcher::speedZoom(50), 17);
+    QCOMPARE(TilePrefetcher::speedZoom(30), 18);
+
+    const QList<QGeoCoordinate> points = {QGeoCoordinate(45.0, 5.0), QGeoCoordinate(45.0, 5.05),
+                                          QGeoCoordinate(45.0, 5.06)};
+    const QList<TileId> tiles = TilePrefetcher::corridorTiles(points, {130, 50});
+    QVERIFY(!tiles.isEmpty());
+    QCOMPARE(keysOf(tiles).size(), tiles.size());
+    QCOMPARE(tiles.first().zoom, 15);
+
+    QSet<int> zooms;
+    for (const TileId& tile : tiles) zooms.insert(tile.zoom);
+    QCOMPARE(zooms, QSet<int>({15, 16, 17, 18}));
+
+    const QSet<quint64> keys = keysOf(tiles);
+    const auto coveredAround = [&keys](const QGeoCoordinate& point, int zoom) {
+        const TileId center = tileAt(point.latitude(), point.longitude(), zoom);
+        for (int dy = -2; dy <= 2; ++dy) {
+            for (int dx = -2; dx <= 2; ++dx) {
+                if (!keys.contains(TileId{zoom, center.x + dx, center.y + dy}.key())) return false;
+            }
+        }
+        return true;
+    };
+    for (int zoom : {15, 16}) {
+        QVERIFY(coveredAround(points.at(0), zoom));
+        QVERIFY(coveredAround(points.at(1), zoom));
+    }
+    for (int zoom : {17, 18}) {
+        QVERIFY(coveredAround(points.at(1), zoom));
+        QVERIFY(coveredAround(points.at(2), zoom));
+        QVERIFY(!keys.contains(tileAt(45.0, 5.0, zoom).key())); // Début d'autoroute : pas de détail
+    }
+    const int routeRow = tileAt(45.0, 5.0, 18).y;
+    for (const TileId& tile : tiles) {
+        if (tile.zoom == 18) QVERIFY(std::abs(tile.y - routeRow) <= 2);
+    }
+
+    const QList<TileId> firstTen = TilePrefetcher::corridorTiles(points, {130, 50}, 10);
+    QCOMPARE(firstTen.size(), 10);
+    for (int i = 0; i < firstTen.size(); ++i) QVERIFY(firstTen.at(i) == tiles.at(i));
+}
+
+void TilePrefetcherTest::tileCache_byteBudget_evictsLeastRecentlyUsed()
+{
+    // Objectif: le cache reste sous son budget en octets en supprimant les tuiles les moins récemment utilisées.
+    // Pourquoi: le préchargement de longs trajets remplirait sinon la carte SD du Raspberry Pi.
+    // Procédure détaillée:
+    //   1) Budget de 10 000 octets ; trois tuiles de 3 000 octets.
+    //   2) Lire la première (elle devient la plus récente), en ajouter une quatrième.
+    //   3) La deuxième, la moins récemment utilisée, est supprimée du cache et du disque.
+    //   4) Réouverture : les tuiles restantes sont indexées ; un budget plus petit est appliqué aussitôt.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const TileId a{15, 16834, 11745}, b{15, 16835, 11745}, c{15, 16836, 11745}, d{15, 16837, 11745};
+    const QByteArray data(3000, 'x');
+
+    TileCache cache;
+    cache.open(dir.path(), 10000);
+    QVERIFY(cache.insert(a, data));
+    QVERIFY(cache.insert(b, data));
+    QVERIFY(cache.insert(c, data));
+    QCOMPARE(cache.totalBytes(), qint64(9000));
+    QCOMPARE(cache.read(a), data);
+    QVERIFY(cache.insert(d, data));
+
+    QVERIFY(cache.contains(a));
+    QVERIFY(!cache.contains(b));
+    QVERIFY(cache.contains(c));
+    QVERIFY(cache.contains(d));
+    QCOMPARE(cache.totalBytes(), qint64(9000));
+    QCOMPARE(cache.stats().evictions, quint64(1));
+    QVERIFY(!QFile::exists(dir.filePath(QStringLiteral("15-16835-11745.png"))));
+    QVERIFY(cache.read(b).isEmpty());
+
+    // Une tuile plus grande que le budget n'est pas gardée.
+    QVERIFY(!cache.insert(TileId{16, 1, 1}, QByteArray(20000, 'y')));
+    QCOMPARE(cache.tileCount(), 0);
+
+    QVERIFY(cache.insert(a, data));
+    QVERIFY(cache.insert(c, data));
+    TileCache reopened;
+    reopened.open(dir.path(), 10000);
+    QCOMPARE(reopened.tileCount(), 2);
+    QCOMPARE(reopened.totalBytes(), qint64(6000));
+    QCOMPARE(reopened.read(c), data);
+
+    TileCache smaller;
+    smaller.open(dir.path(), 4000);
+    QCOMPARE(smaller.tileCount(), 1);
+    QCOMPARE(smaller.totalBytes(), qint64(3000));
+}
+
+void TilePrefetcherTest::prefetcher_newRoute_downloadsCorridorOnceAtLowConcurrency()
+{
+    // Objectif: un nouvel itinéraire télécharge tout son couloir en arrière-plan, une seule fois.
+    // Pourquoi: sur une 4G faible, les tuiles chargées seulement à l'affichage restaient vides à 130 km/h ;
+    //           le préchargement ne doit pas pour autant occuper toutes les connexions de la carte.
+    // Procédure détaillée:
+    //   1) Cache vide alimenté par un serveur de tuiles local ; itinéraire de 1,6 km à 130 km/h.
+    //   2) finished() : chaque tuile du couloir demandée une fois, enregistrée, jamais plus de
+    //      MaxConcurrent requêtes simultanées.
+    //   3) Même itinéraire rechargé (recalcul) : aucune nouvelle requête, finished() aussitôt.
+    TileServerStandIn server;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TileCache cache;
+    cache.setUpstream(server.urlTemplate());
+    cache.open(dir.path());
+    RouteModel route;
+    TilePrefetcher prefetcher(&route, &cache);
+    QSignalSpy finished(&prefetcher, &TilePrefetcher::finished);
+
+    RouteModel::RouteData data;
+    data.points = {QGeoCoordinate(45.0, 5.0), QGeoCoordinate(45.0, 5.02)};
+    data.speedLimitsKmh = {130};
+    const QList<TileId> corridor = TilePrefetcher::corridorTiles(data.points, data.speedLimitsKmh);
+    route.setRoute(data);
+    QVERIFY(prefetcher.pendingCount() > 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 20000);
+    QCOMPARE(server.requests.size(), corridor.size());
+    QCOMPARE(QSet<QString>(server.requests.cbegin(), server.requests.cend()).size(), corridor.size());
+    QVERIFY(server.maxInFlight <= TilePrefetcher::MaxConcurrent);
+    for (const TileId& tile : corridor) QVERIFY(cache.contains(tile));
+    QCOMPARE(cache.read(corridor.first()),
+             QStringLiteral("tuile %1/%2/%3").arg(corridor.first().zoom).arg(corridor.first().x)
+                 .arg(corridor.first().y).toLatin1());
+    QCOMPARE(prefetcher.stats().downloaded, quint64(corridor.size()));
+    QCOMPARE(prefetcher.pendingCount(), 0);
+
+    route.setRoute(data);
+    QCOMPARE(finished.count(), 2);
+    QCOMPARE(server.requests.size(), corridor.size());
+    QCOMPARE(prefetcher.stats().alreadyCached, quint64(corridor.size()));
+}
+
+void TilePrefetcherTest::tileCache_mapRequests_servedFromDiskOrUpstream()
+{
+    // Objectif: l'adresse locale donnée au plugin QtLocation sert le cache, et télécharge ce qui manque.
+    // Pourquoi: le plugin n'indexe son propre cache qu'au démarrage ; les tuiles préchargées pendant le
+    //           trajet ne lui parviennent que par cette adresse.
+    // Procédure détaillée:
+    //   1) Avant listen(), urlTemplate() est l'adresse du serveur de tuiles ; après, 127.0.0.1.
+    //   2) Tuile en cache : servie sans requête au serveur.
+    //   3) Tuile absente : téléchargée une fois, enregistrée, puis servie depuis le disque.
+    //   4) Chemin invalide : 404 ; échec du serveur de tuiles : 502.
+    TileServerStandIn server;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TileCache cache;
+    cache.setUpstream(server.urlTemplate());
+    cache.open(dir.path());
+    QCOMPARE(cache.urlTemplate(), server.urlTemplate());
+    QVERIFY(cache.listen());
+    QVERIFY(cache.urlTemplate().startsWith(QStringLiteral("http://127.0.0.1:")));
+    QVERIFY(cache.urlTemplate().endsWith(QStringLiteral("/%z/%x/%y.png")));
+    const auto urlOf = [&cache](const QString& path) {
+        return cache.urlTemplate().section(QLatin1Char('/'), 0, 2) + path;
+    };
+
+    QNetworkAccessManager network;
+    QByteArray body;
+    QVERIFY(cache.insert(TileId{16, 33668, 23491}, "tuile locale"));
+    QCOMPARE(httpGet(network, urlOf(QStringLiteral("/16/33668/23491.png")), body), 200);
+    QCOMPARE(body, QByteArray("tuile locale"));
+    QVERIFY(server.requests.isEmpty());
+
+    QCOMPARE(httpGet(network, urlOf(QStringLiteral("/16/33669/23491.png")), body), 200);
+    QCOMPARE(body, QByteArray("tuile 16/33669/23491"));
+    QCOMPARE(server.requests.size(), 1);
+    QVERIFY(cache.contains(TileId{16, 33669, 23491}));
+    QCOMPARE(httpGet(network, urlOf(QStringLiteral("/16/33669/23491.png")), body), 200);
+    QCOMPARE(body, QByteArray("tuile 16/33669/23491"));
+    QCOMPARE(server.requests.size(), 1);
+    QCOMPARE(cache.stats().servedFromDisk, quint64(2));
+
+    QCOMPARE(httpGet(network, urlOf(QStringLiteral("/16/abc/1.png")), body), 404);
+    QCOMPARE(httpGet(network, urlOf(QStringLiteral("/19/1/1.png")), body), 502);
+    QCOMPARE(cache.stats().downloadFailures, quint64(1));
+    QVERIFY(!cache.contains(TileId{19, 1, 1}));
+}
+
+void TilePrefetcherTest::tileCache_mapRequestDuringPrefetch_reissuedAtNormalPriority()
+{
+    // Objectif: une tuile demandée par la carte pendant son préchargement n'attend pas en basse priorité.
+    // Pourquoi: la priorité d'une requête partie ne change plus ; rattachée telle quelle, la tuile
+    //           affichée passerait derrière tout le couloir en file.
+    // Procédure détaillée:
+    //   1) Lancer le téléchargement d'une tuile en basse priorité, puis la demander en priorité normale.
+    //   2) Vérifier la relance (reprioritized), sans fusion, et un seul tileFetched, tuile enregistrée.
+    //   3) Redemander en basse priorité pendant le téléchargement normal : simple fusion.
+    TileServerStandIn server;
+    server.delayMs = [](const QString&) { return 50; };
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TileCache cache;
+    cache.setUpstream(server.urlTemplate());
+    cache.open(dir.path());
+    QSignalSpy fetched(&cache, &TileCache::tileFetched);
+
+    const TileId tile{16, 33670, 23491};
+    cache.fetch(tile, QNetworkRequest::LowPriority);
+    cache.fetch(tile, QNetworkRequest::NormalPriority);
+    QCOMPARE(cache.stats().reprioritized, quint64(1));
+    QCOMPARE(cache.stats().coalesced, quint64(0));
+    QCOMPARE(cache.stats().downloads, quint64(2));
+
+    cache.fetch(tile, QNetworkRequest::LowPriority);
+    QCOMPARE(cache.stats().coalesced, quint64(1));
+    QCOMPARE(cache.stats().reprioritized, quint64(1));
+
+    QVERIFY(fetched.wait(5000));
+    QTest::qWait(100);
+    QCOMPARE(fetched.count(), 1);
+    QCOMPARE(fetched.at(0).at(0).toULongLong(), tile.key());
+    QVERIFY(fetched.at(0).at(1).toBool());
+    QVERIFY(cache.contains(tile));
+    QCOMPARE(cache.stats().downloadFailures, quint64(0));
+}
+
+QTEST_GUILESS_MAIN(TilePrefetcherTest)
+#include "tst_tileprefetcher.moc"
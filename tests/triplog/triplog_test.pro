@@ -0,0 +1,21 @@
+QT += testlib core
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = triplog_test
+
+SOURCES += \
+    tst_triplog.cpp \
+    ../../telemetrydata.cpp \
+    ../../triplog.cpp \
+    ../../triplogreader.cpp \
+    ../../triplogwriter.cpp
+
+HEADERS += \
+    ../../telemetrydata.h \
+    ../../telemetryring.h \
+    ../../gpsfix.h \
+    ../../imusample.h \
+    ../../triplog.h \
+    ../../triplogreader.h \
+    ../../triplogwriter.h
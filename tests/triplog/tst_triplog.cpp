@@ -0,0 +1,260 @@
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cmath>
+
+#include "../../telemetrydata.h"
+#include "../../triplog.h"
+#include "../../triplogreader.h"
+#include "../../triplogwriter.h"
+
+namespace {
+ImuSample imuSample(qint64 timestampNs, int i)
+{
+    ImuSample sample;
+    sample.ax = 0.01f * i;
+    sample.ay = -0.02f;
+    sample.az = 1.0f;
+    sample.gx = 0.001f * i;
+    sample.mx = 210.0f;
+    sample.my = -35.5f;
+    sample.mz = 402.25f;
+    sample.magValid = (i % 2) == 0;
+    sample.timestampNs = timestampNs;
+    return sample;
+}
+
+GpsFix gpsFix(qint64 timestampNs, int i)
+{
+    GpsFix fix;
+    fix.valid = true;
+    fix.lat = 48.1173 + 1e-5 * i;
+    fix.lon = 11.5166667;
+    fix.hasSpeed = true;
+    fix.speedMs = 15.0;
+    fix.satellites = 14;
+    fix.hdop = 0.9;
+    fix.horizontalAccuracyM = 1.8;
+    fix.timestampNs = timestampNs;
+    return fix;
+}
+}
+
+class TripLogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encode_allRecordTypes_roundTrip();
+    void writer_severalBlocks_readerIndexesAndSeeks();
+    void reader_interruptedLog_stopsAtLastCompleteRecord();
+    void benchmark_logImuAt200Hz();
+};
+
+void TripLogTest::encode_allRecordTypes_roundTrip()
+{
+    // Objectif: garantir que chaque type d'enregistrement se relit à l'identique (à la précision float près).
+    // Pourquoi: le journal sert à rejouer un trajet après coup ; un champ mal placé dans la charge
+    //           utile de 36 octets fausserait silencieusement toute l'analyse.
+    // Procédure détaillée:
+    //   1) GPS, IMU, cap et en-tête : encodage puis décodage, comparaison champ par champ.
+    //   2) Texte trop long contenant des caractères accentués : troncature à 36 octets sans couper
+    //      une séquence UTF-8.
+    //   3) Décodage avec le mauvais type ou sans marqueur refusé.
+    GpsFix fix = gpsFix(123456789, 3);
+    fix.hasCourse = true;
+    fix.courseDeg = 84.4;
+    GpsFix decodedFix;
+    QVERIFY(TripLog::decodeGps(TripLog::encodeGps(fix), decodedFix));
+    QCOMPARE(decodedFix.timestampNs, fix.timestampNs);
+    QCOMPARE(decodedFix.lat, fix.lat);
+    QCOMPARE(decodedFix.lon, fix.lon);
+    QVERIFY(decodedFix.valid && decodedFix.hasSpeed && decodedFix.hasCourse);
+    QVERIFY(std::abs(decodedFix.speedMs - 15.0) < 1e-6);
+    QVERIFY(std::abs(decodedFix.courseDeg - 84.4) < 1e-4);
+    QVERIFY(std::abs(decodedFix.horizontalAccuracyM - 1.8) < 1e-6);
+    QCOMPARE(decodedFix.hdop, 0.9);
+    QCOMPARE(decodedFix.satellites, 14);
+
+    const ImuSample sample = imuSample(987654321, 4);
+    ImuSample decodedSample;
+    QVERIFY(TripLog::decodeImu(TripLog::encodeImu(sample), decodedSample));
+    QCOMPARE(decodedSample.timestampNs, sample.timestampNs);
+    QCOMPARE(decodedSample.ax, sample.ax);
+    QCOMPARE(decodedSample.gx, sample.gx);
+    QCOMPARE(decodedSample.mz, sample.mz);
+    QVERIFY(decodedSample.magValid);
+
+    double heading = 0.0;
+    QVERIFY(TripLog::decodeHeading(TripLog::encodeHeading(271.5, 42), heading));
+    QCOMPARE(heading, 271.5);
+
+    TripLog::HeaderInfo info;
+    info.version = TripLog::Version;
+    info.blockSlots = TripLog::BlockSlots;
+    info.wallClockMs = 1711200000000;
+    info.originNs = 777;
+    TripLog::HeaderInfo decodedInfo;
+    QVERIFY(TripLog::decodeHeader(TripLog::encodeHeader(info), decodedInfo));
+    QCOMPARE(decodedInfo.wallClockMs, info.wallClockMs);
+    QCOMPARE(decodedInfo.originNs, info.originNs);
+
+    // "è" occupe les octets 35 et 36 : il est retiré en entier.
+    const TripLogRecord text = TripLog::encodeText(TripLog::RouteRequest,
+                                                   QStringLiteral("Avenue de la Libération, Saint-Genès"), 1);
+    QCOMPARE(int(text.flags), 35);
+    QCOMPARE(TripLog::decodeText(text), QStringLiteral("Avenue de la Libération, Saint-Gen"));
+    QCOMPARE(TripLog::decodeText(TripLog::encodeText(TripLog::PageSwitch, QStringLiteral("navigation+media"), 1)),
+             QStringLiteral("navigation+media"));
+
+    QVERIFY(!TripLog::decodeGps(TripLog::encodeImu(sample), decodedFix));
+    QVERIFY(!TripLog::isWritten(TripLogRecord()));
+}
+
+void TripLogTest::writer_severalBlocks_readerIndexesAndSeeks()
+{
+    // Objectif: valider la structure par blocs produite par le thread d'écriture et la recherche par date.
+    // Pourquoi: l'index de fin de bloc est ce qui permet d'ouvrir un trajet de plusieurs heures
+    //           (des millions d'enregistrements) et d'aller à un instant donné sans tout parcourir.
+    // Procédure détaillée:
+    //   1) Deux évènements d'interface, puis 1500 échantillons IMU à 200 Hz entrecoupés d'un fix GPS
+    //      par seconde, poussés dans l'ordre chronologique.
+    //   2) Relecture : nombre d'enregistrements, deux blocs complets, index cohérents (bornes, types).
+    //   3) lowerBound() sur un instant du troisième bloc (incomplet) et entre deux échantillons.
+    //   4) forEach() par type : décompte exact, contenu GPS relu.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("trajet.igpstrip"));
+
+    TripLogWriter writer;
+    QVERIFY(writer.open(path));
+    writer.logPageSwitch(QStringLiteral("navigation+media"));
+    writer.logRouteRequest(QStringLiteral("Tour Eiffel"));
+
+    const qint64 periodNs = 5000000;
+    const qint64 t0 = TelemetryData::monotonicNowNs() + 1000000;
+    int gpsCount = 0;
+    for (int i = 0; i < 1500; ++i) {
+        const qint64 ts = t0 + i * periodNs;
+        writer.logImu(imuSample(ts, i));
+        if (i % 200 == 0) writer.logGpsFix(gpsFix(ts + periodNs / 2, gpsCount++));
+    }
+    writer.close();
+    QCOMPARE(writer.stats().dropped, quint64(0));
+
+    const int dataRecords = 2 + 1500 + gpsCount;
+    QCOMPARE(writer.stats().records, quint64(dataRecords));
+    QCOMPARE(writer.stats().blocks, quint64(2));
+
+    TripLogReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.header().version, TripLog::Version);
+    QCOMPARE(reader.recordCount(), 1 + dataRecords + 2);
+    QCOMPARE(reader.blockCount(), 2);
+    QCOMPARE(QFile(path).size(), qint64(reader.recordCount()) * qint64(sizeof(TripLogRecord)));
+
+    TripLog::IndexEntry first;
+    TripLog::IndexEntry second;
+    QVERIFY(reader.index(0, first));
+    QVERIFY(reader.index(1, second));
+    QCOMPARE(first.block, quint32(0));
+    QCOMPARE(second.block, quint32(1));
+    QVERIFY(first.typeMask & (1u << TripLog::PageSwitch));
+    QVERIFY(first.typeMask & (1u << TripLog::Gps));
+    QVERIFY(!(second.typeMask & (1u << TripLog::RouteRequest)));
+    QVERIFY(first.lastTimestampNs < second.firstTimestampNs);
+    QCOMPARE(reader.record(TripLogReader::indexPosition(0)).type, quint8(TripLog::Index));
+    QVERIFY(!TripLogReader::isDataPosition(TripLogReader::indexPosition(1)));
+
+    const qint64 target = t0 + 1300 * periodNs - 1;
+    const int position = reader.lowerBound(target);
+    QVERIFY(position > TripLogReader::indexPosition(1));
+    ImuSample found;
+    QVERIFY(TripLog::decodeImu(reader.record(position), found));
+    QCOMPARE(found.timestampNs, t0 + 1300 * periodNs);
+    QCOMPARE(reader.lowerBound(t0 + 2000 * periodNs), reader.recordCount());
+    QCOMPARE(reader.lowerBound(0), 1);
+
+    QCOMPARE(reader.forEach(TripLog::Imu, [](const TripLogRecord&) {}), 1500);
+    QCOMPARE(reader.forEach(TripLog::RouteRequest, [](const TripLogRecord& r) {
+        QCOMPARE(TripLog::decodeText(r), QStringLiteral("Tour Eiffel"));
+    }), 1);
+    double lastLat = 0.0;
+    QCOMPARE(reader.forEach(TripLog::Gps, [&](const TripLogRecord& r) {
+        GpsFix fix;
+        QVERIFY(TripLog::decodeGps(r, fix));
+        QVERIFY(fix.lat > lastLat);
+        lastLat = fix.lat;
+    }), gpsCount);
+}
+
+void TripLogTest::reader_interruptedLog_stopsAtLastCompleteRecord()
+{
+    // Objectif: vérifier qu'un journal interrompu par une coupure reste lisible jusqu'au dernier
+    //           enregistrement intact.
+    // Pourquoi: sur la cible, l'alimentation est coupée avec le contact ; le système de fichiers peut
+    //           alors laisser un enregistrement tronqué suivi d'une zone allouée remplie de zéros.
+    // Procédure détaillée:
+    //   1) Écriture de 100 échantillons IMU, fermeture.
+    //   2) Troncature au milieu du 100e enregistrement puis ajout de 4 enregistrements nuls.
+    //   3) Relecture : 99 échantillons ; un fichier étranger est refusé à l'ouverture.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("coupure.igpstrip"));
+
+    TripLogWriter writer;
+    QVERIFY(writer.open(path));
+    const qint64 t0 = TelemetryData::monotonicNowNs();
+    for (int i = 0; i < 100; ++i) writer.logImu(imuSample(t0 + i * 5000000, i));
+    writer.close();
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    const qint64 recordSize = qint64(sizeof(TripLogRecord));
+    QCOMPARE(file.size(), 101 * recordSize);
+    QVERIFY(file.resize(100 * recordSize + 20));
+    QVERIFY(file.seek(file.size()));
+    file.write(QByteArray(int(4 * recordSize), '\0'));
+    file.close();
+
+    TripLogReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.recordCount(), 100);
+    QCOMPARE(reader.forEach(TripLog::Imu, [](const TripLogRecord&) {}), 99);
+    ImuSample last;
+    QVERIFY(TripLog::decodeImu(reader.record(reader.recordCount() - 1), last));
+    QCOMPARE(last.timestampNs, t0 + 98 * 5000000);
+
+    const QString other = dir.filePath(QStringLiteral("autre.bin"));
+    QFile otherFile(other);
+    QVERIFY(otherFile.open(QIODevice::WriteOnly));
+    otherFile.write(QByteArray(int(10 * recordSize), 'x'));
+    otherFile.close();
+    QVERIFY(!reader.open(other));
+    QVERIFY(!reader.isOpen());
+}
+
+void TripLogTest::benchmark_logImuAt200Hz()
+{
+    // Objectif: mesurer le coût côté thread d'acquisition d'une seconde de trajet (200 échantillons
+    //           IMU et 20 caps), écriture disque comprise dans le thread de fond.
+    // Pourquoi: le budget est inférieur à 1 % d'un cœur du Raspberry Pi, soit 10 ms par seconde.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TripLogWriter writer;
+    QVERIFY(writer.open(dir.filePath(QStringLiteral("bench.igpstrip"))));
+
+    qint64 ts = TelemetryData::monotonicNowNs();
+    QBENCHMARK {
+        for (int i = 0; i < 200; ++i) {
+            ts += 5000000;
+            writer.logImu(imuSample(ts, i));
+            if (i % 10 == 0) writer.logHeading(90.0, ts);
+        }
+    }
+    writer.close();
+    QVERIFY(writer.stats().records > 0);
+}
+
+QTEST_GUILESS_MAIN(TripLogTest)
+#include "tst_triplog.moc"
@@ -0,0 +1,200 @@
+#include <QtTest>
+#include <cmath>
+
+#include "../../ubxprotocol.h"
+
+namespace {
+void putU2(QByteArray& payload, int offset, quint16 value)
+{
+    payload[offset] = char(value & 0xFF);
+    payload[offset + 1] = char(value >> 8);
+}
+
+void putU4(QByteArray& payload, int offset, quint32 value)
+{
+    putU2(payload, offset, quint16(value & 0xFFFF));
+    putU2(payload, offset + 2, quint16(value >> 16));
+}
+
+// Charge utile NAV-PVT (92 octets) d'un fix 3D à Munich, 15 m/s cap 84.4°.
+QByteArray navPvtPayload()
+{
+    QByteArray payload(92, '\0');
+    putU4(payload, 0, 392100000);                  // iTOW (ms)
+    putU2(payload, 4, 2024);
+    payload[6] = 3;
+    payload[7] = 23;
+    payload[8] = 12;
+    payload[9] = 35;
+    payload[10] = 19;
+    payload[11] = 0x07;                            // validDate | validTime | fullyResolved
+    payload[20] = 3;                               // fix 3D
+    payload[21] = 0x01;                            // gnssFixOK
+    payload[23] = 14;                              // numSV
+    putU4(payload, 24, quint32(qint32(115166667))); // lon 11.5166667°
+    putU4(payload, 28, quint32(qint32(481173000))); // lat 48.1173°
+    putU4(payload, 36, quint32(qint32(545400)));    // hMSL 545.4 m
+    putU4(payload, 40, 1800);                       // hAcc 1.8 m
+    putU4(payload, 44, 2600);                       // vAcc 2.6 m
+    putU4(payload, 48, quint32(qint32(1460)));      // velN
+    putU4(payload, 52, quint32(qint32(14929)));     // velE
+    putU4(payload, 56, quint32(qint32(-120)));      // velD
+    putU4(payload, 60, quint32(qint32(15000)));     // gSpeed 15 m/s
+    putU4(payload, 64, quint32(qint32(8440000)));   // headMot 84.4°
+    putU4(payload, 68, 350);                        // sAcc
+    putU4(payload, 72, 120000);                     // headAcc 1.2°
+    putU2(payload, 76, 161);                        // pDOP 1.61
+    return payload;
+}
+}
+
+class UbxProtocolTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frame_configurationMessages_matchReferenceBytes();
+    void navigationSetup_clampsRateAndDisablesNmea();
+    void feed_navPvtFrame_decodesAllFields();
+    void feed_splitFramesAmongNmeaAndCorruption_areRecovered();
+};
+
+void UbxProtocolTest::frame_configurationMessages_matchReferenceBytes()
+{
+    // Objectif: vérifier l'encodage des trames de configuration (en-tête, little-endian, Fletcher).
+    // Pourquoi: une somme fausse est ignorée silencieusement par le récepteur, qui resterait
+    //           alors en NMEA à 9600 bauds sans aucun message d'erreur.
+    // Procédure détaillée:
+    //   1) CFG-RATE 10 Hz et CFG-MSG "GGA off" : comparaison avec les octets de la documentation u-blox.
+    //   2) CFG-PRT 115200 : débit en little-endian à l'offset 8 et trame relue intègre par UbxParser.
+    QCOMPARE(UbxProtocol::cfgRate(10).toHex(' '), QByteArray("b5 62 06 08 06 00 64 00 01 00 01 00 7a 12"));
+    QCOMPARE(UbxProtocol::cfgMsg(UbxProtocol::ClassNmea, 0x00, 0).toHex(' '),
+             QByteArray("b5 62 06 01 03 00 f0 00 00 fa 0f"));
+
+    const QByteArray prt = UbxProtocol::cfgPrtUart(UbxProtocol::NavigationBaud);
+    QCOMPARE(prt.size(), 8 + 20);
+    QCOMPARE(prt.mid(6 + 8, 4).toHex(), QByteArray("00c20100"));
+
+    UbxParser parser;
+    int frames = 0;
+    parser.feed(prt.constData(), std::size_t(prt.size()),
+                [&](quint8 msgClass, quint8 msgId, const quint8* payload, std::size_t length) {
+                    QCOMPARE(msgClass, UbxProtocol::ClassCfg);
+                    QCOMPARE(msgId, UbxProtocol::IdCfgPrt);
+                    QCOMPARE(length, std::size_t(20));
+                    QCOMPARE(int(payload[0]), 1);
+                    ++frames;
+                });
+    QCOMPARE(frames, 1);
+    QCOMPARE(parser.stats().checksumErrors, quint64(0));
+}
+
+void UbxProtocolTest::navigationSetup_clampsRateAndDisablesNmea()
+{
+    // Objectif: contrôler la séquence envoyée après le passage à 115200 bauds.
+    // Pourquoi: la cadence doit rester dans la plage supportée (5 à 10 Hz), et toutes les phrases
+    //           NMEA doivent être coupées, sinon elles consomment la bande passante gagnée.
+    // Procédure détaillée:
+    //   1) 20 Hz et 1 Hz demandés : période de mesure bornée à 100 ms et 200 ms.
+    //   2) Six CFG-MSG NMEA à 0, NAV-PVT à chaque solution, NAV-DOP environ une fois par seconde.
+    QCOMPARE(UbxProtocol::navigationSetup(20).first(), UbxProtocol::cfgRate(10));
+    QCOMPARE(UbxProtocol::cfgRate(1).mid(6, 2).toHex(), QByteArray("c800"));
+
+    const QList<QByteArray> frames = UbxProtocol::navigationSetup(5);
+    QCOMPARE(frames.size(), 1 + 6 + 2);
+    int nmeaDisabled = 0;
+    for (const QByteArray& frame : frames.mid(1)) {
+        QCOMPARE(quint8(frame[2]), UbxProtocol::ClassCfg);
+        QCOMPARE(quint8(frame[3]), UbxProtocol::IdCfgMsg);
+        if (quint8(frame[6]) == UbxProtocol::ClassNmea && frame[8] == 0) ++nmeaDisabled;
+    }
+    QCOMPARE(nmeaDisabled, 6);
+    QVERIFY(frames.contains(UbxProtocol::cfgMsg(UbxProtocol::ClassNav, UbxProtocol::IdNavPvt, 1)));
+    QVERIFY(frames.contains(UbxProtocol::cfgMsg(UbxProtocol::ClassNav, UbxProtocol::IdNavDop, 5)));
+}
+
+void UbxProtocolTest::feed_navPvtFrame_decodesAllFields()
+{
+    // Objectif: décoder une trame NAV-PVT complète en unités SI.
+    // Pourquoi: l'échelle des champs (1e-7 °, mm, mm/s, 1e-5 °) est la principale source d'erreur ;
+    //           une route ou une vitesse mal échelonnée fausse directement le guidage.
+    // Procédure détaillée:
+    //   1) Encadrer la charge utile de référence (100 octets au total, contre ≈ 150 pour RMC + GGA).
+    //   2) La décoder via UbxParser et comparer chaque champ.
+    //   3) Une charge utile tronquée est refusée ; gnssFixOK absent rend la position invalide.
+    const QByteArray frame = UbxProtocol::frame(UbxProtocol::ClassNav, UbxProtocol::IdNavPvt, navPvtPayload());
+    QCOMPARE(frame.size(), 100);
+
+    UbxNavPvt pvt;
+    bool decoded = false;
+    UbxParser parser;
+    parser.feed(frame.constData(), std::size_t(frame.size()),
+                [&](quint8 msgClass, quint8 msgId, const quint8* payload, std::size_t length) {
+                    QCOMPARE(msgClass, UbxProtocol::ClassNav);
+                    QCOMPARE(msgId, UbxProtocol::IdNavPvt);
+                    decoded = UbxProtocol::decodeNavPvt(payload, length, pvt);
+                });
+    QVERIFY(decoded);
+
+    QCOMPARE(pvt.iTowMs, quint32(392100000));
+    QCOMPARE(pvt.year, 2024);
+    QCOMPARE(pvt.month, 3);
+    QCOMPARE(pvt.day, 23);
+    QCOMPARE(pvt.hour, 12);
+    QCOMPARE(pvt.second, 19);
+    QVERIFY(pvt.dateValid && pvt.timeValid);
+    QCOMPARE(pvt.fixType, 3);
+    QVERIFY(pvt.positionValid());
+    QCOMPARE(pvt.satellites, 14);
+    QVERIFY(std::abs(pvt.lat - 48.1173) < 1e-9);
+    QVERIFY(std::abs(pvt.lon - 11.5166667) < 1e-9);
+    QVERIFY(std::abs(pvt.altitudeMslM - 545.4) < 1e-9);
+    QVERIFY(std::abs(pvt.horizontalAccuracyM - 1.8) < 1e-9);
+    QVERIFY(std::abs(pvt.velDownMs + 0.12) < 1e-9);
+    QVERIFY(std::abs(pvt.groundSpeedMs - 15.0) < 1e-9);
+    QVERIFY(std::abs(pvt.headingMotionDeg - 84.4) < 1e-9);
+    QVERIFY(std::abs(pvt.headingAccuracyDeg - 1.2) < 1e-9);
+    QVERIFY(std::abs(pvt.pdop - 1.61) < 1e-9);
+
+    const QByteArray payload = navPvtPayload();
+    QVERIFY(!UbxProtocol::decodeNavPvt(reinterpret_cast<const quint8*>(payload.constData()), 84, pvt));
+
+    QByteArray noFixOk = payload;
+    noFixOk[21] = 0;
+    QVERIFY(UbxProtocol::decodeNavPvt(reinterpret_cast<const quint8*>(noFixOk.constData()), 92, pvt));
+    QVERIFY(!pvt.positionValid());
+}
+
+void UbxProtocolTest::feed_splitFramesAmongNmeaAndCorruption_areRecovered()
+{
+    // Objectif: vérifier la resynchronisation du décodeur sur un flux réaliste.
+    // Pourquoi: pendant la reconfiguration, NMEA et UBX se mélangent sur le port, les lectures
+    //           coupent les trames n'importe où et la liaison UART peut corrompre des octets.
+    // Procédure détaillée:
+    //   1) Flux : NMEA, NAV-PVT, NAV-PVT corrompue, faux motif de synchronisation, NAV-PVT.
+    //   2) L'injecter octet par octet : deux trames intègres, une erreur de somme comptée.
+    //   3) Une trame annoncée plus grande que MaxPayload est sautée sans désynchroniser la suivante.
+    const QByteArray pvt = UbxProtocol::frame(UbxProtocol::ClassNav, UbxProtocol::IdNavPvt, navPvtPayload());
+    QByteArray corrupted = pvt;
+    corrupted[40] = char(corrupted[40] ^ 0x10);
+
+    const QByteArray stream = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W*61\r\n"
+                            + pvt + corrupted + QByteArray("\xB5\xB5") + pvt;
+
+    UbxParser parser;
+    int frames = 0;
+    auto count = [&](quint8, quint8, const quint8*, std::size_t) { ++frames; };
+    for (char byte : stream) parser.feed(&byte, 1, count);
+    QCOMPARE(frames, 2);
+    QCOMPARE(parser.stats().frames, quint64(2));
+    QCOMPARE(parser.stats().checksumErrors, quint64(1));
+
+    const QByteArray oversized = UbxProtocol::frame(0x01, 0x35, QByteArray(int(UbxParser::MaxPayload) + 8, '\x5A'));
+    const QByteArray next = oversized + pvt;
+    parser.feed(next.constData(), std::size_t(next.size()), count);
+    QCOMPARE(frames, 3);
+    QCOMPARE(parser.stats().oversized, quint64(1));
+}
+
+QTEST_GUILESS_MAIN(UbxProtocolTest)
+#include "tst_ubxprotocol.moc"
@@ -0,0 +1,12 @@
+QT += testlib core
+CONFIG += c++17 testcase
+TEMPLATE = app
+
+TARGET = ubxprotocol_test
+
+SOURCES += \
+    tst_ubxprotocol.cpp \
+    ../../ubxprotocol.cpp
+
+HEADERS += \
+    ../../ubxprotocol.h
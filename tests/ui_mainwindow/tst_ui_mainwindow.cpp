@@ -1,6 +1,7 @@
 #include <QtTest>
 #include <QPushButton>
 #include <QUdpSocket>
+#include <QQmlEngine>
 
 #define private public
 #include "../../mainwindow.h"
@@ -8,6 +9,7 @@
 #include "../../telemetrydata.h"
 #include "../../navigationpage.h"
 #include "../../mediapage.h"
+#include "../../routepolylineitem.h"
 #include "../../settingspage.h"
 #include "../../homeassistant.h"
 #undef private
@@ -19,6 +21,7 @@ class MainWindowUiTest : public QObject
     Q_OBJECT
 
 private slots:
+    void initTestCase();
     void startup_appliesSplitMode_andShowsNavAndMedia();
     void navButtons_switchVisiblePages();
     void splitButton_togglesIconBetweenSplitAndFullscreen();
@@ -29,6 +32,12 @@ private slots:
     void realisticSequence_splitCameraSettingsSplit_isCoherent();
 };
 
+void MainWindowUiTest::initTestCase()
+{
+    // Enregistré par main() dans l'application : map.qml importe le module InterfaceGPS.
+    qmlRegisterType<RoutePolylineItem>("InterfaceGPS", 1, 0, "RoutePolyline");
+}
+
 void MainWindowUiTest::startup_appliesSplitMode_andShowsNavAndMedia()
 {
     // Objectif: valider l'état initial global de la fenêtre principale.
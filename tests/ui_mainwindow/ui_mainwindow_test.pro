@@ -14,7 +14,20 @@ SOURCES += \
     ../../homeassistant.cpp \
     ../../clavier.cpp \
     ../../bluetoothmanager.cpp \
-    ../../telemetrydata.cpp
+    ../../telemetrydata.cpp \
+    ../../telemetryframepacer.cpp \
+    ../../routemodel.cpp \
+    ../../segmentgrid.cpp \
+    ../../routematcher.cpp \
+    ../../routestrip.cpp \
+    ../../routepolylineitem.cpp \
+    ../../polylinesimplifier.cpp \
+    ../../roadgraph.cpp \
+    ../../offlinerouter.cpp \
+    ../../offlinegeocoder.cpp \
+    ../../mapboxclient.cpp \
+    ../../tilecache.cpp \
+    ../../tileprefetcher.cpp
 
 HEADERS += \
     ../../mainwindow.h \
@@ -25,7 +38,21 @@ HEADERS += \
     ../../homeassistant.h \
     ../../clavier.h \
     ../../bluetoothmanager.h \
-    ../../telemetrydata.h
+    ../../telemetrydata.h \
+    ../../telemetryframepacer.h \
+    ../../telemetryring.h \
+    ../../routemodel.h \
+    ../../segmentgrid.h \
+    ../../routematcher.h \
+    ../../routestrip.h \
+    ../../routepolylineitem.h \
+    ../../polylinesimplifier.h \
+    ../../roadgraph.h \
+    ../../offlinerouter.h \
+    ../../offlinegeocoder.h \
+    ../../mapboxclient.h \
+    ../../tilecache.h \
+    ../../tileprefetcher.h
 
 FORMS += \
     ../../mainwindow.ui \
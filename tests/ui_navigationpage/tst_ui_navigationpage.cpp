@@ -4,10 +4,16 @@
 #include <QStringListModel>
 #include <QCompleter>
 #include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QQmlEngine>
 
 #define private public
 #include "../../navigationpage.h"
+#include "../../offlinerouter.h"
+#include "../../routepolylineitem.h"
+#include "../../roadgraphbuilder.h"
 #include "../../telemetrydata.h"
+#include "../../telemetryframepacer.h"
 #undef private
 
 class NavigationPageUiTest : public QObject
@@ -15,15 +21,24 @@ class NavigationPageUiTest : public QObject
     Q_OBJECT
 
 private slots:
+    void initTestCase();
     void constructor_wiresMainWidgetsAndDefaults();
     void onSuggestionsReceived_updatesCompleterModel();
+    void offlineSuggestions_listedFirstThenMergedWithOnline();
     void onSuggestionChosen_updatesSearchField();
     void triggerSuggestionsSearch_shortQuery_doesNothingAndKeepsState();
     void requestRouteForText_emptyInput_emitsNothing();
     void requestRouteForText_trimmedInput_emitsTrimmedDestination();
     void bindTelemetry_emitsRefreshOnBindAndTelemetryChanges();
+    void framePacer_coalescesUpdatesUntilFrameRendered();
 };
 
+void NavigationPageUiTest::initTestCase()
+{
+    // Enregistré par main() dans l'application : map.qml importe le module InterfaceGPS.
+    qmlRegisterType<RoutePolylineItem>("InterfaceGPS", 1, 0, "RoutePolyline");
+}
+
 void NavigationPageUiTest::constructor_wiresMainWidgetsAndDefaults()
 {
     // Objectif: valider le montage initial de l'écran de navigation.
@@ -64,6 +79,58 @@ void NavigationPageUiTest::onSuggestionsReceived_updatesCompleterModel()
     QCOMPARE(model->stringList(), QStringList({"Paris", "Lyon"}));
 }
 
+void NavigationPageUiTest::offlineSuggestions_listedFirstThenMergedWithOnline()
+{
+    // Objectif: valider l'autocomplétion locale et sa fusion avec les suggestions réseau.
+    // Pourquoi: l'index embarqué répond à chaque lettre, même sans couverture réseau ; les
+    //           suggestions Mapbox, plus lentes, ne doivent ni l'écraser ni le dupliquer.
+    // Procédure détaillée:
+    //   1) Charger un petit graphe portant deux lieux nommés, véhicule positionné à côté.
+    //   2) Saisir « jean jau » : suggestion locale immédiate, avec sa distance.
+    //   3) Recevoir les suggestions réseau de cette saisie : ajoutées après la suggestion locale.
+    //   4) Lettre suivante : les suggestions réseau de « jean jau » ne sont plus affichées.
+    //   5) Choisir la suggestion locale : itinéraire demandé pour ce libellé.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("places.graph"));
+    RoadGraphBuilder builder;
+    builder.addNode(45.0, 5.0);
+    builder.addNode(45.001, 5.0);
+    builder.addEdge(0, 1, 10.0);
+    builder.addEdge(1, 0, 10.0);
+    builder.addPlace(QByteArray("Avenue Jean Jaurès"), 45.01, 5.0, RoadGraph::PlaceKind::Street);
+    builder.addPlace(QByteArray("Rue Jean Moulin"), 45.02, 5.0, RoadGraph::PlaceKind::Street);
+    QVERIFY(builder.write(path));
+
+    NavigationPage page;
+    QVERIFY(page.m_offlineRouter->load(path));
+    TelemetryData data;
+    data.setLat(45.0);
+    data.setLon(5.0);
+    page.bindTelemetry(&data);
+    auto* editSearch = page.findChild<QLineEdit*>("editSearch");
+    QVERIFY(editSearch != nullptr);
+    auto* model = qobject_cast<QStringListModel*>(page.m_searchCompleter->model());
+    QVERIFY(model != nullptr);
+
+    editSearch->setText(QStringLiteral("jean jau"));
+    page.updateOfflineSuggestions();
+    QCOMPARE(model->stringList(), QStringList({QStringLiteral("Avenue Jean Jaurès (1,1 km)")}));
+
+    page.triggerSuggestionsSearch();
+    page.onSuggestionsReceived(QStringLiteral("[\"Avenue Jean Jaurès (1,1 km)\",\"Avenue Jean Jaurès, Lyon\"]"));
+    QCOMPARE(model->stringList(), QStringList({QStringLiteral("Avenue Jean Jaurès (1,1 km)"),
+                                               QStringLiteral("Avenue Jean Jaurès, Lyon")}));
+
+    editSearch->setText(QStringLiteral("jean jaur"));
+    page.updateOfflineSuggestions();
+    QCOMPARE(model->stringList(), QStringList({QStringLiteral("Avenue Jean Jaurès (1,1 km)")}));
+
+    QSignalSpy routeSpy(&page, &NavigationPage::routeSearchRequested);
+    page.requestRouteForText(QStringLiteral("Avenue Jean Jaurès (1,1 km)"));
+    QCOMPARE(routeSpy.count(), 1);
+}
+
 void NavigationPageUiTest::onSuggestionChosen_updatesSearchField()
 {
     // Objectif: valider le report d'une suggestion choisie vers le champ de recherche.
@@ -171,5 +238,47 @@ void NavigationPageUiTest::bindTelemetry_emitsRefreshOnBindAndTelemetryChanges()
     QCOMPARE(lastArgs.at(3).toDouble(), 55.5);
 }
 
+void NavigationPageUiTest::framePacer_coalescesUpdatesUntilFrameRendered()
+{
+    // Objectif: valider la livraison "au plus une fois par image" du cadenceur de télémétrie.
+    // Pourquoi: l'IMU et le GPS produisent plus vite que la carte ne peut se redessiner.
+    // Procédure détaillée:
+    //   1) Soumettre un premier instantané: livraison immédiate (aucune image en cours).
+    //   2) Soumettre deux instantanés avant la fin de l'image: aucune livraison.
+    //   3) Simuler la fin de l'image: une seule livraison avec la dernière valeur et l'union des champs.
+    TelemetryFramePacer pacer;
+    pacer.setWatchdogInterval(60000); // Le test pilote lui-même la fin des images
+    QSignalSpy frameSpy(&pacer, &TelemetryFramePacer::frameReady);
+
+    TelemetrySnapshot s;
+    s.lat = 45.0;
+    pacer.submit(s, TelemetryData::LatField);
+    QCOMPARE(frameSpy.count(), 1);
+
+    s.heading = 10.0;
+    pacer.submit(s, TelemetryData::HeadingField);
+    s.heading = 20.0;
+    pacer.submit(s, TelemetryData::HeadingField);
+    s.lon = 3.0;
+    pacer.submit(s, TelemetryData::LonField);
+    QCOMPARE(frameSpy.count(), 1);
+
+    pacer.onFrameRendered();
+    QCOMPARE(frameSpy.count(), 2);
+
+    const auto delivered = frameSpy.last().at(0).value<TelemetrySnapshot>();
+    const auto dirty = frameSpy.last().at(1).value<TelemetryData::Fields>();
+    QCOMPARE(delivered.heading, 20.0);
+    QCOMPARE(delivered.lon, 3.0);
+    QCOMPARE(dirty, TelemetryData::Fields(TelemetryData::HeadingField | TelemetryData::LonField));
+    QCOMPARE(pacer.submittedCount(), quint64(4));
+    QCOMPARE(pacer.deliveredCount(), quint64(2));
+    QCOMPARE(pacer.droppedCount(), quint64(2));
+
+    // Image rendue sans rien en attente: aucune livraison fantôme
+    pacer.onFrameRendered();
+    QCOMPARE(frameSpy.count(), 2);
+}
+
 QTEST_MAIN(NavigationPageUiTest)
 #include "tst_ui_navigationpage.moc"
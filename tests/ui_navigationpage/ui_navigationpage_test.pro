@@ -8,12 +8,41 @@ SOURCES += \
     tst_ui_navigationpage.cpp \
     ../../navigationpage.cpp \
     ../../clavier.cpp \
-    ../../telemetrydata.cpp
+    ../../telemetrydata.cpp \
+    ../../telemetryframepacer.cpp \
+    ../../routemodel.cpp \
+    ../../segmentgrid.cpp \
+    ../../routematcher.cpp \
+    ../../routestrip.cpp \
+    ../../routepolylineitem.cpp \
+    ../../polylinesimplifier.cpp \
+    ../../roadgraph.cpp \
+    ../../offlinerouter.cpp \
+    ../../offlinegeocoder.cpp \
+    ../../roadgraphbuilder.cpp \
+    ../../mapboxclient.cpp \
+    ../../tilecache.cpp \
+    ../../tileprefetcher.cpp
 
 HEADERS += \
     ../../navigationpage.h \
     ../../clavier.h \
-    ../../telemetrydata.h
+    ../../telemetrydata.h \
+    ../../telemetryframepacer.h \
+    ../../telemetryring.h \
+    ../../routemodel.h \
+    ../../segmentgrid.h \
+    ../../routematcher.h \
+    ../../routestrip.h \
+    ../../routepolylineitem.h \
+    ../../polylinesimplifier.h \
+    ../../roadgraph.h \
+    ../../offlinerouter.h \
+    ../../offlinegeocoder.h \
+    ../../roadgraphbuilder.h \
+    ../../mapboxclient.h \
+    ../../tilecache.h \
+    ../../tileprefetcher.h
 
 FORMS += \
     ../../navigationpage.ui
@@ -0,0 +1,286 @@
+/**
+ * @file tilecache.cpp
+ * @brief Implémentation du cache disque des tuiles et de son adresse locale pour la carte.
+ */
+
+#include "tilecache.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+constexpr int MaxZoom = 28; // Limite de TileId::key()
+
+bool isValidTile(const TileId& tile)
+{
+    if (tile.zoom < 0 || tile.zoom > MaxZoom) return false;
+    const qint64 count = qint64(1) << tile.zoom;
+    return tile.x >= 0 && tile.x < count && tile.y >= 0 && tile.y < count;
+}
+
+TileId tileFromKey(quint64 key)
+{
+    constexpr quint64 Mask = (quint64(1) << 28) - 1;
+    return TileId{int(key >> 56), int((key >> 28) & Mask), int(key & Mask)};
+}
+
+// Chemin d'une requête de la carte : "/<z>/<x>/<y>.png" (paramètres et extension ignorés).
+bool parseTilePath(const QByteArray& path, TileId& tile)
+{
+    const QList<QByteArray> parts = path.left(path.indexOf('?')).split('/');
+    if (parts.size() != 4 || !parts.at(0).isEmpty()) return false;
+    const QByteArray y = parts.at(3).left(parts.at(3).indexOf('.'));
+    bool okZoom = false, okX = false, okY = false;
+    tile = TileId{parts.at(1).toInt(&okZoom), parts.at(2).toInt(&okX), y.toInt(&okY)};
+    return okZoom && okX && okY && isValidTile(tile);
+}
+}
+
+TileCache::TileCache(QObject* parent)
+    : QObject(parent)
+    , m_network(new QNetworkAccessManager(this))
+    , m_upstream(QStringLiteral("https://a.basemaps.cartocdn.com/dark_all/%z/%x/%y.png"))
+{
+}
+
+TileCache::~TileCache()
+{
+    // Les téléchargements encore en cours sont détruits avec m_network : plus rien ne doit nous être signalé.
+    for (QNetworkReply* reply : std::as_const(m_downloads)) reply->disconnect(this);
+    m_downloads.clear();
+}
+
+void TileCache::setUpstream(const QString& urlTemplate)
+{
+    m_upstream = urlTemplate;
+    if (!m_server || !m_server->isListening()) emit urlTemplateChanged();
+}
+
+void TileCache::open(const QString& path, qint64 byteBudget)
+{
+    m_entries.clear();
+    m_byUse.clear();
+    m_totalBytes = 0;
+    m_dir = path;
+    m_byteBudget = std::max<qint64>(byteBudget, 0);
+    if (m_dir.isEmpty()) return;
+
+    // Du plus ancien au plus récent : la date de modification est rafraîchie à chaque lecture (voir read()).
+    const QFileInfoList files = QDir(m_dir).entryInfoList({QStringLiteral("*.png")}, QDir::Files,
+                                                          QDir::Time | QDir::Reversed);
+    for (const QFileInfo& info : files) {
+        const QStringList parts = info.completeBaseName().split(QLatin1Char('-'));
+        bool okZoom = false, okX = false, okY = false;
+        const TileId tile{parts.value(0).toInt(&okZoom), parts.value(1).toInt(&okX), parts.value(2).toInt(&okY)};
+        if (parts.size() != 3 || !okZoom || !okX || !okY || !isValidTile(tile)) continue;
+        Entry entry;
+        entry.bytes = info.size();
+        entry.rank = m_nextRank++;
+        m_byUse.emplace(entry.rank, tile.key());
+        m_entries.insert(tile.key(), entry);
+        m_totalBytes += entry.bytes;
+    }
+    trim();
+}
+
+QByteArray TileCache::read(const TileId& tile)
+{
+    const quint64 key = tile.key();
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) return QByteArray();
+
+    QFile file(filePath(tile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        remove(key); // Supprimée hors de l'application
+        return QByteArray();
+    }
+    const QByteArray data = file.readAll();
+    // L'ordre d'utilisation survit ainsi au redémarrage (voir open())
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    touch(key, *it);
+    return data;
+}
+
+bool TileCache::insert(const TileId& tile, const QByteArray& data)
+{
+    if (m_dir.isEmpty() || data.isEmpty() || !isValidTile(tile) || !QDir().mkpath(m_dir)) return false;
+
+    // Écriture atomique : une coupure d'alimentation ne laisse pas de tuile tronquée.
+    QSaveFile file(filePath(tile));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) return false;
+
+    const quint64 key = tile.key();
+    const auto existing = m_entries.find(key);
+    if (existing != m_entries.end()) { // Remplacée : le fichier vient d'être réécrit
+        m_byUse.erase(existing->rank);
+        m_totalBytes -= existing->bytes;
+        m_entries.erase(existing);
+    }
+    Entry entry;
+    entry.bytes = data.size();
+    entry.rank = m_nextRank++;
+    m_byUse.emplace(entry.rank, key);
+    m_entries.insert(key, entry);
+    m_totalBytes += entry.bytes;
+    trim();
+    return contains(tile); // Une tuile plus grande que le budget est aussitôt supprimée
+}
+
+void TileCache::fetch(const TileId& tile, QNetworkRequest::Priority priority)
+{
+    const quint64 key = tile.key();
+    if (QNetworkReply* pending = m_downloads.value(key)) {
+        // QNetworkRequest::Priority : valeur plus petite = plus prioritaire.
+        if (priority >= pending->request().priority()) {
+            ++m_stats.coalesced;
+            return;
+        }
+        // Tuile demandée par la carte pendant son préchargement : elle ne doit pas attendre derrière
+        // les autres téléchargements en basse priorité. tileFetched() sera émis par la nouvelle requête.
+        pending->disconnect(this);
+        pending->abort();
+        pending->deleteLater();
+        m_downloads.remove(key);
+        ++m_stats.reprioritized;
+    }
+
+    QString url = m_upstream;
+    url.replace(QStringLiteral("%z"), QString::number(tile.zoom))
+        .replace(QStringLiteral("%x"), QString::number(tile.x))
+        .replace(QStringLiteral("%y"), QString::number(tile.y));
+    QNetworkRequest request{QUrl(url)};
+    request.setPriority(priority);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("GPSInterface/1.0"));
+
+    QNetworkReply* reply = m_network->get(request);
+    ++m_stats.downloads;
+    m_downloads.insert(key, reply);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, tile]() { onDownloaded(reply, tile); });
+}
+
+bool TileCache::listen()
+{
+    if (!m_server) {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                    m_requests.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+    }
+    if (m_server->isListening()) return true;
+    if (!m_server->listen(QHostAddress::LocalHost)) return false;
+    emit urlTemplateChanged();
+    return true;
+}
+
+QString TileCache::urlTemplate() const
+{
+    if (!m_server || !m_server->isListening()) return m_upstream;
+    return QStringLiteral("http://127.0.0.1:") + QString::number(m_server->serverPort())
+        + QStringLiteral("/%z/%x/%y.png");
+}
+
+QString TileCache::filePath(const TileId& tile) const
+{
+    return m_dir + QLatin1Char('/') + QString::number(tile.zoom) + QLatin1Char('-') + QString::number(tile.x)
+        + QLatin1Char('-') + QString::number(tile.y) + QStringLiteral(".png");
+}
+
+void TileCache::touch(quint64 key, Entry& entry)
+{
+    m_byUse.erase(entry.rank);
+    entry.rank = m_nextRank++;
+    m_byUse.emplace(entry.rank, key);
+}
+
+void TileCache::remove(quint64 key)
+{
+    const Entry entry = m_entries.take(key);
+    m_byUse.erase(entry.rank);
+    m_totalBytes -= entry.bytes;
+    QFile::remove(filePath(tileFromKey(key)));
+}
+
+void TileCache::trim()
+{
+    while (m_totalBytes > m_byteBudget && !m_byUse.empty()) {
+        remove(m_byUse.begin()->second);
+        ++m_stats.evictions;
+    }
+}
+
+void TileCache::onDownloaded(QNetworkReply* reply, const TileId& tile)
+{
+    reply->deleteLater();
+    const quint64 key = tile.key();
+    m_downloads.remove(key);
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray data = reply->error() == QNetworkReply::NoError && status == 200 ? reply->readAll() : QByteArray();
+    const bool stored = insert(tile, data);
+    if (!stored) ++m_stats.downloadFailures;
+
+    // Une tuile reçue mais non enregistrée (disque plein) est tout de même servie à la carte.
+    const QList<QPointer<QTcpSocket>> waiting = m_waiting.take(key);
+    for (const QPointer<QTcpSocket>& socket : waiting) {
+        if (socket) respond(socket, data.isEmpty() ? 502 : 200, data);
+    }
+    emit tileFetched(key, stored);
+}
+
+void TileCache::onReadyRead(QTcpSocket* socket)
+{
+    QByteArray& request = m_requests[socket];
+    request += socket->readAll();
+    if (!request.contains("\r\n\r\n")) {
+        if (request.size() > MaxRequestBytes) {
+            m_requests.remove(socket);
+            socket->abort();
+        }
+        return;
+    }
+
+    // Ligne de requête : "GET /<z>/<x>/<y>.png HTTP/1.1" ; une seule requête par connexion (Connection: close).
+    const QList<QByteArray> line = request.left(request.indexOf("\r\n")).split(' ');
+    m_requests.remove(socket);
+    TileId tile;
+    if (line.size() < 2 || line.at(0) != "GET" || !parseTilePath(line.at(1), tile)) {
+        respond(socket, 404);
+        return;
+    }
+
+    const QByteArray data = read(tile);
+    if (!data.isEmpty()) {
+        ++m_stats.servedFromDisk;
+        respond(socket, 200, data);
+        return;
+    }
+    m_waiting[tile.key()].append(socket);
+    fetch(tile, QNetworkRequest::NormalPriority);
+}
+
+void TileCache::respond(QTcpSocket* socket, int status, const QByteArray& data)
+{
+    QByteArray reason = "OK";
+    if (status == 404) reason = "Not Found";
+    else if (status == 502) reason = "Bad Gateway";
+    if (status == 200) ++m_stats.served;
+
+    socket->write("HTTP/1.1 " + QByteArray::number(status) + ' ' + reason
+                  + "\r\nContent-Type: image/png\r\nContent-Length: " + QByteArray::number(data.size())
+                  + "\r\nConnection: close\r\n\r\n" + data);
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,165 @@
+/**
+ * @file tilecache.h
+ * @brief Rôle architectural : Cache disque des tuiles de la carte, servi à map.qml par une adresse locale.
+ * @details Responsabilités : Garder les tuiles téléchargées dans un répertoire borné en octets (les moins
+ * récemment utilisées sont supprimées les premières), les télécharger depuis le serveur de tuiles en
+ * fusionnant les demandes identiques, et répondre aux requêtes du plugin QtLocation sur 127.0.0.1.
+ * Dépendances principales : Qt Network.
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <map>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @struct TileId
+ * @brief Tuile Web Mercator (schéma XYZ, origine en haut à gauche).
+ */
+struct TileId {
+    int zoom = 0;
+    int x = 0;
+    int y = 0;
+
+    quint64 key() const { return (quint64(zoom) << 56) | (quint64(x) << 28) | quint64(y); } ///< Clé unique (zoom <= 28).
+    bool operator==(const TileId& other) const { return zoom == other.zoom && x == other.x && y == other.y; }
+};
+
+/**
+ * @class TileCache
+ * @brief Tuiles de la carte (propriété de contexte `tileCache`).
+ * @details Le plugin QtLocation n'indexe son propre cache disque qu'au démarrage : une tuile déposée
+ * pendant le trajet n'y serait jamais relue. La carte charge donc ses tuiles par urlTemplate(), une
+ * adresse locale servie ici : une tuile présente est lue sur disque, une tuile absente est téléchargée
+ * (priorité normale), enregistrée puis servie. TilePrefetcher remplit le même cache à l'avance.
+ * Sans écoute locale, urlTemplate() renvoie directement l'adresse du serveur de tuiles.
+ */
+class TileCache : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString urlTemplate READ urlTemplate NOTIFY urlTemplateChanged)
+
+public:
+    static constexpr qint64 DefaultByteBudget = 256LL * 1024 * 1024; ///< Taille disque par défaut (TILE_CACHE_MB).
+    static constexpr int MaxRequestBytes = 8 * 1024;                 ///< En-têtes HTTP acceptés d'un client local.
+
+    /**
+     * @struct Stats
+     * @brief Compteurs depuis la création.
+     */
+    struct Stats {
+        quint64 served = 0;           ///< Tuiles servies à la carte.
+        quint64 servedFromDisk = 0;   ///< Dont tuiles déjà présentes sur disque.
+        quint64 downloads = 0;        ///< Requêtes envoyées au serveur de tuiles.
+        quint64 downloadFailures = 0; ///< Dont échecs (réseau, HTTP, écriture).
+        quint64 coalesced = 0;        ///< Demandes rattachées à un téléchargement déjà en cours.
+        quint64 reprioritized = 0;    ///< Téléchargements relancés à une priorité plus haute (carte après préchargement).
+        quint64 evictions = 0;        ///< Tuiles supprimées pour tenir le budget.
+    };
+
+    explicit TileCache(QObject* parent = nullptr);
+    ~TileCache() override;
+
+    /**
+     * @brief Adresse du serveur de tuiles, avec `%z`, `%x` et `%y` (CARTO dark_all par défaut).
+     */
+    void setUpstream(const QString& urlTemplate);
+
+    /**
+     * @brief Répertoire du cache, créé à la première écriture, et taille maximale en octets.
+     * @details Indexe les tuiles déjà présentes, de la moins à la plus récemment utilisée (date de
+     * modification), puis les ramène sous @p byteBudget. Vide : aucune tuile n'est gardée.
+     */
+    void open(const QString& path, qint64 byteBudget = DefaultByteBudget);
+
+    QString directory() const { return m_dir; }          ///< Répertoire du cache (vide : fermé).
+    qint64 byteBudget() const { return m_byteBudget; }   ///< Taille disque maximale (octets).
+    qint64 totalBytes() const { return m_totalBytes; }   ///< Taille des tuiles présentes (octets).
+    int tileCount() const { return int(m_entries.size()); } ///< Nombre de tuiles présentes.
+    const Stats& stats() const { return m_stats; }       ///< Compteurs depuis la création.
+
+    bool contains(const TileId& tile) const { return m_entries.contains(tile.key()); } ///< true si la tuile est sur disque.
+
+    /**
+     * @brief Contenu de @p tile, marquée comme la plus récemment utilisée ; vide si absente ou illisible.
+     */
+    QByteArray read(const TileId& tile);
+
+    /**
+     * @brief Enregistre @p tile puis supprime les tuiles les moins récemment utilisées au-delà du budget.
+     * @return false si le cache est fermé ou l'écriture échoue.
+     */
+    bool insert(const TileId& tile, const QByteArray& data);
+
+    /**
+     * @brief Télécharge @p tile avec la priorité réseau @p priority et l'enregistre ; tileFetched() signale
+     * la fin. Une tuile déjà en cours de téléchargement n'est pas redemandée, sauf à une priorité plus
+     * haute : la priorité d'une requête partie ne peut plus changer, elle est annulée puis relancée.
+     */
+    void fetch(const TileId& tile, QNetworkRequest::Priority priority);
+
+    /**
+     * @brief Accepte les requêtes `GET /<z>/<x>/<y>.png` de la carte sur 127.0.0.1 (port libre).
+     * @return false si aucun port n'a pu être ouvert : la carte télécharge alors elle-même ses tuiles.
+     */
+    bool listen();
+
+    /**
+     * @brief Adresse des tuiles pour le plugin QtLocation (`osm.mapping.custom.host`) : l'adresse locale
+     * après listen(), sinon celle du serveur de tuiles.
+     */
+    QString urlTemplate() const;
+
+signals:
+    void urlTemplateChanged();
+
+    /**
+     * @brief Fin du téléchargement de la tuile de clé @p key (TileId::key()) ; @p ok : tuile enregistrée.
+     */
+    void tileFetched(quint64 key, bool ok);
+
+private:
+    /**
+     * @struct Entry
+     * @brief Tuile présente sur disque.
+     */
+    struct Entry {
+        qint64 bytes = 0;
+        quint64 rank = 0; ///< Rang d'utilisation, croissant (clé de m_byUse).
+    };
+
+    QString filePath(const TileId& tile) const;
+    void touch(quint64 key, Entry& entry);
+    void remove(quint64 key);
+    void trim();
+    void onDownloaded(QNetworkReply* reply, const TileId& tile);
+    void onReadyRead(QTcpSocket* socket);
+    void respond(QTcpSocket* socket, int status, const QByteArray& data = QByteArray());
+
+    QNetworkAccessManager* m_network;
+    QTcpServer* m_server = nullptr;
+    QString m_upstream;
+    QString m_dir;
+    qint64 m_byteBudget = DefaultByteBudget;
+    qint64 m_totalBytes = 0;
+    QHash<quint64, Entry> m_entries;             ///< Tuiles sur disque par clé.
+    std::map<quint64, quint64> m_byUse;          ///< Rang d'utilisation -> clé, du moins au plus récent.
+    quint64 m_nextRank = 0;
+    QHash<quint64, QNetworkReply*> m_downloads;  ///< Téléchargements en cours par clé.
+    QHash<quint64, QList<QPointer<QTcpSocket>>> m_waiting; ///< Requêtes de la carte en attente d'une tuile.
+    QHash<QTcpSocket*, QByteArray> m_requests;   ///< En-têtes reçus, pas encore complets.
+    Stats m_stats;
+};
+
+#endif // TILECACHE_H
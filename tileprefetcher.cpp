@@ -0,0 +1,126 @@
+/**
+ * @file tileprefetcher.cpp
+ * @brief Implémentation du préchargement des tuiles le long de l'itinéraire.
+ */
+
+#include "tileprefetcher.h"
+#include "routemodel.h"
+#include <QPointF>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int MaxMapZoom = 18; // Zoom le plus proche du zoom automatique
+
+// Position en pixels dans le monde Web Mercator au zoom @p zoom (origine en haut à gauche).
+QPointF worldPixel(const QGeoCoordinate& coordinate, int zoom)
+{
+    const double worldSize = TilePrefetcher::TileSize * double(1 << zoom);
+    const double phi = std::clamp(coordinate.latitude(), -85.05112878, 85.05112878) * M_PI / 180.0;
+    return QPointF((coordinate.longitude() + 180.0) / 360.0 * worldSize,
+                   (0.5 - std::log(std::tan(M_PI / 4.0 + phi / 2.0)) / (2.0 * M_PI)) * worldSize);
+}
+}
+
+TilePrefetcher::TilePrefetcher(RouteModel* route, TileCache* cache, QObject* parent)
+    : QObject(parent)
+    , m_route(route)
+    , m_cache(cache)
+{
+    connect(m_route, &RouteModel::routeChanged, this, &TilePrefetcher::onRouteChanged);
+    connect(m_cache, &TileCache::tileFetched, this, &TilePrefetcher::onTileFetched);
+}
+
+int TilePrefetcher::speedZoom(double speedKmh)
+{
+    if (speedKmh > 100) return 15;
+    if (speedKmh > 70) return 16;
+    if (speedKmh > 40) return 17;
+    return 18;
+}
+
+QList<TileId> TilePrefetcher::corridorTiles(const QList<QGeoCoordinate>& points, const QList<int>& speedLimitsKmh,
+                                            int maxTiles)
+{
+    QList<TileId> tiles;
+    QSet<quint64> seen;
+    for (int i = 0; i + 1 < points.size(); ++i) {
+        const int limit = speedLimitsKmh.value(i, -1);
+        const int baseZoom = limit > 0 ? speedZoom(limit) : UnknownLimitZoom;
+        for (int zoom = baseZoom; zoom <= std::min(baseZoom + 1, MaxMapZoom); ++zoom) {
+            // Échantillons tous les demi-côtés de tuile : les carrés de rayon CorridorRadiusPx se recouvrent.
+            const QPointF from = worldPixel(points.at(i), zoom);
+            const QPointF to = worldPixel(points.at(i + 1), zoom);
+            const QPointF delta = to - from;
+            const int steps = std::max(1, int(std::ceil(std::hypot(delta.x(), delta.y()) / (TileSize / 2.0))));
+            const int last = (1 << zoom) - 1;
+            for (int step = 0; step <= steps; ++step) {
+                const QPointF p = from + delta * (double(step) / steps);
+                const int x0 = std::clamp(int(std::floor((p.x() - CorridorRadiusPx) / TileSize)), 0, last);
+                const int x1 = std::clamp(int(std::floor((p.x() + CorridorRadiusPx) / TileSize)), 0, last);
+                const int y0 = std::clamp(int(std::floor((p.y() - CorridorRadiusPx) / TileSize)), 0, last);
+                const int y1 = std::clamp(int(std::floor((p.y() + CorridorRadiusPx) / TileSize)), 0, last);
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        const TileId tile{zoom, x, y};
+                        if (seen.contains(tile.key())) continue;
+                        seen.insert(tile.key());
+                        tiles.append(tile);
+                        if (tiles.size() >= maxTiles) return tiles;
+                    }
+                }
+            }
+        }
+    }
+    return tiles;
+}
+
+void TilePrefetcher::onRouteChanged()
+{
+    // Les téléchargements en cours se terminent (ils remplissent le cache) ; la file est remplacée.
+    m_queue.clear();
+    m_next = 0;
+    m_running = m_route->hasRoute();
+    if (m_running) {
+        const int first = std::max(0, m_route->segmentIndex());
+        QList<QGeoCoordinate> points;
+        QList<int> speedLimits;
+        for (int i = first; i < m_route->pointCount(); ++i) {
+            points.append(m_route->point(i));
+            speedLimits.append(m_route->speedLimitAt(i));
+        }
+        for (const TileId& tile : corridorTiles(points, speedLimits)) {
+            if (m_cache->contains(tile)) ++m_stats.alreadyCached;
+            else m_queue.append(tile);
+        }
+        m_stats.queued += quint64(m_queue.size());
+    }
+    emit progressChanged();
+    startNext();
+}
+
+void TilePrefetcher::startNext()
+{
+    while (m_active.size() < MaxConcurrent && m_next < m_queue.size()) {
+        const TileId tile = m_queue.at(m_next++);
+        if (m_cache->contains(tile) || m_active.contains(tile.key())) continue; // Chargée entre-temps par la carte
+        m_active.insert(tile.key());
+        m_cache->fetch(tile, QNetworkRequest::LowPriority);
+    }
+    if (m_running && m_active.isEmpty() && m_next >= m_queue.size()) {
+        m_running = false;
+        m_queue.clear();
+        m_next = 0;
+        emit progressChanged();
+        emit finished();
+    }
+}
+
+void TilePrefetcher::onTileFetched(quint64 key, bool ok)
+{
+    if (!m_active.remove(key)) return; // Tuile demandée par la carte
+    if (ok) ++m_stats.downloaded;
+    else ++m_stats.failed;
+    emit progressChanged();
+    startNext();
+}
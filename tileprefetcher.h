@@ -0,0 +1,96 @@
+/**
+ * @file tileprefetcher.h
+ * @brief Rôle architectural : Préchargement des tuiles de la carte le long de l'itinéraire actif.
+ * @details Responsabilités : Énumérer les tuiles d'un couloir autour du tracé de RouteModel, aux niveaux
+ * de zoom que le zoom automatique (vitesse) affichera sur chaque segment, et les télécharger en
+ * arrière-plan, en basse priorité, dans TileCache.
+ * Dépendances principales : RouteModel, TileCache.
+ */
+
+#ifndef TILEPREFETCHER_H
+#define TILEPREFETCHER_H
+
+#include "tilecache.h"
+#include <QGeoCoordinate>
+#include <QList>
+#include <QObject>
+#include <QSet>
+
+class RouteModel;
+
+/**
+ * @class TilePrefetcher
+ * @brief Préchargement des tuiles de l'itinéraire (propriété de contexte `tilePrefetcher`).
+ * @details À chaque nouvel itinéraire, les tuiles du couloir sont mises en file à partir du segment
+ * courant, dans l'ordre du trajet ; celles déjà en cache sont sautées. Au plus MaxConcurrent
+ * téléchargements en basse priorité sont en cours, pour laisser passer ceux de la carte.
+ */
+class TilePrefetcher : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int pendingCount READ pendingCount NOTIFY progressChanged)
+
+public:
+    static constexpr int TileSize = 256;              ///< Côté d'une tuile (px).
+    static constexpr double CorridorRadiusPx = 512.0; ///< Demi-largeur du couloir : demi-diagonale de l'écran.
+    static constexpr int MaxConcurrent = 2;           ///< Téléchargements simultanés.
+    static constexpr int MaxTilesPerRoute = 6000;     ///< Au-delà, la fin du trajet n'est pas préchargée.
+    static constexpr int UnknownLimitZoom = 17;       ///< Zoom supposé sur un segment sans limitation connue.
+
+    /**
+     * @struct Stats
+     * @brief Compteurs depuis la création.
+     */
+    struct Stats {
+        quint64 queued = 0;        ///< Tuiles mises en file (absentes du cache à l'énumération).
+        quint64 downloaded = 0;    ///< Tuiles téléchargées et enregistrées.
+        quint64 failed = 0;        ///< Téléchargements en échec.
+        quint64 alreadyCached = 0; ///< Tuiles du couloir déjà en cache.
+    };
+
+    /**
+     * @param route Itinéraire suivi (routeChanged() relance le préchargement).
+     * @param cache Cache de destination, partagé avec la carte.
+     */
+    TilePrefetcher(RouteModel* route, TileCache* cache, QObject* parent = nullptr);
+
+    /**
+     * @brief Zoom automatique de la carte pour la vitesse @p speedKmh : 15 au-delà de 100 km/h, 16 au-delà
+     * de 70, 17 au-delà de 40, 18 sinon. map.qml l'utilise pour que carte et préchargement concordent.
+     */
+    Q_INVOKABLE int zoomForSpeed(double speedKmh) const { return speedZoom(speedKmh); }
+    static int speedZoom(double speedKmh); ///< Voir zoomForSpeed().
+
+    /**
+     * @brief Tuiles couvrant, à CorridorRadiusPx près, le tracé @p points, dans l'ordre du trajet et sans
+     * doublon. Chaque segment est couvert au zoom de sa limitation @p speedLimitsKmh (-1 : inconnue) et au
+     * zoom supérieur, affiché si le véhicule roule moins vite.
+     */
+    static QList<TileId> corridorTiles(const QList<QGeoCoordinate>& points, const QList<int>& speedLimitsKmh,
+                                       int maxTiles = MaxTilesPerRoute);
+
+    int pendingCount() const { return int(m_queue.size() - m_next) + int(m_active.size()); } ///< Tuiles restantes.
+    const Stats& stats() const { return m_stats; } ///< Compteurs depuis la création.
+
+signals:
+    void progressChanged();
+
+    /**
+     * @brief Toutes les tuiles de l'itinéraire ont été traitées.
+     */
+    void finished();
+
+private:
+    void onRouteChanged();
+    void startNext();
+    void onTileFetched(quint64 key, bool ok);
+
+    RouteModel* m_route;
+    TileCache* m_cache;
+    QList<TileId> m_queue;   ///< Tuiles du couloir restant à vérifier, dans l'ordre du trajet.
+    int m_next = 0;          ///< Prochaine tuile de m_queue.
+    bool m_running = false;  ///< Itinéraire en cours de préchargement (finished() pas encore émis).
+    QSet<quint64> m_active;  ///< Téléchargements lancés par le préchargement.
+    Stats m_stats;
+};
+
+#endif // TILEPREFETCHER_H
@@ -0,0 +1,19 @@
+QT = core positioning
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+TARGET = buildroadgraph
+
+SOURCES += \
+    main.cpp \
+    ../../osmpbfreader.cpp \
+    ../../osmgraphimporter.cpp \
+    ../../roadgraph.cpp \
+    ../../roadgraphbuilder.cpp
+
+HEADERS += \
+    ../../osmpbfreader.h \
+    ../../osmgraphimporter.h \
+    ../../roadgraph.h \
+    ../../roadgraphbuilder.h
@@ -0,0 +1,46 @@
+/**
+ * @file main.cpp
+ * @brief Outil hors ligne : extrait OpenStreetMap (.osm.pbf) -> graphe routier projetable (ROAD_GRAPH_FILE).
+ * @details Usage : `buildroadgraph <extrait.osm.pbf> <sortie.graph>`. Exécuté sur le poste de
+ * développement (la contraction d'une région demande plusieurs minutes et quelques Go de mémoire) ;
+ * seul le fichier produit est copié sur la cible.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+#include <cstdio>
+
+#include "../../osmgraphimporter.h"
+#include "../../roadgraphbuilder.h"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        std::fprintf(stderr, "Usage : %s <extrait.osm.pbf> <sortie.graph>\n", qPrintable(QFileInfo(args.value(0)).fileName()));
+        return 2;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    RoadGraphBuilder builder;
+    OsmGraphImporter importer(builder);
+    if (!importer.import(args.at(1))) {
+        std::fprintf(stderr, "Extrait illisible (%s) : %s\n", qPrintable(args.at(1)), qPrintable(importer.errorString()));
+        return 1;
+    }
+    const OsmGraphImporter::Stats& stats = importer.stats();
+    std::printf("Import : %lld chemins, %lld nœuds, %lld arcs, %lld lieux, %lld tronçons coupés (%.1f s)\n",
+                stats.roadWays, stats.roadNodes, stats.edges, stats.places, stats.missingNodes, timer.restart() / 1000.0);
+
+    if (!builder.write(args.at(2))) {
+        std::fprintf(stderr, "Écriture impossible : %s\n", qPrintable(args.at(2)));
+        return 1;
+    }
+    std::printf("Graphe : %d nœuds, %d raccourcis, %d lieux -> %s (%.1f s)\n", builder.nodeCount(),
+                builder.shortcutCount(), builder.placeCount(), qPrintable(args.at(2)), timer.elapsed() / 1000.0);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file triplog.cpp
+ * @brief Encodage et décodage des enregistrements du journal de trajet.
+ * @details Chaque type a sa structure de charge utile, recopiée par memcpy (la charge utile
+ * commence à l'octet 11 de l'enregistrement et n'est donc pas alignée pour des double).
+ */
+
+#include "triplog.h"
+#include <QByteArray>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr char FileMagic[8] = {'I', 'G', 'P', 'S', 'T', 'R', 'I', 'P'};
+
+struct HeaderPayload {
+    char magic[8];
+    quint32 version;
+    quint32 blockSlots;
+    qint64 wallClockMs;
+    quint32 recordSize;
+    quint32 reserved;
+};
+
+struct IndexPayload {
+    qint64 firstTimestampNs;
+    qint64 lastTimestampNs;
+    quint32 block;
+    quint32 typeMask;
+    quint64 dropped;
+};
+
+struct GpsPayload {
+    double lat;
+    double lon;
+    float speedMs;
+    float courseDeg;
+    float horizontalAccuracyM;
+    qint16 hdopCenti;  // HDOP x 100 (-1 : inconnu)
+    qint8 satellites;  // -1 : inconnu
+    quint8 reserved;
+};
+
+struct ImuPayload {
+    float accel[3];
+    float gyro[3];
+    float mag[3];
+};
+
+struct HeadingPayload {
+    double headingDeg;
+};
+
+static_assert(sizeof(HeaderPayload) <= sizeof(TripLogRecord::payload), "HeaderPayload trop grand");
+static_assert(sizeof(IndexPayload) <= sizeof(TripLogRecord::payload), "IndexPayload trop grand");
+static_assert(sizeof(GpsPayload) <= sizeof(TripLogRecord::payload), "GpsPayload trop grand");
+static_assert(sizeof(ImuPayload) <= sizeof(TripLogRecord::payload), "ImuPayload trop grand");
+
+template <typename Payload>
+TripLogRecord makeRecord(TripLog::Type type, qint64 timestampNs, const Payload& payload, quint16 flags = 0)
+{
+    TripLogRecord record;
+    record.timestampNs = timestampNs;
+    record.marker = TripLog::RecordMarker;
+    record.type = type;
+    record.flags = flags;
+    std::memcpy(record.payload, &payload, sizeof(Payload));
+    return record;
+}
+
+template <typename Payload>
+bool readPayload(const TripLogRecord& record, TripLog::Type type, Payload& payload)
+{
+    if (record.marker != TripLog::RecordMarker || record.type != type) return false;
+    std::memcpy(&payload, record.payload, sizeof(Payload));
+    return true;
+}
+} // namespace
+
+TripLogRecord TripLog::encodeHeader(const HeaderInfo& info)
+{
+    HeaderPayload payload = {};
+    std::memcpy(payload.magic, FileMagic, sizeof(FileMagic));
+    payload.version = info.version;
+    payload.blockSlots = info.blockSlots;
+    payload.wallClockMs = info.wallClockMs;
+    payload.recordSize = sizeof(TripLogRecord);
+    return makeRecord(Header, info.originNs, payload);
+}
+
+TripLogRecord TripLog::encodeIndex(const IndexEntry& entry, qint64 timestampNs)
+{
+    IndexPayload payload = {};
+    payload.firstTimestampNs = entry.firstTimestampNs;
+    payload.lastTimestampNs = entry.lastTimestampNs;
+    payload.block = entry.block;
+    payload.typeMask = entry.typeMask;
+    payload.dropped = entry.dropped;
+    return makeRecord(Index, timestampNs, payload);
+}
+
+TripLogRecord TripLog::encodeGps(const GpsFix& fix)
+{
+    GpsPayload payload = {};
+    payload.lat = fix.lat;
+    payload.lon = fix.lon;
+    payload.speedMs = float(fix.speedMs);
+    payload.courseDeg = float(fix.courseDeg);
+    payload.horizontalAccuracyM = float(fix.horizontalAccuracyM);
+    payload.hdopCenti = fix.hdop < 0.0 ? qint16(-1) : qint16(qMin(32767L, std::lround(fix.hdop * 100.0)));
+    payload.satellites = qint8(qBound(-1, fix.satellites, 127));
+
+    quint16 flags = 0;
+    if (fix.valid) flags |= GpsValid;
+    if (fix.hasSpeed) flags |= GpsHasSpeed;
+    if (fix.hasCourse) flags |= GpsHasCourse;
+    return makeRecord(Gps, fix.timestampNs, payload, flags);
+}
+
+TripLogRecord TripLog::encodeImu(const ImuSample& sample)
+{
+    const ImuPayload payload = {{sample.ax, sample.ay, sample.az},
+                                {sample.gx, sample.gy, sample.gz},
+                                {sample.mx, sample.my, sample.mz}};
+    return makeRecord(Imu, sample.timestampNs, payload, sample.magValid ? ImuMagValid : 0);
+}
+
+TripLogRecord TripLog::encodeHeading(double headingDeg, qint64 timestampNs)
+{
+    const HeadingPayload payload = {headingDeg};
+    return makeRecord(Heading, timestampNs, payload);
+}
+
+TripLogRecord TripLog::encodeText(Type type, const QString& text, qint64 timestampNs)
+{
+    TripLogRecord record;
+    record.timestampNs = timestampNs;
+    record.marker = RecordMarker;
+    record.type = type;
+
+    // Troncature sur une frontière de caractère UTF-8 (jamais au milieu d'une séquence multi-octets).
+    const QByteArray utf8 = text.toUtf8();
+    int length = qMin(int(utf8.size()), MaxTextBytes);
+    if (length < utf8.size()) {
+        while (length > 0 && (quint8(utf8.at(length)) & 0xC0) == 0x80) --length;
+    }
+    std::memcpy(record.payload, utf8.constData(), std::size_t(length));
+    record.flags = quint16(length);
+    return record;
+}
+
+bool TripLog::decodeHeader(const TripLogRecord& record, HeaderInfo& info)
+{
+    HeaderPayload payload;
+    if (!readPayload(record, Header, payload)) return false;
+    if (std::memcmp(payload.magic, FileMagic, sizeof(FileMagic)) != 0) return false;
+    if (payload.recordSize != sizeof(TripLogRecord)) return false;
+    info.version = payload.version;
+    info.blockSlots = payload.blockSlots;
+    info.wallClockMs = payload.wallClockMs;
+    info.originNs = record.timestampNs;
+    return true;
+}
+
+bool TripLog::decodeIndex(const TripLogRecord& record, IndexEntry& entry)
+{
+    IndexPayload payload;
+    if (!readPayload(record, Index, payload)) return false;
+    entry.firstTimestampNs = payload.firstTimestampNs;
+    entry.lastTimestampNs = payload.lastTimestampNs;
+    entry.block = payload.block;
+    entry.typeMask = payload.typeMask;
+    entry.dropped = payload.dropped;
+    return true;
+}
+
+bool TripLog::decodeGps(const TripLogRecord& record, GpsFix& fix)
+{
+    GpsPayload payload;
+    if (!readPayload(record, Gps, payload)) return false;
+    fix = GpsFix();
+    fix.timestampNs = record.timestampNs;
+    fix.valid = (record.flags & GpsValid) != 0;
+    fix.hasSpeed = (record.flags & GpsHasSpeed) != 0;
+    fix.hasCourse = (record.flags & GpsHasCourse) != 0;
+    fix.lat = payload.lat;
+    fix.lon = payload.lon;
+    fix.speedMs = payload.speedMs;
+    fix.courseDeg = payload.courseDeg;
+    fix.horizontalAccuracyM = payload.horizontalAccuracyM;
+    fix.hdop = payload.hdopCenti < 0 ? -1.0 : payload.hdopCenti / 100.0;
+    fix.satellites = payload.satellites;
+    return true;
+}
+
+bool TripLog::decodeImu(const TripLogRecord& record, ImuSample& sample)
+{
+    ImuPayload payload;
+    if (!readPayload(record, Imu, payload)) return false;
+    sample = ImuSample();
+    sample.timestampNs = record.timestampNs;
+    sample.magValid = (record.flags & ImuMagValid) != 0;
+    sample.ax = payload.accel[0];
+    sample.ay = payload.accel[1];
+    sample.az = payload.accel[2];
+    sample.gx = payload.gyro[0];
+    sample.gy = payload.gyro[1];
+    sample.gz = payload.gyro[2];
+    sample.mx = payload.mag[0];
+    sample.my = payload.mag[1];
+    sample.mz = payload.mag[2];
+    return true;
+}
+
+bool TripLog::decodeHeading(const TripLogRecord& record, double& headingDeg)
+{
+    HeadingPayload payload;
+    if (!readPayload(record, Heading, payload)) return false;
+    headingDeg = payload.headingDeg;
+    return true;
+}
+
+QString TripLog::decodeText(const TripLogRecord& record)
+{
+    if (record.marker != RecordMarker || (record.type != RouteRequest && record.type != PageSwitch)) return QString();
+    const int length = qMin(int(record.flags), MaxTextBytes);
+    return QString::fromUtf8(reinterpret_cast<const char*>(record.payload), length);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file triplog.h
+ * @brief Rôle architectural : Format du journal de trajet binaire (enregistrements de taille fixe).
+ * @details Responsabilités : Définir l'enregistrement de 48 octets commun à l'écrivain (TripLogWriter)
+ * et au lecteur (TripLogReader), ainsi que l'encodage des fix GPS, échantillons IMU, cap, demandes
+ * d'itinéraire et changements de page.
+ * Organisation du fichier : un enregistrement d'en-tête, puis des blocs de BlockSlots enregistrements
+ * dont le dernier est un index (bornes temporelles, types présents, pertes cumulées). La position de
+ * chaque index est donc connue sans lecture préalable, ce qui permet une recherche dichotomique par
+ * date directement dans la projection mémoire.
+ * Les champs sont stockés dans l'ordre des octets de la cible (little-endian sur Raspberry Pi et x86).
+ * Dépendances principales : GpsFix, ImuSample.
+ */
+
+#ifndef TRIPLOG_H
+#define TRIPLOG_H
+
+#include <QString>
+#include <QtGlobal>
+#include "gpsfix.h"
+#include "imusample.h"
+
+/**
+ * @struct TripLogRecord
+ * @brief Enregistrement brut de 48 octets, tel qu'écrit sur disque.
+ */
+struct TripLogRecord {
+    qint64 timestampNs = 0;           ///< Instant de la mesure (horloge monotone, ns).
+    quint16 flags = 0;                ///< Drapeaux propres au type (validité, longueur de texte...).
+    quint8 type = 0;                  ///< TripLog::Type.
+    unsigned char payload[36] = {};   ///< Charge utile, voir TripLog::encode*().
+    quint8 marker = 0;                ///< TripLog::RecordMarker ; dernier octet, donc absent d'un enregistrement tronqué.
+};
+static_assert(sizeof(TripLogRecord) == 48, "TripLogRecord: taille d'enregistrement figée par le format");
+
+/**
+ * @class TripLog
+ * @brief Constantes du format et conversion enregistrement <-> données métier.
+ */
+class TripLog {
+public:
+    /**
+     * @brief Types d'enregistrements.
+     */
+    enum Type : quint8 {
+        Header = 1,       ///< Premier enregistrement du fichier (signature, version, date de début).
+        Index = 2,        ///< Dernier enregistrement de chaque bloc.
+        Gps = 3,          ///< Fix GNSS (GpsFix).
+        Imu = 4,          ///< Échantillon inertiel calibré (ImuSample).
+        Heading = 5,      ///< Cap lissé publié vers l'interface.
+        RouteRequest = 6, ///< Destination demandée par l'utilisateur.
+        PageSwitch = 7    ///< Pages affichées après une navigation dans l'interface.
+    };
+
+    /**
+     * @brief Drapeaux des enregistrements Gps (champ flags).
+     */
+    enum GpsFlag : quint16 {
+        GpsValid = 0x01,
+        GpsHasSpeed = 0x02,
+        GpsHasCourse = 0x04
+    };
+
+    /** @brief Drapeau des enregistrements Imu : magnétomètre valide. */
+    static constexpr quint16 ImuMagValid = 0x01;
+
+    static constexpr quint32 Version = 1;          ///< Version du format.
+    static constexpr quint8 RecordMarker = 0xA5;   ///< Distingue un enregistrement écrit d'une zone vide.
+    static constexpr int BlockSlots = 512;         ///< Enregistrements par bloc, index compris (24 ko).
+    static constexpr int BlockDataRecords = BlockSlots - 1; ///< Enregistrements de données par bloc.
+    static constexpr int MaxTextBytes = 36;        ///< Texte UTF-8 maximal (tronqué au-delà).
+
+    /**
+     * @struct IndexEntry
+     * @brief Contenu d'un enregistrement d'index.
+     */
+    struct IndexEntry {
+        qint64 firstTimestampNs = 0; ///< Plus petit horodatage du bloc.
+        qint64 lastTimestampNs = 0;  ///< Plus grand horodatage du bloc.
+        quint32 block = 0;           ///< Numéro du bloc (0 pour le premier).
+        quint32 typeMask = 0;        ///< Bit (1 << type) pour chaque type présent dans le bloc.
+        quint64 dropped = 0;         ///< Enregistrements perdus (files pleines) depuis l'ouverture.
+    };
+
+    /**
+     * @struct HeaderInfo
+     * @brief Contenu de l'enregistrement d'en-tête.
+     */
+    struct HeaderInfo {
+        quint32 version = 0;         ///< Version du format.
+        quint32 blockSlots = 0;      ///< Taille des blocs en enregistrements.
+        qint64 wallClockMs = 0;      ///< Date de début (ms depuis l'époque Unix, UTC).
+        qint64 originNs = 0;         ///< Horloge monotone au même instant.
+    };
+
+    static TripLogRecord encodeHeader(const HeaderInfo& info);
+    static TripLogRecord encodeIndex(const IndexEntry& entry, qint64 timestampNs);
+    static TripLogRecord encodeGps(const GpsFix& fix);
+    static TripLogRecord encodeImu(const ImuSample& sample);
+    static TripLogRecord encodeHeading(double headingDeg, qint64 timestampNs);
+    static TripLogRecord encodeText(Type type, const QString& text, qint64 timestampNs);
+
+    static bool decodeHeader(const TripLogRecord& record, HeaderInfo& info);
+    static bool decodeIndex(const TripLogRecord& record, IndexEntry& entry);
+    static bool decodeGps(const TripLogRecord& record, GpsFix& fix);
+    static bool decodeImu(const TripLogRecord& record, ImuSample& sample);
+    static bool decodeHeading(const TripLogRecord& record, double& headingDeg);
+
+    /**
+     * @brief Texte d'un enregistrement RouteRequest ou PageSwitch (chaîne vide pour un autre type).
+     */
+    static QString decodeText(const TripLogRecord& record);
+
+    /**
+     * @brief true si l'enregistrement a été entièrement écrit (marqueur présent, type connu).
+     */
+    static bool isWritten(const TripLogRecord& record)
+    {
+        return record.marker == RecordMarker && record.type >= Header && record.type <= PageSwitch;
+    }
+};
+
+#endif // TRIPLOG_H
@@ -0,0 +1,99 @@
+/**
+ * @file triplogreader.cpp
+ * @brief Implémentation de la lecture du journal de trajet.
+ */
+
+#include "triplogreader.h"
+#include <limits>
+
+TripLogReader::~TripLogReader()
+{
+    close();
+}
+
+bool TripLogReader::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 records = m_file.size() / qint64(sizeof(TripLogRecord));
+    if (records < 1 || records > qint64(std::numeric_limits<int>::max())) {
+        m_file.close();
+        return false;
+    }
+
+    uchar* mapped = m_file.map(0, records * qint64(sizeof(TripLogRecord)));
+    if (!mapped) {
+        m_file.close();
+        return false;
+    }
+    // map() renvoie une adresse alignée sur une page : les qint64 des enregistrements sont alignés.
+    const TripLogRecord* base = reinterpret_cast<const TripLogRecord*>(mapped);
+    if (!TripLog::decodeHeader(base[0], m_header) || m_header.version != TripLog::Version
+        || m_header.blockSlots != quint32(TripLog::BlockSlots)) {
+        m_file.unmap(mapped);
+        m_file.close();
+        return false;
+    }
+
+    // Fin valide : les écritures se font en ajout seul, une coupure ne peut laisser qu'une queue
+    // vide (blocs alloués mais jamais écrits) ; les enregistrements valides forment donc un préfixe,
+    // délimité par dichotomie sans parcourir tout le fichier.
+    int low = 1;
+    int high = int(records);
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (TripLog::isWritten(base[mid])) low = mid + 1;
+        else high = mid;
+    }
+    m_records = base;
+    m_count = low;
+    return true;
+}
+
+void TripLogReader::close()
+{
+    if (m_records) m_file.unmap(reinterpret_cast<uchar*>(const_cast<TripLogRecord*>(m_records)));
+    m_records = nullptr;
+    m_count = 0;
+    m_header = TripLog::HeaderInfo();
+    m_file.close();
+}
+
+int TripLogReader::blockCount() const
+{
+    if (m_count <= 1) return 0;
+    return (m_count - 1) / TripLog::BlockSlots;
+}
+
+bool TripLogReader::index(int block, TripLog::IndexEntry& entry) const
+{
+    if (block < 0 || block >= blockCount()) return false;
+    return TripLog::decodeIndex(m_records[indexPosition(block)], entry);
+}
+
+bool TripLogReader::isDataPosition(int position)
+{
+    return position > 0 && (position - 1) % TripLog::BlockSlots != TripLog::BlockDataRecords;
+}
+
+int TripLogReader::lowerBound(qint64 timestampNs) const
+{
+    // Premier bloc complet dont le plus grand horodatage atteint la date cherchée.
+    const int blocks = blockCount();
+    int low = 0;
+    int high = blocks;
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        TripLog::IndexEntry entry;
+        if (index(mid, entry) && entry.lastTimestampNs < timestampNs) low = mid + 1;
+        else high = mid;
+    }
+
+    for (int position = 1 + low * TripLog::BlockSlots; position < m_count; ++position) {
+        if (isDataPosition(position) && m_records[position].timestampNs >= timestampNs) return position;
+    }
+    return m_count;
+}
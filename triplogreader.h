@@ -0,0 +1,122 @@
+/**
+ * @file triplogreader.h
+ * @brief Rôle architectural : Lecture d'un journal de trajet par projection mémoire (analyse après trajet).
+ * @details Responsabilités : Exposer les enregistrements d'un fichier TripLogWriter sans les copier
+ * (QFile::map), retrouver la fin valide d'un journal interrompu et rechercher par date via les index de bloc.
+ * Utilisable hors de l'application (outils d'analyse, tests) : ne dépend que de QtCore.
+ * Dépendances principales : TripLog (format), QFile.
+ */
+
+#ifndef TRIPLOGREADER_H
+#define TRIPLOGREADER_H
+
+#include <QFile>
+#include <QString>
+#include "triplog.h"
+
+/**
+ * @class TripLogReader
+ * @brief Vue en lecture seule d'un journal de trajet projeté en mémoire.
+ * @details Les positions manipulées sont des numéros d'enregistrement bruts : 0 est l'en-tête, et la
+ * dernière position de chaque bloc complet est un index. Un journal interrompu (coupure d'alimentation)
+ * se termine au premier enregistrement non écrit ou tronqué ; tout ce qui précède reste lisible.
+ */
+class TripLogReader {
+public:
+    TripLogReader() = default;
+    ~TripLogReader();
+    TripLogReader(const TripLogReader&) = delete;
+    TripLogReader& operator=(const TripLogReader&) = delete;
+
+    /**
+     * @brief Projette le journal en mémoire et valide son en-tête.
+     * @return false si le fichier est illisible, n'est pas un journal de trajet ou d'une autre version.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Libère la projection.
+     */
+    void close();
+
+    bool isOpen() const { return m_records != nullptr; } ///< true après un open() réussi.
+    const TripLog::HeaderInfo& header() const { return m_header; } ///< Contenu de l'en-tête.
+
+    /**
+     * @brief Nombre d'enregistrements valides, en-tête et index compris.
+     */
+    int recordCount() const { return m_count; }
+
+    /**
+     * @brief Enregistrement brut à la position @p position (0 <= position < recordCount()).
+     */
+    const TripLogRecord& record(int position) const { return m_records[position]; }
+
+    /**
+     * @brief Nombre de blocs complets, c'est-à-dire disposant de leur index.
+     */
+    int blockCount() const;
+
+    /**
+     * @brief Index du bloc @p block (0 <= block < blockCount()).
+     * @return false si l'enregistrement d'index est corrompu.
+     */
+    bool index(int block, TripLog::IndexEntry& entry) const;
+
+    /**
+     * @brief true si la position contient un enregistrement de données (ni en-tête ni index).
+     */
+    static bool isDataPosition(int position);
+
+    /**
+     * @brief Position de l'index du bloc @p block.
+     */
+    static int indexPosition(int block) { return 1 + block * TripLog::BlockSlots + TripLog::BlockDataRecords; }
+
+    /**
+     * @brief Première position de données dont l'horodatage est >= @p timestampNs.
+     * @details Recherche dichotomique sur les index de bloc, puis parcours du seul bloc retenu
+     * (et du bloc final incomplet, dépourvu d'index). Le journal étant trié lot par lot, c'est la
+     * première position dans l'ordre du fichier qui satisfait la condition.
+     * @return recordCount() si aucun enregistrement n'est assez récent.
+     */
+    int lowerBound(qint64 timestampNs) const;
+
+    /**
+     * @brief Appelle @p visit(const TripLogRecord&) pour chaque enregistrement de type @p type.
+     * @details Les blocs complets dont l'index ne mentionne pas ce type sont sautés sans être lus.
+     * @return Nombre d'enregistrements visités.
+     */
+    template <typename Visitor>
+    int forEach(TripLog::Type type, Visitor visit) const
+    {
+        int visited = 0;
+        int position = 1;
+        const int blocks = blockCount();
+        for (int block = 0; block <= blocks; ++block) {
+            const int end = block < blocks ? indexPosition(block) : m_count;
+            if (block < blocks) {
+                TripLog::IndexEntry entry;
+                if (index(block, entry) && !(entry.typeMask & (1u << type))) {
+                    position = end + 1;
+                    continue;
+                }
+            }
+            for (; position < end; ++position) {
+                if (m_records[position].type != type) continue;
+                visit(m_records[position]);
+                ++visited;
+            }
+            position = end + 1;
+        }
+        return visited;
+    }
+
+private:
+    QFile m_file;                           ///< Fichier projeté
+    const TripLogRecord* m_records = nullptr; ///< Début de la projection
+    int m_count = 0;                        ///< Enregistrements valides
+    TripLog::HeaderInfo m_header;           ///< En-tête décodé
+};
+
+#endif // TRIPLOGREADER_H
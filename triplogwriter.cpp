@@ -0,0 +1,209 @@
+/**
+ * @file triplogwriter.cpp
+ * @brief Implémentation de l'enregistreur du journal de trajet.
+ */
+
+#include "triplogwriter.h"
+#include "telemetrydata.h"
+#include <QDateTime>
+#include <algorithm>
+#include <chrono>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+TripLogWriter::TripLogWriter(QObject* parent)
+    : QObject(parent)
+{
+    // Un lot de FlushIntervalMs tient largement dans cette réserve : pas d'allocation en régime établi.
+    m_batch.reserve(1024);
+    m_pending.reserve(1024);
+}
+
+TripLogWriter::~TripLogWriter()
+{
+    close();
+}
+
+bool TripLogWriter::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) return false;
+
+    TripLog::HeaderInfo info;
+    info.version = TripLog::Version;
+    info.blockSlots = TripLog::BlockSlots;
+    info.wallClockMs = QDateTime::currentMSecsSinceEpoch();
+    info.originNs = TelemetryData::monotonicNowNs();
+    const TripLogRecord header = TripLog::encodeHeader(info);
+    if (m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        m_file.close();
+        return false;
+    }
+
+    // Un producteur ayant vu isOpen() juste avant la fermeture précédente a pu pousser après le dernier vidage.
+    TripLogRecord stale;
+    while (m_sensorRing.pop(stale)) {}
+    while (m_guiRing.pop(stale)) {}
+
+    m_block = TripLog::IndexEntry();
+    m_blockFill = 0;
+    m_lastSyncNs = info.originNs;
+    m_fileBytes = qint64(sizeof(header));
+    m_writeFailed = false;
+    m_statRecords = 0;
+    m_statBlocks = 0;
+    m_statSyncs = 0;
+    m_statLost = 0;
+    m_statFailed = false;
+    m_stopRequested = false;
+    m_open.store(true, std::memory_order_release);
+    m_thread = std::thread(&TripLogWriter::writerLoop, this);
+    return true;
+}
+
+void TripLogWriter::close()
+{
+    if (!m_thread.joinable()) return;
+    m_open.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_file.close();
+}
+
+TripLogWriter::Stats TripLogWriter::stats() const
+{
+    Stats stats;
+    stats.records = m_statRecords.load(std::memory_order_relaxed);
+    stats.blocks = m_statBlocks.load(std::memory_order_relaxed);
+    stats.syncs = m_statSyncs.load(std::memory_order_relaxed);
+    stats.dropped = droppedCount();
+    stats.lost = m_statLost.load(std::memory_order_relaxed);
+    stats.failed = m_statFailed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+quint64 TripLogWriter::droppedCount() const
+{
+    return m_sensorRing.droppedCount() + m_guiRing.droppedCount();
+}
+
+void TripLogWriter::logImu(const ImuSample& sample)
+{
+    if (isOpen()) m_sensorRing.push(TripLog::encodeImu(sample));
+}
+
+void TripLogWriter::logHeading(double headingDeg, qint64 timestampNs)
+{
+    if (isOpen()) m_sensorRing.push(TripLog::encodeHeading(headingDeg, timestampNs));
+}
+
+void TripLogWriter::logGpsFix(const GpsFix& fix)
+{
+    if (isOpen()) m_guiRing.push(TripLog::encodeGps(fix));
+}
+
+void TripLogWriter::logRouteRequest(const QString& destination)
+{
+    if (isOpen()) m_guiRing.push(TripLog::encodeText(TripLog::RouteRequest, destination, TelemetryData::monotonicNowNs()));
+}
+
+void TripLogWriter::logPageSwitch(const QString& pages)
+{
+    if (isOpen()) m_guiRing.push(TripLog::encodeText(TripLog::PageSwitch, pages, TelemetryData::monotonicNowNs()));
+}
+
+void TripLogWriter::writerLoop()
+{
+    // Le dernier passage (arrêt demandé) vide les files et synchronise quoi qu'il arrive.
+    bool stopping = false;
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(FlushIntervalMs), [this] { return m_stopRequested; });
+            stopping = m_stopRequested;
+        }
+        drainAndWrite(stopping);
+    }
+}
+
+void TripLogWriter::drainAndWrite(bool forceSync)
+{
+    // Les deux files sont vidées ensemble puis triées : dans un lot, l'IMU et le GPS s'entrelacent
+    // dans l'ordre chronologique (le tri stable conserve l'ordre d'arrivée à horodatage égal).
+    m_batch.clear();
+    TripLogRecord record;
+    while (m_sensorRing.pop(record)) m_batch.push_back(record);
+    while (m_guiRing.pop(record)) m_batch.push_back(record);
+    if (m_writeFailed) {
+        // Journal arrêté : ce qu'un producteur a poussé avant de voir isOpen() à false est perdu.
+        m_statLost.fetch_add(m_batch.size(), std::memory_order_relaxed);
+        return;
+    }
+    std::stable_sort(m_batch.begin(), m_batch.end(), [](const TripLogRecord& a, const TripLogRecord& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+
+    m_pending.clear();
+    m_pendingBlocks = 0;
+    for (const TripLogRecord& r : m_batch) appendRecord(r);
+
+    if (!m_pending.empty()) {
+        // Un seul write() par lot (fichier non tamponné) : pas de recopie dans un tampon QIODevice.
+        const qint64 bytes = qint64(m_pending.size() * sizeof(TripLogRecord));
+        if (m_file.write(reinterpret_cast<const char*>(m_pending.data()), bytes) != bytes) {
+            // Un lot partiel décalerait les blocs suivants de leur index : le fichier est ramené à la fin
+            // du dernier lot complet et le journal s'arrête (les producteurs voient isOpen() à false).
+            m_file.resize(m_fileBytes);
+            m_writeFailed = true;
+            m_open.store(false, std::memory_order_release);
+            m_statFailed.store(true, std::memory_order_relaxed);
+            m_statLost.fetch_add(m_batch.size(), std::memory_order_relaxed);
+            return;
+        }
+        m_fileBytes += bytes;
+        m_statRecords.fetch_add(m_batch.size(), std::memory_order_relaxed);
+        m_statBlocks.fetch_add(quint64(m_pendingBlocks), std::memory_order_relaxed);
+    }
+
+    const qint64 now = TelemetryData::monotonicNowNs();
+    if (!forceSync && now - m_lastSyncNs < qint64(SyncIntervalMs) * 1000000) return;
+    m_lastSyncNs = now;
+#if defined(Q_OS_LINUX)
+    ::fdatasync(m_file.handle());
+#elif defined(Q_OS_UNIX)
+    ::fsync(m_file.handle());
+#endif
+    m_statSyncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TripLogWriter::appendRecord(const TripLogRecord& record)
+{
+    if (m_blockFill == 0) {
+        m_block.firstTimestampNs = record.timestampNs;
+        m_block.lastTimestampNs = record.timestampNs;
+        m_block.typeMask = 0;
+    }
+    m_block.firstTimestampNs = qMin(m_block.firstTimestampNs, record.timestampNs);
+    m_block.lastTimestampNs = qMax(m_block.lastTimestampNs, record.timestampNs);
+    m_block.typeMask |= 1u << record.type;
+    m_pending.push_back(record);
+
+    if (++m_blockFill == TripLog::BlockDataRecords) closeBlock();
+}
+
+void TripLogWriter::closeBlock()
+{
+    m_block.dropped = droppedCount();
+    m_pending.push_back(TripLog::encodeIndex(m_block, m_block.lastTimestampNs));
+    ++m_pendingBlocks; // Comptés dans m_statBlocks une fois le lot écrit
+    ++m_block.block;
+    m_blockFill = 0;
+}
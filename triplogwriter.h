@@ -0,0 +1,144 @@
+/**
+ * @file triplogwriter.h
+ * @brief Rôle architectural : Enregistreur du journal de trajet binaire (thread d'écriture dédié).
+ * @details Responsabilités : Collecter sans blocage les fix GPS, échantillons IMU, caps, demandes
+ * d'itinéraire et changements de page, puis les ajouter au fichier depuis un thread de fond qui
+ * regroupe les écritures et borne le nombre de fsync. Les producteurs ne font qu'une copie dans une
+ * file SPSC : ni l'interface ni le thread d'acquisition IMU n'attendent jamais le disque.
+ * Dépendances principales : TripLog (format), TelemetryRing, QFile, std::thread.
+ */
+
+#ifndef TRIPLOGWRITER_H
+#define TRIPLOGWRITER_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "telemetryring.h"
+#include "triplog.h"
+
+/**
+ * @class TripLogWriter
+ * @brief Journal de trajet en ajout seul, écrit par un thread de fond.
+ * @details Deux producteurs, chacun sur sa propre file sans verrou :
+ * - contexte d'acquisition IMU : logImu() et logHeading() ;
+ * - thread GUI : logGpsFix(), logRouteRequest() et logPageSwitch().
+ *
+ * Toutes les FlushIntervalMs, le thread d'écriture vide les deux files, trie le lot par horodatage,
+ * l'écrit en un seul appel et insère un enregistrement d'index à la fin de chaque bloc. Les données
+ * sont forcées sur le support (fdatasync) au plus une fois par SyncIntervalMs : une coupure
+ * d'alimentation ne coûte qu'une seconde de trajet, et TripLogReader ignore un lot final incomplet.
+ * Quand une file déborde, l'enregistrement est perdu et comptabilisé dans l'index suivant.
+ * Un lot dont l'écriture échoue (disque plein, erreur d'E/S) est retiré du fichier, qui se termine
+ * alors sur le dernier lot complet, et le journal s'arrête : les blocs restent alignés sur leur index.
+ */
+class TripLogWriter : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int FlushIntervalMs = 50;    ///< Période de vidage des files.
+    static constexpr int SyncIntervalMs = 1000;   ///< Intervalle minimal entre deux fdatasync.
+
+    /**
+     * @struct Stats
+     * @brief Compteurs d'écriture (lisibles depuis n'importe quel thread).
+     */
+    struct Stats {
+        quint64 records = 0;  ///< Enregistrements de données écrits.
+        quint64 blocks = 0;   ///< Blocs complets (index écrit).
+        quint64 syncs = 0;    ///< Appels à fdatasync.
+        quint64 dropped = 0;  ///< Enregistrements perdus (files pleines).
+        quint64 lost = 0;     ///< Enregistrements perdus à l'écriture (disque plein, erreur d'E/S).
+        bool failed = false;  ///< Journal arrêté après une erreur d'écriture.
+    };
+
+    /**
+     * @brief Constructeur.
+     * @param parent Objet parent pour la gestion mémoire.
+     */
+    explicit TripLogWriter(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructeur : ferme le journal (écriture et synchronisation des données en attente).
+     */
+    ~TripLogWriter() override;
+
+    /**
+     * @brief Crée (ou écrase) le journal, écrit l'en-tête et démarre le thread d'écriture.
+     * @return false si le fichier ne peut pas être créé.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Arrête le thread d'écriture après avoir écrit et synchronisé les données en attente.
+     */
+    void close();
+
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); } ///< true entre open() et close() (ou une erreur d'écriture).
+    Stats stats() const;                                 ///< Compteurs courants.
+
+    /**
+     * @brief Journalise un échantillon IMU calibré (contexte d'acquisition uniquement, sans blocage).
+     */
+    void logImu(const ImuSample& sample);
+
+    /**
+     * @brief Journalise le cap lissé publié vers l'interface (contexte d'acquisition uniquement).
+     */
+    void logHeading(double headingDeg, qint64 timestampNs);
+
+public slots:
+    /**
+     * @brief Journalise un fix GNSS (thread GUI).
+     */
+    void logGpsFix(const GpsFix& fix);
+
+    /**
+     * @brief Journalise une destination demandée par l'utilisateur (thread GUI, 36 octets UTF-8 au plus).
+     */
+    void logRouteRequest(const QString& destination);
+
+    /**
+     * @brief Journalise les pages affichées après une navigation (thread GUI).
+     */
+    void logPageSwitch(const QString& pages);
+
+private:
+    void writerLoop();
+    void drainAndWrite(bool forceSync);
+    void appendRecord(const TripLogRecord& record);
+    void closeBlock();
+    quint64 droppedCount() const;
+
+    QFile m_file;                                    ///< Fichier (accédé par le thread d'écriture après open())
+    std::thread m_thread;                            ///< Thread d'écriture
+    std::mutex m_wakeMutex;                          ///< Protège uniquement l'attente du thread d'écriture
+    std::condition_variable m_wake;                  ///< Réveil anticipé à la fermeture
+    bool m_stopRequested = false;                    ///< Demande d'arrêt (sous m_wakeMutex)
+    std::atomic<bool> m_open{false};                 ///< Producteurs acceptés (lu depuis tous les threads)
+
+    TelemetryRing<TripLogRecord, 4096> m_sensorRing; ///< IMU et cap (≈ 10 s à 200 Hz + cap)
+    TelemetryRing<TripLogRecord, 256> m_guiRing;     ///< GPS et évènements d'interface
+
+    // --- État du thread d'écriture ---
+    std::vector<TripLogRecord> m_batch;              ///< Lot en cours de tri
+    std::vector<TripLogRecord> m_pending;            ///< Octets prêts pour le prochain write()
+    TripLog::IndexEntry m_block;                     ///< Index du bloc en cours de remplissage
+    int m_blockFill = 0;                             ///< Enregistrements de données dans le bloc en cours
+    qint64 m_lastSyncNs = 0;                         ///< Instant du dernier fdatasync
+    qint64 m_fileBytes = 0;                          ///< Taille du fichier à la fin du dernier lot écrit en entier
+    int m_pendingBlocks = 0;                         ///< Blocs fermés dans m_pending
+    bool m_writeFailed = false;                      ///< Écriture arrêtée après une erreur
+
+    std::atomic<quint64> m_statRecords{0};           ///< Enregistrements de données écrits
+    std::atomic<quint64> m_statBlocks{0};            ///< Blocs complets
+    std::atomic<quint64> m_statSyncs{0};             ///< Synchronisations disque
+    std::atomic<quint64> m_statLost{0};              ///< Enregistrements perdus à l'écriture
+    std::atomic<bool> m_statFailed{false};           ///< Erreur d'écriture rencontrée
+};
+
+#endif // TRIPLOGWRITER_H
@@ -0,0 +1,171 @@
+/**
+ * @file ubxprotocol.cpp
+ * @brief Implémentation du protocole binaire u-blox UBX.
+ * @details Les champs binaires sont en little-endian ; ils sont lus octet par octet pour rester
+ * indépendants de l'alignement et de l'endianness de la cible.
+ */
+
+#include "ubxprotocol.h"
+#include <algorithm>
+
+namespace {
+quint16 readU2(const quint8* p) { return quint16(p[0] | (p[1] << 8)); }
+
+quint32 readU4(const quint8* p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+qint32 readI4(const quint8* p) { return static_cast<qint32>(readU4(p)); }
+
+void appendU2(QByteArray& out, quint16 value)
+{
+    out.append(char(value & 0xFF));
+    out.append(char(value >> 8));
+}
+
+void appendU4(QByteArray& out, quint32 value)
+{
+    appendU2(out, quint16(value & 0xFFFF));
+    appendU2(out, quint16(value >> 16));
+}
+
+constexpr std::size_t NavPvtLength = 92;
+constexpr std::size_t NavDopLength = 18;
+
+// Phrases NMEA standard désactivées en mode UBX (identifiants de la classe 0xF0).
+constexpr quint8 NmeaGga = 0x00;
+constexpr quint8 NmeaGll = 0x01;
+constexpr quint8 NmeaGsa = 0x02;
+constexpr quint8 NmeaGsv = 0x03;
+constexpr quint8 NmeaRmc = 0x04;
+constexpr quint8 NmeaVtg = 0x05;
+} // namespace
+
+void UbxParser::reset()
+{
+    m_state = State::Sync1;
+    m_length = 0;
+    m_received = 0;
+    m_stats = Stats();
+}
+
+QByteArray UbxProtocol::frame(quint8 msgClass, quint8 msgId, const QByteArray& payload)
+{
+    QByteArray out;
+    out.reserve(8 + payload.size());
+    out.append(char(0xB5));
+    out.append(char(0x62));
+    out.append(char(msgClass));
+    out.append(char(msgId));
+    appendU2(out, quint16(payload.size()));
+    out.append(payload);
+
+    // Somme de Fletcher 8 bits sur classe, identifiant, longueur et charge utile.
+    quint8 ckA = 0;
+    quint8 ckB = 0;
+    for (int i = 2; i < out.size(); ++i) {
+        ckA += quint8(out.at(i));
+        ckB += ckA;
+    }
+    out.append(char(ckA));
+    out.append(char(ckB));
+    return out;
+}
+
+QByteArray UbxProtocol::cfgPrtUart(quint32 baud)
+{
+    QByteArray payload;
+    payload.reserve(20);
+    payload.append(char(1));      // portID : UART1
+    payload.append(char(0));      // réservé
+    appendU2(payload, 0);         // txReady : désactivé
+    appendU4(payload, 0x000008D0); // mode : 8 bits, sans parité, 1 bit de stop
+    appendU4(payload, baud);
+    appendU2(payload, 0x0003);    // inProtoMask : UBX + NMEA
+    appendU2(payload, 0x0003);    // outProtoMask : UBX + NMEA (phrases coupées par CFG-MSG)
+    appendU2(payload, 0);         // flags
+    appendU2(payload, 0);         // réservé
+    return frame(ClassCfg, IdCfgPrt, payload);
+}
+
+QByteArray UbxProtocol::cfgRate(int rateHz)
+{
+    const int hz = std::clamp(rateHz, MinRateHz, MaxRateHz);
+    QByteArray payload;
+    payload.reserve(6);
+    appendU2(payload, quint16(1000 / hz)); // measRate (ms)
+    appendU2(payload, 1);                  // navRate : une solution par mesure
+    appendU2(payload, 1);                  // timeRef : temps GPS
+    return frame(ClassCfg, IdCfgRate, payload);
+}
+
+QByteArray UbxProtocol::cfgMsg(quint8 msgClass, quint8 msgId, quint8 rate)
+{
+    QByteArray payload;
+    payload.append(char(msgClass));
+    payload.append(char(msgId));
+    payload.append(char(rate));
+    return frame(ClassCfg, IdCfgMsg, payload);
+}
+
+QList<QByteArray> UbxProtocol::navigationSetup(int rateHz)
+{
+    const int hz = std::clamp(rateHz, MinRateHz, MaxRateHz);
+    QList<QByteArray> frames;
+    frames.append(cfgRate(hz));
+    for (quint8 id : {NmeaGga, NmeaGll, NmeaGsa, NmeaGsv, NmeaRmc, NmeaVtg}) {
+        frames.append(cfgMsg(ClassNmea, id, 0));
+    }
+    frames.append(cfgMsg(ClassNav, IdNavPvt, 1));
+    frames.append(cfgMsg(ClassNav, IdNavDop, quint8(hz))); // ≈ 1 Hz : le HDOP varie lentement
+    return frames;
+}
+
+QList<QByteArray> UbxProtocol::nmeaFallback()
+{
+    QList<QByteArray> frames;
+    for (quint8 id : {NmeaGga, NmeaRmc, NmeaGsa}) {
+        frames.append(cfgMsg(ClassNmea, id, 1));
+    }
+    return frames;
+}
+
+bool UbxProtocol::decodeNavPvt(const quint8* p, std::size_t length, UbxNavPvt& out)
+{
+    if (length < NavPvtLength) return false;
+
+    out.iTowMs = readU4(p);
+    out.year = readU2(p + 4);
+    out.month = p[6];
+    out.day = p[7];
+    out.hour = p[8];
+    out.minute = p[9];
+    out.second = p[10];
+    out.dateValid = (p[11] & 0x01) != 0;
+    out.timeValid = (p[11] & 0x02) != 0;
+    out.fixType = p[20];
+    out.gnssFixOk = (p[21] & 0x01) != 0;
+    out.satellites = p[23];
+    out.lon = readI4(p + 24) * 1e-7;
+    out.lat = readI4(p + 28) * 1e-7;
+    out.altitudeMslM = readI4(p + 36) * 1e-3;
+    out.horizontalAccuracyM = readU4(p + 40) * 1e-3;
+    out.verticalAccuracyM = readU4(p + 44) * 1e-3;
+    out.velNorthMs = readI4(p + 48) * 1e-3;
+    out.velEastMs = readI4(p + 52) * 1e-3;
+    out.velDownMs = readI4(p + 56) * 1e-3;
+    out.groundSpeedMs = readI4(p + 60) * 1e-3;
+    out.headingMotionDeg = readI4(p + 64) * 1e-5;
+    out.speedAccuracyMs = readU4(p + 68) * 1e-3;
+    out.headingAccuracyDeg = readU4(p + 72) * 1e-5;
+    out.pdop = readU2(p + 76) * 0.01;
+    return true;
+}
+
+bool UbxProtocol::decodeNavDopHdop(const quint8* p, std::size_t length, double& hdop)
+{
+    if (length < NavDopLength) return false;
+    hdop = readU2(p + 12) * 0.01;
+    return true;
+}
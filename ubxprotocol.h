@@ -0,0 +1,245 @@
+/**
+ * @file ubxprotocol.h
+ * @brief Rôle architectural : Protocole binaire u-blox UBX (configuration du récepteur et solution NAV-PVT).
+ * @details Responsabilités : Construire les trames de configuration (CFG-PRT, CFG-RATE, CFG-MSG) qui
+ * passent le récepteur à 115200 bauds et 5 à 10 Hz sans phrases NMEA superflues, puis décoder en flux
+ * les trames binaires reçues (somme de Fletcher 8 bits) et les messages NAV-PVT / NAV-DOP.
+ * Une trame NAV-PVT de 100 octets remplace RMC + GGA (≈ 150 octets) et porte en plus l'heure,
+ * la précision estimée et la vitesse 3D.
+ * Dépendances principales : QByteArray (construction des trames uniquement).
+ */
+
+#ifndef UBXPROTOCOL_H
+#define UBXPROTOCOL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * @struct UbxNavPvt
+ * @brief Solution de navigation UBX-NAV-PVT, convertie en unités SI.
+ */
+struct UbxNavPvt {
+    quint32 iTowMs = 0;          ///< Temps de la semaine GPS de l'époque (ms).
+    int year = 0;                ///< Date UTC.
+    int month = 0;
+    int day = 0;
+    int hour = 0;                ///< Heure UTC.
+    int minute = 0;
+    int second = 0;
+    bool dateValid = false;      ///< Date UTC valide (validDate).
+    bool timeValid = false;      ///< Heure UTC valide (validTime).
+    int fixType = 0;             ///< 0 : aucun, 1 : estime seule, 2 : 2D, 3 : 3D, 4 : GNSS + estime, 5 : temps seul.
+    bool gnssFixOk = false;      ///< Fix dans les limites de masque DOP/précision (flags bit 0).
+    int satellites = 0;          ///< Satellites utilisés (numSV).
+    double lat = 0.0;            ///< Latitude (degrés).
+    double lon = 0.0;            ///< Longitude (degrés).
+    double altitudeMslM = 0.0;   ///< Altitude au-dessus du niveau moyen des mers (m).
+    double horizontalAccuracyM = 0.0; ///< Précision horizontale estimée (m).
+    double verticalAccuracyM = 0.0;   ///< Précision verticale estimée (m).
+    double velNorthMs = 0.0;     ///< Vitesse Nord (m/s).
+    double velEastMs = 0.0;      ///< Vitesse Est (m/s).
+    double velDownMs = 0.0;      ///< Vitesse verticale, positive vers le bas (m/s).
+    double groundSpeedMs = 0.0;  ///< Vitesse sol 2D (m/s).
+    double headingMotionDeg = 0.0; ///< Route sur le fond (degrés).
+    double speedAccuracyMs = 0.0;  ///< Précision de la vitesse (m/s).
+    double headingAccuracyDeg = 0.0; ///< Précision de la route (degrés).
+    double pdop = 0.0;           ///< Dilution de précision 3D.
+
+    /**
+     * @brief true si la position est exploitable pour la navigation (fix 2D/3D validé par le récepteur).
+     */
+    bool positionValid() const { return gnssFixOk && fixType >= 2 && fixType <= 4; }
+};
+
+/**
+ * @class UbxParser
+ * @brief Décodeur de trames UBX en flux (machine à états octet par octet, tampon fixe).
+ * @details Les octets hors trame (phrases NMEA encore émises pendant la reconfiguration, bruit)
+ * sont ignorés jusqu'au prochain motif de synchronisation 0xB5 0x62.
+ */
+class UbxParser {
+public:
+    /** @brief Taille maximale de charge utile conservée (NAV-PVT : 92 octets). */
+    static constexpr std::size_t MaxPayload = 512;
+
+    /**
+     * @struct Stats
+     * @brief Compteurs de diagnostic du flux.
+     */
+    struct Stats {
+        quint64 frames = 0;         ///< Trames reçues intègres.
+        quint64 checksumErrors = 0; ///< Trames rejetées (somme de Fletcher fausse).
+        quint64 oversized = 0;      ///< Trames ignorées (charge utile > MaxPayload).
+    };
+
+    /**
+     * @brief Analyse un bloc d'octets lu sur le port série.
+     * @param onFrame Appelé pour chaque trame intègre : (classe, identifiant, charge utile, longueur).
+     * @return Nombre de trames intègres dans ce bloc.
+     */
+    template <typename Handler>
+    std::size_t feed(const char* data, std::size_t size, Handler&& onFrame);
+
+    const Stats& stats() const { return m_stats; } ///< Compteurs de diagnostic.
+
+    /**
+     * @brief Revient à l'attente d'une synchronisation et remet les compteurs à zéro.
+     */
+    void reset();
+
+private:
+    enum class State { Sync1, Sync2, Class, Id, Length1, Length2, Payload, ChecksumA, ChecksumB };
+
+    State m_state = State::Sync1;         ///< Position dans la trame courante
+    quint8 m_class = 0;                   ///< Classe de la trame courante
+    quint8 m_id = 0;                      ///< Identifiant de la trame courante
+    quint16 m_length = 0;                 ///< Longueur annoncée de la charge utile
+    quint16 m_received = 0;               ///< Octets de charge utile reçus
+    quint8 m_ckA = 0;                     ///< Somme de Fletcher en cours (A)
+    quint8 m_ckB = 0;                     ///< Somme de Fletcher en cours (B)
+    quint8 m_expectedA = 0;               ///< Premier octet de somme reçu
+    quint8 m_payload[MaxPayload];         ///< Charge utile de la trame courante
+    Stats m_stats;                        ///< Compteurs de diagnostic
+};
+
+/**
+ * @class UbxProtocol
+ * @brief Constantes, construction des trames de configuration et décodage des messages NAV.
+ */
+class UbxProtocol {
+public:
+    // --- Classes et identifiants de messages ---
+    static constexpr quint8 ClassNav = 0x01;
+    static constexpr quint8 ClassAck = 0x05;
+    static constexpr quint8 ClassCfg = 0x06;
+    static constexpr quint8 ClassNmea = 0xF0;
+    static constexpr quint8 IdNavDop = 0x04;
+    static constexpr quint8 IdNavPvt = 0x07;
+    static constexpr quint8 IdAckNak = 0x00;
+    static constexpr quint8 IdAckAck = 0x01;
+    static constexpr quint8 IdCfgPrt = 0x00;
+    static constexpr quint8 IdCfgMsg = 0x01;
+    static constexpr quint8 IdCfgRate = 0x08;
+
+    static constexpr quint32 DefaultBaud = 9600;     ///< Débit d'usine des modules u-blox (NMEA).
+    static constexpr quint32 NavigationBaud = 115200; ///< Débit nécessaire à 10 Hz avec marge.
+    static constexpr int MinRateHz = 5;              ///< Cadence de navigation minimale configurée.
+    static constexpr int MaxRateHz = 10;             ///< Cadence de navigation maximale configurée.
+
+    /**
+     * @brief Construit une trame complète (synchronisation, en-tête, charge utile, somme de Fletcher).
+     */
+    static QByteArray frame(quint8 msgClass, quint8 msgId, const QByteArray& payload = QByteArray());
+
+    /**
+     * @brief CFG-PRT : UART1 en 8N1 au débit donné, protocoles UBX + NMEA en entrée comme en sortie.
+     * @details La sortie NMEA reste autorisée au niveau du port ; les phrases sont coupées une à une
+     * par CFG-MSG, ce qui laisse passer les messages texte d'erreur du récepteur.
+     */
+    static QByteArray cfgPrtUart(quint32 baud);
+
+    /**
+     * @brief CFG-RATE : période de mesure (bornée à [MinRateHz, MaxRateHz]), une solution par mesure, temps GPS.
+     */
+    static QByteArray cfgRate(int rateHz);
+
+    /**
+     * @brief CFG-MSG : cadence d'émission d'un message sur le port courant (0 = désactivé, 1 = chaque solution).
+     */
+    static QByteArray cfgMsg(quint8 msgClass, quint8 msgId, quint8 rate);
+
+    /**
+     * @brief Séquence envoyée une fois le port passé à NavigationBaud.
+     * @details CFG-RATE, désactivation des phrases NMEA (GGA, GLL, GSA, GSV, RMC, VTG), puis activation
+     * de NAV-PVT à chaque solution et de NAV-DOP une solution sur rateHz (≈ 1 Hz, pour le HDOP).
+     */
+    static QList<QByteArray> navigationSetup(int rateHz);
+
+    /**
+     * @brief Réactive GGA, RMC et GSA, pour un module qui n'émet pas NAV-PVT (u-blox 6 ou antérieur).
+     */
+    static QList<QByteArray> nmeaFallback();
+
+    /**
+     * @brief Décode une charge utile NAV-PVT (92 octets, versions récentes : 92 octets ou plus).
+     * @return false si la charge utile est trop courte.
+     */
+    static bool decodeNavPvt(const quint8* payload, std::size_t length, UbxNavPvt& out);
+
+    /**
+     * @brief Extrait le HDOP d'une charge utile NAV-DOP (18 octets).
+     * @return false si la charge utile est trop courte.
+     */
+    static bool decodeNavDopHdop(const quint8* payload, std::size_t length, double& hdop);
+};
+
+template <typename Handler>
+std::size_t UbxParser::feed(const char* data, std::size_t size, Handler&& onFrame)
+{
+    std::size_t frames = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        const quint8 byte = static_cast<quint8>(data[i]);
+        switch (m_state) {
+        case State::Sync1:
+            if (byte == 0xB5) m_state = State::Sync2;
+            break;
+        case State::Sync2:
+            m_state = byte == 0x62 ? State::Class : (byte == 0xB5 ? State::Sync2 : State::Sync1);
+            break;
+        case State::Class:
+            m_class = byte;
+            m_ckA = byte;
+            m_ckB = m_ckA;
+            m_state = State::Id;
+            break;
+        case State::Id:
+            m_id = byte;
+            m_ckA += byte;
+            m_ckB += m_ckA;
+            m_state = State::Length1;
+            break;
+        case State::Length1:
+            m_length = byte;
+            m_ckA += byte;
+            m_ckB += m_ckA;
+            m_state = State::Length2;
+            break;
+        case State::Length2:
+            m_length |= quint16(byte) << 8;
+            m_ckA += byte;
+            m_ckB += m_ckA;
+            m_received = 0;
+            m_state = m_length == 0 ? State::ChecksumA : State::Payload;
+            break;
+        case State::Payload:
+            if (m_received < MaxPayload) m_payload[m_received] = byte;
+            ++m_received;
+            m_ckA += byte;
+            m_ckB += m_ckA;
+            if (m_received == m_length) m_state = State::ChecksumA;
+            break;
+        case State::ChecksumA:
+            m_expectedA = byte;
+            m_state = State::ChecksumB;
+            break;
+        case State::ChecksumB:
+            m_state = State::Sync1;
+            if (m_expectedA != m_ckA || byte != m_ckB) {
+                ++m_stats.checksumErrors;
+            } else if (m_length > MaxPayload) {
+                ++m_stats.oversized;
+            } else {
+                ++m_stats.frames;
+                ++frames;
+                onFrame(m_class, m_id, m_payload, std::size_t(m_length));
+            }
+            break;
+        }
+    }
+    return frames;
+}
+
+#endif // UBXPROTOCOL_H